@@ -0,0 +1,342 @@
+/* GF(2^8) arithmetic for the FECFRAME elements
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include <string.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+#include "gstgf256.h"
+
+
+#define GF256_PRIMITIVE_POLYNOMIAL 0x11D
+
+
+/* Region lengths for which specialised region functions are generated. The
+ * defaults cover MPEG-TS, sliced into ADUs of 1, 2, 4, 6 and 7 TS packets,
+ * plus the 3 byte ADUI header. */
+#ifndef GST_FEC_GF256_FIXED_LENGTHS
+#define GST_FEC_GF256_FIXED_LENGTHS \
+	GST_FEC_GF256_FIXED_LENGTH(191) \
+	GST_FEC_GF256_FIXED_LENGTH(379) \
+	GST_FEC_GF256_FIXED_LENGTH(755) \
+	GST_FEC_GF256_FIXED_LENGTH(1131) \
+	GST_FEC_GF256_FIXED_LENGTH(1319)
+#endif
+
+
+guint8 gst_fec_gf256_mul_table[256][256];
+
+/* The exp table is twice as long as necessary, so the sum of two
+ * logarithms can be used as index without a modulo operation */
+static guint8 gf256_exp[510];
+static guint gf256_log[256];
+static guint8 gf256_inv[256];
+
+
+void gst_fec_gf256_init(void)
+{
+	static gsize tables_initialized = 0;
+
+	if (g_once_init_enter(&tables_initialized))
+	{
+		guint i, j, x;
+
+		/* Generate the exp and log tables by repeatedly multiplying
+		 * with the generator element (x = 2) */
+		x = 1;
+		for (i = 0; i < 255; ++i)
+		{
+			gf256_exp[i] = x;
+			gf256_exp[i + 255] = x;
+			gf256_log[x] = i;
+
+			x <<= 1;
+			if (x & 0x100)
+				x ^= GF256_PRIMITIVE_POLYNOMIAL;
+		}
+		/* log(0) is undefined; it is never used, since all
+		 * functions check for zero operands first */
+		gf256_log[0] = 0;
+
+		gf256_inv[0] = 0;
+		for (i = 1; i < 256; ++i)
+			gf256_inv[i] = gf256_exp[255 - gf256_log[i]];
+
+		for (i = 0; i < 256; ++i)
+		{
+			for (j = 0; j < 256; ++j)
+				gst_fec_gf256_mul_table[i][j] = ((i == 0) || (j == 0)) ? 0 : gf256_exp[gf256_log[i] + gf256_log[j]];
+		}
+
+		g_once_init_leave(&tables_initialized, 1);
+	}
+}
+
+
+guint8 gst_fec_gf256_mul(guint8 a, guint8 b)
+{
+	return gst_fec_gf256_mul_table[a][b];
+}
+
+
+guint8 gst_fec_gf256_div(guint8 a, guint8 b)
+{
+	g_assert(b != 0);
+
+	if (a == 0)
+		return 0;
+	else
+		return gf256_exp[gf256_log[a] + 255 - gf256_log[b]];
+}
+
+
+guint8 gst_fec_gf256_inv(guint8 a)
+{
+	g_assert(a != 0);
+	return gf256_inv[a];
+}
+
+
+void gst_fec_xor_region(guint8 *dst, guint8 const *src, gsize length)
+{
+	/* XOR FEC spends nearly all of its time in here, so the bulk of
+	 * the region is processed with SIMD registers if the target has
+	 * them. Unaligned loads and stores are used, since symbols are
+	 * located at arbitrary offsets inside GstBuffers. */
+#if defined(__AVX2__)
+	for (; length >= 64; length -= 64, dst += 64, src += 64)
+	{
+		__m256i d0 = _mm256_loadu_si256((__m256i const *)(dst + 0));
+		__m256i d1 = _mm256_loadu_si256((__m256i const *)(dst + 32));
+		__m256i s0 = _mm256_loadu_si256((__m256i const *)(src + 0));
+		__m256i s1 = _mm256_loadu_si256((__m256i const *)(src + 32));
+		_mm256_storeu_si256((__m256i *)(dst + 0), _mm256_xor_si256(d0, s0));
+		_mm256_storeu_si256((__m256i *)(dst + 32), _mm256_xor_si256(d1, s1));
+	}
+#endif
+#if defined(__SSE2__)
+	for (; length >= 16; length -= 16, dst += 16, src += 16)
+	{
+		__m128i d = _mm_loadu_si128((__m128i const *)dst);
+		__m128i s = _mm_loadu_si128((__m128i const *)src);
+		_mm_storeu_si128((__m128i *)dst, _mm_xor_si128(d, s));
+	}
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	for (; length >= 16; length -= 16, dst += 16, src += 16)
+		vst1q_u8(dst, veorq_u8(vld1q_u8(dst), vld1q_u8(src)));
+#endif
+
+	/* Process the rest 8 bytes at a time. memcpy() is used to avoid
+	 * unaligned accesses; compilers turn these calls into plain loads
+	 * and stores. */
+	for (; length >= 8; length -= 8, dst += 8, src += 8)
+	{
+		guint64 d, s;
+		memcpy(&d, dst, 8);
+		memcpy(&s, src, 8);
+		d ^= s;
+		memcpy(dst, &d, 8);
+	}
+
+	for (; length > 0; --length)
+		*dst++ ^= *src++;
+}
+
+
+void gst_fec_gf256_region_mul(guint8 *dst, guint8 const *src, guint8 c, gsize length)
+{
+	guint8 const *row;
+	gsize i;
+
+	switch (c)
+	{
+		case 0:
+			memset(dst, 0, length);
+			return;
+
+		case 1:
+			memcpy(dst, src, length);
+			return;
+
+		default:
+			break;
+	}
+
+	row = gst_fec_gf256_mul_table[c];
+	for (i = 0; i < length; ++i)
+		dst[i] = row[src[i]];
+}
+
+
+void gst_fec_gf256_region_mul_add(guint8 *dst, guint8 const *src, guint8 c, gsize length)
+{
+	guint8 const *row;
+	gsize i;
+
+	switch (c)
+	{
+		case 0:
+			return;
+
+		case 1:
+			gst_fec_xor_region(dst, src, length);
+			return;
+
+		default:
+			break;
+	}
+
+	row = gst_fec_gf256_mul_table[c];
+	for (i = 0; i < length; ++i)
+		dst[i] ^= row[src[i]];
+}
+
+
+/* The specialised region functions. Coefficients 0 and 1 are handled
+ * like in the generic functions, since memset(), memcpy() and the XOR
+ * region function are much faster than table lookups. Everything else
+ * is processed 8 bytes per iteration; with a constant length, the
+ * compiler knows the exact number of iterations of both loops. */
+
+#define GST_FEC_GF256_FIXED_LENGTH(LENGTH) \
+	static void gst_fec_gf256_region_mul_##LENGTH(guint8 *dst, guint8 const *src, guint8 c, gsize length) \
+	{ \
+		guint8 const *row; \
+		gsize i; \
+		\
+		/* length is only read by the assertion */ \
+		(void)length; \
+		g_assert(length == (LENGTH)); \
+		\
+		switch (c) \
+		{ \
+			case 0: \
+				memset(dst, 0, (LENGTH)); \
+				return; \
+			\
+			case 1: \
+				memcpy(dst, src, (LENGTH)); \
+				return; \
+			\
+			default: \
+				break; \
+		} \
+		\
+		row = gst_fec_gf256_mul_table[c]; \
+		for (i = 0; i < ((LENGTH) & ~7u); i += 8) \
+		{ \
+			dst[i + 0] = row[src[i + 0]]; \
+			dst[i + 1] = row[src[i + 1]]; \
+			dst[i + 2] = row[src[i + 2]]; \
+			dst[i + 3] = row[src[i + 3]]; \
+			dst[i + 4] = row[src[i + 4]]; \
+			dst[i + 5] = row[src[i + 5]]; \
+			dst[i + 6] = row[src[i + 6]]; \
+			dst[i + 7] = row[src[i + 7]]; \
+		} \
+		for (; i < (LENGTH); ++i) \
+			dst[i] = row[src[i]]; \
+	} \
+	\
+	static void gst_fec_gf256_region_mul_add_##LENGTH(guint8 *dst, guint8 const *src, guint8 c, gsize length) \
+	{ \
+		guint8 const *row; \
+		gsize i; \
+		\
+		/* length is only read by the assertion */ \
+		(void)length; \
+		g_assert(length == (LENGTH)); \
+		\
+		switch (c) \
+		{ \
+			case 0: \
+				return; \
+			\
+			case 1: \
+				gst_fec_xor_region(dst, src, (LENGTH)); \
+				return; \
+			\
+			default: \
+				break; \
+		} \
+		\
+		row = gst_fec_gf256_mul_table[c]; \
+		for (i = 0; i < ((LENGTH) & ~7u); i += 8) \
+		{ \
+			dst[i + 0] ^= row[src[i + 0]]; \
+			dst[i + 1] ^= row[src[i + 1]]; \
+			dst[i + 2] ^= row[src[i + 2]]; \
+			dst[i + 3] ^= row[src[i + 3]]; \
+			dst[i + 4] ^= row[src[i + 4]]; \
+			dst[i + 5] ^= row[src[i + 5]]; \
+			dst[i + 6] ^= row[src[i + 6]]; \
+			dst[i + 7] ^= row[src[i + 7]]; \
+		} \
+		for (; i < (LENGTH); ++i) \
+			dst[i] ^= row[src[i]]; \
+	}
+
+GST_FEC_GF256_FIXED_LENGTHS
+
+#undef GST_FEC_GF256_FIXED_LENGTH
+
+
+typedef struct
+{
+	gsize length;
+	GstFECGF256RegionOps ops;
+}
+GstFECGF256FixedRegionOps;
+
+#define GST_FEC_GF256_FIXED_LENGTH(LENGTH) \
+	{ (LENGTH), { gst_fec_gf256_region_mul_##LENGTH, gst_fec_gf256_region_mul_add_##LENGTH } },
+
+/* The list is terminated by an entry with length 0. This also keeps
+ * the array from being empty if no lengths are configured. */
+static GstFECGF256FixedRegionOps const fixed_region_ops[] =
+{
+	GST_FEC_GF256_FIXED_LENGTHS
+	{ 0, { NULL, NULL } }
+};
+
+#undef GST_FEC_GF256_FIXED_LENGTH
+
+static GstFECGF256RegionOps const generic_region_ops =
+{
+	gst_fec_gf256_region_mul,
+	gst_fec_gf256_region_mul_add
+};
+
+
+GstFECGF256RegionOps const * gst_fec_gf256_get_region_ops(gsize length)
+{
+	guint i;
+
+	for (i = 0; fixed_region_ops[i].length != 0; ++i)
+	{
+		if (fixed_region_ops[i].length == length)
+			return &(fixed_region_ops[i].ops);
+	}
+
+	return &generic_region_ops;
+}
@@ -0,0 +1,87 @@
+/* GF(2^8) arithmetic for the FECFRAME elements
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef GSTFECFRAME_COMMON_GF256_H
+#define GSTFECFRAME_COMMON_GF256_H
+
+#include <gst/gst.h>
+
+
+G_BEGIN_DECLS
+
+
+/* Finite field GF(2^8), generated by the primitive polynomial
+ * x^8 + x^4 + x^3 + x^2 + 1 (0x11D). This is the same field that is
+ * used by the OpenFEC Reed-Solomon GF(2^8) codec.
+ *
+ * gst_fec_gf256_init() must be called before any other function
+ * in here is used. It can safely be called multiple times, and from
+ * multiple threads; the tables are only computed once. */
+
+
+/* Full multiplication table. Row c contains the products of c with
+ * all 256 field elements. Region operations fetch one row and then
+ * only need one lookup per byte. */
+extern guint8 gst_fec_gf256_mul_table[256][256];
+
+
+void gst_fec_gf256_init(void);
+
+guint8 gst_fec_gf256_mul(guint8 a, guint8 b);
+guint8 gst_fec_gf256_div(guint8 a, guint8 b);
+guint8 gst_fec_gf256_inv(guint8 a);
+
+/* dst = dst XOR src */
+void gst_fec_xor_region(guint8 *dst, guint8 const *src, gsize length);
+/* dst = c * src */
+void gst_fec_gf256_region_mul(guint8 *dst, guint8 const *src, guint8 c, gsize length);
+/* dst = dst + c * src */
+void gst_fec_gf256_region_mul_add(guint8 *dst, guint8 const *src, guint8 c, gsize length);
+
+
+/* Region functions for one specific region length. For the lengths listed in
+ * GST_FEC_GF256_FIXED_LENGTHS (see gstgf256.c; the list can be replaced with
+ * the --fixed-symbol-lengths configure switch), there are variants of the
+ * region functions above whose length is a compile time constant. Their loops
+ * are unrolled 8x, followed by a tail loop for the remaining bytes; since the
+ * trip counts of both loops are constants, the compiler can optimise them
+ * further. This pays off if all symbols have the same length, as is the case
+ * with MPEG-TS (7 TS packets plus the 3 byte ADUI header make 1319 bytes).
+ *
+ * The length argument of these functions must equal the length that was
+ * passed to gst_fec_gf256_get_region_ops(). */
+typedef void (*GstFECGF256RegionFunc)(guint8 *dst, guint8 const *src, guint8 c, gsize length);
+
+typedef struct
+{
+	GstFECGF256RegionFunc region_mul;
+	GstFECGF256RegionFunc region_mul_add;
+}
+GstFECGF256RegionOps;
+
+/* Returns the region functions to use for regions of the given length.
+ * Never returns NULL; if there are no specialised functions for this
+ * length, the generic ones are returned. */
+GstFECGF256RegionOps const * gst_fec_gf256_get_region_ops(gsize length);
+
+
+G_END_DECLS
+
+
+#endif
@@ -0,0 +1,84 @@
+/* Symbol memory arena for the FECFRAME elements
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include "gstsymbolarena.h"
+
+
+/* The smallest size class. Smaller slabs are not worth
+ * distinguishing, since they would be replaced right away. */
+#define MIN_SLAB_SIZE 4096
+
+
+void gst_fec_symbol_arena_init(GstFECSymbolArena *arena)
+{
+	arena->memory = NULL;
+	arena->slab = NULL;
+	arena->slab_size = 0;
+}
+
+
+void gst_fec_symbol_arena_clear(GstFECSymbolArena *arena)
+{
+	g_free(arena->memory);
+	gst_fec_symbol_arena_init(arena);
+}
+
+
+gsize gst_fec_symbol_arena_get_stride(gsize symbol_length)
+{
+	return (symbol_length + GST_FEC_SYMBOL_ARENA_ALIGNMENT - 1) & ~((gsize)(GST_FEC_SYMBOL_ARENA_ALIGNMENT - 1));
+}
+
+
+gboolean gst_fec_symbol_arena_reserve(GstFECSymbolArena *arena, guint num_symbols, gsize symbol_length)
+{
+	gsize required_size = gst_fec_symbol_arena_get_stride(symbol_length) * num_symbols;
+	gsize slab_size;
+
+	if (required_size <= arena->slab_size)
+		return FALSE;
+
+	/* Pick the smallest size class that fits */
+	slab_size = MIN_SLAB_SIZE;
+	while (slab_size < required_size)
+		slab_size <<= 1;
+
+	/* g_malloc() only guarantees an alignment suitable for the basic
+	 * types, so allocate a little more and align the slab manually.
+	 * The old contents are not needed, so g_realloc() is not used. */
+	g_free(arena->memory);
+	arena->memory = g_malloc(slab_size + GST_FEC_SYMBOL_ARENA_ALIGNMENT - 1);
+	arena->slab = (guint8 *)((((guintptr)(arena->memory)) + GST_FEC_SYMBOL_ARENA_ALIGNMENT - 1) & ~((guintptr)(GST_FEC_SYMBOL_ARENA_ALIGNMENT - 1)));
+	arena->slab_size = slab_size;
+
+	return TRUE;
+}
+
+
+gboolean gst_fec_symbol_arena_assign(GstFECSymbolArena *arena, void **symbol_table, guint num_symbols, gsize symbol_length)
+{
+	guint i;
+	gsize stride = gst_fec_symbol_arena_get_stride(symbol_length);
+	gboolean reallocated = gst_fec_symbol_arena_reserve(arena, num_symbols, symbol_length);
+
+	for (i = 0; i < num_symbols; ++i)
+		symbol_table[i] = arena->slab + i * stride;
+
+	return reallocated;
+}
@@ -0,0 +1,80 @@
+/* Symbol memory arena for the FECFRAME elements
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef GSTFECFRAME_COMMON_SYMBOL_ARENA_H
+#define GSTFECFRAME_COMMON_SYMBOL_ARENA_H
+
+#include <gst/gst.h>
+
+
+G_BEGIN_DECLS
+
+
+/* Memory for the source symbols of a source block. Instead of allocating
+ * each symbol separately (and freeing and allocating all of them again
+ * each time the encoding symbol length changes), all symbols are placed in
+ * one contiguous slab. Each symbol starts at a multiple of
+ * GST_FEC_SYMBOL_ARENA_ALIGNMENT bytes, so the symbols are aligned to cache
+ * lines (and SIMD registers), and never share a cache line with another
+ * symbol. The distance between two symbols is called the stride.
+ *
+ * Slab sizes are powers of two (the size classes). The slab is only
+ * replaced if it is too small for the requested symbols; if symbols get
+ * shorter, or grow only a little, the existing slab is reused. The slab
+ * can be pre-warmed with gst_fec_symbol_arena_reserve(), so that symbol
+ * length changes up to a known maximum never allocate anything.
+ *
+ * The contents of the symbols are not preserved if the slab is replaced. */
+
+
+#define GST_FEC_SYMBOL_ARENA_ALIGNMENT 64
+
+
+typedef struct
+{
+	/* The allocated memory block, and the aligned
+	 * slab inside it. Both are NULL if there is none. */
+	gpointer memory;
+	guint8 *slab;
+	/* Size of the slab, in bytes; always a power of two (or 0) */
+	gsize slab_size;
+}
+GstFECSymbolArena;
+
+
+void gst_fec_symbol_arena_init(GstFECSymbolArena *arena);
+/* Frees the slab */
+void gst_fec_symbol_arena_clear(GstFECSymbolArena *arena);
+
+/* Returns the stride for symbols of the given length */
+gsize gst_fec_symbol_arena_get_stride(gsize symbol_length);
+
+/* Makes sure the slab can hold num_symbols symbols with symbol_length bytes
+ * each. Returns TRUE if a new slab had to be allocated for this. */
+gboolean gst_fec_symbol_arena_reserve(GstFECSymbolArena *arena, guint num_symbols, gsize symbol_length);
+/* Reserves space for the symbols like gst_fec_symbol_arena_reserve(), and
+ * sets the first num_symbols entries of symbol_table to the symbols inside
+ * the slab. Returns TRUE if a new slab had to be allocated. */
+gboolean gst_fec_symbol_arena_assign(GstFECSymbolArena *arena, void **symbol_table, guint num_symbols, gsize symbol_length);
+
+
+G_END_DECLS
+
+
+#endif
@@ -0,0 +1,42 @@
+/* RFC 6816-based forward error correction based on LDPC-Staircase for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include "gstldpcfeccommon.h"
+
+
+gboolean gst_ldpc_fec_check_parameters(guint num_source_symbols, guint num_repair_symbols, guint n1, gchar const **error_desc)
+{
+	if ((num_source_symbols + num_repair_symbols) > GST_LDPC_FEC_MAX_NUM_ENCODING_SYMBOLS)
+	{
+		*error_desc = "too many encoding symbols";
+		return FALSE;
+	}
+
+	/* Each column of the left side of the parity check matrix has N1
+	 * "1"s, one in each of N1 different rows. There is one row per
+	 * repair symbol, so there must be at least N1 repair symbols.
+	 * (Without repair symbols, no parity check matrix is needed.) */
+	if ((num_repair_symbols > 0) && (num_repair_symbols < n1))
+	{
+		*error_desc = "number of repair symbols must be at least N1";
+		return FALSE;
+	}
+
+	return TRUE;
+}
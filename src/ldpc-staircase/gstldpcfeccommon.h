@@ -0,0 +1,66 @@
+/* RFC 6816-based forward error correction based on LDPC-Staircase for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef GSTFECFRAME_LDPC_STAIRCASE_LDPCFECCOMMON_H
+#define GSTFECFRAME_LDPC_STAIRCASE_LDPCFECCOMMON_H
+
+#include <gst/gst.h>
+
+
+G_BEGIN_DECLS
+
+
+/* The LDPC-Staircase elements use the m=16 FEC payload ID layout of the
+ * Reed-Solomon elements (16-bit source block number, 16-bit ESI, 16-bit k),
+ * which matches the Repair FEC Payload ID of RFC 6816. */
+#define GST_LDPC_FEC_PAYLOAD_ID_M 16
+
+/* OpenFEC's LDPC-Staircase codec limits the number of encoding
+ * symbols per source block to this value by default */
+#define GST_LDPC_FEC_MAX_NUM_ENCODING_SYMBOLS 50000
+
+/* N1 is the number of "1"s per column in the left side of the parity check
+ * matrix. RFC 6816 transmits N1-3 in a 3-bit field, hence the range. */
+#define GST_LDPC_FEC_MIN_N1 3
+#define GST_LDPC_FEC_MAX_N1 10
+#define GST_LDPC_FEC_DEFAULT_N1 7
+
+/* The seed of the Park-Miller PRNG that is used for creating the
+ * parity check matrix. RFC 5170 requires it to be in this range. */
+#define GST_LDPC_FEC_MIN_PRNG_SEED 1
+#define GST_LDPC_FEC_MAX_PRNG_SEED 0x7FFFFFFE
+#define GST_LDPC_FEC_DEFAULT_PRNG_SEED 1
+
+/* Encoder and decoder must use the same N1 and PRNG seed, otherwise they
+ * use different parity check matrices. The encoder adds them to its caps,
+ * and the decoder refuses caps with differing values. */
+#define GST_LDPC_FEC_N1_CAPS_FIELD "ldpc-n1"
+#define GST_LDPC_FEC_PRNG_SEED_CAPS_FIELD "ldpc-prng-seed"
+
+
+/* Returns FALSE if OpenFEC's LDPC-Staircase codec cannot be used with
+ * the given parameters. In that case, error_desc is set to a static
+ * string that describes the problem. */
+gboolean gst_ldpc_fec_check_parameters(guint num_source_symbols, guint num_repair_symbols, guint n1, gchar const **error_desc);
+
+
+G_END_DECLS
+
+
+#endif
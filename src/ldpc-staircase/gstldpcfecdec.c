@@ -0,0 +1,661 @@
+/* RFC 6816-based forward error correction based on LDPC-Staircase for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/**
+ * GstLDPCFECDec is the counterpart of GstLDPCFECEnc. It manages source blocks
+ * the same way GstRSFECDec does (see the documentation there), but decodes
+ * iteratively, as the symbols arrive.
+ *
+ * Each source block gets its own OpenFEC LDPC-Staircase decoder session. The
+ * session is created once the first repair packet of the block arrives, since
+ * the encoding symbol length is not known before (source packets only contain
+ * the ADU, not the padded ADUI). All source packets that were queued until then
+ * are fed into the session as ADUIs, followed by the repair packet. From then
+ * on, each new packet is fed into the session right away. OpenFEC uses the new
+ * symbol to solve the parity check equations it is part of; this may in turn
+ * recover other symbols, and so on. As soon as OpenFEC reports that all source
+ * symbols are known, the source block is processed and its recovered ADUs are
+ * output, without waiting for further packets.
+ *
+ * If a source block is still incomplete when it is pruned or drained, OpenFEC's
+ * maximum likelihood decoder (Gaussian elimination over the remaining equations)
+ * is used as a last attempt, since it can succeed in cases where the iterative
+ * decoder got stuck.
+ *
+ * As with GstLDPCFECEnc, the code-construction property does not apply, and
+ * values other than the default (vandermonde) are refused.
+ */
+
+
+#include <string.h>
+#include "gstldpcfeccommon.h"
+#include "gstldpcfecdec.h"
+
+
+GST_DEBUG_CATEGORY(ldpc_fec_dec_debug);
+#define GST_CAT_DEFAULT ldpc_fec_dec_debug
+
+
+enum
+{
+	PROP_0,
+	PROP_N1,
+	PROP_PRNG_SEED
+};
+
+
+#define FEC_SOURCE_CAPS_STR "application/x-fec-source-flow, encoding-id = (int) 7"
+#define FEC_REPAIR_CAPS_STR "application/x-fec-repair-flow, encoding-id = (int) 7"
+
+
+#define FEC_PAYLOAD_ID_LENGTH 6
+
+
+#define CHECK_IF_FATAL_ERROR(elem, status) \
+	do { \
+		if ((status) == OF_STATUS_FATAL_ERROR) \
+			GST_ELEMENT_ERROR((elem), LIBRARY, FAILED, ("OpenFEC reports fatal error"), (NULL)); \
+	} while (0)
+
+
+/* Decoder state of one source block, stored in its scheme_data */
+typedef struct
+{
+	/* OpenFEC decoder session of this source block */
+	of_session_t *session;
+	/* Length of the encoding symbols, taken from the first repair packet */
+	gsize encoding_symbol_length;
+	/* Memory blocks of all symbols that were passed to OpenFEC or
+	 * decoded by OpenFEC. OpenFEC keeps pointers to them until the
+	 * session is released. The table has num_encoding_symbols entries;
+	 * the index equals the ESI, and unused entries are NULL. */
+	void **symbols;
+}
+GstLDPCFECDecBlockState;
+
+
+/* These replace the templates of the same name from the base class */
+
+static GstStaticPadTemplate static_fecsource_template = GST_STATIC_PAD_TEMPLATE(
+	"fecsource",
+	GST_PAD_SINK,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS(FEC_SOURCE_CAPS_STR)
+);
+
+
+static GstStaticPadTemplate static_fecrepair_template = GST_STATIC_PAD_TEMPLATE(
+	"fecrepair",
+	GST_PAD_SINK,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS(FEC_REPAIR_CAPS_STR)
+);
+
+
+
+
+G_DEFINE_TYPE(GstLDPCFECDec, gst_ldpc_fec_dec, GST_TYPE_RS_FEC_DEC)
+
+
+
+
+static void gst_ldpc_fec_dec_set_property(GObject *object, guint prop_id, GValue const *value, GParamSpec *pspec);
+static void gst_ldpc_fec_dec_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec);
+
+static guint gst_ldpc_fec_dec_get_payload_id_m(GstRSFECDec *rs_fec_dec);
+static guint gst_ldpc_fec_dec_get_max_num_encoding_symbols(GstRSFECDec *rs_fec_dec);
+static gboolean gst_ldpc_fec_dec_check_settings(GstRSFECDec *rs_fec_dec);
+static gboolean gst_ldpc_fec_dec_check_caps(GstRSFECDec *rs_fec_dec, GstCaps *caps);
+static gboolean gst_ldpc_fec_dec_add_fec_packet(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block, GstBuffer *fec_packet, guint esi, gboolean is_source_packet);
+static gboolean gst_ldpc_fec_dec_can_process_source_block(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block);
+static gboolean gst_ldpc_fec_dec_recover_source_symbols(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block);
+static gboolean gst_ldpc_fec_dec_finish_source_block(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block);
+static void gst_ldpc_fec_dec_free_source_block_data(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block);
+
+static GstLDPCFECDecBlockState* gst_ldpc_fec_dec_create_block_state(GstLDPCFECDec *ldpc_fec_dec, gsize encoding_symbol_length);
+static gboolean gst_ldpc_fec_dec_feed_source_packet(GstLDPCFECDec *ldpc_fec_dec, GstLDPCFECDecBlockState *state, GstBuffer *fec_packet, guint esi);
+static gboolean gst_ldpc_fec_dec_feed_repair_packet(GstLDPCFECDec *ldpc_fec_dec, GstLDPCFECDecBlockState *state, GstBuffer *fec_packet, guint esi);
+static gboolean gst_ldpc_fec_dec_feed_symbol(GstLDPCFECDec *ldpc_fec_dec, GstLDPCFECDecBlockState *state, guint esi);
+static void* gst_ldpc_fec_dec_decoded_symbol_callback(void *context, UINT32 size, UINT32 esi);
+
+static gchar const * gst_ldpc_fec_dec_get_status_name(of_status_t status);
+
+
+
+
+static void gst_ldpc_fec_dec_class_init(GstLDPCFECDecClass *klass)
+{
+	GObjectClass *object_class;
+	GstElementClass *element_class;
+	GstRSFECDecClass *rs_fec_dec_class;
+
+	GST_DEBUG_CATEGORY_INIT(ldpc_fec_dec_debug, "ldpcfecdec", 0, "FECFRAME RFC 6816 LDPC-Staircase scheme decoder");
+
+	object_class = G_OBJECT_CLASS(klass);
+	element_class = GST_ELEMENT_CLASS(klass);
+	rs_fec_dec_class = GST_RS_FEC_DEC_CLASS(klass);
+
+	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_fecsource_template));
+	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_fecrepair_template));
+
+	object_class->set_property  = GST_DEBUG_FUNCPTR(gst_ldpc_fec_dec_set_property);
+	object_class->get_property  = GST_DEBUG_FUNCPTR(gst_ldpc_fec_dec_get_property);
+
+	rs_fec_dec_class->supports_num_symbols_changes = FALSE;
+	rs_fec_dec_class->get_payload_id_m             = GST_DEBUG_FUNCPTR(gst_ldpc_fec_dec_get_payload_id_m);
+	rs_fec_dec_class->get_max_num_encoding_symbols = GST_DEBUG_FUNCPTR(gst_ldpc_fec_dec_get_max_num_encoding_symbols);
+	rs_fec_dec_class->check_settings               = GST_DEBUG_FUNCPTR(gst_ldpc_fec_dec_check_settings);
+	rs_fec_dec_class->check_caps                   = GST_DEBUG_FUNCPTR(gst_ldpc_fec_dec_check_caps);
+	rs_fec_dec_class->add_fec_packet               = GST_DEBUG_FUNCPTR(gst_ldpc_fec_dec_add_fec_packet);
+	rs_fec_dec_class->can_process_source_block     = GST_DEBUG_FUNCPTR(gst_ldpc_fec_dec_can_process_source_block);
+	rs_fec_dec_class->recover_source_symbols       = GST_DEBUG_FUNCPTR(gst_ldpc_fec_dec_recover_source_symbols);
+	rs_fec_dec_class->finish_source_block          = GST_DEBUG_FUNCPTR(gst_ldpc_fec_dec_finish_source_block);
+	rs_fec_dec_class->free_source_block_data       = GST_DEBUG_FUNCPTR(gst_ldpc_fec_dec_free_source_block_data);
+
+	g_object_class_install_property(
+		object_class,
+		PROP_N1,
+		g_param_spec_uint(
+			"n1",
+			"N1",
+			"Number of \"1\"s per column in the left side of the parity check matrix (must match the encoder's value)",
+			GST_LDPC_FEC_MIN_N1, GST_LDPC_FEC_MAX_N1,
+			GST_LDPC_FEC_DEFAULT_N1,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_PRNG_SEED,
+		g_param_spec_uint(
+			"prng-seed",
+			"PRNG seed",
+			"Seed for the pseudo random number generator that creates the parity check matrix (must match the encoder's value)",
+			GST_LDPC_FEC_MIN_PRNG_SEED, GST_LDPC_FEC_MAX_PRNG_SEED,
+			GST_LDPC_FEC_DEFAULT_PRNG_SEED,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+
+	gst_element_class_set_static_metadata(
+		element_class,
+		"LDPC-Staircase forward error correction decoder",
+		"Codec/Decoder/Network",
+		"Decoder for forward-error erasure coding based on the FECFRAME LDPC-Staircase scheme RFC 6816",
+		"Carlos Rafael Giani <dv@pseudoterminal.org>"
+	);
+}
+
+
+static void gst_ldpc_fec_dec_init(GstLDPCFECDec *ldpc_fec_dec)
+{
+	ldpc_fec_dec->n1 = GST_LDPC_FEC_DEFAULT_N1;
+	ldpc_fec_dec->prng_seed = GST_LDPC_FEC_DEFAULT_PRNG_SEED;
+}
+
+
+static void gst_ldpc_fec_dec_set_property(GObject *object, guint prop_id, GValue const *value, GParamSpec *pspec)
+{
+	GstLDPCFECDec *ldpc_fec_dec = GST_LDPC_FEC_DEC(object);
+	GstRSFECDec *rs_fec_dec = GST_RS_FEC_DEC(object);
+
+	switch (prop_id)
+	{
+		case PROP_N1:
+			GST_OBJECT_LOCK(object);
+			if (rs_fec_dec->allocated_encoding_symbol_table == NULL)
+				ldpc_fec_dec->n1 = g_value_get_uint(value);
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set N1 after the decoder was initialized"), (NULL));
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_PRNG_SEED:
+			GST_OBJECT_LOCK(object);
+			if (rs_fec_dec->allocated_encoding_symbol_table == NULL)
+				ldpc_fec_dec->prng_seed = g_value_get_uint(value);
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set PRNG seed after the decoder was initialized"), (NULL));
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		default:
+			/* The remaining properties belong to the base class */
+			G_OBJECT_CLASS(gst_ldpc_fec_dec_parent_class)->set_property(object, prop_id, value, pspec);
+			break;
+	}
+}
+
+
+static void gst_ldpc_fec_dec_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec)
+{
+	GstLDPCFECDec *ldpc_fec_dec = GST_LDPC_FEC_DEC(object);
+
+	switch (prop_id)
+	{
+		case PROP_N1:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, ldpc_fec_dec->n1);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_PRNG_SEED:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, ldpc_fec_dec->prng_seed);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		default:
+			G_OBJECT_CLASS(gst_ldpc_fec_dec_parent_class)->get_property(object, prop_id, value, pspec);
+			break;
+	}
+}
+
+
+static guint gst_ldpc_fec_dec_get_payload_id_m(G_GNUC_UNUSED GstRSFECDec *rs_fec_dec)
+{
+	return GST_LDPC_FEC_PAYLOAD_ID_M;
+}
+
+
+static guint gst_ldpc_fec_dec_get_max_num_encoding_symbols(G_GNUC_UNUSED GstRSFECDec *rs_fec_dec)
+{
+	return GST_LDPC_FEC_MAX_NUM_ENCODING_SYMBOLS;
+}
+
+
+static gboolean gst_ldpc_fec_dec_check_settings(GstRSFECDec *rs_fec_dec)
+{
+	GstLDPCFECDec *ldpc_fec_dec = GST_LDPC_FEC_DEC(rs_fec_dec);
+	gchar const *error_desc;
+
+	/* See gst_ldpc_fec_enc_check_settings() */
+	if (rs_fec_dec->code_construction != GST_RS_FEC_CODE_CONSTRUCTION_VANDERMONDE)
+	{
+		GST_ELEMENT_ERROR(
+			rs_fec_dec, LIBRARY, SETTINGS,
+			("code construction cannot be changed"),
+			("LDPC-Staircase does not support code construction %s", gst_rs_fec_code_construction_get_name(rs_fec_dec->code_construction))
+		);
+		return FALSE;
+	}
+
+	if (!gst_ldpc_fec_check_parameters(rs_fec_dec->num_source_symbols, rs_fec_dec->num_repair_symbols, ldpc_fec_dec->n1, &error_desc))
+	{
+		GST_ELEMENT_ERROR(
+			rs_fec_dec, LIBRARY, SETTINGS,
+			("invalid LDPC-Staircase parameters"),
+			("%s  (number of source symbols: %u  repair symbols: %u  N1: %u)", error_desc, rs_fec_dec->num_source_symbols, rs_fec_dec->num_repair_symbols, ldpc_fec_dec->n1)
+		);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+static gboolean gst_ldpc_fec_dec_check_caps(GstRSFECDec *rs_fec_dec, GstCaps *caps)
+{
+	GstLDPCFECDec *ldpc_fec_dec = GST_LDPC_FEC_DEC(rs_fec_dec);
+	GstStructure const *s = gst_caps_get_structure(caps, 0);
+	guint n1, prng_seed;
+
+	/* Refuse caps with parameters that differ from the configured ones,
+	 * since the parity check matrices would differ, and the recovered
+	 * symbols would contain garbage. Caps without these fields are
+	 * accepted; the properties must then be set correctly by the user. */
+
+	if (gst_structure_get_uint(s, GST_LDPC_FEC_N1_CAPS_FIELD, &n1) && (n1 != ldpc_fec_dec->n1))
+	{
+		GST_ERROR_OBJECT(rs_fec_dec, "caps use N1 %u, but decoder is configured for %u", n1, ldpc_fec_dec->n1);
+		return FALSE;
+	}
+
+	if (gst_structure_get_uint(s, GST_LDPC_FEC_PRNG_SEED_CAPS_FIELD, &prng_seed) && (prng_seed != ldpc_fec_dec->prng_seed))
+	{
+		GST_ERROR_OBJECT(rs_fec_dec, "caps use PRNG seed %u, but decoder is configured for %u", prng_seed, ldpc_fec_dec->prng_seed);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+static gboolean gst_ldpc_fec_dec_add_fec_packet(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block, GstBuffer *fec_packet, guint esi, gboolean is_source_packet)
+{
+	GstLDPCFECDec *ldpc_fec_dec = GST_LDPC_FEC_DEC(rs_fec_dec);
+	GstLDPCFECDecBlockState *state = source_block->scheme_data;
+	GSList *node;
+
+	if (state == NULL)
+	{
+		/* Without a repair packet, the encoding symbol length is unknown,
+		 * and no session can be created yet. The source packet stays in
+		 * the source block's list, and is fed into the session later. */
+		if (is_source_packet)
+			return TRUE;
+
+		/* First repair packet of this source block. All repair packets
+		 * are encoding_symbol_length + 6 bytes long (the FEC payload ID
+		 * has 6 bytes). */
+		if ((state = gst_ldpc_fec_dec_create_block_state(ldpc_fec_dec, gst_buffer_get_size(fec_packet) - FEC_PAYLOAD_ID_LENGTH)) == NULL)
+			return FALSE;
+		source_block->scheme_data = state;
+
+		GST_LOG_OBJECT(ldpc_fec_dec, "created LDPC-Staircase decoder session for source block #%u  (encoding symbol length: %" G_GSIZE_FORMAT ")", source_block->block_nr, state->encoding_symbol_length);
+
+		/* Feed the source packets that were received so far */
+		for (node = source_block->source_packets; node != NULL; node = node->next)
+		{
+			GstBuffer *source_packet = (GstBuffer *)(node->data);
+			guint8 payload_id[FEC_PAYLOAD_ID_LENGTH];
+			guint source_esi;
+
+			/* The FEC payload ID is located at the end of FEC source packets */
+			gst_buffer_extract(source_packet, gst_buffer_get_size(source_packet) - FEC_PAYLOAD_ID_LENGTH, payload_id, FEC_PAYLOAD_ID_LENGTH);
+			gst_rs_fec_read_payload_id(payload_id, GST_LDPC_FEC_PAYLOAD_ID_M, NULL, &source_esi, NULL);
+
+			if (!gst_ldpc_fec_dec_feed_source_packet(ldpc_fec_dec, state, source_packet, source_esi))
+				return FALSE;
+		}
+
+		return gst_ldpc_fec_dec_feed_repair_packet(ldpc_fec_dec, state, fec_packet, esi);
+	}
+
+	/* Symbols that arrive after OpenFEC recovered all source symbols
+	 * are of no use (this can happen if processing the block failed) */
+	if (of_is_decoding_complete(state->session))
+		return TRUE;
+
+	if (is_source_packet)
+		return gst_ldpc_fec_dec_feed_source_packet(ldpc_fec_dec, state, fec_packet, esi);
+	else
+		return gst_ldpc_fec_dec_feed_repair_packet(ldpc_fec_dec, state, fec_packet, esi);
+}
+
+
+static gboolean gst_ldpc_fec_dec_can_process_source_block(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block)
+{
+	GstLDPCFECDecBlockState *state = source_block->scheme_data;
+
+	/* All source packets were received; nothing needs to be decoded */
+	if (source_block->num_source_packets == rs_fec_dec->num_source_symbols)
+		return TRUE;
+
+	/* Otherwise, the source block is done as soon as the iterative decoder
+	 * recovered all missing source symbols. Unlike with Reed-Solomon, the
+	 * number of received packets alone does not tell when this happens. */
+	return (state != NULL) && of_is_decoding_complete(state->session);
+}
+
+
+static gboolean gst_ldpc_fec_dec_recover_source_symbols(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block)
+{
+	GstLDPCFECDecBlockState *state = source_block->scheme_data;
+	gsize source_symbol_table_size = sizeof(void *) * rs_fec_dec->num_source_symbols;
+	void **source_symbol_table;
+	of_status_t status;
+	guint esi;
+
+	/* The actual decoding already happened while the packets came in.
+	 * Only the pointers to the recovered symbols need to be fetched.
+	 * OpenFEC fills in one pointer per source symbol. */
+	source_symbol_table = g_slice_alloc0(source_symbol_table_size);
+	if ((status = of_get_source_symbols_tab(state->session, source_symbol_table)) != OF_STATUS_OK)
+	{
+		GST_ERROR_OBJECT(rs_fec_dec, "could not get source symbols: %s", gst_ldpc_fec_dec_get_status_name(status));
+		CHECK_IF_FATAL_ERROR(rs_fec_dec, status);
+		g_slice_free1(source_symbol_table_size, source_symbol_table);
+		return FALSE;
+	}
+
+	/* Received ADUs are already in the output_adu_table. Only pass on
+	 * the symbols of the missing ones, as the base class expects. The
+	 * pointers refer to the state's symbol memory blocks, so they stay
+	 * valid after the temporary table is freed. */
+	memset(rs_fec_dec->recovered_encoding_symbol_table, 0, sizeof(void*) * rs_fec_dec->num_encoding_symbols);
+	for (esi = 0; esi < rs_fec_dec->num_source_symbols; ++esi)
+	{
+		if (source_block->output_adu_table[esi] == NULL)
+			rs_fec_dec->recovered_encoding_symbol_table[esi] = source_symbol_table[esi];
+	}
+
+	g_slice_free1(source_symbol_table_size, source_symbol_table);
+
+	return TRUE;
+}
+
+
+static gboolean gst_ldpc_fec_dec_finish_source_block(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block)
+{
+	GstLDPCFECDecBlockState *state = source_block->scheme_data;
+	of_status_t status;
+
+	/* Without repair packets, nothing can be recovered */
+	if (state == NULL)
+		return FALSE;
+
+	if (of_is_decoding_complete(state->session))
+		return TRUE;
+
+	/* The iterative decoder got stuck. Try the ML decoder, which solves
+	 * the remaining equations with Gaussian elimination. This is much
+	 * more expensive, which is why it is only done once per block. */
+	if ((status = of_finish_decoding(state->session)) != OF_STATUS_OK)
+	{
+		GST_DEBUG_OBJECT(rs_fec_dec, "could not finish decoding source block #%u: %s", source_block->block_nr, gst_ldpc_fec_dec_get_status_name(status));
+		CHECK_IF_FATAL_ERROR(rs_fec_dec, status);
+		return FALSE;
+	}
+
+	return of_is_decoding_complete(state->session);
+}
+
+
+static void gst_ldpc_fec_dec_free_source_block_data(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block)
+{
+	GstLDPCFECDecBlockState *state = source_block->scheme_data;
+	of_status_t status;
+	guint i;
+
+	if ((status = of_release_codec_instance(state->session)) != OF_STATUS_OK)
+	{
+		GST_ERROR_OBJECT(rs_fec_dec, "could not release codec instance: %s", gst_ldpc_fec_dec_get_status_name(status));
+		CHECK_IF_FATAL_ERROR(rs_fec_dec, status);
+	}
+
+	/* The session is gone, so the symbol memory blocks can be freed now */
+	for (i = 0; i < rs_fec_dec->num_encoding_symbols; ++i)
+	{
+		if (state->symbols[i] != NULL)
+			g_slice_free1(state->encoding_symbol_length, state->symbols[i]);
+	}
+	g_slice_free1(sizeof(void *) * rs_fec_dec->num_encoding_symbols, state->symbols);
+
+	g_slice_free1(sizeof(GstLDPCFECDecBlockState), state);
+	source_block->scheme_data = NULL;
+}
+
+
+static GstLDPCFECDecBlockState* gst_ldpc_fec_dec_create_block_state(GstLDPCFECDec *ldpc_fec_dec, gsize encoding_symbol_length)
+{
+	GstRSFECDec *rs_fec_dec = GST_RS_FEC_DEC(ldpc_fec_dec);
+	GstLDPCFECDecBlockState *state;
+	of_status_t status;
+	of_ldpc_parameters_t params;
+
+	state = g_slice_alloc0(sizeof(GstLDPCFECDecBlockState));
+	state->encoding_symbol_length = encoding_symbol_length;
+	state->symbols = g_slice_alloc0(sizeof(void *) * rs_fec_dec->num_encoding_symbols);
+
+	if ((status = of_create_codec_instance(&(state->session), OF_CODEC_LDPC_STAIRCASE_STABLE, OF_DECODER, 0)) != OF_STATUS_OK)
+	{
+		GST_ERROR_OBJECT(ldpc_fec_dec, "could not create codec instance: %s", gst_ldpc_fec_dec_get_status_name(status));
+		CHECK_IF_FATAL_ERROR(ldpc_fec_dec, status);
+		goto error_free_state;
+	}
+
+	memset(&params, 0, sizeof(params));
+	params.nb_source_symbols = rs_fec_dec->num_source_symbols;
+	params.nb_repair_symbols = rs_fec_dec->num_repair_symbols;
+	params.encoding_symbol_length = encoding_symbol_length;
+	params.prng_seed = ldpc_fec_dec->prng_seed;
+	params.N1 = ldpc_fec_dec->n1;
+
+	if ((status = of_set_fec_parameters(state->session, (of_parameters_t *)(&params))) != OF_STATUS_OK)
+	{
+		GST_ERROR_OBJECT(ldpc_fec_dec, "could not set FEC parameters: %s", gst_ldpc_fec_dec_get_status_name(status));
+		CHECK_IF_FATAL_ERROR(ldpc_fec_dec, status);
+		goto error_release_session;
+	}
+
+	/* Let OpenFEC store decoded symbols in memory blocks allocated by the
+	 * callback, so they end up in the state's symbol table, and are
+	 * freed together with the other symbols */
+	if ((status = of_set_callback_functions(state->session, gst_ldpc_fec_dec_decoded_symbol_callback, gst_ldpc_fec_dec_decoded_symbol_callback, state)) != OF_STATUS_OK)
+	{
+		GST_ERROR_OBJECT(ldpc_fec_dec, "could not set callback functions: %s", gst_ldpc_fec_dec_get_status_name(status));
+		CHECK_IF_FATAL_ERROR(ldpc_fec_dec, status);
+		goto error_release_session;
+	}
+
+	return state;
+
+error_release_session:
+	of_release_codec_instance(state->session);
+error_free_state:
+	g_slice_free1(sizeof(void *) * rs_fec_dec->num_encoding_symbols, state->symbols);
+	g_slice_free1(sizeof(GstLDPCFECDecBlockState), state);
+	return NULL;
+}
+
+
+static gboolean gst_ldpc_fec_dec_feed_source_packet(GstLDPCFECDec *ldpc_fec_dec, GstLDPCFECDecBlockState *state, GstBuffer *fec_packet, guint esi)
+{
+	/* The encoder only supports one flow, and always writes flow ID 0
+	 * into the ADUIs. Source packets do not carry the flow ID, so the
+	 * same value has to be used here to reproduce the source symbol. */
+	guint adu_flow_id = 0;
+	gsize adu_length = gst_buffer_get_size(fec_packet) - FEC_PAYLOAD_ID_LENGTH;
+	guint8 *symbol;
+
+	/* The symbol may already be known, if OpenFEC decoded it before this
+	 * packet arrived. The decoder has no use for it then, and replacing
+	 * the entry would leak the decoded symbol's memory block. */
+	if (state->symbols[esi] != NULL)
+	{
+		GST_LOG_OBJECT(ldpc_fec_dec, "symbol with ESI %u is already known - not feeding it into decoder", esi);
+		return TRUE;
+	}
+
+	/* The ADU is already in the output_adu_table; this only makes its
+	 * symbol known to the decoder. Packets that do not fit the symbol
+	 * length would corrupt the decoding, so skip them. (The ADU itself
+	 * is still output.) */
+	if ((adu_length + 3) > state->encoding_symbol_length)
+	{
+		GST_WARNING_OBJECT(ldpc_fec_dec, "ADU with ESI %u is too large for encoding symbol length %" G_GSIZE_FORMAT " - not using it for decoding", esi, state->encoding_symbol_length);
+		return TRUE;
+	}
+
+	/* Rebuild the ADUI the encoder used as source symbol:
+	 * flow ID (8 bit), ADU length (16 bit big endian), ADU, zero padding */
+	symbol = g_slice_alloc(state->encoding_symbol_length);
+	symbol[0] = adu_flow_id;
+	symbol[1] = (adu_length & 0xFF00) >> 8;
+	symbol[2] = (adu_length & 0x00FF);
+	gst_buffer_extract(fec_packet, 0, symbol + 3, adu_length);
+	memset(symbol + 3 + adu_length, 0, state->encoding_symbol_length - 3 - adu_length);
+
+	state->symbols[esi] = symbol;
+
+	return gst_ldpc_fec_dec_feed_symbol(ldpc_fec_dec, state, esi);
+}
+
+
+static gboolean gst_ldpc_fec_dec_feed_repair_packet(GstLDPCFECDec *ldpc_fec_dec, GstLDPCFECDecBlockState *state, GstBuffer *fec_packet, guint esi)
+{
+	gsize repair_symbol_length = gst_buffer_get_size(fec_packet) - FEC_PAYLOAD_ID_LENGTH;
+
+	if (repair_symbol_length != state->encoding_symbol_length)
+	{
+		GST_WARNING_OBJECT(ldpc_fec_dec, "repair symbol with ESI %u has length %" G_GSIZE_FORMAT ", expected %" G_GSIZE_FORMAT " - not using it for decoding", esi, repair_symbol_length, state->encoding_symbol_length);
+		return TRUE;
+	}
+
+	/* See gst_ldpc_fec_dec_feed_source_packet() */
+	if (state->symbols[esi] != NULL)
+	{
+		GST_LOG_OBJECT(ldpc_fec_dec, "symbol with ESI %u is already known - not feeding it into decoder", esi);
+		return TRUE;
+	}
+
+	/* The symbol is copied, since OpenFEC may keep using it until the
+	 * session is released, and the packet has to stay unmapped */
+	state->symbols[esi] = g_slice_alloc(state->encoding_symbol_length);
+	gst_buffer_extract(fec_packet, FEC_PAYLOAD_ID_LENGTH, state->symbols[esi], state->encoding_symbol_length);
+
+	return gst_ldpc_fec_dec_feed_symbol(ldpc_fec_dec, state, esi);
+}
+
+
+static gboolean gst_ldpc_fec_dec_feed_symbol(GstLDPCFECDec *ldpc_fec_dec, GstLDPCFECDecBlockState *state, guint esi)
+{
+	of_status_t status;
+
+	if ((status = of_decode_with_new_symbol(state->session, state->symbols[esi], esi)) != OF_STATUS_OK)
+	{
+		GST_ERROR_OBJECT(ldpc_fec_dec, "could not decode with new symbol %u: %s", esi, gst_ldpc_fec_dec_get_status_name(status));
+		CHECK_IF_FATAL_ERROR(ldpc_fec_dec, status);
+		return FALSE;
+	}
+
+	GST_LOG_OBJECT(ldpc_fec_dec, "fed symbol with ESI %u into decoder", esi);
+
+	return TRUE;
+}
+
+
+static void* gst_ldpc_fec_dec_decoded_symbol_callback(void *context, G_GNUC_UNUSED UINT32 size, UINT32 esi)
+{
+	GstLDPCFECDecBlockState *state = (GstLDPCFECDecBlockState *)context;
+
+	/* Called by OpenFEC when it recovers a symbol. Symbols that were
+	 * fed into the decoder are not decoded again, so the entry should
+	 * be unused. Should an entry be in use anyway, its memory block is
+	 * reused instead of being replaced (and leaked); OpenFEC writes the
+	 * same symbol contents into it. */
+	if (state->symbols[esi] == NULL)
+		state->symbols[esi] = g_slice_alloc(state->encoding_symbol_length);
+
+	return state->symbols[esi];
+}
+
+
+static gchar const * gst_ldpc_fec_dec_get_status_name(of_status_t status)
+{
+	switch (status)
+	{
+		case OF_STATUS_OK: return "ok";
+		case OF_STATUS_FAILURE: return "failure";
+		case OF_STATUS_ERROR: return "error";
+		case OF_STATUS_FATAL_ERROR: return "fatal error";
+		default: return "<unknown>";
+	}
+}
@@ -0,0 +1,74 @@
+/* RFC 6816-based forward error correction based on LDPC-Staircase for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef GSTFECFRAME_LDPC_STAIRCASE_LDPCFECDEC_H
+#define GSTFECFRAME_LDPC_STAIRCASE_LDPCFECDEC_H
+
+#include <gst/gst.h>
+#include "reed-solomon/gstrsfecdec.h"
+
+
+G_BEGIN_DECLS
+
+
+typedef struct _GstLDPCFECDec GstLDPCFECDec;
+typedef struct _GstLDPCFECDecClass GstLDPCFECDecClass;
+
+
+#define GST_TYPE_LDPC_FEC_DEC             (gst_ldpc_fec_dec_get_type())
+#define GST_LDPC_FEC_DEC(obj)             (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_LDPC_FEC_DEC, GstLDPCFECDec))
+#define GST_LDPC_FEC_DEC_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST((klass), GST_TYPE_LDPC_FEC_DEC, GstLDPCFECDecClass))
+#define GST_LDPC_FEC_DEC_CAST(obj)        ((GstLDPCFECDec *)(obj))
+#define GST_IS_LDPC_FEC_DEC(obj)          (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_LDPC_FEC_DEC))
+#define GST_IS_LDPC_FEC_DEC_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass), GST_TYPE_LDPC_FEC_DEC))
+
+
+/* The LDPC-Staircase decoder reuses the source block management, ADU
+ * output and FEC framing of the Reed-Solomon decoder. Unlike Reed-Solomon,
+ * LDPC-Staircase decodes iteratively: each incoming symbol is passed to
+ * the source block's OpenFEC session right away, and the block is done
+ * as soon as OpenFEC has recovered all missing source symbols. (Since
+ * LDPC-Staircase is not MDS, this usually requires a few more than k
+ * symbols.) The code-construction property
+ * of the base class has no effect here. */
+struct _GstLDPCFECDec
+{
+	GstRSFECDec parent;
+
+	/* Parameters of the parity check matrix (see gstldpcfeccommon.h).
+	 * Like the number of symbols, these can only be modified if
+	 * allocated_encoding_symbol_table == NULL. */
+	guint n1;
+	guint prng_seed;
+};
+
+
+struct _GstLDPCFECDecClass
+{
+	GstRSFECDecClass parent_class;
+};
+
+
+GType gst_ldpc_fec_dec_get_type(void);
+
+
+G_END_DECLS
+
+
+#endif
@@ -0,0 +1,400 @@
+/* RFC 6816-based forward error correction based on LDPC-Staircase for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/**
+ * GstLDPCFECEnc produces FEC source and repair packets like GstRSFECEnc does, except
+ * that the repair symbols are computed with the LDPC-Staircase codes from
+ * RFC 5170, as used by the FECFRAME scheme RFC 6816. LDPC-Staircase is not
+ * MDS (the decoder usually needs a few more than k symbols), but its encoding
+ * and decoding costs grow linearly with the source block size, and a source
+ * block can have up to 50000 encoding symbols. This makes it a good choice for
+ * large source blocks, where Reed-Solomon becomes too slow.
+ *
+ * The ADUI framing, the pads, and the source block generation are the same as
+ * in GstRSFECEnc; see the documentation there for details. The decoder must be
+ * configured with the same number of source and repair symbols, and with the
+ * same N1 and PRNG seed. The latter two are also signaled in the caps.
+ *
+ * The code-construction property of GstRSFECEnc does not apply to LDPC-Staircase.
+ * It must be left at its default value (vandermonde); other values are refused
+ * when the element starts.
+ *
+ * NOTE: RFC 6816 uses a 4-byte Source FEC Payload ID (without the source block
+ * length). Here, the 6-byte m=16 FEC payload ID of GstRSFECEnc is used for both
+ * source and repair packets instead, so the source packets are not interoperable
+ * with other RFC 6816 implementations.
+ */
+
+
+#include <string.h>
+#include "gstldpcfeccommon.h"
+#include "gstldpcfecenc.h"
+
+
+GST_DEBUG_CATEGORY(ldpc_fec_enc_debug);
+#define GST_CAT_DEFAULT ldpc_fec_enc_debug
+
+
+enum
+{
+	PROP_0,
+	PROP_N1,
+	PROP_PRNG_SEED
+};
+
+
+#define FEC_SOURCE_CAPS_STR "application/x-fec-source-flow, encoding-id = (int) 7"
+#define FEC_REPAIR_CAPS_STR "application/x-fec-repair-flow, encoding-id = (int) 7"
+
+
+#define CHECK_IF_FATAL_ERROR(elem, status) \
+	do { \
+		if ((status) == OF_STATUS_FATAL_ERROR) \
+			GST_ELEMENT_ERROR((elem), LIBRARY, FAILED, ("OpenFEC reports fatal error"), (NULL)); \
+	} while (0)
+
+
+/* These replace the templates of the same name from the base class */
+
+static GstStaticPadTemplate static_fecsource_template = GST_STATIC_PAD_TEMPLATE(
+	"fecsource",
+	GST_PAD_SRC,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS(FEC_SOURCE_CAPS_STR)
+);
+
+
+static GstStaticPadTemplate static_fecrepair_template = GST_STATIC_PAD_TEMPLATE(
+	"fecrepair",
+	GST_PAD_SRC,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS(FEC_REPAIR_CAPS_STR)
+);
+
+
+
+
+G_DEFINE_TYPE(GstLDPCFECEnc, gst_ldpc_fec_enc, GST_TYPE_RS_FEC_ENC)
+
+
+
+
+static void gst_ldpc_fec_enc_set_property(GObject *object, guint prop_id, GValue const *value, GParamSpec *pspec);
+static void gst_ldpc_fec_enc_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec);
+
+static guint gst_ldpc_fec_enc_get_payload_id_m(GstRSFECEnc *rs_fec_enc);
+static guint gst_ldpc_fec_enc_get_max_num_encoding_symbols(GstRSFECEnc *rs_fec_enc);
+static gboolean gst_ldpc_fec_enc_check_settings(GstRSFECEnc *rs_fec_enc);
+static gboolean gst_ldpc_fec_enc_uses_openfec_session(GstRSFECEnc *rs_fec_enc);
+static gsize gst_ldpc_fec_enc_get_encoding_symbol_length(GstRSFECEnc *rs_fec_enc, gsize max_adui_length);
+static gboolean gst_ldpc_fec_enc_configure_session(GstRSFECEnc *rs_fec_enc, gsize encoding_symbol_length);
+static gboolean gst_ldpc_fec_enc_build_repair_symbols(GstRSFECEnc *rs_fec_enc, gsize encoding_symbol_length);
+static void gst_ldpc_fec_enc_set_caps_fields(GstRSFECEnc *rs_fec_enc, GstCaps *caps);
+
+static gchar const * gst_ldpc_fec_enc_get_status_name(of_status_t status);
+
+
+
+
+static void gst_ldpc_fec_enc_class_init(GstLDPCFECEncClass *klass)
+{
+	GObjectClass *object_class;
+	GstElementClass *element_class;
+	GstRSFECEncClass *rs_fec_enc_class;
+
+	GST_DEBUG_CATEGORY_INIT(ldpc_fec_enc_debug, "ldpcfecenc", 0, "FECFRAME RFC 6816 LDPC-Staircase scheme encoder");
+
+	object_class = G_OBJECT_CLASS(klass);
+	element_class = GST_ELEMENT_CLASS(klass);
+	rs_fec_enc_class = GST_RS_FEC_ENC_CLASS(klass);
+
+	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_fecsource_template));
+	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_fecrepair_template));
+
+	object_class->set_property  = GST_DEBUG_FUNCPTR(gst_ldpc_fec_enc_set_property);
+	object_class->get_property  = GST_DEBUG_FUNCPTR(gst_ldpc_fec_enc_get_property);
+
+	rs_fec_enc_class->openfec_codec_id             = OF_CODEC_LDPC_STAIRCASE_STABLE;
+	rs_fec_enc_class->supports_num_symbols_changes = FALSE;
+	rs_fec_enc_class->get_payload_id_m             = GST_DEBUG_FUNCPTR(gst_ldpc_fec_enc_get_payload_id_m);
+	rs_fec_enc_class->get_max_num_encoding_symbols = GST_DEBUG_FUNCPTR(gst_ldpc_fec_enc_get_max_num_encoding_symbols);
+	rs_fec_enc_class->check_settings               = GST_DEBUG_FUNCPTR(gst_ldpc_fec_enc_check_settings);
+	rs_fec_enc_class->uses_openfec_session         = GST_DEBUG_FUNCPTR(gst_ldpc_fec_enc_uses_openfec_session);
+	rs_fec_enc_class->get_encoding_symbol_length   = GST_DEBUG_FUNCPTR(gst_ldpc_fec_enc_get_encoding_symbol_length);
+	rs_fec_enc_class->configure_session            = GST_DEBUG_FUNCPTR(gst_ldpc_fec_enc_configure_session);
+	rs_fec_enc_class->build_repair_symbols         = GST_DEBUG_FUNCPTR(gst_ldpc_fec_enc_build_repair_symbols);
+	rs_fec_enc_class->set_caps_fields              = GST_DEBUG_FUNCPTR(gst_ldpc_fec_enc_set_caps_fields);
+
+	g_object_class_install_property(
+		object_class,
+		PROP_N1,
+		g_param_spec_uint(
+			"n1",
+			"N1",
+			"Number of \"1\"s per column in the left side of the parity check matrix (the decoder must use the same value)",
+			GST_LDPC_FEC_MIN_N1, GST_LDPC_FEC_MAX_N1,
+			GST_LDPC_FEC_DEFAULT_N1,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_PRNG_SEED,
+		g_param_spec_uint(
+			"prng-seed",
+			"PRNG seed",
+			"Seed for the pseudo random number generator that creates the parity check matrix (the decoder must use the same value)",
+			GST_LDPC_FEC_MIN_PRNG_SEED, GST_LDPC_FEC_MAX_PRNG_SEED,
+			GST_LDPC_FEC_DEFAULT_PRNG_SEED,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+
+	gst_element_class_set_static_metadata(
+		element_class,
+		"LDPC-Staircase forward error correction encoder",
+		"Codec/Encoder/Network",
+		"Produces forward-error erasure coding based on the FECFRAME LDPC-Staircase scheme RFC 6816",
+		"Carlos Rafael Giani <dv@pseudoterminal.org>"
+	);
+}
+
+
+static void gst_ldpc_fec_enc_init(GstLDPCFECEnc *ldpc_fec_enc)
+{
+	ldpc_fec_enc->n1 = GST_LDPC_FEC_DEFAULT_N1;
+	ldpc_fec_enc->prng_seed = GST_LDPC_FEC_DEFAULT_PRNG_SEED;
+}
+
+
+static void gst_ldpc_fec_enc_set_property(GObject *object, guint prop_id, GValue const *value, GParamSpec *pspec)
+{
+	GstLDPCFECEnc *ldpc_fec_enc = GST_LDPC_FEC_ENC(object);
+	GstRSFECEnc *rs_fec_enc = GST_RS_FEC_ENC(object);
+
+	switch (prop_id)
+	{
+		case PROP_N1:
+			GST_OBJECT_LOCK(object);
+			if (!(rs_fec_enc->initialized))
+				ldpc_fec_enc->n1 = g_value_get_uint(value);
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set N1 after initializing OpenFEC"), (NULL));
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_PRNG_SEED:
+			GST_OBJECT_LOCK(object);
+			if (!(rs_fec_enc->initialized))
+				ldpc_fec_enc->prng_seed = g_value_get_uint(value);
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set PRNG seed after initializing OpenFEC"), (NULL));
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		default:
+			/* The remaining properties belong to the base class */
+			G_OBJECT_CLASS(gst_ldpc_fec_enc_parent_class)->set_property(object, prop_id, value, pspec);
+			break;
+	}
+}
+
+
+static void gst_ldpc_fec_enc_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec)
+{
+	GstLDPCFECEnc *ldpc_fec_enc = GST_LDPC_FEC_ENC(object);
+
+	switch (prop_id)
+	{
+		case PROP_N1:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, ldpc_fec_enc->n1);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_PRNG_SEED:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, ldpc_fec_enc->prng_seed);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		default:
+			G_OBJECT_CLASS(gst_ldpc_fec_enc_parent_class)->get_property(object, prop_id, value, pspec);
+			break;
+	}
+}
+
+
+static guint gst_ldpc_fec_enc_get_payload_id_m(G_GNUC_UNUSED GstRSFECEnc *rs_fec_enc)
+{
+	return GST_LDPC_FEC_PAYLOAD_ID_M;
+}
+
+
+static guint gst_ldpc_fec_enc_get_max_num_encoding_symbols(G_GNUC_UNUSED GstRSFECEnc *rs_fec_enc)
+{
+	return GST_LDPC_FEC_MAX_NUM_ENCODING_SYMBOLS;
+}
+
+
+static gboolean gst_ldpc_fec_enc_check_settings(GstRSFECEnc *rs_fec_enc)
+{
+	GstLDPCFECEnc *ldpc_fec_enc = GST_LDPC_FEC_ENC(rs_fec_enc);
+	gchar const *error_desc;
+
+	/* The code construction property is inherited from GstRSFECEnc, but
+	 * LDPC-Staircase has no such choice. Refuse other values instead of
+	 * silently ignoring them, since the user might expect them to work. */
+	if (rs_fec_enc->code_construction != GST_RS_FEC_CODE_CONSTRUCTION_VANDERMONDE)
+	{
+		GST_ELEMENT_ERROR(
+			rs_fec_enc, LIBRARY, SETTINGS,
+			("code construction cannot be changed"),
+			("LDPC-Staircase does not support code construction %s", gst_rs_fec_code_construction_get_name(rs_fec_enc->code_construction))
+		);
+		return FALSE;
+	}
+
+	if (!gst_ldpc_fec_check_parameters(rs_fec_enc->num_source_symbols, rs_fec_enc->num_repair_symbols, ldpc_fec_enc->n1, &error_desc))
+	{
+		GST_ELEMENT_ERROR(
+			rs_fec_enc, LIBRARY, SETTINGS,
+			("invalid LDPC-Staircase parameters"),
+			("%s  (number of source symbols: %u  repair symbols: %u  N1: %u)", error_desc, rs_fec_enc->num_source_symbols, rs_fec_enc->num_repair_symbols, ldpc_fec_enc->n1)
+		);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+static gboolean gst_ldpc_fec_enc_uses_openfec_session(G_GNUC_UNUSED GstRSFECEnc *rs_fec_enc)
+{
+	/* The repair symbols are always built by OpenFEC */
+	return TRUE;
+}
+
+
+static gsize gst_ldpc_fec_enc_get_encoding_symbol_length(G_GNUC_UNUSED GstRSFECEnc *rs_fec_enc, gsize max_adui_length)
+{
+	/* OpenFEC's LDPC-Staircase codec works with symbols of any length */
+	return max_adui_length;
+}
+
+
+static gboolean gst_ldpc_fec_enc_configure_session(GstRSFECEnc *rs_fec_enc, gsize encoding_symbol_length)
+{
+	GstLDPCFECEnc *ldpc_fec_enc = GST_LDPC_FEC_ENC(rs_fec_enc);
+	of_status_t status;
+	of_ldpc_parameters_t params;
+
+	/* Unlike the Reed-Solomon codec, the LDPC-Staircase codec builds its
+	 * parity check matrix when the FEC parameters are set, and cannot be
+	 * configured again afterwards. If the session was configured before
+	 * (= if an encoding symbol length is set), replace it with a new one. */
+	if (rs_fec_enc->encoding_symbol_length != 0)
+	{
+		if ((status = of_release_codec_instance(rs_fec_enc->openfec_session)) != OF_STATUS_OK)
+		{
+			GST_ERROR_OBJECT(rs_fec_enc, "could not release codec instance: %s", gst_ldpc_fec_enc_get_status_name(status));
+			CHECK_IF_FATAL_ERROR(rs_fec_enc, status);
+			return FALSE;
+		}
+
+		if ((status = of_create_codec_instance(&(rs_fec_enc->openfec_session), OF_CODEC_LDPC_STAIRCASE_STABLE, OF_ENCODER, 0)) != OF_STATUS_OK)
+		{
+			GST_ERROR_OBJECT(rs_fec_enc, "could not create codec instance: %s", gst_ldpc_fec_enc_get_status_name(status));
+			rs_fec_enc->openfec_session = NULL;
+			CHECK_IF_FATAL_ERROR(rs_fec_enc, status);
+			return FALSE;
+		}
+	}
+
+	memset(&params, 0, sizeof(params));
+	params.nb_source_symbols = rs_fec_enc->num_source_symbols;
+	params.nb_repair_symbols = rs_fec_enc->num_repair_symbols;
+	params.encoding_symbol_length = encoding_symbol_length;
+	params.prng_seed = ldpc_fec_enc->prng_seed;
+	params.N1 = ldpc_fec_enc->n1;
+
+	if ((status = of_set_fec_parameters(rs_fec_enc->openfec_session, (of_parameters_t *)(&params))) != OF_STATUS_OK)
+	{
+		GST_ERROR_OBJECT(rs_fec_enc, "could not set FEC parameters: %s", gst_ldpc_fec_enc_get_status_name(status));
+		CHECK_IF_FATAL_ERROR(rs_fec_enc, status);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+static gboolean gst_ldpc_fec_enc_build_repair_symbols(GstRSFECEnc *rs_fec_enc, G_GNUC_UNUSED gsize encoding_symbol_length)
+{
+	guint i;
+
+	/* The staircase structure makes each repair symbol depend on
+	 * the previous one, so they must be built in ascending ESI order.
+	 * Only the ones that are actually sent are built. */
+	for (i = 0; i < rs_fec_enc->cur_num_repair_symbols; ++i)
+	{
+		guint esi = i + rs_fec_enc->num_source_symbols; /* ESI = encoding symbol ID */
+		of_status_t status;
+
+		if ((status = of_build_repair_symbol(rs_fec_enc->openfec_session, rs_fec_enc->encoding_symbol_table, esi)) != OF_STATUS_OK)
+		{
+			GST_ERROR_OBJECT(rs_fec_enc, "could not build repair symbol #%u: %s", i, gst_ldpc_fec_enc_get_status_name(status));
+			CHECK_IF_FATAL_ERROR(rs_fec_enc, status);
+			return FALSE;
+		}
+
+		GST_LOG_OBJECT(rs_fec_enc, "built repair symbol #%u", i);
+	}
+
+	return TRUE;
+}
+
+
+static void gst_ldpc_fec_enc_set_caps_fields(GstRSFECEnc *rs_fec_enc, GstCaps *caps)
+{
+	GstLDPCFECEnc *ldpc_fec_enc = GST_LDPC_FEC_ENC(rs_fec_enc);
+
+	/* A decoder with a different N1 or PRNG seed would use a different
+	 * parity check matrix, and produce garbage. Add these values to the
+	 * caps to make sure such a decoder fails to negotiate instead. */
+	gst_caps_set_simple(
+		caps,
+		GST_LDPC_FEC_N1_CAPS_FIELD, G_TYPE_UINT, ldpc_fec_enc->n1,
+		GST_LDPC_FEC_PRNG_SEED_CAPS_FIELD, G_TYPE_UINT, ldpc_fec_enc->prng_seed,
+		NULL
+	);
+}
+
+
+static gchar const * gst_ldpc_fec_enc_get_status_name(of_status_t status)
+{
+	switch (status)
+	{
+		case OF_STATUS_OK: return "ok";
+		case OF_STATUS_FAILURE: return "failure";
+		case OF_STATUS_ERROR: return "error";
+		case OF_STATUS_FATAL_ERROR: return "fatal error";
+		default: return "<unknown>";
+	}
+}
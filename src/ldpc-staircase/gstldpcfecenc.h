@@ -0,0 +1,70 @@
+/* RFC 6816-based forward error correction based on LDPC-Staircase for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef GSTFECFRAME_LDPC_STAIRCASE_LDPCFECENC_H
+#define GSTFECFRAME_LDPC_STAIRCASE_LDPCFECENC_H
+
+#include <gst/gst.h>
+#include "reed-solomon/gstrsfecenc.h"
+
+
+G_BEGIN_DECLS
+
+
+typedef struct _GstLDPCFECEnc GstLDPCFECEnc;
+typedef struct _GstLDPCFECEncClass GstLDPCFECEncClass;
+
+
+#define GST_TYPE_LDPC_FEC_ENC             (gst_ldpc_fec_enc_get_type())
+#define GST_LDPC_FEC_ENC(obj)             (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_LDPC_FEC_ENC, GstLDPCFECEnc))
+#define GST_LDPC_FEC_ENC_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST((klass), GST_TYPE_LDPC_FEC_ENC, GstLDPCFECEncClass))
+#define GST_LDPC_FEC_ENC_CAST(obj)        ((GstLDPCFECEnc *)(obj))
+#define GST_IS_LDPC_FEC_ENC(obj)          (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_LDPC_FEC_ENC))
+#define GST_IS_LDPC_FEC_ENC_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass), GST_TYPE_LDPC_FEC_ENC))
+
+
+/* The LDPC-Staircase encoder reuses the ADU handling, source block
+ * generation and FEC framing of the Reed-Solomon encoder. Only the
+ * repair symbol computation differs. The code-construction property
+ * of the base class has no effect here. */
+struct _GstLDPCFECEnc
+{
+	GstRSFECEnc parent;
+
+	/* Parameters of the parity check matrix (see gstldpcfeccommon.h).
+	 * Like the number of symbols, these can only be modified if
+	 * initialized is FALSE. */
+	guint n1;
+	guint prng_seed;
+};
+
+
+struct _GstLDPCFECEncClass
+{
+	GstRSFECEncClass parent_class;
+};
+
+
+GType gst_ldpc_fec_enc_get_type(void);
+
+
+G_END_DECLS
+
+
+#endif
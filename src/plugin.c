@@ -20,6 +20,14 @@
 #include <gst/gst.h>
 #include "reed-solomon/gstrsfecenc.h"
 #include "reed-solomon/gstrsfecdec.h"
+#include "ldpc-staircase/gstldpcfecenc.h"
+#include "ldpc-staircase/gstldpcfecdec.h"
+#include "rlc/gstrlcfecenc.h"
+#include "rlc/gstrlcfecdec.h"
+#include "xor/gstxorfecenc.h"
+#include "xor/gstxorfecdec.h"
+#include "raptorq/gstraptorqfecenc.h"
+#include "raptorq/gstraptorqfecdec.h"
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -31,6 +39,14 @@ static gboolean plugin_init(GstPlugin *plugin)
 	gboolean ret = TRUE;
 	ret = ret && gst_element_register(plugin, "rsfecenc", GST_RANK_NONE, gst_rs_fec_enc_get_type());
 	ret = ret && gst_element_register(plugin, "rsfecdec", GST_RANK_NONE, gst_rs_fec_dec_get_type());
+	ret = ret && gst_element_register(plugin, "ldpcfecenc", GST_RANK_NONE, gst_ldpc_fec_enc_get_type());
+	ret = ret && gst_element_register(plugin, "ldpcfecdec", GST_RANK_NONE, gst_ldpc_fec_dec_get_type());
+	ret = ret && gst_element_register(plugin, "rlcfecenc", GST_RANK_NONE, gst_rlc_fec_enc_get_type());
+	ret = ret && gst_element_register(plugin, "rlcfecdec", GST_RANK_NONE, gst_rlc_fec_dec_get_type());
+	ret = ret && gst_element_register(plugin, "xorfecenc", GST_RANK_NONE, gst_xor_fec_enc_get_type());
+	ret = ret && gst_element_register(plugin, "xorfecdec", GST_RANK_NONE, gst_xor_fec_dec_get_type());
+	ret = ret && gst_element_register(plugin, "raptorqfecenc", GST_RANK_NONE, gst_raptorq_fec_enc_get_type());
+	ret = ret && gst_element_register(plugin, "raptorqfecdec", GST_RANK_NONE, gst_raptorq_fec_dec_get_type());
 	return ret;
 }
 
@@ -0,0 +1,1080 @@
+/* RaptorQ-style rateless forward error correction for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include <string.h>
+#include "common/gstgf256.h"
+#include "gstraptorqcode.h"
+
+
+/* Minimum number of HDPC symbols. See gst_raptorq_code_new() for
+ * how the actual number is computed. */
+#define MIN_NUM_HDPC_SYMBOLS 10
+/* Added to the number of HDPC symbols from RFC 5053 */
+#define EXTRA_NUM_HDPC_SYMBOLS 3
+/* Number of permanently inactive symbols (besides the HDPC ones)
+ * per sqrt(K); see gst_raptorq_code_new() */
+#define PI_SYMBOLS_PER_SQRT_K 1
+/* LT degrees are limited to this value (see degree_table) */
+#define MAX_LT_DEGREE 40
+/* Each LT row additionally contains 2 or 3 permanently inactive columns */
+#define MAX_PI_DEGREE 3
+/* If no systematic seed below this value produces an invertible
+ * constraint matrix, no code is constructed for that K */
+#define MAX_SYSTEMATIC_SEED 256
+/* How many codes are kept in the cache. Applications typically use
+ * only one or two different block sizes, so a few entries suffice. */
+#define CODE_CACHE_SIZE 8
+
+#define INVALID_INDEX G_MAXUINT
+/* Row states; any other value is the column the row is the pivot of */
+#define ROW_PENDING (INVALID_INDEX)
+#define ROW_DENSE (INVALID_INDEX - 1)
+
+
+/* Operation on the symbol slots:
+ *   dst == src  : slot[dst] = coef * slot[dst]
+ *   coef == 1   : slot[dst] ^= slot[src]
+ *   otherwise   : slot[dst] ^= coef * slot[src]
+ * The solver records these while working on the constraint matrix; by
+ * replaying them on the symbol data, the intermediate symbols are
+ * computed without having to look at the matrix again. */
+typedef struct
+{
+	guint32 dst, src;
+	guint8 coef;
+}
+GstRaptorQSymbolOp;
+
+
+struct _GstRaptorQCode
+{
+	volatile gint ref_count;
+
+	guint num_source_symbols; /* K */
+	guint num_ldpc_symbols; /* S */
+	guint num_hdpc_symbols; /* H */
+	guint num_intermediate_symbols; /* L = K+S+H */
+	guint num_pi_symbols; /* P */
+	guint num_lt_symbols; /* W = L-P */
+	guint lt_prime; /* smallest prime >= W */
+	guint pi_prime; /* smallest prime >= P */
+	guint systematic_seed;
+
+	/* H rows with K+S coefficients each */
+	guint8 *hdpc_coefficients;
+
+	/* Encoding schedule. The slots are laid out as described in
+	 * gst_raptorq_code_solve(). The intermediate symbol i ends up in
+	 * slot encoding_column_slots[i]. */
+	GstRaptorQSymbolOp *encoding_ops;
+	guint num_encoding_ops;
+	guint *encoding_column_slots;
+};
+
+
+/* Sparse binary rows: the S LDPC rows, followed by one LT row per
+ * encoding symbol. The columns of row i are stored in
+ * columns[offsets[i]] ... columns[offsets[i+1]-1]. */
+typedef struct
+{
+	guint num_rows;
+	guint *offsets;
+	guint *columns;
+}
+GstRaptorQSparseRows;
+
+
+/* State of gst_raptorq_code_solve() */
+typedef struct
+{
+	GstRaptorQCode const *code;
+	GstRaptorQSparseRows const *rows;
+	GArray *ops;
+
+	/* Column -> rows adjacency, in the same format as the rows */
+	guint *col_offsets, *col_rows;
+
+	/* Number of active columns per row, and the row states */
+	guint *active_degrees;
+	guint *row_states;
+	/* Per-row bitsets over the inactive columns. Bitsets grow on
+	 * demand, since the number of inactive columns is not known
+	 * in advance. */
+	guint64 **row_bits;
+	guint *row_num_words;
+
+	guint *column_pivot_rows, *column_inactive_indices;
+	guint *inactive_columns, num_inactive;
+	/* Pivot rows, in the order they were chosen */
+	guint *pivot_rows, num_pivots;
+	/* Rows whose active degree dropped to 1 */
+	guint *stack, stack_size;
+
+	guint num_unresolved;
+}
+GstRaptorQSolver;
+
+
+/* Degree distribution of the LT code, taken from RFC 5053 section 5.4.4.2.
+ * A 20-bit random value v selects the degree degree_table[i].degree of the
+ * first entry with v < degree_table[i].threshold. */
+static struct
+{
+	guint32 threshold;
+	guint degree;
+}
+const degree_table[] =
+{
+	{   10241,  1 },
+	{  491582,  2 },
+	{  712794,  3 },
+	{  831695,  4 },
+	{  948446, 10 },
+	{ 1032189, 11 },
+	{ 1048576, 40 }
+};
+
+
+static GMutex code_cache_mutex;
+static GHashTable *code_cache = NULL;
+/* Least recently used code is at the head */
+static GQueue code_cache_lru = G_QUEUE_INIT;
+
+
+
+
+static gboolean gst_raptorq_is_prime(guint value)
+{
+	guint i;
+
+	if (value < 2)
+		return FALSE;
+	for (i = 2; (i * i) <= value; ++i)
+	{
+		if ((value % i) == 0)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+
+static guint gst_raptorq_next_prime(guint value)
+{
+	while (!gst_raptorq_is_prime(value))
+		++value;
+	return value;
+}
+
+
+static guint64 gst_raptorq_binomial(guint n, guint k)
+{
+	guint64 result = 1;
+	guint i;
+
+	for (i = 1; i <= k; ++i)
+		result = result * (n - k + i) / i;
+	return result;
+}
+
+
+/* Integer hash with good avalanche behavior. It is the basis of all
+ * pseudo random values used by the code, so that encoder and decoder
+ * always generate the same values on all platforms. */
+static guint32 gst_raptorq_hash(guint32 x)
+{
+	x ^= x >> 16;
+	x *= 0x7FEB352Du;
+	x ^= x >> 15;
+	x *= 0x846CA68Bu;
+	x ^= x >> 16;
+	return x;
+}
+
+
+/* Returns a pseudo random value in the range 0..(m-1), derived from
+ * the seed y and the value index i */
+static guint32 gst_raptorq_rand(guint32 y, guint32 i, guint32 m)
+{
+	return gst_raptorq_hash(y ^ gst_raptorq_hash(i + 0x9E3779B9u)) % m;
+}
+
+
+/* Picks num_columns distinct values out of 0..(range-1), and stores
+ * base + value in columns. Like in RFC 5053, the values are visited by
+ * stepping through 0..(prime-1) with stride a, skipping values >= range.
+ * Since prime is a prime >= range, no value is visited twice before all
+ * values have been visited. */
+static void gst_raptorq_pick_columns(guint *columns, guint num_columns, guint a, guint b, guint range, guint prime, guint base)
+{
+	guint i;
+
+	for (i = 0; i < num_columns; ++i)
+	{
+		if (i > 0)
+			b = (b + a) % prime;
+		while (b >= range)
+			b = (b + a) % prime;
+		columns[i] = base + b;
+	}
+}
+
+
+/* Computes the columns of the LT row of the encoding symbol with the
+ * given ESI. columns must have room for MAX_LT_DEGREE + MAX_PI_DEGREE
+ * entries. Returns the number of columns, which are all distinct.
+ *
+ * Like in RFC 6330, the row consists of a few columns out of the first
+ * W columns, with the degree taken from degree_table, and 2 or 3 columns
+ * out of the P permanently inactive columns. */
+static guint gst_raptorq_code_get_lt_columns(GstRaptorQCode const *code, guint esi, guint *columns)
+{
+	guint32 y, v;
+	guint degree, pi_degree, i;
+	guint W = code->num_lt_symbols;
+	guint P = code->num_pi_symbols;
+
+	y = gst_raptorq_hash(gst_raptorq_hash(code->num_source_symbols ^ (code->systematic_seed << 16)) + esi);
+
+	v = gst_raptorq_rand(y, 0, 1u << 20);
+	for (i = 0; v >= degree_table[i].threshold; ++i);
+	degree = MIN(degree_table[i].degree, W);
+
+	gst_raptorq_pick_columns(
+		columns, degree,
+		1 + gst_raptorq_rand(y, 1, code->lt_prime - 1), gst_raptorq_rand(y, 2, code->lt_prime),
+		W, code->lt_prime, 0
+	);
+
+	/* Low degree rows get one more permanently inactive column */
+	pi_degree = (degree < 4) ? 3 : 2;
+	gst_raptorq_pick_columns(
+		columns + degree, pi_degree,
+		1 + gst_raptorq_rand(y, 3, code->pi_prime - 1), gst_raptorq_rand(y, 4, code->pi_prime),
+		P, code->pi_prime, W
+	);
+
+	return degree + pi_degree;
+}
+
+
+/* Builds the sparse rows of the constraint matrix for the encoding
+ * symbols with the given ESIs. If esis is NULL, the ESIs 0..num_symbols-1
+ * are used. */
+static void gst_raptorq_code_build_sparse_rows(GstRaptorQCode const *code, guint num_symbols, guint const *esis, GstRaptorQSparseRows *rows)
+{
+	guint S = code->num_ldpc_symbols;
+	guint P = code->num_pi_symbols;
+	guint W = code->num_lt_symbols;
+	guint B = W - S;
+	guint i, j, num_columns;
+	guint *counts;
+	guint lt_columns[MAX_LT_DEGREE + MAX_PI_DEGREE];
+
+	rows->num_rows = S + num_symbols;
+	rows->offsets = g_malloc((rows->num_rows + 1) * sizeof(guint));
+
+	/* First pass: count the columns of each row */
+
+	/* The first B = W-S columns appear in three LDPC rows each, like in
+	 * RFC 5053 section 5.4.2.3. LDPC row j additionally contains column
+	 * B+j (the LDPC symbol j) and, like in RFC 6330 section 5.3.3.3, two
+	 * permanently inactive columns. */
+	counts = rows->offsets + 1;
+	for (j = 0; j < S; ++j)
+		counts[j] = 3;
+	for (i = 0; i < B; ++i)
+	{
+		guint a = 1 + (i / S) % (S - 1);
+		guint b = i % S;
+		counts[b]++;
+		b = (b + a) % S;
+		counts[b]++;
+		b = (b + a) % S;
+		counts[b]++;
+	}
+	for (i = 0; i < num_symbols; ++i)
+		counts[S + i] = gst_raptorq_code_get_lt_columns(code, (esis != NULL) ? esis[i] : i, lt_columns);
+
+	rows->offsets[0] = 0;
+	for (i = 0; i < rows->num_rows; ++i)
+		rows->offsets[i + 1] += rows->offsets[i];
+	num_columns = rows->offsets[rows->num_rows];
+
+	/* Second pass: fill in the columns. counts is reused as fill
+	 * position per row. */
+	rows->columns = g_malloc(num_columns * sizeof(guint));
+	counts = g_malloc(rows->num_rows * sizeof(guint));
+	memcpy(counts, rows->offsets, rows->num_rows * sizeof(guint));
+
+	for (i = 0; i < B; ++i)
+	{
+		guint a = 1 + (i / S) % (S - 1);
+		guint b = i % S;
+		rows->columns[counts[b]++] = i;
+		b = (b + a) % S;
+		rows->columns[counts[b]++] = i;
+		b = (b + a) % S;
+		rows->columns[counts[b]++] = i;
+	}
+	for (j = 0; j < S; ++j)
+	{
+		rows->columns[counts[j]++] = B + j;
+		rows->columns[counts[j]++] = W + (j % P);
+		rows->columns[counts[j]++] = W + ((j + 1) % P);
+	}
+	for (i = 0; i < num_symbols; ++i)
+		gst_raptorq_code_get_lt_columns(code, (esis != NULL) ? esis[i] : i, rows->columns + counts[S + i]);
+
+	g_free(counts);
+}
+
+
+static void gst_raptorq_sparse_rows_free(GstRaptorQSparseRows *rows)
+{
+	g_free(rows->offsets);
+	g_free(rows->columns);
+}
+
+
+static void gst_raptorq_add_op(GArray *ops, guint dst, guint src, guint8 coef)
+{
+	GstRaptorQSymbolOp op;
+	op.dst = dst;
+	op.src = src;
+	op.coef = coef;
+	g_array_append_val(ops, op);
+}
+
+
+static void gst_raptorq_solver_init(GstRaptorQSolver *solver, GstRaptorQCode const *code, GstRaptorQSparseRows const *rows, GArray *ops)
+{
+	guint i, j;
+	guint L = code->num_intermediate_symbols;
+	guint R = rows->num_rows;
+	guint *fill;
+
+	memset(solver, 0, sizeof(GstRaptorQSolver));
+	solver->code = code;
+	solver->rows = rows;
+	solver->ops = ops;
+
+	solver->col_offsets = g_malloc0((L + 1) * sizeof(guint));
+	for (i = 0; i < rows->offsets[R]; ++i)
+		solver->col_offsets[rows->columns[i] + 1]++;
+	for (j = 0; j < L; ++j)
+		solver->col_offsets[j + 1] += solver->col_offsets[j];
+
+	solver->col_rows = g_malloc(rows->offsets[R] * sizeof(guint));
+	fill = g_malloc(L * sizeof(guint));
+	memcpy(fill, solver->col_offsets, L * sizeof(guint));
+	for (i = 0; i < R; ++i)
+	{
+		for (j = rows->offsets[i]; j < rows->offsets[i + 1]; ++j)
+			solver->col_rows[fill[rows->columns[j]]++] = i;
+	}
+	g_free(fill);
+
+	solver->active_degrees = g_malloc(R * sizeof(guint));
+	solver->row_states = g_malloc(R * sizeof(guint));
+	solver->row_bits = g_malloc0(R * sizeof(guint64 *));
+	solver->row_num_words = g_malloc0(R * sizeof(guint));
+	solver->stack = g_malloc(R * sizeof(guint));
+	for (i = 0; i < R; ++i)
+	{
+		solver->active_degrees[i] = rows->offsets[i + 1] - rows->offsets[i];
+		solver->row_states[i] = (solver->active_degrees[i] == 0) ? ROW_DENSE : ROW_PENDING;
+		if (solver->active_degrees[i] == 1)
+			solver->stack[solver->stack_size++] = i;
+	}
+
+	solver->column_pivot_rows = g_malloc(L * sizeof(guint));
+	solver->column_inactive_indices = g_malloc(L * sizeof(guint));
+	for (j = 0; j < L; ++j)
+	{
+		solver->column_pivot_rows[j] = INVALID_INDEX;
+		solver->column_inactive_indices[j] = INVALID_INDEX;
+	}
+	solver->inactive_columns = g_malloc(L * sizeof(guint));
+	solver->pivot_rows = g_malloc(L * sizeof(guint));
+
+	solver->num_unresolved = L;
+}
+
+
+static void gst_raptorq_solver_cleanup(GstRaptorQSolver *solver)
+{
+	guint i;
+
+	for (i = 0; i < solver->rows->num_rows; ++i)
+		g_free(solver->row_bits[i]);
+	g_free(solver->row_bits);
+	g_free(solver->row_num_words);
+	g_free(solver->col_offsets);
+	g_free(solver->col_rows);
+	g_free(solver->active_degrees);
+	g_free(solver->row_states);
+	g_free(solver->stack);
+	g_free(solver->column_pivot_rows);
+	g_free(solver->column_inactive_indices);
+	g_free(solver->inactive_columns);
+	g_free(solver->pivot_rows);
+}
+
+
+static guint gst_raptorq_solver_get_row_slot(GstRaptorQSolver const *solver, guint row)
+{
+	/* The HDPC slots sit between the LDPC and the LT rows */
+	return (row < solver->code->num_ldpc_symbols) ? row : (row + solver->code->num_hdpc_symbols);
+}
+
+
+static gboolean gst_raptorq_solver_is_active(GstRaptorQSolver const *solver, guint column)
+{
+	return (solver->column_pivot_rows[column] == INVALID_INDEX) && (solver->column_inactive_indices[column] == INVALID_INDEX);
+}
+
+
+/* Called whenever a pending row loses an active column */
+static void gst_raptorq_solver_decrement_degree(GstRaptorQSolver *solver, guint row)
+{
+	solver->active_degrees[row]--;
+	if (solver->active_degrees[row] == 1)
+		solver->stack[solver->stack_size++] = row;
+	else if (solver->active_degrees[row] == 0)
+		solver->row_states[row] = ROW_DENSE;
+}
+
+
+static void gst_raptorq_solver_inactivate(GstRaptorQSolver *solver, guint column)
+{
+	guint i;
+	guint index = solver->num_inactive++;
+
+	solver->column_inactive_indices[column] = index;
+	solver->inactive_columns[index] = column;
+	solver->num_unresolved--;
+
+	for (i = solver->col_offsets[column]; i < solver->col_offsets[column + 1]; ++i)
+	{
+		guint row = solver->col_rows[i];
+		guint min_num_words = index / 64 + 1;
+
+		if (solver->row_states[row] != ROW_PENDING)
+			continue;
+
+		if (solver->row_num_words[row] < min_num_words)
+		{
+			solver->row_bits[row] = g_realloc(solver->row_bits[row], min_num_words * sizeof(guint64));
+			memset(solver->row_bits[row] + solver->row_num_words[row], 0, (min_num_words - solver->row_num_words[row]) * sizeof(guint64));
+			solver->row_num_words[row] = min_num_words;
+		}
+		solver->row_bits[row][index / 64] |= G_GUINT64_CONSTANT(1) << (index % 64);
+
+		gst_raptorq_solver_decrement_degree(solver, row);
+	}
+}
+
+
+/* Makes the row the pivot of its one remaining active column */
+static void gst_raptorq_solver_pivot(GstRaptorQSolver *solver, guint row)
+{
+	GstRaptorQSparseRows const *rows = solver->rows;
+	guint i, w, column = INVALID_INDEX;
+
+	for (i = rows->offsets[row]; i < rows->offsets[row + 1]; ++i)
+	{
+		if (gst_raptorq_solver_is_active(solver, rows->columns[i]))
+		{
+			column = rows->columns[i];
+			break;
+		}
+	}
+	g_assert(column != INVALID_INDEX);
+
+	solver->row_states[row] = column;
+	solver->column_pivot_rows[column] = row;
+	solver->pivot_rows[solver->num_pivots++] = row;
+	solver->num_unresolved--;
+
+	/* Eliminate the column from all other pending rows. The pivot row
+	 * only consists of the pivot column and inactive columns, so only
+	 * the bitsets need to be combined. */
+	for (i = solver->col_offsets[column]; i < solver->col_offsets[column + 1]; ++i)
+	{
+		guint other = solver->col_rows[i];
+
+		if ((other == row) || (solver->row_states[other] != ROW_PENDING))
+			continue;
+
+		gst_raptorq_add_op(solver->ops, gst_raptorq_solver_get_row_slot(solver, other), gst_raptorq_solver_get_row_slot(solver, row), 1);
+
+		if (solver->row_num_words[other] < solver->row_num_words[row])
+		{
+			solver->row_bits[other] = g_realloc(solver->row_bits[other], solver->row_num_words[row] * sizeof(guint64));
+			memset(solver->row_bits[other] + solver->row_num_words[other], 0, (solver->row_num_words[row] - solver->row_num_words[other]) * sizeof(guint64));
+			solver->row_num_words[other] = solver->row_num_words[row];
+		}
+		for (w = 0; w < solver->row_num_words[row]; ++w)
+			solver->row_bits[other][w] ^= solver->row_bits[row][w];
+
+		gst_raptorq_solver_decrement_degree(solver, other);
+	}
+}
+
+
+/* Phase 1 of gst_raptorq_code_solve() */
+static void gst_raptorq_solver_peel(GstRaptorQSolver *solver)
+{
+	GstRaptorQSparseRows const *rows = solver->rows;
+	guint i, j;
+	guint L = solver->code->num_intermediate_symbols;
+	guint R = rows->num_rows;
+
+	/* The permanently inactive columns */
+	for (j = solver->code->num_lt_symbols; j < L; ++j)
+		gst_raptorq_solver_inactivate(solver, j);
+
+	while (solver->num_unresolved > 0)
+	{
+		guint row = INVALID_INDEX;
+
+		while (solver->stack_size > 0)
+		{
+			guint candidate = solver->stack[--solver->stack_size];
+			if ((solver->row_states[candidate] == ROW_PENDING) && (solver->active_degrees[candidate] == 1))
+			{
+				row = candidate;
+				break;
+			}
+		}
+
+		if (row != INVALID_INDEX)
+		{
+			gst_raptorq_solver_pivot(solver, row);
+			continue;
+		}
+
+		/* Stuck; inactivate all active columns except one of the
+		 * pending row with the fewest active columns. That row can
+		 * then be used as pivot. */
+		for (i = 0; i < R; ++i)
+		{
+			if ((solver->row_states[i] == ROW_PENDING) && ((row == INVALID_INDEX) || (solver->active_degrees[i] < solver->active_degrees[row])))
+				row = i;
+		}
+
+		if (row != INVALID_INDEX)
+		{
+			gboolean first = TRUE;
+			for (i = rows->offsets[row]; i < rows->offsets[row + 1]; ++i)
+			{
+				guint column = rows->columns[i];
+				if (!gst_raptorq_solver_is_active(solver, column))
+					continue;
+				if (first)
+					first = FALSE;
+				else
+					gst_raptorq_solver_inactivate(solver, column);
+			}
+		}
+		else
+		{
+			/* No pending rows left; the remaining columns can
+			 * only be determined by the HDPC rows */
+			for (j = 0; j < L; ++j)
+			{
+				if (gst_raptorq_solver_is_active(solver, j))
+					gst_raptorq_solver_inactivate(solver, j);
+			}
+		}
+	}
+}
+
+
+/* Phases 2 and 3 of gst_raptorq_code_solve() */
+static gboolean gst_raptorq_solver_solve_inactive(GstRaptorQSolver *solver, guint *column_slots)
+{
+	GstRaptorQCode const *code = solver->code;
+	guint H = code->num_hdpc_symbols;
+	guint num_hdpc_columns = code->num_intermediate_symbols - H;
+	guint I = solver->num_inactive;
+	guint i, j, w, num_dense, num_rows;
+	guint *dense_rows, *dense_slots, *inactive_pivots;
+	guint8 *dense_matrix, *hdpc_row;
+	gboolean *used;
+	gboolean ok = FALSE;
+
+	num_dense = 0;
+	dense_rows = g_malloc((solver->rows->num_rows + H) * sizeof(guint));
+	for (i = 0; i < solver->rows->num_rows; ++i)
+	{
+		if (solver->row_states[i] == ROW_DENSE)
+			dense_rows[num_dense++] = i;
+	}
+
+	num_rows = num_dense + H;
+	if (num_rows < I)
+	{
+		g_free(dense_rows);
+		return FALSE;
+	}
+
+	dense_matrix = g_malloc0((gsize)num_rows * MAX(I, 1));
+	dense_slots = g_malloc(num_rows * sizeof(guint));
+	inactive_pivots = g_malloc(MAX(I, 1) * sizeof(guint));
+	used = g_malloc0(num_rows * sizeof(gboolean));
+	hdpc_row = g_malloc(code->num_intermediate_symbols);
+
+	/* Dense rows from phase 1 only contain inactive columns */
+	for (i = 0; i < num_dense; ++i)
+	{
+		guint row = dense_rows[i];
+		guint8 *dense_row = dense_matrix + (gsize)i * I;
+
+		dense_slots[i] = gst_raptorq_solver_get_row_slot(solver, row);
+		for (j = 0; j < I; ++j)
+		{
+			if ((j / 64) < solver->row_num_words[row])
+				dense_row[j] = (solver->row_bits[row][j / 64] >> (j % 64)) & 1;
+		}
+	}
+
+	for (i = 0; i < H; ++i)
+	{
+		guint8 *dense_row = dense_matrix + (gsize)(num_dense + i) * I;
+		guint slot = code->num_ldpc_symbols + i;
+
+		dense_slots[num_dense + i] = slot;
+
+		/* HDPC row i: random coefficients for the source and LDPC
+		 * symbols, and the identity for the HDPC symbols */
+		memcpy(hdpc_row, code->hdpc_coefficients + (gsize)i * num_hdpc_columns, num_hdpc_columns);
+		memset(hdpc_row + num_hdpc_columns, 0, H);
+		hdpc_row[num_hdpc_columns + i] = 1;
+
+		/* Substitute the pivot rows. Pivot row p states that its
+		 * pivot column equals slot(p) + (sum of its inactive columns). */
+		for (j = 0; j < solver->num_pivots; ++j)
+		{
+			guint row = solver->pivot_rows[j];
+			guint8 coef = hdpc_row[solver->row_states[row]];
+
+			if (coef == 0)
+				continue;
+
+			gst_raptorq_add_op(solver->ops, slot, gst_raptorq_solver_get_row_slot(solver, row), coef);
+			for (w = 0; w < solver->row_num_words[row]; ++w)
+			{
+				guint64 bits = solver->row_bits[row][w];
+				while (bits != 0)
+				{
+					dense_row[w * 64 + __builtin_ctzll(bits)] ^= coef;
+					bits &= bits - 1;
+				}
+			}
+		}
+
+		for (j = 0; j < I; ++j)
+			dense_row[j] ^= hdpc_row[solver->inactive_columns[j]];
+	}
+
+	/* Phase 2: Gauss-Jordan elimination over the inactive columns */
+	for (j = 0; j < I; ++j)
+	{
+		guint pivot = INVALID_INDEX;
+		guint8 *pivot_row;
+		guint8 inv;
+
+		for (i = 0; i < num_rows; ++i)
+		{
+			if (!used[i] && (dense_matrix[(gsize)i * I + j] != 0))
+			{
+				pivot = i;
+				break;
+			}
+		}
+
+		if (pivot == INVALID_INDEX)
+			goto cleanup;
+
+		used[pivot] = TRUE;
+		inactive_pivots[j] = pivot;
+		pivot_row = dense_matrix + (gsize)pivot * I;
+
+		/* Entries left of column j are zero in the pivot row */
+		inv = gst_fec_gf256_inv(pivot_row[j]);
+		if (inv != 1)
+		{
+			gst_fec_gf256_region_mul(pivot_row + j, pivot_row + j, inv, I - j);
+			gst_raptorq_add_op(solver->ops, dense_slots[pivot], dense_slots[pivot], inv);
+		}
+
+		for (i = 0; i < num_rows; ++i)
+		{
+			guint8 *dense_row = dense_matrix + (gsize)i * I;
+			guint8 coef = dense_row[j];
+
+			if ((i == pivot) || (coef == 0))
+				continue;
+
+			gst_fec_gf256_region_mul_add(dense_row + j, pivot_row + j, coef, I - j);
+			gst_raptorq_add_op(solver->ops, dense_slots[i], dense_slots[pivot], coef);
+		}
+	}
+
+	/* Phase 3: back substitution */
+
+	for (j = 0; j < I; ++j)
+		column_slots[solver->inactive_columns[j]] = dense_slots[inactive_pivots[j]];
+
+	for (j = 0; j < solver->num_pivots; ++j)
+	{
+		guint row = solver->pivot_rows[j];
+		guint slot = gst_raptorq_solver_get_row_slot(solver, row);
+
+		for (w = 0; w < solver->row_num_words[row]; ++w)
+		{
+			guint64 bits = solver->row_bits[row][w];
+			while (bits != 0)
+			{
+				gst_raptorq_add_op(solver->ops, slot, column_slots[solver->inactive_columns[w * 64 + __builtin_ctzll(bits)]], 1);
+				bits &= bits - 1;
+			}
+		}
+
+		column_slots[solver->row_states[row]] = slot;
+	}
+
+	ok = TRUE;
+
+cleanup:
+	g_free(dense_rows);
+	g_free(dense_matrix);
+	g_free(dense_slots);
+	g_free(inactive_pivots);
+	g_free(used);
+	g_free(hdpc_row);
+
+	return ok;
+}
+
+
+/* Solves the constraint matrix made of the given sparse rows and the
+ * HDPC rows. Instead of operating on the symbol data, the symbol
+ * operations are recorded in ops, so the same solution can be applied to
+ * any symbol data. Returns FALSE if the matrix does not have full rank.
+ *
+ * Symbol slots are laid out like this:
+ *   0 .. S-1                  : LDPC rows (their value is zero)
+ *   S .. S+H-1                : HDPC rows (their value is zero)
+ *   S+H .. S+H+num_symbols-1  : encoding symbols (the LT rows)
+ * Once the ops have been applied, intermediate symbol i is in slot
+ * column_slots[i].
+ *
+ * The solver works in three phases:
+ *
+ * 1. Peeling with inactivation on the sparse rows. Rows with exactly one
+ *    active (= unsolved and not inactive) column become the pivot of that
+ *    column; the pivot row is XORed into all other pending rows containing
+ *    that column. If no such row exists, the pending row with the fewest
+ *    active columns is picked, and all of its active columns except one
+ *    are inactivated. Inactive columns are not eliminated in this phase;
+ *    they are tracked per row in a bitset instead. Rows which run out of
+ *    active columns only contain inactive columns and become dense rows.
+ *    The last P columns (which include the HDPC columns) are inactive
+ *    right from the start; they are the "permanently inactive" columns
+ *    of RFC 6330. Since every sparse row contains some of them, the dense rows are far less likely to be
+ *    linearly dependent than with a purely sparse binary code.
+ * 2. The HDPC rows are expressed in terms of the inactive columns by
+ *    substituting the pivot rows. Together with the dense rows from
+ *    phase 1, they form a small dense GF(2^8) system over the inactive
+ *    columns, which is solved with Gauss-Jordan elimination.
+ * 3. The solved inactive columns are substituted back into the pivot
+ *    rows from phase 1. */
+static gboolean gst_raptorq_code_solve(GstRaptorQCode const *code, GstRaptorQSparseRows const *rows, GArray *ops, guint *column_slots)
+{
+	GstRaptorQSolver solver;
+	gboolean ok;
+
+	/* There must be at least as many rows as unknowns */
+	if ((rows->num_rows + code->num_hdpc_symbols) < code->num_intermediate_symbols)
+		return FALSE;
+
+	gst_raptorq_solver_init(&solver, code, rows, ops);
+	gst_raptorq_solver_peel(&solver);
+	ok = gst_raptorq_solver_solve_inactive(&solver, column_slots);
+	gst_raptorq_solver_cleanup(&solver);
+
+	return ok;
+}
+
+
+static void gst_raptorq_execute_ops(GstRaptorQSymbolOp const *ops, guint num_ops, guint8 *slots, gsize symbol_length)
+{
+	guint i;
+
+	for (i = 0; i < num_ops; ++i)
+	{
+		guint8 *dst = slots + (gsize)(ops[i].dst) * symbol_length;
+		guint8 const *src = slots + (gsize)(ops[i].src) * symbol_length;
+
+		if (ops[i].dst == ops[i].src)
+			gst_fec_gf256_region_mul(dst, dst, ops[i].coef, symbol_length);
+		else if (ops[i].coef == 1)
+			gst_fec_xor_region(dst, src, symbol_length);
+		else
+			gst_fec_gf256_region_mul_add(dst, src, ops[i].coef, symbol_length);
+	}
+}
+
+
+static void gst_raptorq_code_free(GstRaptorQCode *code)
+{
+	g_free(code->hdpc_coefficients);
+	g_free(code->encoding_ops);
+	g_free(code->encoding_column_slots);
+	g_slice_free1(sizeof(GstRaptorQCode), code);
+}
+
+
+static void gst_raptorq_code_generate_hdpc_coefficients(GstRaptorQCode *code)
+{
+	guint i, j;
+	guint num_columns = code->num_intermediate_symbols - code->num_hdpc_symbols;
+
+	for (i = 0; i < code->num_hdpc_symbols; ++i)
+	{
+		guint32 y = gst_raptorq_hash(gst_raptorq_hash(code->num_source_symbols * 31u + code->systematic_seed) ^ (i + 1));
+		for (j = 0; j < num_columns; ++j)
+			code->hdpc_coefficients[i * num_columns + j] = 1 + gst_raptorq_rand(y, j, 255);
+	}
+}
+
+
+static GstRaptorQCode* gst_raptorq_code_new(guint num_source_symbols)
+{
+	GstRaptorQCode *code;
+	guint K = num_source_symbols;
+	guint x, h, seed;
+	GArray *ops;
+
+	if ((K == 0) || (K > GST_RAPTORQ_MAX_NUM_SOURCE_SYMBOLS))
+		return NULL;
+
+	code = g_slice_alloc0(sizeof(GstRaptorQCode));
+	code->ref_count = 1;
+	code->num_source_symbols = K;
+
+	/* Like in RFC 5053 section 5.4.2.3: X is the smallest positive integer
+	 * with X*(X-1) >= 2*K, and S is the smallest prime >= ceil(0.01*K) + X */
+	for (x = 1; (x * (x - 1)) < (2 * K); ++x);
+	code->num_ldpc_symbols = gst_raptorq_next_prime((K + 99) / 100 + x);
+	/* H is the smallest integer with choose(H, ceil(H/2)) >= K+S, like
+	 * in RFC 5053 section 5.4.2.3, plus a few more */
+	for (h = 1; gst_raptorq_binomial(h, (h + 1) / 2) < (K + code->num_ldpc_symbols); ++h);
+	code->num_hdpc_symbols = MAX(h + EXTRA_NUM_HDPC_SYMBOLS, MIN_NUM_HDPC_SYMBOLS);
+	code->num_intermediate_symbols = K + code->num_ldpc_symbols + code->num_hdpc_symbols;
+	/* The last P intermediate symbols are permanently inactive. These are
+	 * the HDPC symbols, plus about sqrt(K) more. Like in RFC 6330, P has
+	 * to grow with K, otherwise the sparse part of the matrix increasingly
+	 * often lacks more rank than the dense part can make up for. */
+	for (x = 0; (x * x) < K; ++x);
+	code->num_pi_symbols = code->num_hdpc_symbols + MIN(x * PI_SYMBOLS_PER_SQRT_K, K / 2);
+	code->num_lt_symbols = code->num_intermediate_symbols - code->num_pi_symbols;
+	code->lt_prime = gst_raptorq_next_prime(code->num_lt_symbols);
+	code->pi_prime = gst_raptorq_next_prime(code->num_pi_symbols);
+
+	code->hdpc_coefficients = g_malloc((gsize)(code->num_hdpc_symbols) * (K + code->num_ldpc_symbols));
+	code->encoding_column_slots = g_malloc(code->num_intermediate_symbols * sizeof(guint));
+	ops = g_array_new(FALSE, FALSE, sizeof(GstRaptorQSymbolOp));
+
+	/* The systematic seed is the first one for which the source symbols
+	 * (ESIs 0..K-1) and the constraints yield an invertible matrix. This
+	 * is what makes the code systematic: the intermediate symbols can
+	 * always be computed out of the source symbols. (RFC 6330 ships a
+	 * precomputed table of these seeds; here, they are searched for when
+	 * the code is constructed, which rarely takes more than one try.) */
+	for (seed = 0; seed < MAX_SYSTEMATIC_SEED; ++seed)
+	{
+		GstRaptorQSparseRows rows;
+		gboolean solved;
+
+		code->systematic_seed = seed;
+		gst_raptorq_code_generate_hdpc_coefficients(code);
+
+		g_array_set_size(ops, 0);
+		gst_raptorq_code_build_sparse_rows(code, K, NULL, &rows);
+		solved = gst_raptorq_code_solve(code, &rows, ops, code->encoding_column_slots);
+		gst_raptorq_sparse_rows_free(&rows);
+
+		if (solved)
+			break;
+	}
+
+	if (seed == MAX_SYSTEMATIC_SEED)
+	{
+		g_array_free(ops, TRUE);
+		gst_raptorq_code_free(code);
+		return NULL;
+	}
+
+	code->num_encoding_ops = ops->len;
+	code->encoding_ops = (GstRaptorQSymbolOp *)g_array_free(ops, FALSE);
+
+	return code;
+}
+
+
+GstRaptorQCode* gst_raptorq_code_get(guint num_source_symbols)
+{
+	GstRaptorQCode *code;
+
+	g_mutex_lock(&code_cache_mutex);
+
+	if (code_cache == NULL)
+		code_cache = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+	code = g_hash_table_lookup(code_cache, GUINT_TO_POINTER(num_source_symbols));
+	if (code != NULL)
+	{
+		/* Mark as most recently used */
+		g_queue_remove(&code_cache_lru, code);
+		g_queue_push_tail(&code_cache_lru, code);
+	}
+	else
+	{
+		/* The cache holds one reference, which is dropped on eviction.
+		 * Codes still in use by someone else stay alive until they
+		 * are unref'd there. */
+		code = gst_raptorq_code_new(num_source_symbols);
+		if (code == NULL)
+		{
+			g_mutex_unlock(&code_cache_mutex);
+			return NULL;
+		}
+
+		g_hash_table_insert(code_cache, GUINT_TO_POINTER(num_source_symbols), code);
+		g_queue_push_tail(&code_cache_lru, code);
+
+		if (g_queue_get_length(&code_cache_lru) > CODE_CACHE_SIZE)
+		{
+			GstRaptorQCode *evicted = g_queue_pop_head(&code_cache_lru);
+			g_hash_table_remove(code_cache, GUINT_TO_POINTER(evicted->num_source_symbols));
+			gst_raptorq_code_unref(evicted);
+		}
+	}
+
+	g_atomic_int_inc(&(code->ref_count));
+
+	g_mutex_unlock(&code_cache_mutex);
+
+	return code;
+}
+
+
+void gst_raptorq_code_unref(GstRaptorQCode *code)
+{
+	if (g_atomic_int_dec_and_test(&(code->ref_count)))
+		gst_raptorq_code_free(code);
+}
+
+
+guint gst_raptorq_code_get_num_intermediate_symbols(GstRaptorQCode const *code)
+{
+	return code->num_intermediate_symbols;
+}
+
+
+static void gst_raptorq_code_gather_intermediate_symbols(guint8 const *slots, guint const *column_slots, guint num_intermediate_symbols, guint8 *intermediate_symbols, gsize symbol_length)
+{
+	guint i;
+	for (i = 0; i < num_intermediate_symbols; ++i)
+		memcpy(intermediate_symbols + (gsize)i * symbol_length, slots + (gsize)(column_slots[i]) * symbol_length, symbol_length);
+}
+
+
+void gst_raptorq_code_encode(GstRaptorQCode const *code, void * const *source_symbols, guint8 *intermediate_symbols, gsize symbol_length)
+{
+	guint i;
+	guint num_constraints = code->num_ldpc_symbols + code->num_hdpc_symbols;
+	gsize slots_size = (gsize)(num_constraints + code->num_source_symbols) * symbol_length;
+	guint8 *slots = g_malloc(slots_size);
+
+	memset(slots, 0, (gsize)num_constraints * symbol_length);
+	for (i = 0; i < code->num_source_symbols; ++i)
+		memcpy(slots + (gsize)(num_constraints + i) * symbol_length, source_symbols[i], symbol_length);
+
+	gst_raptorq_execute_ops(code->encoding_ops, code->num_encoding_ops, slots, symbol_length);
+	gst_raptorq_code_gather_intermediate_symbols(slots, code->encoding_column_slots, code->num_intermediate_symbols, intermediate_symbols, symbol_length);
+
+	g_free(slots);
+}
+
+
+gboolean gst_raptorq_code_decode(GstRaptorQCode const *code, guint num_symbols, guint const *esis, void * const *symbols, guint8 *intermediate_symbols, gsize symbol_length)
+{
+	GstRaptorQSparseRows rows;
+	GArray *ops;
+	guint *column_slots;
+	guint i;
+	gboolean solved;
+	guint num_constraints = code->num_ldpc_symbols + code->num_hdpc_symbols;
+
+	/* Unlike with encoding, the set of received ESIs differs from block
+	 * to block, so the schedule has to be computed every time */
+	ops = g_array_new(FALSE, FALSE, sizeof(GstRaptorQSymbolOp));
+	column_slots = g_malloc(code->num_intermediate_symbols * sizeof(guint));
+
+	gst_raptorq_code_build_sparse_rows(code, num_symbols, esis, &rows);
+	solved = gst_raptorq_code_solve(code, &rows, ops, column_slots);
+	gst_raptorq_sparse_rows_free(&rows);
+
+	if (solved)
+	{
+		gsize slots_size = (gsize)(num_constraints + num_symbols) * symbol_length;
+		guint8 *slots = g_malloc(slots_size);
+
+		memset(slots, 0, (gsize)num_constraints * symbol_length);
+		for (i = 0; i < num_symbols; ++i)
+			memcpy(slots + (gsize)(num_constraints + i) * symbol_length, symbols[i], symbol_length);
+
+		gst_raptorq_execute_ops((GstRaptorQSymbolOp const *)(ops->data), ops->len, slots, symbol_length);
+		gst_raptorq_code_gather_intermediate_symbols(slots, column_slots, code->num_intermediate_symbols, intermediate_symbols, symbol_length);
+
+		g_free(slots);
+	}
+
+	g_array_free(ops, TRUE);
+	g_free(column_slots);
+
+	return solved;
+}
+
+
+void gst_raptorq_code_build_symbol(GstRaptorQCode const *code, guint8 const *intermediate_symbols, guint esi, guint8 *symbol, gsize symbol_length)
+{
+	guint columns[MAX_LT_DEGREE + MAX_PI_DEGREE];
+	guint i, degree;
+
+	degree = gst_raptorq_code_get_lt_columns(code, esi, columns);
+
+	memcpy(symbol, intermediate_symbols + (gsize)(columns[0]) * symbol_length, symbol_length);
+	for (i = 1; i < degree; ++i)
+		gst_fec_xor_region(symbol, intermediate_symbols + (gsize)(columns[i]) * symbol_length, symbol_length);
+}
@@ -0,0 +1,100 @@
+/* RaptorQ-style rateless forward error correction for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef GSTFECFRAME_RAPTORQ_RAPTORQCODE_H
+#define GSTFECFRAME_RAPTORQ_RAPTORQCODE_H
+
+#include <gst/gst.h>
+
+
+G_BEGIN_DECLS
+
+
+/* Systematic Raptor code over GF(2^8), modeled after RaptorQ (RFC 6330).
+ *
+ * Like in RFC 6330, the K source symbols of a source block are first
+ * turned into L = K+S+H intermediate symbols, and every encoding symbol
+ * is the XOR of a few intermediate symbols chosen by a tuple generator
+ * (an LT code). The intermediate symbols satisfy S sparse binary LDPC
+ * constraints and H dense GF(2^8) HDPC constraints, and are chosen such
+ * that the encoding symbols with ESI 0..K-1 equal the source symbols.
+ * Repair symbols can be generated for any ESI >= K, so the code is
+ * rateless. The decoder usually needs K or very few more symbols.
+ *
+ * Computing the intermediate symbols means solving the linear system
+ * given by the constraints and the received encoding symbols. This is
+ * done with inactivation decoding: sparse rows with one unknown are
+ * solved right away (like in a peeling decoder), and whenever this gets
+ * stuck, a few unknowns are "inactivated" and solved later in a small
+ * dense system together with the HDPC rows. The cost grows roughly
+ * linearly with K, which makes source blocks with tens of thousands of
+ * symbols feasible.
+ *
+ * The parameters (S, H, tuple generator, degree distribution, HDPC
+ * coefficients) do not match the tables of RFC 6330, so this code is
+ * not interoperable with other RaptorQ implementations.
+ *
+ * GstRaptorQCode instances hold everything that only depends on K: the
+ * parameters, the HDPC coefficients, and the sequence of symbol
+ * operations that computes the intermediate symbols out of K source
+ * symbols (the "encoding schedule"). Finding the schedule is the
+ * expensive part of encoding, so instances are kept in a process wide
+ * cache, and encoding a source block only needs to replay the cached
+ * schedule on the symbol data.
+ *
+ * gst_fec_gf256_init() must be called before any function in here is used. */
+
+
+/* RFC 6330 limits source blocks to this many source symbols */
+#define GST_RAPTORQ_MAX_NUM_SOURCE_SYMBOLS 56403
+/* Encoding symbol IDs have 24 bits */
+#define GST_RAPTORQ_MAX_ESI ((1u << 24) - 1)
+
+
+typedef struct _GstRaptorQCode GstRaptorQCode;
+
+
+/* Returns the code for source blocks with the given number of source
+ * symbols, creating it if it is not in the cache yet. The returned code
+ * must be released with gst_raptorq_code_unref(). Returns NULL if no
+ * code could be constructed. Thread safe. */
+GstRaptorQCode* gst_raptorq_code_get(guint num_source_symbols);
+void gst_raptorq_code_unref(GstRaptorQCode *code);
+
+/* Number of intermediate symbols (L). Buffers for intermediate
+ * symbols must be L * symbol_length bytes large. */
+guint gst_raptorq_code_get_num_intermediate_symbols(GstRaptorQCode const *code);
+
+/* Computes the intermediate symbols out of the K source symbols. The
+ * source_symbols table has K entries, the array index equals the ESI. */
+void gst_raptorq_code_encode(GstRaptorQCode const *code, void * const *source_symbols, guint8 *intermediate_symbols, gsize symbol_length);
+/* Computes the intermediate symbols out of any set of received encoding
+ * symbols (source and repair). esis and symbols have num_symbols entries.
+ * Returns FALSE if the received symbols are not sufficient; more symbols
+ * are needed then. */
+gboolean gst_raptorq_code_decode(GstRaptorQCode const *code, guint num_symbols, guint const *esis, void * const *symbols, guint8 *intermediate_symbols, gsize symbol_length);
+/* Builds the encoding symbol with the given ESI out of the intermediate
+ * symbols. For ESIs below K, this yields the source symbol. */
+void gst_raptorq_code_build_symbol(GstRaptorQCode const *code, guint8 const *intermediate_symbols, guint esi, guint8 *symbol, gsize symbol_length);
+
+
+G_END_DECLS
+
+
+#endif
@@ -0,0 +1,44 @@
+/* RaptorQ-style rateless forward error correction for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef GSTFECFRAME_RAPTORQ_RAPTORQFECCOMMON_H
+#define GSTFECFRAME_RAPTORQ_RAPTORQFECCOMMON_H
+
+#include <gst/gst.h>
+#include "gstraptorqcode.h"
+
+
+G_BEGIN_DECLS
+
+
+/* The RaptorQ elements use the m=24 FEC payload ID layout of the
+ * Reed-Solomon elements (8-bit source block number, 24-bit ESI,
+ * 16-bit k). The 8-bit SBN and 24-bit ESI match the FEC payload ID
+ * of RFC 6330; the large ESI range is what allows for producing
+ * (practically) unlimited numbers of repair symbols per block. */
+#define GST_RAPTORQ_FEC_PAYLOAD_ID_M 24
+
+/* All 2^24 ESIs can be used */
+#define GST_RAPTORQ_FEC_MAX_NUM_ENCODING_SYMBOLS (GST_RAPTORQ_MAX_ESI + 1)
+
+
+G_END_DECLS
+
+
+#endif
@@ -0,0 +1,423 @@
+/* RaptorQ-style rateless forward error correction for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/**
+ * GstRaptorQFECDec is the counterpart of GstRaptorQFECEnc. It manages source
+ * blocks the same way GstRSFECDec does (see the documentation there).
+ *
+ * Once a source block has k or more symbols, and at least one of them is a
+ * repair symbol (without one, the encoding symbol length is unknown, since
+ * source packets only contain the ADU, not the padded ADUI), the decoder tries
+ * to compute the block's intermediate symbols out of all received symbols. If
+ * this succeeds, the missing source symbols are built out of the intermediate
+ * symbols, and the block is processed right away. Otherwise, more symbols are
+ * needed; decoding is then retried whenever another packet of the block
+ * arrives. RaptorQ is not MDS, but k symbols suffice in the vast majority of
+ * cases, and k+2 symbols practically always.
+ *
+ * The base class only accepts ESIs below num-source-symbols plus
+ * num-repair-symbols. If the encoder produces additional repair symbols with
+ * its push-repair-symbols action signal, num-repair-symbols must be set
+ * high enough here to cover their ESIs, otherwise they are dropped.
+ */
+
+
+#include <string.h>
+#include "gstraptorqfeccommon.h"
+#include "gstraptorqfecdec.h"
+
+
+GST_DEBUG_CATEGORY(raptorq_fec_dec_debug);
+#define GST_CAT_DEFAULT raptorq_fec_dec_debug
+
+
+#define FEC_SOURCE_CAPS_STR "application/x-fec-source-flow, fec-scheme = (string) raptorq"
+#define FEC_REPAIR_CAPS_STR "application/x-fec-repair-flow, fec-scheme = (string) raptorq"
+
+
+#define FEC_PAYLOAD_ID_LENGTH 6
+
+
+/* Decoder state of one source block, stored in its scheme_data. It
+ * only exists once the source block was decoded successfully. */
+typedef struct
+{
+	/* Length of the encoding symbols, taken from the first repair packet */
+	gsize encoding_symbol_length;
+	/* The decoded intermediate symbols (L * encoding_symbol_length bytes) */
+	guint8 *intermediate_symbols;
+	/* Memory for the recovered source symbols; the
+	 * recovered_encoding_symbol_table entries point into it */
+	guint8 *recovered_symbols;
+}
+GstRaptorQFECDecBlockState;
+
+
+/* These replace the templates of the same name from the base class */
+
+static GstStaticPadTemplate static_fecsource_template = GST_STATIC_PAD_TEMPLATE(
+	"fecsource",
+	GST_PAD_SINK,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS(FEC_SOURCE_CAPS_STR)
+);
+
+
+static GstStaticPadTemplate static_fecrepair_template = GST_STATIC_PAD_TEMPLATE(
+	"fecrepair",
+	GST_PAD_SINK,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS(FEC_REPAIR_CAPS_STR)
+);
+
+
+
+
+G_DEFINE_TYPE(GstRaptorQFECDec, gst_raptorq_fec_dec, GST_TYPE_RS_FEC_DEC)
+
+
+
+
+static void gst_raptorq_fec_dec_finalize(GObject *object);
+
+static GstStateChangeReturn gst_raptorq_fec_dec_change_state(GstElement *element, GstStateChange transition);
+
+static guint gst_raptorq_fec_dec_get_payload_id_m(GstRSFECDec *rs_fec_dec);
+static guint gst_raptorq_fec_dec_get_max_num_encoding_symbols(GstRSFECDec *rs_fec_dec);
+static gboolean gst_raptorq_fec_dec_check_settings(GstRSFECDec *rs_fec_dec);
+static gboolean gst_raptorq_fec_dec_check_caps(GstRSFECDec *rs_fec_dec, GstCaps *caps);
+static gboolean gst_raptorq_fec_dec_add_fec_packet(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block, GstBuffer *fec_packet, guint esi, gboolean is_source_packet);
+static gboolean gst_raptorq_fec_dec_can_process_source_block(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block);
+static gboolean gst_raptorq_fec_dec_recover_source_symbols(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block);
+static void gst_raptorq_fec_dec_free_source_block_data(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block);
+
+static void gst_raptorq_fec_dec_try_decode(GstRaptorQFECDec *raptorq_fec_dec, GstRSFECDecSourceBlock *source_block);
+static void gst_raptorq_fec_dec_release_code(GstRaptorQFECDec *raptorq_fec_dec);
+
+
+
+
+static void gst_raptorq_fec_dec_class_init(GstRaptorQFECDecClass *klass)
+{
+	GObjectClass *object_class;
+	GstElementClass *element_class;
+	GstRSFECDecClass *rs_fec_dec_class;
+
+	GST_DEBUG_CATEGORY_INIT(raptorq_fec_dec_debug, "raptorqfecdec", 0, "RaptorQ-style rateless FEC decoder");
+
+	object_class = G_OBJECT_CLASS(klass);
+	element_class = GST_ELEMENT_CLASS(klass);
+	rs_fec_dec_class = GST_RS_FEC_DEC_CLASS(klass);
+
+	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_fecsource_template));
+	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_fecrepair_template));
+
+	object_class->finalize      = GST_DEBUG_FUNCPTR(gst_raptorq_fec_dec_finalize);
+
+	element_class->change_state = GST_DEBUG_FUNCPTR(gst_raptorq_fec_dec_change_state);
+
+	rs_fec_dec_class->supports_num_symbols_changes = FALSE;
+	rs_fec_dec_class->get_payload_id_m             = GST_DEBUG_FUNCPTR(gst_raptorq_fec_dec_get_payload_id_m);
+	rs_fec_dec_class->get_max_num_encoding_symbols = GST_DEBUG_FUNCPTR(gst_raptorq_fec_dec_get_max_num_encoding_symbols);
+	rs_fec_dec_class->check_settings               = GST_DEBUG_FUNCPTR(gst_raptorq_fec_dec_check_settings);
+	rs_fec_dec_class->check_caps                   = GST_DEBUG_FUNCPTR(gst_raptorq_fec_dec_check_caps);
+	rs_fec_dec_class->add_fec_packet               = GST_DEBUG_FUNCPTR(gst_raptorq_fec_dec_add_fec_packet);
+	rs_fec_dec_class->can_process_source_block     = GST_DEBUG_FUNCPTR(gst_raptorq_fec_dec_can_process_source_block);
+	rs_fec_dec_class->recover_source_symbols       = GST_DEBUG_FUNCPTR(gst_raptorq_fec_dec_recover_source_symbols);
+	rs_fec_dec_class->free_source_block_data       = GST_DEBUG_FUNCPTR(gst_raptorq_fec_dec_free_source_block_data);
+
+	gst_element_class_set_static_metadata(
+		element_class,
+		"RaptorQ-style forward error correction decoder",
+		"Codec/Decoder/Network",
+		"Decoder for rateless forward-error erasure coding based on a RaptorQ-style Raptor code",
+		"Carlos Rafael Giani <dv@pseudoterminal.org>"
+	);
+}
+
+
+static void gst_raptorq_fec_dec_init(GstRaptorQFECDec *raptorq_fec_dec)
+{
+	raptorq_fec_dec->code = NULL;
+}
+
+
+static void gst_raptorq_fec_dec_finalize(GObject *object)
+{
+	gst_raptorq_fec_dec_release_code(GST_RAPTORQ_FEC_DEC(object));
+
+	G_OBJECT_CLASS(gst_raptorq_fec_dec_parent_class)->finalize(object);
+}
+
+
+static GstStateChangeReturn gst_raptorq_fec_dec_change_state(GstElement *element, GstStateChange transition)
+{
+	GstRaptorQFECDec *raptorq_fec_dec = GST_RAPTORQ_FEC_DEC(element);
+	GstRSFECDec *rs_fec_dec = GST_RS_FEC_DEC(element);
+	GstStateChangeReturn result;
+
+	if ((result = GST_ELEMENT_CLASS(gst_raptorq_fec_dec_parent_class)->change_state(element, transition)) == GST_STATE_CHANGE_FAILURE)
+		return result;
+
+	switch (transition)
+	{
+		case GST_STATE_CHANGE_NULL_TO_READY:
+			/* Fetch the code here (the settings were checked by the
+			 * base class at this point), since constructing it in the
+			 * streaming thread would delay the first recovered ADUs */
+			if ((raptorq_fec_dec->code = gst_raptorq_code_get(rs_fec_dec->num_source_symbols)) == NULL)
+			{
+				GST_ELEMENT_ERROR(rs_fec_dec, LIBRARY, INIT, ("could not construct RaptorQ code"), ("number of source symbols: %u", rs_fec_dec->num_source_symbols));
+				return GST_STATE_CHANGE_FAILURE;
+			}
+			break;
+
+		case GST_STATE_CHANGE_READY_TO_NULL:
+			gst_raptorq_fec_dec_release_code(raptorq_fec_dec);
+			break;
+
+		default:
+			break;
+	}
+
+	return result;
+}
+
+
+static guint gst_raptorq_fec_dec_get_payload_id_m(G_GNUC_UNUSED GstRSFECDec *rs_fec_dec)
+{
+	return GST_RAPTORQ_FEC_PAYLOAD_ID_M;
+}
+
+
+static guint gst_raptorq_fec_dec_get_max_num_encoding_symbols(G_GNUC_UNUSED GstRSFECDec *rs_fec_dec)
+{
+	return GST_RAPTORQ_FEC_MAX_NUM_ENCODING_SYMBOLS;
+}
+
+
+static gboolean gst_raptorq_fec_dec_check_settings(GstRSFECDec *rs_fec_dec)
+{
+	if (rs_fec_dec->num_source_symbols > GST_RAPTORQ_MAX_NUM_SOURCE_SYMBOLS)
+	{
+		GST_ELEMENT_ERROR(
+			rs_fec_dec, LIBRARY, SETTINGS,
+			("invalid RaptorQ parameters"),
+			("number of source symbols: %u  maximum allowed: %u", rs_fec_dec->num_source_symbols, GST_RAPTORQ_MAX_NUM_SOURCE_SYMBOLS)
+		);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+static gboolean gst_raptorq_fec_dec_check_caps(G_GNUC_UNUSED GstRSFECDec *rs_fec_dec, G_GNUC_UNUSED GstCaps *caps)
+{
+	/* The code only depends on k, so there is nothing to check */
+	return TRUE;
+}
+
+
+static gboolean gst_raptorq_fec_dec_add_fec_packet(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block, G_GNUC_UNUSED GstBuffer *fec_packet, G_GNUC_UNUSED guint esi, G_GNUC_UNUSED gboolean is_source_packet)
+{
+	/* Symbols that arrive after the block was decoded are of no use
+	 * (this can happen if processing the block failed) */
+	if (source_block->scheme_data != NULL)
+		return TRUE;
+
+	/* Nothing to decode if no source packet is missing, and nothing
+	 * can be decoded without repair packets or with less than k symbols */
+	if ((source_block->num_source_packets == rs_fec_dec->num_source_symbols) || (source_block->num_repair_packets == 0) || ((source_block->num_source_packets + source_block->num_repair_packets) < rs_fec_dec->num_source_symbols))
+		return TRUE;
+
+	gst_raptorq_fec_dec_try_decode(GST_RAPTORQ_FEC_DEC(rs_fec_dec), source_block);
+
+	return TRUE;
+}
+
+
+static gboolean gst_raptorq_fec_dec_can_process_source_block(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block)
+{
+	/* All source packets were received; nothing needs to be decoded */
+	if (source_block->num_source_packets == rs_fec_dec->num_source_symbols)
+		return TRUE;
+
+	/* Otherwise, the block can be processed once it was decoded. Unlike
+	 * with Reed-Solomon, the number of received packets alone does not
+	 * tell when this is possible. */
+	return (source_block->scheme_data != NULL);
+}
+
+
+static gboolean gst_raptorq_fec_dec_recover_source_symbols(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block)
+{
+	GstRaptorQFECDec *raptorq_fec_dec = GST_RAPTORQ_FEC_DEC(rs_fec_dec);
+	GstRaptorQFECDecBlockState *state = source_block->scheme_data;
+	guint esi, num_missing_symbols;
+	guint8 *symbol;
+
+	g_assert(state != NULL);
+
+	num_missing_symbols = rs_fec_dec->num_source_symbols - source_block->num_source_packets;
+
+	g_free(state->recovered_symbols);
+	state->recovered_symbols = g_malloc(num_missing_symbols * state->encoding_symbol_length);
+
+	/* Received ADUs are already in the output_adu_table. Only build
+	 * the symbols of the missing ones, as the base class expects. */
+	memset(rs_fec_dec->recovered_encoding_symbol_table, 0, sizeof(void*) * rs_fec_dec->num_encoding_symbols);
+	symbol = state->recovered_symbols;
+	for (esi = 0; esi < rs_fec_dec->num_source_symbols; ++esi)
+	{
+		if (source_block->output_adu_table[esi] != NULL)
+			continue;
+
+		gst_raptorq_code_build_symbol(raptorq_fec_dec->code, state->intermediate_symbols, esi, symbol, state->encoding_symbol_length);
+		rs_fec_dec->recovered_encoding_symbol_table[esi] = symbol;
+		symbol += state->encoding_symbol_length;
+	}
+
+	return TRUE;
+}
+
+
+static void gst_raptorq_fec_dec_free_source_block_data(G_GNUC_UNUSED GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block)
+{
+	GstRaptorQFECDecBlockState *state = source_block->scheme_data;
+
+	g_free(state->intermediate_symbols);
+	g_free(state->recovered_symbols);
+	g_slice_free1(sizeof(GstRaptorQFECDecBlockState), state);
+	source_block->scheme_data = NULL;
+}
+
+
+static void gst_raptorq_fec_dec_try_decode(GstRaptorQFECDec *raptorq_fec_dec, GstRSFECDecSourceBlock *source_block)
+{
+	GstRSFECDec *rs_fec_dec = GST_RS_FEC_DEC(raptorq_fec_dec);
+	guint adu_flow_id = 0; /* XXX: Currently, only one flow (flow 0) is supported */
+	GSList *node;
+	gsize encoding_symbol_length;
+	guint max_num_symbols, num_symbols;
+	guint *esis;
+	void **symbols;
+	guint8 *symbol_data;
+	guint8 *intermediate_symbols;
+
+	/* All repair packets are encoding_symbol_length + 6 bytes long
+	 * (the FEC payload ID has 6 bytes), so use the first one to
+	 * determine the encoding symbol length */
+	encoding_symbol_length = gst_buffer_get_size((GstBuffer *)(source_block->repair_packets->data)) - FEC_PAYLOAD_ID_LENGTH;
+
+	max_num_symbols = source_block->num_source_packets + source_block->num_repair_packets;
+	num_symbols = 0;
+	esis = g_malloc(sizeof(guint) * max_num_symbols);
+	symbols = g_malloc(sizeof(void *) * max_num_symbols);
+	symbol_data = g_malloc(encoding_symbol_length * max_num_symbols);
+
+	for (node = source_block->source_packets; node != NULL; node = node->next)
+	{
+		GstBuffer *source_packet = (GstBuffer *)(node->data);
+		gsize adu_length = gst_buffer_get_size(source_packet) - FEC_PAYLOAD_ID_LENGTH;
+		guint8 payload_id[FEC_PAYLOAD_ID_LENGTH];
+		guint8 *symbol = symbol_data + num_symbols * encoding_symbol_length;
+
+		/* The FEC payload ID is located at the end of FEC source packets */
+		gst_buffer_extract(source_packet, adu_length, payload_id, FEC_PAYLOAD_ID_LENGTH);
+		gst_rs_fec_read_payload_id(payload_id, GST_RAPTORQ_FEC_PAYLOAD_ID_M, NULL, &(esis[num_symbols]), NULL);
+
+		/* Packets that do not fit the symbol length would corrupt the
+		 * decoding, so skip them. (The ADU itself is still output.) */
+		if ((adu_length + 3) > encoding_symbol_length)
+		{
+			GST_WARNING_OBJECT(raptorq_fec_dec, "ADU with ESI %u is too large for encoding symbol length %" G_GSIZE_FORMAT " - not using it for decoding", esis[num_symbols], encoding_symbol_length);
+			continue;
+		}
+
+		/* Rebuild the ADUI the encoder used as source symbol:
+		 * flow ID (8 bit), ADU length (16 bit big endian), ADU, zero padding */
+		symbol[0] = adu_flow_id;
+		symbol[1] = (adu_length & 0xFF00) >> 8;
+		symbol[2] = (adu_length & 0x00FF);
+		gst_buffer_extract(source_packet, 0, symbol + 3, adu_length);
+		memset(symbol + 3 + adu_length, 0, encoding_symbol_length - 3 - adu_length);
+
+		symbols[num_symbols] = symbol;
+		num_symbols++;
+	}
+
+	for (node = source_block->repair_packets; node != NULL; node = node->next)
+	{
+		GstBuffer *repair_packet = (GstBuffer *)(node->data);
+		gsize repair_symbol_length = gst_buffer_get_size(repair_packet) - FEC_PAYLOAD_ID_LENGTH;
+		guint8 payload_id[FEC_PAYLOAD_ID_LENGTH];
+		guint8 *symbol = symbol_data + num_symbols * encoding_symbol_length;
+
+		/* The FEC payload ID is located at the start of FEC repair packets */
+		gst_buffer_extract(repair_packet, 0, payload_id, FEC_PAYLOAD_ID_LENGTH);
+		gst_rs_fec_read_payload_id(payload_id, GST_RAPTORQ_FEC_PAYLOAD_ID_M, NULL, &(esis[num_symbols]), NULL);
+
+		if (repair_symbol_length != encoding_symbol_length)
+		{
+			GST_WARNING_OBJECT(raptorq_fec_dec, "repair symbol with ESI %u has length %" G_GSIZE_FORMAT ", expected %" G_GSIZE_FORMAT " - not using it for decoding", esis[num_symbols], repair_symbol_length, encoding_symbol_length);
+			continue;
+		}
+
+		gst_buffer_extract(repair_packet, FEC_PAYLOAD_ID_LENGTH, symbol, encoding_symbol_length);
+
+		symbols[num_symbols] = symbol;
+		num_symbols++;
+	}
+
+	if (num_symbols >= rs_fec_dec->num_source_symbols)
+	{
+		intermediate_symbols = g_malloc(gst_raptorq_code_get_num_intermediate_symbols(raptorq_fec_dec->code) * encoding_symbol_length);
+
+		if (gst_raptorq_code_decode(raptorq_fec_dec->code, num_symbols, esis, symbols, intermediate_symbols, encoding_symbol_length))
+		{
+			GstRaptorQFECDecBlockState *state = g_slice_alloc(sizeof(GstRaptorQFECDecBlockState));
+			state->encoding_symbol_length = encoding_symbol_length;
+			state->intermediate_symbols = intermediate_symbols;
+			state->recovered_symbols = NULL;
+			source_block->scheme_data = state;
+
+			GST_LOG_OBJECT(raptorq_fec_dec, "decoded source block #%u with %u symbols", source_block->block_nr, num_symbols);
+		}
+		else
+		{
+			GST_LOG_OBJECT(raptorq_fec_dec, "could not decode source block #%u with %u symbols yet - waiting for more", source_block->block_nr, num_symbols);
+			g_free(intermediate_symbols);
+		}
+	}
+
+	g_free(symbol_data);
+	g_free(symbols);
+	g_free(esis);
+}
+
+
+static void gst_raptorq_fec_dec_release_code(GstRaptorQFECDec *raptorq_fec_dec)
+{
+	if (raptorq_fec_dec->code != NULL)
+	{
+		gst_raptorq_code_unref(raptorq_fec_dec->code);
+		raptorq_fec_dec->code = NULL;
+	}
+}
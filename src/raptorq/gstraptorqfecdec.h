@@ -0,0 +1,69 @@
+/* RaptorQ-style rateless forward error correction for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+#ifndef GSTFECFRAME_RAPTORQ_RAPTORQFECDEC_H
+#define GSTFECFRAME_RAPTORQ_RAPTORQFECDEC_H
+
+#include <gst/gst.h>
+#include "reed-solomon/gstrsfecdec.h"
+#include "gstraptorqcode.h"
+
+
+G_BEGIN_DECLS
+
+
+typedef struct _GstRaptorQFECDec GstRaptorQFECDec;
+typedef struct _GstRaptorQFECDecClass GstRaptorQFECDecClass;
+
+
+#define GST_TYPE_RAPTORQ_FEC_DEC             (gst_raptorq_fec_dec_get_type())
+#define GST_RAPTORQ_FEC_DEC(obj)             (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_RAPTORQ_FEC_DEC, GstRaptorQFECDec))
+#define GST_RAPTORQ_FEC_DEC_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST((klass), GST_TYPE_RAPTORQ_FEC_DEC, GstRaptorQFECDecClass))
+#define GST_RAPTORQ_FEC_DEC_CAST(obj)        ((GstRaptorQFECDec *)(obj))
+#define GST_IS_RAPTORQ_FEC_DEC(obj)          (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_RAPTORQ_FEC_DEC))
+#define GST_IS_RAPTORQ_FEC_DEC_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass), GST_TYPE_RAPTORQ_FEC_DEC))
+
+
+/* The RaptorQ decoder reuses the source block management, ADU output
+ * and FEC framing of the Reed-Solomon decoder. A source block is decoded
+ * as soon as at least k of its symbols (including at least one repair
+ * symbol) were received; if that fails (RaptorQ is not MDS), decoding is
+ * retried with each further symbol. The code-construction property of
+ * the base class has no effect here. */
+struct _GstRaptorQFECDec
+{
+	GstRSFECDec parent;
+
+	/* Code for the configured number of source symbols, taken from the
+	 * code cache when switching from NULL to READY */
+	GstRaptorQCode *code;
+};
+
+
+struct _GstRaptorQFECDecClass
+{
+	GstRSFECDecClass parent_class;
+};
+
+
+GType gst_raptorq_fec_dec_get_type(void);
+
+
+G_END_DECLS
+
+
+#endif
@@ -0,0 +1,508 @@
+/* RaptorQ-style rateless forward error correction for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/**
+ * GstRaptorQFECEnc produces FEC source and repair packets like GstRSFECEnc does,
+ * except that the repair symbols are computed with a systematic Raptor code
+ * modeled after RaptorQ (RFC 6330); see gstraptorqcode.h for details. Like
+ * LDPC-Staircase, it is not MDS, but the decoder almost always succeeds with k
+ * or k+1 symbols, encoding and decoding costs grow roughly linearly with k, and
+ * source blocks can have up to 56403 source symbols. Unlike the other schemes,
+ * RaptorQ is rateless: any number of repair symbols can be generated for a
+ * source block, not just the fixed n-k ones.
+ *
+ * Finding out how to compute the intermediate symbols for a given k (which
+ * involves solving the constraint matrix) is done once per block size. The
+ * result is kept in a process wide cache, so all source blocks (and all encoder
+ * instances) with the same k share it, and encoding a block only consists of
+ * replaying the precomputed symbol operations.
+ *
+ * The ADUI framing, the pads, and the source block generation are the same as
+ * in GstRSFECEnc; see the documentation there for details. num-repair-symbols
+ * repair packets are pushed right after each source block. If the
+ * unlimited-repair-symbols property is set to TRUE, the encoder additionally
+ * retains the most recent source block, and the application can produce more
+ * repair packets for it at any time by emitting the push-repair-symbols action
+ * signal. This allows for sending repair packets until all receivers have the
+ * data, which is the typical use case for rateless codes (for example with file
+ * transfers). These extra repair packets continue at ESI k+num-repair-symbols.
+ * The decoder must accept their ESIs; see GstRaptorQFECDec for details.
+ * They are subject to max-repair-bitrate, repair-pacing and repair-delay
+ * just like the other repair packets. If the budget does not cover all
+ * of the requested packets, only the affordable ones are pushed, and the
+ * signal returns FALSE.
+ *
+ * NOTE: The FEC payload ID uses the RFC 6330 field widths for the source block
+ * number and ESI (8 and 24 bits), but the code itself is not compatible with
+ * RFC 6330, so these elements only interoperate with each other.
+ */
+
+
+#include <string.h>
+#include "gstraptorqfeccommon.h"
+#include "gstraptorqfecenc.h"
+
+
+GST_DEBUG_CATEGORY(raptorq_fec_enc_debug);
+#define GST_CAT_DEFAULT raptorq_fec_enc_debug
+
+
+enum
+{
+	PROP_0,
+	PROP_UNLIMITED_REPAIR_SYMBOLS
+};
+
+
+enum
+{
+	SIGNAL_PUSH_REPAIR_SYMBOLS,
+	LAST_SIGNAL
+};
+
+
+#define DEFAULT_UNLIMITED_REPAIR_SYMBOLS FALSE
+
+
+#define FEC_SOURCE_CAPS_STR "application/x-fec-source-flow, fec-scheme = (string) raptorq"
+#define FEC_REPAIR_CAPS_STR "application/x-fec-repair-flow, fec-scheme = (string) raptorq"
+
+
+#define FEC_PAYLOAD_ID_LENGTH 6
+
+
+/* These replace the templates of the same name from the base class */
+
+static GstStaticPadTemplate static_fecsource_template = GST_STATIC_PAD_TEMPLATE(
+	"fecsource",
+	GST_PAD_SRC,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS(FEC_SOURCE_CAPS_STR)
+);
+
+
+static GstStaticPadTemplate static_fecrepair_template = GST_STATIC_PAD_TEMPLATE(
+	"fecrepair",
+	GST_PAD_SRC,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS(FEC_REPAIR_CAPS_STR)
+);
+
+
+static guint raptorq_fec_enc_signals[LAST_SIGNAL] = { 0 };
+
+
+
+
+G_DEFINE_TYPE(GstRaptorQFECEnc, gst_raptorq_fec_enc, GST_TYPE_RS_FEC_ENC)
+
+
+
+
+static void gst_raptorq_fec_enc_finalize(GObject *object);
+static void gst_raptorq_fec_enc_set_property(GObject *object, guint prop_id, GValue const *value, GParamSpec *pspec);
+static void gst_raptorq_fec_enc_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec);
+
+static GstStateChangeReturn gst_raptorq_fec_enc_change_state(GstElement *element, GstStateChange transition);
+
+static guint gst_raptorq_fec_enc_get_payload_id_m(GstRSFECEnc *rs_fec_enc);
+static guint gst_raptorq_fec_enc_get_max_num_encoding_symbols(GstRSFECEnc *rs_fec_enc);
+static gboolean gst_raptorq_fec_enc_check_settings(GstRSFECEnc *rs_fec_enc);
+static gboolean gst_raptorq_fec_enc_uses_openfec_session(GstRSFECEnc *rs_fec_enc);
+static gsize gst_raptorq_fec_enc_get_encoding_symbol_length(GstRSFECEnc *rs_fec_enc, gsize max_adui_length);
+static gboolean gst_raptorq_fec_enc_configure_session(GstRSFECEnc *rs_fec_enc, gsize encoding_symbol_length);
+static gboolean gst_raptorq_fec_enc_build_repair_symbols(GstRSFECEnc *rs_fec_enc, gsize encoding_symbol_length);
+static void gst_raptorq_fec_enc_set_caps_fields(GstRSFECEnc *rs_fec_enc, GstCaps *caps);
+
+static gboolean gst_raptorq_fec_enc_push_repair_symbols(GstRaptorQFECEnc *raptorq_fec_enc, guint num_repair_symbols);
+
+static void gst_raptorq_fec_enc_release_code(GstRaptorQFECEnc *raptorq_fec_enc);
+
+
+
+
+static void gst_raptorq_fec_enc_class_init(GstRaptorQFECEncClass *klass)
+{
+	GObjectClass *object_class;
+	GstElementClass *element_class;
+	GstRSFECEncClass *rs_fec_enc_class;
+
+	GST_DEBUG_CATEGORY_INIT(raptorq_fec_enc_debug, "raptorqfecenc", 0, "RaptorQ-style rateless FEC encoder");
+
+	object_class = G_OBJECT_CLASS(klass);
+	element_class = GST_ELEMENT_CLASS(klass);
+	rs_fec_enc_class = GST_RS_FEC_ENC_CLASS(klass);
+
+	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_fecsource_template));
+	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_fecrepair_template));
+
+	object_class->finalize      = GST_DEBUG_FUNCPTR(gst_raptorq_fec_enc_finalize);
+	object_class->set_property  = GST_DEBUG_FUNCPTR(gst_raptorq_fec_enc_set_property);
+	object_class->get_property  = GST_DEBUG_FUNCPTR(gst_raptorq_fec_enc_get_property);
+
+	element_class->change_state = GST_DEBUG_FUNCPTR(gst_raptorq_fec_enc_change_state);
+
+	/* The RaptorQ code is set up for a fixed k */
+	rs_fec_enc_class->supports_num_symbols_changes = FALSE;
+	/* This class builds the repair symbols itself, so the base class
+	 * does not create an OpenFEC session */
+	rs_fec_enc_class->get_payload_id_m             = GST_DEBUG_FUNCPTR(gst_raptorq_fec_enc_get_payload_id_m);
+	rs_fec_enc_class->get_max_num_encoding_symbols = GST_DEBUG_FUNCPTR(gst_raptorq_fec_enc_get_max_num_encoding_symbols);
+	rs_fec_enc_class->check_settings               = GST_DEBUG_FUNCPTR(gst_raptorq_fec_enc_check_settings);
+	rs_fec_enc_class->uses_openfec_session         = GST_DEBUG_FUNCPTR(gst_raptorq_fec_enc_uses_openfec_session);
+	rs_fec_enc_class->get_encoding_symbol_length   = GST_DEBUG_FUNCPTR(gst_raptorq_fec_enc_get_encoding_symbol_length);
+	rs_fec_enc_class->configure_session            = GST_DEBUG_FUNCPTR(gst_raptorq_fec_enc_configure_session);
+	rs_fec_enc_class->build_repair_symbols         = GST_DEBUG_FUNCPTR(gst_raptorq_fec_enc_build_repair_symbols);
+	rs_fec_enc_class->set_caps_fields              = GST_DEBUG_FUNCPTR(gst_raptorq_fec_enc_set_caps_fields);
+
+	klass->push_repair_symbols = GST_DEBUG_FUNCPTR(gst_raptorq_fec_enc_push_repair_symbols);
+
+	g_object_class_install_property(
+		object_class,
+		PROP_UNLIMITED_REPAIR_SYMBOLS,
+		g_param_spec_boolean(
+			"unlimited-repair-symbols",
+			"Unlimited repair symbols",
+			"Retain the most recent source block, so that more repair symbols can be produced for it with the push-repair-symbols action signal",
+			DEFAULT_UNLIMITED_REPAIR_SYMBOLS,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+
+	/* Produces and pushes the given number of additional repair packets
+	 * for the most recent source block. Requires unlimited-repair-symbols
+	 * to be TRUE. Returns FALSE if no source block is retained (for
+	 * example because no source block was completed yet, or because EOS
+	 * was received), or if pushing failed. */
+	raptorq_fec_enc_signals[SIGNAL_PUSH_REPAIR_SYMBOLS] = g_signal_new(
+		"push-repair-symbols",
+		G_TYPE_FROM_CLASS(klass),
+		G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+		G_STRUCT_OFFSET(GstRaptorQFECEncClass, push_repair_symbols),
+		NULL, NULL,
+		NULL,
+		G_TYPE_BOOLEAN, 1, G_TYPE_UINT
+	);
+
+	gst_element_class_set_static_metadata(
+		element_class,
+		"RaptorQ-style forward error correction encoder",
+		"Codec/Encoder/Network",
+		"Produces rateless forward-error erasure coding based on a RaptorQ-style Raptor code",
+		"Carlos Rafael Giani <dv@pseudoterminal.org>"
+	);
+}
+
+
+static void gst_raptorq_fec_enc_init(GstRaptorQFECEnc *raptorq_fec_enc)
+{
+	raptorq_fec_enc->unlimited_repair_symbols = DEFAULT_UNLIMITED_REPAIR_SYMBOLS;
+	raptorq_fec_enc->code = NULL;
+	raptorq_fec_enc->intermediate_symbols = NULL;
+	raptorq_fec_enc->intermediate_symbols_size = 0;
+	raptorq_fec_enc->has_retained_block = FALSE;
+}
+
+
+static void gst_raptorq_fec_enc_finalize(GObject *object)
+{
+	gst_raptorq_fec_enc_release_code(GST_RAPTORQ_FEC_ENC(object));
+
+	G_OBJECT_CLASS(gst_raptorq_fec_enc_parent_class)->finalize(object);
+}
+
+
+static void gst_raptorq_fec_enc_set_property(GObject *object, guint prop_id, GValue const *value, GParamSpec *pspec)
+{
+	GstRaptorQFECEnc *raptorq_fec_enc = GST_RAPTORQ_FEC_ENC(object);
+	GstRSFECEnc *rs_fec_enc = GST_RS_FEC_ENC(object);
+
+	switch (prop_id)
+	{
+		case PROP_UNLIMITED_REPAIR_SYMBOLS:
+			GST_OBJECT_LOCK(object);
+			if (!(rs_fec_enc->initialized))
+				raptorq_fec_enc->unlimited_repair_symbols = g_value_get_boolean(value);
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot enable or disable unlimited repair symbols after the encoder was initialized"), (NULL));
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		default:
+			/* The remaining properties belong to the base class */
+			G_OBJECT_CLASS(gst_raptorq_fec_enc_parent_class)->set_property(object, prop_id, value, pspec);
+			break;
+	}
+}
+
+
+static void gst_raptorq_fec_enc_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec)
+{
+	GstRaptorQFECEnc *raptorq_fec_enc = GST_RAPTORQ_FEC_ENC(object);
+
+	switch (prop_id)
+	{
+		case PROP_UNLIMITED_REPAIR_SYMBOLS:
+			GST_OBJECT_LOCK(object);
+			g_value_set_boolean(value, raptorq_fec_enc->unlimited_repair_symbols);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		default:
+			G_OBJECT_CLASS(gst_raptorq_fec_enc_parent_class)->get_property(object, prop_id, value, pspec);
+			break;
+	}
+}
+
+
+static GstStateChangeReturn gst_raptorq_fec_enc_change_state(GstElement *element, GstStateChange transition)
+{
+	GstRaptorQFECEnc *raptorq_fec_enc = GST_RAPTORQ_FEC_ENC(element);
+	GstStateChangeReturn result;
+
+	if ((result = GST_ELEMENT_CLASS(gst_raptorq_fec_enc_parent_class)->change_state(element, transition)) == GST_STATE_CHANGE_FAILURE)
+		return result;
+
+	switch (transition)
+	{
+		case GST_STATE_CHANGE_PAUSED_TO_READY:
+			/* The stream is over; repair symbols for its last
+			 * block must not be produced anymore */
+			raptorq_fec_enc->has_retained_block = FALSE;
+			break;
+
+		case GST_STATE_CHANGE_READY_TO_NULL:
+			/* The number of source symbols can change in the NULL
+			 * state, so the code may not fit anymore afterwards */
+			gst_raptorq_fec_enc_release_code(raptorq_fec_enc);
+			break;
+
+		default:
+			break;
+	}
+
+	return result;
+}
+
+
+static guint gst_raptorq_fec_enc_get_payload_id_m(G_GNUC_UNUSED GstRSFECEnc *rs_fec_enc)
+{
+	return GST_RAPTORQ_FEC_PAYLOAD_ID_M;
+}
+
+
+static guint gst_raptorq_fec_enc_get_max_num_encoding_symbols(G_GNUC_UNUSED GstRSFECEnc *rs_fec_enc)
+{
+	return GST_RAPTORQ_FEC_MAX_NUM_ENCODING_SYMBOLS;
+}
+
+
+static gboolean gst_raptorq_fec_enc_check_settings(GstRSFECEnc *rs_fec_enc)
+{
+	if (rs_fec_enc->num_source_symbols > GST_RAPTORQ_MAX_NUM_SOURCE_SYMBOLS)
+	{
+		GST_ELEMENT_ERROR(
+			rs_fec_enc, LIBRARY, SETTINGS,
+			("invalid RaptorQ parameters"),
+			("number of source symbols: %u  maximum allowed: %u", rs_fec_enc->num_source_symbols, GST_RAPTORQ_MAX_NUM_SOURCE_SYMBOLS)
+		);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+static gboolean gst_raptorq_fec_enc_uses_openfec_session(G_GNUC_UNUSED GstRSFECEnc *rs_fec_enc)
+{
+	return FALSE;
+}
+
+
+static gsize gst_raptorq_fec_enc_get_encoding_symbol_length(G_GNUC_UNUSED GstRSFECEnc *rs_fec_enc, gsize max_adui_length)
+{
+	/* The code works with symbols of any length */
+	return max_adui_length;
+}
+
+
+static gboolean gst_raptorq_fec_enc_configure_session(GstRSFECEnc *rs_fec_enc, G_GNUC_UNUSED gsize encoding_symbol_length)
+{
+	GstRaptorQFECEnc *raptorq_fec_enc = GST_RAPTORQ_FEC_ENC(rs_fec_enc);
+
+	/* The code does not depend on the symbol length, so it only
+	 * needs to be fetched the first time. This is where the costly
+	 * part happens if the code for this k is not in the cache yet. */
+	if (raptorq_fec_enc->code != NULL)
+		return TRUE;
+
+	if ((raptorq_fec_enc->code = gst_raptorq_code_get(rs_fec_enc->num_source_symbols)) == NULL)
+	{
+		GST_ELEMENT_ERROR(rs_fec_enc, LIBRARY, INIT, ("could not construct RaptorQ code"), ("number of source symbols: %u", rs_fec_enc->num_source_symbols));
+		return FALSE;
+	}
+
+	GST_DEBUG_OBJECT(rs_fec_enc, "got RaptorQ code for %u source symbols; it has %u intermediate symbols", rs_fec_enc->num_source_symbols, gst_raptorq_code_get_num_intermediate_symbols(raptorq_fec_enc->code));
+
+	return TRUE;
+}
+
+
+static gboolean gst_raptorq_fec_enc_build_repair_symbols(GstRSFECEnc *rs_fec_enc, gsize encoding_symbol_length)
+{
+	GstRaptorQFECEnc *raptorq_fec_enc = GST_RAPTORQ_FEC_ENC(rs_fec_enc);
+	gsize intermediate_symbols_size;
+	guint i;
+
+	intermediate_symbols_size = gst_raptorq_code_get_num_intermediate_symbols(raptorq_fec_enc->code) * encoding_symbol_length;
+	if (intermediate_symbols_size != raptorq_fec_enc->intermediate_symbols_size)
+	{
+		g_free(raptorq_fec_enc->intermediate_symbols);
+		raptorq_fec_enc->intermediate_symbols = g_malloc(intermediate_symbols_size);
+		raptorq_fec_enc->intermediate_symbols_size = intermediate_symbols_size;
+	}
+
+	/* The source symbols are at the start of the encoding_symbol_table,
+	 * followed by the repair symbols (which point into the mapped FEC
+	 * repair packets) */
+	gst_raptorq_code_encode(raptorq_fec_enc->code, rs_fec_enc->encoding_symbol_table, raptorq_fec_enc->intermediate_symbols, encoding_symbol_length);
+
+	for (i = 0; i < rs_fec_enc->cur_num_repair_symbols; ++i)
+	{
+		guint esi = i + rs_fec_enc->num_source_symbols;
+		gst_raptorq_code_build_symbol(raptorq_fec_enc->code, raptorq_fec_enc->intermediate_symbols, esi, rs_fec_enc->encoding_symbol_table[esi], encoding_symbol_length);
+	}
+
+	/* Keep the intermediate symbols around for push-repair-symbols. While
+	 * repair symbols are built, the base class sets cur_source_block_nr
+	 * to the number of the block they belong to. (With interleaving,
+	 * this retains the last block of the interleaving group.) */
+	if (raptorq_fec_enc->unlimited_repair_symbols)
+	{
+		raptorq_fec_enc->has_retained_block = TRUE;
+		raptorq_fec_enc->retained_block_nr = rs_fec_enc->cur_source_block_nr;
+		raptorq_fec_enc->retained_symbol_length = encoding_symbol_length;
+		raptorq_fec_enc->retained_source_block_length = rs_fec_enc->cur_source_block_length;
+		raptorq_fec_enc->next_repair_esi = rs_fec_enc->num_source_symbols + rs_fec_enc->cur_num_repair_symbols;
+	}
+
+	return TRUE;
+}
+
+
+static void gst_raptorq_fec_enc_set_caps_fields(G_GNUC_UNUSED GstRSFECEnc *rs_fec_enc, G_GNUC_UNUSED GstCaps *caps)
+{
+	/* The code only depends on k, which is transmitted in the FEC
+	 * payload IDs, so there is nothing to add here */
+}
+
+
+static gboolean gst_raptorq_fec_enc_push_repair_symbols(GstRaptorQFECEnc *raptorq_fec_enc, guint num_repair_symbols)
+{
+	GstRSFECEnc *rs_fec_enc = GST_RS_FEC_ENC(raptorq_fec_enc);
+	gboolean ok = TRUE;
+	GstClockTime first_send_time, send_interval;
+	guint num_affordable_repair_symbols;
+	guint i;
+
+	/* Taking the stream lock serializes this with the chain function,
+	 * which replaces the retained source block */
+	GST_PAD_STREAM_LOCK(rs_fec_enc->sinkpad);
+
+	if (!raptorq_fec_enc->has_retained_block || rs_fec_enc->eos_received || !rs_fec_enc->segment_started)
+	{
+		GST_DEBUG_OBJECT(raptorq_fec_enc, "no source block retained - cannot push repair symbols");
+		ok = FALSE;
+		goto finish;
+	}
+
+	/* Do not pay for repair symbols whose ESIs are not available */
+	if (num_repair_symbols > (GST_RAPTORQ_MAX_ESI + 1 - raptorq_fec_enc->next_repair_esi))
+	{
+		GST_WARNING_OBJECT(raptorq_fec_enc, "all ESIs of source block #%u are used up", raptorq_fec_enc->retained_block_nr);
+		num_repair_symbols = GST_RAPTORQ_MAX_ESI + 1 - raptorq_fec_enc->next_repair_esi;
+		ok = FALSE;
+	}
+
+	/* These packets are part of the repair flow just like the ones of the
+	 * source blocks, so they are subject to the same bitrate budget and
+	 * pacing, and go through the base class' repair output queue. (If the
+	 * queue is in use, pushing them directly would reorder the flow.) */
+	num_affordable_repair_symbols = gst_rs_fec_enc_take_repair_budget(rs_fec_enc, num_repair_symbols, raptorq_fec_enc->retained_symbol_length + FEC_PAYLOAD_ID_LENGTH);
+	if (num_affordable_repair_symbols < num_repair_symbols)
+		ok = FALSE;
+	gst_rs_fec_enc_get_repair_send_times(rs_fec_enc, &first_send_time, &send_interval);
+
+	GST_LOG_OBJECT(raptorq_fec_enc, "pushing %u additional FEC repair packets for source block #%u", num_affordable_repair_symbols, raptorq_fec_enc->retained_block_nr);
+
+	for (i = 0; i < num_affordable_repair_symbols; ++i)
+	{
+		GstBuffer *fec_repair_packet;
+		GstMapInfo map_info;
+		guint esi = raptorq_fec_enc->next_repair_esi;
+		GstFlowReturn flow_ret;
+
+		fec_repair_packet = gst_buffer_new_allocate(NULL, raptorq_fec_enc->retained_symbol_length + FEC_PAYLOAD_ID_LENGTH, NULL);
+		gst_buffer_map(fec_repair_packet, &map_info, GST_MAP_WRITE);
+		gst_rs_fec_write_payload_id(map_info.data, GST_RAPTORQ_FEC_PAYLOAD_ID_M, raptorq_fec_enc->retained_block_nr, esi, raptorq_fec_enc->retained_source_block_length);
+		gst_raptorq_code_build_symbol(raptorq_fec_enc->code, raptorq_fec_enc->intermediate_symbols, esi, map_info.data + FEC_PAYLOAD_ID_LENGTH, raptorq_fec_enc->retained_symbol_length);
+		gst_buffer_unmap(fec_repair_packet, &map_info);
+
+		raptorq_fec_enc->next_repair_esi++;
+
+		if (rs_fec_enc->first_repair_packet)
+		{
+			GST_BUFFER_FLAG_SET(fec_repair_packet, GST_BUFFER_FLAG_DISCONT);
+			rs_fec_enc->first_repair_packet = FALSE;
+		}
+
+		/* offset and offset_end have no meaning here */
+		GST_BUFFER_OFFSET(fec_repair_packet) = -1;
+		GST_BUFFER_OFFSET_END(fec_repair_packet) = -1;
+
+		GST_LOG_OBJECT(raptorq_fec_enc, "pushing additional FEC repair packet:  source block nr: %u  ESI: %u", raptorq_fec_enc->retained_block_nr, esi);
+
+		if ((flow_ret = gst_rs_fec_enc_push_repair_packet(rs_fec_enc, fec_repair_packet, GST_CLOCK_TIME_IS_VALID(first_send_time) ? (first_send_time + i * send_interval) : GST_CLOCK_TIME_NONE)) != GST_FLOW_OK)
+		{
+			GST_DEBUG_OBJECT(raptorq_fec_enc, "got return value %s while pushing additional FEC repair packet", gst_flow_get_name(flow_ret));
+			ok = FALSE;
+			break;
+		}
+	}
+
+finish:
+	GST_PAD_STREAM_UNLOCK(rs_fec_enc->sinkpad);
+
+	return ok;
+}
+
+
+static void gst_raptorq_fec_enc_release_code(GstRaptorQFECEnc *raptorq_fec_enc)
+{
+	if (raptorq_fec_enc->code != NULL)
+	{
+		gst_raptorq_code_unref(raptorq_fec_enc->code);
+		raptorq_fec_enc->code = NULL;
+	}
+
+	g_free(raptorq_fec_enc->intermediate_symbols);
+	raptorq_fec_enc->intermediate_symbols = NULL;
+	raptorq_fec_enc->intermediate_symbols_size = 0;
+	raptorq_fec_enc->has_retained_block = FALSE;
+}
@@ -0,0 +1,94 @@
+/* RaptorQ-style rateless forward error correction for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef GSTFECFRAME_RAPTORQ_RAPTORQFECENC_H
+#define GSTFECFRAME_RAPTORQ_RAPTORQFECENC_H
+
+#include <gst/gst.h>
+#include "reed-solomon/gstrsfecenc.h"
+#include "gstraptorqcode.h"
+
+
+G_BEGIN_DECLS
+
+
+typedef struct _GstRaptorQFECEnc GstRaptorQFECEnc;
+typedef struct _GstRaptorQFECEncClass GstRaptorQFECEncClass;
+
+
+#define GST_TYPE_RAPTORQ_FEC_ENC             (gst_raptorq_fec_enc_get_type())
+#define GST_RAPTORQ_FEC_ENC(obj)             (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_RAPTORQ_FEC_ENC, GstRaptorQFECEnc))
+#define GST_RAPTORQ_FEC_ENC_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST((klass), GST_TYPE_RAPTORQ_FEC_ENC, GstRaptorQFECEncClass))
+#define GST_RAPTORQ_FEC_ENC_CAST(obj)        ((GstRaptorQFECEnc *)(obj))
+#define GST_IS_RAPTORQ_FEC_ENC(obj)          (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_RAPTORQ_FEC_ENC))
+#define GST_IS_RAPTORQ_FEC_ENC_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass), GST_TYPE_RAPTORQ_FEC_ENC))
+
+
+/* The RaptorQ encoder reuses the ADU handling, source block generation
+ * and FEC framing of the Reed-Solomon encoder. Only the repair symbol
+ * computation differs. The code-construction property of the base
+ * class has no effect here. */
+struct _GstRaptorQFECEnc
+{
+	GstRSFECEnc parent;
+
+	/* If TRUE, the intermediate symbols of the most recent source block
+	 * are retained after its repair packets were pushed, so that further
+	 * repair packets can be produced for it with the push-repair-symbols
+	 * action signal. Can only be modified if initialized is FALSE. */
+	gboolean unlimited_repair_symbols;
+
+	/* Code for the configured number of source symbols, taken from the
+	 * code cache once the encoder is configured for the first time */
+	GstRaptorQCode *code;
+
+	/* Intermediate symbols of the most recent source block. The buffer
+	 * is reused for subsequent blocks if its size fits. */
+	guint8 *intermediate_symbols;
+	gsize intermediate_symbols_size;
+
+	/* State of the retained source block (only used if
+	 * unlimited_repair_symbols is TRUE). next_repair_esi is the ESI
+	 * of the next repair symbol push-repair-symbols produces. */
+	gboolean has_retained_block;
+	guint retained_block_nr;
+	gsize retained_symbol_length;
+	/* Source block length written into the payload IDs of additional
+	 * repair packets; less than k if the block was shortened */
+	guint retained_source_block_length;
+	guint next_repair_esi;
+};
+
+
+struct _GstRaptorQFECEncClass
+{
+	GstRSFECEncClass parent_class;
+
+	/* Class handler of the push-repair-symbols action signal */
+	gboolean (*push_repair_symbols)(GstRaptorQFECEnc *raptorq_fec_enc, guint num_repair_symbols);
+};
+
+
+GType gst_raptorq_fec_enc_get_type(void);
+
+
+G_END_DECLS
+
+
+#endif
@@ -0,0 +1,204 @@
+/* Cauchy-matrix based Reed-Solomon erasure code
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include <string.h>
+#include "common/gstgf256.h"
+#include "gstrscauchy.h"
+
+
+static guint8 gst_rs_cauchy_get_column_scale(gboolean parity_first_row, guint num_source_symbols, guint source_index)
+{
+	/* x_0 + y_i if the first row shall be XOR parity, 1 otherwise */
+	return parity_first_row ? (((guint8)num_source_symbols) ^ ((guint8)source_index)) : 1;
+}
+
+
+static guint8 gst_rs_cauchy_get_coefficient(gboolean parity_first_row, guint num_source_symbols, guint repair_index, guint source_index)
+{
+	/* 1 / (x_j + y_i), with x_j = k + j and y_i = i. In GF(2^8),
+	 * addition is XOR. x_j and y_i are always different, so the
+	 * sum is never zero. */
+	guint8 x = num_source_symbols + repair_index;
+	guint8 y = source_index;
+
+	/* With a scale of x_0 + y_i, the coefficients of the first
+	 * row are exactly 1, so skip the table lookups for them */
+	if (parity_first_row && (repair_index == 0))
+		return 1;
+
+	return gst_fec_gf256_div(gst_rs_cauchy_get_column_scale(parity_first_row, num_source_symbols, source_index), x ^ y);
+}
+
+
+void gst_rs_cauchy_build_repair_symbol(gboolean parity_first_row, guint num_source_symbols, void * const *encoding_symbol_table, guint esi, gsize encoding_symbol_length)
+{
+	guint i;
+	guint repair_index = esi - num_source_symbols;
+	guint8 *repair_symbol = encoding_symbol_table[esi];
+	/* Uses specialised functions if the symbol length is a common one */
+	GstFECGF256RegionOps const *region_ops = gst_fec_gf256_get_region_ops(encoding_symbol_length);
+
+	g_assert(esi >= num_source_symbols);
+	g_assert(esi < 256);
+
+	/* The first product initializes the repair symbol, which
+	 * spares an extra memset() call */
+	region_ops->region_mul(repair_symbol, encoding_symbol_table[0], gst_rs_cauchy_get_coefficient(parity_first_row, num_source_symbols, repair_index, 0), encoding_symbol_length);
+	for (i = 1; i < num_source_symbols; ++i)
+		region_ops->region_mul_add(repair_symbol, encoding_symbol_table[i], gst_rs_cauchy_get_coefficient(parity_first_row, num_source_symbols, repair_index, i), encoding_symbol_length);
+}
+
+
+gboolean gst_rs_cauchy_decode(gboolean parity_first_row, guint num_source_symbols, guint num_repair_symbols, void * const *received_encoding_symbol_table, void * const *recovered_source_symbol_table, gsize encoding_symbol_length)
+{
+	guint8 missing_esis[256], repair_indices[256];
+	guint8 a[256], b[256];
+	guint8 p[256], q[256], s[256], t[256];
+	guint num_missing = 0, num_repair = 0;
+	guint i, j, l;
+	guint8 *syndromes;
+	GstFECGF256RegionOps const *region_ops = gst_fec_gf256_get_region_ops(encoding_symbol_length);
+
+	g_assert((num_source_symbols + num_repair_symbols) <= 256);
+
+	/* Find out which source symbols are missing */
+	for (i = 0; i < num_source_symbols; ++i)
+	{
+		if (received_encoding_symbol_table[i] == NULL)
+			missing_esis[num_missing++] = i;
+	}
+
+	if (num_missing == 0)
+		return TRUE;
+
+	/* Single erasure fast path: if the first row is XOR parity, exactly one
+	 * source symbol is missing, and the parity symbol is present, then the
+	 * missing symbol is the XOR of the parity symbol and all received source
+	 * symbols. This bypasses the matrix code entirely. */
+	if (parity_first_row && (num_missing == 1) && (num_repair_symbols > 0) && (received_encoding_symbol_table[num_source_symbols] != NULL))
+	{
+		guint8 *recovered_symbol = recovered_source_symbol_table[missing_esis[0]];
+
+		g_assert(recovered_symbol != NULL);
+
+		memcpy(recovered_symbol, received_encoding_symbol_table[num_source_symbols], encoding_symbol_length);
+		for (i = 0; i < num_source_symbols; ++i)
+		{
+			if (i != missing_esis[0])
+				gst_fec_xor_region(recovered_symbol, received_encoding_symbol_table[i], encoding_symbol_length);
+		}
+
+		return TRUE;
+	}
+
+	/* Pick as many received repair symbols as there are missing source symbols */
+	for (j = 0; (j < num_repair_symbols) && (num_repair < num_missing); ++j)
+	{
+		if (received_encoding_symbol_table[num_source_symbols + j] != NULL)
+			repair_indices[num_repair++] = j;
+	}
+
+	if (num_repair < num_missing)
+		return FALSE;
+
+	/* Compute the syndromes: for each picked repair symbol, subtract the
+	 * contributions of the received source symbols. What remains is the
+	 * sum of the contributions of the missing source symbols. This is the
+	 * right-hand side of a num_missing x num_missing linear system whose
+	 * matrix is a square submatrix of the Cauchy matrix. */
+	syndromes = g_malloc(num_missing * encoding_symbol_length);
+	for (j = 0; j < num_missing; ++j)
+	{
+		guint8 *syndrome = syndromes + j * encoding_symbol_length;
+
+		memcpy(syndrome, received_encoding_symbol_table[num_source_symbols + repair_indices[j]], encoding_symbol_length);
+		for (i = 0; i < num_source_symbols; ++i)
+		{
+			if (received_encoding_symbol_table[i] != NULL)
+				region_ops->region_mul_add(syndrome, received_encoding_symbol_table[i], gst_rs_cauchy_get_coefficient(parity_first_row, num_source_symbols, repair_indices[j], i), encoding_symbol_length);
+		}
+	}
+
+	/* The submatrix is A[j][i] = 1 / (a_j + b_i), with a_j being the
+	 * x value of the j-th picked repair symbol, and b_i being the y value
+	 * of the i-th missing source symbol. Its inverse is:
+	 *
+	 *   A^-1[i][j] = (p_j * q_i) / ((a_j + b_i) * s_j * t_i)
+	 *
+	 *   p_j = product over l of (a_j + b_l)
+	 *   q_i = product over l of (a_l + b_i)
+	 *   s_j = product over l != j of (a_j + a_l)
+	 *   t_i = product over l != i of (b_i + b_l)
+	 *
+	 * (Subtraction equals addition in GF(2^8), so there are no signs.)
+	 * Computing these products takes O(num_missing^2) steps. */
+	for (j = 0; j < num_missing; ++j)
+	{
+		a[j] = num_source_symbols + repair_indices[j];
+		b[j] = missing_esis[j];
+	}
+
+	for (j = 0; j < num_missing; ++j)
+	{
+		p[j] = q[j] = s[j] = t[j] = 1;
+		for (l = 0; l < num_missing; ++l)
+		{
+			p[j] = gst_fec_gf256_mul(p[j], a[j] ^ b[l]);
+			q[j] = gst_fec_gf256_mul(q[j], a[l] ^ b[j]);
+			if (l != j)
+			{
+				s[j] = gst_fec_gf256_mul(s[j], a[j] ^ a[l]);
+				t[j] = gst_fec_gf256_mul(t[j], b[j] ^ b[l]);
+			}
+		}
+	}
+
+	/* Fold the per-row and per-column factors together, so only
+	 * one division remains per matrix element. p and q are reused
+	 * for storing p_j/s_j and q_i/t_i. If the columns were scaled,
+	 * the system yields the scaled source symbols, so undo the
+	 * scaling by dividing q_i by the column scale as well. */
+	for (j = 0; j < num_missing; ++j)
+	{
+		p[j] = gst_fec_gf256_div(p[j], s[j]);
+		q[j] = gst_fec_gf256_div(gst_fec_gf256_div(q[j], t[j]), gst_rs_cauchy_get_column_scale(parity_first_row, num_source_symbols, b[j]));
+	}
+
+	/* Multiply the inverse with the syndromes to get the missing source symbols */
+	for (i = 0; i < num_missing; ++i)
+	{
+		guint8 *recovered_symbol = recovered_source_symbol_table[missing_esis[i]];
+
+		g_assert(recovered_symbol != NULL);
+
+		for (j = 0; j < num_missing; ++j)
+		{
+			guint8 coefficient = gst_fec_gf256_div(gst_fec_gf256_mul(p[j], q[i]), a[j] ^ b[i]);
+
+			if (j == 0)
+				region_ops->region_mul(recovered_symbol, syndromes, coefficient, encoding_symbol_length);
+			else
+				region_ops->region_mul_add(recovered_symbol, syndromes + j * encoding_symbol_length, coefficient, encoding_symbol_length);
+		}
+	}
+
+	g_free(syndromes);
+
+	return TRUE;
+}
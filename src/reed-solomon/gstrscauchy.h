@@ -0,0 +1,69 @@
+/* Cauchy-matrix based Reed-Solomon erasure code
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef GSTFECFRAME_REED_SOLOMON_RSCAUCHY_H
+#define GSTFECFRAME_REED_SOLOMON_RSCAUCHY_H
+
+#include <gst/gst.h>
+
+
+G_BEGIN_DECLS
+
+
+/* Systematic Reed-Solomon erasure code over GF(2^8) whose repair symbols
+ * are generated by a Cauchy matrix instead of the RFC 6865 Vandermonde
+ * matrix. Repair symbol j (ESI k+j) is computed as:
+ *
+ *   repair_j = sum over i in 0..k-1 of  source_i / (x_j + y_i)
+ *
+ * with x_j = k + j and y_i = i. All x and y values are distinct, so
+ * every square submatrix of this matrix is invertible, and any k
+ * received encoding symbols suffice for recovering the source symbols.
+ * Unlike with Vandermonde matrices, the inverse of such a submatrix
+ * is available in closed form, which brings the cost of setting up
+ * the decoder for a new erasure pattern down from O(k^3) to O(k^2).
+ *
+ * If parity_first_row is TRUE, each column i of the matrix is scaled by
+ * (x_0 + y_i). This turns the first row into all ones, so the first repair
+ * symbol (ESI k) is the plain XOR of all source symbols, and a single lost
+ * source symbol can be recovered by XORing without any GF multiplications.
+ * Scaling columns by nonzero values keeps all square submatrices
+ * invertible, so the code stays MDS.
+ *
+ * k+r must not exceed 256. The symbol tables have the same layout as
+ * the ones used by OpenFEC: source symbols come first, followed by the
+ * repair symbols, and the array index equals the ESI. */
+
+
+void gst_rs_cauchy_build_repair_symbol(gboolean parity_first_row, guint num_source_symbols, void * const *encoding_symbol_table, guint esi, gsize encoding_symbol_length);
+
+/* Recovers all source symbols whose entries in received_encoding_symbol_table
+ * (which is num_source_symbols+num_repair_symbols long) are NULL. The recovered
+ * symbols are written into the memory blocks that recovered_source_symbol_table
+ * (which is num_source_symbols long) points to at these indices. Returns FALSE
+ * if not enough encoding symbols were received. If parity_first_row is TRUE,
+ * and only one source symbol is missing while the XOR parity symbol is present,
+ * the missing symbol is recovered by XORing, without any GF multiplications. */
+gboolean gst_rs_cauchy_decode(gboolean parity_first_row, guint num_source_symbols, guint num_repair_symbols, void * const *received_encoding_symbol_table, void * const *recovered_source_symbol_table, gsize encoding_symbol_length);
+
+
+G_END_DECLS
+
+
+#endif
@@ -0,0 +1,196 @@
+/* RFC 6865-based forward error correction based on Reed-Solomon for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include <string.h>
+#include "gstrsfeccommon.h"
+#include "gstrsfft.h"
+
+
+/* The value nicks double as the names used in the caps */
+static GEnumValue const code_construction_values[] =
+{
+	{ GST_RS_FEC_CODE_CONSTRUCTION_VANDERMONDE, "Vandermonde matrix (RFC 6865)", "vandermonde" },
+	{ GST_RS_FEC_CODE_CONSTRUCTION_CAUCHY, "Cauchy matrix (not interoperable with other RFC 6865 implementations)", "cauchy" },
+	{ GST_RS_FEC_CODE_CONSTRUCTION_PARITY_CAUCHY, "XOR parity as first repair symbol, Cauchy matrix for the others (not interoperable with other RFC 6865 implementations)", "parity-cauchy" },
+	{ GST_RS_FEC_CODE_CONSTRUCTION_GF16_FFT, "GF(2^16) with additive FFT, for very large source blocks (not interoperable with other RFC 6865 implementations)", "gf16-fft" },
+	{ 0, NULL, NULL }
+};
+
+
+GType gst_rs_fec_code_construction_get_type(void)
+{
+	static volatile gsize code_construction_type = 0;
+
+	if (g_once_init_enter(&code_construction_type))
+	{
+		GType type = g_enum_register_static("GstRSFECCodeConstruction", code_construction_values);
+		g_once_init_leave(&code_construction_type, type);
+	}
+
+	return code_construction_type;
+}
+
+
+gchar const * gst_rs_fec_code_construction_get_name(GstRSFECCodeConstruction code_construction)
+{
+	GEnumValue const *value;
+
+	for (value = code_construction_values; value->value_nick != NULL; ++value)
+	{
+		if (value->value == (gint)code_construction)
+			return value->value_nick;
+	}
+
+	return "<unknown>";
+}
+
+
+gboolean gst_rs_fec_code_construction_from_caps(GstCaps const *caps, GstRSFECCodeConstruction *code_construction)
+{
+	GEnumValue const *value;
+	GstStructure const *s = gst_caps_get_structure(caps, 0);
+	gchar const *name = gst_structure_get_string(s, GST_RS_FEC_CODE_CONSTRUCTION_CAPS_FIELD);
+
+	if (name == NULL)
+	{
+		*code_construction = GST_RS_FEC_CODE_CONSTRUCTION_VANDERMONDE;
+		return TRUE;
+	}
+
+	for (value = code_construction_values; value->value_nick != NULL; ++value)
+	{
+		if (strcmp(value->value_nick, name) == 0)
+		{
+			*code_construction = value->value;
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+
+gboolean gst_rs_fec_num_symbols_from_caps(GstCaps const *caps, guint *num_source_symbols, guint *num_repair_symbols)
+{
+	gint k, r;
+	GstStructure const *s = gst_caps_get_structure(caps, 0);
+
+	if (!gst_structure_get_int(s, GST_RS_FEC_NUM_SOURCE_SYMBOLS_CAPS_FIELD, &k) || !gst_structure_get_int(s, GST_RS_FEC_NUM_REPAIR_SYMBOLS_CAPS_FIELD, &r))
+		return FALSE;
+
+	if ((k < 1) || (r < 0))
+		return FALSE;
+
+	*num_source_symbols = k;
+	*num_repair_symbols = r;
+
+	return TRUE;
+}
+
+
+guint gst_rs_fec_code_construction_get_m(GstRSFECCodeConstruction code_construction)
+{
+	return (code_construction == GST_RS_FEC_CODE_CONSTRUCTION_GF16_FFT) ? 16 : 8;
+}
+
+
+guint gst_rs_fec_code_construction_get_max_num_encoding_symbols(GstRSFECCodeConstruction code_construction)
+{
+	/* With Reed-Solomon, up to 2^m - 1 encoding symbols can be used */
+	return (1u << gst_rs_fec_code_construction_get_m(code_construction)) - 1;
+}
+
+
+gboolean gst_rs_fec_code_construction_check_num_symbols(GstRSFECCodeConstruction code_construction, guint num_source_symbols, guint num_repair_symbols)
+{
+	if ((num_source_symbols + num_repair_symbols) > gst_rs_fec_code_construction_get_max_num_encoding_symbols(code_construction))
+		return FALSE;
+
+	/* The FFT additionally needs room for rounding up
+	 * the number of repair symbols to a power of two */
+	if (code_construction == GST_RS_FEC_CODE_CONSTRUCTION_GF16_FFT)
+		return gst_rs_fft_check_parameters(num_source_symbols, num_repair_symbols);
+
+	return TRUE;
+}
+
+
+void gst_rs_fec_write_payload_id(guint8 *payload_id, guint m, guint source_block_nr, guint esi, guint num_source_symbols)
+{
+	/* source block nr and ESI together make up the first 32 bits */
+	guint32 sbn_esi = ((source_block_nr & ((1u << (32 - m)) - 1)) << m) | (esi & ((1u << m) - 1));
+
+	payload_id[0] = (sbn_esi >> 24) & 0xFF;
+	payload_id[1] = (sbn_esi >> 16) & 0xFF;
+	payload_id[2] = (sbn_esi >> 8) & 0xFF;
+	payload_id[3] = (sbn_esi >> 0) & 0xFF;
+	/* source block length (16-bit value) */
+	payload_id[4] = (num_source_symbols & 0xFF00) >> 8;
+	payload_id[5] = (num_source_symbols & 0x00FF) >> 0;
+}
+
+
+void gst_rs_fec_read_payload_id(guint8 const *payload_id, guint m, guint *source_block_nr, guint *esi, guint *num_source_symbols)
+{
+	guint32 sbn_esi = (((guint32)(payload_id[0])) << 24) | (((guint32)(payload_id[1])) << 16) | (((guint32)(payload_id[2])) << 8) | ((guint32)(payload_id[3]));
+
+	if (source_block_nr != NULL)
+		*source_block_nr = sbn_esi >> m;
+	if (esi != NULL)
+		*esi = sbn_esi & ((1u << m) - 1);
+	if (num_source_symbols != NULL)
+		*num_source_symbols = (((guint)(payload_id[4])) << 8) | ((guint)(payload_id[5]));
+}
+
+
+void gst_rs_fec_write_fragment_header(guint8 *header, guint adu_nr, guint fragment_index, gboolean is_last_fragment)
+{
+	guint16 index_and_flag = (fragment_index & 0x7FFF) | (is_last_fragment ? 0x8000 : 0);
+
+	header[0] = (adu_nr >> 8) & 0xFF;
+	header[1] = (adu_nr >> 0) & 0xFF;
+	header[2] = (index_and_flag >> 8) & 0xFF;
+	header[3] = (index_and_flag >> 0) & 0xFF;
+}
+
+
+void gst_rs_fec_read_fragment_header(guint8 const *header, guint *adu_nr, guint *fragment_index, gboolean *is_last_fragment)
+{
+	guint index_and_flag = (((guint)(header[2])) << 8) | ((guint)(header[3]));
+
+	*adu_nr = (((guint)(header[0])) << 8) | ((guint)(header[1]));
+	*fragment_index = index_and_flag & 0x7FFF;
+	*is_last_fragment = (index_and_flag & 0x8000) != 0;
+}
+
+
+void gst_rs_fec_write_timestamp_header(guint8 *header, GstClockTime pts, GstClockTime duration)
+{
+	/* GST_CLOCK_TIME_NONE is all bits set, so
+	 * it needs no special treatment here */
+	GST_WRITE_UINT64_BE(header + 0, pts);
+	GST_WRITE_UINT64_BE(header + 8, duration);
+}
+
+
+void gst_rs_fec_read_timestamp_header(guint8 const *header, GstClockTime *pts, GstClockTime *duration)
+{
+	*pts = GST_READ_UINT64_BE(header + 0);
+	*duration = GST_READ_UINT64_BE(header + 8);
+}
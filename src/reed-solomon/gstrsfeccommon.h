@@ -0,0 +1,144 @@
+/* RFC 6865-based forward error correction based on Reed-Solomon for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef GSTFECFRAME_REED_SOLOMON_RSFECCOMMON_H
+#define GSTFECFRAME_REED_SOLOMON_RSFECCOMMON_H
+
+#include <gst/gst.h>
+
+
+G_BEGIN_DECLS
+
+
+/* How the repair symbols of a source block are computed.
+ *
+ * VANDERMONDE is the construction specified by RFC 6865, and is
+ * implemented by OpenFEC. CAUCHY, PARITY_CAUCHY and GF16_FFT are not
+ * part of any RFC; they are only usable if both ends of the
+ * transmission are rsfecenc/rsfecdec elements. Both ends must use the
+ * same construction. The encoder signals its construction in the caps
+ * of its source pads, and the decoder refuses caps with a construction
+ * that differs from its own. Caps without the construction field are
+ * treated as VANDERMONDE. */
+typedef enum
+{
+	GST_RS_FEC_CODE_CONSTRUCTION_VANDERMONDE,
+	GST_RS_FEC_CODE_CONSTRUCTION_CAUCHY,
+	/* Like CAUCHY, but the first repair symbol is the XOR
+	 * parity of all source symbols */
+	GST_RS_FEC_CODE_CONSTRUCTION_PARITY_CAUCHY,
+	/* Reed-Solomon over GF(2^16), encoded and decoded with
+	 * the additive FFT (see gstrsfft.h) */
+	GST_RS_FEC_CODE_CONSTRUCTION_GF16_FFT
+}
+GstRSFECCodeConstruction;
+
+
+#define GST_TYPE_RS_FEC_CODE_CONSTRUCTION (gst_rs_fec_code_construction_get_type())
+#define GST_RS_FEC_CODE_CONSTRUCTION_CAPS_FIELD "code-construction"
+
+
+GType gst_rs_fec_code_construction_get_type(void);
+
+gchar const * gst_rs_fec_code_construction_get_name(GstRSFECCodeConstruction code_construction);
+/* Reads the construction from the caps. Returns FALSE if the field
+ * contains an unknown construction name. */
+gboolean gst_rs_fec_code_construction_from_caps(GstCaps const *caps, GstRSFECCodeConstruction *code_construction);
+
+/* Returns the m value from RFC 6865 (the code uses GF(2^m)) */
+guint gst_rs_fec_code_construction_get_m(GstRSFECCodeConstruction code_construction);
+/* Returns the maximum allowed value for k+r */
+guint gst_rs_fec_code_construction_get_max_num_encoding_symbols(GstRSFECCodeConstruction code_construction);
+/* Returns FALSE if the construction cannot be used with the given number
+ * of source and repair symbols */
+gboolean gst_rs_fec_code_construction_check_num_symbols(GstRSFECCodeConstruction code_construction, guint num_source_symbols, guint num_repair_symbols);
+
+/* Caps fields with the number of source and repair symbols (k and n-k)
+ * the encoder currently uses. They are added by encoders that can change
+ * these numbers while running. Since CAPS events are serialized, the
+ * values apply to the FEC packets that follow the event on the same pad.
+ * Both fields are of type int. */
+#define GST_RS_FEC_NUM_SOURCE_SYMBOLS_CAPS_FIELD "num-source-symbols"
+#define GST_RS_FEC_NUM_REPAIR_SYMBOLS_CAPS_FIELD "num-repair-symbols"
+
+/* Reads the number of source and repair symbols from the caps. Returns
+ * FALSE if the caps do not contain both fields, or if they are invalid. */
+gboolean gst_rs_fec_num_symbols_from_caps(GstCaps const *caps, guint *num_source_symbols, guint *num_repair_symbols);
+
+/* Write and read RFC 6865 FEC payload IDs. The layout depends on m: the
+ * source block number has 32-m bits, the ESI has m bits, and the source
+ * block length (k) always has 16 bits. All values are big endian. Any
+ * of the output pointers of the read function may be NULL. */
+void gst_rs_fec_write_payload_id(guint8 *payload_id, guint m, guint source_block_nr, guint esi, guint num_source_symbols);
+void gst_rs_fec_read_payload_id(guint8 const *payload_id, guint m, guint *source_block_nr, guint *esi, guint *num_source_symbols);
+
+/* Boolean caps field which is set to TRUE by encoders that split ADUs into
+ * fragments. Each fragment is then carried as a separate ADU, which starts
+ * with a fragment header of GST_RS_FEC_FRAGMENT_HEADER_SIZE bytes:
+ *   bits 31-16 : ADU number (incremented for each ADU, wraps around)
+ *   bit  15    : set in the last fragment of the ADU
+ *   bits 14-0  : fragment index within the ADU
+ * All values are big endian. The header is part of the ADU, and is
+ * therefore protected by the repair symbols like the ADU data. */
+#define GST_RS_FEC_FRAGMENTED_CAPS_FIELD "fragmented"
+#define GST_RS_FEC_FRAGMENT_HEADER_SIZE 4
+#define GST_RS_FEC_MAX_NUM_FRAGMENTS (1u << 15)
+
+void gst_rs_fec_write_fragment_header(guint8 *header, guint adu_nr, guint fragment_index, gboolean is_last_fragment);
+void gst_rs_fec_read_fragment_header(guint8 const *header, guint *adu_nr, guint *fragment_index, gboolean *is_last_fragment);
+
+/* Boolean caps field which is set to TRUE by encoders that pack several
+ * small ADUs into one source symbol. Each ADU that is passed to the FEC
+ * scheme is then a "pack", which consists of one or more entries. Each
+ * entry is an ADU, prepended with its length as a 16-bit big endian value
+ * (GST_RS_FEC_PACK_ENTRY_HEADER_SIZE bytes). If both packing and
+ * fragmentation are used, the fragments are packed. */
+#define GST_RS_FEC_PACKED_CAPS_FIELD "packed"
+#define GST_RS_FEC_PACK_ENTRY_HEADER_SIZE 2
+
+/* Boolean caps field which is set to TRUE by encoders that transmit the
+ * timestamps of the ADUs. Each ADU is then prepended with a timestamp
+ * header of GST_RS_FEC_TIMESTAMP_HEADER_SIZE bytes:
+ *   bytes 0-7  : PTS, as running time, in nanoseconds
+ *   bytes 8-15 : duration, in nanoseconds
+ * All values are big endian; all bits set means GST_CLOCK_TIME_NONE.
+ * The header is added before the ADU is fragmented or packed, so each
+ * ADU carries one header, and the decoder strips it after unpacking
+ * and reassembling. */
+#define GST_RS_FEC_TIMESTAMPED_CAPS_FIELD "timestamped"
+#define GST_RS_FEC_TIMESTAMP_HEADER_SIZE 16
+
+void gst_rs_fec_write_timestamp_header(guint8 *header, GstClockTime pts, GstClockTime duration);
+void gst_rs_fec_read_timestamp_header(guint8 const *header, GstClockTime *pts, GstClockTime *duration);
+
+
+/* Name of the GstStructure of loss reports. Decoders send these reports as
+ * upstream custom events (and post them as element messages, so applications
+ * can relay them to a remote encoder). Encoders use them to adapt the number
+ * of repair symbols. Fields:
+ *   "lost-source-symbols"  (guint)   : source symbols not received
+ *   "num-source-symbols"   (guint)   : source symbols sent
+ *   "loss-rate"            (gdouble) : lost-source-symbols / num-source-symbols */
+#define GST_FEC_LOSS_REPORT_STRUCTURE_NAME "GstFECLossReport"
+
+
+G_END_DECLS
+
+
+#endif
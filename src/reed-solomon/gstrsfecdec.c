@@ -35,6 +35,17 @@
  * generating repair symbols and recovering lost source symbols (if enough
  * encoding symbols have been received).
  *
+ * Alternatively, the "code-construction" property can be set to "cauchy".
+ * Recovery is then done by an in-plugin Cauchy matrix decoder (see
+ * gstrscauchy.h), which inverts the erasure pattern's matrix in O(k^2)
+ * instead of O(k^3). The "parity-cauchy" construction additionally makes
+ * the first repair symbol an XOR parity symbol. If only one source symbol
+ * of a block is missing and the parity symbol was received, the lost symbol
+ * is recovered by XORing the received symbols, bypassing the matrix code.
+ * This requires an encoder that uses the same construction. The encoder
+ * signals its construction in the caps; caps whose construction does not
+ * match the property are refused.
+ *
  * The decoder works by keeping a "source block table". This hash table uses
  * source block numbers as keys, and pointers to corresponding source blocks
  * as values. When a FEC source or repair packet is received, its source
@@ -80,7 +91,8 @@
  * 5, and the source block number of a FEC packet is 4, then it is a bit older
  * (distance 1). If the number is 6, it is newer (again, distance 1). If the distance
  * is larger than max_source_block_age, the number is considered to be "too old".
- * This check wraps around the 2^24 range of source block numbers. If for example
+ * This check wraps around the 2^24 range of source block numbers (2^16 with
+ * the gf16-fft construction; all of the numbers given here scale accordingly). If for example
  * max_source_block_age is 2, and most_recent_block_nr is 0, it means that source
  * block numbers 0 and 16777215 are OK, but 16777214 is too old, and 1 is newer.
  * Anything from (most_recent_block_nr+1) to (most_recent_block_nr+2^22)%(2^22) is
@@ -89,18 +101,100 @@
  * This mechanism implies that max_source_block_age has an influence on the decoder's
  * latency, just as num_source_symbols has. Too large values mean that the latency
  * can become large as well.
+ *
+ * The decoder answers latency queries with an estimate of this latency. It measures
+ * the average interval between incoming source packets, and multiplies it with
+ * (max_source_block_age + 1) * k, since a source packet may have to wait for that
+ * many source packets before its block is finished or pruned. With sorted output,
+ * this is added to both the minimum and maximum latency; otherwise, only recovered
+ * ADUs are delayed, so it is only added to the maximum latency. Whenever the estimate
+ * changes by more than 10%, a latency message is posted, so the pipeline can
+ * redistribute the latency.
+ *
+ * If the "loss-report-interval" property is set to N > 0, the decoder counts
+ * how many source symbols were lost, and sends a loss report every N source
+ * blocks. The report is sent as an upstream custom event through the fecsource
+ * pad, which reaches the encoder directly in a local pipeline, and is also
+ * posted as an element message, so that applications can forward it to a
+ * remote encoder (for example, by setting the encoder's "loss-rate" property).
+ * Losses are counted when source blocks are destroyed, so FEC source packets
+ * that arrive after their block was completed or pruned count as lost.
+ *
+ * The decoder configures itself from the incoming packets, so its k and n do
+ * not have to match the encoder's, and the encoder can change them while
+ * running. The k of each source block is taken from the source block length
+ * field in the FEC payload ID of its FEC source packets (which always carries
+ * the unshortened k), and n-k from the "num-source-symbols" and
+ * "num-repair-symbols" fields of the caps of the pad the packets arrive at.
+ * Since caps are serialized, each packet is interpreted with the caps that were
+ * valid when it was sent. If the caps lack these fields (for example because
+ * the caps were set manually on a udpsrc), FEC repair packets that arrive
+ * before any FEC source packet of their block are kept until one arrives, and
+ * the "num-repair-symbols" property is used as n-k. With the Vandermonde and
+ * Cauchy constructions, the repair symbols do not depend on n, so a block's n-k
+ * is simply raised if a repair packet with a larger ESI shows up. The gf16-fft
+ * construction needs the exact n, which then must come from the caps or the
+ * property. The symbol tables are allocated for the "max-source-symbols" and
+ * "max-repair-symbols" properties (or for num-source-symbols and
+ * num-repair-symbols if these are 0), and grow on demand when a block with
+ * larger numbers arrives.
+ *
+ * If the encoder splits ADUs into fragments (see its "max-fragment-size"
+ * property), it adds "fragmented=true" to its caps. The decoder then strips the
+ * fragment header from each outgoing ADU, and only pushes the reassembled ADU
+ * once its last fragment is output. Since the output is sorted, a fragment
+ * that does not follow the previous one means that fragments were lost for
+ * good, and the partial ADU is discarded. If the caps do not reach the decoder,
+ * the "reassemble-fragments" property can be set to TRUE instead.
+ *
+ * Likewise, if the encoder packs several small ADUs into one source symbol
+ * (see its "pack-size" property), the caps contain "packed=true", and each
+ * outgoing ADU is unpacked into the ADUs it contains (before fragments are
+ * reassembled). The "unpack-adus" property enables this without caps.
+ *
+ * If the encoder transmits timestamps (see its "transmit-timestamps" property),
+ * the caps contain "timestamped=true", and each ADU starts with a timestamp
+ * header, which is stripped once the ADU is unpacked and reassembled. The ADU
+ * then gets the PTS and duration from the header instead of the arrival time,
+ * so recovered ADUs have the same timestamps as they had at the encoder. The
+ * PTS is the encoder's running time, so downstream sinks that synchronize to
+ * the clock may need an offset. The "restore-timestamps" property enables this
+ * without caps.
+ *
+ * If the encoder sliced a byte stream into small ADUs (see its "adu-size"
+ * property), pushing each ADU as its own buffer is wasteful. If the
+ * "output-buffer-size" property is nonzero, outgoing ADUs are collected, and
+ * pushed as one buffer once it holds at least that many bytes. The collected
+ * ADUs refer to the memory of the received packets, so no bytes are copied.
+ * Note that ADUs wait in this buffer until enough data arrives (or until EOS),
+ * so it adds latency.
+ *
+ * After a recovery, the ADUs of the recovered block are pushed in one burst,
+ * which downstream decoders and re-senders have to absorb. If the "paced-output"
+ * property is set to TRUE, outgoing buffers are pushed by a task on the srcpad
+ * instead, which waits (using the system clock) until each buffer is due. A
+ * buffer is due one spacing after the previous one; the spacing is the PTS
+ * difference with transmitted timestamps (see "restore-timestamps"), and the
+ * average interval between source packets otherwise. If the schedule falls
+ * behind, the buffer is pushed right away. Buffers are never held back longer
+ * than PACED_OUTPUT_MAX_DELAY, which is added to both the reported minimum and
+ * maximum latency, since every buffer may be held back that long.
  */
 
 
-/* NOTE: Currently, only GF(2^8) Reed-Solomon is supported. RFC 6865 however also
- * mentions support for GF(2^m), where 2 <= m <= 16. OpenFEC currently does not support
- * GF(2^m) unless m is 4 or 8. Therefore, only GF(2^8) is supported in this element
- * for now. Once OpenFEC has been extended to support the necessary range for m,
- * reevaluate. */
+/* NOTE: RFC 6865 mentions support for GF(2^m), where 2 <= m <= 16. OpenFEC currently
+ * does not support GF(2^m) unless m is 4 or 8. Therefore, the OpenFEC based Vandermonde
+ * construction and the Cauchy constructions use GF(2^8). The "gf16-fft" construction
+ * uses GF(2^16) with an in-plugin codec, and the m=16 FEC payload ID layout (16-bit
+ * source block number, 16-bit ESI). This also affects the wrap-around of the source
+ * block numbers (see below). */
 
 
 #include <stdlib.h>
 #include <string.h>
+#include "common/gstgf256.h"
+#include "gstrscauchy.h"
+#include "gstrsfft.h"
 #include "gstrsfecdec.h"
 
 
@@ -115,59 +209,66 @@ enum
 	PROP_NUM_REPAIR_SYMBOLS,
 	PROP_MAX_SOURCE_BLOCK_AGE,
 	PROP_DO_TIMESTAMP,
-	PROP_SORT_OUTPUT
+	PROP_SORT_OUTPUT,
+	PROP_CODE_CONSTRUCTION,
+	PROP_LOSS_REPORT_INTERVAL,
+	PROP_MAX_SOURCE_SYMBOLS,
+	PROP_MAX_REPAIR_SYMBOLS,
+	PROP_REASSEMBLE_FRAGMENTS,
+	PROP_UNPACK_ADUS,
+	PROP_OUTPUT_BUFFER_SIZE,
+	PROP_MAX_SYMBOL_LENGTH,
+	PROP_RESTORE_TIMESTAMPS,
+	PROP_PACED_OUTPUT
 };
 
 
-typedef struct
-{
-	/* Number of this source block */
-	guint block_nr;
-
-	/* Bitmask for identifying which packets are present.
-	 * 1 = FEC source/repair packet present. 0 = missing.
-	 * The bit number corresponds to the ESI of the packet.
-	 * 8 64-bit integers, since the maximum number of encoding
-	 * symbols is 255. */
-	/* NOTE: the limit is 255 if m=8, since with Reed-Solomon,
-	 * up to 2^m - 1 encoding symbols can be used. If m != 8,
-	 * the limit won't be 255 ! (See the top of this file.) */
-	guint64 packet_mask[8];
-
-	/* Lists containing received source and repair packets.
-	 * the entries are _not_ ordered according to the packet ESIs,
-	 * since ordering is done implicitely later during the
-	 * source block processing. */
-	GSList *source_packets, *repair_packets;
-	/* How many source and repair packets are currently contained
-	 * in the lists. */
-	guint num_source_packets, num_repair_packets;
-
-	/* Table holding the GstBuffers of the ADUs that will be
-	 * pushed downstream when this source block is pruned. */
-	GstBuffer **output_adu_table;
-
-	/* If TRUE, then this source block has been processed,
-	 * all lost ADUs have been recovered and are placed in the
-	 * output_adu_table, and it is considered a "complete" source
-	 * block. A source block which does not have all of its ADUs
-	 * in the output_adu_table yet is considered incomplete. */
-	gboolean is_complete;
-}
-GstRSFECDecSourceBlock;
-
-
 #define DEFAULT_NUM_SOURCE_SYMBOLS 4
 #define DEFAULT_NUM_REPAIR_SYMBOLS 2
 #define DEFAULT_MAX_SOURCE_BLOCK_AGE 1
 #define DEFAULT_DO_TIMESTAMP TRUE
 #define DEFAULT_SORT_OUTPUT TRUE
+#define DEFAULT_CODE_CONSTRUCTION GST_RS_FEC_CODE_CONSTRUCTION_VANDERMONDE
+#define DEFAULT_LOSS_REPORT_INTERVAL 0
+#define DEFAULT_MAX_SOURCE_SYMBOLS 0
+#define DEFAULT_MAX_REPAIR_SYMBOLS 0
+#define DEFAULT_REASSEMBLE_FRAGMENTS FALSE
+#define DEFAULT_UNPACK_ADUS FALSE
+#define DEFAULT_OUTPUT_BUFFER_SIZE 0
+#define DEFAULT_MAX_SYMBOL_LENGTH 0
+#define DEFAULT_RESTORE_TIMESTAMPS FALSE
+#define DEFAULT_PACED_OUTPUT FALSE
+
+/* Intervals between source packets that are longer than this are
+ * considered pauses, and are not used for the latency estimate */
+#define MAX_SOURCE_PACKET_INTERVAL GST_SECOND
+
+/* With paced output, buffers are held back at most this long. If the
+ * schedule would delay them any further (for example, because the
+ * estimated packet interval is too large, or because the sender's
+ * clock runs slower), the buffers are sent closer together instead. */
+#define PACED_OUTPUT_MAX_DELAY (200 * GST_MSECOND)
+
+
+/* Entry in the paced output queue. Exactly one of buffer
+ * and event is non-NULL. */
+typedef struct
+{
+	GstBuffer *buffer;
+	GstEvent *event;
+	/* System clock time when the buffer shall be pushed,
+	 * or GST_CLOCK_TIME_NONE to push it right away */
+	GstClockTime send_time;
+}
+GstRSFECDecOutputItem;
 
 
 #define FEC_SOURCE_CAPS_STR "application/x-fec-source-flow, encoding-id = (int) 8"
 #define FEC_REPAIR_CAPS_STR "application/x-fec-repair-flow, encoding-id = (int) 8"
 
 
+#define PACKET_MASK_SIZE(NUM_ENCODING_SYMBOLS) (sizeof(guint64) * (((NUM_ENCODING_SYMBOLS) + 63) >> 6))
+
 #define SOURCE_BLOCK_SET_FLAG(SRCBLOCK, IDX) \
 	do { \
 		(SRCBLOCK)->packet_mask[(IDX) >> 6] |= ((guint64)1) << ((IDX) & 63); \
@@ -189,6 +290,10 @@ GstRSFECDecSourceBlock;
 	} while (0)
 
 
+/* Source block numbers use the 32-m bits of the FEC payload ID that the ESI does not use */
+#define GST_RS_FEC_DEC_NUM_BLOCK_NR_BITS(obj) (32 - GST_RS_FEC_DEC_GET_CLASS(obj)->get_payload_id_m(obj))
+
+
 #define RS_LOCK_MUTEX(obj) do { g_mutex_lock(&(((GstRSFECDec *)(obj))->mutex)); } while (0)
 #define RS_UNLOCK_MUTEX(obj) do { g_mutex_unlock(&(((GstRSFECDec *)(obj))->mutex)); } while (0)
 
@@ -232,24 +337,36 @@ static gboolean gst_rs_fec_dec_fecsource_event(GstPad *pad, GstObject *parent, G
 static gboolean gst_rs_fec_dec_fecrepair_event(GstPad *pad, GstObject *parent, GstEvent *event);
 static GstFlowReturn gst_rs_fec_dec_fecsource_chain(GstPad *pad, GstObject *parent, GstBuffer *buffer);
 static GstFlowReturn gst_rs_fec_dec_fecrepair_chain(GstPad *pad, GstObject *parent, GstBuffer *buffer);
+static gboolean gst_rs_fec_dec_src_query(GstPad *pad, GstObject *parent, GstQuery *query);
+static gboolean gst_rs_fec_dec_update_latency(GstRSFECDec *rs_fec_dec);
+static gboolean gst_rs_fec_dec_handle_caps_event(GstRSFECDec *rs_fec_dec, GstEvent *caps_event, gboolean is_fecsource);
 
 static void gst_rs_fec_dec_alloc_encoding_symbol_table(GstRSFECDec *rs_fec_dec);
 static void gst_rs_fec_dec_free_encoding_symbol_table(GstRSFECDec *rs_fec_dec);
+static void gst_rs_fec_dec_grow_encoding_symbol_table(GstRSFECDec *rs_fec_dec, guint num_source_symbols, guint num_repair_symbols);
+static void gst_rs_fec_dec_alloc_symbol_memblocks(GstRSFECDec *rs_fec_dec, gsize encoding_symbol_length);
 
-static void gst_rs_fec_dec_source_packet_read_payload_id(GstBuffer *fec_source_packet, guint *source_block_nr, guint *esi);
-static void gst_rs_fec_dec_repair_packet_read_payload_id(GstBuffer *fec_repair_packet, guint *source_block_nr, guint *esi);
+static void gst_rs_fec_dec_source_packet_read_payload_id(GstRSFECDec *rs_fec_dec, GstBuffer *fec_source_packet, guint *source_block_nr, guint *esi, guint *source_block_length);
+static void gst_rs_fec_dec_repair_packet_read_payload_id(GstRSFECDec *rs_fec_dec, GstBuffer *fec_repair_packet, guint *source_block_nr, guint *esi, guint *source_block_length);
 
+static gboolean gst_rs_fec_dec_get_packet_num_symbols(GstRSFECDec *rs_fec_dec, gboolean is_source_packet, guint source_block_length, guint *num_source_symbols, guint *num_repair_symbols);
 static GstFlowReturn gst_rs_fec_dec_insert_fec_packet(GstRSFECDec *rs_fec_dec, GstBuffer *fec_packet, gboolean is_source_packet);
+static GstFlowReturn gst_rs_fec_dec_insert_pending_repair_packets(GstRSFECDec *rs_fec_dec, GSList *pending_repair_packets);
 
 static GstRSFECDecSourceBlock* gst_rs_fec_dec_fetch_source_block(GstRSFECDec *rs_fec_dec, guint block_nr);
-static GstRSFECDecSourceBlock* gst_rs_fec_dec_create_source_block(GstRSFECDec *rs_fec_dec, guint block_nr);
+static GstRSFECDecSourceBlock* gst_rs_fec_dec_create_source_block(GstRSFECDec *rs_fec_dec, guint block_nr, guint num_source_symbols, guint num_repair_symbols);
+static void gst_rs_fec_dec_set_source_block_num_symbols(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block, guint num_source_symbols, guint num_repair_symbols);
+static void gst_rs_fec_dec_set_source_block_num_repair_symbols(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block, guint num_repair_symbols);
+static gboolean gst_rs_fec_dec_shorten_source_block(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block, guint source_block_length);
 static void gst_rs_fec_dec_destroy_source_block(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block);
-static gboolean gst_rs_fec_dec_can_source_block_be_processed(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block);
 static GstFlowReturn gst_rs_fec_dec_process_source_block(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block);
+static GstFlowReturn gst_rs_fec_dec_finish_source_block(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block);
 static GstFlowReturn gst_rs_fec_dec_push_source_block(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block);
+static GstStructure* gst_rs_fec_dec_take_loss_report(GstRSFECDec *rs_fec_dec);
+static void gst_rs_fec_dec_send_loss_report(GstRSFECDec *rs_fec_dec, GstStructure *loss_report);
 
-static gboolean gst_rs_fec_dec_is_source_block_nr_newer(guint candidate_block_nr, guint reference_block_nr);
-static gboolean gst_rs_fec_dec_is_source_block_nr_recent_enough(guint candidate_block_nr, guint reference_block_nr, guint max_age);
+static gboolean gst_rs_fec_dec_is_source_block_nr_newer(guint candidate_block_nr, guint reference_block_nr, guint num_block_nr_bits);
+static gboolean gst_rs_fec_dec_is_source_block_nr_recent_enough(guint candidate_block_nr, guint reference_block_nr, guint max_age, guint num_block_nr_bits);
 static gboolean gst_rs_fec_dec_check_if_source_block_in_range(guint block_nr, guint start, guint end);
 static gint gst_rs_fec_dec_compare_source_blocks(gconstpointer first, gconstpointer second);
 
@@ -258,14 +375,32 @@ static GstFlowReturn gst_rs_fec_dec_drain_source_block_table(GstRSFECDec *rs_fec
 
 static void gst_rs_fec_dec_reset_states(GstRSFECDec *rs_fec_dec);
 static void gst_rs_fec_dec_flush(GstRSFECDec *rs_fec_dec);
+static GstBuffer* gst_rs_fec_dec_reassemble_adu(GstRSFECDec *rs_fec_dec, GstBuffer *fragment);
+static GstFlowReturn gst_rs_fec_dec_unpack_adus(GstRSFECDec *rs_fec_dec, GstBuffer *pack);
 static GstFlowReturn gst_rs_fec_dec_push_adu(GstRSFECDec *rs_fec_dec, GstBuffer *adu);
+static GstBuffer* gst_rs_fec_dec_restore_timestamps(GstRSFECDec *rs_fec_dec, GstBuffer *adu);
+static GstFlowReturn gst_rs_fec_dec_push_output_buffer(GstRSFECDec *rs_fec_dec, GstBuffer *buffer);
+static void gst_rs_fec_dec_push_output_event(GstRSFECDec *rs_fec_dec, GstEvent *event);
+static gboolean gst_rs_fec_dec_queue_output_item(GstRSFECDec *rs_fec_dec, GstBuffer *buffer, GstEvent *event, GstClockTime spacing);
+static void gst_rs_fec_dec_output_loop(gpointer user_data);
+static void gst_rs_fec_dec_stop_output(GstRSFECDec *rs_fec_dec);
+static void gst_rs_fec_dec_reset_output(GstRSFECDec *rs_fec_dec);
+static GstFlowReturn gst_rs_fec_dec_push_unpacked_adu(GstRSFECDec *rs_fec_dec, GstBuffer *adu);
+static GstFlowReturn gst_rs_fec_dec_push_pending_output(GstRSFECDec *rs_fec_dec);
 static void gst_rs_fec_dec_push_stream_start(GstRSFECDec *rs_fec_dec);
 static void gst_rs_fec_dec_push_segment(GstRSFECDec *rs_fec_dec);
 static void gst_rs_fec_dec_push_eos(GstRSFECDec *rs_fec_dec);
-static of_session_t* gst_rs_fec_dec_create_openfec_session(GstRSFECDec *rs_fec_dec, gsize encoding_symbol_length);
+static of_session_t* gst_rs_fec_dec_create_openfec_session(GstRSFECDec *rs_fec_dec, guint num_source_symbols, guint num_repair_symbols, gsize encoding_symbol_length);
 static void* gst_rs_fec_dec_openfec_source_symbol_cb(void *context, UINT32 size, UINT32 esi);
 static gchar const * gst_rs_fec_dec_get_status_name(of_status_t status);
 
+static guint gst_rs_fec_dec_get_payload_id_m(GstRSFECDec *rs_fec_dec);
+static guint gst_rs_fec_dec_get_max_num_encoding_symbols(GstRSFECDec *rs_fec_dec);
+static gboolean gst_rs_fec_dec_check_settings(GstRSFECDec *rs_fec_dec);
+static gboolean gst_rs_fec_dec_check_caps(GstRSFECDec *rs_fec_dec, GstCaps *caps);
+static gboolean gst_rs_fec_dec_can_source_block_be_processed(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block);
+static gboolean gst_rs_fec_dec_recover_source_symbols(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block);
+
 
 
 static void gst_rs_fec_dec_class_init(GstRSFECDecClass *klass)
@@ -275,6 +410,9 @@ static void gst_rs_fec_dec_class_init(GstRSFECDecClass *klass)
 
 	GST_DEBUG_CATEGORY_INIT(rs_fec_dec_debug, "rsfecdec", 0, "FECFRAME RFC 6865 Reed-Solomon scheme decoder");
 
+	gst_fec_gf256_init();
+	gst_rs_fft_init();
+
 	object_class = G_OBJECT_CLASS(klass);
 	element_class = GST_ELEMENT_CLASS(klass);
 
@@ -288,13 +426,24 @@ static void gst_rs_fec_dec_class_init(GstRSFECDecClass *klass)
 
 	element_class->change_state = GST_DEBUG_FUNCPTR(gst_rs_fec_dec_change_state);
 
+	klass->supports_num_symbols_changes = TRUE;
+	klass->get_payload_id_m             = GST_DEBUG_FUNCPTR(gst_rs_fec_dec_get_payload_id_m);
+	klass->get_max_num_encoding_symbols = GST_DEBUG_FUNCPTR(gst_rs_fec_dec_get_max_num_encoding_symbols);
+	klass->check_settings               = GST_DEBUG_FUNCPTR(gst_rs_fec_dec_check_settings);
+	klass->check_caps                   = GST_DEBUG_FUNCPTR(gst_rs_fec_dec_check_caps);
+	klass->add_fec_packet               = NULL;
+	klass->can_process_source_block     = GST_DEBUG_FUNCPTR(gst_rs_fec_dec_can_source_block_be_processed);
+	klass->recover_source_symbols       = GST_DEBUG_FUNCPTR(gst_rs_fec_dec_recover_source_symbols);
+	klass->finish_source_block          = NULL;
+	klass->free_source_block_data       = NULL;
+
 	g_object_class_install_property(
 		object_class,
 		PROP_NUM_SOURCE_SYMBOLS,
 		g_param_spec_uint(
 			"num-source-symbols",
 			"Number of source symbols",
-			"How many source symbols to use per Reed-Solomon source block",
+			"How many source symbols to use per source block (only used if the FEC scheme cannot take it from the packets)",
 			1, G_MAXUINT,
 			DEFAULT_NUM_SOURCE_SYMBOLS,
 			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
@@ -306,7 +455,7 @@ static void gst_rs_fec_dec_class_init(GstRSFECDecClass *klass)
 		g_param_spec_uint(
 			"num-repair-symbols",
 			"Number of repair symbols",
-			"How many repair symbols to use per Reed-Solomon repair block (0 disables FEC repair)",
+			"How many repair symbols to use per Reed-Solomon repair block (0 disables FEC repair; only used if the caps do not contain this number)",
 			0, G_MAXUINT,
 			DEFAULT_NUM_REPAIR_SYMBOLS,
 			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
@@ -346,6 +495,122 @@ static void gst_rs_fec_dec_class_init(GstRSFECDecClass *klass)
 			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
 		)
 	);
+	g_object_class_install_property(
+		object_class,
+		PROP_CODE_CONSTRUCTION,
+		g_param_spec_enum(
+			"code-construction",
+			"Code construction",
+			"How the repair symbols were computed (must match the encoder's construction)",
+			GST_TYPE_RS_FEC_CODE_CONSTRUCTION,
+			DEFAULT_CODE_CONSTRUCTION,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_LOSS_REPORT_INTERVAL,
+		g_param_spec_uint(
+			"loss-report-interval",
+			"Loss report interval",
+			"Send a loss report upstream and post it on the bus every this many source blocks (0 = disabled)",
+			0, G_MAXUINT,
+			DEFAULT_LOSS_REPORT_INTERVAL,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_MAX_SOURCE_SYMBOLS,
+		g_param_spec_uint(
+			"max-source-symbols",
+			"Preallocated source symbols",
+			"Number of source symbols to allocate the tables for initially; they grow if the stream needs more (0 = num-source-symbols)",
+			0, G_MAXUINT,
+			DEFAULT_MAX_SOURCE_SYMBOLS,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_MAX_REPAIR_SYMBOLS,
+		g_param_spec_uint(
+			"max-repair-symbols",
+			"Preallocated repair symbols",
+			"Number of repair symbols to allocate the tables for initially; they grow if the stream needs more (0 = num-repair-symbols)",
+			0, G_MAXUINT,
+			DEFAULT_MAX_REPAIR_SYMBOLS,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_REASSEMBLE_FRAGMENTS,
+		g_param_spec_boolean(
+			"reassemble-fragments",
+			"Reassemble fragments",
+			"Reassemble ADUs that the encoder split into fragments (always done if the caps contain fragmented=true; requires sort-output)",
+			DEFAULT_REASSEMBLE_FRAGMENTS,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_UNPACK_ADUS,
+		g_param_spec_boolean(
+			"unpack-adus",
+			"Unpack ADUs",
+			"Unpack ADUs that the encoder packed into shared source symbols (always done if the caps contain packed=true)",
+			DEFAULT_UNPACK_ADUS,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_OUTPUT_BUFFER_SIZE,
+		g_param_spec_uint(
+			"output-buffer-size",
+			"Output buffer size",
+			"Collect outgoing ADUs and push them as one buffer once it holds at least this many bytes (0 = push each ADU on its own)",
+			0, G_MAXUINT,
+			DEFAULT_OUTPUT_BUFFER_SIZE,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_MAX_SYMBOL_LENGTH,
+		g_param_spec_uint(
+			"max-symbol-length",
+			"Max symbol length",
+			"Reserve memory for source symbols of up to this many bytes at startup, so that changes of the symbol length do not allocate memory (0 = allocate on demand)",
+			0, 1 + 2 + 65535,
+			DEFAULT_MAX_SYMBOL_LENGTH,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_RESTORE_TIMESTAMPS,
+		g_param_spec_boolean(
+			"restore-timestamps",
+			"Restore timestamps",
+			"Restore the PTS and duration of ADUs from the timestamp headers that the encoder prepended (always done if the caps contain timestamped=true; overrides do-timestamp)",
+			DEFAULT_RESTORE_TIMESTAMPS,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_PACED_OUTPUT,
+		g_param_spec_boolean(
+			"paced-output",
+			"Paced output",
+			"Push outgoing buffers spaced according to their PTS (or the average source packet interval) instead of in bursts",
+			DEFAULT_PACED_OUTPUT,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
 
 	gst_element_class_set_static_metadata(
 		element_class,
@@ -362,6 +627,13 @@ static void gst_rs_fec_dec_init(GstRSFECDec *rs_fec_dec)
 	rs_fec_dec->num_source_symbols = DEFAULT_NUM_SOURCE_SYMBOLS;
 	rs_fec_dec->num_repair_symbols = DEFAULT_NUM_REPAIR_SYMBOLS;
 	rs_fec_dec->num_encoding_symbols = rs_fec_dec->num_source_symbols + rs_fec_dec->num_repair_symbols;
+	rs_fec_dec->max_source_symbols = DEFAULT_MAX_SOURCE_SYMBOLS;
+	rs_fec_dec->max_repair_symbols = DEFAULT_MAX_REPAIR_SYMBOLS;
+	rs_fec_dec->fecsource_num_source_symbols = 0;
+	rs_fec_dec->fecsource_num_repair_symbols = 0;
+	rs_fec_dec->fecrepair_num_source_symbols = 0;
+	rs_fec_dec->fecrepair_num_repair_symbols = 0;
+	rs_fec_dec->code_construction = DEFAULT_CODE_CONSTRUCTION;
 
 	rs_fec_dec->max_source_block_age = DEFAULT_MAX_SOURCE_BLOCK_AGE;
 
@@ -373,12 +645,41 @@ static void gst_rs_fec_dec_init(GstRSFECDec *rs_fec_dec)
 
 	rs_fec_dec->sort_output = DEFAULT_SORT_OUTPUT;
 
+	rs_fec_dec->reassemble_fragments = DEFAULT_REASSEMBLE_FRAGMENTS;
+	rs_fec_dec->caps_fragmented = FALSE;
+	rs_fec_dec->partial_adu = NULL;
+	rs_fec_dec->partial_adu_nr = 0;
+	rs_fec_dec->next_fragment_index = 0;
+	rs_fec_dec->unpack_adus = DEFAULT_UNPACK_ADUS;
+	rs_fec_dec->caps_packed = FALSE;
+	rs_fec_dec->restore_timestamps = DEFAULT_RESTORE_TIMESTAMPS;
+	rs_fec_dec->caps_timestamped = FALSE;
+	rs_fec_dec->paced_output = DEFAULT_PACED_OUTPUT;
+	rs_fec_dec->system_clock = gst_system_clock_obtain();
+	rs_fec_dec->last_output_pts = GST_CLOCK_TIME_NONE;
+	rs_fec_dec->last_output_send_time = GST_CLOCK_TIME_NONE;
+	g_queue_init(&(rs_fec_dec->output_queue));
+	g_mutex_init(&(rs_fec_dec->output_mutex));
+	g_cond_init(&(rs_fec_dec->output_cond));
+	rs_fec_dec->output_clock_id = NULL;
+	rs_fec_dec->output_task_started = FALSE;
+	rs_fec_dec->output_flushing = FALSE;
+	rs_fec_dec->output_flow_return = GST_FLOW_OK;
+	rs_fec_dec->output_buffer_size = DEFAULT_OUTPUT_BUFFER_SIZE;
+	rs_fec_dec->pending_output = NULL;
+
 	rs_fec_dec->allocated_encoding_symbol_table = NULL;
 	rs_fec_dec->received_encoding_symbol_table = NULL;
 	rs_fec_dec->recovered_encoding_symbol_table = NULL;
+	gst_fec_symbol_arena_init(&(rs_fec_dec->symbol_arena));
+	rs_fec_dec->max_symbol_length = DEFAULT_MAX_SYMBOL_LENGTH;
 
 	rs_fec_dec->fec_repair_packet_mapinfos = NULL;
 
+	rs_fec_dec->last_source_packet_time = GST_CLOCK_TIME_NONE;
+	rs_fec_dec->source_packet_interval = GST_CLOCK_TIME_NONE;
+	rs_fec_dec->reported_latency = 0;
+
 	rs_fec_dec->source_block_table = g_hash_table_new(g_direct_hash, g_direct_equal);
 	rs_fec_dec->first_pruning = TRUE;
 	rs_fec_dec->most_recent_block_nr = 0;
@@ -390,6 +691,11 @@ static void gst_rs_fec_dec_init(GstRSFECDec *rs_fec_dec)
 	rs_fec_dec->fecsource_eos = FALSE;
 	rs_fec_dec->fecrepair_eos = FALSE;
 
+	rs_fec_dec->loss_report_interval = DEFAULT_LOSS_REPORT_INTERVAL;
+	rs_fec_dec->num_report_blocks = 0;
+	rs_fec_dec->num_report_lost_source_symbols = 0;
+	rs_fec_dec->num_report_source_symbols = 0;
+
 	rs_fec_dec->fecsourcepad = gst_ghost_pad_new_no_target_from_template(
 		"fecsource",
 		gst_element_class_get_pad_template(GST_ELEMENT_GET_CLASS(rs_fec_dec), "fecsource")
@@ -413,6 +719,8 @@ static void gst_rs_fec_dec_init(GstRSFECDec *rs_fec_dec)
 
 	gst_pad_set_chain_function(rs_fec_dec->fecsourcepad, GST_DEBUG_FUNCPTR(gst_rs_fec_dec_fecsource_chain));
 	gst_pad_set_chain_function(rs_fec_dec->fecrepairpad, GST_DEBUG_FUNCPTR(gst_rs_fec_dec_fecrepair_chain));
+
+	gst_pad_set_query_function(rs_fec_dec->srcpad, GST_DEBUG_FUNCPTR(gst_rs_fec_dec_src_query));
 }
 
 
@@ -423,6 +731,11 @@ static void gst_rs_fec_dec_finalize(GObject *object)
 	g_hash_table_unref(rs_fec_dec->source_block_table);
 	g_mutex_clear(&(rs_fec_dec->mutex));
 
+	gst_rs_fec_dec_reset_output(rs_fec_dec);
+	g_mutex_clear(&(rs_fec_dec->output_mutex));
+	g_cond_clear(&(rs_fec_dec->output_cond));
+	gst_object_unref(GST_OBJECT(rs_fec_dec->system_clock));
+
 	G_OBJECT_CLASS(gst_rs_fec_dec_parent_class)->finalize(object);
 }
 
@@ -431,10 +744,10 @@ static void gst_rs_fec_dec_set_property(GObject *object, guint prop_id, GValue c
 {
 	GstRSFECDec *rs_fec_dec = GST_RS_FEC_DEC(object);
 
-	/* NOTE: this assumes Reed-Solomon with GF(2^8) is used
-	 * once OpenFEC can handle GF(2^m) with 2 <= m <= 16,
-	 * replace this constant with something appropriate */
-	guint const max_num_encoding_symbols = (1 << 8) - 1;
+	/* NOTE: the maximum depends on the FEC scheme and the code construction.
+	 * If the construction is changed after the number of symbols, the
+	 * values are checked again in the NULL->READY state change. */
+	guint const max_num_encoding_symbols = GST_RS_FEC_DEC_GET_CLASS(rs_fec_dec)->get_max_num_encoding_symbols(rs_fec_dec);
 
 	switch (prop_id)
 	{
@@ -499,6 +812,78 @@ static void gst_rs_fec_dec_set_property(GObject *object, guint prop_id, GValue c
 			GST_OBJECT_UNLOCK(object);
 			break;
 
+		case PROP_REASSEMBLE_FRAGMENTS:
+			GST_OBJECT_LOCK(object);
+			rs_fec_dec->reassemble_fragments = g_value_get_boolean(value);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_UNPACK_ADUS:
+			GST_OBJECT_LOCK(object);
+			rs_fec_dec->unpack_adus = g_value_get_boolean(value);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_RESTORE_TIMESTAMPS:
+			GST_OBJECT_LOCK(object);
+			rs_fec_dec->restore_timestamps = g_value_get_boolean(value);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_PACED_OUTPUT:
+			GST_OBJECT_LOCK(object);
+			rs_fec_dec->paced_output = g_value_get_boolean(value);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_OUTPUT_BUFFER_SIZE:
+			GST_OBJECT_LOCK(object);
+			rs_fec_dec->output_buffer_size = g_value_get_uint(value);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_MAX_SYMBOL_LENGTH:
+			GST_OBJECT_LOCK(object);
+			if (rs_fec_dec->allocated_encoding_symbol_table == NULL)
+				rs_fec_dec->max_symbol_length = g_value_get_uint(value);
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set max symbol length after initializing decoder"), (NULL));
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_CODE_CONSTRUCTION:
+			GST_OBJECT_LOCK(object);
+			if (rs_fec_dec->allocated_encoding_symbol_table == NULL)
+				rs_fec_dec->code_construction = g_value_get_enum(value);
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set code construction after initializing decoder"), (NULL));
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_LOSS_REPORT_INTERVAL:
+			GST_OBJECT_LOCK(object);
+			rs_fec_dec->loss_report_interval = g_value_get_uint(value);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_MAX_SOURCE_SYMBOLS:
+			GST_OBJECT_LOCK(object);
+			if (rs_fec_dec->allocated_encoding_symbol_table == NULL)
+				rs_fec_dec->max_source_symbols = g_value_get_uint(value);
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set maximum number of source symbols after initializing decoder"), (NULL));
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_MAX_REPAIR_SYMBOLS:
+			GST_OBJECT_LOCK(object);
+			if (rs_fec_dec->allocated_encoding_symbol_table == NULL)
+				rs_fec_dec->max_repair_symbols = g_value_get_uint(value);
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set maximum number of repair symbols after initializing decoder"), (NULL));
+			GST_OBJECT_UNLOCK(object);
+			break;
+
 		default:
 			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
 			break;
@@ -532,6 +917,54 @@ static void gst_rs_fec_dec_get_property(GObject *object, guint prop_id, GValue *
 			g_value_set_boolean(value, rs_fec_dec->sort_output);
 			break;
 
+		case PROP_REASSEMBLE_FRAGMENTS:
+			g_value_set_boolean(value, rs_fec_dec->reassemble_fragments);
+			break;
+
+		case PROP_UNPACK_ADUS:
+			g_value_set_boolean(value, rs_fec_dec->unpack_adus);
+			break;
+
+		case PROP_RESTORE_TIMESTAMPS:
+			g_value_set_boolean(value, rs_fec_dec->restore_timestamps);
+			break;
+
+		case PROP_PACED_OUTPUT:
+			GST_OBJECT_LOCK(object);
+			g_value_set_boolean(value, rs_fec_dec->paced_output);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_OUTPUT_BUFFER_SIZE:
+			g_value_set_uint(value, rs_fec_dec->output_buffer_size);
+			break;
+
+		case PROP_MAX_SYMBOL_LENGTH:
+			g_value_set_uint(value, rs_fec_dec->max_symbol_length);
+			break;
+
+		case PROP_CODE_CONSTRUCTION:
+			g_value_set_enum(value, rs_fec_dec->code_construction);
+			break;
+
+		case PROP_LOSS_REPORT_INTERVAL:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, rs_fec_dec->loss_report_interval);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_MAX_SOURCE_SYMBOLS:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, rs_fec_dec->max_source_symbols);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_MAX_REPAIR_SYMBOLS:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, rs_fec_dec->max_repair_symbols);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
 		default:
 			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
 			break;
@@ -547,16 +980,50 @@ static GstStateChangeReturn gst_rs_fec_dec_change_state(GstElement *element, Gst
 	switch (transition)
 	{
 		case GST_STATE_CHANGE_NULL_TO_READY:
+			/* The check function posts an error message on failure */
+			if (!GST_RS_FEC_DEC_GET_CLASS(rs_fec_dec)->check_settings(rs_fec_dec))
+				return GST_STATE_CHANGE_FAILURE;
+
+			/* Resolve the limits the tables are allocated for. FEC schemes
+			 * that cannot handle changes are limited to the configured
+			 * number of symbols. */
+			GST_OBJECT_LOCK(rs_fec_dec);
+			if (GST_RS_FEC_DEC_GET_CLASS(rs_fec_dec)->supports_num_symbols_changes)
+			{
+				rs_fec_dec->max_source_symbols = MAX(rs_fec_dec->max_source_symbols, rs_fec_dec->num_source_symbols);
+				rs_fec_dec->max_repair_symbols = MAX(rs_fec_dec->max_repair_symbols, rs_fec_dec->num_repair_symbols);
+			}
+			else
+			{
+				rs_fec_dec->max_source_symbols = rs_fec_dec->num_source_symbols;
+				rs_fec_dec->max_repair_symbols = rs_fec_dec->num_repair_symbols;
+			}
+			rs_fec_dec->fecsource_num_source_symbols = 0;
+			rs_fec_dec->fecsource_num_repair_symbols = 0;
+			rs_fec_dec->fecrepair_num_source_symbols = 0;
+			rs_fec_dec->fecrepair_num_repair_symbols = 0;
+			GST_OBJECT_UNLOCK(rs_fec_dec);
+
 			gst_rs_fec_dec_alloc_encoding_symbol_table(rs_fec_dec);
 			/* For an explanation of why this is expected, see
-			 * gst_rs_fec_dec_create_openfec_session(). */
+			 * gst_rs_fec_dec_alloc_symbol_memblocks(). */
 			g_assert(rs_fec_dec->encoding_symbol_length == 0);
 			break;
 
 		case GST_STATE_CHANGE_READY_TO_PAUSED:
 			/* Make sure states are at their initial value */
 			gst_rs_fec_dec_reset_states(rs_fec_dec);
+			gst_rs_fec_dec_reset_output(rs_fec_dec);
+			break;
+
+		case GST_STATE_CHANGE_PAUSED_TO_READY:
+			/* The output task must be stopped before the pads are
+			 * deactivated, since it holds the srcpad's stream lock
+			 * while it waits for buffers */
+			gst_rs_fec_dec_stop_output(rs_fec_dec);
+			gst_pad_stop_task(rs_fec_dec->srcpad);
 			break;
+
 		default:
 			break;
 	}
@@ -580,7 +1047,7 @@ static GstStateChangeReturn gst_rs_fec_dec_change_state(GstElement *element, Gst
 			/* Encoding symbol table and symbol memory blocks were freed.
 			 * Set encoding_symbol_length to zero to ensure later runs
 			 * don't try to free symbol memory blocks. See
-			 * gst_rs_fec_dec_create_openfec_session() for more. */
+			 * gst_rs_fec_dec_alloc_symbol_memblocks() for more. */
 			rs_fec_dec->encoding_symbol_length = 0;
 			break;
 		default:
@@ -604,10 +1071,13 @@ static gboolean gst_rs_fec_dec_fecsource_event(GstPad *pad, GstObject *parent, G
 			return TRUE;
 
 		case GST_EVENT_CAPS:
-			/* Throw away incoming caps
+		{
+			/* Throw away incoming caps after checking them
 			 * this decoder generates its own CAPS events */
+			gboolean ret = gst_rs_fec_dec_handle_caps_event(rs_fec_dec, event, TRUE);
 			gst_event_unref(event);
-			return TRUE;
+			return ret;
+		}
 
 		case GST_EVENT_SEGMENT:
 			/* Throw away incoming segments
@@ -615,6 +1085,18 @@ static gboolean gst_rs_fec_dec_fecsource_event(GstPad *pad, GstObject *parent, G
 			gst_event_unref(event);
 			return TRUE;
 
+		case GST_EVENT_FLUSH_START:
+		{
+			gboolean ret;
+
+			/* Wake up the output task, and pause it once the
+			 * FLUSH_START event unblocked any pending push downstream */
+			gst_rs_fec_dec_stop_output(rs_fec_dec);
+			ret = gst_pad_event_default(pad, parent, event);
+			gst_pad_pause_task(rs_fec_dec->srcpad);
+			return ret;
+		}
+
 		case GST_EVENT_FLUSH_STOP:
 			/* Lock to avoid race conditions between flushes here
 			 * and chain function calls at the other sinkpad */
@@ -623,6 +1105,7 @@ static gboolean gst_rs_fec_dec_fecsource_event(GstPad *pad, GstObject *parent, G
 			 * and states are reset properly */
 			gst_rs_fec_dec_flush(rs_fec_dec);
 			RS_UNLOCK_MUTEX(rs_fec_dec);
+			gst_rs_fec_dec_reset_output(rs_fec_dec);
 			break;
 
 		case GST_EVENT_EOS:
@@ -657,10 +1140,13 @@ static gboolean gst_rs_fec_dec_fecrepair_event(GstPad *pad, GstObject *parent, G
 			return TRUE;
 
 		case GST_EVENT_CAPS:
-			/* Throw away incoming caps
+		{
+			/* Throw away incoming caps after checking them
 			 * this decoder generates its own CAPS events */
+			gboolean ret = gst_rs_fec_dec_handle_caps_event(rs_fec_dec, event, FALSE);
 			gst_event_unref(event);
-			return TRUE;
+			return ret;
+		}
 
 		case GST_EVENT_SEGMENT:
 			/* Throw away incoming segments
@@ -668,6 +1154,18 @@ static gboolean gst_rs_fec_dec_fecrepair_event(GstPad *pad, GstObject *parent, G
 			gst_event_unref(event);
 			return TRUE;
 
+		case GST_EVENT_FLUSH_START:
+		{
+			gboolean ret;
+
+			/* Wake up the output task, and pause it once the
+			 * FLUSH_START event unblocked any pending push downstream */
+			gst_rs_fec_dec_stop_output(rs_fec_dec);
+			ret = gst_pad_event_default(pad, parent, event);
+			gst_pad_pause_task(rs_fec_dec->srcpad);
+			return ret;
+		}
+
 		case GST_EVENT_FLUSH_STOP:
 			/* Lock to avoid race conditions between flushes here
 			 * and chain function calls at the other sinkpad */
@@ -676,6 +1174,7 @@ static gboolean gst_rs_fec_dec_fecrepair_event(GstPad *pad, GstObject *parent, G
 			 * and states are reset properly */
 			gst_rs_fec_dec_flush(rs_fec_dec);
 			RS_UNLOCK_MUTEX(rs_fec_dec);
+			gst_rs_fec_dec_reset_output(rs_fec_dec);
 			break;
 
 		case GST_EVENT_EOS:
@@ -701,6 +1200,8 @@ static GstFlowReturn gst_rs_fec_dec_fecsource_chain(G_GNUC_UNUSED GstPad *pad, G
 {
 	GstRSFECDec *rs_fec_dec = GST_RS_FEC_DEC_CAST(parent);
 	GstFlowReturn ret = GST_FLOW_OK;
+	GstStructure *loss_report;
+	gboolean latency_changed = FALSE;
 
 	/* Lock to prevent race conditions between flushes, this chain function,
 	 * and a chain function call at the other sinkpad */
@@ -713,10 +1214,25 @@ static GstFlowReturn gst_rs_fec_dec_fecsource_chain(G_GNUC_UNUSED GstPad *pad, G
 		ret = GST_FLOW_EOS;
 	}
 	else
+	{
+		latency_changed = gst_rs_fec_dec_update_latency(rs_fec_dec);
 		ret = gst_rs_fec_dec_insert_fec_packet(rs_fec_dec, buffer, TRUE);
+	}
+
+	loss_report = gst_rs_fec_dec_take_loss_report(rs_fec_dec);
 
 	RS_UNLOCK_MUTEX(rs_fec_dec);
 
+	/* The report is sent without holding the lock, since
+	 * upstream may react to it synchronously */
+	if (loss_report != NULL)
+		gst_rs_fec_dec_send_loss_report(rs_fec_dec, loss_report);
+
+	/* Same with the latency message; the application may query
+	 * the latency (and thus call the query function) right away */
+	if (latency_changed)
+		gst_element_post_message(GST_ELEMENT(rs_fec_dec), gst_message_new_latency(GST_OBJECT(rs_fec_dec)));
+
 	return ret;
 }
 
@@ -725,6 +1241,7 @@ static GstFlowReturn gst_rs_fec_dec_fecrepair_chain(G_GNUC_UNUSED GstPad *pad, G
 {
 	GstRSFECDec *rs_fec_dec = GST_RS_FEC_DEC_CAST(parent);
 	GstFlowReturn ret = GST_FLOW_OK;
+	GstStructure *loss_report;
 
 	/* Lock to prevent race conditions between flushes, this chain function,
 	 * and a chain function call at the other sinkpad */
@@ -739,133 +1256,479 @@ static GstFlowReturn gst_rs_fec_dec_fecrepair_chain(G_GNUC_UNUSED GstPad *pad, G
 	else
 		ret = gst_rs_fec_dec_insert_fec_packet(rs_fec_dec, buffer, FALSE);
 
+	loss_report = gst_rs_fec_dec_take_loss_report(rs_fec_dec);
+
 	RS_UNLOCK_MUTEX(rs_fec_dec);
 
+	if (loss_report != NULL)
+		gst_rs_fec_dec_send_loss_report(rs_fec_dec, loss_report);
+
 	return ret;
 }
 
 
-static void gst_rs_fec_dec_alloc_encoding_symbol_table(GstRSFECDec *rs_fec_dec)
+static gboolean gst_rs_fec_dec_src_query(GstPad *pad, GstObject *parent, GstQuery *query)
 {
-	g_assert(rs_fec_dec->allocated_encoding_symbol_table == NULL);
+	GstRSFECDec *rs_fec_dec = GST_RS_FEC_DEC_CAST(parent);
 
-	GST_DEBUG_OBJECT(rs_fec_dec, "allocating symbol and output ADU tables  (num encoding symbols: %u  num source symbols: %u)", rs_fec_dec->num_encoding_symbols, rs_fec_dec->num_source_symbols);
+	switch (GST_QUERY_TYPE(query))
+	{
+		case GST_QUERY_LATENCY:
+		{
+			gboolean live;
+			GstClockTime min_latency, max_latency, own_min_latency, own_max_latency;
+
+			/* The ghost pads have no targets, so the query cannot be
+			 * forwarded through internal links. Ask the upstream peer
+			 * of the fecsource pad directly. The repair packets are
+			 * not relevant here, since the decoder never waits for
+			 * them longer than the source block pruning allows. */
+			if (!gst_pad_peer_query(rs_fec_dec->fecsourcepad, query))
+				return FALSE;
+
+			gst_query_parse_latency(query, &live, &min_latency, &max_latency);
+
+			/* With sorted output, every ADU may be delayed by up to the
+			 * estimated latency. Without sorting, received ADUs are pushed
+			 * right away, and only recovered ADUs arrive late; downstream
+			 * elements (like jitterbuffers) then have to be prepared
+			 * for that, so it is only reported as maximum latency. */
+			RS_LOCK_MUTEX(rs_fec_dec);
+			own_max_latency = rs_fec_dec->reported_latency;
+			own_min_latency = rs_fec_dec->sort_output ? own_max_latency : 0;
+			RS_UNLOCK_MUTEX(rs_fec_dec);
 
-	/* Create encoding symbol tables for OpenFEC. In the tables, the
-	 * source symbols must come in first, in the same order as they
-	 * are in the queue. Directly behind the source symbols, the
-	 * repair symbols are located. The memory blocks of the
-	 * individual symbols are allocated an inserted into the
-	 * allocated_encoding_symbol_table later on-demand.*/
-	rs_fec_dec->allocated_encoding_symbol_table = g_slice_alloc0(sizeof(void *) * rs_fec_dec->num_encoding_symbols);
-	rs_fec_dec->received_encoding_symbol_table = g_slice_alloc0(sizeof(void *) * rs_fec_dec->num_encoding_symbols);
-	rs_fec_dec->recovered_encoding_symbol_table = g_slice_alloc0(sizeof(void *) * rs_fec_dec->num_encoding_symbols);
+			/* Paced output holds back every buffer, received or recovered,
+			 * for up to PACED_OUTPUT_MAX_DELAY. This affects the minimum
+			 * latency as well; otherwise, the pipeline latency would be
+			 * too low, and sinks would render paced buffers too late. */
+			GST_OBJECT_LOCK(rs_fec_dec);
+			if (rs_fec_dec->paced_output)
+			{
+				own_min_latency += PACED_OUTPUT_MAX_DELAY;
+				own_max_latency += PACED_OUTPUT_MAX_DELAY;
+			}
+			GST_OBJECT_UNLOCK(rs_fec_dec);
 
-	rs_fec_dec->fec_repair_packet_mapinfos = g_slice_alloc0(sizeof(GstMapInfo) * rs_fec_dec->num_repair_symbols);
-}
+			min_latency += own_min_latency;
+			if (GST_CLOCK_TIME_IS_VALID(max_latency))
+				max_latency += own_max_latency;
 
+			GST_DEBUG_OBJECT(rs_fec_dec, "reporting latency: live: %d  min: %" GST_TIME_FORMAT "  max: %" GST_TIME_FORMAT, live, GST_TIME_ARGS(min_latency), GST_TIME_ARGS(max_latency));
 
-static void gst_rs_fec_dec_free_encoding_symbol_table(GstRSFECDec *rs_fec_dec)
-{
-	g_assert(rs_fec_dec->allocated_encoding_symbol_table != NULL);
+			gst_query_set_latency(query, live, min_latency, max_latency);
 
-	GST_DEBUG_OBJECT(rs_fec_dec, "freeing symbol and output ADU tables  (num encoding symbols: %u  num source symbols: %u)", rs_fec_dec->num_encoding_symbols, rs_fec_dec->num_source_symbols);
+			return TRUE;
+		}
 
-	/* Deallocate symbol memory blocks first */
-	if (rs_fec_dec->encoding_symbol_length != 0)
-	{
-		guint i;
-		/* See gst_rs_fec_dec_create_openfec_session() for an explanation
-		 * why only the source symbols - and not all symbols - are freed */
-		for (i = 0; i < rs_fec_dec->num_source_symbols; ++i)
-			g_slice_free1(rs_fec_dec->encoding_symbol_length, rs_fec_dec->allocated_encoding_symbol_table[i]);
+		default:
+			return gst_pad_query_default(pad, parent, query);
 	}
+}
 
-	/* Deallocate the tables */
-	g_slice_free1(sizeof(void *) * rs_fec_dec->num_encoding_symbols, rs_fec_dec->allocated_encoding_symbol_table);
-	g_slice_free1(sizeof(void *) * rs_fec_dec->num_encoding_symbols, rs_fec_dec->received_encoding_symbol_table);
-	g_slice_free1(sizeof(void *) * rs_fec_dec->num_encoding_symbols, rs_fec_dec->recovered_encoding_symbol_table);
 
-	g_slice_free1(sizeof(GstMapInfo) * rs_fec_dec->num_repair_symbols, rs_fec_dec->fec_repair_packet_mapinfos);
+static gboolean gst_rs_fec_dec_update_latency(GstRSFECDec *rs_fec_dec)
+{
+	/* Measures the interval between source packets, and updates the latency
+	 * estimate. Returns TRUE if the estimate changed enough to be announced
+	 * again. Must be called with the mutex locked. */
+
+	GstClockTime now = g_get_monotonic_time() * GST_USECOND;
+	GstClockTime interval, latency, difference;
+	guint num_source_symbols;
 
-	rs_fec_dec->allocated_encoding_symbol_table = NULL;
-	rs_fec_dec->received_encoding_symbol_table = NULL;
-	rs_fec_dec->recovered_encoding_symbol_table = NULL;
-}
+	interval = GST_CLOCK_TIME_IS_VALID(rs_fec_dec->last_source_packet_time) ? (now - rs_fec_dec->last_source_packet_time) : GST_CLOCK_TIME_NONE;
+	rs_fec_dec->last_source_packet_time = now;
 
+	/* Longer intervals are pauses in the transmission, and
+	 * say nothing about the packet rate */
+	if (!GST_CLOCK_TIME_IS_VALID(interval) || (interval > MAX_SOURCE_PACKET_INTERVAL))
+		return FALSE;
 
-static void gst_rs_fec_dec_source_packet_read_payload_id(GstBuffer *fec_source_packet, guint *source_block_nr, guint *esi)
-{
-	GstMapInfo map_info;
-	gst_buffer_map(fec_source_packet, &map_info, GST_MAP_READ);
+	/* Exponential moving average, which smoothes out network jitter */
+	if (GST_CLOCK_TIME_IS_VALID(rs_fec_dec->source_packet_interval))
+		rs_fec_dec->source_packet_interval = (rs_fec_dec->source_packet_interval * 15 + interval) / 16;
+	else
+		rs_fec_dec->source_packet_interval = interval;
 
-	/* In the FEC payload ID, the source block nr comes first, then the ESI,
-	 * then the source block length (not used here) */
+	num_source_symbols = (rs_fec_dec->fecsource_num_source_symbols != 0) ? rs_fec_dec->fecsource_num_source_symbols : rs_fec_dec->num_source_symbols;
+	latency = (GstClockTime)(rs_fec_dec->max_source_block_age + 1) * num_source_symbols * rs_fec_dec->source_packet_interval;
 
-	if (source_block_nr != NULL)
-	{
-		guint8 *bytes = &(map_info.data[map_info.size - 6]);
-		*source_block_nr = (((guint)(bytes[0])) << 16) | (((guint)(bytes[1])) << 8) | ((guint)(bytes[2]));
-	}
+	/* Only announce changes of more than 10%, since the
+	 * estimate fluctuates a little with every packet */
+	difference = (latency > rs_fec_dec->reported_latency) ? (latency - rs_fec_dec->reported_latency) : (rs_fec_dec->reported_latency - latency);
+	if ((difference * 10) <= rs_fec_dec->reported_latency)
+		return FALSE;
 
-	if (esi != NULL)
-		*esi = map_info.data[map_info.size - 3];
+	GST_DEBUG_OBJECT(rs_fec_dec, "latency changed from %" GST_TIME_FORMAT " to %" GST_TIME_FORMAT "  (source packet interval: %" GST_TIME_FORMAT ")", GST_TIME_ARGS(rs_fec_dec->reported_latency), GST_TIME_ARGS(latency), GST_TIME_ARGS(rs_fec_dec->source_packet_interval));
+	rs_fec_dec->reported_latency = latency;
 
-	gst_buffer_unmap(fec_source_packet, &map_info);
+	return TRUE;
 }
 
 
-static void gst_rs_fec_dec_repair_packet_read_payload_id(GstBuffer *fec_repair_packet, guint *source_block_nr, guint *esi)
+static gboolean gst_rs_fec_dec_handle_caps_event(GstRSFECDec *rs_fec_dec, GstEvent *caps_event, gboolean is_fecsource)
 {
-	GstMapInfo map_info;
-	gst_buffer_map(fec_repair_packet, &map_info, GST_MAP_READ);
+	GstCaps *caps;
+	guint num_source_symbols = 0, num_repair_symbols = 0;
 
-	/* In the FEC payload ID, the source block nr comes first, then the ESI,
-	 * then the source block length (not used here) */
+	gst_event_parse_caps(caps_event, &caps);
+	if (!GST_RS_FEC_DEC_GET_CLASS(rs_fec_dec)->check_caps(rs_fec_dec, caps))
+		return FALSE;
 
-	if (source_block_nr != NULL)
+	/* Fragmentation, packing and timestamp headers work the same with all FEC schemes.
+	 * Only the fecsource caps are looked at, since the ADUs come from
+	 * the source packets (directly or through recovery). */
+	if (is_fecsource)
 	{
-		/* Source block nr is stored as a 24-bit big endian unsigned integer */
-		guint8 *bytes = &(map_info.data[0]);
-		*source_block_nr = (((guint)(bytes[0])) << 16) | (((guint)(bytes[1])) << 8) | ((guint)(bytes[2]));
+		gboolean fragmented = FALSE, packed = FALSE, timestamped = FALSE;
+		gst_structure_get_boolean(gst_caps_get_structure(caps, 0), GST_RS_FEC_FRAGMENTED_CAPS_FIELD, &fragmented);
+		gst_structure_get_boolean(gst_caps_get_structure(caps, 0), GST_RS_FEC_PACKED_CAPS_FIELD, &packed);
+		gst_structure_get_boolean(gst_caps_get_structure(caps, 0), GST_RS_FEC_TIMESTAMPED_CAPS_FIELD, &timestamped);
+
+		RS_LOCK_MUTEX(rs_fec_dec);
+		rs_fec_dec->caps_fragmented = fragmented;
+		rs_fec_dec->caps_packed = packed;
+		rs_fec_dec->caps_timestamped = timestamped;
+		RS_UNLOCK_MUTEX(rs_fec_dec);
+
+		GST_DEBUG_OBJECT(rs_fec_dec, "fecsource caps indicate %s, %s, %s ADUs", fragmented ? "fragmented" : "unfragmented", packed ? "packed" : "unpacked", timestamped ? "timestamped" : "untimestamped");
 	}
 
-	if (esi != NULL)
-		*esi = map_info.data[3];
+	if (!GST_RS_FEC_DEC_GET_CLASS(rs_fec_dec)->supports_num_symbols_changes)
+		return TRUE;
 
-	gst_buffer_unmap(fec_repair_packet, &map_info);
+	/* The caps event is serialized, so the numbers of symbols in
+	 * it apply to the packets that follow on the same pad. Caps
+	 * without these numbers leave it to the properties. */
+	if (gst_rs_fec_num_symbols_from_caps(caps, &num_source_symbols, &num_repair_symbols))
+	{
+		if (!gst_rs_fec_code_construction_check_num_symbols(rs_fec_dec->code_construction, num_source_symbols, num_repair_symbols))
+		{
+			GST_ERROR_OBJECT(
+				rs_fec_dec,
+				"caps use %u source and %u repair symbols, which is invalid for code construction %s",
+				num_source_symbols, num_repair_symbols,
+				gst_rs_fec_code_construction_get_name(rs_fec_dec->code_construction)
+			);
+			return FALSE;
+		}
+
+		GST_DEBUG_OBJECT(rs_fec_dec, "fec%s caps use %u source and %u repair symbols", is_fecsource ? "source" : "repair", num_source_symbols, num_repair_symbols);
+	}
+	else
+		num_source_symbols = num_repair_symbols = 0;
+
+	RS_LOCK_MUTEX(rs_fec_dec);
+	if (is_fecsource)
+	{
+		rs_fec_dec->fecsource_num_source_symbols = num_source_symbols;
+		rs_fec_dec->fecsource_num_repair_symbols = num_repair_symbols;
+	}
+	else
+	{
+		rs_fec_dec->fecrepair_num_source_symbols = num_source_symbols;
+		rs_fec_dec->fecrepair_num_repair_symbols = num_repair_symbols;
+	}
+	RS_UNLOCK_MUTEX(rs_fec_dec);
+
+	return TRUE;
+}
+
+
+static gboolean gst_rs_fec_dec_check_caps(GstRSFECDec *rs_fec_dec, GstCaps *caps)
+{
+	GstRSFECCodeConstruction code_construction;
+
+	/* The decoder cannot switch constructions on the fly, since
+	 * the construction may only be changed in the NULL state.
+	 * Refuse the caps if the constructions differ, otherwise
+	 * the recovered symbols would contain garbage. */
+	if (!gst_rs_fec_code_construction_from_caps(caps, &code_construction))
+	{
+		GST_ERROR_OBJECT(rs_fec_dec, "caps %" GST_PTR_FORMAT " contain an unknown code construction", (gpointer)caps);
+		return FALSE;
+	}
+
+	if (code_construction != rs_fec_dec->code_construction)
+	{
+		GST_ERROR_OBJECT(
+			rs_fec_dec,
+			"caps use code construction %s, but decoder is configured for %s",
+			gst_rs_fec_code_construction_get_name(code_construction),
+			gst_rs_fec_code_construction_get_name(rs_fec_dec->code_construction)
+		);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+static void gst_rs_fec_dec_alloc_encoding_symbol_table(GstRSFECDec *rs_fec_dec)
+{
+	g_assert(rs_fec_dec->allocated_encoding_symbol_table == NULL);
+
+	GST_DEBUG_OBJECT(rs_fec_dec, "allocating symbol and output ADU tables  (max num source symbols: %u  max num repair symbols: %u)", rs_fec_dec->max_source_symbols, rs_fec_dec->max_repair_symbols);
+
+	/* Create encoding symbol tables for OpenFEC. In the tables, the
+	 * source symbols must come in first, in the same order as they
+	 * are in the queue. Directly behind the source symbols, the
+	 * repair symbols are located. The memory blocks of the
+	 * individual symbols are allocated an inserted into the
+	 * allocated_encoding_symbol_table later on-demand.*/
+	rs_fec_dec->allocated_encoding_symbol_table = g_slice_alloc0(sizeof(void *) * (rs_fec_dec->max_source_symbols + rs_fec_dec->max_repair_symbols));
+	rs_fec_dec->received_encoding_symbol_table = g_slice_alloc0(sizeof(void *) * (rs_fec_dec->max_source_symbols + rs_fec_dec->max_repair_symbols));
+	rs_fec_dec->recovered_encoding_symbol_table = g_slice_alloc0(sizeof(void *) * (rs_fec_dec->max_source_symbols + rs_fec_dec->max_repair_symbols));
+
+	rs_fec_dec->fec_repair_packet_mapinfos = g_slice_alloc0(sizeof(GstMapInfo) * rs_fec_dec->max_repair_symbols);
+
+	/* Pre-warm the symbol arena, so that encoding symbol lengths up
+	 * to max_symbol_length never cause any allocations later on
+	 * (unless max_source_symbols grows) */
+	if ((rs_fec_dec->max_symbol_length > 0) && gst_fec_symbol_arena_reserve(&(rs_fec_dec->symbol_arena), rs_fec_dec->max_source_symbols, rs_fec_dec->max_symbol_length))
+		GST_DEBUG_OBJECT(rs_fec_dec, "reserved %" G_GSIZE_FORMAT " bytes for source symbols of up to %u bytes", rs_fec_dec->symbol_arena.slab_size, rs_fec_dec->max_symbol_length);
+}
+
+
+static void gst_rs_fec_dec_free_encoding_symbol_table(GstRSFECDec *rs_fec_dec)
+{
+	g_assert(rs_fec_dec->allocated_encoding_symbol_table != NULL);
+
+	GST_DEBUG_OBJECT(rs_fec_dec, "freeing symbol and output ADU tables  (max num source symbols: %u  max num repair symbols: %u)", rs_fec_dec->max_source_symbols, rs_fec_dec->max_repair_symbols);
+
+	/* Deallocate symbol memory blocks first. See
+	 * gst_rs_fec_dec_alloc_symbol_memblocks() for an explanation
+	 * why only the source symbols have memory blocks. */
+	gst_fec_symbol_arena_clear(&(rs_fec_dec->symbol_arena));
+
+	/* Deallocate the tables */
+	g_slice_free1(sizeof(void *) * (rs_fec_dec->max_source_symbols + rs_fec_dec->max_repair_symbols), rs_fec_dec->allocated_encoding_symbol_table);
+	g_slice_free1(sizeof(void *) * (rs_fec_dec->max_source_symbols + rs_fec_dec->max_repair_symbols), rs_fec_dec->received_encoding_symbol_table);
+	g_slice_free1(sizeof(void *) * (rs_fec_dec->max_source_symbols + rs_fec_dec->max_repair_symbols), rs_fec_dec->recovered_encoding_symbol_table);
+
+	g_slice_free1(sizeof(GstMapInfo) * rs_fec_dec->max_repair_symbols, rs_fec_dec->fec_repair_packet_mapinfos);
+
+	rs_fec_dec->allocated_encoding_symbol_table = NULL;
+	rs_fec_dec->received_encoding_symbol_table = NULL;
+	rs_fec_dec->recovered_encoding_symbol_table = NULL;
+}
+
+
+static void gst_rs_fec_dec_grow_encoding_symbol_table(GstRSFECDec *rs_fec_dec, guint num_source_symbols, guint num_repair_symbols)
+{
+	/* The tables are only used while a source block is recovered,
+	 * so they can be reallocated between two packets */
+
+	guint old_num_symbols, new_num_symbols;
+	guint new_max_source_symbols, new_max_repair_symbols;
+
+	if ((num_source_symbols <= rs_fec_dec->max_source_symbols) && (num_repair_symbols <= rs_fec_dec->max_repair_symbols))
+		return;
+
+	new_max_source_symbols = MAX(rs_fec_dec->max_source_symbols, num_source_symbols);
+	new_max_repair_symbols = MAX(rs_fec_dec->max_repair_symbols, num_repair_symbols);
+	old_num_symbols = rs_fec_dec->max_source_symbols + rs_fec_dec->max_repair_symbols;
+	new_num_symbols = new_max_source_symbols + new_max_repair_symbols;
+
+	GST_DEBUG_OBJECT(rs_fec_dec, "source block needs %u source and %u repair symbols; growing tables to %u source and %u repair symbols", num_source_symbols, num_repair_symbols, new_max_source_symbols, new_max_repair_symbols);
+
+	/* The symbol memory blocks are assigned to the new table again by
+	 * gst_rs_fec_dec_alloc_symbol_memblocks() on demand. The arena
+	 * grows then if necessary. */
+	rs_fec_dec->encoding_symbol_length = 0;
+
+	/* The tables are replaced without ever setting them to NULL,
+	 * since the properties that may only be set while no decoding
+	 * session is running check allocated_encoding_symbol_table */
+	g_slice_free1(sizeof(void *) * old_num_symbols, rs_fec_dec->allocated_encoding_symbol_table);
+	g_slice_free1(sizeof(void *) * old_num_symbols, rs_fec_dec->received_encoding_symbol_table);
+	g_slice_free1(sizeof(void *) * old_num_symbols, rs_fec_dec->recovered_encoding_symbol_table);
+	g_slice_free1(sizeof(GstMapInfo) * rs_fec_dec->max_repair_symbols, rs_fec_dec->fec_repair_packet_mapinfos);
+
+	rs_fec_dec->allocated_encoding_symbol_table = g_slice_alloc0(sizeof(void *) * new_num_symbols);
+	rs_fec_dec->received_encoding_symbol_table = g_slice_alloc0(sizeof(void *) * new_num_symbols);
+	rs_fec_dec->recovered_encoding_symbol_table = g_slice_alloc0(sizeof(void *) * new_num_symbols);
+	rs_fec_dec->fec_repair_packet_mapinfos = g_slice_alloc0(sizeof(GstMapInfo) * new_max_repair_symbols);
+
+	GST_OBJECT_LOCK(rs_fec_dec);
+	rs_fec_dec->max_source_symbols = new_max_source_symbols;
+	rs_fec_dec->max_repair_symbols = new_max_repair_symbols;
+	GST_OBJECT_UNLOCK(rs_fec_dec);
+}
+
+
+static void gst_rs_fec_dec_source_packet_read_payload_id(GstRSFECDec *rs_fec_dec, GstBuffer *fec_source_packet, guint *source_block_nr, guint *esi, guint *source_block_length)
+{
+	GstMapInfo map_info;
+	gst_buffer_map(fec_source_packet, &map_info, GST_MAP_READ);
+
+	/* In the FEC payload ID, the source block nr comes first, then the ESI,
+	 * then the source block length. In FEC source packets, the latter is
+	 * always the unshortened k of the block. The payload ID is located at
+	 * the end of the packet. */
+	gst_rs_fec_read_payload_id(&(map_info.data[map_info.size - 6]), GST_RS_FEC_DEC_GET_CLASS(rs_fec_dec)->get_payload_id_m(rs_fec_dec), source_block_nr, esi, source_block_length);
+
+	gst_buffer_unmap(fec_source_packet, &map_info);
+}
+
+
+static void gst_rs_fec_dec_repair_packet_read_payload_id(GstRSFECDec *rs_fec_dec, GstBuffer *fec_repair_packet, guint *source_block_nr, guint *esi, guint *source_block_length)
+{
+	GstMapInfo map_info;
+	gst_buffer_map(fec_repair_packet, &map_info, GST_MAP_READ);
+
+	/* In the FEC payload ID, the source block nr comes first, then the ESI,
+	 * then the source block length. The latter is only of interest in repair
+	 * packets, since it is less than k there if the encoder shortened the
+	 * source block. In FEC repair packets, the payload ID is located at the
+	 * beginning of the packet. */
+	gst_rs_fec_read_payload_id(&(map_info.data[0]), GST_RS_FEC_DEC_GET_CLASS(rs_fec_dec)->get_payload_id_m(rs_fec_dec), source_block_nr, esi, source_block_length);
+
+	gst_buffer_unmap(fec_repair_packet, &map_info);
+}
+
+
+static gboolean gst_rs_fec_dec_get_packet_num_symbols(GstRSFECDec *rs_fec_dec, gboolean is_source_packet, guint source_block_length, guint *num_source_symbols, guint *num_repair_symbols)
+{
+	guint k, r;
+
+	if (!GST_RS_FEC_DEC_GET_CLASS(rs_fec_dec)->supports_num_symbols_changes)
+	{
+		*num_source_symbols = rs_fec_dec->num_source_symbols;
+		*num_repair_symbols = rs_fec_dec->num_repair_symbols;
+		return TRUE;
+	}
+
+	if (is_source_packet)
+	{
+		/* FEC source packets always carry the unshortened k
+		 * in the source block length field */
+		k = source_block_length;
+		r = (rs_fec_dec->fecsource_num_source_symbols != 0) ? rs_fec_dec->fecsource_num_repair_symbols : rs_fec_dec->num_repair_symbols;
+	}
+	else if (rs_fec_dec->fecrepair_num_source_symbols != 0)
+	{
+		/* FEC repair packets carry the shortened block length, which
+		 * is a lower bound for k; k itself comes from the caps */
+		k = MAX(rs_fec_dec->fecrepair_num_source_symbols, source_block_length);
+		r = rs_fec_dec->fecrepair_num_repair_symbols;
+	}
+	else
+	{
+		/* Without caps, the k of a FEC repair packet is only known from
+		 * the FEC source packets of the same block. 0 tells the caller
+		 * to look it up there. */
+		*num_source_symbols = 0;
+		*num_repair_symbols = rs_fec_dec->num_repair_symbols;
+		return TRUE;
+	}
+
+	if ((k == 0) || !gst_rs_fec_code_construction_check_num_symbols(rs_fec_dec->code_construction, k, r))
+	{
+		GST_WARNING_OBJECT(rs_fec_dec, "FEC %s packet uses %u source and %u repair symbols, which is invalid for code construction %s", is_source_packet ? "source" : "repair", k, r, gst_rs_fec_code_construction_get_name(rs_fec_dec->code_construction));
+		return FALSE;
+	}
+
+	*num_source_symbols = k;
+	*num_repair_symbols = r;
+
+	return TRUE;
 }
 
 
 static GstFlowReturn gst_rs_fec_dec_insert_fec_packet(GstRSFECDec *rs_fec_dec, GstBuffer *fec_packet, gboolean is_source_packet)
 {
-	guint source_block_nr, esi;
+	guint source_block_nr, esi, source_block_length = 0;
+	guint num_source_symbols, num_repair_symbols;
 	GstRSFECDecSourceBlock *source_block;
 	GstBuffer *adu;
 	gsize adu_length;
 	gchar const *packet_str = is_source_packet ? "source" : "repair";
 	GstFlowReturn ret = GST_FLOW_OK;
+	GstRSFECDecClass *klass = GST_RS_FEC_DEC_GET_CLASS(rs_fec_dec);
 
 	/* fec_packet is not ref'd here, but it is unref'd when the source block is destroyed */
 
 	/* Get the source block nr and ESI of the packet */
 	if (is_source_packet)
-		gst_rs_fec_dec_source_packet_read_payload_id(fec_packet, &source_block_nr, &esi);
+		gst_rs_fec_dec_source_packet_read_payload_id(rs_fec_dec, fec_packet, &source_block_nr, &esi, &source_block_length);
 	else
-		gst_rs_fec_dec_repair_packet_read_payload_id(fec_packet, &source_block_nr, &esi);
+		gst_rs_fec_dec_repair_packet_read_payload_id(rs_fec_dec, fec_packet, &source_block_nr, &esi, &source_block_length);
 	GST_LOG_OBJECT(rs_fec_dec, "adding FEC %s packet with source block nr #%u and ESI %u", packet_str, source_block_nr, esi);
 
+	/* Find out which k and n-k the encoder used for this packet's block */
+	if (!gst_rs_fec_dec_get_packet_num_symbols(rs_fec_dec, is_source_packet, source_block_length, &num_source_symbols, &num_repair_symbols))
+	{
+		gst_buffer_unref(fec_packet);
+		return GST_FLOW_OK;
+	}
+
 	/* Get the corresponding source block; create a new one if it does not exist */
 	source_block = gst_rs_fec_dec_fetch_source_block(rs_fec_dec, source_block_nr);
 	if (source_block == NULL)
 	{
 		GST_LOG_OBJECT(rs_fec_dec, "source block with nr #%u not present - creating", source_block_nr);
-		source_block = gst_rs_fec_dec_create_source_block(rs_fec_dec, source_block_nr);
+		source_block = gst_rs_fec_dec_create_source_block(rs_fec_dec, source_block_nr, num_source_symbols, num_repair_symbols);
+	}
+	else if (source_block->num_code_source_symbols == 0)
+	{
+		/* The block was created by FEC repair packets, and its k was not known
+		 * back then. If this packet tells it, set up the block, and insert the
+		 * repair packets that were kept until now. Doing this before inserting
+		 * this packet is fine, since the order of the packets does not matter. */
+		if (num_source_symbols != 0)
+		{
+			GSList *pending_repair_packets = source_block->pending_repair_packets;
+			source_block->pending_repair_packets = NULL;
+
+			gst_rs_fec_dec_set_source_block_num_symbols(rs_fec_dec, source_block, num_source_symbols, num_repair_symbols);
+
+			if ((ret = gst_rs_fec_dec_insert_pending_repair_packets(rs_fec_dec, pending_repair_packets)) != GST_FLOW_OK)
+			{
+				gst_buffer_unref(fec_packet);
+				return ret;
+			}
+
+			/* If sorting is disabled, the repair packets may have completed
+			 * the block, which is then already pushed and destroyed */
+			if ((source_block = gst_rs_fec_dec_fetch_source_block(rs_fec_dec, source_block_nr)) == NULL)
+			{
+				GST_LOG_OBJECT(rs_fec_dec, "source block #%u was already completed and pushed - discarding unnecessary FEC %s packet with ESI %u", source_block_nr, packet_str, esi);
+				gst_buffer_unref(fec_packet);
+				return GST_FLOW_OK;
+			}
+		}
+	}
+	else if (num_source_symbols == 0)
+	{
+		/* FEC repair packet whose k is not known from the caps; it
+		 * belongs to the block that the FEC source packets set up */
+		num_source_symbols = source_block->num_code_source_symbols;
+		if (source_block_length > num_source_symbols)
+		{
+			GST_WARNING_OBJECT(rs_fec_dec, "FEC repair packet has source block length %u, but source block #%u has %u source symbols - discarding packet", source_block_length, source_block_nr, num_source_symbols);
+			gst_buffer_unref(fec_packet);
+			return GST_FLOW_OK;
+		}
+	}
+	else if (num_source_symbols != source_block->num_code_source_symbols)
+	{
+		GST_WARNING_OBJECT(rs_fec_dec, "FEC %s packet uses %u source symbols, but source block #%u has %u - discarding packet", packet_str, num_source_symbols, source_block_nr, source_block->num_code_source_symbols);
+		gst_buffer_unref(fec_packet);
+		return GST_FLOW_OK;
+	}
+	else if (!is_source_packet && (rs_fec_dec->fecrepair_num_source_symbols != 0) && !source_block->is_complete && ((source_block->num_repair_packets == 0) || (num_repair_symbols > source_block->num_code_repair_symbols)))
+	{
+		/* The number of repair symbols is only known for sure from
+		 * the caps that came with the repair packets. It is never
+		 * lowered below the ESIs of repair packets in the block. */
+		gst_rs_fec_dec_set_source_block_num_repair_symbols(rs_fec_dec, source_block, num_repair_symbols);
 	}
 
 	/* Discard packet if it is too old (for a definiton of what "too old" means, see
 	 * the description of the max_source_block_age value in the header) */
-	if (!gst_rs_fec_dec_is_source_block_nr_recent_enough(source_block_nr, rs_fec_dec->most_recent_block_nr, rs_fec_dec->max_source_block_age))
+	if (!gst_rs_fec_dec_is_source_block_nr_recent_enough(source_block_nr, rs_fec_dec->most_recent_block_nr, rs_fec_dec->max_source_block_age, GST_RS_FEC_DEC_NUM_BLOCK_NR_BITS(rs_fec_dec)))
 	{
 		GST_LOG_OBJECT(rs_fec_dec, "FEC %s packet's block nr is too old (packet block nr: %u most recent nr: %u) - discarding obsolete packet", packet_str, source_block_nr, rs_fec_dec->most_recent_block_nr);
 		gst_buffer_unref(fec_packet);
@@ -883,6 +1746,34 @@ static GstFlowReturn gst_rs_fec_dec_insert_fec_packet(GstRSFECDec *rs_fec_dec, G
 		return GST_FLOW_OK;
 	}
 
+	/* If the block's k is still not known, keep the FEC repair
+	 * packet until a FEC source packet of the block arrives */
+	if (source_block->num_code_source_symbols == 0)
+	{
+		GST_LOG_OBJECT(rs_fec_dec, "k of source block #%u is not known yet - keeping FEC repair packet with ESI %u until it is", source_block_nr, esi);
+		source_block->pending_repair_packets = g_slist_prepend(source_block->pending_repair_packets, fec_packet);
+		return gst_rs_fec_dec_prune_source_block_table(rs_fec_dec, source_block_nr);
+	}
+
+	/* If n-k is not known from the caps, a FEC repair packet with a larger
+	 * ESI means that the encoder uses more repair symbols than assumed.
+	 * This is only possible if the repair symbols do not depend on n. */
+	if (!is_source_packet && klass->supports_num_symbols_changes && (rs_fec_dec->fecrepair_num_source_symbols == 0) && (rs_fec_dec->code_construction != GST_RS_FEC_CODE_CONSTRUCTION_GF16_FFT))
+	{
+		guint k = source_block->num_code_source_symbols;
+		if ((esi >= (k + source_block->num_code_repair_symbols)) && gst_rs_fec_code_construction_check_num_symbols(rs_fec_dec->code_construction, k, esi - k + 1))
+			gst_rs_fec_dec_set_source_block_num_repair_symbols(rs_fec_dec, source_block, esi - k + 1);
+	}
+
+	/* Discard packets with invalid ESIs, since they would otherwise
+	 * cause out-of-bounds accesses in the packet mask */
+	if ((is_source_packet && (esi >= source_block->num_code_source_symbols)) || (!is_source_packet && ((esi < source_block->num_code_source_symbols) || (esi >= (source_block->num_code_source_symbols + source_block->num_code_repair_symbols)))))
+	{
+		GST_WARNING_OBJECT(rs_fec_dec, "FEC %s packet has invalid ESI %u - discarding packet", packet_str, esi);
+		gst_buffer_unref(fec_packet);
+		return GST_FLOW_OK;
+	}
+
 	/* Find out if this packet has already been received, and if so, discard and exit */
 	if (SOURCE_BLOCK_IS_FLAG_SET(source_block, esi))
 	{
@@ -922,13 +1813,33 @@ static GstFlowReturn gst_rs_fec_dec_insert_fec_packet(GstRSFECDec *rs_fec_dec, G
 	}
 	else
 	{
+		/* If the encoder closed this source block early, the repair packet
+		 * carries the shortened block length. The source symbols past
+		 * that length were zero symbols in the encoder; add them now,
+		 * so that the FEC scheme sees a regular block with k symbols. */
+		if ((source_block_length > 0) && (source_block_length < source_block->num_source_symbols))
+		{
+			if (!gst_rs_fec_dec_shorten_source_block(rs_fec_dec, source_block, source_block_length))
+			{
+				gst_buffer_unref(fec_packet);
+				return GST_FLOW_ERROR;
+			}
+		}
+
 		/* Add the packet to the list, and increase the counter */
 		source_block->repair_packets = g_slist_prepend(source_block->repair_packets, fec_packet);
 		source_block->num_repair_packets++;
 		GST_LOG_OBJECT(rs_fec_dec, "added FEC repair packet to source block #%u ; there are %u repair packets in the block now", source_block_nr, source_block->num_repair_packets);
 	}
 
-	if (gst_rs_fec_dec_can_source_block_be_processed(rs_fec_dec, source_block))
+	/* Let FEC schemes with incremental decoders consume the new symbol */
+	if ((klass->add_fec_packet != NULL) && !klass->add_fec_packet(rs_fec_dec, source_block, fec_packet, esi, is_source_packet))
+	{
+		GST_ERROR_OBJECT(rs_fec_dec, "could not add FEC %s packet with ESI %u to source block #%u", packet_str, esi, source_block_nr);
+		return GST_FLOW_ERROR;
+	}
+
+	if (klass->can_process_source_block(rs_fec_dec, source_block))
 	{
 		GST_LOG_OBJECT(rs_fec_dec, "source block #%u can be processed now", source_block->block_nr);
 		ret = gst_rs_fec_dec_process_source_block(rs_fec_dec, source_block);
@@ -949,33 +1860,165 @@ static GstFlowReturn gst_rs_fec_dec_insert_fec_packet(GstRSFECDec *rs_fec_dec, G
 }
 
 
+static GstFlowReturn gst_rs_fec_dec_insert_pending_repair_packets(GstRSFECDec *rs_fec_dec, GSList *pending_repair_packets)
+{
+	GSList *node;
+	GstFlowReturn ret = GST_FLOW_OK;
+
+	/* The list was built with prepend calls; insert the
+	 * packets in the order they were received */
+	pending_repair_packets = g_slist_reverse(pending_repair_packets);
+
+	for (node = pending_repair_packets; node != NULL; node = node->next)
+	{
+		GstBuffer *fec_repair_packet = (GstBuffer *)(node->data);
+
+		if (ret == GST_FLOW_OK)
+			ret = gst_rs_fec_dec_insert_fec_packet(rs_fec_dec, fec_repair_packet, FALSE);
+		else
+			gst_buffer_unref(fec_repair_packet);
+	}
+
+	g_slist_free(pending_repair_packets);
+
+	return ret;
+}
+
+
 static GstRSFECDecSourceBlock* gst_rs_fec_dec_fetch_source_block(GstRSFECDec *rs_fec_dec, guint block_nr)
 {
 	return (GstRSFECDecSourceBlock *)g_hash_table_lookup(rs_fec_dec->source_block_table, GINT_TO_POINTER(block_nr));
 }
 
 
-static GstRSFECDecSourceBlock* gst_rs_fec_dec_create_source_block(GstRSFECDec *rs_fec_dec, guint block_nr)
+static GstRSFECDecSourceBlock* gst_rs_fec_dec_create_source_block(GstRSFECDec *rs_fec_dec, guint block_nr, guint num_source_symbols, guint num_repair_symbols)
 {
 	/* Create a new source block, and insert it into the source block table */
 	GstRSFECDecSourceBlock *source_block = g_slice_alloc0(sizeof(GstRSFECDecSourceBlock));
 	g_hash_table_insert(rs_fec_dec->source_block_table, GINT_TO_POINTER(block_nr), source_block);
 
-	/* Initialize the source block */
+	/* Initialize the source block. If k is not known yet, the
+	 * rest is set up once it is. */
 	source_block->block_nr = block_nr;
-	source_block->output_adu_table = g_slice_alloc0(sizeof(void *) * rs_fec_dec->num_source_symbols);
+	if (num_source_symbols != 0)
+		gst_rs_fec_dec_set_source_block_num_symbols(rs_fec_dec, source_block, num_source_symbols, num_repair_symbols);
 
-	GST_LOG_OBJECT(rs_fec_dec, "created source block #%u", block_nr);
+	GST_LOG_OBJECT(rs_fec_dec, "created source block #%u  (num source symbols: %u  num repair symbols: %u)", block_nr, num_source_symbols, num_repair_symbols);
 
 	return source_block;
 }
 
 
+static void gst_rs_fec_dec_set_source_block_num_symbols(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block, guint num_source_symbols, guint num_repair_symbols)
+{
+	g_assert(source_block->num_code_source_symbols == 0);
+
+	gst_rs_fec_dec_grow_encoding_symbol_table(rs_fec_dec, num_source_symbols, num_repair_symbols);
+
+	source_block->num_mask_symbols = num_source_symbols + num_repair_symbols;
+	source_block->packet_mask = g_slice_alloc0(PACKET_MASK_SIZE(source_block->num_mask_symbols));
+	source_block->output_adu_table = g_slice_alloc0(sizeof(void *) * num_source_symbols);
+	source_block->num_code_source_symbols = num_source_symbols;
+	source_block->num_code_repair_symbols = num_repair_symbols;
+	source_block->num_source_symbols = num_source_symbols;
+}
+
+
+static void gst_rs_fec_dec_set_source_block_num_repair_symbols(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block, guint num_repair_symbols)
+{
+	guint num_mask_symbols = source_block->num_code_source_symbols + num_repair_symbols;
+
+	GST_LOG_OBJECT(rs_fec_dec, "source block #%u has %u repair symbols", source_block->block_nr, num_repair_symbols);
+
+	gst_rs_fec_dec_grow_encoding_symbol_table(rs_fec_dec, source_block->num_code_source_symbols, num_repair_symbols);
+
+	/* Grow the packet mask, keeping the bits of the packets received so far */
+	if (PACKET_MASK_SIZE(num_mask_symbols) > PACKET_MASK_SIZE(source_block->num_mask_symbols))
+	{
+		guint64 *packet_mask = g_slice_alloc0(PACKET_MASK_SIZE(num_mask_symbols));
+		memcpy(packet_mask, source_block->packet_mask, PACKET_MASK_SIZE(source_block->num_mask_symbols));
+		g_slice_free1(PACKET_MASK_SIZE(source_block->num_mask_symbols), source_block->packet_mask);
+		source_block->packet_mask = packet_mask;
+		source_block->num_mask_symbols = num_mask_symbols;
+	}
+	else
+		source_block->num_mask_symbols = MAX(source_block->num_mask_symbols, num_mask_symbols);
+
+	source_block->num_code_repair_symbols = num_repair_symbols;
+}
+
+
+static gboolean gst_rs_fec_dec_shorten_source_block(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block, guint source_block_length)
+{
+	guint esi;
+	GstRSFECDecClass *klass = GST_RS_FEC_DEC_GET_CLASS(rs_fec_dec);
+
+	GST_LOG_OBJECT(rs_fec_dec, "source block #%u is shortened to %u source symbols", source_block->block_nr, source_block_length);
+
+	/* An ADUI with a zero ADU length and no ADU bytes is all zeros after
+	 * padding, so a FEC source packet that only consists of a payload ID
+	 * reproduces exactly the zero symbol the encoder used. Such packets
+	 * are inserted for all ESIs past the end of the shortened block.
+	 * Their empty ADUs are placed in the output_adu_table to mark them
+	 * as present, but never pushed downstream. */
+	for (esi = source_block_length; esi < source_block->num_source_symbols; ++esi)
+	{
+		GstBuffer *fec_source_packet;
+		GstMapInfo map_info;
+
+		/* If there is a "real" source packet with this ESI, then the
+		 * source block length is bogus. Ignore it in that case. */
+		if (SOURCE_BLOCK_IS_FLAG_SET(source_block, esi))
+		{
+			GST_WARNING_OBJECT(rs_fec_dec, "source block #%u is shortened to %u symbols, but contains source packet with ESI %u - ignoring", source_block->block_nr, source_block_length, esi);
+			continue;
+		}
+
+		SOURCE_BLOCK_SET_FLAG(source_block, esi);
+
+		fec_source_packet = gst_buffer_new_allocate(NULL, 6, NULL);
+		gst_buffer_map(fec_source_packet, &map_info, GST_MAP_WRITE);
+		gst_rs_fec_write_payload_id(map_info.data, klass->get_payload_id_m(rs_fec_dec), source_block->block_nr, esi, source_block_length);
+		gst_buffer_unmap(fec_source_packet, &map_info);
+
+		source_block->source_packets = g_slist_prepend(source_block->source_packets, fec_source_packet);
+		source_block->num_source_packets++;
+		source_block->output_adu_table[esi] = gst_buffer_new();
+
+		if ((klass->add_fec_packet != NULL) && !klass->add_fec_packet(rs_fec_dec, source_block, fec_source_packet, esi, TRUE))
+		{
+			GST_ERROR_OBJECT(rs_fec_dec, "could not add zero source symbol with ESI %u to shortened source block #%u", esi, source_block->block_nr);
+			return FALSE;
+		}
+	}
+
+	source_block->num_source_symbols = source_block_length;
+
+	return TRUE;
+}
+
+
 static void gst_rs_fec_dec_destroy_source_block(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block)
 {
 	GSList *node;
 	guint block_nr = source_block->block_nr;
 	guint i;
+	GstRSFECDecClass *klass = GST_RS_FEC_DEC_GET_CLASS(rs_fec_dec);
+	guint num_received_source_symbols;
+
+	/* Update the loss counters. The zero symbols that were added
+	 * to shortened blocks are no received source symbols. (After
+	 * a flush, the counters are reset, so it does not matter that
+	 * the flushed blocks are counted here as well.) */
+	num_received_source_symbols = source_block->num_source_packets - (source_block->num_code_source_symbols - source_block->num_source_symbols);
+	rs_fec_dec->num_report_blocks++;
+	rs_fec_dec->num_report_source_symbols += source_block->num_source_symbols;
+	rs_fec_dec->num_report_lost_source_symbols += source_block->num_source_symbols - num_received_source_symbols;
+
+	/* Release the scheme's decoder state first, since it
+	 * may refer to the memory of the queued packets */
+	if ((source_block->scheme_data != NULL) && (klass->free_source_block_data != NULL))
+		klass->free_source_block_data(rs_fec_dec, source_block);
 
 	/* Clean up all queued FEC source packets */
 	if (source_block->source_packets != NULL)
@@ -1005,14 +2048,25 @@ static void gst_rs_fec_dec_destroy_source_block(GstRSFECDec *rs_fec_dec, GstRSFE
 		g_slist_free(source_block->repair_packets);
 	}
 
+	/* Clean up FEC repair packets of blocks whose k never became known */
+	if (source_block->pending_repair_packets != NULL)
+	{
+		GST_LOG_OBJECT(rs_fec_dec, "cleaning up pending FEC repair packets in source block #%u", block_nr);
+		g_slist_free_full(source_block->pending_repair_packets, (GDestroyNotify)gst_buffer_unref);
+	}
+
 	/* Cleanup the output_adu_table */
-	for (i = 0; i < rs_fec_dec->num_source_symbols; ++i)
+	for (i = 0; i < source_block->num_code_source_symbols; ++i)
 	{
 		GstBuffer *adu = source_block->output_adu_table[i];
 		if (adu != NULL)
 			gst_buffer_unref(adu);
 	}
-	g_slice_free1(sizeof(void *) * rs_fec_dec->num_source_symbols, source_block->output_adu_table);
+	if (source_block->num_code_source_symbols != 0)
+	{
+		g_slice_free1(sizeof(void *) * source_block->num_code_source_symbols, source_block->output_adu_table);
+		g_slice_free1(PACKET_MASK_SIZE(source_block->num_mask_symbols), source_block->packet_mask);
+	}
 
 	/* Source block is cleaned up, now free it */
 	g_slice_free1(sizeof(GstRSFECDecSourceBlock), source_block);
@@ -1024,22 +2078,16 @@ static void gst_rs_fec_dec_destroy_source_block(GstRSFECDec *rs_fec_dec, GstRSFE
 static gboolean gst_rs_fec_dec_can_source_block_be_processed(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block)
 {
 	/* Recovery via Reed-Solomon erasure coding can commence once at least
-	 * num_source_symbols packets have been received */
-	return (source_block->num_source_packets + source_block->num_repair_packets) >= rs_fec_dec->num_source_symbols;
+	 * k packets have been received */
+	return (source_block->num_source_packets + source_block->num_repair_packets) >= source_block->num_code_source_symbols;
 }
 
 
 static GstFlowReturn gst_rs_fec_dec_process_source_block(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block)
 {
-	of_status_t status;
-	of_session_t *session = NULL;
-	GSList *node;
 	guint esi;
-	guint node_count;
-	gsize encoding_symbol_length;
-	guint adu_flow_id = 0; /* XXX: XXX: Currently, only one flow (flow 0) is supported */
+	guint adu_flow_id = 0; /* XXX: Currently, only one flow (flow 0) is supported */
 	GstFlowReturn ret = GST_FLOW_OK;
-	gboolean repair_packets_mapped = FALSE;
 
 	if (source_block->num_repair_packets == 0)
 	{
@@ -1049,147 +2097,294 @@ static GstFlowReturn gst_rs_fec_dec_process_source_block(GstRSFECDec *rs_fec_dec
 
 		/* If this place is reached even though not all source packets have been
 		 * received, then something went wrong when inserting packes. */
-		g_assert(source_block->num_source_packets == rs_fec_dec->num_source_symbols);
+		g_assert(source_block->num_source_packets == source_block->num_code_source_symbols);
 
 		/* All ADUs present, mark it as done. (ADUs were extracted earlier in the
 		 * gst_rs_fec_dec_insert_fec_packet() function.) */
 		source_block->is_complete = TRUE;
+		return GST_FLOW_OK;
 	}
-	else
+
+	/* This point is reached in the more general case that not all FEC source packets
+	 * were received. Let the FEC scheme recover the missing source symbols. */
+	if (!GST_RS_FEC_DEC_GET_CLASS(rs_fec_dec)->recover_source_symbols(rs_fec_dec, source_block))
 	{
-		/* This point is reached in the more general case that not all FEC source packets
-		 * were received */
+		GST_ERROR_OBJECT(rs_fec_dec, "could not recover source symbols of source block #%u", source_block->block_nr);
+		return GST_FLOW_ERROR;
+	}
 
-		/* The encoding_symbol_length needs to be determined. Use the length of the
-		 * first repair packet to this end. All repair packets are of the same length,
-		 * which is encoding_symbol_length + 6 (the FEC payload ID has 6 bytes). */
-		encoding_symbol_length = gst_buffer_get_size((GstBuffer *)(source_block->repair_packets->data)) - 6;
+	/* Output all received and recovered ADUs, in order of their ESI. */
+	for (esi = 0; esi < source_block->num_code_source_symbols; ++esi)
+	{
+		GstBuffer *adu;
+		guint adu_flow, adu_length;
+		guint8 *recovered_sym_memblock = rs_fec_dec->recovered_encoding_symbol_table[esi];
 
-		/* Set up OpenFEC. Unlike encoders, OpenFEC decoder sessions can only be used once
-		 * for each source block, which is why session are created and released here.
-		 * The symbol memory blocks, however, are reallocated only if the encoding_symbol_length
-		 * changed since the last call. */
-		if ((session = gst_rs_fec_dec_create_openfec_session(rs_fec_dec, encoding_symbol_length)) == NULL)
-		{
-			GST_ERROR_OBJECT(rs_fec_dec, "could not create OpenFEC session");
-			return GST_FLOW_ERROR;
-		}
+		/* The zero symbols of a shortened block are never output */
+		if (esi >= source_block->num_source_symbols)
+			break;
 
-		/* Set all of the pointers in the received_encoding_symbol_table to NULL to
-		 * be able to determine later which packets have been lost (needed by OpenFEC) */
-		memset(rs_fec_dec->received_encoding_symbol_table, 0, sizeof(void*) * rs_fec_dec->num_encoding_symbols);
-
-		/* Go over each FEC source packet, create a source symbol out of its ADU
-		 * for the OpenFEC decoder, and store the ADU in the output_adu_table.
-		 * Also update the received_encoding_symbol_table; for each source symbol,
-		 * set the appropriate entry in this table to the corresponding entry in the
-		 * allocated_encoding_symbol_table. In other words, all entries in the
-		 * received_encoding_symbol_table which correspond to a received source symbol
-		 * will be non-NULL after this loop, and the others will be NULL. */
-		for (node = source_block->source_packets; node != NULL; node = node->next)
+		if (recovered_sym_memblock == NULL)
 		{
-			guint esi;
-			GstBuffer *adu;
-			gsize adu_length;
-			gsize padding_length;
-			guint8 *adui_memblock;
-			GstBuffer *fec_source_packet = (GstBuffer *)(node->data);
-
-			/* Get the ESI of the packet */
-			gst_rs_fec_dec_source_packet_read_payload_id(fec_source_packet, NULL, &esi);
-
-			/* Check for invalid source symbol ESIs
-			 * Valid source symbol ESIs are in the range (0..k-1) */
-			g_assert(esi < rs_fec_dec->num_source_symbols);
-
-			/* ADU = FEC source packet minus the trailing 6 bytes which
-			 * make up the FEC payload ID */
-			adu_length = gst_buffer_get_size(fec_source_packet) - 6;
-
-			/* All encoding symbols are of equal length, and a source symbol
-			 * is an ADU with 3 extra bytes prepended and padding njullbytes
-			 * appended to ensure that their length is encoding_symbol_length.
-			 * This means that (adu_length+3) <= source_symbol_length = encoding_symbol_length. */
-			g_assert((adu_length + 3) <= encoding_symbol_length);
-
-			/* Fetch the ADU with the given ESI. The ADUs are already available,
-			 * since they were previously extracted from the packet in the
-			 * gst_rs_fec_dec_insert_fec_packet() function. */
-			adu = source_block->output_adu_table[esi];
-
-			/* Calculate the number of trailing padding bytes needed. */
-			padding_length = encoding_symbol_length - (adu_length + 3);
-
-			/* Assemble a source symbol (= an ADUI) by getting the pointer of the
-			 * corresponding symbol memory block in the allocated_encoding_symbol_table
-			 * (all of these blocks have*a length that equals encoding_symbol_length),
-			 * and writing flow ID and ADU length data into it, followed by the ADU data
-			 * itself. This recreates the ADUIs that were used inside the encoder. */
-			adui_memblock = rs_fec_dec->allocated_encoding_symbol_table[esi];
-			adui_memblock[0] = adu_flow_id;
-			adui_memblock[1] = (adu_length & 0xFF00) >> 8;
-			adui_memblock[2] = (adu_length & 0xFF);
-			gst_buffer_extract(adu, 0, adui_memblock + 3, adu_length);
-
-			/* Put the pointer to the ADUI in the received_encoding_symbol_table,
-			 * using the ESI as the index. We received the ADU, it is not lost.
-			 * By copying the pointer into this table, we inform OpenFEC that the
-			 * source symbol (= ADUI) with the given ESI has been received. */
-			rs_fec_dec->received_encoding_symbol_table[esi] = adui_memblock;
-
-			GST_LOG_OBJECT(rs_fec_dec, "inserted source symbol into encoding symbol table:  ESI: %u  ADU flow ID: %u  ADU length: %" G_GSIZE_FORMAT "  padding: %" G_GSIZE_FORMAT, esi, adu_flow_id, adu_length, padding_length);
-
-			/* Set padding nullbytes to the source symbol to 0 */
-			if (padding_length > 0)
-				memset(adui_memblock + adu_length + 3, 0, padding_length);
-
-			/* If no sorting is needed, then this received ADU has already been
-			 * pushed earlier, when it was inserted. This means that it is no
-			 * longer needed anywhere, so unref the buffer, and mark its entry
-			 * as NULL to ensure it is not unref'd again in
-			 * gst_rs_fec_dec_push_source_block(). */
-			if (!rs_fec_dec->sort_output)
+			/* This ADU was received, not recovered. If no sorting is needed,
+			 * then it has already been pushed earlier, when it was inserted.
+			 * This means that it is no longer needed anywhere, so unref the
+			 * buffer, and mark its entry as NULL to ensure it is not unref'd
+			 * again in gst_rs_fec_dec_push_source_block(). */
+			if (!rs_fec_dec->sort_output && (source_block->output_adu_table[esi] != NULL))
 			{
-				gst_buffer_unref(adu);
+				gst_buffer_unref(source_block->output_adu_table[esi]);
 				source_block->output_adu_table[esi] = NULL;
 			}
+
+			continue;
 		}
 
-		/* Go over each FEC repair packet, map it, and put a pointer to the
-		 * repair symbol data inside the packet in the received_encoding_symbol_table. */
-		node_count = 0;
-		for (node = source_block->repair_packets; node != NULL; node = node->next)
+		/* ADU with with the given ESI was recovered, not received.
+		 * Extract this ADU from the recovered source symbol and
+		 * put the recovered ADU into the source block's output_adu_table. */
+
+		/* Extract flow ID */
+		adu_flow = recovered_sym_memblock[0];
+		/* Extract ADU length (16-bit big endian unsigned integer) */
+		adu_length = (((guint)(recovered_sym_memblock[1])) << 8) | ((guint)(recovered_sym_memblock[2]));
+
+		if (adu_flow != adu_flow_id)
 		{
-			guint esi;
-			GstMapInfo *map_info;
-			GstBuffer *fec_repair_packet = (GstBuffer *)(node->data);
+			GST_ELEMENT_WARNING(rs_fec_dec, STREAM, DECODE, ("multiple ADU flows are currently not supported"), ("recovered ADU has flow ID %u", adu_flow));
+			continue;
+		}
 
-			g_assert(node_count < rs_fec_dec->num_repair_symbols);
+		GST_LOG_OBJECT(rs_fec_dec, "pushing recovered ADU with ESI %u  (source block: #%u  length: %u)", esi, source_block->block_nr, adu_length);
+
+		/* Create a new GstBuffer and copy the ADU bytes into it.
+		 * The ADU bytes are located right after the 3 initial bytes
+		 * (the ADU flow and ADU length). The ADU bytes need to be
+		 * copied, since the symbol memory block referred to by
+		 * the recovered_sym_memblock pointer is reused later for
+		 * subsequent decoding, so we cannot simply wrap that pointer
+		 * in a GstMemory instance. Otherwise, race conditions could
+		 * occur if downstream then tries to access this data at the
+		 * same time. */
+		adu = gst_buffer_new_allocate(NULL, adu_length, NULL);
+		gst_buffer_fill(adu, 0, recovered_sym_memblock + 3, adu_length);
+
+		if (rs_fec_dec->sort_output)
+		{
+			/* Put the recovered ADU into the output_adu_table */
+			source_block->output_adu_table[esi] = adu;
+		}
+		else
+		{
+			/* Sorting is disabled, so we can push the ADU
+			 * immediately. */
+			source_block->output_adu_table[esi] = NULL;
+			if ((ret = gst_rs_fec_dec_push_adu(rs_fec_dec, adu)) != GST_FLOW_OK)
+			{
+				GST_DEBUG_OBJECT(rs_fec_dec, "got return value %s while pushing recovered ADU", gst_flow_get_name(ret));
+				return ret;
+			}
+		}
+	}
+
+	source_block->is_complete = TRUE;
+
+	return ret;
+}
 
-			gst_rs_fec_dec_repair_packet_read_payload_id(fec_repair_packet, NULL, &esi);
 
-			g_assert((esi >= rs_fec_dec->num_source_symbols) && (esi < rs_fec_dec->num_encoding_symbols));
+static GstFlowReturn gst_rs_fec_dec_finish_source_block(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block)
+{
+	/* Give the FEC scheme a last chance to recover the missing
+	 * source symbols of an incomplete block before it is discarded */
+
+	GstRSFECDecClass *klass = GST_RS_FEC_DEC_GET_CLASS(rs_fec_dec);
+
+	if (source_block->is_complete || (klass->finish_source_block == NULL))
+		return GST_FLOW_OK;
+
+	if (!klass->finish_source_block(rs_fec_dec, source_block))
+		return GST_FLOW_OK;
+
+	GST_LOG_OBJECT(rs_fec_dec, "incomplete source block #%u can be processed after finishing decoding", source_block->block_nr);
+
+	return gst_rs_fec_dec_process_source_block(rs_fec_dec, source_block);
+}
+
+
+static gboolean gst_rs_fec_dec_recover_source_symbols(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block)
+{
+	of_status_t status;
+	of_session_t *session = NULL;
+	GSList *node;
+	guint esi;
+	guint node_count;
+	gsize encoding_symbol_length;
+	guint adu_flow_id = 0; /* XXX: Currently, only one flow (flow 0) is supported */
+	gboolean ret = TRUE;
+	gboolean repair_packets_mapped = FALSE;
+	guint const num_source_symbols = source_block->num_code_source_symbols;
+	guint const num_repair_symbols = source_block->num_code_repair_symbols;
+
+	/* The encoding_symbol_length needs to be determined. Use the length of the
+	 * first repair packet to this end. All repair packets are of the same length,
+	 * which is encoding_symbol_length + 6 (the FEC payload ID has 6 bytes). */
+	encoding_symbol_length = gst_buffer_get_size((GstBuffer *)(source_block->repair_packets->data)) - 6;
+
+	/* The symbol memory blocks are reallocated only if the encoding_symbol_length
+	 * changed since the last call. */
+	gst_rs_fec_dec_alloc_symbol_memblocks(rs_fec_dec, encoding_symbol_length);
+
+	/* Set up OpenFEC. Unlike encoders, OpenFEC decoder sessions can only be used once
+	 * for each source block, which is why session are created and released here.
+	 * The Cauchy decoder does not need a session. */
+	if ((rs_fec_dec->code_construction == GST_RS_FEC_CODE_CONSTRUCTION_VANDERMONDE) && ((session = gst_rs_fec_dec_create_openfec_session(rs_fec_dec, num_source_symbols, num_repair_symbols, encoding_symbol_length)) == NULL))
+	{
+		GST_ERROR_OBJECT(rs_fec_dec, "could not create OpenFEC session");
+		return FALSE;
+	}
+
+	/* Set all of the pointers in the received_encoding_symbol_table to NULL to
+	 * be able to determine later which packets have been lost (needed by OpenFEC) */
+	memset(rs_fec_dec->received_encoding_symbol_table, 0, sizeof(void*) * (rs_fec_dec->max_source_symbols + rs_fec_dec->max_repair_symbols));
+
+	/* Go over each FEC source packet, create a source symbol out of its ADU
+	 * for the OpenFEC decoder, and store the ADU in the output_adu_table.
+	 * Also update the received_encoding_symbol_table; for each source symbol,
+	 * set the appropriate entry in this table to the corresponding entry in the
+	 * allocated_encoding_symbol_table. In other words, all entries in the
+	 * received_encoding_symbol_table which correspond to a received source symbol
+	 * will be non-NULL after this loop, and the others will be NULL. */
+	for (node = source_block->source_packets; node != NULL; node = node->next)
+	{
+		guint esi;
+		GstBuffer *adu;
+		gsize adu_length;
+		gsize padding_length;
+		guint8 *adui_memblock;
+		GstBuffer *fec_source_packet = (GstBuffer *)(node->data);
+
+		/* Get the ESI of the packet */
+		gst_rs_fec_dec_source_packet_read_payload_id(rs_fec_dec, fec_source_packet, NULL, &esi, NULL);
+
+		/* Check for invalid source symbol ESIs
+		 * Valid source symbol ESIs are in the range (0..k-1) */
+		g_assert(esi < num_source_symbols);
+
+		/* ADU = FEC source packet minus the trailing 6 bytes which
+		 * make up the FEC payload ID */
+		adu_length = gst_buffer_get_size(fec_source_packet) - 6;
+
+		/* All encoding symbols are of equal length, and a source symbol
+		 * is an ADU with 3 extra bytes prepended and padding njullbytes
+		 * appended to ensure that their length is encoding_symbol_length.
+		 * This means that (adu_length+3) <= source_symbol_length = encoding_symbol_length. */
+		g_assert((adu_length + 3) <= encoding_symbol_length);
+
+		/* Fetch the ADU with the given ESI. The ADUs are already available,
+		 * since they were previously extracted from the packet in the
+		 * gst_rs_fec_dec_insert_fec_packet() function. */
+		adu = source_block->output_adu_table[esi];
+
+		/* Calculate the number of trailing padding bytes needed. */
+		padding_length = encoding_symbol_length - (adu_length + 3);
+
+		/* Assemble a source symbol (= an ADUI) by getting the pointer of the
+		 * corresponding symbol memory block in the allocated_encoding_symbol_table
+		 * (all of these blocks have*a length that equals encoding_symbol_length),
+		 * and writing flow ID and ADU length data into it, followed by the ADU data
+		 * itself. This recreates the ADUIs that were used inside the encoder. */
+		adui_memblock = rs_fec_dec->allocated_encoding_symbol_table[esi];
+		adui_memblock[0] = adu_flow_id;
+		adui_memblock[1] = (adu_length & 0xFF00) >> 8;
+		adui_memblock[2] = (adu_length & 0xFF);
+		gst_buffer_extract(adu, 0, adui_memblock + 3, adu_length);
+
+		/* Put the pointer to the ADUI in the received_encoding_symbol_table,
+		 * using the ESI as the index. We received the ADU, it is not lost.
+		 * By copying the pointer into this table, we inform OpenFEC that the
+		 * source symbol (= ADUI) with the given ESI has been received. */
+		rs_fec_dec->received_encoding_symbol_table[esi] = adui_memblock;
+
+		GST_LOG_OBJECT(rs_fec_dec, "inserted source symbol into encoding symbol table:  ESI: %u  ADU flow ID: %u  ADU length: %" G_GSIZE_FORMAT "  padding: %" G_GSIZE_FORMAT, esi, adu_flow_id, adu_length, padding_length);
+
+		/* Set padding nullbytes to the source symbol to 0 */
+		if (padding_length > 0)
+			memset(adui_memblock + adu_length + 3, 0, padding_length);
+	}
+
+	/* Go over each FEC repair packet, map it, and put a pointer to the
+	 * repair symbol data inside the packet in the received_encoding_symbol_table. */
+	node_count = 0;
+	for (node = source_block->repair_packets; node != NULL; node = node->next)
+	{
+		guint esi;
+		GstMapInfo *map_info;
+		GstBuffer *fec_repair_packet = (GstBuffer *)(node->data);
+
+		g_assert(node_count < num_repair_symbols);
+
+		gst_rs_fec_dec_repair_packet_read_payload_id(rs_fec_dec, fec_repair_packet, NULL, &esi, NULL);
+
+		g_assert((esi >= num_source_symbols) && (esi < (num_source_symbols + num_repair_symbols)));
+
+		/* Map the FEC repair packet, and keep the mapping information in the
+		 * fec_repair_packet_mapinfos array. This way, after recovery is
+		 * finished, all of the buffers can be unmapped.
+		 * After this loop finishes, the first N entries in the array are
+		 * filled with valid mapinfo, where N equals the number of nodes in
+		 * the repair_packets list. */
+		map_info = &(rs_fec_dec->fec_repair_packet_mapinfos[node_count]);
+		gst_buffer_map(fec_repair_packet, map_info, GST_MAP_READ);
+
+		/* The first 6 bytes in the FEC repair packet are its payload ID.
+		 * The following bytes are the repair symbol data, which is what
+		 * OpenFEC needs. */
+		rs_fec_dec->received_encoding_symbol_table[esi] = map_info->data + 6;
+
+		/* Incrementing this counter is necessary for storing the
+		 * map information */
+		node_count++;
+	}
+	repair_packets_mapped = TRUE;
+
+	if (rs_fec_dec->code_construction != GST_RS_FEC_CODE_CONSTRUCTION_VANDERMONDE)
+	{
+		gboolean decoded;
 
-			/* Map the FEC repair packet, and keep the mapping information in the
-			 * fec_repair_packet_mapinfos array. This way, after recovery is
-			 * finished, all of the buffers can be unmapped.
-			 * After this loop finishes, the first N entries in the array are
-			 * filled with valid mapinfo, where N equals the number of nodes in
-			 * the repair_packets list. */
-			map_info = &(rs_fec_dec->fec_repair_packet_mapinfos[node_count]);
-			gst_buffer_map(fec_repair_packet, map_info, GST_MAP_READ);
+		/* The in-plugin decoders write the recovered symbols directly into the memory
+		 * blocks that are given to them, so fill the recovered_encoding_symbol_table
+		 * with the allocated memory blocks of the lost source symbols. (With the
+		 * parity-cauchy construction, gst_rs_cauchy_decode() also takes care of the
+		 * single erasure XOR fast path.) */
+		for (esi = 0; esi < num_source_symbols; ++esi)
+			rs_fec_dec->recovered_encoding_symbol_table[esi] = (rs_fec_dec->received_encoding_symbol_table[esi] == NULL) ? rs_fec_dec->allocated_encoding_symbol_table[esi] : NULL;
 
-			/* The first 6 bytes in the FEC repair packet are its payload ID.
-			 * The following bytes are the repair symbol data, which is what
-			 * OpenFEC needs. */
-			rs_fec_dec->received_encoding_symbol_table[esi] = map_info->data + 6;
+		if (rs_fec_dec->code_construction == GST_RS_FEC_CODE_CONSTRUCTION_GF16_FFT)
+		{
+			/* The GF(2^16) code works with 16-bit words. An odd length
+			 * means that the packets were not produced by a gf16-fft
+			 * encoder. */
+			if ((encoding_symbol_length & 1) != 0)
+			{
+				GST_ERROR_OBJECT(rs_fec_dec, "encoding symbol length %" G_GSIZE_FORMAT " is odd", encoding_symbol_length);
+				ret = FALSE;
+				goto cleanup;
+			}
 
-			/* Incrementing this counter is necessary for storing the
-			 * map information */
-			node_count++;
+			decoded = gst_rs_fft_decode(num_source_symbols, num_repair_symbols, rs_fec_dec->received_encoding_symbol_table, rs_fec_dec->recovered_encoding_symbol_table, encoding_symbol_length);
 		}
-		repair_packets_mapped = TRUE;
+		else
+			decoded = gst_rs_cauchy_decode(rs_fec_dec->code_construction == GST_RS_FEC_CODE_CONSTRUCTION_PARITY_CAUCHY, num_source_symbols, num_repair_symbols, rs_fec_dec->received_encoding_symbol_table, rs_fec_dec->recovered_encoding_symbol_table, encoding_symbol_length);
 
+		if (!decoded)
+		{
+			ret = FALSE;
+			goto cleanup;
+		}
+	}
+	else
+	{
 		/* Inform OpenFEC about the received symbols. At this point, any encoding symbols that
 		 * have been received will have a non-NULL entry in the received_encoding_symbol_table.
 		 * Those who have not been received are considered lost at this point and have NULL
@@ -1198,7 +2393,7 @@ static GstFlowReturn gst_rs_fec_dec_process_source_block(GstRSFECDec *rs_fec_dec
 		{
 			GST_ERROR_OBJECT(rs_fec_dec, "could not set available symbols: %s", gst_rs_fec_dec_get_status_name(status));
 			CHECK_IF_FATAL_ERROR(rs_fec_dec, status);
-			ret = GST_FLOW_ERROR;
+			ret = FALSE;
 			goto cleanup;
 		}
 
@@ -1215,7 +2410,7 @@ static GstFlowReturn gst_rs_fec_dec_process_source_block(GstRSFECDec *rs_fec_dec
 		{
 			GST_ERROR_OBJECT(rs_fec_dec, "could not finish decoding: %s", gst_rs_fec_dec_get_status_name(status));
 			CHECK_IF_FATAL_ERROR(rs_fec_dec, status);
-			ret = GST_FLOW_ERROR;
+			ret = FALSE;
 			goto cleanup;
 		}
 
@@ -1226,72 +2421,19 @@ static GstFlowReturn gst_rs_fec_dec_process_source_block(GstRSFECDec *rs_fec_dec
 		{
 			GST_ERROR_OBJECT(rs_fec_dec, "could not get the recovered symbols: %s", gst_rs_fec_dec_get_status_name(status));
 			CHECK_IF_FATAL_ERROR(rs_fec_dec, status);
-			ret = GST_FLOW_ERROR;
+			ret = FALSE;
 			goto cleanup;
 		}
 
-		/* Output all received and recovered ADUs, in order of their ESI. */
-		for (esi = 0; esi < rs_fec_dec->num_source_symbols; ++esi)
+		/* OpenFEC also returns the received source symbols in the table, but
+		 * only the recovered ones shall be in it */
+		for (esi = 0; esi < num_source_symbols; ++esi)
 		{
-			if (rs_fec_dec->received_encoding_symbol_table[esi] == NULL)
-			{
-				/* ADU with with the given ESI was recovered, not received.
-				 * Extract this ADU from the recovered source symbol and
-				 * put the recovered ADU into the source block's output_adu_table. */
-
-				GstBuffer *adu;
-				guint adu_flow, adu_length;
-				guint8 *recovered_sym_memblock = rs_fec_dec->recovered_encoding_symbol_table[esi];
-
-				g_assert(recovered_sym_memblock != NULL);
-
-				/* Extract flow ID */
-				adu_flow = recovered_sym_memblock[0];
-				/* Extract ADU length (16-bit big endian unsigned integer) */
-				adu_length = (((guint)(recovered_sym_memblock[1])) << 8) | ((guint)(recovered_sym_memblock[2]));
-
-				if (adu_flow != 0)
-				{
-					GST_ELEMENT_WARNING(rs_fec_dec, STREAM, DECODE, ("multiple ADU flows are currently not supported"), ("recovered ADU has flow ID %u", adu_flow));
-					continue;
-				}
-
-				GST_LOG_OBJECT(rs_fec_dec, "pushing recovered ADU with ESI %u  (source block: #%u  length: %u)", esi, source_block->block_nr, adu_length);
-
-				/* Create a new GstBuffer and copy the ADU bytes into it.
-				 * The ADU bytes are located right after the 3 initial bytes
-				 * (the ADU flow and ADU length). The ADU bytes need to be
-				 * copied, since the symbol memory block referred to by
-				 * the recovered_sym_memblock pointer is reused later for
-				 * subsequent decoding, so we cannot simply wrap that pointer
-				 * in a GstMemory instance. Otherwise, race conditions could
-				 * occur if downstream then tries to access this data at the
-				 * same time. */
-				adu = gst_buffer_new_allocate(NULL, adu_length, NULL);
-				gst_buffer_fill(adu, 0, recovered_sym_memblock + 3, adu_length);
-
-				if (rs_fec_dec->sort_output)
-				{
-					/* Put the recovered ADU into the output_adu_table */
-					source_block->output_adu_table[esi] = adu;
-				}
-				else
-				{
-					/* Sorting is disabled, so we can push the ADU
-					 * immediately. */
-					source_block->output_adu_table[esi] = NULL;
-					if ((ret = gst_rs_fec_dec_push_adu(rs_fec_dec, adu)) != GST_FLOW_OK)
-					{
-						GST_DEBUG_OBJECT(rs_fec_dec, "got return value %s while pushing recovered ADU", gst_flow_get_name(ret));
-						goto cleanup;
-					}
-				}
-			}
+			if (rs_fec_dec->received_encoding_symbol_table[esi] != NULL)
+				rs_fec_dec->recovered_encoding_symbol_table[esi] = NULL;
 		}
 	}
 
-	source_block->is_complete = TRUE;
-
 cleanup:
 	if (repair_packets_mapped)
 	{
@@ -1303,7 +2445,7 @@ cleanup:
 			GstMapInfo *map_info;
 			GstBuffer *fec_repair_packet = (GstBuffer *)(node->data);
 
-			g_assert(node_count < rs_fec_dec->num_repair_symbols);
+			g_assert(node_count < num_repair_symbols);
 
 			map_info = &(rs_fec_dec->fec_repair_packet_mapinfos[node_count]);
 			gst_buffer_unmap(fec_repair_packet, map_info);
@@ -1330,7 +2472,7 @@ static GstFlowReturn gst_rs_fec_dec_push_source_block(GstRSFECDec *rs_fec_dec, G
 	GstFlowReturn ret = GST_FLOW_OK;
 	gboolean push_adus = TRUE;
 
-	for (esi = 0; esi < rs_fec_dec->num_source_symbols; ++esi)
+	for (esi = 0; esi < source_block->num_code_source_symbols; ++esi)
 	{
 		GstBuffer *adu = source_block->output_adu_table[esi];
 		source_block->output_adu_table[esi] = NULL;
@@ -1338,7 +2480,8 @@ static GstFlowReturn gst_rs_fec_dec_push_source_block(GstRSFECDec *rs_fec_dec, G
 		if (adu == NULL)
 			continue;
 
-		if (push_adus)
+		/* The zero symbols of a shortened block are never output */
+		if (push_adus && (esi < source_block->num_source_symbols))
 		{
 			GST_LOG_OBJECT(rs_fec_dec, "pushing ADU with ESI %u from source block %u", esi, source_block->block_nr);
 			if ((ret = gst_rs_fec_dec_push_adu(rs_fec_dec, adu)) != GST_FLOW_OK)
@@ -1355,7 +2498,7 @@ static GstFlowReturn gst_rs_fec_dec_push_source_block(GstRSFECDec *rs_fec_dec, G
 }
 
 
-static gboolean gst_rs_fec_dec_is_source_block_nr_newer(guint candidate_block_nr, guint reference_block_nr)
+static gboolean gst_rs_fec_dec_is_source_block_nr_newer(guint candidate_block_nr, guint reference_block_nr, guint num_block_nr_bits)
 {
 	/* A source block number is considered "newer" if it is in the range
 	 * (reference_block_nr+1 ... (reference_block_nr+(2^24-1)) mod (2^24)).
@@ -1369,19 +2512,22 @@ static gboolean gst_rs_fec_dec_is_source_block_nr_newer(guint candidate_block_nr
 	 * But this contradicts itself, since foe example 16777214 > 0. By
 	 * introducing a range for newer values, it is resolved. In this example,
 	 * newer values range from 1 to 2^22, and the remaining values are
-	 * considered current, old, or too old. */
+	 * considered current, old, or too old.
+	 *
+	 * With num_block_nr_bits other than 24, the ranges are scaled
+	 * accordingly (the newer range is always a quarter of the total). */
 
-	guint const newer_range = (1u << 22);
-	guint const total_range = (1u << 24);
+	guint const total_range = (1u << num_block_nr_bits);
+	guint const newer_range = total_range >> 2;
 
-	guint start = reference_block_nr + 1;
+	guint start = (reference_block_nr + 1) & (total_range - 1);
 	guint end = (reference_block_nr + (newer_range - 1)) & (total_range - 1);
 
 	return gst_rs_fec_dec_check_if_source_block_in_range(candidate_block_nr, start, end);
 }
 
 
-static gboolean gst_rs_fec_dec_is_source_block_nr_recent_enough(guint candidate_block_nr, guint reference_block_nr, guint max_age)
+static gboolean gst_rs_fec_dec_is_source_block_nr_recent_enough(guint candidate_block_nr, guint reference_block_nr, guint max_age, guint num_block_nr_bits)
 {
 	/* See the explanation in gst_rs_fec_dec_is_source_block_nr_newer() for
 	 * details.
@@ -1389,8 +2535,8 @@ static gboolean gst_rs_fec_dec_is_source_block_nr_recent_enough(guint candidate_
 	 * The "recent enough" range also includes the "newer range", since otherwise
 	 * this function would incorrectly classify newer values as "too old". */
 
-	guint const newer_range = (1u << 22);
-	guint const total_range = (1u << 24);
+	guint const total_range = (1u << num_block_nr_bits);
+	guint const newer_range = total_range >> 2;
 
 	guint start = (reference_block_nr + total_range - (max_age - 1)) & (total_range - 1);
 	guint end = (reference_block_nr + (newer_range - 1)) & (total_range - 1);
@@ -1444,7 +2590,7 @@ static GstFlowReturn gst_rs_fec_dec_prune_source_block_table(GstRSFECDec *rs_fec
 		 * at this point, a source block nr is either slightly old
 		 * (but still recent enough), or the same as most_recent_block_nr,
 		 * or newer. */
-		if (gst_rs_fec_dec_is_source_block_nr_newer(source_block_nr, rs_fec_dec->most_recent_block_nr))
+		if (gst_rs_fec_dec_is_source_block_nr_newer(source_block_nr, rs_fec_dec->most_recent_block_nr, GST_RS_FEC_DEC_NUM_BLOCK_NR_BITS(rs_fec_dec)))
 		{
 			gpointer value;
 			GHashTableIter iter;
@@ -1458,11 +2604,16 @@ static GstFlowReturn gst_rs_fec_dec_prune_source_block_table(GstRSFECDec *rs_fec
 			while (g_hash_table_iter_next(&iter, NULL, &value))
 			{
 				GstRSFECDecSourceBlock *source_block = (GstRSFECDecSourceBlock *)value;
-				if (!gst_rs_fec_dec_is_source_block_nr_recent_enough(source_block->block_nr, rs_fec_dec->most_recent_block_nr, rs_fec_dec->max_source_block_age))
+				if (!gst_rs_fec_dec_is_source_block_nr_recent_enough(source_block->block_nr, rs_fec_dec->most_recent_block_nr, rs_fec_dec->max_source_block_age, GST_RS_FEC_DEC_NUM_BLOCK_NR_BITS(rs_fec_dec)))
 				{
 					/* This source block is too old and needs to be pruned.
 					 * Insert it in the block list if sorting is enabled,
-					 * or just destroy it right away otherwise. */
+					 * or just destroy it right away otherwise. If it is
+					 * incomplete, try to recover its missing symbols first
+					 * (if sorting is disabled, this pushes recovered ADUs). */
+
+					if (ret == GST_FLOW_OK)
+						ret = gst_rs_fec_dec_finish_source_block(rs_fec_dec, source_block);
 
 					if (rs_fec_dec->sort_output)
 					{
@@ -1528,6 +2679,10 @@ static GstFlowReturn gst_rs_fec_dec_drain_source_block_table(GstRSFECDec *rs_fec
 	{
 		GstRSFECDecSourceBlock *source_block = (GstRSFECDecSourceBlock *)value;
 
+		/* Last chance for incomplete blocks to recover their missing symbols */
+		if (ret == GST_FLOW_OK)
+			ret = gst_rs_fec_dec_finish_source_block(rs_fec_dec, source_block);
+
 		GST_LOG_OBJECT(rs_fec_dec, "inserting source block #%u into the draining list", source_block->block_nr);
 		drain_block_list = g_slist_prepend(drain_block_list, source_block);
 		g_hash_table_iter_remove(&iter);
@@ -1564,6 +2719,45 @@ static GstFlowReturn gst_rs_fec_dec_drain_source_block_table(GstRSFECDec *rs_fec
 }
 
 
+static GstStructure* gst_rs_fec_dec_take_loss_report(GstRSFECDec *rs_fec_dec)
+{
+	GstStructure *loss_report;
+	guint loss_report_interval;
+
+	GST_OBJECT_LOCK(rs_fec_dec);
+	loss_report_interval = rs_fec_dec->loss_report_interval;
+	GST_OBJECT_UNLOCK(rs_fec_dec);
+
+	if ((loss_report_interval == 0) || (rs_fec_dec->num_report_blocks < loss_report_interval) || (rs_fec_dec->num_report_source_symbols == 0))
+		return NULL;
+
+	loss_report = gst_structure_new(
+		GST_FEC_LOSS_REPORT_STRUCTURE_NAME,
+		"lost-source-symbols", G_TYPE_UINT, rs_fec_dec->num_report_lost_source_symbols,
+		"num-source-symbols", G_TYPE_UINT, rs_fec_dec->num_report_source_symbols,
+		"loss-rate", G_TYPE_DOUBLE, (gdouble)(rs_fec_dec->num_report_lost_source_symbols) / (gdouble)(rs_fec_dec->num_report_source_symbols),
+		NULL
+	);
+
+	GST_LOG_OBJECT(rs_fec_dec, "loss report: %u of %u source symbols lost in the last %u source blocks", rs_fec_dec->num_report_lost_source_symbols, rs_fec_dec->num_report_source_symbols, rs_fec_dec->num_report_blocks);
+
+	rs_fec_dec->num_report_blocks = 0;
+	rs_fec_dec->num_report_lost_source_symbols = 0;
+	rs_fec_dec->num_report_source_symbols = 0;
+
+	return loss_report;
+}
+
+
+static void gst_rs_fec_dec_send_loss_report(GstRSFECDec *rs_fec_dec, GstStructure *loss_report)
+{
+	/* Post a copy for the application, then send the report upstream.
+	 * Both functions take ownership of the structure. */
+	gst_element_post_message(GST_ELEMENT(rs_fec_dec), gst_message_new_element(GST_OBJECT(rs_fec_dec), gst_structure_copy(loss_report)));
+	gst_pad_push_event(rs_fec_dec->fecsourcepad, gst_event_new_custom(GST_EVENT_CUSTOM_UPSTREAM, loss_report));
+}
+
+
 static void gst_rs_fec_dec_reset_states(GstRSFECDec *rs_fec_dec)
 {
 	/* _Not_ setting encoding_symbol_length to 0 here, since its
@@ -1579,6 +2773,23 @@ static void gst_rs_fec_dec_reset_states(GstRSFECDec *rs_fec_dec)
 	rs_fec_dec->segment_started = FALSE;
 	rs_fec_dec->fecsource_eos = FALSE;
 	rs_fec_dec->fecrepair_eos = FALSE;
+	rs_fec_dec->num_report_blocks = 0;
+	rs_fec_dec->num_report_lost_source_symbols = 0;
+	rs_fec_dec->num_report_source_symbols = 0;
+	rs_fec_dec->last_source_packet_time = GST_CLOCK_TIME_NONE;
+	rs_fec_dec->last_output_pts = GST_CLOCK_TIME_NONE;
+
+	if (rs_fec_dec->partial_adu != NULL)
+	{
+		gst_buffer_unref(rs_fec_dec->partial_adu);
+		rs_fec_dec->partial_adu = NULL;
+	}
+
+	if (rs_fec_dec->pending_output != NULL)
+	{
+		gst_buffer_unref(rs_fec_dec->pending_output);
+		rs_fec_dec->pending_output = NULL;
+	}
 }
 
 
@@ -1600,13 +2811,164 @@ static void gst_rs_fec_dec_flush(GstRSFECDec *rs_fec_dec)
 }
 
 
+static GstBuffer* gst_rs_fec_dec_reassemble_adu(GstRSFECDec *rs_fec_dec, GstBuffer *fragment)
+{
+	guint8 header[GST_RS_FEC_FRAGMENT_HEADER_SIZE];
+	guint adu_nr, fragment_index;
+	gboolean is_last_fragment;
+	GstBuffer *adu;
+
+	if (gst_buffer_extract(fragment, 0, header, GST_RS_FEC_FRAGMENT_HEADER_SIZE) != GST_RS_FEC_FRAGMENT_HEADER_SIZE)
+	{
+		GST_WARNING_OBJECT(rs_fec_dec, "ADU is too small to contain a fragment header - discarding");
+		gst_buffer_unref(fragment);
+		return NULL;
+	}
+	gst_rs_fec_read_fragment_header(header, &adu_nr, &fragment_index, &is_last_fragment);
+
+	/* Strip the fragment header; this only adjusts the
+	 * memory offsets, the bytes themselves stay in place */
+	fragment = gst_buffer_make_writable(fragment);
+	gst_buffer_resize(fragment, GST_RS_FEC_FRAGMENT_HEADER_SIZE, -1);
+
+	/* Fragments arrive in order (the output is sorted), so if this is not
+	 * the expected fragment, one or more fragments were lost for good */
+	if ((rs_fec_dec->partial_adu != NULL) && ((adu_nr != rs_fec_dec->partial_adu_nr) || (fragment_index != rs_fec_dec->next_fragment_index)))
+	{
+		GST_DEBUG_OBJECT(rs_fec_dec, "fragment #%u of ADU #%u is missing - discarding partial ADU", rs_fec_dec->next_fragment_index, rs_fec_dec->partial_adu_nr);
+		gst_buffer_unref(rs_fec_dec->partial_adu);
+		rs_fec_dec->partial_adu = NULL;
+	}
+
+	if (rs_fec_dec->partial_adu == NULL)
+	{
+		if (fragment_index != 0)
+		{
+			GST_DEBUG_OBJECT(rs_fec_dec, "first fragment of ADU #%u is missing - discarding fragment #%u", adu_nr, fragment_index);
+			gst_buffer_unref(fragment);
+			return NULL;
+		}
+
+		/* The first fragment carries the timestamps and flags of the ADU */
+		rs_fec_dec->partial_adu = fragment;
+		rs_fec_dec->partial_adu_nr = adu_nr;
+	}
+	else
+		rs_fec_dec->partial_adu = gst_buffer_append(rs_fec_dec->partial_adu, fragment);
+
+	rs_fec_dec->next_fragment_index = fragment_index + 1;
+
+	if (!is_last_fragment)
+		return NULL;
+
+	adu = rs_fec_dec->partial_adu;
+	rs_fec_dec->partial_adu = NULL;
+
+	GST_LOG_OBJECT(rs_fec_dec, "reassembled ADU #%u from %u fragment(s), %" G_GSIZE_FORMAT " bytes", adu_nr, fragment_index + 1, gst_buffer_get_size(adu));
+
+	return adu;
+}
+
+
+static GstBuffer* gst_rs_fec_dec_restore_timestamps(GstRSFECDec *rs_fec_dec, GstBuffer *adu)
+{
+	guint8 header[GST_RS_FEC_TIMESTAMP_HEADER_SIZE];
+	GstClockTime pts, duration;
+
+	if (gst_buffer_extract(adu, 0, header, GST_RS_FEC_TIMESTAMP_HEADER_SIZE) != GST_RS_FEC_TIMESTAMP_HEADER_SIZE)
+	{
+		GST_WARNING_OBJECT(rs_fec_dec, "ADU is too small to contain a timestamp header - discarding");
+		gst_buffer_unref(adu);
+		return NULL;
+	}
+	gst_rs_fec_read_timestamp_header(header, &pts, &duration);
+
+	/* Strip the timestamp header; like with fragment headers,
+	 * this only adjusts the memory offsets */
+	adu = gst_buffer_make_writable(adu);
+	gst_buffer_resize(adu, GST_RS_FEC_TIMESTAMP_HEADER_SIZE, -1);
+
+	/* The PTS is the running time at the encoder. The output segment
+	 * starts at 0, so it is also the PTS in the output segment. The
+	 * DTS is not transmitted. */
+	GST_BUFFER_PTS(adu) = pts;
+	GST_BUFFER_DTS(adu) = GST_CLOCK_TIME_NONE;
+	GST_BUFFER_DURATION(adu) = duration;
+
+	GST_LOG_OBJECT(rs_fec_dec, "restored timestamps of ADU: PTS %" GST_TIME_FORMAT " duration %" GST_TIME_FORMAT, GST_TIME_ARGS(pts), GST_TIME_ARGS(duration));
+
+	return adu;
+}
+
+
+static GstFlowReturn gst_rs_fec_dec_unpack_adus(GstRSFECDec *rs_fec_dec, GstBuffer *pack)
+{
+	GstFlowReturn ret = GST_FLOW_OK;
+	gsize pack_size = gst_buffer_get_size(pack);
+	gsize offset = 0;
+
+	while (offset < pack_size)
+	{
+		guint8 entry_header[GST_RS_FEC_PACK_ENTRY_HEADER_SIZE];
+		gsize adu_length;
+		GstBuffer *adu;
+
+		if (gst_buffer_extract(pack, offset, entry_header, GST_RS_FEC_PACK_ENTRY_HEADER_SIZE) != GST_RS_FEC_PACK_ENTRY_HEADER_SIZE)
+		{
+			GST_WARNING_OBJECT(rs_fec_dec, "pack ends with a truncated entry header - discarding rest of pack");
+			break;
+		}
+		offset += GST_RS_FEC_PACK_ENTRY_HEADER_SIZE;
+
+		adu_length = (((gsize)(entry_header[0])) << 8) | ((gsize)(entry_header[1]));
+		if (adu_length > (pack_size - offset))
+		{
+			GST_WARNING_OBJECT(rs_fec_dec, "pack entry with %" G_GSIZE_FORMAT " bytes exceeds the pack - discarding rest of pack", adu_length);
+			break;
+		}
+
+		/* Using a GStreamer subbuffer to avoid unnecessary copies */
+		adu = gst_buffer_copy_region(pack, GST_BUFFER_COPY_MEMORY, offset, adu_length);
+		offset += adu_length;
+
+		if ((ret = gst_rs_fec_dec_push_unpacked_adu(rs_fec_dec, adu)) != GST_FLOW_OK)
+			break;
+	}
+
+	gst_buffer_unref(pack);
+
+	return ret;
+}
+
+
 static GstFlowReturn gst_rs_fec_dec_push_adu(GstRSFECDec *rs_fec_dec, GstBuffer *adu)
 {
+	if (rs_fec_dec->unpack_adus || rs_fec_dec->caps_packed)
+		return gst_rs_fec_dec_unpack_adus(rs_fec_dec, adu);
+	else
+		return gst_rs_fec_dec_push_unpacked_adu(rs_fec_dec, adu);
+}
+
+
+static GstFlowReturn gst_rs_fec_dec_push_unpacked_adu(GstRSFECDec *rs_fec_dec, GstBuffer *adu)
+{
+	/* Fragments are only pushed once their ADU is complete */
+	if ((rs_fec_dec->reassemble_fragments || rs_fec_dec->caps_fragmented) && ((adu = gst_rs_fec_dec_reassemble_adu(rs_fec_dec, adu)) == NULL))
+		return GST_FLOW_OK;
+
+	if (rs_fec_dec->restore_timestamps || rs_fec_dec->caps_timestamped)
+	{
+		if ((adu = gst_rs_fec_dec_restore_timestamps(rs_fec_dec, adu)) == NULL)
+			return GST_FLOW_OK;
+	}
+
 	/* Send stream-start and segment events if necessary */
 	gst_rs_fec_dec_push_stream_start(rs_fec_dec);
 	gst_rs_fec_dec_push_segment(rs_fec_dec);
 
-	if (rs_fec_dec->do_timestamp)
+	/* Transmitted timestamps are exact, even for recovered
+	 * ADUs, so they are preferred over the arrival time */
+	if (rs_fec_dec->do_timestamp && !(rs_fec_dec->restore_timestamps || rs_fec_dec->caps_timestamped))
 	{
 		/* Fetch clock and base time, to be able to set buffer timestamps */
 		GstClock *clock = GST_ELEMENT_CLOCK(rs_fec_dec);
@@ -1623,7 +2985,276 @@ static GstFlowReturn gst_rs_fec_dec_push_adu(GstRSFECDec *rs_fec_dec, GstBuffer
 		}
 	}
 
-	return gst_pad_push(rs_fec_dec->srcpad, adu);
+	if (rs_fec_dec->output_buffer_size == 0)
+		return gst_rs_fec_dec_push_output_buffer(rs_fec_dec, adu);
+
+	/* Collect the ADU in the pending output buffer. Appending only
+	 * merges the memory blocks; the bytes are not copied. The
+	 * output buffer keeps the timestamps of its first ADU. */
+	if (rs_fec_dec->pending_output == NULL)
+		rs_fec_dec->pending_output = adu;
+	else
+		rs_fec_dec->pending_output = gst_buffer_append(rs_fec_dec->pending_output, adu);
+
+	if (gst_buffer_get_size(rs_fec_dec->pending_output) < rs_fec_dec->output_buffer_size)
+		return GST_FLOW_OK;
+
+	return gst_rs_fec_dec_push_pending_output(rs_fec_dec);
+}
+
+
+static GstFlowReturn gst_rs_fec_dec_push_pending_output(GstRSFECDec *rs_fec_dec)
+{
+	GstBuffer *output = rs_fec_dec->pending_output;
+
+	if (output == NULL)
+		return GST_FLOW_OK;
+
+	rs_fec_dec->pending_output = NULL;
+
+	GST_LOG_OBJECT(rs_fec_dec, "pushing collected output buffer with %" G_GSIZE_FORMAT " bytes", gst_buffer_get_size(output));
+
+	return gst_rs_fec_dec_push_output_buffer(rs_fec_dec, output);
+}
+
+
+static GstFlowReturn gst_rs_fec_dec_push_output_buffer(GstRSFECDec *rs_fec_dec, GstBuffer *buffer)
+{
+	GstFlowReturn ret;
+	gboolean paced_output;
+	GstClockTime spacing = GST_CLOCK_TIME_NONE;
+
+	GST_OBJECT_LOCK(rs_fec_dec);
+	paced_output = rs_fec_dec->paced_output;
+	GST_OBJECT_UNLOCK(rs_fec_dec);
+
+	if (paced_output)
+	{
+		GstClockTime pts = GST_BUFFER_PTS(buffer);
+
+		/* Transmitted timestamps give the exact original spacing. PTS
+		 * jumps (and arrival time stamps, which are bunched up after a
+		 * recovery) are not usable; fall back to the average interval
+		 * between source packets then. */
+		if (rs_fec_dec->do_timestamp && !(rs_fec_dec->restore_timestamps || rs_fec_dec->caps_timestamped))
+			pts = GST_CLOCK_TIME_NONE;
+
+		if (GST_CLOCK_TIME_IS_VALID(pts) && GST_CLOCK_TIME_IS_VALID(rs_fec_dec->last_output_pts) && (pts >= rs_fec_dec->last_output_pts) && ((pts - rs_fec_dec->last_output_pts) <= MAX_SOURCE_PACKET_INTERVAL))
+			spacing = pts - rs_fec_dec->last_output_pts;
+		else if (GST_CLOCK_TIME_IS_VALID(rs_fec_dec->source_packet_interval))
+			spacing = rs_fec_dec->source_packet_interval;
+		else
+			spacing = 0;
+
+		rs_fec_dec->last_output_pts = pts;
+	}
+
+	/* Without pacing, push directly, unless the output task is
+	 * running already, in which case the buffer must queue up
+	 * behind the ones that are still waiting */
+	g_mutex_lock(&(rs_fec_dec->output_mutex));
+	if (!paced_output && !(rs_fec_dec->output_task_started))
+	{
+		g_mutex_unlock(&(rs_fec_dec->output_mutex));
+		return gst_pad_push(rs_fec_dec->srcpad, buffer);
+	}
+	g_mutex_unlock(&(rs_fec_dec->output_mutex));
+
+	if (!gst_rs_fec_dec_queue_output_item(rs_fec_dec, buffer, NULL, spacing))
+		return GST_FLOW_FLUSHING;
+
+	g_mutex_lock(&(rs_fec_dec->output_mutex));
+	ret = rs_fec_dec->output_flow_return;
+	g_mutex_unlock(&(rs_fec_dec->output_mutex));
+
+	return ret;
+}
+
+
+static void gst_rs_fec_dec_push_output_event(GstRSFECDec *rs_fec_dec, GstEvent *event)
+{
+	gboolean task_started;
+
+	g_mutex_lock(&(rs_fec_dec->output_mutex));
+	task_started = rs_fec_dec->output_task_started;
+	g_mutex_unlock(&(rs_fec_dec->output_mutex));
+
+	/* Serialized events must not overtake the queued buffers */
+	if (task_started)
+		gst_rs_fec_dec_queue_output_item(rs_fec_dec, NULL, event, GST_CLOCK_TIME_NONE);
+	else
+		gst_pad_push_event(rs_fec_dec->srcpad, event);
+}
+
+
+static gboolean gst_rs_fec_dec_queue_output_item(GstRSFECDec *rs_fec_dec, GstBuffer *buffer, GstEvent *event, GstClockTime spacing)
+{
+	GstRSFECDecOutputItem *item;
+	GstClockTime send_time = GST_CLOCK_TIME_NONE;
+
+	g_mutex_lock(&(rs_fec_dec->output_mutex));
+
+	if (rs_fec_dec->output_flushing)
+	{
+		g_mutex_unlock(&(rs_fec_dec->output_mutex));
+		GST_DEBUG_OBJECT(rs_fec_dec, "output is flushing - dropping %s", (buffer != NULL) ? "buffer" : "event");
+		if (buffer != NULL)
+			gst_buffer_unref(buffer);
+		else
+			gst_event_unref(event);
+		return FALSE;
+	}
+
+	/* The buffer is sent one spacing after the previous one. If the
+	 * schedule fell behind (after a pause, or because the previous
+	 * buffers came late), it is sent right away, and the schedule
+	 * continues from there. Send times never go backwards, and
+	 * buffers are never held back longer than PACED_OUTPUT_MAX_DELAY,
+	 * so the queue cannot grow without bounds. */
+	if (GST_CLOCK_TIME_IS_VALID(spacing))
+	{
+		GstClockTime now = gst_clock_get_time(rs_fec_dec->system_clock);
+
+		send_time = GST_CLOCK_TIME_IS_VALID(rs_fec_dec->last_output_send_time) ? (rs_fec_dec->last_output_send_time + spacing) : now;
+		if (send_time < now)
+			send_time = now;
+		else if (send_time > (now + PACED_OUTPUT_MAX_DELAY))
+			send_time = now + PACED_OUTPUT_MAX_DELAY;
+		rs_fec_dec->last_output_send_time = send_time;
+	}
+
+	item = g_slice_new(GstRSFECDecOutputItem);
+	item->buffer = buffer;
+	item->event = event;
+	item->send_time = send_time;
+	g_queue_push_tail(&(rs_fec_dec->output_queue), item);
+
+	if (!(rs_fec_dec->output_task_started))
+	{
+		GST_DEBUG_OBJECT(rs_fec_dec, "starting output task");
+		rs_fec_dec->output_task_started = TRUE;
+		gst_pad_start_task(rs_fec_dec->srcpad, gst_rs_fec_dec_output_loop, rs_fec_dec, NULL);
+	}
+
+	g_cond_signal(&(rs_fec_dec->output_cond));
+	g_mutex_unlock(&(rs_fec_dec->output_mutex));
+
+	return TRUE;
+}
+
+
+static void gst_rs_fec_dec_output_loop(gpointer user_data)
+{
+	GstRSFECDec *rs_fec_dec = GST_RS_FEC_DEC(user_data);
+	GstRSFECDecOutputItem *item;
+	GstFlowReturn ret = GST_FLOW_OK;
+
+	g_mutex_lock(&(rs_fec_dec->output_mutex));
+
+	while (g_queue_is_empty(&(rs_fec_dec->output_queue)) && !(rs_fec_dec->output_flushing))
+		g_cond_wait(&(rs_fec_dec->output_cond), &(rs_fec_dec->output_mutex));
+
+	if (rs_fec_dec->output_flushing)
+	{
+		g_mutex_unlock(&(rs_fec_dec->output_mutex));
+		GST_DEBUG_OBJECT(rs_fec_dec, "pausing output task, since it is flushing");
+		gst_pad_pause_task(rs_fec_dec->srcpad);
+		return;
+	}
+
+	/* Wait until the next item is due. The queue is checked again
+	 * afterwards (in the next iteration), since it may have been
+	 * flushed in the meantime. */
+	item = g_queue_peek_head(&(rs_fec_dec->output_queue));
+	if (GST_CLOCK_TIME_IS_VALID(item->send_time) && (gst_clock_get_time(rs_fec_dec->system_clock) < item->send_time))
+	{
+		GstClockID clock_id = gst_clock_new_single_shot_id(rs_fec_dec->system_clock, item->send_time);
+
+		rs_fec_dec->output_clock_id = clock_id;
+		g_mutex_unlock(&(rs_fec_dec->output_mutex));
+
+		gst_clock_id_wait(clock_id, NULL);
+
+		g_mutex_lock(&(rs_fec_dec->output_mutex));
+		rs_fec_dec->output_clock_id = NULL;
+		g_mutex_unlock(&(rs_fec_dec->output_mutex));
+
+		gst_clock_id_unref(clock_id);
+		return;
+	}
+
+	g_queue_pop_head(&(rs_fec_dec->output_queue));
+	g_mutex_unlock(&(rs_fec_dec->output_mutex));
+
+	if (item->buffer != NULL)
+	{
+		ret = gst_pad_push(rs_fec_dec->srcpad, item->buffer);
+	}
+	else
+	{
+		gboolean is_eos = (GST_EVENT_TYPE(item->event) == GST_EVENT_EOS);
+		gst_pad_push_event(rs_fec_dec->srcpad, item->event);
+		if (is_eos)
+			ret = GST_FLOW_EOS;
+	}
+
+	g_slice_free(GstRSFECDecOutputItem, item);
+
+	if (ret != GST_FLOW_OK)
+	{
+		/* Report the error upstream with the next buffer,
+		 * unless the output is flushing anyway */
+		g_mutex_lock(&(rs_fec_dec->output_mutex));
+		if (!(rs_fec_dec->output_flushing))
+			rs_fec_dec->output_flow_return = ret;
+		g_mutex_unlock(&(rs_fec_dec->output_mutex));
+
+		GST_DEBUG_OBJECT(rs_fec_dec, "pausing output task, reason: %s", gst_flow_get_name(ret));
+		gst_pad_pause_task(rs_fec_dec->srcpad);
+	}
+}
+
+
+static void gst_rs_fec_dec_stop_output(GstRSFECDec *rs_fec_dec)
+{
+	/* Wake up the output task and make it pause. The caller then
+	 * pauses or stops the task, which waits until the task function
+	 * is done. Until gst_rs_fec_dec_reset_output() is called, nothing
+	 * can be queued anymore. */
+	g_mutex_lock(&(rs_fec_dec->output_mutex));
+	rs_fec_dec->output_flushing = TRUE;
+	rs_fec_dec->output_flow_return = GST_FLOW_FLUSHING;
+	rs_fec_dec->output_task_started = FALSE;
+	if (rs_fec_dec->output_clock_id != NULL)
+		gst_clock_id_unschedule(rs_fec_dec->output_clock_id);
+	g_cond_signal(&(rs_fec_dec->output_cond));
+	g_mutex_unlock(&(rs_fec_dec->output_mutex));
+}
+
+
+static void gst_rs_fec_dec_reset_output(GstRSFECDec *rs_fec_dec)
+{
+	GstRSFECDecOutputItem *item;
+
+	/* Discard whatever the task did not send, and allow queuing again.
+	 * The task is not running at this point (it is either paused or
+	 * stopped, or was never started). */
+	g_mutex_lock(&(rs_fec_dec->output_mutex));
+
+	while ((item = g_queue_pop_head(&(rs_fec_dec->output_queue))) != NULL)
+	{
+		if (item->buffer != NULL)
+			gst_buffer_unref(item->buffer);
+		else
+			gst_event_unref(item->event);
+		g_slice_free(GstRSFECDecOutputItem, item);
+	}
+
+	rs_fec_dec->last_output_send_time = GST_CLOCK_TIME_NONE;
+	rs_fec_dec->output_flushing = FALSE;
+	rs_fec_dec->output_flow_return = GST_FLOW_OK;
+
+	g_mutex_unlock(&(rs_fec_dec->output_mutex));
 }
 
 
@@ -1640,7 +3271,7 @@ static void gst_rs_fec_dec_push_stream_start(GstRSFECDec *rs_fec_dec)
 	GST_DEBUG_OBJECT(rs_fec_dec, "sending out stream-start event with ID %s", stream_id);
 
 	event = gst_event_new_stream_start(stream_id);
-	gst_pad_push_event(rs_fec_dec->srcpad, event);
+	gst_rs_fec_dec_push_output_event(rs_fec_dec, event);
 
 	rs_fec_dec->stream_started = TRUE;
 }
@@ -1660,7 +3291,7 @@ static void gst_rs_fec_dec_push_segment(GstRSFECDec *rs_fec_dec)
 	GST_DEBUG_OBJECT(rs_fec_dec, "sending out segment event");
 
 	event = gst_event_new_segment(&segment);
-	gst_pad_push_event(rs_fec_dec->srcpad, event);
+	gst_rs_fec_dec_push_output_event(rs_fec_dec, event);
 
 	rs_fec_dec->segment_started = TRUE;
 }
@@ -1672,10 +3303,10 @@ static void gst_rs_fec_dec_push_eos(GstRSFECDec *rs_fec_dec)
 	 * For example, if the fecsource sinkpad gets EOS, it may
 	 * still be possible for the fecrepair sinkpad to receive
 	 * enough repair symbols to recover some ADUs.
-	 * Exception: if num_repair_symbols is 0, then no repair
+	 * Exception: if max_repair_symbols is 0, then no repair
 	 * symbols are expected, so just look at fecsource_eos
 	 * in that case. */
-	if (rs_fec_dec->fecsource_eos && (rs_fec_dec->fecrepair_eos || (rs_fec_dec->num_repair_symbols == 0)))
+	if (rs_fec_dec->fecsource_eos && (rs_fec_dec->fecrepair_eos || (rs_fec_dec->max_repair_symbols == 0)))
 	{
 		GST_DEBUG_OBJECT(rs_fec_dec, "both sinkpads received EOS -> draining source block table and pushing EOS downstream");
 
@@ -1684,21 +3315,22 @@ static void gst_rs_fec_dec_push_eos(GstRSFECDec *rs_fec_dec)
 		gst_rs_fec_dec_push_segment(rs_fec_dec);
 
 		gst_rs_fec_dec_drain_source_block_table(rs_fec_dec);
+		gst_rs_fec_dec_push_pending_output(rs_fec_dec);
 
-		gst_pad_push_event(rs_fec_dec->srcpad, gst_event_new_eos());
+		gst_rs_fec_dec_push_output_event(rs_fec_dec, gst_event_new_eos());
 	}
 }
 
 
-static of_session_t* gst_rs_fec_dec_create_openfec_session(GstRSFECDec *rs_fec_dec, gsize encoding_symbol_length)
+static of_session_t* gst_rs_fec_dec_create_openfec_session(GstRSFECDec *rs_fec_dec, guint num_source_symbols, guint num_repair_symbols, gsize encoding_symbol_length)
 {
 	of_status_t status;
 	of_session_t *session;
 	of_rs_parameters_t params;
 
-	/* NOTE: This code (and in fact the entire element) assumes the number of
-	 * source and repair symbols per source block does not change during a
-	 * session. Also see the checks in set_property(). */
+	/* NOTE: Sessions are created for each source block, so blocks
+	 * with different numbers of source and repair symbols are
+	 * handled by simply passing the numbers of the block here. */
 
 	/* Create the session */
 	if ((status = of_create_codec_instance(&session, OF_CODEC_REED_SOLOMON_GF_2_8_STABLE, OF_DECODER, 0)) != OF_STATUS_OK)
@@ -1714,11 +3346,11 @@ static of_session_t* gst_rs_fec_dec_create_openfec_session(GstRSFECDec *rs_fec_d
 	 * allocate blocks */
 	of_set_callback_functions(session, gst_rs_fec_dec_openfec_source_symbol_cb, NULL, rs_fec_dec);
 
-	GST_LOG_OBJECT(rs_fec_dec, "configuring OpenFEC decoder session  (num source symbols: %u  num repair symbols: %u  encoding symbol length: %" G_GSIZE_FORMAT ")", rs_fec_dec->num_source_symbols, rs_fec_dec->num_repair_symbols, encoding_symbol_length);
+	GST_LOG_OBJECT(rs_fec_dec, "configuring OpenFEC decoder session  (num source symbols: %u  num repair symbols: %u  encoding symbol length: %" G_GSIZE_FORMAT ")", num_source_symbols, num_repair_symbols, encoding_symbol_length);
 
 	memset(&params, 0, sizeof(params));
-	params.nb_source_symbols = rs_fec_dec->num_source_symbols;
-	params.nb_repair_symbols = rs_fec_dec->num_repair_symbols;
+	params.nb_source_symbols = num_source_symbols;
+	params.nb_repair_symbols = num_repair_symbols;
 	params.encoding_symbol_length = encoding_symbol_length;
 
 	/* Instruct the OpenFEC session to (re)configure itself */
@@ -1730,38 +3362,33 @@ static of_session_t* gst_rs_fec_dec_create_openfec_session(GstRSFECDec *rs_fec_d
 		return NULL;
 	}
 
+	return session;
+}
+
+
+static void gst_rs_fec_dec_alloc_symbol_memblocks(GstRSFECDec *rs_fec_dec, gsize encoding_symbol_length)
+{
 	/* If the encoding_symbol_length changed since the last time,
-	 * the symbol memory blocks have to be reallocated.
-	 * NOTE: if this is the first time gst_rs_fec_dec_create_openfec_session()
+	 * the symbol memory blocks have to be reassigned.
+	 * NOTE: if this is the first time gst_rs_fec_dec_alloc_symbol_memblocks()
 	 * is called after allocating the encoding symbol tables, it must be
 	 * ensured that rs_fec_dec->encoding_symbol_length is 0, since in that
 	 * case, there won't be any symbol memory blocks present yet */
 	if (rs_fec_dec->encoding_symbol_length != encoding_symbol_length)
 	{
-		guint i;
-
-		GST_DEBUG_OBJECT(rs_fec_dec, "encoding symbol length changed from %" G_GSIZE_FORMAT " to %" G_GSIZE_FORMAT "; need to reallocate symbol memory blocks", rs_fec_dec->encoding_symbol_length, encoding_symbol_length);
+		GST_DEBUG_OBJECT(rs_fec_dec, "encoding symbol length changed from %" G_GSIZE_FORMAT " to %" G_GSIZE_FORMAT "; need to reassign symbol memory blocks", rs_fec_dec->encoding_symbol_length, encoding_symbol_length);
 
-		/* Deallocate any existing symbol memory blocks, but do NOT deallocate the
-		 * table itself (unlike in gst_rs_fec_dec_free_encoding_symbol_table() )
-		 * It is still needed */
-		if (rs_fec_dec->encoding_symbol_length != 0)
-		{
-			for (i = 0; i < rs_fec_dec->num_source_symbols; ++i)
-				g_slice_free1(rs_fec_dec->encoding_symbol_length, rs_fec_dec->allocated_encoding_symbol_table[i]);
-		}
-
-		/* Allocate a new set of memory blocks with the new encoding symbol length each.
-		 * Only the source symbols are allocated. The repair symbols do not need
-		 * allocation, since they can be read from the FEC repair packets directly. */
-		for (i = 0; i < rs_fec_dec->num_source_symbols; ++i)
-			rs_fec_dec->allocated_encoding_symbol_table[i] = g_slice_alloc(encoding_symbol_length);
+		/* Place the memory blocks for the new encoding symbol length in the
+		 * symbol arena. This only allocates memory if the current slab is
+		 * too small for them. Only the source symbols get memory blocks. The
+		 * repair symbols do not need any, since they can be read from the
+		 * FEC repair packets directly. */
+		if (gst_fec_symbol_arena_assign(&(rs_fec_dec->symbol_arena), rs_fec_dec->allocated_encoding_symbol_table, rs_fec_dec->max_source_symbols, encoding_symbol_length))
+			GST_DEBUG_OBJECT(rs_fec_dec, "allocated new %" G_GSIZE_FORMAT " byte slab for the source symbols", rs_fec_dec->symbol_arena.slab_size);
 
 		/* Set the new encoding symbol length */
 		rs_fec_dec->encoding_symbol_length = encoding_symbol_length;
 	}
-
-	return session;
 }
 
 
@@ -1788,3 +3415,31 @@ static gchar const * gst_rs_fec_dec_get_status_name(of_status_t status)
 		default: return "<unknown>";
 	}
 }
+
+
+static guint gst_rs_fec_dec_get_payload_id_m(GstRSFECDec *rs_fec_dec)
+{
+	return gst_rs_fec_code_construction_get_m(rs_fec_dec->code_construction);
+}
+
+
+static guint gst_rs_fec_dec_get_max_num_encoding_symbols(GstRSFECDec *rs_fec_dec)
+{
+	return gst_rs_fec_code_construction_get_max_num_encoding_symbols(rs_fec_dec->code_construction);
+}
+
+
+static gboolean gst_rs_fec_dec_check_settings(GstRSFECDec *rs_fec_dec)
+{
+	if (!gst_rs_fec_code_construction_check_num_symbols(rs_fec_dec->code_construction, rs_fec_dec->num_source_symbols, rs_fec_dec->num_repair_symbols))
+	{
+		GST_ELEMENT_ERROR(
+			rs_fec_dec, LIBRARY, SETTINGS,
+			("invalid number of encoding symbols for code construction"),
+			("code construction: %s  number of source symbols: %u  repair symbols: %u", gst_rs_fec_code_construction_get_name(rs_fec_dec->code_construction), rs_fec_dec->num_source_symbols, rs_fec_dec->num_repair_symbols)
+		);
+		return FALSE;
+	}
+
+	return TRUE;
+}
@@ -22,6 +22,8 @@
 
 #include <gst/gst.h>
 #include <of_openfec_api.h>
+#include "common/gstsymbolarena.h"
+#include "gstrsfeccommon.h"
 
 
 G_BEGIN_DECLS
@@ -29,16 +31,82 @@ G_BEGIN_DECLS
 
 typedef struct _GstRSFECDec GstRSFECDec;
 typedef struct _GstRSFECDecClass GstRSFECDecClass;
+typedef struct _GstRSFECDecSourceBlock GstRSFECDecSourceBlock;
 
 
 #define GST_TYPE_RS_FEC_DEC             (gst_rs_fec_dec_get_type())
 #define GST_RS_FEC_DEC(obj)             (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_RS_FEC_DEC, GstRSFECDec))
 #define GST_RS_FEC_DEC_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST((klass), GST_TYPE_RS_FEC_DEC, GstRSFECDecClass))
 #define GST_RS_FEC_DEC_CAST(obj)        ((GstRSFECDec *)(obj))
+#define GST_RS_FEC_DEC_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS((obj), GST_TYPE_RS_FEC_DEC, GstRSFECDecClass))
 #define GST_IS_RS_FEC_DEC(obj)          (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_RS_FEC_DEC))
 #define GST_IS_RS_FEC_DEC_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass), GST_TYPE_RS_FEC_DEC))
 
 
+struct _GstRSFECDecSourceBlock
+{
+	/* Number of this source block */
+	guint block_nr;
+
+	/* Bitmask for identifying which packets are present.
+	 * 1 = FEC source/repair packet present. 0 = missing.
+	 * The bit number corresponds to the ESI of the packet.
+	 * With Reed-Solomon, up to 2^m - 1 encoding symbols can be
+	 * used, so this can be up to 1024 64-bit integers long with
+	 * m=16. It is therefore allocated with as many integers as
+	 * needed for num_mask_symbols bits. */
+	guint64 *packet_mask;
+	/* Number of bits in packet_mask. This is the sum of the
+	 * block's k and n-k, and is grown if n-k grows. */
+	guint num_mask_symbols;
+
+	/* Lists containing received source and repair packets.
+	 * the entries are _not_ ordered according to the packet ESIs,
+	 * since ordering is done implicitely later during the
+	 * source block processing. */
+	GSList *source_packets, *repair_packets;
+	/* How many source and repair packets are currently contained
+	 * in the lists. */
+	guint num_source_packets, num_repair_packets;
+	/* FEC repair packets that arrived before the block's k was known
+	 * (see num_code_source_symbols). They are inserted once the first
+	 * FEC source packet of the block arrives. */
+	GSList *pending_repair_packets;
+
+	/* Number of source and repair symbols (k and n-k) of the code
+	 * the encoder used for this block (see GstRSFECDec for how they
+	 * are determined). k is 0 if the block was created by a FEC
+	 * repair packet and its k is not known yet. In that case, the
+	 * packet_mask and output_adu_table are not allocated yet. */
+	guint num_code_source_symbols, num_code_repair_symbols;
+
+	/* Number of source symbols in this block. This is normally
+	 * num_code_source_symbols, but is less if the encoder closed
+	 * the block early and shortened it. The missing source symbols
+	 * (with ESIs from this value up to num_code_source_symbols-1)
+	 * are then all-zero symbols, which are added as empty FEC source
+	 * packets once a repair packet announces the shortened length. */
+	guint num_source_symbols;
+
+	/* Table holding the GstBuffers of the ADUs that will be
+	 * pushed downstream when this source block is pruned. It
+	 * has num_code_source_symbols entries. */
+	GstBuffer **output_adu_table;
+
+	/* If TRUE, then this source block has been processed,
+	 * all lost ADUs have been recovered and are placed in the
+	 * output_adu_table, and it is considered a "complete" source
+	 * block. A source block which does not have all of its ADUs
+	 * in the output_adu_table yet is considered incomplete. */
+	gboolean is_complete;
+
+	/* Per-block state of the FEC scheme's decoder. Not used by
+	 * Reed-Solomon. Released by the free_source_block_data()
+	 * class function. */
+	gpointer scheme_data;
+};
+
+
 struct _GstRSFECDec
 {
 	GstElement parent;
@@ -49,10 +117,39 @@ struct _GstRSFECDec
 	GstPad *srcpad, *fecsourcepad, *fecrepairpad;
 	/* Number of source and repair symbols, configured via properties.
 	 * These may only be modified if no decoding session is currently
-	 * running (that is, if allocated_encoding_symbol_table == NULL). */
+	 * running (that is, if allocated_encoding_symbol_table == NULL).
+	 * If the class supports it (see supports_num_symbols_changes), the
+	 * decoder configures itself from the packets instead, and each
+	 * source block gets its own numbers (see GstRSFECDecSourceBlock):
+	 * k is taken from the source block length field of the FEC payload
+	 * ID of the source packets. For repair packets, which only carry the
+	 * shortened block length there, k comes from the caps, or else from
+	 * the source packets of the same block. n-k comes from the caps of
+	 * the pad the packet came from. If the caps do not contain it,
+	 * num_repair_symbols is used, and with code constructions whose
+	 * repair symbols do not depend on n, n-k is raised for blocks with
+	 * repair packets whose ESIs are beyond that. */
 	guint num_source_symbols, num_repair_symbols;
 	/* Sum of num_source_symbols and num_repair_symbols */
 	guint num_encoding_symbols;
+	/* Numbers of source and repair symbols that the tables are allocated
+	 * for. 0 means num_source_symbols/num_repair_symbols. Like those,
+	 * these can only be set if allocated_encoding_symbol_table is NULL,
+	 * and they are raised to the configured number of symbols during the
+	 * NULL->READY state change. If the class supports changes, they grow
+	 * whenever a source block with larger numbers shows up. Protected by
+	 * the object lock. */
+	guint max_source_symbols, max_repair_symbols;
+	/* Numbers of source and repair symbols from the most recent caps of
+	 * the fecsource and fecrepair pads. The numbers of source symbols
+	 * are 0 if the caps did not contain them. Protected by the mutex. */
+	guint fecsource_num_source_symbols, fecsource_num_repair_symbols;
+	guint fecrepair_num_source_symbols, fecrepair_num_repair_symbols;
+	/* Code construction the encoder used for generating the repair
+	 * symbols. Like the symbol counts, this may only be modified if
+	 * no decoding session is currently running. Incoming caps with
+	 * a different construction are refused. */
+	GstRSFECCodeConstruction code_construction;
 
 	/* How old a source block nr can maximally be. "Old" in this context
 	 * refers to the distance between the reference block nr (which is
@@ -77,6 +174,48 @@ struct _GstRSFECDec
 	 * can sort on its own. */
 	gboolean sort_output;
 
+	/* If reassemble_fragments is TRUE (set via property), or if the
+	 * caps of the fecsource pad contain "fragmented=true" (stored in
+	 * caps_fragmented), outgoing ADUs are fragments of larger ADUs (see
+	 * GST_RS_FEC_FRAGMENTED_CAPS_FIELD), and are reassembled before they
+	 * are pushed downstream. partial_adu holds the fragments of the ADU
+	 * with number partial_adu_nr received so far, and next_fragment_index
+	 * is the index of the fragment that has to come next. If a fragment
+	 * is missing, the partial ADU is discarded. This requires sorted
+	 * output. partial_adu is discarded after a flush, and when switching
+	 * back state from PAUSED to READY. */
+	gboolean reassemble_fragments;
+	gboolean caps_fragmented;
+	GstBuffer *partial_adu;
+	guint partial_adu_nr;
+	guint next_fragment_index;
+
+	/* If unpack_adus is TRUE (set via property), or if the caps of the
+	 * fecsource pad contain "packed=true" (stored in caps_packed), the
+	 * ADUs are packs of several ADUs (see GST_RS_FEC_PACKED_CAPS_FIELD),
+	 * which are unpacked before they are pushed downstream (and before
+	 * fragments are reassembled). */
+	gboolean unpack_adus;
+	gboolean caps_packed;
+
+	/* If restore_timestamps is TRUE (set via property), or if the caps
+	 * of the fecsource pad contain "timestamped=true" (stored in
+	 * caps_timestamped), the ADUs start with a timestamp header (see
+	 * GST_RS_FEC_TIMESTAMPED_CAPS_FIELD), which is stripped after
+	 * unpacking and reassembling. The PTS and duration from the header
+	 * are then used instead of do_timestamp's arrival time. */
+	gboolean restore_timestamps;
+	gboolean caps_timestamped;
+
+	/* If output_buffer_size is nonzero (set via property), outgoing ADUs
+	 * are collected in pending_output, and pushed downstream as one buffer
+	 * once it holds at least output_buffer_size bytes. This is meant for
+	 * byte streams which the encoder sliced into small ADUs. The collected
+	 * ADUs are pushed at EOS, and discarded after a flush and when switching
+	 * back state from PAUSED to READY. */
+	guint output_buffer_size;
+	GstBuffer *pending_output;
+
 	/* TRUE if no ADU has been pushed downstream yet.
 	 * This is set to FALSE at startup, after a flush, and when switching
 	 * back state from PAUSED to READY. */
@@ -88,9 +227,11 @@ struct _GstRSFECDec
 
 	/* Tables containing encoding symbols.
 	 *
-	 * All of these tables are num_encoding_symbols long. They
-	 * are (re)allocated when the decoder is reconfigured
-	 * (= when the encoding symbol length changes).
+	 * All of these tables are max_source_symbols + max_repair_symbols
+	 * long, and are reallocated when max_source_symbols or
+	 * max_repair_symbols grow. The memory blocks of the source
+	 * symbols are located in symbol_arena, and are reassigned when
+	 * the encoding symbol length changes.
 	 * The array index equals the ESI of the corresponding symbol.
 	 * Allocated_encoding_symbol_table contains pointers to all
 	 * allocated source symbol memory blocks. (Repair symbols
@@ -123,11 +264,20 @@ struct _GstRSFECDec
 	void **received_encoding_symbol_table;
 	void **recovered_encoding_symbol_table;
 
+	/* Slab for the source symbol memory blocks. It is only replaced if
+	 * the source symbols do not fit into it anymore. If max_symbol_length
+	 * is nonzero (set via property), the slab is made large enough for
+	 * symbols of that length when the tables are allocated. Like the
+	 * number of symbols, max_symbol_length can only be modified if
+	 * allocated_encoding_symbol_table is NULL. */
+	GstFECSymbolArena symbol_arena;
+	guint max_symbol_length;
+
 	/* Table containing MapInfo instances. Used while a source
 	 * block is processed, when the FEC repair packets are mapped
 	 * in order for OpenFEC to read the repair symbols. Unlike
 	 * the other tables, the indices here do _not_ correspond to
-	 * ESIs. */
+	 * ESIs. It has max_repair_symbols entries. */
 	GstMapInfo *fec_repair_packet_mapinfos;
 
 	/* Hash table containing all of the incomplete source blocks.
@@ -177,12 +327,116 @@ struct _GstRSFECDec
 	 * These are set to FALSE at startup, after a flush, and when switching
 	 * back state from PAUSED to READY. */
 	gboolean fecsource_eos, fecrepair_eos;
+
+	/* Loss report state. If loss_report_interval is nonzero, a loss report
+	 * (see GST_FEC_LOSS_REPORT_STRUCTURE_NAME) is sent upstream and posted
+	 * on the bus after that many source blocks were destroyed. The counters
+	 * cover the source blocks since the last report, and are updated when
+	 * a source block is destroyed. They are reset after a flush, and when
+	 * switching back state from PAUSED to READY. */
+	guint loss_report_interval;
+	guint num_report_blocks;
+	guint num_report_lost_source_symbols;
+	guint num_report_source_symbols;
+
+	/* Latency estimate. A source packet may have to wait until its
+	 * block is complete, or until the block is pruned, which happens
+	 * once max_source_block_age newer blocks arrived. That is up to
+	 * (max_source_block_age + 1) * k source packets. The interval
+	 * between source packets is measured (with the monotonic system
+	 * clock) and averaged in source_packet_interval.
+	 * last_source_packet_time is the arrival time of the previous
+	 * source packet, and GST_CLOCK_TIME_NONE after a flush.
+	 * reported_latency is the estimate that was last announced with
+	 * a latency message, and is used for answering latency queries.
+	 * Protected by the mutex. */
+	GstClockTime last_source_packet_time;
+	GstClockTime source_packet_interval;
+	GstClockTime reported_latency;
+
+	/* If paced_output is TRUE, outgoing buffers are not pushed in bursts
+	 * (like the ADUs of a block that was just recovered), but spread out
+	 * according to their original spacing: the PTS difference to the
+	 * previous buffer if both have a PTS (with transmitted timestamps),
+	 * otherwise source_packet_interval. last_output_pts is the PTS of the
+	 * previous buffer (protected by the mutex). Like with the encoder's
+	 * repair pacing, the buffers are put into output_queue along with
+	 * their send time (system clock time), and pushed by a task on the
+	 * srcpad. Once the task is started, all buffers and serialized events
+	 * go through the queue, to keep their order. last_output_send_time is
+	 * the send time of the last queued buffer; send times never go
+	 * backwards, and never lie more than PACED_OUTPUT_MAX_DELAY in the
+	 * future. The queue, the task state, last_output_send_time, and
+	 * output_clock_id (the clock entry the task waits on) are protected
+	 * by output_mutex. If output_flushing is TRUE, the task is shutting
+	 * down, and nothing is queued anymore. output_flow_return is the
+	 * result of the task's last push, which is returned to upstream.
+	 * paced_output can be modified at any time (protected by the
+	 * object lock). */
+	gboolean paced_output;
+	GstClock *system_clock;
+	GstClockTime last_output_pts;
+	GstClockTime last_output_send_time;
+	GQueue output_queue;
+	GMutex output_mutex;
+	GCond output_cond;
+	GstClockID output_clock_id;
+	gboolean output_task_started;
+	gboolean output_flushing;
+	GstFlowReturn output_flow_return;
 };
 
 
 struct _GstRSFECDecClass
 {
 	GstElementClass parent_class;
+
+	/* TRUE if source blocks with different numbers of source and repair
+	 * symbols can be decoded (see num_source_symbols in GstRSFECDec). If
+	 * FALSE, the num_source_symbols and num_repair_symbols properties are
+	 * used for all blocks. */
+	gboolean supports_num_symbols_changes;
+
+	/* The functions below cover everything that depends on the FEC scheme.
+	 * The class installs the Reed-Solomon versions. Elements for other FEC
+	 * schemes (like ldpcfecdec) derive from GstRSFECDec and override them;
+	 * the FEC payload ID parsing, the source block table, pruning, and the
+	 * ADU output are then shared. Except for get_max_num_encoding_symbols(),
+	 * check_settings() and check_caps(), these are called with the decoder
+	 * mutex locked. */
+
+	/* Returns the m value that determines the FEC payload ID layout
+	 * (see gst_rs_fec_read_payload_id() ) */
+	guint (*get_payload_id_m)(GstRSFECDec *rs_fec_dec);
+	/* Returns the maximum allowed value for num_encoding_symbols. Called
+	 * with the object lock held. */
+	guint (*get_max_num_encoding_symbols)(GstRSFECDec *rs_fec_dec);
+	/* Returns FALSE (and posts an error message) if the scheme cannot be
+	 * used with the currently configured properties. Called during the
+	 * NULL->READY state change. */
+	gboolean (*check_settings)(GstRSFECDec *rs_fec_dec);
+	/* Returns FALSE if the caps of one of the sinkpads are incompatible
+	 * with the configuration of the decoder */
+	gboolean (*check_caps)(GstRSFECDec *rs_fec_dec, GstCaps *caps);
+
+	/* Called after a new FEC packet was added to an incomplete source
+	 * block. Schemes that decode incrementally feed the symbol to their
+	 * decoder here. Returns FALSE in case of an error. Optional. */
+	gboolean (*add_fec_packet)(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block, GstBuffer *fec_packet, guint esi, gboolean is_source_packet);
+	/* Returns TRUE if enough encoding symbols are present for recovering
+	 * the missing source symbols of the block */
+	gboolean (*can_process_source_block)(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block);
+	/* Recovers the missing source symbols. Afterwards, each entry of the
+	 * recovered_encoding_symbol_table that belongs to a missing source
+	 * symbol points to the recovered symbol, and the other entries are
+	 * NULL. Only called if at least one repair packet is present. */
+	gboolean (*recover_source_symbols)(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block);
+	/* Called for incomplete blocks right before they are pruned or
+	 * drained, as a last attempt at recovering their missing symbols.
+	 * Returns TRUE if the block can be processed now. Optional. */
+	gboolean (*finish_source_block)(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block);
+	/* Releases the scheme_data of a source block. Optional. */
+	void (*free_source_block_data)(GstRSFECDec *rs_fec_dec, GstRSFECDecSourceBlock *source_block);
 };
 
 
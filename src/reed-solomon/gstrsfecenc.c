@@ -47,24 +47,190 @@
  * turning them into FEC repair packets. These packets are then pushed
  * downstream to the fecrepair pad.
  *
+ * If the "code-construction" property is set to "cauchy", repair symbols are
+ * generated with a Cauchy matrix by an in-plugin encoder (see gstrscauchy.h)
+ * instead of OpenFEC's RFC 6865 Vandermonde matrix. With "parity-cauchy",
+ * the first repair symbol (ESI k) is the XOR parity of the source symbols,
+ * and the others are generated with a column-scaled Cauchy matrix. With
+ * "gf16-fft", a GF(2^16) Reed-Solomon code is used, which is encoded and
+ * decoded with an additive FFT in O(n log n) time. This allows for source
+ * blocks with thousands of symbols. None of these constructions use
+ * OpenFEC, so no OpenFEC session is created for them. The resulting stream
+ * can only be decoded by rsfecdec elements that use the same construction.
+ * The construction is signalled in the "code-construction" caps field of
+ * both source pads.
+ *
+ * Normally, all ADUs of a source block are pushed, followed by the block's
+ * repair packets, so a short outage can wipe out an entire block. If the
+ * "interleave-depth" property is set to a value D > 1, D source blocks (an
+ * "interleaving group") are filled at the same time instead: consecutive ADUs
+ * are assigned round-robin to the blocks, so the first ADU of the group gets
+ * ESI 0 in the first block, the second one ESI 0 in the second block etc. Once
+ * the group is complete, the repair packets of its blocks are interleaved the
+ * same way. A burst of up to D lost packets then costs each block at most one
+ * symbol. All blocks of a group use the same encoding symbol length. The
+ * decoder handles the concurrent blocks like reordered ones; its
+ * "max-source-block-age" property must be at least D.
+ *
+ * Since a source block is only complete after k ADUs, a pausing source can
+ * leave the last ADUs without repair packets for an arbitrarily long time. To
+ * bound this, the "max-block-duration" property can be set. If the current
+ * source block (or interleaving group) is still incomplete once that much time
+ * passed since its first ADU arrived, it is closed early. Partial blocks are
+ * also closed when a GAP event arrives, and at EOS, instead of being discarded.
+ * A block that is closed early with k' < k ADUs is encoded as a "shortened"
+ * code: the ADUIs with the ESIs k'..k-1 are treated as all-zero symbols that
+ * are never transmitted. The repair packets of such a block carry k' in the
+ * source block length field of their FEC payload ID, which tells the decoder
+ * to insert the zero symbols itself. (Source packets always carry k, since the
+ * final length of their block is not known when they are sent.) All supported
+ * codes are linear and systematic, so this works with every code construction
+ * and FEC scheme. The max-block-duration timer runs on the system clock.
+ *
+ * For video, a lost packet usually makes its entire frame undecodable, and a
+ * source block that straddles two frames delays the recovery of the first one
+ * until packets of the next one arrived. With the "frame-boundary" property,
+ * blocks can instead be closed at frame boundaries, which are detected from
+ * the MARKER flag (set on the last ADU of a frame), the DELTA_UNIT flag (unset
+ * on the first ADU of a keyframe) or PTS changes. A block is only closed at a
+ * boundary if it contains at least "min-source-symbols" ADUs, so block sizes
+ * vary between min-source-symbols and k. Blocks closed this way are shortened
+ * blocks, as described above, so the decoder learns their actual size from
+ * the repair packets.
+ *
+ * Not all ADUs are equally important; a lost keyframe or parameter set costs
+ * far more than a lost B-frame. If the "uep" property is set to TRUE, the
+ * number of repair symbols is chosen per source block, based on the flags of
+ * its ADUs (unequal error protection). Blocks with an ADU that is not a delta
+ * unit or that is a header get num-repair-symbols repair symbols, blocks with
+ * only droppable ADUs get "droppable-repair-symbols", and all other blocks get
+ * "delta-repair-symbols". With "repair-overhead-budget", the average repair
+ * overhead can be limited to a percentage of the source symbols; high priority
+ * blocks then get precedence. The decoder needs no extra configuration, since
+ * the ESIs of the repair symbols that are sent remain the same.
+ *
+ * On clean links, most repair symbols are never needed. If "adaptive-repair"
+ * is set to TRUE, the number of repair symbols per block follows the loss
+ * rate instead: each block gets "min-repair-symbols" repair symbols, plus
+ * twice the number of expected losses, up to num-repair-symbols. The loss
+ * rate is taken from loss reports, which rsfecdec sends as upstream custom
+ * events (see its "loss-report-interval" property), or which an application
+ * can pass in by setting the "loss-rate" property. Increases of the loss
+ * rate take effect immediately, decreases are smoothed. Repair symbols that
+ * are not sent are not computed either.
+ *
+ * The repair overhead normally depends on the ADU sizes, which makes it hard
+ * to fit into a fixed bandwidth budget. With the "max-repair-bitrate"
+ * property, the FEC repair flow is limited to a bitrate instead. The repair
+ * packets (encoding symbol length + 6 bytes each) are paid for from a token
+ * bucket that is filled at that rate, and each block only gets as many repair
+ * symbols as the bucket can currently pay for, on top of the limits above.
+ * The bucket holds the budget of 500 ms (at least the repair packets of one
+ * block), and runs on the system clock. The read-only
+ * "repair-budget-utilization" property tells how much of the budget was used.
+ *
+ * By default, the repair packets of a block are pushed in one burst once the
+ * block is complete. Such micro-bursts can overflow switch buffers and shallow
+ * Wi-Fi queues, causing the very losses FEC is supposed to repair. If the
+ * "repair-pacing" property is set to TRUE, the repair packets are spread
+ * evenly over the expected duration of the next block instead (estimated from
+ * the time it took to fill the current one). With "repair-delay", the repair
+ * packets of each block are sent that much later, so that an outage does not
+ * hit the source packets and the repair packets of a block at the same time.
+ * In both cases, the repair packets are pushed from a separate task on the
+ * fecrepair pad, which waits on the system clock.
+ *
+ * The "num-source-symbols" and "num-repair-symbols" properties can also be
+ * changed while the element is running, to adjust the protection of a live
+ * stream. The new values take effect at the start of the next source block
+ * (or interleaving group). All tables are allocated for the largest values
+ * that may be used, which are set with the "max-source-symbols" and
+ * "max-repair-symbols" properties (by default, the initial values are the
+ * largest ones). The decoder learns k from the source block length field of
+ * the FEC payload IDs of the source packets. The new values are additionally
+ * sent in the "num-source-symbols" and "num-repair-symbols" fields of new
+ * caps on both source pads, since repair packets only carry the shortened
+ * block length, and the gf16-fft construction needs n for decoding. Subclasses
+ * for other FEC schemes may not support such changes (see
+ * supports_num_symbols_changes in the class structure).
+ *
  * If num_repair_symbols is set to 0, the element behaves as usual, except
  * that it does not build any repair symbols, and therefore does not push
  * any FEC repair packets downstream.
  *
- * IMPORTANT: ADUs must not be larger than 65535 bytes, since the length value
- * in ADUIs are 16-bit unsigned integers, as specified in the RFC. This element
- * does not do any ADU splitting; upstream must take care of that.
+ * Large ADUs make for large encoding symbols, and therefore for repair packets
+ * that exceed the MTU and get IP fragmented; losing one IP fragment then loses
+ * the entire repair packet. If the "max-fragment-size" property is nonzero, ADUs
+ * are split into fragments of at most that many bytes, and each fragment is
+ * sent as a separate source symbol, prepended with a 4 byte fragment header
+ * (ADU number, fragment index, last fragment flag; see gstrsfeccommon.h). The
+ * fragments refer to the memory of the input buffer, so no ADU bytes are
+ * copied. The caps of both source pads then contain "fragmented=true", which
+ * tells the decoder to reassemble the ADUs. The first fragment carries the
+ * timestamps of the ADU, and all fragments carry its flags.
+ *
+ * The opposite problem exists with flows of small ADUs (audio, telemetry):
+ * each ADU costs a 3 byte ADUI header, a 6 byte FEC payload ID and a packet of
+ * its own. If the "pack-size" property is nonzero, consecutive ADUs are packed
+ * into one source symbol of up to pack-size bytes instead, each prepended with
+ * its 16-bit length. ADUs that do not fit into a pack with others are sent in
+ * a pack of their own. A pack is handed over to the source block once the next
+ * ADU does not fit into it anymore, at frame boundaries (packs never straddle
+ * frames), and when an incomplete source block is closed (so max-block-duration
+ * also limits the time an ADU waits in a pack). The pack carries the
+ * timestamps of its first ADU, and the combined flags of its ADUs. The caps
+ * then contain "packed=true". If fragmentation is enabled as well, the
+ * fragments are packed.
+ *
+ * All encoding symbols of a block are as long as its longest ADUI, so one large
+ * ADU in a block of small ones inflates every repair packet of the block. If
+ * the "max-padding-overhead" property is set to a percentage, the block (or
+ * interleaving group) is closed early, as a shortened block, if the next ADU
+ * would make the padding exceed that share of its source symbol bytes. That
+ * ADU then starts the next block. As with frame boundaries, blocks are only
+ * closed this way if they contain at least min-source-symbols ADUs. The
+ * read-only "padding-overhead" and "last-padding-overhead" properties tell how
+ * much of the source symbol bytes were padding (over the whole stream, and in
+ * the most recent block).
+ *
+ * For byte streams like MPEG-TS, the input buffer boundaries do not matter.
+ * If the "adu-size" property is nonzero, the input buffers are treated as a
+ * byte stream, and sliced into ADUs of exactly adu-size bytes (for example,
+ * 1316 bytes, which are 7 TS packets). The ADUs refer to the memory of the
+ * input buffers, so no bytes are copied. Bytes that do not fill an ADU are
+ * kept until the next input buffer arrives; at GAP and EOS events, they are
+ * sent as a shorter ADU. Since all other ADUs have the same size, there is
+ * no padding in the source symbols, and the encoding symbol length stays the
+ * same, so the FEC scheme does not have to be reconfigured.
+ *
+ * FEC source packets carry no timestamps, so by default, the decoder can only
+ * timestamp ADUs with their arrival time, which is off by the recovery delay
+ * for recovered ADUs. If the "transmit-timestamps" property is set to TRUE,
+ * each ADU is prepended with a 16 byte timestamp header, which carries its PTS
+ * (converted to running time) and its duration (see gstrsfeccommon.h). The
+ * header is added before fragmenting and packing, so it is protected like the
+ * ADU data, and packed ADUs keep their individual timestamps. The caps of both
+ * source pads then contain "timestamped=true", which tells the decoder to
+ * restore the timestamps.
+ *
+ * IMPORTANT: Unless max-fragment-size is set, ADUs must not be larger than
+ * 65535 bytes, since the length value in ADUIs are 16-bit unsigned integers,
+ * as specified in the RFC. With transmit-timestamps, this includes the
+ * timestamp header.
  */
 
 
-/* NOTE: Currently, only GF(2^8) Reed-Solomon is supported. RFC 6865 however also
- * mentions support for GF(2^m), where 2 <= m <= 16. OpenFEC currently does not support
- * GF(2^m) unless m is 4 or 8. Therefore, only GF(2^8) is supported in this element
- * for now. Once OpenFEC has been extended to support the necessary range for m,
- * reevaluate. */
+/* NOTE: RFC 6865 mentions support for GF(2^m), where 2 <= m <= 16. OpenFEC currently
+ * does not support GF(2^m) unless m is 4 or 8. Therefore, the OpenFEC based Vandermonde
+ * construction and the Cauchy constructions use GF(2^8). The "gf16-fft" construction
+ * uses GF(2^16) with an in-plugin codec, and the m=16 FEC payload ID layout (16-bit
+ * source block number, 16-bit ESI). It allows for up to 65535 encoding symbols. */
 
 
 #include <string.h>
+#include "common/gstgf256.h"
+#include "gstrscauchy.h"
+#include "gstrsfft.h"
 #include "gstrsfecenc.h"
 
 
@@ -75,12 +241,86 @@ enum
 {
 	PROP_0,
 	PROP_NUM_SOURCE_SYMBOLS,
-	PROP_NUM_REPAIR_SYMBOLS
+	PROP_NUM_REPAIR_SYMBOLS,
+	PROP_CODE_CONSTRUCTION,
+	PROP_INTERLEAVE_DEPTH,
+	PROP_MAX_BLOCK_DURATION,
+	PROP_FRAME_BOUNDARY,
+	PROP_MIN_SOURCE_SYMBOLS,
+	PROP_UEP,
+	PROP_DELTA_REPAIR_SYMBOLS,
+	PROP_DROPPABLE_REPAIR_SYMBOLS,
+	PROP_REPAIR_OVERHEAD_BUDGET,
+	PROP_ADAPTIVE_REPAIR,
+	PROP_MIN_REPAIR_SYMBOLS,
+	PROP_LOSS_RATE,
+	PROP_MAX_REPAIR_BITRATE,
+	PROP_REPAIR_BUDGET_UTILIZATION,
+	PROP_REPAIR_PACING,
+	PROP_REPAIR_DELAY,
+	PROP_MAX_SOURCE_SYMBOLS,
+	PROP_MAX_REPAIR_SYMBOLS,
+	PROP_MAX_FRAGMENT_SIZE,
+	PROP_PACK_SIZE,
+	PROP_MAX_PADDING_OVERHEAD,
+	PROP_PADDING_OVERHEAD,
+	PROP_LAST_PADDING_OVERHEAD,
+	PROP_ADU_SIZE,
+	PROP_MAX_SYMBOL_LENGTH,
+	PROP_TRANSMIT_TIMESTAMPS
 };
 
 
 #define DEFAULT_NUM_SOURCE_SYMBOLS 4
 #define DEFAULT_NUM_REPAIR_SYMBOLS 2
+#define DEFAULT_CODE_CONSTRUCTION GST_RS_FEC_CODE_CONSTRUCTION_VANDERMONDE
+#define DEFAULT_INTERLEAVE_DEPTH 1
+#define DEFAULT_MAX_BLOCK_DURATION 0
+#define DEFAULT_FRAME_BOUNDARY GST_RS_FEC_ENC_FRAME_BOUNDARY_NONE
+#define DEFAULT_MIN_SOURCE_SYMBOLS 1
+#define DEFAULT_UEP FALSE
+#define DEFAULT_DELTA_REPAIR_SYMBOLS 1
+#define DEFAULT_DROPPABLE_REPAIR_SYMBOLS 0
+#define DEFAULT_REPAIR_OVERHEAD_BUDGET 0
+#define DEFAULT_ADAPTIVE_REPAIR FALSE
+#define DEFAULT_MIN_REPAIR_SYMBOLS 1
+#define DEFAULT_LOSS_RATE 0.0
+#define DEFAULT_MAX_REPAIR_BITRATE 0
+#define DEFAULT_REPAIR_PACING FALSE
+#define DEFAULT_REPAIR_DELAY 0
+#define DEFAULT_MAX_SOURCE_SYMBOLS 0
+#define DEFAULT_MAX_REPAIR_SYMBOLS 0
+#define DEFAULT_MAX_FRAGMENT_SIZE 0
+#define DEFAULT_PACK_SIZE 0
+#define DEFAULT_MAX_PADDING_OVERHEAD 0
+#define DEFAULT_ADU_SIZE 0
+#define DEFAULT_MAX_SYMBOL_LENGTH 0
+#define DEFAULT_TRANSMIT_TIMESTAMPS FALSE
+
+/* With adaptive repair, this many repair symbols are sent
+ * per expected lost symbol, to cover variations in the loss
+ * rate from one block to the next */
+#define ADAPTIVE_REPAIR_SAFETY_FACTOR 2.0
+/* Weight of a new loss report if it reports a lower loss rate
+ * than the current estimate. Higher loss rates are adopted
+ * immediately. */
+#define LOSS_RATE_DECAY_WEIGHT 0.25
+
+/* With max-repair-bitrate, the token bucket can hold the budget of
+ * this much time. This allows for short bursts of repair packets
+ * (for example, for a high priority block with UEP) while keeping
+ * the average rate within the budget. */
+#define REPAIR_BUCKET_DURATION (500 * GST_MSECOND)
+
+/* The decoder considers block numbers that are more than half the
+ * number range apart as old, so the blocks of a group must stay well
+ * within that. With the 8-bit source block numbers of the m=24
+ * payload ID layout, this leaves room for 64 concurrent blocks. */
+#define MAX_INTERLEAVE_DEPTH 64
+
+/* If the block timeout fires while the streaming thread is busy,
+ * try again after this much time */
+#define BLOCK_TIMEOUT_RETRY_INTERVAL (10 * GST_MSECOND)
 
 
 #define FEC_SOURCE_CAPS_STR "application/x-fec-source-flow, encoding-id = (int) 8"
@@ -90,6 +330,19 @@ enum
 #define FEC_PAYLOAD_ID_LENGTH 6
 
 
+/* Entry in the repair output queue. Exactly one of buffer
+ * and event is non-NULL. */
+typedef struct
+{
+	GstBuffer *buffer;
+	GstEvent *event;
+	/* System clock time when the buffer shall be pushed,
+	 * or GST_CLOCK_TIME_NONE to push it right away */
+	GstClockTime send_time;
+}
+GstRSFECEncRepairOutputItem;
+
+
 #define CHECK_IF_FATAL_ERROR(elem, status) \
 	do { \
 		if ((status) == OF_STATUS_FATAL_ERROR) \
@@ -126,13 +379,49 @@ static GstStaticPadTemplate static_fecrepair_template = GST_STATIC_PAD_TEMPLATE(
 G_DEFINE_TYPE(GstRSFECEnc, gst_rs_fec_enc, GST_TYPE_ELEMENT)
 
 
+static GEnumValue const frame_boundary_values[] =
+{
+	{ GST_RS_FEC_ENC_FRAME_BOUNDARY_NONE, "Ignore frame boundaries", "none" },
+	{ GST_RS_FEC_ENC_FRAME_BOUNDARY_MARKER, "Frames end with an ADU that has the MARKER flag set", "marker" },
+	{ GST_RS_FEC_ENC_FRAME_BOUNDARY_KEYFRAME, "Frames start with an ADU that does not have the DELTA_UNIT flag set", "keyframe" },
+	{ GST_RS_FEC_ENC_FRAME_BOUNDARY_PTS, "Frames start with an ADU whose PTS differs from the previous one", "pts" },
+	{ 0, NULL, NULL }
+};
+
+
+GType gst_rs_fec_enc_frame_boundary_get_type(void)
+{
+	static volatile gsize frame_boundary_type = 0;
+
+	if (g_once_init_enter(&frame_boundary_type))
+	{
+		GType type = g_enum_register_static("GstRSFECEncFrameBoundary", frame_boundary_values);
+		g_once_init_leave(&frame_boundary_type, type);
+	}
+
+	return frame_boundary_type;
+}
+
+
+static void gst_rs_fec_enc_finalize(GObject *object);
 static void gst_rs_fec_enc_set_property(GObject *object, guint prop_id, GValue const *value, GParamSpec *pspec);
 static void gst_rs_fec_enc_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec);
 
 static GstStateChangeReturn gst_rs_fec_enc_change_state(GstElement *element, GstStateChange transition);
 
 static gboolean gst_rs_fec_enc_sink_event(GstPad *pad, GstObject *parent, GstEvent *event);
+static gboolean gst_rs_fec_enc_src_event(GstPad *pad, GstObject *parent, GstEvent *event);
+static gboolean gst_rs_fec_enc_src_query(GstPad *pad, GstObject *parent, GstQuery *query);
 static GstFlowReturn gst_rs_fec_enc_sink_chain(GstPad *pad, GstObject *parent, GstBuffer *buffer);
+static GstFlowReturn gst_rs_fec_enc_slice_byte_stream(GstRSFECEnc *rs_fec_enc, GstBuffer *buffer);
+static GstFlowReturn gst_rs_fec_enc_flush_pending_bytes(GstRSFECEnc *rs_fec_enc);
+static GstFlowReturn gst_rs_fec_enc_input_adu(GstRSFECEnc *rs_fec_enc, GstBuffer *buffer);
+static GstBuffer* gst_rs_fec_enc_add_timestamp_header(GstRSFECEnc *rs_fec_enc, GstBuffer *buffer);
+static GstFlowReturn gst_rs_fec_enc_fragment_adu(GstRSFECEnc *rs_fec_enc, GstBuffer *buffer);
+static GstFlowReturn gst_rs_fec_enc_add_adu(GstRSFECEnc *rs_fec_enc, GstBuffer *buffer, gboolean starts_adu, gboolean ends_adu);
+static GstFlowReturn gst_rs_fec_enc_pack_adu(GstRSFECEnc *rs_fec_enc, GstBuffer *buffer, gboolean starts_adu, gboolean ends_adu);
+static GstFlowReturn gst_rs_fec_enc_flush_pending_pack(GstRSFECEnc *rs_fec_enc);
+static GstFlowReturn gst_rs_fec_enc_handle_adu(GstRSFECEnc *rs_fec_enc, GstBuffer *buffer, gboolean starts_adu, gboolean ends_adu);
 
 static void gst_rs_fec_enc_alloc_encoding_symbol_table(GstRSFECEnc *rs_fec_enc);
 static void gst_rs_fec_enc_free_encoding_symbol_table(GstRSFECEnc *rs_fec_enc);
@@ -144,18 +433,48 @@ static void gst_rs_fec_enc_free_fec_repair_packet_table(GstRSFECEnc *rs_fec_enc)
 static gboolean gst_rs_fec_enc_init_openfec(GstRSFECEnc *rs_fec_enc);
 static gboolean gst_rs_fec_enc_shutdown_openfec(GstRSFECEnc *rs_fec_enc);
 static gboolean gst_rs_fec_enc_configure_fec(GstRSFECEnc *rs_fec_enc, gsize symbol_length);
+static void gst_rs_fec_enc_apply_num_symbols(GstRSFECEnc *rs_fec_enc);
 
-static void gst_rs_fec_enc_insert_adu(GstRSFECEnc *rs_fec_enc, GstBuffer *adu, guint esi);
-static GstFlowReturn gst_rs_fec_enc_push_adu(GstRSFECEnc *rs_fec_enc, GstBuffer *adu, guint esi);
+static void gst_rs_fec_enc_insert_adu(GstRSFECEnc *rs_fec_enc, GstBuffer *adu, guint index);
+static GstFlowReturn gst_rs_fec_enc_push_adu(GstRSFECEnc *rs_fec_enc, GstBuffer *adu, guint source_block_nr, guint esi);
 static void gst_rs_fec_enc_push_events(GstRSFECEnc *rs_fec_enc);
+static GstCaps* gst_rs_fec_enc_create_caps(GstRSFECEnc *rs_fec_enc, GstPad *pad);
+static void gst_rs_fec_enc_discard_pending_data(GstRSFECEnc *rs_fec_enc);
 static void gst_rs_fec_enc_flush_all_adus(GstRSFECEnc *rs_fec_enc);
 static void gst_rs_fec_enc_flush_all_fec_repair_packets(GstRSFECEnc *rs_fec_enc);
 static void gst_rs_fec_enc_free_payload_id(gpointer data);
-static GstFlowReturn gst_rs_fec_enc_process_source_block(GstRSFECEnc *rs_fec_enc);
+static GstFlowReturn gst_rs_fec_enc_process_source_block(GstRSFECEnc *rs_fec_enc, gboolean close_partial_block);
+static void gst_rs_fec_enc_start_block_timeout(GstRSFECEnc *rs_fec_enc);
+static void gst_rs_fec_enc_schedule_block_timeout(GstRSFECEnc *rs_fec_enc, GstClockTime timeout);
+static void gst_rs_fec_enc_cancel_block_timeout(GstRSFECEnc *rs_fec_enc);
+static gboolean gst_rs_fec_enc_block_timeout_cb(GstClock *clock, GstClockTime time, GstClockID id, gpointer user_data);
+static GstFlowReturn gst_rs_fec_enc_check_block_duration(GstRSFECEnc *rs_fec_enc);
+static GstFlowReturn gst_rs_fec_enc_close_incomplete_block(GstRSFECEnc *rs_fec_enc);
+static gboolean gst_rs_fec_enc_is_frame_boundary(GstRSFECEnc *rs_fec_enc, GstBuffer *adu, gboolean before_adu);
+static GstFlowReturn gst_rs_fec_enc_close_block_at_frame_boundary(GstRSFECEnc *rs_fec_enc);
+static gboolean gst_rs_fec_enc_exceeds_max_padding_overhead(GstRSFECEnc *rs_fec_enc, gsize adu_length);
+static void gst_rs_fec_enc_update_padding_stats(GstRSFECEnc *rs_fec_enc, gsize encoding_symbol_length);
+static guint gst_rs_fec_enc_select_num_repair_symbols(GstRSFECEnc *rs_fec_enc, GstBuffer **block_adus, guint num_block_adus, gsize encoding_symbol_length);
+static guint gst_rs_fec_enc_refill_repair_tokens(GstRSFECEnc *rs_fec_enc, guint max_repair_bitrate, gsize repair_packet_length);
+static void gst_rs_fec_enc_update_loss_rate(GstRSFECEnc *rs_fec_enc, gdouble reported_loss_rate);
+static void gst_rs_fec_enc_push_repair_event(GstRSFECEnc *rs_fec_enc, GstEvent *event);
+static gboolean gst_rs_fec_enc_queue_repair_output_item(GstRSFECEnc *rs_fec_enc, GstBuffer *buffer, GstEvent *event, GstClockTime send_time);
+static void gst_rs_fec_enc_repair_output_loop(gpointer user_data);
+static void gst_rs_fec_enc_stop_repair_output(GstRSFECEnc *rs_fec_enc);
+static void gst_rs_fec_enc_reset_repair_output(GstRSFECEnc *rs_fec_enc);
 static void gst_rs_fec_enc_reset_states(GstRSFECEnc *rs_fec_enc);
 static void gst_rs_fec_enc_flush(GstRSFECEnc *rs_fec_enc);
 static gchar const * gst_rs_fec_enc_get_status_name(of_status_t status);
 
+static guint gst_rs_fec_enc_get_payload_id_m(GstRSFECEnc *rs_fec_enc);
+static guint gst_rs_fec_enc_get_max_num_encoding_symbols(GstRSFECEnc *rs_fec_enc);
+static gboolean gst_rs_fec_enc_check_settings(GstRSFECEnc *rs_fec_enc);
+static gsize gst_rs_fec_enc_get_encoding_symbol_length(GstRSFECEnc *rs_fec_enc, gsize max_adui_length);
+static gboolean gst_rs_fec_enc_uses_openfec_session(GstRSFECEnc *rs_fec_enc);
+static gboolean gst_rs_fec_enc_configure_session(GstRSFECEnc *rs_fec_enc, gsize encoding_symbol_length);
+static gboolean gst_rs_fec_enc_build_repair_symbols(GstRSFECEnc *rs_fec_enc, gsize encoding_symbol_length);
+static void gst_rs_fec_enc_set_caps_fields(GstRSFECEnc *rs_fec_enc, GstCaps *caps);
+
 
 
 static void gst_rs_fec_enc_class_init(GstRSFECEncClass *klass)
@@ -165,6 +484,9 @@ static void gst_rs_fec_enc_class_init(GstRSFECEncClass *klass)
 
 	GST_DEBUG_CATEGORY_INIT(rs_fec_enc_debug, "rsfecenc", 0, "FECFRAME RFC 6865 Reed-Solomon scheme encoder");
 
+	gst_fec_gf256_init();
+	gst_rs_fft_init();
+
 	object_class = G_OBJECT_CLASS(klass);
 	element_class = GST_ELEMENT_CLASS(klass);
 
@@ -172,18 +494,30 @@ static void gst_rs_fec_enc_class_init(GstRSFECEncClass *klass)
 	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_fecsource_template));
 	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_fecrepair_template));
 
+	object_class->finalize      = GST_DEBUG_FUNCPTR(gst_rs_fec_enc_finalize);
 	object_class->set_property  = GST_DEBUG_FUNCPTR(gst_rs_fec_enc_set_property);
 	object_class->get_property  = GST_DEBUG_FUNCPTR(gst_rs_fec_enc_get_property);
 
 	element_class->change_state = GST_DEBUG_FUNCPTR(gst_rs_fec_enc_change_state);
 
+	klass->openfec_codec_id             = OF_CODEC_REED_SOLOMON_GF_2_8_STABLE;
+	klass->supports_num_symbols_changes = TRUE;
+	klass->get_payload_id_m             = GST_DEBUG_FUNCPTR(gst_rs_fec_enc_get_payload_id_m);
+	klass->get_max_num_encoding_symbols = GST_DEBUG_FUNCPTR(gst_rs_fec_enc_get_max_num_encoding_symbols);
+	klass->check_settings               = GST_DEBUG_FUNCPTR(gst_rs_fec_enc_check_settings);
+	klass->uses_openfec_session         = GST_DEBUG_FUNCPTR(gst_rs_fec_enc_uses_openfec_session);
+	klass->get_encoding_symbol_length   = GST_DEBUG_FUNCPTR(gst_rs_fec_enc_get_encoding_symbol_length);
+	klass->configure_session            = GST_DEBUG_FUNCPTR(gst_rs_fec_enc_configure_session);
+	klass->build_repair_symbols         = GST_DEBUG_FUNCPTR(gst_rs_fec_enc_build_repair_symbols);
+	klass->set_caps_fields              = GST_DEBUG_FUNCPTR(gst_rs_fec_enc_set_caps_fields);
+
 	g_object_class_install_property(
 		object_class,
 		PROP_NUM_SOURCE_SYMBOLS,
 		g_param_spec_uint(
 			"num-source-symbols",
 			"Number of source symbols",
-			"How many source symbols to use per Reed-Solomon source block",
+			"How many source symbols to use per Reed-Solomon source block (changes while running take effect at the next source block)",
 			1, G_MAXUINT,
 			DEFAULT_NUM_SOURCE_SYMBOLS,
 			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
@@ -195,12 +529,320 @@ static void gst_rs_fec_enc_class_init(GstRSFECEncClass *klass)
 		g_param_spec_uint(
 			"num-repair-symbols",
 			"Number of repair symbols",
-			"How many repair symbols to use per Reed-Solomon repair block (0 disables FEC repair symbol generation)",
+			"How many repair symbols to use per Reed-Solomon repair block (0 disables FEC repair symbol generation; changes while running take effect at the next source block)",
 			0, G_MAXUINT,
 			DEFAULT_NUM_REPAIR_SYMBOLS,
 			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
 		)
 	);
+	g_object_class_install_property(
+		object_class,
+		PROP_CODE_CONSTRUCTION,
+		g_param_spec_enum(
+			"code-construction",
+			"Code construction",
+			"How to compute repair symbols (the decoder must use the same construction)",
+			GST_TYPE_RS_FEC_CODE_CONSTRUCTION,
+			DEFAULT_CODE_CONSTRUCTION,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_INTERLEAVE_DEPTH,
+		g_param_spec_uint(
+			"interleave-depth",
+			"Interleave depth",
+			"How many source blocks to fill at the same time by assigning ADUs to them round-robin (1 disables interleaving; the decoder's max-source-block-age must be at least this large)",
+			1, MAX_INTERLEAVE_DEPTH,
+			DEFAULT_INTERLEAVE_DEPTH,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_MAX_BLOCK_DURATION,
+		g_param_spec_uint64(
+			"max-block-duration",
+			"Max block duration",
+			"Maximum time in nanoseconds between the first ADU of a source block and its repair packets; incomplete blocks are closed early as shortened blocks (0 = wait for complete blocks)",
+			0, G_MAXUINT64,
+			DEFAULT_MAX_BLOCK_DURATION,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_FRAME_BOUNDARY,
+		g_param_spec_enum(
+			"frame-boundary",
+			"Frame boundary",
+			"How frame boundaries are detected; source blocks are closed early at frame boundaries if they contain at least min-source-symbols ADUs",
+			GST_TYPE_RS_FEC_ENC_FRAME_BOUNDARY,
+			DEFAULT_FRAME_BOUNDARY,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_MIN_SOURCE_SYMBOLS,
+		g_param_spec_uint(
+			"min-source-symbols",
+			"Min source symbols",
+			"Minimum number of source symbols a source block must contain to be closed early at a frame boundary",
+			1, G_MAXUINT,
+			DEFAULT_MIN_SOURCE_SYMBOLS,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_UEP,
+		g_param_spec_boolean(
+			"uep",
+			"Unequal error protection",
+			"Choose the number of repair symbols per source block based on the buffer flags of its ADUs",
+			DEFAULT_UEP,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_DELTA_REPAIR_SYMBOLS,
+		g_param_spec_uint(
+			"delta-repair-symbols",
+			"Delta repair symbols",
+			"Number of repair symbols for source blocks that only contain delta units (only used if uep is TRUE; at most num-repair-symbols)",
+			0, G_MAXUINT,
+			DEFAULT_DELTA_REPAIR_SYMBOLS,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_DROPPABLE_REPAIR_SYMBOLS,
+		g_param_spec_uint(
+			"droppable-repair-symbols",
+			"Droppable repair symbols",
+			"Number of repair symbols for source blocks that only contain droppable ADUs (only used if uep is TRUE; at most num-repair-symbols)",
+			0, G_MAXUINT,
+			DEFAULT_DROPPABLE_REPAIR_SYMBOLS,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_REPAIR_OVERHEAD_BUDGET,
+		g_param_spec_uint(
+			"repair-overhead-budget",
+			"Repair overhead budget",
+			"Maximum average number of repair symbols, in percent of the number of source symbols (only used if uep is TRUE; 0 = unlimited)",
+			0, G_MAXUINT,
+			DEFAULT_REPAIR_OVERHEAD_BUDGET,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_ADAPTIVE_REPAIR,
+		g_param_spec_boolean(
+			"adaptive-repair",
+			"Adaptive repair",
+			"Adapt the number of repair symbols per source block to the reported loss rate",
+			DEFAULT_ADAPTIVE_REPAIR,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_MIN_REPAIR_SYMBOLS,
+		g_param_spec_uint(
+			"min-repair-symbols",
+			"Min repair symbols",
+			"Number of repair symbols per source block at a loss rate of 0 (only used if adaptive-repair is TRUE; at most num-repair-symbols)",
+			0, G_MAXUINT,
+			DEFAULT_MIN_REPAIR_SYMBOLS,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_LOSS_RATE,
+		g_param_spec_double(
+			"loss-rate",
+			"Loss rate",
+			"Estimated fraction of lost packets; setting this passes in a loss report, reading it returns the smoothed estimate",
+			0.0, 1.0,
+			DEFAULT_LOSS_RATE,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_MAX_REPAIR_BITRATE,
+		g_param_spec_uint(
+			"max-repair-bitrate",
+			"Max repair bitrate",
+			"Maximum bitrate of the FEC repair packets, in bits per second (0 = unlimited)",
+			0, G_MAXUINT,
+			DEFAULT_MAX_REPAIR_BITRATE,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_REPAIR_BUDGET_UTILIZATION,
+		g_param_spec_double(
+			"repair-budget-utilization",
+			"Repair budget utilization",
+			"Fraction of the max-repair-bitrate budget that was used for repair packets since the stream started (0 if the bitrate is unlimited)",
+			0.0, 1.0,
+			0.0,
+			G_PARAM_READABLE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_REPAIR_PACING,
+		g_param_spec_boolean(
+			"repair-pacing",
+			"Repair pacing",
+			"Spread the FEC repair packets of a source block evenly over the expected duration of the next block instead of sending them in a burst",
+			DEFAULT_REPAIR_PACING,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_REPAIR_DELAY,
+		g_param_spec_uint64(
+			"repair-delay",
+			"Repair delay",
+			"Delay between the completion of a source block and its first FEC repair packet, in nanoseconds",
+			0, G_MAXUINT64,
+			DEFAULT_REPAIR_DELAY,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_MAX_SOURCE_SYMBOLS,
+		g_param_spec_uint(
+			"max-source-symbols",
+			"Maximum number of source symbols",
+			"Largest number of source symbols per source block that can be set while running (0 = initial number of source symbols)",
+			0, G_MAXUINT,
+			DEFAULT_MAX_SOURCE_SYMBOLS,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_MAX_REPAIR_SYMBOLS,
+		g_param_spec_uint(
+			"max-repair-symbols",
+			"Maximum number of repair symbols",
+			"Largest number of repair symbols per source block that can be set while running (0 = initial number of repair symbols)",
+			0, G_MAXUINT,
+			DEFAULT_MAX_REPAIR_SYMBOLS,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_MAX_FRAGMENT_SIZE,
+		g_param_spec_uint(
+			"max-fragment-size",
+			"Maximum fragment size",
+			"Split ADUs into fragments of at most this many bytes, each sent as a separate source symbol with a fragment header (0 = no fragmentation)",
+			0, 65535 - GST_RS_FEC_FRAGMENT_HEADER_SIZE,
+			DEFAULT_MAX_FRAGMENT_SIZE,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_PACK_SIZE,
+		g_param_spec_uint(
+			"pack-size",
+			"Pack size",
+			"Coalesce small ADUs into source symbols of up to this many bytes (0 = no packing)",
+			0, 65535,
+			DEFAULT_PACK_SIZE,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_MAX_PADDING_OVERHEAD,
+		g_param_spec_uint(
+			"max-padding-overhead",
+			"Maximum padding overhead",
+			"Close a source block early if the next ADU would make the padding exceed this many percent of its source symbol bytes (0 = disabled)",
+			0, 100,
+			DEFAULT_MAX_PADDING_OVERHEAD,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_PADDING_OVERHEAD,
+		g_param_spec_double(
+			"padding-overhead",
+			"Padding overhead",
+			"Fraction of the source symbol bytes that were padding, over all source blocks since the stream started",
+			0.0, 1.0,
+			0.0,
+			G_PARAM_READABLE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_LAST_PADDING_OVERHEAD,
+		g_param_spec_double(
+			"last-padding-overhead",
+			"Last padding overhead",
+			"Fraction of the source symbol bytes that were padding in the most recent source block (or interleaving group)",
+			0.0, 1.0,
+			0.0,
+			G_PARAM_READABLE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_ADU_SIZE,
+		g_param_spec_uint(
+			"adu-size",
+			"ADU size",
+			"Treat the input as a byte stream, and slice it into ADUs of this many bytes (0 = each input buffer is one ADU)",
+			0, 65535,
+			DEFAULT_ADU_SIZE,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_MAX_SYMBOL_LENGTH,
+		g_param_spec_uint(
+			"max-symbol-length",
+			"Max symbol length",
+			"Reserve memory for source symbols of up to this many bytes at startup, so that changes of the symbol length do not allocate memory (0 = allocate on demand)",
+			0, 1 + 2 + 65535,
+			DEFAULT_MAX_SYMBOL_LENGTH,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_TRANSMIT_TIMESTAMPS,
+		g_param_spec_boolean(
+			"transmit-timestamps",
+			"Transmit timestamps",
+			"Prepend each ADU with a header that carries its PTS (as running time) and duration, so the decoder can restore them",
+			DEFAULT_TRANSMIT_TIMESTAMPS,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
 
 	gst_element_class_set_static_metadata(
 		element_class,
@@ -215,20 +857,78 @@ static void gst_rs_fec_enc_class_init(GstRSFECEncClass *klass)
 static void gst_rs_fec_enc_init(GstRSFECEnc *rs_fec_enc)
 {
 	rs_fec_enc->openfec_session = NULL;
+	rs_fec_enc->initialized = FALSE;
 
 	rs_fec_enc->num_source_symbols = DEFAULT_NUM_SOURCE_SYMBOLS;
 	rs_fec_enc->num_repair_symbols = DEFAULT_NUM_REPAIR_SYMBOLS;
 	rs_fec_enc->num_encoding_symbols = rs_fec_enc->num_source_symbols + rs_fec_enc->num_repair_symbols;
+	rs_fec_enc->next_num_source_symbols = rs_fec_enc->num_source_symbols;
+	rs_fec_enc->next_num_repair_symbols = rs_fec_enc->num_repair_symbols;
+	rs_fec_enc->max_source_symbols = DEFAULT_MAX_SOURCE_SYMBOLS;
+	rs_fec_enc->max_repair_symbols = DEFAULT_MAX_REPAIR_SYMBOLS;
+	rs_fec_enc->num_symbols_changed = FALSE;
+	rs_fec_enc->code_construction = DEFAULT_CODE_CONSTRUCTION;
+	rs_fec_enc->interleave_depth = DEFAULT_INTERLEAVE_DEPTH;
 	rs_fec_enc->cur_source_block_nr = 0;
+	rs_fec_enc->cur_source_block_length = rs_fec_enc->num_source_symbols;
+	rs_fec_enc->max_block_duration = DEFAULT_MAX_BLOCK_DURATION;
+	rs_fec_enc->system_clock = gst_system_clock_obtain();
+	rs_fec_enc->cur_block_start_time = GST_CLOCK_TIME_NONE;
+	rs_fec_enc->block_timeout_clock_id = NULL;
+	rs_fec_enc->frame_boundary = DEFAULT_FRAME_BOUNDARY;
+	rs_fec_enc->min_source_symbols = DEFAULT_MIN_SOURCE_SYMBOLS;
+	rs_fec_enc->last_adu_pts = GST_CLOCK_TIME_NONE;
+	rs_fec_enc->cur_num_repair_symbols = rs_fec_enc->num_repair_symbols;
+	rs_fec_enc->uep = DEFAULT_UEP;
+	rs_fec_enc->delta_repair_symbols = DEFAULT_DELTA_REPAIR_SYMBOLS;
+	rs_fec_enc->droppable_repair_symbols = DEFAULT_DROPPABLE_REPAIR_SYMBOLS;
+	rs_fec_enc->repair_overhead_budget = DEFAULT_REPAIR_OVERHEAD_BUDGET;
+	rs_fec_enc->repair_credit = 0;
+	rs_fec_enc->adaptive_repair = DEFAULT_ADAPTIVE_REPAIR;
+	rs_fec_enc->min_repair_symbols = DEFAULT_MIN_REPAIR_SYMBOLS;
+	rs_fec_enc->loss_rate = DEFAULT_LOSS_RATE;
+	rs_fec_enc->max_repair_bitrate = DEFAULT_MAX_REPAIR_BITRATE;
+	rs_fec_enc->repair_tokens = 0;
+	rs_fec_enc->repair_tokens_update_time = GST_CLOCK_TIME_NONE;
+	rs_fec_enc->num_repair_budget_bytes = 0;
+	rs_fec_enc->num_repair_budget_bytes_used = 0;
+	rs_fec_enc->repair_pacing = DEFAULT_REPAIR_PACING;
+	rs_fec_enc->repair_delay = DEFAULT_REPAIR_DELAY;
+	rs_fec_enc->last_repair_send_time = GST_CLOCK_TIME_NONE;
+	rs_fec_enc->repair_send_interval = 0;
+	g_queue_init(&(rs_fec_enc->repair_output_queue));
+	g_mutex_init(&(rs_fec_enc->repair_output_mutex));
+	g_cond_init(&(rs_fec_enc->repair_output_cond));
+	rs_fec_enc->repair_output_clock_id = NULL;
+	rs_fec_enc->repair_output_task_started = FALSE;
+	rs_fec_enc->repair_output_flushing = FALSE;
+	rs_fec_enc->repair_output_flow_return = GST_FLOW_OK;
 	rs_fec_enc->first_source_packet = TRUE;
 	rs_fec_enc->first_repair_packet = TRUE;
+	rs_fec_enc->max_fragment_size = DEFAULT_MAX_FRAGMENT_SIZE;
+	rs_fec_enc->next_adu_nr = 0;
+	rs_fec_enc->pack_size = DEFAULT_PACK_SIZE;
+	rs_fec_enc->pending_pack = NULL;
+	rs_fec_enc->adu_size = DEFAULT_ADU_SIZE;
+	rs_fec_enc->pending_bytes = NULL;
+	rs_fec_enc->transmit_timestamps = DEFAULT_TRANSMIT_TIMESTAMPS;
+	gst_segment_init(&(rs_fec_enc->input_segment), GST_FORMAT_UNDEFINED);
+	gst_fec_symbol_arena_init(&(rs_fec_enc->symbol_arena));
+	rs_fec_enc->max_symbol_length = DEFAULT_MAX_SYMBOL_LENGTH;
 
 	rs_fec_enc->encoding_symbol_length = 0;
 	rs_fec_enc->encoding_symbol_table = NULL;
+	rs_fec_enc->source_symbol_table = NULL;
 
 	rs_fec_enc->adu_table = NULL;
 	rs_fec_enc->cur_num_adus = 0;
 	rs_fec_enc->cur_max_adu_length = 0;
+	rs_fec_enc->cur_adu_bytes = 0;
+
+	rs_fec_enc->max_padding_overhead = DEFAULT_MAX_PADDING_OVERHEAD;
+	rs_fec_enc->num_padding_bytes = 0;
+	rs_fec_enc->num_symbol_bytes = 0;
+	rs_fec_enc->last_padding_overhead = 0.0;
 
 	rs_fec_enc->fec_repair_packet_table = NULL;
 	rs_fec_enc->cur_num_fec_repair_packets = 0;
@@ -256,7 +956,28 @@ static void gst_rs_fec_enc_init(GstRSFECEnc *rs_fec_enc)
 	gst_element_add_pad(GST_ELEMENT(rs_fec_enc), rs_fec_enc->fecrepairpad);
 
 	gst_pad_set_event_function(rs_fec_enc->sinkpad, GST_DEBUG_FUNCPTR(gst_rs_fec_enc_sink_event));
+	gst_pad_set_event_function(rs_fec_enc->fecsourcepad, GST_DEBUG_FUNCPTR(gst_rs_fec_enc_src_event));
+	gst_pad_set_event_function(rs_fec_enc->fecrepairpad, GST_DEBUG_FUNCPTR(gst_rs_fec_enc_src_event));
 	gst_pad_set_chain_function(rs_fec_enc->sinkpad, GST_DEBUG_FUNCPTR(gst_rs_fec_enc_sink_chain));
+	gst_pad_set_query_function(rs_fec_enc->fecsourcepad, GST_DEBUG_FUNCPTR(gst_rs_fec_enc_src_query));
+	gst_pad_set_query_function(rs_fec_enc->fecrepairpad, GST_DEBUG_FUNCPTR(gst_rs_fec_enc_src_query));
+}
+
+
+static void gst_rs_fec_enc_finalize(GObject *object)
+{
+	GstRSFECEnc *rs_fec_enc = GST_RS_FEC_ENC(object);
+
+	/* The pending block timeout (if any) holds a reference to the
+	 * element, so it cannot exist anymore at this point */
+	g_assert(rs_fec_enc->block_timeout_clock_id == NULL);
+	gst_object_unref(GST_OBJECT(rs_fec_enc->system_clock));
+
+	gst_rs_fec_enc_reset_repair_output(rs_fec_enc);
+	g_mutex_clear(&(rs_fec_enc->repair_output_mutex));
+	g_cond_clear(&(rs_fec_enc->repair_output_cond));
+
+	G_OBJECT_CLASS(gst_rs_fec_enc_parent_class)->finalize(object);
 }
 
 
@@ -264,16 +985,16 @@ static void gst_rs_fec_enc_set_property(GObject *object, guint prop_id, GValue c
 {
 	GstRSFECEnc *rs_fec_enc = GST_RS_FEC_ENC(object);
 
-	/* NOTE: this assumes Reed-Solomon with GF(2^8) is used
-	 * once OpenFEC can handle GF(2^m) with 2 <= m <= 16,
-	 * replace this constant with something appropriate */
-	guint const max_num_encoding_symbols = (1 << 8) - 1;
+	/* NOTE: the maximum depends on the FEC scheme and the code construction.
+	 * If the construction is changed after the number of symbols, the
+	 * values are checked again in gst_rs_fec_enc_init_openfec(). */
+	guint const max_num_encoding_symbols = GST_RS_FEC_ENC_GET_CLASS(rs_fec_enc)->get_max_num_encoding_symbols(rs_fec_enc);
 
 	switch (prop_id)
 	{
 		case PROP_NUM_SOURCE_SYMBOLS:
 			GST_OBJECT_LOCK(object);
-			if (rs_fec_enc->openfec_session == NULL)
+			if (!(rs_fec_enc->initialized))
 			{
 				rs_fec_enc->num_source_symbols = g_value_get_uint(value);
 				rs_fec_enc->num_encoding_symbols = rs_fec_enc->num_source_symbols + rs_fec_enc->num_repair_symbols;
@@ -286,14 +1007,18 @@ static void gst_rs_fec_enc_set_property(GObject *object, guint prop_id, GValue c
 					);
 				}
 			}
-			else
+			else if (!GST_RS_FEC_ENC_GET_CLASS(rs_fec_enc)->supports_num_symbols_changes)
 				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set number of source symbols after initializing OpenFEC"), (NULL));
+			else if (g_value_get_uint(value) > rs_fec_enc->max_source_symbols)
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set number of source symbols beyond the maximum"), ("number of source symbols: %u  maximum: %u", g_value_get_uint(value), rs_fec_enc->max_source_symbols));
+			else
+				rs_fec_enc->next_num_source_symbols = g_value_get_uint(value);
 			GST_OBJECT_UNLOCK(object);
 			break;
 
 		case PROP_NUM_REPAIR_SYMBOLS:
 			GST_OBJECT_LOCK(object);
-			if (rs_fec_enc->openfec_session == NULL)
+			if (!(rs_fec_enc->initialized))
 			{
 				rs_fec_enc->num_repair_symbols = g_value_get_uint(value);
 				rs_fec_enc->num_encoding_symbols = rs_fec_enc->num_source_symbols + rs_fec_enc->num_repair_symbols;
@@ -306,68 +1031,417 @@ static void gst_rs_fec_enc_set_property(GObject *object, guint prop_id, GValue c
 					);
 				}
 			}
-			else
+			else if (!GST_RS_FEC_ENC_GET_CLASS(rs_fec_enc)->supports_num_symbols_changes)
 				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set number of repair symbols after initializing OpenFEC"), (NULL));
+			else if (g_value_get_uint(value) > rs_fec_enc->max_repair_symbols)
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set number of repair symbols beyond the maximum"), ("number of repair symbols: %u  maximum: %u", g_value_get_uint(value), rs_fec_enc->max_repair_symbols));
+			else
+				rs_fec_enc->next_num_repair_symbols = g_value_get_uint(value);
 			GST_OBJECT_UNLOCK(object);
 			break;
 
-		default:
-			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+		case PROP_MAX_SOURCE_SYMBOLS:
+			GST_OBJECT_LOCK(object);
+			if (!(rs_fec_enc->initialized))
+				rs_fec_enc->max_source_symbols = g_value_get_uint(value);
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set maximum number of source symbols after initializing OpenFEC"), (NULL));
+			GST_OBJECT_UNLOCK(object);
 			break;
-	}
-}
-
-
-static void gst_rs_fec_enc_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec)
-{
-	GstRSFECEnc *rs_fec_enc = GST_RS_FEC_ENC(object);
 
-	switch (prop_id)
-	{
-		case PROP_NUM_SOURCE_SYMBOLS:
-			g_value_set_uint(value, rs_fec_enc->num_source_symbols);
+		case PROP_MAX_REPAIR_SYMBOLS:
+			GST_OBJECT_LOCK(object);
+			if (!(rs_fec_enc->initialized))
+				rs_fec_enc->max_repair_symbols = g_value_get_uint(value);
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set maximum number of repair symbols after initializing OpenFEC"), (NULL));
+			GST_OBJECT_UNLOCK(object);
 			break;
 
-		case PROP_NUM_REPAIR_SYMBOLS:
-			g_value_set_uint(value, rs_fec_enc->num_repair_symbols);
+		case PROP_MAX_FRAGMENT_SIZE:
+			GST_OBJECT_LOCK(object);
+			if (!(rs_fec_enc->initialized))
+				rs_fec_enc->max_fragment_size = g_value_get_uint(value);
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set maximum fragment size after initializing OpenFEC"), (NULL));
+			GST_OBJECT_UNLOCK(object);
 			break;
 
-		default:
-			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+		case PROP_PACK_SIZE:
+			GST_OBJECT_LOCK(object);
+			if (!(rs_fec_enc->initialized))
+				rs_fec_enc->pack_size = g_value_get_uint(value);
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set pack size after initializing OpenFEC"), (NULL));
+			GST_OBJECT_UNLOCK(object);
 			break;
-	}
-}
 
+		case PROP_MAX_PADDING_OVERHEAD:
+			GST_OBJECT_LOCK(object);
+			rs_fec_enc->max_padding_overhead = g_value_get_uint(value);
+			GST_OBJECT_UNLOCK(object);
+			break;
 
-static GstStateChangeReturn gst_rs_fec_enc_change_state(GstElement *element, GstStateChange transition)
-{
-	GstRSFECEnc *rs_fec_enc = GST_RS_FEC_ENC(element);
-	GstStateChangeReturn result;
+		case PROP_ADU_SIZE:
+			GST_OBJECT_LOCK(object);
+			if (!(rs_fec_enc->initialized))
+				rs_fec_enc->adu_size = g_value_get_uint(value);
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set ADU size after initializing OpenFEC"), (NULL));
+			GST_OBJECT_UNLOCK(object);
+			break;
 
-	switch (transition)
-	{
-		case GST_STATE_CHANGE_NULL_TO_READY:
-			if (!gst_rs_fec_enc_init_openfec(rs_fec_enc))
-				return GST_STATE_CHANGE_FAILURE;
+		case PROP_TRANSMIT_TIMESTAMPS:
+			GST_OBJECT_LOCK(object);
+			if (!(rs_fec_enc->initialized))
+				rs_fec_enc->transmit_timestamps = g_value_get_boolean(value);
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot enable or disable timestamp transmission after initializing OpenFEC"), (NULL));
+			GST_OBJECT_UNLOCK(object);
 			break;
 
-		case GST_STATE_CHANGE_READY_TO_PAUSED:
-			/* Make sure states are at their initial value */
-			gst_rs_fec_enc_reset_states(rs_fec_enc);
+		case PROP_MAX_SYMBOL_LENGTH:
+			GST_OBJECT_LOCK(object);
+			if (!(rs_fec_enc->initialized))
+				rs_fec_enc->max_symbol_length = g_value_get_uint(value);
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set max symbol length after initializing OpenFEC"), (NULL));
+			GST_OBJECT_UNLOCK(object);
 			break;
 
-		default:
+		case PROP_CODE_CONSTRUCTION:
+			GST_OBJECT_LOCK(object);
+			if (!(rs_fec_enc->initialized))
+				rs_fec_enc->code_construction = g_value_get_enum(value);
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set code construction after initializing OpenFEC"), (NULL));
+			GST_OBJECT_UNLOCK(object);
 			break;
-	}
 
-	if ((result = GST_ELEMENT_CLASS(gst_rs_fec_enc_parent_class)->change_state(element, transition)) == GST_STATE_CHANGE_FAILURE)
-		return result;
+		case PROP_INTERLEAVE_DEPTH:
+			GST_OBJECT_LOCK(object);
+			if (!(rs_fec_enc->initialized))
+				rs_fec_enc->interleave_depth = g_value_get_uint(value);
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set interleave depth after initializing OpenFEC"), (NULL));
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_MAX_BLOCK_DURATION:
+			GST_OBJECT_LOCK(object);
+			rs_fec_enc->max_block_duration = g_value_get_uint64(value);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_FRAME_BOUNDARY:
+			GST_OBJECT_LOCK(object);
+			rs_fec_enc->frame_boundary = g_value_get_enum(value);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_MIN_SOURCE_SYMBOLS:
+			GST_OBJECT_LOCK(object);
+			rs_fec_enc->min_source_symbols = g_value_get_uint(value);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_UEP:
+			GST_OBJECT_LOCK(object);
+			rs_fec_enc->uep = g_value_get_boolean(value);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_DELTA_REPAIR_SYMBOLS:
+			GST_OBJECT_LOCK(object);
+			rs_fec_enc->delta_repair_symbols = g_value_get_uint(value);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_DROPPABLE_REPAIR_SYMBOLS:
+			GST_OBJECT_LOCK(object);
+			rs_fec_enc->droppable_repair_symbols = g_value_get_uint(value);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_REPAIR_OVERHEAD_BUDGET:
+			GST_OBJECT_LOCK(object);
+			rs_fec_enc->repair_overhead_budget = g_value_get_uint(value);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_ADAPTIVE_REPAIR:
+			GST_OBJECT_LOCK(object);
+			rs_fec_enc->adaptive_repair = g_value_get_boolean(value);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_MIN_REPAIR_SYMBOLS:
+			GST_OBJECT_LOCK(object);
+			rs_fec_enc->min_repair_symbols = g_value_get_uint(value);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_LOSS_RATE:
+			gst_rs_fec_enc_update_loss_rate(rs_fec_enc, g_value_get_double(value));
+			break;
+
+		case PROP_MAX_REPAIR_BITRATE:
+			GST_OBJECT_LOCK(object);
+			/* If the bitrate was unlimited so far, the token bucket
+			 * is not running; start it with a full bucket */
+			if (rs_fec_enc->max_repair_bitrate == 0)
+			{
+				rs_fec_enc->repair_tokens = 0;
+				rs_fec_enc->repair_tokens_update_time = GST_CLOCK_TIME_NONE;
+			}
+			rs_fec_enc->max_repair_bitrate = g_value_get_uint(value);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_REPAIR_PACING:
+			GST_OBJECT_LOCK(object);
+			rs_fec_enc->repair_pacing = g_value_get_boolean(value);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_REPAIR_DELAY:
+			GST_OBJECT_LOCK(object);
+			rs_fec_enc->repair_delay = g_value_get_uint64(value);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+			break;
+	}
+}
+
+
+static void gst_rs_fec_enc_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec)
+{
+	GstRSFECEnc *rs_fec_enc = GST_RS_FEC_ENC(object);
+
+	switch (prop_id)
+	{
+		case PROP_NUM_SOURCE_SYMBOLS:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, (rs_fec_enc->initialized) ? rs_fec_enc->next_num_source_symbols : rs_fec_enc->num_source_symbols);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_NUM_REPAIR_SYMBOLS:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, (rs_fec_enc->initialized) ? rs_fec_enc->next_num_repair_symbols : rs_fec_enc->num_repair_symbols);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_MAX_SOURCE_SYMBOLS:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, rs_fec_enc->max_source_symbols);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_MAX_REPAIR_SYMBOLS:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, rs_fec_enc->max_repair_symbols);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_MAX_FRAGMENT_SIZE:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, rs_fec_enc->max_fragment_size);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_PACK_SIZE:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, rs_fec_enc->pack_size);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_CODE_CONSTRUCTION:
+			g_value_set_enum(value, rs_fec_enc->code_construction);
+			break;
+
+		case PROP_INTERLEAVE_DEPTH:
+			g_value_set_uint(value, rs_fec_enc->interleave_depth);
+			break;
+
+		case PROP_MAX_BLOCK_DURATION:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint64(value, rs_fec_enc->max_block_duration);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_FRAME_BOUNDARY:
+			GST_OBJECT_LOCK(object);
+			g_value_set_enum(value, rs_fec_enc->frame_boundary);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_MIN_SOURCE_SYMBOLS:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, rs_fec_enc->min_source_symbols);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_UEP:
+			GST_OBJECT_LOCK(object);
+			g_value_set_boolean(value, rs_fec_enc->uep);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_DELTA_REPAIR_SYMBOLS:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, rs_fec_enc->delta_repair_symbols);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_DROPPABLE_REPAIR_SYMBOLS:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, rs_fec_enc->droppable_repair_symbols);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_REPAIR_OVERHEAD_BUDGET:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, rs_fec_enc->repair_overhead_budget);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_ADAPTIVE_REPAIR:
+			GST_OBJECT_LOCK(object);
+			g_value_set_boolean(value, rs_fec_enc->adaptive_repair);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_MIN_REPAIR_SYMBOLS:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, rs_fec_enc->min_repair_symbols);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_LOSS_RATE:
+			GST_OBJECT_LOCK(object);
+			g_value_set_double(value, rs_fec_enc->loss_rate);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_MAX_REPAIR_BITRATE:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, rs_fec_enc->max_repair_bitrate);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_REPAIR_PACING:
+			GST_OBJECT_LOCK(object);
+			g_value_set_boolean(value, rs_fec_enc->repair_pacing);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_REPAIR_DELAY:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint64(value, rs_fec_enc->repair_delay);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_REPAIR_BUDGET_UTILIZATION:
+			GST_OBJECT_LOCK(object);
+			if (rs_fec_enc->num_repair_budget_bytes > 0)
+				g_value_set_double(value, MIN((gdouble)(rs_fec_enc->num_repair_budget_bytes_used) / (gdouble)(rs_fec_enc->num_repair_budget_bytes), 1.0));
+			else
+				g_value_set_double(value, 0.0);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_MAX_PADDING_OVERHEAD:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, rs_fec_enc->max_padding_overhead);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_PADDING_OVERHEAD:
+			GST_OBJECT_LOCK(object);
+			if (rs_fec_enc->num_symbol_bytes > 0)
+				g_value_set_double(value, (gdouble)(rs_fec_enc->num_padding_bytes) / (gdouble)(rs_fec_enc->num_symbol_bytes));
+			else
+				g_value_set_double(value, 0.0);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_LAST_PADDING_OVERHEAD:
+			GST_OBJECT_LOCK(object);
+			g_value_set_double(value, rs_fec_enc->last_padding_overhead);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_ADU_SIZE:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, rs_fec_enc->adu_size);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_MAX_SYMBOL_LENGTH:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, rs_fec_enc->max_symbol_length);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_TRANSMIT_TIMESTAMPS:
+			GST_OBJECT_LOCK(object);
+			g_value_set_boolean(value, rs_fec_enc->transmit_timestamps);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+			break;
+	}
+}
+
+
+static GstStateChangeReturn gst_rs_fec_enc_change_state(GstElement *element, GstStateChange transition)
+{
+	GstRSFECEnc *rs_fec_enc = GST_RS_FEC_ENC(element);
+	GstStateChangeReturn result;
 
 	switch (transition)
 	{
+		case GST_STATE_CHANGE_NULL_TO_READY:
+			if (!gst_rs_fec_enc_init_openfec(rs_fec_enc))
+				return GST_STATE_CHANGE_FAILURE;
+			break;
+
+		case GST_STATE_CHANGE_READY_TO_PAUSED:
+			/* Make sure states are at their initial value */
+			gst_rs_fec_enc_reset_states(rs_fec_enc);
+			gst_rs_fec_enc_reset_repair_output(rs_fec_enc);
+			break;
+
 		case GST_STATE_CHANGE_PAUSED_TO_READY:
-			/* Make sure any stored ADUs are flushed and states are reset properly */
+			/* The repair output task must be stopped before the pads are
+			 * deactivated, since it holds the fecrepair pad's stream lock
+			 * while it waits for packets */
+			gst_rs_fec_enc_stop_repair_output(rs_fec_enc);
+			gst_pad_stop_task(rs_fec_enc->fecrepairpad);
+			break;
+
+		default:
+			break;
+	}
+
+	if ((result = GST_ELEMENT_CLASS(gst_rs_fec_enc_parent_class)->change_state(element, transition)) == GST_STATE_CHANGE_FAILURE)
+		return result;
+
+	switch (transition)
+	{
+		case GST_STATE_CHANGE_PAUSED_TO_READY:
+			/* Make sure any stored ADUs are flushed and states are reset properly.
+			 * The stream lock is taken, since the block timeout callback may
+			 * try to process the stored ADUs at the same time. */
+			GST_PAD_STREAM_LOCK(rs_fec_enc->sinkpad);
 			gst_rs_fec_enc_flush(rs_fec_enc);
+			GST_PAD_STREAM_UNLOCK(rs_fec_enc->sinkpad);
 			/* Stream is done after switching to READY */
 			rs_fec_enc->stream_started = FALSE;
 			break;
@@ -404,18 +1478,59 @@ static gboolean gst_rs_fec_enc_sink_event(GstPad *pad, GstObject *parent, GstEve
 
 		case GST_EVENT_SEGMENT:
 			/* Throw away incoming segments
-			 * this encoder generates its own SEGMENT events */
+			 * this encoder generates its own SEGMENT events
+			 * (the segment is kept for converting transmitted
+			 * timestamps to running time) */
+			gst_event_copy_segment(event, &(rs_fec_enc->input_segment));
 			gst_event_unref(event);
 			return TRUE;
 
+		case GST_EVENT_FLUSH_START:
+		{
+			gboolean ret;
+
+			/* Wake up the repair output task, and pause it once the
+			 * FLUSH_START event unblocked any pending push downstream */
+			gst_rs_fec_enc_stop_repair_output(rs_fec_enc);
+			ret = gst_pad_event_default(pad, parent, event);
+			gst_pad_pause_task(rs_fec_enc->fecrepairpad);
+			return ret;
+		}
+
 		case GST_EVENT_FLUSH_STOP:
 			/* Make sure any stored ADUs are flushed and states are reset properly */
 			gst_rs_fec_enc_flush(rs_fec_enc);
+			gst_rs_fec_enc_reset_repair_output(rs_fec_enc);
+			break;
+
+		case GST_EVENT_GAP:
+			/* No data will come in for a while, so send the repair packets
+			 * of the incomplete source block(s) now instead of letting the
+			 * ADUs that were received so far wait for more data. Leftover
+			 * bytes of a byte stream are sent as a shorter ADU first. */
+			if (!rs_fec_enc->eos_received)
+				gst_rs_fec_enc_flush_pending_bytes(rs_fec_enc);
+			if (!rs_fec_enc->eos_received && ((rs_fec_enc->cur_num_adus > 0) || (rs_fec_enc->pending_pack != NULL)))
+			{
+				GST_DEBUG_OBJECT(rs_fec_enc, "GAP received - closing incomplete source block early");
+				gst_rs_fec_enc_close_incomplete_block(rs_fec_enc);
+			}
 			break;
 
 		case GST_EVENT_EOS:
 			GST_DEBUG_OBJECT(rs_fec_enc, "EOS received");
 
+			/* Protect the ADUs of the last, incomplete source block(s) by
+			 * closing them early instead of discarding them. Leftover bytes
+			 * of a byte stream are sent as a shorter ADU first. */
+			if (!rs_fec_enc->eos_received)
+				gst_rs_fec_enc_flush_pending_bytes(rs_fec_enc);
+			if (!rs_fec_enc->eos_received && ((rs_fec_enc->cur_num_adus > 0) || (rs_fec_enc->pending_pack != NULL)))
+			{
+				GST_DEBUG_OBJECT(rs_fec_enc, "closing incomplete source block before EOS");
+				gst_rs_fec_enc_close_incomplete_block(rs_fec_enc);
+			}
+
 			/* Set the eos_received flag to let the chain function know we are done
 			 * receiving data, and forward the EOS event to both sourcepads */
 			rs_fec_enc->eos_received = TRUE;
@@ -424,10 +1539,11 @@ static gboolean gst_rs_fec_enc_sink_event(GstPad *pad, GstObject *parent, GstEve
 			 * (once for each sourcepad) */
 			gst_event_ref(event);
 			gst_pad_push_event(rs_fec_enc->fecsourcepad, event);
-			gst_pad_push_event(rs_fec_enc->fecrepairpad, event);
+			gst_rs_fec_enc_push_repair_event(rs_fec_enc, event);
 
 			/* After EOS, no data is accepted anymore; might as well flush
 			 * whatever is still stored */
+			gst_rs_fec_enc_discard_pending_data(rs_fec_enc);
 			gst_rs_fec_enc_flush_all_adus(rs_fec_enc);
 			gst_rs_fec_enc_flush_all_fec_repair_packets(rs_fec_enc);
 
@@ -441,64 +1557,467 @@ static gboolean gst_rs_fec_enc_sink_event(GstPad *pad, GstObject *parent, GstEve
 }
 
 
-static GstFlowReturn gst_rs_fec_enc_sink_chain(G_GNUC_UNUSED GstPad *pad, GstObject *parent, GstBuffer *buffer)
+static gboolean gst_rs_fec_enc_src_event(GstPad *pad, GstObject *parent, GstEvent *event)
 {
-	GstRSFECEnc *rs_fec_enc = GST_RS_FEC_ENC_CAST(parent);
-	GstFlowReturn ret = GST_FLOW_OK;
+	GstRSFECEnc *rs_fec_enc = GST_RS_FEC_ENC(parent);
 
-	if (rs_fec_enc->eos_received)
-	{
-		GST_DEBUG_OBJECT(rs_fec_enc, "received data after EOS was received - dropping buffer");
-		gst_buffer_unref(buffer);
-		ret = GST_FLOW_EOS;
-	}
-	else
+	switch (GST_EVENT_TYPE(event))
 	{
-		/* The input buffer is the new ADU */
-
-		gsize bufsize = gst_buffer_get_size(buffer);
-
-		if (bufsize > 65535)
-		{
-			GST_ELEMENT_ERROR(rs_fec_enc, STREAM, ENCODE, ("input buffer too large"), ("maximum is 65535 bytes, buffer size is %" G_GSIZE_FORMAT, bufsize));
-			gst_buffer_unref(buffer);
-			ret = GST_FLOW_ERROR;
-		}
-		else
+		case GST_EVENT_CUSTOM_UPSTREAM:
 		{
-			GstBuffer *output_adu;
-
-			/* The ESI for this new ADU shall be the value of cur_num_adus.
-			 * The reason for this is that new ADUs shall be placed one after the
-			 * other in the adu_table. So, the first ADU is placed in index 0,
-			 * the second in index 1 etc. cur_num_adus therefore functions both
-			 * as an index counter for the ESIs and a value denoting the number
-			 * of currently present ADUs. */
-			guint esi = rs_fec_enc->cur_num_adus;
-
-			/* Copy the ADU. This avoids actually copying the bytes themselves
-			 * unless it is deemed absolutely necessary by GStreamer.
-			 * The copy is required, because the GstBuffer is modified (an FEC
-			 * payload ID is appended prior to sending). */
-			output_adu = gst_buffer_copy(buffer);
-			if ((ret = gst_rs_fec_enc_push_adu(rs_fec_enc, output_adu, esi)) != GST_FLOW_OK)
-			{
-				gst_buffer_unref(buffer);
-				return ret;
-			}
+			/* Loss reports from a decoder downstream */
+			GstStructure const *s = gst_event_get_structure(event);
+			gdouble reported_loss_rate;
 
-			/* Insert the ADU into the adu_table and update the cur_max_adu_length. */
-			gst_rs_fec_enc_insert_adu(rs_fec_enc, buffer, esi);
+			if ((s != NULL) && gst_structure_has_name(s, GST_FEC_LOSS_REPORT_STRUCTURE_NAME))
+			{
+				if (gst_structure_get_double(s, "loss-rate", &reported_loss_rate))
+					gst_rs_fec_enc_update_loss_rate(rs_fec_enc, reported_loss_rate);
+				else
+					GST_WARNING_OBJECT(rs_fec_enc, "loss report without loss rate - ignoring");
 
-			/* Increment the counter _before_ processing the block below, since it
-			 * expects cur_num_adus to denote the number of inserted ADUs. */
-			rs_fec_enc->cur_num_adus++;
+				gst_event_unref(event);
+				return TRUE;
+			}
 
-			ret = gst_rs_fec_enc_process_source_block(rs_fec_enc);
+			break;
 		}
-	}
 
-	return ret;
+		default:
+			break;
+	}
+
+	return gst_pad_event_default(pad, parent, event);
+}
+
+
+static gboolean gst_rs_fec_enc_src_query(GstPad *pad, GstObject *parent, GstQuery *query)
+{
+	GstRSFECEnc *rs_fec_enc = GST_RS_FEC_ENC(parent);
+
+	switch (GST_QUERY_TYPE(query))
+	{
+		case GST_QUERY_LATENCY:
+			/* Source packets are pushed as soon as their ADU comes in,
+			 * so the encoder adds no latency to the FEC source flow.
+			 * The ghost pads have no targets, which means the default
+			 * handler would find no internal links to forward the query
+			 * through; forward it to the sinkpad's peer instead, and
+			 * pass its answer on unchanged. The FEC repair flow gets the
+			 * same answer, since repair packets are only useful together
+			 * with the source packets anyway. */
+			return gst_pad_peer_query(rs_fec_enc->sinkpad, query);
+
+		default:
+			return gst_pad_query_default(pad, parent, query);
+	}
+}
+
+
+static GstFlowReturn gst_rs_fec_enc_sink_chain(G_GNUC_UNUSED GstPad *pad, GstObject *parent, GstBuffer *buffer)
+{
+	GstRSFECEnc *rs_fec_enc = GST_RS_FEC_ENC_CAST(parent);
+	GstFlowReturn ret = GST_FLOW_OK;
+
+	if (rs_fec_enc->eos_received)
+	{
+		GST_DEBUG_OBJECT(rs_fec_enc, "received data after EOS was received - dropping buffer");
+		gst_buffer_unref(buffer);
+		ret = GST_FLOW_EOS;
+	}
+	else if ((ret = gst_rs_fec_enc_check_block_duration(rs_fec_enc)) != GST_FLOW_OK)
+	{
+		/* If the current source block has been open for too long, it is
+		 * closed before this buffer is added, which then starts the next
+		 * block. This is checked once per input buffer, so that the
+		 * fragments of a buffer are not split up by this check. */
+		gst_buffer_unref(buffer);
+	}
+	else if (rs_fec_enc->adu_size > 0)
+	{
+		/* The input buffer is part of a byte stream, which is
+		 * sliced into the new ADUs */
+		ret = gst_rs_fec_enc_slice_byte_stream(rs_fec_enc, buffer);
+	}
+	else
+	{
+		/* The input buffer is the new ADU */
+		ret = gst_rs_fec_enc_input_adu(rs_fec_enc, buffer);
+	}
+
+	return ret;
+}
+
+
+static GstFlowReturn gst_rs_fec_enc_slice_byte_stream(GstRSFECEnc *rs_fec_enc, GstBuffer *buffer)
+{
+	GstFlowReturn ret = GST_FLOW_OK;
+	gsize bufsize, offset;
+
+	/* Bytes left over from the previous buffer come first. Appending
+	 * only merges the memory blocks; the bytes are not copied. */
+	if (rs_fec_enc->pending_bytes != NULL)
+	{
+		buffer = gst_buffer_append(rs_fec_enc->pending_bytes, buffer);
+		rs_fec_enc->pending_bytes = NULL;
+	}
+
+	bufsize = gst_buffer_get_size(buffer);
+
+	/* The ADUs are sub-buffers which refer to the memory of the input
+	 * buffer. They all get the timestamps of the input buffer; the
+	 * encoder does not transmit these anyway. */
+	for (offset = 0; (bufsize - offset) >= rs_fec_enc->adu_size; offset += rs_fec_enc->adu_size)
+	{
+		GstBuffer *adu = gst_buffer_copy_region(buffer, GST_BUFFER_COPY_ALL, offset, rs_fec_enc->adu_size);
+		if ((ret = gst_rs_fec_enc_input_adu(rs_fec_enc, adu)) != GST_FLOW_OK)
+			break;
+	}
+
+	if ((ret == GST_FLOW_OK) && (offset < bufsize))
+	{
+		GST_LOG_OBJECT(rs_fec_enc, "keeping %" G_GSIZE_FORMAT " byte(s) until the next ADU is complete", bufsize - offset);
+		rs_fec_enc->pending_bytes = gst_buffer_copy_region(buffer, GST_BUFFER_COPY_ALL, offset, bufsize - offset);
+	}
+
+	gst_buffer_unref(buffer);
+
+	return ret;
+}
+
+
+static GstFlowReturn gst_rs_fec_enc_flush_pending_bytes(GstRSFECEnc *rs_fec_enc)
+{
+	GstBuffer *adu = rs_fec_enc->pending_bytes;
+
+	if (adu == NULL)
+		return GST_FLOW_OK;
+
+	rs_fec_enc->pending_bytes = NULL;
+
+	/* No more bytes will follow for a while, so the leftover
+	 * bytes are sent as a shorter ADU */
+	GST_LOG_OBJECT(rs_fec_enc, "sending %" G_GSIZE_FORMAT " leftover byte(s) as a shorter ADU", gst_buffer_get_size(adu));
+
+	return gst_rs_fec_enc_input_adu(rs_fec_enc, adu);
+}
+
+
+static GstFlowReturn gst_rs_fec_enc_input_adu(GstRSFECEnc *rs_fec_enc, GstBuffer *buffer)
+{
+	gsize bufsize;
+
+	/* The timestamp header belongs to the ADU, so it is added
+	 * before the ADU is fragmented or packed */
+	if (rs_fec_enc->transmit_timestamps)
+		buffer = gst_rs_fec_enc_add_timestamp_header(rs_fec_enc, buffer);
+
+	/* The ADU is split into fragments, which become the new ADUs */
+	if (rs_fec_enc->max_fragment_size > 0)
+		return gst_rs_fec_enc_fragment_adu(rs_fec_enc, buffer);
+
+	bufsize = gst_buffer_get_size(buffer);
+	if (bufsize > 65535)
+	{
+		GST_ELEMENT_ERROR(rs_fec_enc, STREAM, ENCODE, ("input buffer too large"), ("maximum is 65535 bytes, buffer size is %" G_GSIZE_FORMAT "; use the max-fragment-size property for larger buffers", bufsize));
+		gst_buffer_unref(buffer);
+		return GST_FLOW_ERROR;
+	}
+
+	return gst_rs_fec_enc_add_adu(rs_fec_enc, buffer, TRUE, TRUE);
+}
+
+
+static GstBuffer* gst_rs_fec_enc_add_timestamp_header(GstRSFECEnc *rs_fec_enc, GstBuffer *buffer)
+{
+	GstMemory *header;
+	GstMapInfo map_info;
+	GstClockTime pts = GST_CLOCK_TIME_NONE;
+
+	/* The PTS is transmitted as running time, since the decoder
+	 * outputs a segment of its own, which starts at 0. Buffers
+	 * outside of the segment, or from a non-TIME segment, get no
+	 * PTS. (gst_segment_to_running_time() returns
+	 * GST_CLOCK_TIME_NONE in these cases.) */
+	if (GST_BUFFER_PTS_IS_VALID(buffer) && (rs_fec_enc->input_segment.format == GST_FORMAT_TIME))
+		pts = gst_segment_to_running_time(&(rs_fec_enc->input_segment), GST_FORMAT_TIME, GST_BUFFER_PTS(buffer));
+
+	header = gst_allocator_alloc(NULL, GST_RS_FEC_TIMESTAMP_HEADER_SIZE, NULL);
+	gst_memory_map(header, &map_info, GST_MAP_WRITE);
+	gst_rs_fec_write_timestamp_header(map_info.data, pts, GST_BUFFER_DURATION(buffer));
+	gst_memory_unmap(header, &map_info);
+
+	buffer = gst_buffer_make_writable(buffer);
+	gst_buffer_prepend_memory(buffer, header);
+
+	return buffer;
+}
+
+
+static GstFlowReturn gst_rs_fec_enc_fragment_adu(GstRSFECEnc *rs_fec_enc, GstBuffer *buffer)
+{
+	GstFlowReturn ret = GST_FLOW_OK;
+	gsize bufsize = gst_buffer_get_size(buffer);
+	gsize offset;
+	guint fragment_index, num_fragments;
+
+	/* Empty buffers still produce one (empty) fragment, so the
+	 * ADU is not silently lost at the other end */
+	num_fragments = MAX((bufsize + rs_fec_enc->max_fragment_size - 1) / rs_fec_enc->max_fragment_size, 1);
+	if (num_fragments > GST_RS_FEC_MAX_NUM_FRAGMENTS)
+	{
+		GST_ELEMENT_ERROR(rs_fec_enc, STREAM, ENCODE, ("input buffer too large"), ("buffer size is %" G_GSIZE_FORMAT ", which would require %u fragments; maximum is %u", bufsize, num_fragments, GST_RS_FEC_MAX_NUM_FRAGMENTS));
+		gst_buffer_unref(buffer);
+		return GST_FLOW_ERROR;
+	}
+
+	GST_LOG_OBJECT(rs_fec_enc, "splitting ADU #%u with %" G_GSIZE_FORMAT " bytes into %u fragment(s)", rs_fec_enc->next_adu_nr, bufsize, num_fragments);
+
+	for (fragment_index = 0, offset = 0; fragment_index < num_fragments; ++fragment_index, offset += rs_fec_enc->max_fragment_size)
+	{
+		GstBuffer *fragment;
+		GstMemory *header;
+		GstMapInfo map_info;
+		gsize fragment_size = MIN(rs_fec_enc->max_fragment_size, bufsize - offset);
+		gboolean is_last_fragment = (fragment_index == (num_fragments - 1));
+
+		/* The fragment refers to the memory of the input buffer, so the
+		 * ADU bytes are not copied. It also gets the buffer's flags;
+		 * the timestamps are only copied into the first fragment. */
+		fragment = gst_buffer_copy_region(buffer, GST_BUFFER_COPY_ALL, offset, fragment_size);
+
+		header = gst_allocator_alloc(NULL, GST_RS_FEC_FRAGMENT_HEADER_SIZE, NULL);
+		gst_memory_map(header, &map_info, GST_MAP_WRITE);
+		gst_rs_fec_write_fragment_header(map_info.data, rs_fec_enc->next_adu_nr, fragment_index, is_last_fragment);
+		gst_memory_unmap(header, &map_info);
+		gst_buffer_prepend_memory(fragment, header);
+
+		if ((ret = gst_rs_fec_enc_add_adu(rs_fec_enc, fragment, fragment_index == 0, is_last_fragment)) != GST_FLOW_OK)
+			break;
+	}
+
+	rs_fec_enc->next_adu_nr = (rs_fec_enc->next_adu_nr + 1) & 0xFFFF;
+
+	gst_buffer_unref(buffer);
+
+	return ret;
+}
+
+
+static GstFlowReturn gst_rs_fec_enc_add_adu(GstRSFECEnc *rs_fec_enc, GstBuffer *buffer, gboolean starts_adu, gboolean ends_adu)
+{
+	if (rs_fec_enc->pack_size > 0)
+		return gst_rs_fec_enc_pack_adu(rs_fec_enc, buffer, starts_adu, ends_adu);
+	else
+		return gst_rs_fec_enc_handle_adu(rs_fec_enc, buffer, starts_adu, ends_adu);
+}
+
+
+static GstFlowReturn gst_rs_fec_enc_pack_adu(GstRSFECEnc *rs_fec_enc, GstBuffer *buffer, gboolean starts_adu, gboolean ends_adu)
+{
+	GstFlowReturn ret = GST_FLOW_OK;
+	GstRSFECEncFrameBoundary frame_boundary;
+	gsize entry_size = GST_RS_FEC_PACK_ENTRY_HEADER_SIZE + gst_buffer_get_size(buffer);
+	GstMemory *entry_header;
+	GstMapInfo map_info;
+	gboolean ends_frame;
+
+	if (entry_size > 65535)
+	{
+		GST_ELEMENT_ERROR(rs_fec_enc, STREAM, ENCODE, ("input buffer too large"), ("maximum is %d bytes with packing, buffer size is %" G_GSIZE_FORMAT, 65535 - GST_RS_FEC_PACK_ENTRY_HEADER_SIZE, gst_buffer_get_size(buffer)));
+		gst_buffer_unref(buffer);
+		return GST_FLOW_ERROR;
+	}
+
+	GST_OBJECT_LOCK(rs_fec_enc);
+	frame_boundary = rs_fec_enc->frame_boundary;
+	GST_OBJECT_UNLOCK(rs_fec_enc);
+
+	/* Hand over the pending pack first if this ADU does not fit in it
+	 * anymore, or if the ADU starts a new frame. Packs never straddle
+	 * frames, so the frame boundaries can be detected at the pack level
+	 * in gst_rs_fec_enc_handle_adu(). */
+	if (rs_fec_enc->pending_pack != NULL)
+	{
+		gboolean starts_frame = FALSE;
+		GstBuffer *pack = rs_fec_enc->pending_pack;
+
+		if (starts_adu)
+		{
+			switch (frame_boundary)
+			{
+				case GST_RS_FEC_ENC_FRAME_BOUNDARY_KEYFRAME:
+					starts_frame = !GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+					break;
+				case GST_RS_FEC_ENC_FRAME_BOUNDARY_PTS:
+					starts_frame = GST_BUFFER_PTS_IS_VALID(buffer) && GST_BUFFER_PTS_IS_VALID(pack) && (GST_BUFFER_PTS(buffer) != GST_BUFFER_PTS(pack));
+					break;
+				default:
+					break;
+			}
+		}
+
+		if (starts_frame || ((gst_buffer_get_size(pack) + entry_size) > rs_fec_enc->pack_size))
+		{
+			if ((ret = gst_rs_fec_enc_flush_pending_pack(rs_fec_enc)) != GST_FLOW_OK)
+			{
+				gst_buffer_unref(buffer);
+				return ret;
+			}
+		}
+	}
+
+	if (rs_fec_enc->pending_pack == NULL)
+	{
+		/* The pack gets the timestamps and flags of its first ADU */
+		rs_fec_enc->pending_pack = gst_buffer_new();
+		gst_buffer_copy_into(rs_fec_enc->pending_pack, buffer, GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+
+		/* The pack's ADUs already wait for the source block, so
+		 * max-block-duration counts from now on */
+		if ((rs_fec_enc->cur_num_adus == 0) && !GST_CLOCK_TIME_IS_VALID(rs_fec_enc->cur_block_start_time))
+			gst_rs_fec_enc_start_block_timeout(rs_fec_enc);
+	}
+	else
+	{
+		/* Combine the flags, so that unequal error protection treats the
+		 * pack like its most important ADU */
+		GstBuffer *pack = rs_fec_enc->pending_pack;
+		if (!GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT))
+			GST_BUFFER_FLAG_UNSET(pack, GST_BUFFER_FLAG_DELTA_UNIT);
+		if (GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_HEADER))
+			GST_BUFFER_FLAG_SET(pack, GST_BUFFER_FLAG_HEADER);
+		if (!GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DROPPABLE))
+			GST_BUFFER_FLAG_UNSET(pack, GST_BUFFER_FLAG_DROPPABLE);
+	}
+
+	/* Only the last fragment of an ADU can end a frame */
+	ends_frame = ends_adu && GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_MARKER);
+	if (ends_frame)
+		GST_BUFFER_FLAG_SET(rs_fec_enc->pending_pack, GST_BUFFER_FLAG_MARKER);
+	else
+		GST_BUFFER_FLAG_UNSET(rs_fec_enc->pending_pack, GST_BUFFER_FLAG_MARKER);
+
+	/* Append the entry. The ADU bytes are not copied, unless the
+	 * pack ends up with too many memory blocks. */
+	entry_header = gst_allocator_alloc(NULL, GST_RS_FEC_PACK_ENTRY_HEADER_SIZE, NULL);
+	gst_memory_map(entry_header, &map_info, GST_MAP_WRITE);
+	map_info.data[0] = ((entry_size - GST_RS_FEC_PACK_ENTRY_HEADER_SIZE) >> 8) & 0xFF;
+	map_info.data[1] = ((entry_size - GST_RS_FEC_PACK_ENTRY_HEADER_SIZE) >> 0) & 0xFF;
+	gst_memory_unmap(entry_header, &map_info);
+	gst_buffer_append_memory(rs_fec_enc->pending_pack, entry_header);
+	rs_fec_enc->pending_pack = gst_buffer_append(rs_fec_enc->pending_pack, buffer);
+
+	/* Hand over the pack right away if no further ADU fits into
+	 * it, or if its last ADU ends a frame */
+	if (((gst_buffer_get_size(rs_fec_enc->pending_pack) + GST_RS_FEC_PACK_ENTRY_HEADER_SIZE) >= rs_fec_enc->pack_size) || (ends_frame && (frame_boundary == GST_RS_FEC_ENC_FRAME_BOUNDARY_MARKER)))
+		ret = gst_rs_fec_enc_flush_pending_pack(rs_fec_enc);
+
+	return ret;
+}
+
+
+static GstFlowReturn gst_rs_fec_enc_flush_pending_pack(GstRSFECEnc *rs_fec_enc)
+{
+	GstBuffer *pack = rs_fec_enc->pending_pack;
+
+	if (pack == NULL)
+		return GST_FLOW_OK;
+
+	rs_fec_enc->pending_pack = NULL;
+
+	GST_LOG_OBJECT(rs_fec_enc, "handing over pack with %" G_GSIZE_FORMAT " bytes", gst_buffer_get_size(pack));
+
+	return gst_rs_fec_enc_handle_adu(rs_fec_enc, pack, TRUE, TRUE);
+}
+
+
+static GstFlowReturn gst_rs_fec_enc_handle_adu(GstRSFECEnc *rs_fec_enc, GstBuffer *buffer, gboolean starts_adu, gboolean ends_adu)
+{
+	GstFlowReturn ret;
+	GstBuffer *output_adu;
+	guint block_offset, esi;
+	gboolean ends_frame;
+
+	/* If this ADU starts a new frame, close the current block before
+	 * this ADU is added, which then becomes the first ADU of the next
+	 * block. Whether it ends a
+	 * frame must be determined here as well, since the buffer is
+	 * handed over to the adu_table further below. Fragments carry the
+	 * flags of their ADU, so frame boundaries are only looked for at
+	 * the first and the last fragment, respectively. */
+	if (starts_adu)
+	{
+		if (gst_rs_fec_enc_is_frame_boundary(rs_fec_enc, buffer, TRUE) && ((ret = gst_rs_fec_enc_close_block_at_frame_boundary(rs_fec_enc)) != GST_FLOW_OK))
+		{
+			gst_buffer_unref(buffer);
+			return ret;
+		}
+		rs_fec_enc->last_adu_pts = GST_BUFFER_PTS(buffer);
+	}
+	ends_frame = ends_adu && gst_rs_fec_enc_is_frame_boundary(rs_fec_enc, buffer, FALSE);
+
+	/* Likewise if this ADU would add too much padding to the block */
+	if (gst_rs_fec_enc_exceeds_max_padding_overhead(rs_fec_enc, gst_buffer_get_size(buffer)))
+	{
+		GST_LOG_OBJECT(rs_fec_enc, "ADU with %" G_GSIZE_FORMAT " bytes would exceed the maximum padding overhead - closing source block with %u ADU(s) early", gst_buffer_get_size(buffer), rs_fec_enc->cur_num_adus);
+		if ((ret = gst_rs_fec_enc_process_source_block(rs_fec_enc, TRUE)) != GST_FLOW_OK)
+		{
+			gst_buffer_unref(buffer);
+			return ret;
+		}
+	}
+
+	/* The ESI for this new ADU is derived from cur_num_adus.
+	 * The reason for this is that new ADUs shall be placed one after the
+	 * other in their source block. Without interleaving, the first ADU
+	 * gets ESI 0, the second ESI 1 etc. With interleaving, consecutive
+	 * ADUs go to consecutive blocks of the group, and the ESI only
+	 * advances once each block of the group got an ADU. cur_num_adus
+	 * therefore functions both as an index counter for the ESIs and a
+	 * value denoting the number of currently present ADUs. */
+	block_offset = rs_fec_enc->cur_num_adus % rs_fec_enc->interleave_depth;
+	esi = rs_fec_enc->cur_num_adus / rs_fec_enc->interleave_depth;
+
+	/* New numbers of source and repair symbols can only take effect
+	 * at the start of an interleaving group, since the source packets
+	 * carry k in their FEC payload ID */
+	if (rs_fec_enc->cur_num_adus == 0)
+		gst_rs_fec_enc_apply_num_symbols(rs_fec_enc);
+
+	/* Copy the ADU. This avoids actually copying the bytes themselves
+	 * unless it is deemed absolutely necessary by GStreamer.
+	 * The copy is required, because the GstBuffer is modified (an FEC
+	 * payload ID is appended prior to sending). */
+	output_adu = gst_buffer_copy(buffer);
+	if ((ret = gst_rs_fec_enc_push_adu(rs_fec_enc, output_adu, rs_fec_enc->cur_source_block_nr + block_offset, esi)) != GST_FLOW_OK)
+	{
+		gst_buffer_unref(buffer);
+		return ret;
+	}
+
+	/* The first ADU opens a new source block; from now on,
+	 * the time until its repair packets are sent counts. (With
+	 * packing, the time may already count since the pack was
+	 * started.) */
+	if ((rs_fec_enc->cur_num_adus == 0) && !GST_CLOCK_TIME_IS_VALID(rs_fec_enc->cur_block_start_time))
+		gst_rs_fec_enc_start_block_timeout(rs_fec_enc);
+
+	/* Insert the ADU into the adu_table and update the cur_max_adu_length. */
+	gst_rs_fec_enc_insert_adu(rs_fec_enc, buffer, block_offset * rs_fec_enc->num_source_symbols + esi);
+
+	/* Increment the counter _before_ processing the block below, since it
+	 * expects cur_num_adus to denote the number of inserted ADUs. */
+	rs_fec_enc->cur_num_adus++;
+
+	ret = gst_rs_fec_enc_process_source_block(rs_fec_enc, FALSE);
+
+	/* If the block is still incomplete, but this ADU ends a frame,
+	 * close the block now */
+	if ((ret == GST_FLOW_OK) && ends_frame)
+		ret = gst_rs_fec_enc_close_block_at_frame_boundary(rs_fec_enc);
+
+	return ret;
 }
 
 
@@ -508,18 +2027,22 @@ static void gst_rs_fec_enc_alloc_encoding_symbol_table(GstRSFECEnc *rs_fec_enc)
 
 	GST_DEBUG_OBJECT(
 		rs_fec_enc,
-		"allocating encoding symbol ADU table  (num encoding symbols: %u  num source symbols: %u)",
-		rs_fec_enc->num_encoding_symbols,
-		rs_fec_enc->num_source_symbols
+		"allocating encoding symbol ADU table  (max num source symbols: %u  max num repair symbols: %u)",
+		rs_fec_enc->max_source_symbols,
+		rs_fec_enc->max_repair_symbols
 	);
 
 	/* Create encoding symbol table for OpenFEC. In the table, the
 	 * source symbols must come in first, in the same order as they
 	 * are in the queue. Directly behind the source symbols, the
 	 * repair symbols are located. The memory blocks of the
-	 * individual symbols are allocated later in the function
-	 * gst_rs_fec_enc_configure_fec(). */
-	rs_fec_enc->encoding_symbol_table = g_slice_alloc0(sizeof(void *) * rs_fec_enc->num_encoding_symbols);
+	 * individual source symbols are allocated later in the function
+	 * gst_rs_fec_enc_configure_fec(), and kept in the separate
+	 * source_symbol_table. Both tables are allocated for the
+	 * maximum number of symbols, so they do not have to be
+	 * reallocated if the number of symbols changes. */
+	rs_fec_enc->encoding_symbol_table = g_slice_alloc0(sizeof(void *) * (rs_fec_enc->max_source_symbols + rs_fec_enc->max_repair_symbols));
+	rs_fec_enc->source_symbol_table = g_slice_alloc0(sizeof(void *) * rs_fec_enc->max_source_symbols);
 }
 
 
@@ -527,22 +2050,17 @@ static void gst_rs_fec_enc_free_encoding_symbol_table(GstRSFECEnc *rs_fec_enc)
 {
 	g_assert(rs_fec_enc->encoding_symbol_table != NULL);
 
-	/* Deallocate symbol memory blocks first */
-	if (rs_fec_enc->encoding_symbol_length != 0)
-	{
-		/* Deallocating the first num_source_symbols, NOT all
-		 * num_encoding_symbols. See inside the function
-		 * gst_rs_fec_enc_configure_fec() for an explanation. */
-
-		guint i;
-		for (i = 0; i < rs_fec_enc->num_source_symbols; ++i)
-			g_slice_free1(rs_fec_enc->encoding_symbol_length, rs_fec_enc->encoding_symbol_table[i]);
-	}
+	/* Deallocate symbol memory blocks first. Only the source symbols
+	 * have memory blocks of their own. See inside the function
+	 * gst_rs_fec_enc_configure_fec() for an explanation. */
+	gst_fec_symbol_arena_clear(&(rs_fec_enc->symbol_arena));
 
-	/* Then deallocate the table itself */
-	g_slice_free1(sizeof(void *) * rs_fec_enc->num_encoding_symbols, rs_fec_enc->encoding_symbol_table);
+	/* Then deallocate the tables themselves */
+	g_slice_free1(sizeof(void *) * (rs_fec_enc->max_source_symbols + rs_fec_enc->max_repair_symbols), rs_fec_enc->encoding_symbol_table);
+	g_slice_free1(sizeof(void *) * rs_fec_enc->max_source_symbols, rs_fec_enc->source_symbol_table);
 
 	rs_fec_enc->encoding_symbol_table = NULL;
+	rs_fec_enc->source_symbol_table = NULL;
 }
 
 
@@ -552,15 +2070,16 @@ static void gst_rs_fec_enc_alloc_adu_table(GstRSFECEnc *rs_fec_enc)
 
 	GST_DEBUG_OBJECT(
 		rs_fec_enc,
-		"allocating ADU table  (num source symbols: %u)",
-		rs_fec_enc->num_source_symbols
+		"allocating ADU table  (max num source symbols: %u  interleave depth: %u)",
+		rs_fec_enc->max_source_symbols,
+		rs_fec_enc->interleave_depth
 	);
 
 	/* The ADU table has entries for as many ADUs as are needed
-	 * to create a source block. This means that the ADU table
-	 * length equals num_source_symbols. Incoming ADUs are placed
-	 * in this table. */
-	rs_fec_enc->adu_table = g_slice_alloc0(sizeof(GstBuffer *) * rs_fec_enc->num_source_symbols);
+	 * to create all source blocks of an interleaving group. This
+	 * means that the ADU table length equals max_source_symbols
+	 * times interleave_depth. Incoming ADUs are placed in this table. */
+	rs_fec_enc->adu_table = g_slice_alloc0(sizeof(GstBuffer *) * rs_fec_enc->max_source_symbols * rs_fec_enc->interleave_depth);
 }
 
 
@@ -569,622 +2088,1513 @@ static void gst_rs_fec_enc_free_adu_table(GstRSFECEnc *rs_fec_enc)
 	g_assert(rs_fec_enc->adu_table != NULL);
 	/* It is assumed that any leftover ADUs have been flushed at this point */
 	g_assert(rs_fec_enc->cur_num_adus == 0);
-	g_slice_free1(sizeof(GstBuffer *) * rs_fec_enc->num_source_symbols, rs_fec_enc->adu_table);
+	g_slice_free1(sizeof(GstBuffer *) * rs_fec_enc->max_source_symbols * rs_fec_enc->interleave_depth, rs_fec_enc->adu_table);
 	rs_fec_enc->adu_table = NULL;
 }
 
 
-static void gst_rs_fec_enc_alloc_fec_repair_packet_table(GstRSFECEnc *rs_fec_enc)
-{
-	g_assert(rs_fec_enc->fec_repair_packet_table == NULL);
+static void gst_rs_fec_enc_alloc_fec_repair_packet_table(GstRSFECEnc *rs_fec_enc)
+{
+	g_assert(rs_fec_enc->fec_repair_packet_table == NULL);
+
+	if (rs_fec_enc->max_repair_symbols == 0)
+		return;
+
+	GST_DEBUG_OBJECT(
+		rs_fec_enc,
+		"allocating FEC repair packet table  (max num repair symbols: %u  interleave depth: %u)",
+		rs_fec_enc->max_repair_symbols,
+		rs_fec_enc->interleave_depth
+	);
+
+	/* The FEC repair packet table is used during the source block
+	 * processing. It is filled with GstBuffers that shall contain
+	 * the built repair symbol data and the FEC payload ID. Once
+	 * processing is done, the table will have no entries until
+	 * the next source block processing. The only reason why this
+	 * table would still be filled with packets after processing
+	 * is when an error occurred. Like the ADU table, it has room
+	 * for all source blocks of an interleaving group. */
+	rs_fec_enc->fec_repair_packet_table = g_slice_alloc0(sizeof(GstBuffer *) * rs_fec_enc->max_repair_symbols * rs_fec_enc->interleave_depth);
+	/* This array contains GstMapInfo entries for each packet.
+	 * When building symbols, OpenFEC needs access to the packet's
+	 * memory. This is only available after mapping. So keep track
+	 * of the map information to be able to  unmap after OpenFEC
+	 * has finished building symbols. */
+	rs_fec_enc->fec_repair_packet_map_infos = g_slice_alloc0(sizeof(GstMapInfo) * rs_fec_enc->max_repair_symbols * rs_fec_enc->interleave_depth);
+}
+
+
+static void gst_rs_fec_enc_free_fec_repair_packet_table(GstRSFECEnc *rs_fec_enc)
+{
+	if (rs_fec_enc->max_repair_symbols == 0)
+		return;
+
+	g_assert(rs_fec_enc->fec_repair_packet_table != NULL);
+	/* It is assumed that any leftover FEC repair packets have been flushed at this point */
+	g_assert(rs_fec_enc->cur_num_fec_repair_packets == 0);
+
+	g_slice_free1(sizeof(GstBuffer *) * rs_fec_enc->max_repair_symbols * rs_fec_enc->interleave_depth, rs_fec_enc->fec_repair_packet_table);
+	g_slice_free1(sizeof(GstMapInfo) * rs_fec_enc->max_repair_symbols * rs_fec_enc->interleave_depth, rs_fec_enc->fec_repair_packet_map_infos);
+
+	rs_fec_enc->fec_repair_packet_table = NULL;
+	rs_fec_enc->fec_repair_packet_map_infos = NULL;
+}
+
+
+static gboolean gst_rs_fec_enc_init_openfec(GstRSFECEnc *rs_fec_enc)
+{
+	of_status_t status;
+	GstRSFECEncClass *klass = GST_RS_FEC_ENC_GET_CLASS(rs_fec_enc);
+
+	/* Catch redundant calls */
+	if (rs_fec_enc->initialized)
+		return TRUE;
+
+	/* The check function posts an error message on failure */
+	if (!klass->check_settings(rs_fec_enc))
+		return FALSE;
+
+	/* Create a new OpenFEC session, necessary for the actual encoding,
+	 * unless the repair symbols are built without OpenFEC */
+	if (klass->uses_openfec_session(rs_fec_enc) && ((status = of_create_codec_instance(&(rs_fec_enc->openfec_session), klass->openfec_codec_id, OF_ENCODER, 0)) != OF_STATUS_OK))
+	{
+		GST_ERROR_OBJECT(rs_fec_enc, "could not create codec instance: %s", gst_rs_fec_enc_get_status_name(status));
+		rs_fec_enc->openfec_session = NULL;
+		CHECK_IF_FATAL_ERROR(rs_fec_enc, status);
+		return FALSE;
+	}
+
+	/* The tables are allocated for the largest number of source/repair symbols
+	 * that can be used while the session is open, so it is OK to allocate them
+	 * once. Schemes that do not support changes always use the initial ones. */
+	GST_OBJECT_LOCK(rs_fec_enc);
+	if (klass->supports_num_symbols_changes)
+	{
+		rs_fec_enc->max_source_symbols = MAX(rs_fec_enc->max_source_symbols, rs_fec_enc->num_source_symbols);
+		rs_fec_enc->max_repair_symbols = MAX(rs_fec_enc->max_repair_symbols, rs_fec_enc->num_repair_symbols);
+	}
+	else
+	{
+		rs_fec_enc->max_source_symbols = rs_fec_enc->num_source_symbols;
+		rs_fec_enc->max_repair_symbols = rs_fec_enc->num_repair_symbols;
+	}
+	rs_fec_enc->next_num_source_symbols = rs_fec_enc->num_source_symbols;
+	rs_fec_enc->next_num_repair_symbols = rs_fec_enc->num_repair_symbols;
+	rs_fec_enc->num_symbols_changed = FALSE;
+	GST_OBJECT_UNLOCK(rs_fec_enc);
+
+	/* Allocate tables here */
+	gst_rs_fec_enc_alloc_encoding_symbol_table(rs_fec_enc);
+	gst_rs_fec_enc_alloc_adu_table(rs_fec_enc);
+	gst_rs_fec_enc_alloc_fec_repair_packet_table(rs_fec_enc);
+
+	/* Pre-warm the symbol arena, so that encoding symbol lengths up
+	 * to max_symbol_length never cause any allocations later on */
+	if ((rs_fec_enc->max_symbol_length > 0) && gst_fec_symbol_arena_reserve(&(rs_fec_enc->symbol_arena), rs_fec_enc->max_source_symbols, rs_fec_enc->max_symbol_length))
+		GST_DEBUG_OBJECT(rs_fec_enc, "reserved %" G_GSIZE_FORMAT " bytes for source symbols of up to %u bytes", rs_fec_enc->symbol_arena.slab_size, rs_fec_enc->max_symbol_length);
+
+	/* Reset to zero, to make sure future encoding length computations
+	 * work correctly */
+	rs_fec_enc->encoding_symbol_length = 0;
+
+	rs_fec_enc->initialized = TRUE;
+
+	GST_INFO_OBJECT(rs_fec_enc, "OpenFEC session initialized, session: %p", (gpointer)(rs_fec_enc->openfec_session));
+
+	return TRUE;
+}
+
+
+static gboolean gst_rs_fec_enc_shutdown_openfec(GstRSFECEnc *rs_fec_enc)
+{
+	of_status_t status;
+
+	/* Catch redundant calls */
+	if (!(rs_fec_enc->initialized))
+		return TRUE;
+
+	/* No need to call gst_rs_fec_enc_flush() here, since it is
+	 * called in the PAUSED->READY state change already */
+
+	/* Deallocate the memory blocks of each symbol in the
+	 * table, and the table itself */
+	gst_rs_fec_enc_free_encoding_symbol_table(rs_fec_enc);
+
+	/* Deallocate the other tables here */
+	gst_rs_fec_enc_free_adu_table(rs_fec_enc);
+	gst_rs_fec_enc_free_fec_repair_packet_table(rs_fec_enc);
+
+	/* Set to zero, since all symbol memory blocks are deallocated now,
+	 * and any new processing would require re-computing this length.
+	 * anyway. It also helps with debugging. */
+	rs_fec_enc->encoding_symbol_length = 0;
+
+	rs_fec_enc->initialized = FALSE;
+
+	/* Release the OpenFEC session (if one was created) */
+	if ((rs_fec_enc->openfec_session != NULL) && ((status = of_release_codec_instance(rs_fec_enc->openfec_session)) != OF_STATUS_OK))
+	{
+		GST_ERROR_OBJECT(rs_fec_enc, "could not release codec instance: %s", gst_rs_fec_enc_get_status_name(status));
+		CHECK_IF_FATAL_ERROR(rs_fec_enc, status);
+		return FALSE;
+	}
+
+	/* All done */
+	rs_fec_enc->openfec_session = NULL;
+	GST_INFO_OBJECT(rs_fec_enc, "OpenFEC session shut down");
+
+	return TRUE;
+}
+
+
+static gboolean gst_rs_fec_enc_configure_fec(GstRSFECEnc *rs_fec_enc, gsize encoding_symbol_length)
+{
+	/* Here, the encoder is (re)configured by sending new parameters to OpenFEC
+	 * and (re)assigning the symbol memory blocks in the table. This is
+	 * however only done if the encoding symbol length or the number of
+	 * symbols changed, otherwise the (re)configuration is unnecessary.
+	 * The memory blocks are assigned for max_source_symbols source
+	 * symbols, so they only need to be reassigned if the encoding
+	 * symbol length changed. */
+
+	if ((rs_fec_enc->encoding_symbol_length == encoding_symbol_length) && !(rs_fec_enc->num_symbols_changed))
+	{
+		GST_LOG_OBJECT(rs_fec_enc, "encoding symbol length and number of symbols did not change -> no need to (re)configure OpenFEC encoder");
+		return TRUE;
+	}
+
+	GST_DEBUG_OBJECT(
+		rs_fec_enc,
+		"(re)configuring encoder  (code construction: %s  num source symbols: %u  num repair symbols: %u  encoding symbol length: %" G_GSIZE_FORMAT ")",
+		gst_rs_fec_code_construction_get_name(rs_fec_enc->code_construction),
+		rs_fec_enc->num_source_symbols,
+		rs_fec_enc->num_repair_symbols,
+		encoding_symbol_length
+	);
+
+	if (!GST_RS_FEC_ENC_GET_CLASS(rs_fec_enc)->configure_session(rs_fec_enc, encoding_symbol_length))
+		return FALSE;
+
+	rs_fec_enc->num_symbols_changed = FALSE;
+
+	if (rs_fec_enc->encoding_symbol_length == encoding_symbol_length)
+		return TRUE;
+
+	/* Place the memory blocks for the new encoding symbol length in the
+	 * symbol arena. This only allocates memory if the current slab is
+	 * too small for them. Only source symbols need memory blocks, since
+	 * the repair symbols are already allocated and stored in the
+	 * fec_repair_packet_table. */
+	if (gst_fec_symbol_arena_assign(&(rs_fec_enc->symbol_arena), rs_fec_enc->source_symbol_table, rs_fec_enc->max_source_symbols, encoding_symbol_length))
+		GST_DEBUG_OBJECT(rs_fec_enc, "allocated new %" G_GSIZE_FORMAT " byte slab for the source symbols", rs_fec_enc->symbol_arena.slab_size);
+
+	/* Set the new encoding symbol length */
+	rs_fec_enc->encoding_symbol_length = encoding_symbol_length;
+
+	return TRUE;
+}
+
+
+static void gst_rs_fec_enc_apply_num_symbols(GstRSFECEnc *rs_fec_enc)
+{
+	guint num_source_symbols, num_repair_symbols;
+	GstCaps *caps;
+
+	GST_OBJECT_LOCK(rs_fec_enc);
+	num_source_symbols = rs_fec_enc->next_num_source_symbols;
+	num_repair_symbols = rs_fec_enc->next_num_repair_symbols;
+	GST_OBJECT_UNLOCK(rs_fec_enc);
+
+	if ((num_source_symbols == rs_fec_enc->num_source_symbols) && (num_repair_symbols == rs_fec_enc->num_repair_symbols))
+		return;
+
+	/* The properties are set one at a time, so the combination may be
+	 * invalid for a while. Keep using the current numbers until it is
+	 * valid. (Both are within the maxima; set_property() checks that.) */
+	if (!gst_rs_fec_code_construction_check_num_symbols(rs_fec_enc->code_construction, num_source_symbols, num_repair_symbols))
+	{
+		GST_WARNING_OBJECT(
+			rs_fec_enc,
+			"%u source symbols and %u repair symbols cannot be used with code construction %s - keeping %u source and %u repair symbols",
+			num_source_symbols, num_repair_symbols,
+			gst_rs_fec_code_construction_get_name(rs_fec_enc->code_construction),
+			rs_fec_enc->num_source_symbols, rs_fec_enc->num_repair_symbols
+		);
+		return;
+	}
+
+	GST_DEBUG_OBJECT(
+		rs_fec_enc,
+		"changing number of symbols from %u source + %u repair to %u source + %u repair, starting with source block #%u",
+		rs_fec_enc->num_source_symbols, rs_fec_enc->num_repair_symbols,
+		num_source_symbols, num_repair_symbols,
+		rs_fec_enc->cur_source_block_nr
+	);
+
+	rs_fec_enc->num_source_symbols = num_source_symbols;
+	rs_fec_enc->num_repair_symbols = num_repair_symbols;
+	rs_fec_enc->num_encoding_symbols = num_source_symbols + num_repair_symbols;
+	rs_fec_enc->cur_source_block_length = num_source_symbols;
+	rs_fec_enc->cur_num_repair_symbols = num_repair_symbols;
+	/* The session is reconfigured once the next repair symbols are built */
+	rs_fec_enc->num_symbols_changed = TRUE;
+
+	/* Announce the new numbers in new caps. CAPS events are serialized, so
+	 * the decoder sees them before the packets of the new group. On the
+	 * fecrepair pad, the event has to queue up behind the repair packets of
+	 * the previous groups if these are paced or delayed. If the stream has
+	 * not started yet, gst_rs_fec_enc_push_events() sends caps with the
+	 * new numbers anyway. */
+	if (rs_fec_enc->stream_started)
+	{
+		caps = gst_rs_fec_enc_create_caps(rs_fec_enc, rs_fec_enc->fecsourcepad);
+		gst_pad_push_event(rs_fec_enc->fecsourcepad, gst_event_new_caps(caps));
+		gst_caps_unref(caps);
+
+		caps = gst_rs_fec_enc_create_caps(rs_fec_enc, rs_fec_enc->fecrepairpad);
+		gst_rs_fec_enc_push_repair_event(rs_fec_enc, gst_event_new_caps(caps));
+		gst_caps_unref(caps);
+	}
+}
+
+
+static void gst_rs_fec_enc_insert_adu(GstRSFECEnc *rs_fec_enc, GstBuffer *adu, guint index)
+{
+	gsize adu_length;
+	g_assert(adu != NULL);
+
+	/* Get the length of the given ADU, and check if it is larger than the
+	 * currently known maximum; if so, set it as the new maximum */
+	adu_length = gst_buffer_get_size(adu);
+	rs_fec_enc->cur_max_adu_length = MAX(adu_length, rs_fec_enc->cur_max_adu_length);
+	rs_fec_enc->cur_adu_bytes += adu_length;
+
+	rs_fec_enc->adu_table[index] = adu;
+
+	GST_LOG_OBJECT(
+		rs_fec_enc,
+		"ADU length: %" G_GSIZE_FORMAT " current max ADU length: %" G_GSIZE_FORMAT,
+		adu_length,
+		rs_fec_enc->cur_max_adu_length
+	);
+}
+
+
+static GstFlowReturn gst_rs_fec_enc_push_adu(GstRSFECEnc *rs_fec_enc, GstBuffer *adu, guint source_block_nr, guint esi)
+{
+	GstBuffer *fec_source_packet;
+	GstMemory *wrapped_payload_id;
+	GstFlowReturn ret;
+
+	/* Just like the length field in the ADUI, the values in the
+	 * payload ID use big endian */
+	guint8 *fec_payload_id = g_slice_alloc(FEC_PAYLOAD_ID_LENGTH);
+	gst_rs_fec_write_payload_id(fec_payload_id, GST_RS_FEC_ENC_GET_CLASS(rs_fec_enc)->get_payload_id_m(rs_fec_enc), source_block_nr, esi, rs_fec_enc->num_source_symbols);
+
+	GST_LOG_OBJECT(rs_fec_enc, "pushing ADU from source block nr %u and with ESI %u as FEC source packet downstream", source_block_nr, esi);
+
+	/* Create FEC source packet out of the ADU by appending the payload ID */
+	fec_source_packet = adu;
+	wrapped_payload_id = gst_memory_new_wrapped(
+		0,
+		fec_payload_id,
+		FEC_PAYLOAD_ID_LENGTH,
+		0,
+		FEC_PAYLOAD_ID_LENGTH,
+		fec_payload_id,
+		gst_rs_fec_enc_free_payload_id
+	);
+	gst_buffer_append_memory(fec_source_packet, wrapped_payload_id);
+
+	/* Clear timestamp and duration, since they are
+	 * useless with FEC source packets
+	 * (The source packet is a GstBuffer, which originally came
+	 * from upstream, so it still has the timestamp and duration
+	 * set by upstream) */
+	GST_BUFFER_PTS(fec_source_packet) = GST_CLOCK_TIME_NONE;
+	GST_BUFFER_DTS(fec_source_packet) = GST_CLOCK_TIME_NONE;
+	GST_BUFFER_DURATION(fec_source_packet) = GST_CLOCK_TIME_NONE;
+
+	/* Mark discontinuity at start */
+	if (rs_fec_enc->first_source_packet)
+	{
+		GST_BUFFER_FLAG_SET(fec_source_packet, GST_BUFFER_FLAG_DISCONT);
+		rs_fec_enc->first_source_packet = FALSE;
+	}
+
+	/* offset and offset_end have no meaning here */
+	GST_BUFFER_OFFSET(fec_source_packet) = -1;
+	GST_BUFFER_OFFSET_END(fec_source_packet) = -1;
+
+	/* Push STREAM_START, CAPS, SEGMENT events if necessary */
+	gst_rs_fec_enc_push_events(rs_fec_enc);
+
+	/* Send out the FEC source packet */
+	ret = gst_pad_push(rs_fec_enc->fecsourcepad, fec_source_packet);
+
+	if (ret != GST_FLOW_OK)
+		GST_DEBUG_OBJECT(rs_fec_enc, "got return value %s while pushing", gst_flow_get_name(ret));
+
+	return ret;
+}
+
+
+static void gst_rs_fec_enc_push_events(GstRSFECEnc *rs_fec_enc)
+{
+	if (!rs_fec_enc->segment_started)
+	{
+		GstEvent *event;
+		GstCaps *caps;
+		GstSegment segment;
+		gchar *stream_id;
+		guint group_id;
+
+		group_id = gst_util_group_id_next();
+		gst_segment_init(&segment, GST_FORMAT_BYTES);
+
+		if (rs_fec_enc->stream_started)
+			GST_DEBUG_OBJECT(rs_fec_enc, "pushing SEGMENT and CAPS events downstream");
+		else
+			GST_DEBUG_OBJECT(rs_fec_enc, "pushing STREAM_START, SEGMENT, and CAPS events downstream (stream-start group id: %u)", group_id);
+
+		/* push stream start, caps, segment events for source pad */
+		{
+			if (!rs_fec_enc->stream_started)
+			{
+				/* stream start */
+				stream_id = gst_pad_create_stream_id(rs_fec_enc->fecsourcepad, GST_ELEMENT_CAST(rs_fec_enc), "fecsource");
+				event = gst_event_new_stream_start(stream_id);
+				gst_event_set_group_id(event, group_id);
+				gst_pad_push_event(rs_fec_enc->fecsourcepad, event);
+				g_free(stream_id);
+
+				/* caps */
+				caps = gst_rs_fec_enc_create_caps(rs_fec_enc, rs_fec_enc->fecsourcepad);
+				event = gst_event_new_caps(caps);
+				gst_pad_push_event(rs_fec_enc->fecsourcepad, event);
+				gst_caps_unref(caps);
+			}
+
+			/* segment */
+			event = gst_event_new_segment(&segment);
+			gst_pad_push_event(rs_fec_enc->fecsourcepad, event);
+		}
+
+		/* push stream start, caps, segment events for repair pad */
+		{
+			if (!rs_fec_enc->stream_started)
+			{
+				/* stream start */
+				stream_id = gst_pad_create_stream_id(rs_fec_enc->fecrepairpad, GST_ELEMENT_CAST(rs_fec_enc), "fecrepair");
+				event = gst_event_new_stream_start(stream_id);
+				gst_event_set_group_id(event, group_id);
+				gst_pad_push_event(rs_fec_enc->fecrepairpad, event);
+				g_free(stream_id);
+
+				/* caps */
+				caps = gst_rs_fec_enc_create_caps(rs_fec_enc, rs_fec_enc->fecrepairpad);
+				event = gst_event_new_caps(caps);
+				gst_pad_push_event(rs_fec_enc->fecrepairpad, event);
+				gst_caps_unref(caps);
+			}
+
+			/* segment */
+			event = gst_event_new_segment(&segment);
+			gst_pad_push_event(rs_fec_enc->fecrepairpad, event);
+		}
+
+		rs_fec_enc->segment_started = TRUE;
+		rs_fec_enc->stream_started = TRUE;
+	}
+}
+
+
+static GstCaps* gst_rs_fec_enc_create_caps(GstRSFECEnc *rs_fec_enc, GstPad *pad)
+{
+	/* The template caps of the pad contain the FEC encoding ID. Subclasses
+	 * install their own pad templates, so this works for all schemes. */
+	GstCaps *caps = gst_caps_make_writable(gst_pad_get_pad_template_caps(pad));
+	GST_RS_FEC_ENC_GET_CLASS(rs_fec_enc)->set_caps_fields(rs_fec_enc, caps);
+	/* Fragmentation does not depend on the FEC scheme, so
+	 * it is announced here instead of in set_caps_fields */
+	if (rs_fec_enc->max_fragment_size > 0)
+		gst_caps_set_simple(caps, GST_RS_FEC_FRAGMENTED_CAPS_FIELD, G_TYPE_BOOLEAN, TRUE, NULL);
+	if (rs_fec_enc->pack_size > 0)
+		gst_caps_set_simple(caps, GST_RS_FEC_PACKED_CAPS_FIELD, G_TYPE_BOOLEAN, TRUE, NULL);
+	if (rs_fec_enc->transmit_timestamps)
+		gst_caps_set_simple(caps, GST_RS_FEC_TIMESTAMPED_CAPS_FIELD, G_TYPE_BOOLEAN, TRUE, NULL);
+	return caps;
+}
+
+
+static void gst_rs_fec_enc_discard_pending_data(GstRSFECEnc *rs_fec_enc)
+{
+	/* Unlike the ADU table, the pending pack and the pending bytes are
+	 * not flushed when a source block is done, since they belong to the
+	 * next block */
+	if (rs_fec_enc->pending_pack != NULL)
+	{
+		gst_buffer_unref(rs_fec_enc->pending_pack);
+		rs_fec_enc->pending_pack = NULL;
+	}
+	if (rs_fec_enc->pending_bytes != NULL)
+	{
+		gst_buffer_unref(rs_fec_enc->pending_bytes);
+		rs_fec_enc->pending_bytes = NULL;
+	}
+}
+
+
+static void gst_rs_fec_enc_flush_all_adus(GstRSFECEnc *rs_fec_enc)
+{
+	/* If there are any leftover ADUs, unref them here,
+	 * and set their entries in the ADU table to NULL. */
+
+	guint i;
+
+	if (rs_fec_enc->cur_num_adus == 0)
+		return;
+
+	GST_LOG_OBJECT(rs_fec_enc, "flushing %u ADUs", rs_fec_enc->cur_num_adus);
+
+	for (i = 0; i < rs_fec_enc->max_source_symbols * rs_fec_enc->interleave_depth; ++i)
+	{
+		GstBuffer *adu = rs_fec_enc->adu_table[i];
+		rs_fec_enc->adu_table[i] = NULL;
+		if (adu != NULL)
+			gst_buffer_unref(adu);
+	}
+
+	rs_fec_enc->cur_num_adus = 0;
+}
+
+
+static void gst_rs_fec_enc_flush_all_fec_repair_packets(GstRSFECEnc *rs_fec_enc)
+{
+	/* If there are any leftover FEC repair packets, unmap
+	 * and unref them here, and set their entries in the
+	 * table to NULL. */
+
+	guint i;
+
+	if (rs_fec_enc->cur_num_fec_repair_packets == 0)
+		return;
+
+	GST_LOG_OBJECT(rs_fec_enc, "flushing %u repair packets", rs_fec_enc->cur_num_fec_repair_packets);
+
+	for (i = 0; i < rs_fec_enc->max_repair_symbols * rs_fec_enc->interleave_depth; ++i)
+	{
+		GstBuffer *fec_repair_packet = rs_fec_enc->fec_repair_packet_table[i];
+		if (fec_repair_packet != NULL)
+		{
+			/* If a packet is still in the table, it implies the
+			 * GstBuffer is still mapped, so unmap it first. */
+
+			GstMapInfo *map_info = &(rs_fec_enc->fec_repair_packet_map_infos[i]);
+			g_assert(map_info != NULL);
+			gst_buffer_unmap(fec_repair_packet, map_info);
+
+			gst_buffer_unref(fec_repair_packet);
+		}
+	}
+
+	rs_fec_enc->cur_num_fec_repair_packets = 0;
+}
+
+
+static void gst_rs_fec_enc_free_payload_id(gpointer data)
+{
+	/* This function is called once a GstMemory block that
+	 * contains a FEC payload ID is deallocated */
+	g_slice_free1(FEC_PAYLOAD_ID_LENGTH, data);
+}
+
+
+static GstFlowReturn gst_rs_fec_enc_process_source_block(GstRSFECEnc *rs_fec_enc, gboolean close_partial_block)
+{
+	GstBuffer *adu;
+	guint i, block_offset;
+	GstFlowReturn ret = GST_FLOW_OK;
+	GstRSFECEncClass *klass = GST_RS_FEC_ENC_GET_CLASS(rs_fec_enc);
+
+	/* Number of the first source block of the interleaving group.
+	 * Without interleaving, the group consists of just this block. */
+	guint first_source_block_nr = rs_fec_enc->cur_source_block_nr;
+	guint interleave_depth = rs_fec_enc->interleave_depth;
+	guint num_group_repair_packets;
+
+	/* Number of ADUs in the group, and number of source blocks in the group
+	 * that contain at least one ADU. The latter is only smaller than the
+	 * interleave depth if a group is closed early. */
+	guint num_group_adus = rs_fec_enc->cur_num_adus;
+	guint num_blocks;
+
+	/* Number of repair symbols that are actually sent for each block
+	 * of the group. Less than num_repair_symbols with UEP. */
+	guint num_block_repair_symbols[MAX_INTERLEAVE_DEPTH];
+
+	/* Repair packet pacing. The repair packets of the group are sent
+	 * send_interval apart, starting at first_send_time (system clock
+	 * time). If first_send_time is GST_CLOCK_TIME_NONE, they are pushed
+	 * right away. The group's fill time is recorded here, since the
+	 * block timeout (and with it the start time) is cancelled below. */
+	GstClockTime group_start_time = rs_fec_enc->cur_block_start_time;
+	GstClockTime first_send_time, send_interval;
+	gboolean repair_pacing;
+	GstClockTime repair_delay;
+	guint num_sent_repair_packets, num_group_sent_repair_packets;
+
+	/* Reed-Solomon and RFC 6865 both require encoding symbols to be of the same
+	 * length for the same source block. encoding_symbol_length is that length.
+	 * All blocks of an interleaving group use the same length. */
+	gsize encoding_symbol_length;
+
+	if (num_group_adus == 0)
+		return GST_FLOW_OK;
+
+	if (!close_partial_block && (num_group_adus < (rs_fec_enc->num_source_symbols * interleave_depth)))
+	{
+		GST_LOG_OBJECT(rs_fec_enc, "there are not enough ADUs yet to create a source block (present: %u required: %u) - skipping", num_group_adus, rs_fec_enc->num_source_symbols * interleave_depth);
+		return GST_FLOW_OK;
+	}
+
+	/* ADUs are distributed round-robin over the blocks of the group, so if
+	 * the group is closed early with fewer ADUs than blocks, the trailing
+	 * blocks are empty. These are not processed at all, and their source
+	 * block numbers are not used. */
+	num_blocks = MIN(num_group_adus, interleave_depth);
+	num_group_repair_packets = rs_fec_enc->num_repair_symbols * num_blocks;
+
+	if (num_group_adus < (rs_fec_enc->num_source_symbols * interleave_depth))
+		GST_LOG_OBJECT(rs_fec_enc, "closing incomplete source block(s) early with %u ADU(s) - processing source blocks #%u to #%u as shortened blocks", num_group_adus, first_source_block_nr, first_source_block_nr + num_blocks - 1);
+	else if (interleave_depth > 1)
+		GST_LOG_OBJECT(rs_fec_enc, "there are enough ADUs to create an interleaving group - processing source blocks #%u to #%u", first_source_block_nr, first_source_block_nr + interleave_depth - 1);
+	else
+		GST_LOG_OBJECT(rs_fec_enc, "there are enough ADUs to create a source block - processing source block #%u", first_source_block_nr);
+
+	/* ADUIs are created by prepending 3 extra bytes to ADUs according to RFC 6865
+	 * these byates contain ADU flow identification and ADU length (in big endian)
+	 * Since ADUIs and repair symbol must be of the same size, the length of the longest
+	 * ADU+ the 3 bytes is considered the "encoding symbol length" (the FEC scheme
+	 * may round it up further) */
+	encoding_symbol_length = klass->get_encoding_symbol_length(rs_fec_enc, 1 + 2 + rs_fec_enc->cur_max_adu_length);
+	GST_LOG_OBJECT(rs_fec_enc, "using encoding symbol length of %" G_GSIZE_FORMAT " bytes for this source block", encoding_symbol_length);
+
+	gst_rs_fec_enc_update_padding_stats(rs_fec_enc, encoding_symbol_length);
+
+	/* Request encoder reconfiguration. The function takes care of checking if
+	 * a reconfiguration is really necessary (it is if the encoding symbol length
+	 * changed since last time). This makes no sense if num_repair_symbols is 0,
+	 * since then, no repair data shall be generated at all. */
+	if ((rs_fec_enc->num_repair_symbols > 0) && !gst_rs_fec_enc_configure_fec(rs_fec_enc, encoding_symbol_length))
+	{
+		GST_ERROR_OBJECT(rs_fec_enc, "reconfiguring failed");
+		ret = GST_FLOW_ERROR;
+		goto cleanup;
+	}
+
+	/* Place the source symbol memory blocks in front of the repair symbols.
+	 * This has to be done for each group, since the position of the repair
+	 * symbols in the table depends on num_source_symbols. */
+	for (i = 0; (i < rs_fec_enc->num_source_symbols) && (rs_fec_enc->num_repair_symbols > 0); ++i)
+		rs_fec_enc->encoding_symbol_table[i] = rs_fec_enc->source_symbol_table[i];
+
+	/* Push STREAM_START, CAPS, SEGMENT events if necessary */
+	gst_rs_fec_enc_push_events(rs_fec_enc);
+
+	/* Allocate buffers for the FEC repair packets of all blocks in the group */
+	for (i = 0; i < num_group_repair_packets; ++i)
+	{
+		GstBuffer *fec_repair_packet;
+		GstMapInfo *map_info;
+
+		/* Allocate buffer for the packet, and put it in the table */
+		fec_repair_packet = gst_buffer_new_allocate(NULL, encoding_symbol_length + 6, NULL);
+		rs_fec_enc->fec_repair_packet_table[i] = fec_repair_packet;
+
+		/* Retrieve corresponding map info value that shall be filled
+		 * with mapping information */
+		map_info = &(rs_fec_enc->fec_repair_packet_map_infos[i]);
+
+		/* Map the buffer. It will be unmapped later, either when a
+		 * repair packet has been fully constructed, or when
+		 * gst_rs_fec_enc_flush_all_fec_repair_packets() is called. */
+		gst_buffer_map(fec_repair_packet, map_info, GST_MAP_WRITE);
+	}
+	/* Update the counter */
+	rs_fec_enc->cur_num_fec_repair_packets = num_group_repair_packets;
+	memset(num_block_repair_symbols, 0, sizeof(num_block_repair_symbols));
+
+	/* In this block, ADUs are fed into the encoder, one source block at a time.
+	 * The encoding symbol table is reused for each block of the group. None of
+	 * these steps make any sense if num_repair_symbols is 0. */
+	for (block_offset = 0; (block_offset < num_blocks) && (rs_fec_enc->num_repair_symbols > 0); ++block_offset)
+	{
+		GstBuffer **block_adus = rs_fec_enc->adu_table + block_offset * rs_fec_enc->num_source_symbols;
+		GstMapInfo *block_map_infos = rs_fec_enc->fec_repair_packet_map_infos + block_offset * rs_fec_enc->num_repair_symbols;
+
+		/* Subclasses may want to know which block they are building
+		 * repair symbols for, so let cur_source_block_nr refer to it */
+		rs_fec_enc->cur_source_block_nr = first_source_block_nr + block_offset;
+
+		/* Number of ADUs in this block. Block #b of the group received
+		 * the ADUs #b, #b+D, #b+2D ... of the group (D = interleave depth). */
+		rs_fec_enc->cur_source_block_length = (num_group_adus + interleave_depth - 1 - block_offset) / interleave_depth;
+
+		/* If this block is shortened, the source symbols past its end are
+		 * all-zero symbols. They are never transmitted; the decoder recreates
+		 * them once it sees the shortened block length in a repair packet. */
+		for (i = rs_fec_enc->cur_source_block_length; i < rs_fec_enc->num_source_symbols; ++i)
+			memset(rs_fec_enc->encoding_symbol_table[i], 0, encoding_symbol_length);
+
+		/* Pick the number of repair symbols to send for this block. This
+		 * must happen while the ADUs are still in the table, since their
+		 * flags determine the block's priority with UEP. It also must
+		 * happen for each block right before its repair symbols are built,
+		 * since the bitrate budget is taken from a token bucket. */
+		num_block_repair_symbols[block_offset] = gst_rs_fec_enc_select_num_repair_symbols(rs_fec_enc, block_adus, rs_fec_enc->cur_source_block_length, encoding_symbol_length);
+		rs_fec_enc->cur_num_repair_symbols = num_block_repair_symbols[block_offset];
+
+		/* Convert ADUs into ADUIs, and put them into the encoding symbol table for the
+		 * OpenFEC Reed-Solomon encoder */
+		for (i = 0; i < rs_fec_enc->cur_source_block_length; ++i)
+		{
+			guint8 *adui_memblock;
+			gsize padding;
+			gsize adu_length;
+			guint adu_flow_id = 0; /* XXX: Currently, only one flow (flow 0) is supported */
+
+			/* Get the ADU from the table. Since the ADU will not
+			 * be needed in the table anymore, set its entry to NULL.
+			 * It is pushed downstream, so no need to unref it either. */
+			g_assert(rs_fec_enc->cur_num_adus > 0);
+			adu = block_adus[i];
+			adu_length = gst_buffer_get_size(adu);
+			block_adus[i] = NULL;
+			rs_fec_enc->cur_num_adus--;
+
+			g_assert((adu_length + 3) <= encoding_symbol_length);
+
+			/* Get the corresponding entry from the symbol table */
+			adui_memblock = rs_fec_enc->encoding_symbol_table[i];
+
+			/* Prepend the extra 3 bytes to the ADU and add padding,
+			 * converting it into an ADUI */
+			/* ADU flow ID, one byte */
+			adui_memblock[0] = adu_flow_id;
+			/* Length of ADU, 16-bit big endian unsigned integer */
+			adui_memblock[1] = (adu_length & 0xFF00) >> 8;
+			adui_memblock[2] = (adu_length & 0x00FF);
+			/* The ADU itself */
+			gst_buffer_extract(adu, 0, adui_memblock + 3, adu_length);
+			/* Padding in case this ADU is not the longest one */
+			padding = encoding_symbol_length - 3 - adu_length;
+			if (padding > 0)
+				memset(adui_memblock + 3 + adu_length, 0, padding);
+
+			/* ADU is not needed anymore, discard */
+			gst_buffer_unref(adu);
+
+			GST_LOG_OBJECT(rs_fec_enc, "preparing ADU #%u in source block #%u for encoder:  flow ID: %u  length: %" G_GSIZE_FORMAT " bytes  padding: %" G_GSIZE_FORMAT " bytes", i, rs_fec_enc->cur_source_block_nr, adu_flow_id, adu_length, padding);
+		}
+
+		/* Store the pointers to the regions in the mapped buffer data blocks
+		 * where the encoding symbols of this block shall be constructed and
+		 * stored. The first 6 bytes are reserved for the FEC payload ID, so
+		 * apply an offset. */
+		for (i = 0; i < rs_fec_enc->num_repair_symbols; ++i)
+			rs_fec_enc->encoding_symbol_table[rs_fec_enc->num_source_symbols + i] = block_map_infos[i].data + 6;
+
+		/* Build the repair symbols. They are written directly into
+		 * the mapped FEC repair packets. */
+		if ((rs_fec_enc->cur_num_repair_symbols > 0) && !klass->build_repair_symbols(rs_fec_enc, encoding_symbol_length))
+		{
+			ret = GST_FLOW_ERROR;
+			goto cleanup;
+		}
+	}
+
+	/* Work out when the repair packets shall be sent. With pacing, the
+	 * time it took to fill this group is the estimate for the duration
+	 * of the next group, so spreading the packets over that time keeps
+	 * the repair flow as smooth as the source flow. */
+	GST_OBJECT_LOCK(rs_fec_enc);
+	repair_pacing = rs_fec_enc->repair_pacing;
+	repair_delay = rs_fec_enc->repair_delay;
+	GST_OBJECT_UNLOCK(rs_fec_enc);
+
+	num_group_sent_repair_packets = 0;
+	for (block_offset = 0; block_offset < num_blocks; ++block_offset)
+		num_group_sent_repair_packets += num_block_repair_symbols[block_offset];
+
+	first_send_time = GST_CLOCK_TIME_NONE;
+	send_interval = 0;
+	if (repair_pacing || (repair_delay > 0))
+	{
+		GstClockTime now = gst_clock_get_time(rs_fec_enc->system_clock);
+
+		first_send_time = now + repair_delay;
+		if (repair_pacing && GST_CLOCK_TIME_IS_VALID(group_start_time) && (now > group_start_time) && (num_group_sent_repair_packets > 0))
+			send_interval = (now - group_start_time) / num_group_sent_repair_packets;
+
+		GST_LOG_OBJECT(rs_fec_enc, "sending %u repair packet(s) starting at %" GST_TIME_FORMAT " with an interval of %" GST_TIME_FORMAT, num_group_sent_repair_packets, GST_TIME_ARGS(first_send_time), GST_TIME_ARGS(send_interval));
+	}
+
+	/* Always store the interval of this group, even if none could be
+	 * computed (then it is 0), so additional repair packets are never
+	 * paced with the interval of an older group */
+	rs_fec_enc->repair_send_interval = send_interval;
+
+	/* Send the repair symbols out as FEC repair packets. With interleaving,
+	 * the first repair packet of each block in the group is sent, then the
+	 * second one of each block etc. */
+	num_sent_repair_packets = 0;
+	for (i = 0; i < num_group_repair_packets; ++i)
+	{
+		guint repair_index = i / num_blocks;
+		guint table_index;
+		guint source_block_length;
+		guint esi = repair_index + rs_fec_enc->num_source_symbols; /* ESI = encoding symbol ID */
+		guint source_block_nr;
+		GstBuffer *fec_repair_packet;
+		GstMapInfo *map_info;
+
+		block_offset = i % num_blocks;
+		source_block_nr = first_source_block_nr + block_offset;
+		source_block_length = (num_group_adus + interleave_depth - 1 - block_offset) / interleave_depth;
+		table_index = block_offset * rs_fec_enc->num_repair_symbols + repair_index;
+
+		/* Repair packets that are not sent for this block are left in
+		 * the table, and discarded by the flush during cleanup */
+		if (repair_index >= num_block_repair_symbols[block_offset])
+			continue;
+
+		fec_repair_packet = rs_fec_enc->fec_repair_packet_table[table_index];
+		map_info = &(rs_fec_enc->fec_repair_packet_map_infos[table_index]);
+
+		/* Build the FEC payload ID */
+
+		/* Just like the length field in the ADUI, the values in the
+		 * payload ID use big endian. The source block length field
+		 * contains the actual number of ADUs in the block, which is
+		 * less than k if the block is shortened. The ESIs of the
+		 * repair symbols still start at k. */
+		gst_rs_fec_write_payload_id(map_info->data, klass->get_payload_id_m(rs_fec_enc), source_block_nr, esi, source_block_length);
+
+		GST_LOG_OBJECT(rs_fec_enc, "pushing FEC repair packet:  source block nr: %u  ESI: %u  source block length: %u", source_block_nr, esi, source_block_length);
+
+		/* No more write access is needed, so unmap the buffer */
+		gst_buffer_unmap(fec_repair_packet, map_info);
+
+		/* This FEC repair packet is finished and ready to be pushed
+		 * downstream. Remove it from the table, and decrement the
+		 * cur_num_fec_repair_packets counter. */
+		rs_fec_enc->fec_repair_packet_table[table_index] = NULL;
+		g_assert(rs_fec_enc->cur_num_fec_repair_packets > 0);
+		rs_fec_enc->cur_num_fec_repair_packets--;
+
+		/* Mark discontinuity at start */
+		if (rs_fec_enc->first_repair_packet)
+		{
+			GST_BUFFER_FLAG_SET(fec_repair_packet, GST_BUFFER_FLAG_DISCONT);
+			rs_fec_enc->first_repair_packet = FALSE;
+		}
+
+		/* offset and offset_end have no meaning here */
+		GST_BUFFER_OFFSET(fec_repair_packet) = -1;
+		GST_BUFFER_OFFSET_END(fec_repair_packet) = -1;
+
+		/* Send out the FEC repair packet, or queue it for sending later */
+		ret = gst_rs_fec_enc_push_repair_packet(rs_fec_enc, fec_repair_packet, GST_CLOCK_TIME_IS_VALID(first_send_time) ? (first_send_time + num_sent_repair_packets * send_interval) : GST_CLOCK_TIME_NONE);
+		num_sent_repair_packets++;
+		if (ret != GST_FLOW_OK)
+			goto cleanup;
+	}
+
+	GST_LOG_OBJECT(rs_fec_enc, "finished processing source block #%u", first_source_block_nr + num_blocks - 1);
+
+	/* After successfully processing the source blocks
+	 * of this group, continue with the next group */
+	rs_fec_enc->cur_source_block_nr = first_source_block_nr + num_blocks;
+
+cleanup:
+	/* Cleanup any leftover data in case an error occurred
+	 * and not all ADUs and/or repair packets were processed above */
+	if (ret != GST_FLOW_OK)
+		rs_fec_enc->cur_source_block_nr = first_source_block_nr;
+	gst_rs_fec_enc_flush_all_adus(rs_fec_enc);
+	gst_rs_fec_enc_flush_all_fec_repair_packets(rs_fec_enc);
+	rs_fec_enc->cur_max_adu_length = 0;
+	rs_fec_enc->cur_adu_bytes = 0;
+	rs_fec_enc->cur_source_block_length = rs_fec_enc->num_source_symbols;
+	rs_fec_enc->cur_num_repair_symbols = rs_fec_enc->num_repair_symbols;
+
+	/* The group is done, so its timeout is not needed anymore. The next
+	 * ADU starts a new group, which will schedule a new timeout. */
+	gst_rs_fec_enc_cancel_block_timeout(rs_fec_enc);
+
+	return ret;
+}
+
+
+static void gst_rs_fec_enc_start_block_timeout(GstRSFECEnc *rs_fec_enc)
+{
+	GstClockTime max_block_duration;
+
+	GST_OBJECT_LOCK(rs_fec_enc);
+	max_block_duration = rs_fec_enc->max_block_duration;
+	GST_OBJECT_UNLOCK(rs_fec_enc);
+
+	/* The start time is recorded even if no maximum duration is set,
+	 * since the property can be changed while the block is open */
+	rs_fec_enc->cur_block_start_time = gst_clock_get_time(rs_fec_enc->system_clock);
+
+	if (max_block_duration > 0)
+		gst_rs_fec_enc_schedule_block_timeout(rs_fec_enc, rs_fec_enc->cur_block_start_time + max_block_duration);
+}
+
+
+static void gst_rs_fec_enc_schedule_block_timeout(GstRSFECEnc *rs_fec_enc, GstClockTime timeout)
+{
+	GstClockID clock_id, old_clock_id;
+
+	clock_id = gst_clock_new_single_shot_id(rs_fec_enc->system_clock, timeout);
+
+	GST_OBJECT_LOCK(rs_fec_enc);
+	old_clock_id = rs_fec_enc->block_timeout_clock_id;
+	rs_fec_enc->block_timeout_clock_id = gst_clock_id_ref(clock_id);
+	GST_OBJECT_UNLOCK(rs_fec_enc);
 
-	if (rs_fec_enc->num_repair_symbols == 0)
-		return;
+	if (old_clock_id != NULL)
+	{
+		gst_clock_id_unschedule(old_clock_id);
+		gst_clock_id_unref(old_clock_id);
+	}
 
-	GST_DEBUG_OBJECT(
-		rs_fec_enc,
-		"allocating FEC repair packet table  (num repair symbols: %u)",
-		rs_fec_enc->num_repair_symbols
-	);
+	/* The callback holds a reference to the element, to make sure it
+	 * is not finalized while the timeout is still pending */
+	gst_clock_id_wait_async(clock_id, gst_rs_fec_enc_block_timeout_cb, gst_object_ref(rs_fec_enc), (GDestroyNotify)gst_object_unref);
+	gst_clock_id_unref(clock_id);
 
-	/* The FEC repair packet table is used during the source block
-	 * processing. It is filled with GstBuffers that shall contain
-	 * the built repair symbol data and the FEC payload ID. Once
-	 * processing is done, the table will have no entries until
-	 * the next source block processing. The only reason why this
-	 * table would still be filled with packets after processing
-	 * is when an error occurred. */
-	rs_fec_enc->fec_repair_packet_table = g_slice_alloc0(sizeof(GstBuffer *) * rs_fec_enc->num_repair_symbols);
-	/* This array contains GstMapInfo entries for each packet.
-	 * When building symbols, OpenFEC needs access to the packet's
-	 * memory. This is only available after mapping. So keep track
-	 * of the map information to be able to  unmap after OpenFEC
-	 * has finished building symbols. */
-	rs_fec_enc->fec_repair_packet_map_infos = g_slice_alloc0(sizeof(GstMapInfo) * rs_fec_enc->num_repair_symbols);
+	GST_LOG_OBJECT(rs_fec_enc, "scheduled block timeout at %" GST_TIME_FORMAT, GST_TIME_ARGS(timeout));
 }
 
 
-static void gst_rs_fec_enc_free_fec_repair_packet_table(GstRSFECEnc *rs_fec_enc)
+static void gst_rs_fec_enc_cancel_block_timeout(GstRSFECEnc *rs_fec_enc)
 {
-	if (rs_fec_enc->num_repair_symbols == 0)
-		return;
+	GstClockID clock_id;
 
-	g_assert(rs_fec_enc->fec_repair_packet_table != NULL);
-	/* It is assumed that any leftover FEC repair packets have been flushed at this point */
-	g_assert(rs_fec_enc->cur_num_fec_repair_packets == 0);
+	GST_OBJECT_LOCK(rs_fec_enc);
+	clock_id = rs_fec_enc->block_timeout_clock_id;
+	rs_fec_enc->block_timeout_clock_id = NULL;
+	GST_OBJECT_UNLOCK(rs_fec_enc);
 
-	g_slice_free1(sizeof(GstBuffer *) * rs_fec_enc->num_repair_symbols, rs_fec_enc->fec_repair_packet_table);
-	g_slice_free1(sizeof(GstBuffer *) * rs_fec_enc->num_repair_symbols, rs_fec_enc->fec_repair_packet_map_infos);
+	if (clock_id != NULL)
+	{
+		gst_clock_id_unschedule(clock_id);
+		gst_clock_id_unref(clock_id);
+	}
 
-	rs_fec_enc->fec_repair_packet_table = NULL;
-	rs_fec_enc->fec_repair_packet_map_infos = NULL;
+	rs_fec_enc->cur_block_start_time = GST_CLOCK_TIME_NONE;
 }
 
 
-static gboolean gst_rs_fec_enc_init_openfec(GstRSFECEnc *rs_fec_enc)
+static gboolean gst_rs_fec_enc_block_timeout_cb(G_GNUC_UNUSED GstClock *clock, G_GNUC_UNUSED GstClockTime time, GstClockID id, gpointer user_data)
 {
-	of_status_t status;
+	GstRSFECEnc *rs_fec_enc = GST_RS_FEC_ENC(user_data);
+	gboolean is_current;
+
+	/* This is called from the clock's thread. The ADU table and the repair
+	 * packet table are owned by the streaming thread, so the stream lock
+	 * must be held while processing the block. It is not waited for though,
+	 * since the streaming thread may in turn be trying to cancel this very
+	 * timeout. Instead, if the lock is held, the timeout is retried shortly. */
+	if (!g_rec_mutex_trylock(GST_PAD_GET_STREAM_LOCK(rs_fec_enc->sinkpad)))
+	{
+		GST_OBJECT_LOCK(rs_fec_enc);
+		is_current = (rs_fec_enc->block_timeout_clock_id == id);
+		GST_OBJECT_UNLOCK(rs_fec_enc);
 
-	/* Catch redundant calls */
-	if (rs_fec_enc->openfec_session != NULL)
-		return TRUE;
+		if (is_current)
+		{
+			GST_LOG_OBJECT(rs_fec_enc, "block timeout fired while streaming thread is busy - retrying");
+			gst_rs_fec_enc_schedule_block_timeout(rs_fec_enc, gst_clock_get_time(rs_fec_enc->system_clock) + BLOCK_TIMEOUT_RETRY_INTERVAL);
+		}
 
-	/* Create a new OpenFEC session, necessary for the actual encoding */
-	if ((status = of_create_codec_instance(&(rs_fec_enc->openfec_session), OF_CODEC_REED_SOLOMON_GF_2_8_STABLE, OF_ENCODER, 0)) != OF_STATUS_OK)
-	{
-		GST_ERROR_OBJECT(rs_fec_enc, "could not create codec instance: %s", gst_rs_fec_enc_get_status_name(status));
-		rs_fec_enc->openfec_session = NULL;
-		CHECK_IF_FATAL_ERROR(rs_fec_enc, status);
-		return FALSE;
+		return TRUE;
 	}
 
-	/* NOTE: This element does not allow changes to the number of source/repair
-	 * symbols once an OpenFEC session is open, so it is OK to allocate the tables
-	 * once */
-
-	/* Allocate tables here */
-	gst_rs_fec_enc_alloc_encoding_symbol_table(rs_fec_enc);
-	gst_rs_fec_enc_alloc_adu_table(rs_fec_enc);
-	gst_rs_fec_enc_alloc_fec_repair_packet_table(rs_fec_enc);
+	/* The timeout may have been cancelled or replaced while waiting */
+	GST_OBJECT_LOCK(rs_fec_enc);
+	is_current = (rs_fec_enc->block_timeout_clock_id == id);
+	GST_OBJECT_UNLOCK(rs_fec_enc);
 
-	/* Reset to zero, to make sure future encoding length computations
-	 * work correctly */
-	rs_fec_enc->encoding_symbol_length = 0;
+	if (is_current && !rs_fec_enc->eos_received && ((rs_fec_enc->cur_num_adus > 0) || (rs_fec_enc->pending_pack != NULL)))
+	{
+		GST_DEBUG_OBJECT(rs_fec_enc, "max block duration exceeded - closing incomplete source block early");
+		gst_rs_fec_enc_close_incomplete_block(rs_fec_enc);
+	}
 
-	GST_INFO_OBJECT(rs_fec_enc, "OpenFEC session initialized, session: %p", (gpointer)(rs_fec_enc->openfec_session));
+	GST_PAD_STREAM_UNLOCK(rs_fec_enc->sinkpad);
 
 	return TRUE;
 }
 
 
-static gboolean gst_rs_fec_enc_shutdown_openfec(GstRSFECEnc *rs_fec_enc)
+static GstFlowReturn gst_rs_fec_enc_check_block_duration(GstRSFECEnc *rs_fec_enc)
 {
-	of_status_t status;
+	GstClockTime max_block_duration;
 
-	/* Catch redundant calls */
-	if (rs_fec_enc->openfec_session == NULL)
-		return TRUE;
+	/* The timeout callback may not have been able to close the block yet
+	 * (or no timeout was scheduled because the property was changed after
+	 * the block was opened), so check the duration here as well */
 
-	/* No need to call gst_rs_fec_enc_flush() here, since it is
-	 * called in the PAUSED->READY state change already */
+	if (((rs_fec_enc->cur_num_adus == 0) && (rs_fec_enc->pending_pack == NULL)) || !GST_CLOCK_TIME_IS_VALID(rs_fec_enc->cur_block_start_time))
+		return GST_FLOW_OK;
 
-	/* Deallocate the memory blocks of each symbol in the
-	 * table, and the table itself */
-	gst_rs_fec_enc_free_encoding_symbol_table(rs_fec_enc);
+	GST_OBJECT_LOCK(rs_fec_enc);
+	max_block_duration = rs_fec_enc->max_block_duration;
+	GST_OBJECT_UNLOCK(rs_fec_enc);
 
-	/* Deallocate the other tables here */
-	gst_rs_fec_enc_free_adu_table(rs_fec_enc);
-	gst_rs_fec_enc_free_fec_repair_packet_table(rs_fec_enc);
+	if ((max_block_duration == 0) || ((gst_clock_get_time(rs_fec_enc->system_clock) - rs_fec_enc->cur_block_start_time) < max_block_duration))
+		return GST_FLOW_OK;
 
-	/* Set to zero, since all symbol memory blocks are deallocated now,
-	 * and any new processing would require re-computing this length.
-	 * anyway. It also helps with debugging. */
-	rs_fec_enc->encoding_symbol_length = 0;
+	GST_DEBUG_OBJECT(rs_fec_enc, "max block duration exceeded - closing incomplete source block early");
+	return gst_rs_fec_enc_close_incomplete_block(rs_fec_enc);
+}
 
-	/* Release the OpenFEC session */
-	if ((status = of_release_codec_instance(rs_fec_enc->openfec_session)) != OF_STATUS_OK)
-	{
-		GST_ERROR_OBJECT(rs_fec_enc, "could not release codec instance: %s", gst_rs_fec_enc_get_status_name(status));
-		CHECK_IF_FATAL_ERROR(rs_fec_enc, status);
-		return FALSE;
-	}
 
-	/* All done */
-	rs_fec_enc->openfec_session = NULL;
-	GST_INFO_OBJECT(rs_fec_enc, "OpenFEC session shut down");
+static GstFlowReturn gst_rs_fec_enc_close_incomplete_block(GstRSFECEnc *rs_fec_enc)
+{
+	GstFlowReturn ret;
 
-	return TRUE;
+	/* The ADUs of the pending pack belong to this block as well. Handing
+	 * over the pack may complete the block, in which case there is
+	 * nothing left to close. */
+	if ((ret = gst_rs_fec_enc_flush_pending_pack(rs_fec_enc)) != GST_FLOW_OK)
+		return ret;
+
+	if (rs_fec_enc->cur_num_adus == 0)
+		return GST_FLOW_OK;
+
+	return gst_rs_fec_enc_process_source_block(rs_fec_enc, TRUE);
 }
 
 
-static gboolean gst_rs_fec_enc_configure_fec(GstRSFECEnc *rs_fec_enc, gsize encoding_symbol_length)
+static gboolean gst_rs_fec_enc_is_frame_boundary(GstRSFECEnc *rs_fec_enc, GstBuffer *adu, gboolean before_adu)
 {
-	/* Here, the encoder is (re)configured by sending new parameters to OpenFEC
-	 * and (re)allocating the symbol memory blocks in the table. This is
-	 * however only done if the encoding symbol length changed, otherwise
-	 * the (re)configuration is unnecessary.
-	 *
-	 * NOTE: this means that num_source_symbols and num_repair_symbols remain
-	 * constant; encoding_symbol_length is the only variable. Also see the
-	 * checks in the PROP_NUM_SOURCE_SYMBOLS and PROP_NUM_REPAIR_SYMBOLS cases
-	 * in the set_property() switch for more. */
+	GstRSFECEncFrameBoundary frame_boundary;
 
-	of_status_t status;
-	of_rs_parameters_t params;
-	guint i;
+	GST_OBJECT_LOCK(rs_fec_enc);
+	frame_boundary = rs_fec_enc->frame_boundary;
+	GST_OBJECT_UNLOCK(rs_fec_enc);
 
-	if (rs_fec_enc->encoding_symbol_length == encoding_symbol_length)
+	/* If before_adu is TRUE, this checks if a frame boundary lies between
+	 * the previous ADU and the given one (that is, the ADU starts a new
+	 * frame). Otherwise, it checks if the boundary lies right after the
+	 * given ADU (that is, the ADU ends a frame). */
+	switch (frame_boundary)
 	{
-		GST_LOG_OBJECT(rs_fec_enc, "encoding symbol length did not change -> no need to (re)configure OpenFEC encoder");
-		return TRUE;
-	}
+		case GST_RS_FEC_ENC_FRAME_BOUNDARY_MARKER:
+			return !before_adu && GST_BUFFER_FLAG_IS_SET(adu, GST_BUFFER_FLAG_MARKER);
 
-	GST_DEBUG_OBJECT(
-		rs_fec_enc,
-		"(re)configuring OpenFEC encoder  (num source symbols: %u  num repair symbols: %u  encoding symbol length: %" G_GSIZE_FORMAT ")",
-		rs_fec_enc->num_source_symbols,
-		rs_fec_enc->num_repair_symbols,
-		encoding_symbol_length
-	);
+		case GST_RS_FEC_ENC_FRAME_BOUNDARY_KEYFRAME:
+			return before_adu && !GST_BUFFER_FLAG_IS_SET(adu, GST_BUFFER_FLAG_DELTA_UNIT);
 
-	memset(&params, 0, sizeof(params));
-	params.nb_source_symbols = rs_fec_enc->num_source_symbols;
-	params.nb_repair_symbols = rs_fec_enc->num_repair_symbols;
-	params.encoding_symbol_length = encoding_symbol_length;
+		case GST_RS_FEC_ENC_FRAME_BOUNDARY_PTS:
+			/* ADUs without a PTS belong to the current frame */
+			return before_adu && GST_BUFFER_PTS_IS_VALID(adu) && GST_CLOCK_TIME_IS_VALID(rs_fec_enc->last_adu_pts) && (GST_BUFFER_PTS(adu) != rs_fec_enc->last_adu_pts);
 
-	/* Instruct the OpenFEC session to (re)configure itself */
-	if ((status = of_set_fec_parameters(rs_fec_enc->openfec_session, (of_parameters_t *)(&params))) != OF_STATUS_OK)
-	{
-		GST_ERROR_OBJECT(rs_fec_enc, "could not set FEC parameters: %s", gst_rs_fec_enc_get_status_name(status));
-		CHECK_IF_FATAL_ERROR(rs_fec_enc, status);
-		return FALSE;
+		default:
+			return FALSE;
 	}
+}
 
-	/* Deallocate any existing symbol memory blocks, but do NOT deallocate the
-	 * table itself (unlike in gst_rs_fec_enc_free_encoding_symbol_table() ),
-	 * since it is still needed. */
-	if (rs_fec_enc->encoding_symbol_length != 0)
-	{
-		/* Deallocating the first num_source_symbols, NOT all
-		 * num_encoding_symbols. See below for a reason why. */
-		for (i = 0; i < rs_fec_enc->num_source_symbols; ++i)
-			g_slice_free1(rs_fec_enc->encoding_symbol_length, rs_fec_enc->encoding_symbol_table[i]);
-	}
 
-	/* Allocate a new set of memory blocks with the new encoding symbol length each.
-	 * Only allocate num_source_symbols, since the repair symbols are already
-	 * allocated and stored in the fec_repair_packet_table. */
-	for (i = 0; i < rs_fec_enc->num_source_symbols; ++i)
-		rs_fec_enc->encoding_symbol_table[i] = g_slice_alloc(encoding_symbol_length);
+static GstFlowReturn gst_rs_fec_enc_close_block_at_frame_boundary(GstRSFECEnc *rs_fec_enc)
+{
+	guint min_source_symbols;
 
-	/* Set the new encoding symbol length */
-	rs_fec_enc->encoding_symbol_length = encoding_symbol_length;
+	GST_OBJECT_LOCK(rs_fec_enc);
+	min_source_symbols = rs_fec_enc->min_source_symbols;
+	GST_OBJECT_UNLOCK(rs_fec_enc);
 
-	return TRUE;
+	/* With interleaving, ADUs are distributed round-robin, so each
+	 * block of the group has at least cur_num_adus / D ADUs */
+	if ((rs_fec_enc->cur_num_adus == 0) || (rs_fec_enc->cur_num_adus < (min_source_symbols * rs_fec_enc->interleave_depth)))
+		return GST_FLOW_OK;
+
+	GST_LOG_OBJECT(rs_fec_enc, "frame boundary detected - closing source block with %u ADU(s) early", rs_fec_enc->cur_num_adus);
+	return gst_rs_fec_enc_process_source_block(rs_fec_enc, TRUE);
 }
 
 
-static void gst_rs_fec_enc_insert_adu(GstRSFECEnc *rs_fec_enc, GstBuffer *adu, guint esi)
+static gboolean gst_rs_fec_enc_exceeds_max_padding_overhead(GstRSFECEnc *rs_fec_enc, gsize adu_length)
 {
-	gsize adu_length;
-	g_assert(adu != NULL);
+	guint max_padding_overhead, min_source_symbols;
+	guint64 num_adus, max_adui_length, num_symbol_bytes, num_padding_bytes;
 
-	/* Get the length of the given ADU, and check if it is larger than the
-	 * currently known maximum; if so, set it as the new maximum */
-	adu_length = gst_buffer_get_size(adu);
-	rs_fec_enc->cur_max_adu_length = MAX(adu_length, rs_fec_enc->cur_max_adu_length);
+	GST_OBJECT_LOCK(rs_fec_enc);
+	max_padding_overhead = rs_fec_enc->max_padding_overhead;
+	min_source_symbols = rs_fec_enc->min_source_symbols;
+	GST_OBJECT_UNLOCK(rs_fec_enc);
+
+	if ((max_padding_overhead == 0) || (rs_fec_enc->cur_num_adus == 0) || (rs_fec_enc->cur_num_adus < (min_source_symbols * rs_fec_enc->interleave_depth)))
+		return FALSE;
 
-	rs_fec_enc->adu_table[esi] = adu;
+	/* Padding of the group if the ADU were added to it. Each ADUI is
+	 * padded up to the longest ADUI of the group. Any rounding of the
+	 * encoding symbol length by the FEC scheme is not included, since
+	 * it does not depend on how the blocks are formed. */
+	num_adus = rs_fec_enc->cur_num_adus + 1;
+	max_adui_length = 1 + 2 + MAX(rs_fec_enc->cur_max_adu_length, adu_length);
+	num_symbol_bytes = num_adus * max_adui_length;
+	num_padding_bytes = num_symbol_bytes - (num_adus * (1 + 2) + rs_fec_enc->cur_adu_bytes + adu_length);
 
-	GST_LOG_OBJECT(
-		rs_fec_enc,
-		"ADU length: %" G_GSIZE_FORMAT " current max ADU length: %" G_GSIZE_FORMAT,
-		adu_length,
-		rs_fec_enc->cur_max_adu_length
-	);
+	return (num_padding_bytes * 100) > (num_symbol_bytes * max_padding_overhead);
 }
 
 
-static GstFlowReturn gst_rs_fec_enc_push_adu(GstRSFECEnc *rs_fec_enc, GstBuffer *adu, guint esi)
+static void gst_rs_fec_enc_update_padding_stats(GstRSFECEnc *rs_fec_enc, gsize encoding_symbol_length)
 {
-	GstBuffer *fec_source_packet;
-	GstMemory *wrapped_payload_id;
-	GstFlowReturn ret;
+	guint64 num_symbol_bytes = (guint64)(rs_fec_enc->cur_num_adus) * encoding_symbol_length;
+	guint64 num_padding_bytes = num_symbol_bytes - ((guint64)(rs_fec_enc->cur_num_adus) * (1 + 2) + rs_fec_enc->cur_adu_bytes);
 
-	/* Incremental counter for source block nr */
-	guint source_block_nr = rs_fec_enc->cur_source_block_nr;
+	GST_OBJECT_LOCK(rs_fec_enc);
+	rs_fec_enc->num_symbol_bytes += num_symbol_bytes;
+	rs_fec_enc->num_padding_bytes += num_padding_bytes;
+	rs_fec_enc->last_padding_overhead = (gdouble)num_padding_bytes / (gdouble)num_symbol_bytes;
+	GST_OBJECT_UNLOCK(rs_fec_enc);
 
-	/* Just like the length field in the ADUI, the values in the
-	 * payload ID use big endian */
-	guint8 *fec_payload_id = g_slice_alloc(FEC_PAYLOAD_ID_LENGTH);
+	GST_LOG_OBJECT(rs_fec_enc, "%" G_GUINT64_FORMAT " of %" G_GUINT64_FORMAT " source symbol bytes are padding", num_padding_bytes, num_symbol_bytes);
+}
 
-	/* source block number (24-bit value) */
-	fec_payload_id[0] = ((source_block_nr & 0xFF0000) >> 16);
-	fec_payload_id[1] = ((source_block_nr & 0x00FF00) >> 8);
-	fec_payload_id[2] = ((source_block_nr & 0x0000FF) >> 0);
-	/* encoding symbol ID (8-bit value) */
-	fec_payload_id[3] = esi & 0xFF;
-	/* source block length (16-bit value) */
-	fec_payload_id[4] = ((rs_fec_enc->num_source_symbols & 0xFF00) >> 8);
-	fec_payload_id[5] = ((rs_fec_enc->num_source_symbols & 0x00FF) >> 0);
 
-	GST_LOG_OBJECT(rs_fec_enc, "pushing ADU from source block nr %u and with ESI %u as FEC source packet downstream", source_block_nr, esi);
+static guint gst_rs_fec_enc_select_num_repair_symbols(GstRSFECEnc *rs_fec_enc, GstBuffer **block_adus, guint num_block_adus, gsize encoding_symbol_length)
+{
+	guint i;
+	gboolean uep;
+	guint delta_repair_symbols, droppable_repair_symbols, repair_overhead_budget;
+	gboolean high_priority = FALSE, all_droppable = TRUE;
+	guint num_repair_symbols, max_num_repair_symbols;
+	guint64 max_credit, reserve;
+	gboolean adaptive_repair;
+	guint min_repair_symbols;
+	gdouble loss_rate;
+	guint max_repair_bitrate;
+	gsize const repair_packet_length = encoding_symbol_length + FEC_PAYLOAD_ID_LENGTH;
+
+	GST_OBJECT_LOCK(rs_fec_enc);
+	max_repair_bitrate = rs_fec_enc->max_repair_bitrate;
+	adaptive_repair = rs_fec_enc->adaptive_repair;
+	min_repair_symbols = rs_fec_enc->min_repair_symbols;
+	loss_rate = rs_fec_enc->loss_rate;
+	uep = rs_fec_enc->uep;
+	delta_repair_symbols = rs_fec_enc->delta_repair_symbols;
+	droppable_repair_symbols = rs_fec_enc->droppable_repair_symbols;
+	repair_overhead_budget = rs_fec_enc->repair_overhead_budget;
+	GST_OBJECT_UNLOCK(rs_fec_enc);
+
+	/* With adaptive repair, send enough repair symbols to cover the
+	 * expected number of lost symbols in this block (with a margin).
+	 * Otherwise, always send the configured number of repair symbols. */
+	if (adaptive_repair)
+	{
+		/* Round up the expected losses (not using ceil() to avoid a libm dependency) */
+		gdouble expected_losses = ADAPTIVE_REPAIR_SAFETY_FACTOR * loss_rate * (rs_fec_enc->num_source_symbols + rs_fec_enc->num_repair_symbols);
+		guint num_expected_losses = (guint)expected_losses;
+		if ((gdouble)num_expected_losses < expected_losses)
+			num_expected_losses++;
+
+		max_num_repair_symbols = MIN(min_repair_symbols + num_expected_losses, rs_fec_enc->num_repair_symbols);
+		GST_LOG_OBJECT(rs_fec_enc, "adaptive repair: loss rate %f -> up to %u repair symbol(s)", loss_rate, max_num_repair_symbols);
+	}
+	else
+		max_num_repair_symbols = rs_fec_enc->num_repair_symbols;
 
-	/* Create FEC source packet out of the ADU by appending the payload ID */
-	fec_source_packet = adu;
-	wrapped_payload_id = gst_memory_new_wrapped(
-		0,
-		fec_payload_id,
-		FEC_PAYLOAD_ID_LENGTH,
-		0,
-		FEC_PAYLOAD_ID_LENGTH,
-		fec_payload_id,
-		gst_rs_fec_enc_free_payload_id
-	);
-	gst_buffer_append_memory(fec_source_packet, wrapped_payload_id);
+	/* With a bitrate budget, do not send more repair symbols than
+	 * the token bucket can currently pay for */
+	if (max_repair_bitrate > 0)
+		max_num_repair_symbols = MIN(max_num_repair_symbols, gst_rs_fec_enc_refill_repair_tokens(rs_fec_enc, max_repair_bitrate, repair_packet_length));
 
-	/* Clear timestamp and duration, since they are
-	 * useless with FEC source packets
-	 * (The source packet is a GstBuffer, which originally came
-	 * from upstream, so it still has the timestamp and duration
-	 * set by upstream) */
-	GST_BUFFER_PTS(fec_source_packet) = GST_CLOCK_TIME_NONE;
-	GST_BUFFER_DTS(fec_source_packet) = GST_CLOCK_TIME_NONE;
-	GST_BUFFER_DURATION(fec_source_packet) = GST_CLOCK_TIME_NONE;
+	if (!uep)
+	{
+		num_repair_symbols = max_num_repair_symbols;
+		goto finish;
+	}
 
-	/* Mark discontinuity at start */
-	if (rs_fec_enc->first_source_packet)
+	/* Classify the block by the flags of its ADUs */
+	for (i = 0; i < num_block_adus; ++i)
 	{
-		GST_BUFFER_FLAG_SET(fec_source_packet, GST_BUFFER_FLAG_DISCONT);
-		rs_fec_enc->first_source_packet = FALSE;
+		GstBuffer *adu = block_adus[i];
+
+		if (!GST_BUFFER_FLAG_IS_SET(adu, GST_BUFFER_FLAG_DELTA_UNIT) || GST_BUFFER_FLAG_IS_SET(adu, GST_BUFFER_FLAG_HEADER))
+			high_priority = TRUE;
+		if (!GST_BUFFER_FLAG_IS_SET(adu, GST_BUFFER_FLAG_DROPPABLE))
+			all_droppable = FALSE;
 	}
 
-	/* offset and offset_end have no meaning here */
-	GST_BUFFER_OFFSET(fec_source_packet) = -1;
-	GST_BUFFER_OFFSET_END(fec_source_packet) = -1;
+	if (high_priority)
+		num_repair_symbols = max_num_repair_symbols;
+	else if (all_droppable)
+		num_repair_symbols = MIN(droppable_repair_symbols, max_num_repair_symbols);
+	else
+		num_repair_symbols = MIN(delta_repair_symbols, max_num_repair_symbols);
 
-	/* Push STREAM_START, CAPS, SEGMENT events if necessary */
-	gst_rs_fec_enc_push_events(rs_fec_enc);
+	if (repair_overhead_budget > 0)
+	{
+		/* Each block earns budget percent of its number of source symbols
+		 * as credit (in hundredths of a symbol). The credit is capped, so
+		 * that a long run of low priority blocks cannot save up for a burst
+		 * of repair packets. High priority blocks may use all available
+		 * credit, while other blocks must leave enough credit for one high
+		 * priority block. */
+		reserve = (guint64)(rs_fec_enc->num_repair_symbols) * 100;
+		max_credit = reserve * 2;
+		rs_fec_enc->repair_credit = MIN(rs_fec_enc->repair_credit + (guint64)repair_overhead_budget * num_block_adus, max_credit);
+
+		if (high_priority)
+			num_repair_symbols = MIN(num_repair_symbols, rs_fec_enc->repair_credit / 100);
+		else
+			num_repair_symbols = MIN(num_repair_symbols, (rs_fec_enc->repair_credit > reserve) ? ((rs_fec_enc->repair_credit - reserve) / 100) : 0);
 
-	/* Send out the FEC source packet */
-	ret = gst_pad_push(rs_fec_enc->fecsourcepad, fec_source_packet);
+		rs_fec_enc->repair_credit -= (guint64)num_repair_symbols * 100;
+	}
 
-	if (ret != GST_FLOW_OK)
-		GST_DEBUG_OBJECT(rs_fec_enc, "got return value %s while pushing", gst_flow_get_name(ret));
+	GST_LOG_OBJECT(rs_fec_enc, "UEP: %s source block gets %u repair symbol(s)", high_priority ? "high priority" : (all_droppable ? "droppable" : "delta"), num_repair_symbols);
 
-	return ret;
+finish:
+	/* Take the repair packets out of the token bucket */
+	if (max_repair_bitrate > 0)
+	{
+		guint64 num_bytes = (guint64)num_repair_symbols * repair_packet_length;
+
+		GST_OBJECT_LOCK(rs_fec_enc);
+		g_assert(rs_fec_enc->repair_tokens >= num_bytes);
+		rs_fec_enc->repair_tokens -= num_bytes;
+		rs_fec_enc->num_repair_budget_bytes_used += num_bytes;
+		GST_OBJECT_UNLOCK(rs_fec_enc);
+	}
+
+	return num_repair_symbols;
 }
 
 
-static void gst_rs_fec_enc_push_events(GstRSFECEnc *rs_fec_enc)
+static guint gst_rs_fec_enc_refill_repair_tokens(GstRSFECEnc *rs_fec_enc, guint max_repair_bitrate, gsize repair_packet_length)
 {
-	if (!rs_fec_enc->segment_started)
+	GstClockTime now = gst_clock_get_time(rs_fec_enc->system_clock);
+	guint64 bucket_size, num_earned_bytes;
+	guint num_affordable_repair_symbols;
+
+	/* The bucket holds the budget of REPAIR_BUCKET_DURATION, but at least
+	 * enough for all repair packets of one block, since otherwise, blocks
+	 * could never get all of their repair symbols at low bitrates */
+	bucket_size = MAX(gst_util_uint64_scale(max_repair_bitrate, REPAIR_BUCKET_DURATION, GST_SECOND * 8), (guint64)(rs_fec_enc->num_repair_symbols) * repair_packet_length);
+
+	GST_OBJECT_LOCK(rs_fec_enc);
+
+	if (!GST_CLOCK_TIME_IS_VALID(rs_fec_enc->repair_tokens_update_time))
 	{
-		GstEvent *event;
-		GstCaps *caps;
-		GstSegment segment;
-		gchar *stream_id;
-		guint group_id;
+		/* First block with a budget; start with a full bucket */
+		num_earned_bytes = bucket_size;
+	}
+	else if (now > rs_fec_enc->repair_tokens_update_time)
+		num_earned_bytes = gst_util_uint64_scale(now - rs_fec_enc->repair_tokens_update_time, max_repair_bitrate, GST_SECOND * 8);
+	else
+		num_earned_bytes = 0;
 
-		group_id = gst_util_group_id_next();
-		gst_segment_init(&segment, GST_FORMAT_BYTES);
+	/* Tokens that do not fit in the bucket are lost, but they
+	 * still count as budget for the utilization statistic */
+	rs_fec_enc->repair_tokens = MIN(rs_fec_enc->repair_tokens + num_earned_bytes, bucket_size);
+	rs_fec_enc->num_repair_budget_bytes += num_earned_bytes;
+	rs_fec_enc->repair_tokens_update_time = now;
 
-		if (rs_fec_enc->stream_started)
-			GST_DEBUG_OBJECT(rs_fec_enc, "pushing SEGMENT and CAPS events downstream");
-		else
-			GST_DEBUG_OBJECT(rs_fec_enc, "pushing STREAM_START, SEGMENT, and CAPS events downstream (stream-start group id: %u)", group_id);
+	num_affordable_repair_symbols = MIN(rs_fec_enc->repair_tokens / repair_packet_length, (guint64)(rs_fec_enc->num_repair_symbols));
 
-		/* push stream start, caps, segment events for source pad */
-		{
-			if (!rs_fec_enc->stream_started)
-			{
-				/* stream start */
-				stream_id = gst_pad_create_stream_id(rs_fec_enc->fecsourcepad, GST_ELEMENT_CAST(rs_fec_enc), "fecsource");
-				event = gst_event_new_stream_start(stream_id);
-				gst_event_set_group_id(event, group_id);
-				gst_pad_push_event(rs_fec_enc->fecsourcepad, event);
-				g_free(stream_id);
+	GST_LOG_OBJECT(rs_fec_enc, "repair bitrate budget: %" G_GUINT64_FORMAT " byte(s) available -> up to %u repair symbol(s)", rs_fec_enc->repair_tokens, num_affordable_repair_symbols);
 
-				/* caps */
-				caps = gst_caps_from_string(FEC_SOURCE_CAPS_STR);
-				event = gst_event_new_caps(caps);
-				gst_pad_push_event(rs_fec_enc->fecsourcepad, event);
-				gst_caps_unref(caps);
-			}
+	GST_OBJECT_UNLOCK(rs_fec_enc);
 
-			/* segment */
-			event = gst_event_new_segment(&segment);
-			gst_pad_push_event(rs_fec_enc->fecsourcepad, event);
-		}
+	return num_affordable_repair_symbols;
+}
 
-		/* push stream start, caps, segment events for repair pad */
-		{
-			if (!rs_fec_enc->stream_started)
-			{
-				/* stream start */
-				stream_id = gst_pad_create_stream_id(rs_fec_enc->fecrepairpad, GST_ELEMENT_CAST(rs_fec_enc), "fecrepair");
-				event = gst_event_new_stream_start(stream_id);
-				gst_event_set_group_id(event, group_id);
-				gst_pad_push_event(rs_fec_enc->fecrepairpad, event);
-				g_free(stream_id);
 
-				/* caps */
-				caps = gst_caps_from_string(FEC_REPAIR_CAPS_STR);
-				event = gst_event_new_caps(caps);
-				gst_pad_push_event(rs_fec_enc->fecrepairpad, event);
-				gst_caps_unref(caps);
-			}
+static void gst_rs_fec_enc_update_loss_rate(GstRSFECEnc *rs_fec_enc, gdouble reported_loss_rate)
+{
+	reported_loss_rate = CLAMP(reported_loss_rate, 0.0, 1.0);
 
-			/* segment */
-			event = gst_event_new_segment(&segment);
-			gst_pad_push_event(rs_fec_enc->fecrepairpad, event);
-		}
+	GST_OBJECT_LOCK(rs_fec_enc);
 
-		rs_fec_enc->segment_started = TRUE;
-		rs_fec_enc->stream_started = TRUE;
-	}
+	/* Fast attack, slow decay: when losses increase, react at once,
+	 * since the repair symbols are needed right now. When they
+	 * decrease, reduce the repair symbols gradually, in case this
+	 * was just a short calm period. */
+	if (reported_loss_rate >= rs_fec_enc->loss_rate)
+		rs_fec_enc->loss_rate = reported_loss_rate;
+	else
+		rs_fec_enc->loss_rate = (1.0 - LOSS_RATE_DECAY_WEIGHT) * rs_fec_enc->loss_rate + LOSS_RATE_DECAY_WEIGHT * reported_loss_rate;
+
+	GST_DEBUG_OBJECT(rs_fec_enc, "got loss report with loss rate %f; estimated loss rate is now %f", reported_loss_rate, rs_fec_enc->loss_rate);
+
+	GST_OBJECT_UNLOCK(rs_fec_enc);
 }
 
 
-static void gst_rs_fec_enc_flush_all_adus(GstRSFECEnc *rs_fec_enc)
+guint gst_rs_fec_enc_take_repair_budget(GstRSFECEnc *rs_fec_enc, guint num_repair_packets, gsize repair_packet_length)
 {
-	/* If there are any leftover ADUs, unref them here,
-	 * and set their entries in the ADU table to NULL. */
+	guint max_repair_bitrate;
+	guint num_affordable_repair_packets;
 
-	guint esi;
+	GST_OBJECT_LOCK(rs_fec_enc);
+	max_repair_bitrate = rs_fec_enc->max_repair_bitrate;
+	GST_OBJECT_UNLOCK(rs_fec_enc);
 
-	if (rs_fec_enc->cur_num_adus == 0)
-		return;
+	if (max_repair_bitrate == 0)
+		return num_repair_packets;
 
-	GST_LOG_OBJECT(rs_fec_enc, "flushing %u ADUs", rs_fec_enc->cur_num_adus);
+	/* The return value of the refill is capped at num_repair_symbols,
+	 * which is the limit for source blocks, not for these packets,
+	 * so the affordable number is computed from the tokens instead */
+	gst_rs_fec_enc_refill_repair_tokens(rs_fec_enc, max_repair_bitrate, repair_packet_length);
 
-	for (esi = 0; esi < rs_fec_enc->num_source_symbols; ++esi)
-	{
-		GstBuffer *adu = rs_fec_enc->adu_table[esi];
-		rs_fec_enc->adu_table[esi] = NULL;
-		if (adu != NULL)
-			gst_buffer_unref(adu);
-	}
+	GST_OBJECT_LOCK(rs_fec_enc);
+	num_affordable_repair_packets = MIN(rs_fec_enc->repair_tokens / repair_packet_length, (guint64)num_repair_packets);
+	rs_fec_enc->repair_tokens -= (guint64)num_affordable_repair_packets * repair_packet_length;
+	rs_fec_enc->num_repair_budget_bytes_used += (guint64)num_affordable_repair_packets * repair_packet_length;
+	GST_OBJECT_UNLOCK(rs_fec_enc);
 
-	rs_fec_enc->cur_num_adus = 0;
+	if (num_affordable_repair_packets < num_repair_packets)
+		GST_DEBUG_OBJECT(rs_fec_enc, "repair bitrate budget only allows for %u of %u additional repair packet(s)", num_affordable_repair_packets, num_repair_packets);
+
+	return num_affordable_repair_packets;
 }
 
 
-static void gst_rs_fec_enc_flush_all_fec_repair_packets(GstRSFECEnc *rs_fec_enc)
+void gst_rs_fec_enc_get_repair_send_times(GstRSFECEnc *rs_fec_enc, GstClockTime *first_send_time, GstClockTime *send_interval)
 {
-	/* If there are any leftover FEC repair packets, unmap
-	 * and unref them here, and set their entries in the
-	 * table to NULL. */
-
-	guint i;
+	gboolean repair_pacing;
+	GstClockTime repair_delay;
 
-	if (rs_fec_enc->cur_num_fec_repair_packets == 0)
-		return;
+	GST_OBJECT_LOCK(rs_fec_enc);
+	repair_pacing = rs_fec_enc->repair_pacing;
+	repair_delay = rs_fec_enc->repair_delay;
+	GST_OBJECT_UNLOCK(rs_fec_enc);
 
-	GST_LOG_OBJECT(rs_fec_enc, "flushing %u repair packets", rs_fec_enc->cur_num_fec_repair_packets);
+	*first_send_time = GST_CLOCK_TIME_NONE;
+	*send_interval = 0;
 
-	for (i = 0; i < rs_fec_enc->num_repair_symbols; ++i)
+	/* There is no block fill time to derive the interval from here,
+	 * so the interval of the last processed block is used */
+	if (repair_pacing || (repair_delay > 0))
 	{
-		GstBuffer *fec_repair_packet = rs_fec_enc->fec_repair_packet_table[i];
-		if (fec_repair_packet != NULL)
-		{
-			/* If a packet is still in the table, it implies the
-			 * GstBuffer is still mapped, so unmap it first. */
+		*first_send_time = gst_clock_get_time(rs_fec_enc->system_clock) + repair_delay;
+		if (repair_pacing)
+			*send_interval = rs_fec_enc->repair_send_interval;
+	}
+}
 
-			GstMapInfo *map_info = &(rs_fec_enc->fec_repair_packet_map_infos[i]);
-			g_assert(map_info != NULL);
-			gst_buffer_unmap(fec_repair_packet, map_info);
 
-			gst_buffer_unref(fec_repair_packet);
-		}
+GstFlowReturn gst_rs_fec_enc_push_repair_packet(GstRSFECEnc *rs_fec_enc, GstBuffer *fec_repair_packet, GstClockTime send_time)
+{
+	GstFlowReturn ret;
+
+	/* Without pacing and delay, push directly, unless the repair output
+	 * task is running already, in which case the packet must queue up
+	 * behind the ones that are still waiting */
+	g_mutex_lock(&(rs_fec_enc->repair_output_mutex));
+	if (!GST_CLOCK_TIME_IS_VALID(send_time) && !(rs_fec_enc->repair_output_task_started))
+	{
+		g_mutex_unlock(&(rs_fec_enc->repair_output_mutex));
+		return gst_pad_push(rs_fec_enc->fecrepairpad, fec_repair_packet);
 	}
+	g_mutex_unlock(&(rs_fec_enc->repair_output_mutex));
 
-	rs_fec_enc->cur_num_fec_repair_packets = 0;
+	if (!gst_rs_fec_enc_queue_repair_output_item(rs_fec_enc, fec_repair_packet, NULL, send_time))
+		return GST_FLOW_FLUSHING;
+
+	g_mutex_lock(&(rs_fec_enc->repair_output_mutex));
+	ret = rs_fec_enc->repair_output_flow_return;
+	g_mutex_unlock(&(rs_fec_enc->repair_output_mutex));
+
+	return ret;
 }
 
 
-static void gst_rs_fec_enc_free_payload_id(gpointer data)
+static void gst_rs_fec_enc_push_repair_event(GstRSFECEnc *rs_fec_enc, GstEvent *event)
 {
-	/* This function is called once a GstMemory block that
-	 * contains a FEC payload ID is deallocated */
-	g_slice_free1(FEC_PAYLOAD_ID_LENGTH, data);
+	gboolean task_started;
+
+	g_mutex_lock(&(rs_fec_enc->repair_output_mutex));
+	task_started = rs_fec_enc->repair_output_task_started;
+	g_mutex_unlock(&(rs_fec_enc->repair_output_mutex));
+
+	/* Serialized events must not overtake the queued repair packets */
+	if (task_started)
+		gst_rs_fec_enc_queue_repair_output_item(rs_fec_enc, NULL, event, GST_CLOCK_TIME_NONE);
+	else
+		gst_pad_push_event(rs_fec_enc->fecrepairpad, event);
 }
 
 
-static GstFlowReturn gst_rs_fec_enc_process_source_block(GstRSFECEnc *rs_fec_enc)
+static gboolean gst_rs_fec_enc_queue_repair_output_item(GstRSFECEnc *rs_fec_enc, GstBuffer *buffer, GstEvent *event, GstClockTime send_time)
 {
-	GstBuffer *adu;
-	guint i;
-	GstFlowReturn ret = GST_FLOW_OK;
+	GstRSFECEncRepairOutputItem *item;
 
-	/* Incremental counter for source block nr */
-	guint source_block_nr = rs_fec_enc->cur_source_block_nr;
+	g_mutex_lock(&(rs_fec_enc->repair_output_mutex));
 
-	/* Reed-Solomon and RFC 6865 both require encoding symbols to be of the same
-	 * length for the same source block. encoding_symbol_length is that length. */
-	gsize encoding_symbol_length;
-
-	if (rs_fec_enc->cur_num_adus < rs_fec_enc->num_source_symbols)
+	if (rs_fec_enc->repair_output_flushing)
 	{
-		GST_LOG_OBJECT(rs_fec_enc, "there are not enough ADUs yet to create a source block (present: %u required: %u) - skipping", rs_fec_enc->cur_num_adus, rs_fec_enc->num_source_symbols);
-		return GST_FLOW_OK;
+		g_mutex_unlock(&(rs_fec_enc->repair_output_mutex));
+		GST_DEBUG_OBJECT(rs_fec_enc, "repair output is flushing - dropping %s", (buffer != NULL) ? "FEC repair packet" : "event");
+		if (buffer != NULL)
+			gst_buffer_unref(buffer);
+		else
+			gst_event_unref(event);
+		return FALSE;
 	}
 
-	GST_LOG_OBJECT(rs_fec_enc, "there are enough ADUs to create a source block - processing source block #%u", source_block_nr);
+	/* Send times never go backwards, so packets that would be sent
+	 * before the last queued one are sent right after it instead */
+	if (GST_CLOCK_TIME_IS_VALID(send_time))
+	{
+		if (GST_CLOCK_TIME_IS_VALID(rs_fec_enc->last_repair_send_time) && (send_time < rs_fec_enc->last_repair_send_time))
+			send_time = rs_fec_enc->last_repair_send_time;
+		rs_fec_enc->last_repair_send_time = send_time;
+	}
 
-	/* ADUIs are created by prepending 3 extra bytes to ADUs according to RFC 6865
-	 * these byates contain ADU flow identification and ADU length (in big endian)
-	 * Since ADUIs and repair symbol must be of the same size, the length of the longest
-	 * ADU+ the 3 bytes is considered the "encoding symbol length" */
-	encoding_symbol_length = 1 + 2 + rs_fec_enc->cur_max_adu_length;
-	GST_LOG_OBJECT(rs_fec_enc, "using encoding symbol length of %" G_GSIZE_FORMAT " bytes for this source block", encoding_symbol_length);
+	item = g_slice_new(GstRSFECEncRepairOutputItem);
+	item->buffer = buffer;
+	item->event = event;
+	item->send_time = send_time;
+	g_queue_push_tail(&(rs_fec_enc->repair_output_queue), item);
 
-	/* In this block, the encoder is (re)configured and ADUs are fed into the encoder.
-	 * None of these steps make any sense if num_source_symbols is 0, since then, no
-	 * repair data shall be generated at all. */
-	if (rs_fec_enc->num_repair_symbols > 0)
+	if (!(rs_fec_enc->repair_output_task_started))
 	{
-		/* Request encoder reconfiguration. The function takes care of checking if
-		 * a reconfiguration is really necessary (it is if the encoding symbol length
-		 * changed since last time). */
-		if (!gst_rs_fec_enc_configure_fec(rs_fec_enc, encoding_symbol_length))
-		{
-			GST_ERROR_OBJECT(rs_fec_enc, "reconfiguring failed");
-			ret = GST_FLOW_ERROR;
-			goto cleanup;
-		}
+		GST_DEBUG_OBJECT(rs_fec_enc, "starting repair output task");
+		rs_fec_enc->repair_output_task_started = TRUE;
+		gst_pad_start_task(rs_fec_enc->fecrepairpad, gst_rs_fec_enc_repair_output_loop, rs_fec_enc, NULL);
+	}
 
-		/* Convert ADUs into ADUIs, and put them into the encoding symbol table for the
-		 * OpenFEC Reed-Solomon encoder */
-		for (i = 0; i < rs_fec_enc->num_source_symbols; ++i)
-		{
-			guint8 *adui_memblock;
-			gsize padding;
-			gsize adu_length;
-			guint adu_flow_id = 0; /* XXX: Currently, only one flow (flow 0) is supported */
+	g_cond_signal(&(rs_fec_enc->repair_output_cond));
+	g_mutex_unlock(&(rs_fec_enc->repair_output_mutex));
 
-			/* Get the ADU from the table. Since the ADU will not
-			 * be needed in the table anymore, set its entry to NULL.
-			 * It is pushed downstream, so no need to unref it either. */
-			g_assert(rs_fec_enc->cur_num_adus > 0);
-			adu = rs_fec_enc->adu_table[i];
-			adu_length = gst_buffer_get_size(adu);
-			rs_fec_enc->adu_table[i] = NULL;
-			rs_fec_enc->cur_num_adus--;
+	return TRUE;
+}
 
-			g_assert((adu_length + 3) <= encoding_symbol_length);
 
-			/* Get the corresponding entry from the symbol table */
-			adui_memblock = rs_fec_enc->encoding_symbol_table[i];
+static void gst_rs_fec_enc_repair_output_loop(gpointer user_data)
+{
+	GstRSFECEnc *rs_fec_enc = GST_RS_FEC_ENC(user_data);
+	GstRSFECEncRepairOutputItem *item;
+	GstFlowReturn ret = GST_FLOW_OK;
 
-			/* Prepend the extra 3 bytes to the ADU and add padding,
-			 * converting it into an ADUI */
-			/* ADU flow ID, one byte */
-			adui_memblock[0] = adu_flow_id;
-			/* Length of ADU, 16-bit big endian unsigned integer */
-			adui_memblock[1] = (adu_length & 0xFF00) >> 8;
-			adui_memblock[2] = (adu_length & 0x00FF);
-			/* The ADU itself */
-			gst_buffer_extract(adu, 0, adui_memblock + 3, adu_length);
-			/* Padding in case this ADU is not the longest one */
-			padding = rs_fec_enc->cur_max_adu_length - adu_length;
-			if (padding > 0)
-				memset(adui_memblock + 3 + adu_length, 0, padding);
+	g_mutex_lock(&(rs_fec_enc->repair_output_mutex));
 
-			/* ADU is not needed anymore, discard */
-			gst_buffer_unref(adu);
+	while (g_queue_is_empty(&(rs_fec_enc->repair_output_queue)) && !(rs_fec_enc->repair_output_flushing))
+		g_cond_wait(&(rs_fec_enc->repair_output_cond), &(rs_fec_enc->repair_output_mutex));
 
-			GST_LOG_OBJECT(rs_fec_enc, "preparing ADU #%u in source block for encoder:  flow ID: %u  length: %" G_GSIZE_FORMAT " bytes  padding: %" G_GSIZE_FORMAT " bytes", i, adu_flow_id, adu_length, padding);
-		}
+	if (rs_fec_enc->repair_output_flushing)
+	{
+		g_mutex_unlock(&(rs_fec_enc->repair_output_mutex));
+		GST_DEBUG_OBJECT(rs_fec_enc, "pausing repair output task, since it is flushing");
+		gst_pad_pause_task(rs_fec_enc->fecrepairpad);
+		return;
 	}
 
-	/* Push STREAM_START, CAPS, SEGMENT events if necessary */
-	gst_rs_fec_enc_push_events(rs_fec_enc);
-
-	/* Allocate buffers for the FEC repair packets */
-	for (i = 0; i < rs_fec_enc->num_repair_symbols; ++i)
+	/* Wait until the next item is due. The queue is checked again
+	 * afterwards (in the next iteration), since it may have been
+	 * flushed in the meantime. */
+	item = g_queue_peek_head(&(rs_fec_enc->repair_output_queue));
+	if (GST_CLOCK_TIME_IS_VALID(item->send_time) && (gst_clock_get_time(rs_fec_enc->system_clock) < item->send_time))
 	{
-		GstBuffer *fec_repair_packet;
-		GstMapInfo *map_info;
+		GstClockID clock_id = gst_clock_new_single_shot_id(rs_fec_enc->system_clock, item->send_time);
 
-		/* Allocate buffer for the packet, and put it in the table */
-		fec_repair_packet = gst_buffer_new_allocate(NULL, encoding_symbol_length + 6, NULL);
-		rs_fec_enc->fec_repair_packet_table[i] = fec_repair_packet;
+		rs_fec_enc->repair_output_clock_id = clock_id;
+		g_mutex_unlock(&(rs_fec_enc->repair_output_mutex));
 
-		/* Retrieve corresponding map info value that shall be filled
-		 * with mapping information */
-		map_info = &(rs_fec_enc->fec_repair_packet_map_infos[i]);
+		gst_clock_id_wait(clock_id, NULL);
 
-		/* Map the buffer. It will be unmapped later, either when a
-		 * repair packet has been fully constructed, or when
-		 * gst_rs_fec_enc_flush_all_fec_repair_packets() is called. */
-		gst_buffer_map(fec_repair_packet, map_info, GST_MAP_WRITE);
+		g_mutex_lock(&(rs_fec_enc->repair_output_mutex));
+		rs_fec_enc->repair_output_clock_id = NULL;
+		g_mutex_unlock(&(rs_fec_enc->repair_output_mutex));
 
-		/* Store the pointer to the region in the mapped buffer data block
-		 * where the encoding symbol shall be constructed and stored.
-		 * The first 6 bytes are reserved for the FEC payload ID, so
-		 * apply an offset. */
-		rs_fec_enc->encoding_symbol_table[rs_fec_enc->num_source_symbols + i] = map_info->data + 6;
+		gst_clock_id_unref(clock_id);
+		return;
 	}
-	/* Update the counter */
-	rs_fec_enc->cur_num_fec_repair_packets = rs_fec_enc->num_repair_symbols;
 
-	/* Build repair symbols and send them out as FEC repair packets */
-	for (i = 0; i < rs_fec_enc->num_repair_symbols; ++i)
+	g_queue_pop_head(&(rs_fec_enc->repair_output_queue));
+	g_mutex_unlock(&(rs_fec_enc->repair_output_mutex));
+
+	if (item->buffer != NULL)
 	{
-		guint esi = i + rs_fec_enc->num_source_symbols; /* ESI = encoding symbol ID */
-		GstBuffer *fec_repair_packet = rs_fec_enc->fec_repair_packet_table[i];
-		GstMapInfo *map_info = &(rs_fec_enc->fec_repair_packet_map_infos[i]);
-		of_status_t status;
+		ret = gst_pad_push(rs_fec_enc->fecrepairpad, item->buffer);
+	}
+	else
+	{
+		gboolean is_eos = (GST_EVENT_TYPE(item->event) == GST_EVENT_EOS);
+		gst_pad_push_event(rs_fec_enc->fecrepairpad, item->event);
+		if (is_eos)
+			ret = GST_FLOW_EOS;
+	}
 
-		/* Build this repair symbol */
-		if ((status = of_build_repair_symbol(rs_fec_enc->openfec_session, rs_fec_enc->encoding_symbol_table, esi)) != OF_STATUS_OK)
-		{
-			GST_ERROR_OBJECT(rs_fec_enc, "could not build repair symbol #%u: %s", i, gst_rs_fec_enc_get_status_name(status));
-			CHECK_IF_FATAL_ERROR(rs_fec_enc, status);
-			ret = GST_FLOW_ERROR;
-			goto cleanup;
-		}
-		else
-			GST_LOG_OBJECT(rs_fec_enc, "built repair symbol #%u", i);
+	g_slice_free(GstRSFECEncRepairOutputItem, item);
 
-		/* Build the FEC payload ID */
+	if (ret != GST_FLOW_OK)
+	{
+		/* Report the error upstream with the next repair packet,
+		 * unless the output is flushing anyway */
+		g_mutex_lock(&(rs_fec_enc->repair_output_mutex));
+		if (!(rs_fec_enc->repair_output_flushing))
+			rs_fec_enc->repair_output_flow_return = ret;
+		g_mutex_unlock(&(rs_fec_enc->repair_output_mutex));
+
+		GST_DEBUG_OBJECT(rs_fec_enc, "pausing repair output task, reason: %s", gst_flow_get_name(ret));
+		gst_pad_pause_task(rs_fec_enc->fecrepairpad);
+	}
+}
 
-		/* Just like the length field in the ADUI, the values in the
-		 * payload ID use big endian */
-		guint8 *fec_payload_id = map_info->data;
-		/* source block number (24-bit value) */
-		fec_payload_id[0] = ((source_block_nr & 0xFF0000) >> 16);
-		fec_payload_id[1] = ((source_block_nr & 0x00FF00) >> 8);
-		fec_payload_id[2] = ((source_block_nr & 0x0000FF) >> 0);
-		/* encoding symbol ID (8-bit value) */
-		fec_payload_id[3] = esi & 0xFF;
-		/* source block length (16-bit value) */
-		fec_payload_id[4] = ((rs_fec_enc->num_source_symbols & 0xFF00) >> 8);
-		fec_payload_id[5] = ((rs_fec_enc->num_source_symbols & 0x00FF) >> 0);
-
-		GST_LOG_OBJECT(rs_fec_enc, "pushing FEC repair packet:  source block nr: %u  ESI: %u", source_block_nr, esi);
 
-		/* No more write access is needed, so unmap the buffer */
-		gst_buffer_unmap(fec_repair_packet, map_info);
+static void gst_rs_fec_enc_stop_repair_output(GstRSFECEnc *rs_fec_enc)
+{
+	/* Wake up the repair output task and make it pause. The caller then
+	 * pauses or stops the task, which waits until the task function is
+	 * done. Until gst_rs_fec_enc_reset_repair_output() is called, nothing
+	 * can be queued anymore. */
+	g_mutex_lock(&(rs_fec_enc->repair_output_mutex));
+	rs_fec_enc->repair_output_flushing = TRUE;
+	rs_fec_enc->repair_output_flow_return = GST_FLOW_FLUSHING;
+	rs_fec_enc->repair_output_task_started = FALSE;
+	if (rs_fec_enc->repair_output_clock_id != NULL)
+		gst_clock_id_unschedule(rs_fec_enc->repair_output_clock_id);
+	g_cond_signal(&(rs_fec_enc->repair_output_cond));
+	g_mutex_unlock(&(rs_fec_enc->repair_output_mutex));
+}
 
-		/* This FEC repair packet is finished and ready to be pushed
-		 * downstream. Remove it from the table, and decrement the
-		 * cur_num_fec_repair_packets counter. */
-		rs_fec_enc->fec_repair_packet_table[i] = NULL;
-		g_assert(rs_fec_enc->cur_num_fec_repair_packets > 0);
-		rs_fec_enc->cur_num_fec_repair_packets--;
 
-		/* Mark discontinuity at start */
-		if (rs_fec_enc->first_repair_packet)
-		{
-			GST_BUFFER_FLAG_SET(fec_repair_packet, GST_BUFFER_FLAG_DISCONT);
-			rs_fec_enc->first_repair_packet = FALSE;
-		}
+static void gst_rs_fec_enc_reset_repair_output(GstRSFECEnc *rs_fec_enc)
+{
+	GstRSFECEncRepairOutputItem *item;
 
-		/* offset and offset_end have no meaning here */
-		GST_BUFFER_OFFSET(fec_repair_packet) = -1;
-		GST_BUFFER_OFFSET_END(fec_repair_packet) = -1;
+	/* Discard whatever the task did not send, and allow queuing again.
+	 * The task is not running at this point (it is either paused or
+	 * stopped, or was never started). */
+	g_mutex_lock(&(rs_fec_enc->repair_output_mutex));
 
-		/* Send out the FEC repair packet */
-		if ((ret = gst_pad_push(rs_fec_enc->fecrepairpad, fec_repair_packet)) != GST_FLOW_OK)
-			goto cleanup;
+	while ((item = g_queue_pop_head(&(rs_fec_enc->repair_output_queue))) != NULL)
+	{
+		if (item->buffer != NULL)
+			gst_buffer_unref(item->buffer);
+		else
+			gst_event_unref(item->event);
+		g_slice_free(GstRSFECEncRepairOutputItem, item);
 	}
 
-	GST_LOG_OBJECT(rs_fec_enc, "finished processing source block #%u", source_block_nr);
-
-	/* After successfully processing this
-	 * source block, increase number */
-	rs_fec_enc->cur_source_block_nr++;
+	rs_fec_enc->last_repair_send_time = GST_CLOCK_TIME_NONE;
+	rs_fec_enc->repair_output_flushing = FALSE;
+	rs_fec_enc->repair_output_flow_return = GST_FLOW_OK;
 
-cleanup:
-	/* Cleanup any leftover data in case an error occurred
-	 * and not all ADUs and/or repair packets were processed above */
-	gst_rs_fec_enc_flush_all_adus(rs_fec_enc);
-	gst_rs_fec_enc_flush_all_fec_repair_packets(rs_fec_enc);
-	rs_fec_enc->cur_max_adu_length = 0;
-
-	return ret;
+	g_mutex_unlock(&(rs_fec_enc->repair_output_mutex));
 }
 
 
@@ -1199,15 +3609,36 @@ static void gst_rs_fec_enc_reset_states(GstRSFECEnc *rs_fec_enc)
 	 * have the same encoding symbol length as the past ones. */
 
 	rs_fec_enc->cur_max_adu_length = 0;
+	rs_fec_enc->cur_adu_bytes = 0;
+	/* The pacing interval of blocks from before a flush or
+	 * a PAUSED->READY change says nothing about the new data */
+	rs_fec_enc->repair_send_interval = 0;
 	rs_fec_enc->first_source_packet = TRUE;
 	rs_fec_enc->first_repair_packet = TRUE;
 	rs_fec_enc->segment_started = FALSE;
 	rs_fec_enc->eos_received = FALSE;
+	rs_fec_enc->last_adu_pts = GST_CLOCK_TIME_NONE;
+	/* Start with enough credit for one high priority block */
+	rs_fec_enc->repair_credit = (guint64)(rs_fec_enc->num_repair_symbols) * 100;
+
+	/* Restart the bitrate budget; the bucket is filled again
+	 * when the next block gets its repair symbols */
+	GST_OBJECT_LOCK(rs_fec_enc);
+	rs_fec_enc->repair_tokens = 0;
+	rs_fec_enc->repair_tokens_update_time = GST_CLOCK_TIME_NONE;
+	rs_fec_enc->num_repair_budget_bytes = 0;
+	rs_fec_enc->num_repair_budget_bytes_used = 0;
+	rs_fec_enc->num_padding_bytes = 0;
+	rs_fec_enc->num_symbol_bytes = 0;
+	rs_fec_enc->last_padding_overhead = 0.0;
+	GST_OBJECT_UNLOCK(rs_fec_enc);
 }
 
 
 static void gst_rs_fec_enc_flush(GstRSFECEnc *rs_fec_enc)
 {
+	gst_rs_fec_enc_cancel_block_timeout(rs_fec_enc);
+	gst_rs_fec_enc_discard_pending_data(rs_fec_enc);
 	gst_rs_fec_enc_flush_all_adus(rs_fec_enc);
 	gst_rs_fec_enc_flush_all_fec_repair_packets(rs_fec_enc);
 	gst_rs_fec_enc_reset_states(rs_fec_enc);
@@ -1225,3 +3656,144 @@ static gchar const * gst_rs_fec_enc_get_status_name(of_status_t status)
 		default: return "<unknown>";
 	}
 }
+
+
+static guint gst_rs_fec_enc_get_payload_id_m(GstRSFECEnc *rs_fec_enc)
+{
+	return gst_rs_fec_code_construction_get_m(rs_fec_enc->code_construction);
+}
+
+
+static guint gst_rs_fec_enc_get_max_num_encoding_symbols(GstRSFECEnc *rs_fec_enc)
+{
+	return gst_rs_fec_code_construction_get_max_num_encoding_symbols(rs_fec_enc->code_construction);
+}
+
+
+static gboolean gst_rs_fec_enc_check_settings(GstRSFECEnc *rs_fec_enc)
+{
+	if (!gst_rs_fec_code_construction_check_num_symbols(rs_fec_enc->code_construction, rs_fec_enc->num_source_symbols, rs_fec_enc->num_repair_symbols))
+	{
+		GST_ELEMENT_ERROR(
+			rs_fec_enc, LIBRARY, SETTINGS,
+			("invalid number of encoding symbols for code construction"),
+			("code construction: %s  number of source symbols: %u  repair symbols: %u", gst_rs_fec_code_construction_get_name(rs_fec_enc->code_construction), rs_fec_enc->num_source_symbols, rs_fec_enc->num_repair_symbols)
+		);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+static gsize gst_rs_fec_enc_get_encoding_symbol_length(GstRSFECEnc *rs_fec_enc, gsize max_adui_length)
+{
+	/* The GF(2^16) codec works with 16-bit words */
+	if (rs_fec_enc->code_construction == GST_RS_FEC_CODE_CONSTRUCTION_GF16_FFT)
+		return (max_adui_length + 1) & ~((gsize)1);
+	else
+		return max_adui_length;
+}
+
+
+static gboolean gst_rs_fec_enc_uses_openfec_session(GstRSFECEnc *rs_fec_enc)
+{
+	/* Only the Vandermonde construction is implemented by OpenFEC.
+	 * The Cauchy and GF(2^16) constructions use in-plugin codecs. */
+	return rs_fec_enc->code_construction == GST_RS_FEC_CODE_CONSTRUCTION_VANDERMONDE;
+}
+
+
+static gboolean gst_rs_fec_enc_configure_session(GstRSFECEnc *rs_fec_enc, gsize encoding_symbol_length)
+{
+	of_status_t status;
+	of_rs_parameters_t params;
+
+	/* Only the Vandermonde construction is implemented by OpenFEC. The
+	 * other constructions have no state besides the symbol memory blocks. */
+	if (rs_fec_enc->code_construction != GST_RS_FEC_CODE_CONSTRUCTION_VANDERMONDE)
+		return TRUE;
+
+	memset(&params, 0, sizeof(params));
+	params.nb_source_symbols = rs_fec_enc->num_source_symbols;
+	params.nb_repair_symbols = rs_fec_enc->num_repair_symbols;
+	params.encoding_symbol_length = encoding_symbol_length;
+
+	/* Instruct the OpenFEC session to (re)configure itself */
+	if ((status = of_set_fec_parameters(rs_fec_enc->openfec_session, (of_parameters_t *)(&params))) != OF_STATUS_OK)
+	{
+		GST_ERROR_OBJECT(rs_fec_enc, "could not set FEC parameters: %s", gst_rs_fec_enc_get_status_name(status));
+		CHECK_IF_FATAL_ERROR(rs_fec_enc, status);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+static gboolean gst_rs_fec_enc_build_repair_symbols(GstRSFECEnc *rs_fec_enc, gsize encoding_symbol_length)
+{
+	guint i;
+
+	/* The FFT computes all repair symbols in one go */
+	if (rs_fec_enc->code_construction == GST_RS_FEC_CODE_CONSTRUCTION_GF16_FFT)
+	{
+		gst_rs_fft_build_repair_symbols(rs_fec_enc->num_source_symbols, rs_fec_enc->num_repair_symbols, rs_fec_enc->encoding_symbol_table, encoding_symbol_length);
+		return TRUE;
+	}
+
+	/* The other constructions build symbols one by one, so only
+	 * build the ones that are actually sent */
+	for (i = 0; i < rs_fec_enc->cur_num_repair_symbols; ++i)
+	{
+		guint esi = i + rs_fec_enc->num_source_symbols; /* ESI = encoding symbol ID */
+		of_status_t status;
+
+		switch (rs_fec_enc->code_construction)
+		{
+			case GST_RS_FEC_CODE_CONSTRUCTION_VANDERMONDE:
+				if ((status = of_build_repair_symbol(rs_fec_enc->openfec_session, rs_fec_enc->encoding_symbol_table, esi)) != OF_STATUS_OK)
+				{
+					GST_ERROR_OBJECT(rs_fec_enc, "could not build repair symbol #%u: %s", i, gst_rs_fec_enc_get_status_name(status));
+					CHECK_IF_FATAL_ERROR(rs_fec_enc, status);
+					return FALSE;
+				}
+				break;
+
+			case GST_RS_FEC_CODE_CONSTRUCTION_CAUCHY:
+			case GST_RS_FEC_CODE_CONSTRUCTION_PARITY_CAUCHY:
+				gst_rs_cauchy_build_repair_symbol(rs_fec_enc->code_construction == GST_RS_FEC_CODE_CONSTRUCTION_PARITY_CAUCHY, rs_fec_enc->num_source_symbols, rs_fec_enc->encoding_symbol_table, esi, encoding_symbol_length);
+				break;
+
+			default:
+				g_assert_not_reached();
+		}
+
+		GST_LOG_OBJECT(rs_fec_enc, "built repair symbol #%u", i);
+	}
+
+	return TRUE;
+}
+
+
+static void gst_rs_fec_enc_set_caps_fields(GstRSFECEnc *rs_fec_enc, GstCaps *caps)
+{
+	/* The code construction is added to the caps to make sure that
+	 * a decoder which uses a different construction fails to
+	 * negotiate, instead of producing garbage */
+	gst_caps_set_simple(
+		caps,
+		GST_RS_FEC_CODE_CONSTRUCTION_CAPS_FIELD, G_TYPE_STRING, gst_rs_fec_code_construction_get_name(rs_fec_enc->code_construction),
+		NULL
+	);
+
+	/* The number of symbols can change while running. The decoder
+	 * takes k from the source packets, but needs the caps for
+	 * learning k in repair packets and n (see gstrsfeccommon.h). */
+	gst_caps_set_simple(
+		caps,
+		GST_RS_FEC_NUM_SOURCE_SYMBOLS_CAPS_FIELD, G_TYPE_INT, (gint)(rs_fec_enc->num_source_symbols),
+		GST_RS_FEC_NUM_REPAIR_SYMBOLS_CAPS_FIELD, G_TYPE_INT, (gint)(rs_fec_enc->num_repair_symbols),
+		NULL
+	);
+}
@@ -22,6 +22,8 @@
 
 #include <gst/gst.h>
 #include <of_openfec_api.h>
+#include "common/gstsymbolarena.h"
+#include "gstrsfeccommon.h"
 
 
 G_BEGIN_DECLS
@@ -31,10 +33,36 @@ typedef struct _GstRSFECEnc GstRSFECEnc;
 typedef struct _GstRSFECEncClass GstRSFECEncClass;
 
 
+/* How frame (or access unit) boundaries are detected in the input.
+ * If a boundary is detected, and the current source block contains
+ * at least min_source_symbols ADUs, the block is closed early, so
+ * that source blocks do not straddle frames. */
+typedef enum
+{
+	/* Frame boundaries are ignored; blocks always contain k ADUs
+	 * (unless they are closed because of max_block_duration) */
+	GST_RS_FEC_ENC_FRAME_BOUNDARY_NONE,
+	/* An ADU with the MARKER flag set is the last one of a frame
+	 * (like the RTP marker bit for video) */
+	GST_RS_FEC_ENC_FRAME_BOUNDARY_MARKER,
+	/* An ADU without the DELTA_UNIT flag set starts a new frame.
+	 * With typical video streams, this aligns blocks with keyframes. */
+	GST_RS_FEC_ENC_FRAME_BOUNDARY_KEYFRAME,
+	/* An ADU whose PTS differs from the previous ADU's PTS starts
+	 * a new frame */
+	GST_RS_FEC_ENC_FRAME_BOUNDARY_PTS
+}
+GstRSFECEncFrameBoundary;
+
+
+#define GST_TYPE_RS_FEC_ENC_FRAME_BOUNDARY (gst_rs_fec_enc_frame_boundary_get_type())
+
+
 #define GST_TYPE_RS_FEC_ENC             (gst_rs_fec_enc_get_type())
 #define GST_RS_FEC_ENC(obj)             (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_RS_FEC_ENC, GstRSFECEnc))
 #define GST_RS_FEC_ENC_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST((klass), GST_TYPE_RS_FEC_ENC, GstRSFECEncClass))
 #define GST_RS_FEC_ENC_CAST(obj)        ((GstRSFECEnc *)(obj))
+#define GST_RS_FEC_ENC_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS((obj), GST_TYPE_RS_FEC_ENC, GstRSFECEncClass))
 #define GST_IS_RS_FEC_ENC(obj)          (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_RS_FEC_ENC))
 #define GST_IS_RS_FEC_ENC_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass), GST_TYPE_RS_FEC_ENC))
 
@@ -45,19 +73,188 @@ struct _GstRSFECEnc
 
 	/* Sink- and source pads */
 	GstPad *sinkpad, *fecsourcepad, *fecrepairpad;
-	/* OpenFEC session handle */
+	/* OpenFEC session handle. This is NULL if the FEC scheme does not
+	 * use OpenFEC (see uses_openfec_session in the class structure). */
 	of_session_t *openfec_session;
-	/* Number of source and repair symbols, configured via properties.
-	 * These may only be modified if no decoding session is currently
-	 * running (that is, if openfec_session == NULL). */
+	/* TRUE between gst_rs_fec_enc_init_openfec() and
+	 * gst_rs_fec_enc_shutdown_openfec(), that is, while the tables are
+	 * allocated. Many properties can only be modified while this is FALSE. */
+	gboolean initialized;
+	/* Number of source and repair symbols of the current interleaving
+	 * group. These are configured via properties. If the class supports
+	 * it (see supports_num_symbols_changes), they can be modified while
+	 * the session is running; the new values are then stored in
+	 * next_num_source_symbols and next_num_repair_symbols (protected by
+	 * the object lock), and take effect at the start of the next
+	 * interleaving group (see gst_rs_fec_enc_apply_num_symbols() ). */
 	guint num_source_symbols, num_repair_symbols;
+	guint next_num_source_symbols, next_num_repair_symbols;
 	/* Sum of num_source_symbols and num_repair_symbols */
 	guint num_encoding_symbols;
+	/* Upper limits for num_source_symbols and num_repair_symbols while
+	 * the session is running. All tables are allocated for these many
+	 * symbols, so changing the number of symbols never reallocates them.
+	 * 0 means that the number of symbols the session starts with is the
+	 * limit. These can only be modified if initialized is FALSE. At
+	 * session start, they are raised to the configured number of symbols
+	 * if they are lower than that. */
+	guint max_source_symbols, max_repair_symbols;
+	/* TRUE if the number of symbols changed since the last time
+	 * configure_session was called */
+	gboolean num_symbols_changed;
+	/* How repair symbols are computed. OpenFEC is only used for building
+	 * repair symbols if this is set to GST_RS_FEC_CODE_CONSTRUCTION_VANDERMONDE.
+	 * Like the number of symbols, this can only be modified if
+	 * initialized is FALSE. */
+	GstRSFECCodeConstruction code_construction;
+	/* How many source blocks are filled at the same time. Consecutive
+	 * ADUs are assigned round-robin to the interleave_depth blocks of
+	 * the current "interleaving group", and the repair packets of the
+	 * group's blocks are interleaved as well. A burst of lost packets
+	 * is then spread over several blocks. 1 disables interleaving.
+	 * Like the number of symbols, this can only be modified if
+	 * initialized is FALSE. */
+	guint interleave_depth;
 	/* Counter for assigning block numbers to outgoing source blocks.
 	 * It is _not_ reset after flushes and PAUSED->READY state changes
 	 * This ensures the decoder on the other end does not get confused
-	 * because it starts seeing past source block numbers again. */
+	 * because it starts seeing past source block numbers again.
+	 * This is the number of the first block of the current interleaving
+	 * group. While the group is processed, it is set to the number of
+	 * the block whose repair symbols are being built. */
 	guint cur_source_block_nr;
+	/* Number of source symbols of the block whose repair symbols are
+	 * being built. This is num_source_symbols, unless the block is
+	 * closed early (see max_block_duration). Such a "shortened" block
+	 * is encoded as if the missing source symbols were all-zero ADUIs,
+	 * and its actual length is transmitted in the source block length
+	 * field of the FEC payload IDs of the repair packets. */
+	guint cur_source_block_length;
+	/* Number of repair symbols that are sent for the block whose repair
+	 * symbols are being built. This is num_repair_symbols, unless unequal
+	 * error protection is enabled (see uep). FEC schemes only need to
+	 * build the first cur_num_repair_symbols repair symbols, but may build
+	 * all num_repair_symbols ones; the others are discarded. */
+	guint cur_num_repair_symbols;
+
+	/* Maximum time between the arrival of the first ADU of an
+	 * interleaving group and the transmission of its repair packets,
+	 * in nanoseconds. If the group is not complete by then, it is closed
+	 * early, with shortened source blocks. 0 disables this. Partial
+	 * groups are also closed when a GAP or EOS event is received.
+	 * Can be modified at any time (protected by the object lock). */
+	GstClockTime max_block_duration;
+	/* System clock time when the first ADU of the current interleaving
+	 * group was received. The system clock is used instead of the
+	 * pipeline clock, since the duration limit refers to real time. */
+	GstClock *system_clock;
+	GstClockTime cur_block_start_time;
+	/* Pending clock entry which closes the current interleaving group
+	 * once max_block_duration has passed. NULL if no group is open or
+	 * max_block_duration is 0. Protected by the object lock, since the
+	 * entry's callback runs in a clock thread. */
+	GstClockID block_timeout_clock_id;
+
+	/* If not NONE, source blocks (or interleaving groups) are closed
+	 * early at frame boundaries, provided they contain at least
+	 * min_source_symbols ADUs (min_source_symbols * interleave_depth
+	 * with interleaving). Blocks therefore contain between
+	 * min_source_symbols and num_source_symbols ADUs. Blocks closed
+	 * early are shortened, just like with max_block_duration.
+	 * Both values can be modified at any time (protected by the
+	 * object lock). */
+	GstRSFECEncFrameBoundary frame_boundary;
+	guint min_source_symbols;
+	/* PTS of the last received ADU, for detecting frame boundaries
+	 * with GST_RS_FEC_ENC_FRAME_BOUNDARY_PTS. Set to
+	 * GST_CLOCK_TIME_NONE after a flush. */
+	GstClockTime last_adu_pts;
+
+	/* If TRUE, unequal error protection (UEP) is used: the number of
+	 * repair symbols is chosen per source block, based on the flags of
+	 * the block's ADUs. Blocks with at least one ADU that is not a
+	 * DELTA_UNIT, or that has the HEADER flag set (keyframes, parameter
+	 * sets, audio), get num_repair_symbols repair symbols. Blocks that
+	 * only contain DROPPABLE ADUs get droppable_repair_symbols, and all
+	 * others get delta_repair_symbols. num_repair_symbols is therefore
+	 * the maximum. If repair_overhead_budget is nonzero, the average
+	 * number of repair symbols is additionally limited to that many
+	 * percent of the number of source symbols. The budget is tracked in
+	 * repair_credit (in hundredths of a symbol); low priority blocks
+	 * only use credit beyond what a high priority block needs, so the
+	 * budget is spent on the blocks where losses hurt most. All of these
+	 * can be modified at any time (protected by the object lock). */
+	gboolean uep;
+	guint delta_repair_symbols;
+	guint droppable_repair_symbols;
+	guint repair_overhead_budget;
+	guint64 repair_credit;
+
+	/* If TRUE, the number of repair symbols per source block follows the
+	 * loss rate on the path (closed loop control). loss_rate is a smoothed
+	 * estimate of the fraction of lost packets, which is updated by loss
+	 * reports (see GST_FEC_LOSS_REPORT_STRUCTURE_NAME) that arrive as
+	 * upstream custom events, or by setting the "loss-rate" property.
+	 * Each block then gets min_repair_symbols plus enough repair symbols
+	 * to cover the expected losses with some margin, up to
+	 * num_repair_symbols. With UEP, this is the count for high priority
+	 * blocks, and the other counts are capped by it. All of these can be
+	 * modified at any time (protected by the object lock). */
+	gboolean adaptive_repair;
+	guint min_repair_symbols;
+	gdouble loss_rate;
+
+	/* Maximum bitrate of the FEC repair flow, in bits per second. 0 means
+	 * unlimited. If nonzero, the repair bytes (encoding_symbol_length + 6
+	 * per packet) are taken from a token bucket that is filled at this
+	 * rate, and each source block only gets as many repair symbols as the
+	 * bucket can pay for. The bucket holds repair_tokens bytes, and was
+	 * last filled at repair_tokens_update_time (system clock time, or
+	 * GST_CLOCK_TIME_NONE if the bucket is not running yet).
+	 * num_repair_budget_bytes is the number of bytes the budget allowed
+	 * for so far, and num_repair_budget_bytes_used the number of bytes
+	 * that were spent; their ratio is the budget utilization. All of
+	 * these are protected by the object lock, and max_repair_bitrate can
+	 * be modified at any time. */
+	guint max_repair_bitrate;
+	guint64 repair_tokens;
+	GstClockTime repair_tokens_update_time;
+	guint64 num_repair_budget_bytes;
+	guint64 num_repair_budget_bytes_used;
+
+	/* If repair_pacing is TRUE, the repair packets of a source block (or
+	 * interleaving group) are not pushed in one burst, but spread evenly
+	 * over the expected duration of the next block, which is estimated
+	 * from the time it took to fill this one. repair_delay additionally
+	 * delays the first repair packet of each block, for time diversity
+	 * against outages. Both can be modified at any time (protected by the
+	 * object lock). If either is in use, repair packets are put into
+	 * repair_output_queue along with their send time (system clock time),
+	 * and pushed by a task on the fecrepair pad. Once the task is started,
+	 * all repair packets and the EOS event go through the queue, to keep
+	 * their order. last_repair_send_time is the send time of the last
+	 * queued packet; send times never go backwards. The queue, the task
+	 * state, and repair_output_clock_id (the clock entry the task waits
+	 * on) are protected by repair_output_mutex. If repair_output_flushing
+	 * is TRUE, the task is shutting down, and nothing is queued anymore.
+	 * repair_output_flow_return is the result of the task's last push,
+	 * which is returned to upstream. repair_send_interval is the pacing
+	 * interval of the last processed block (0 if that block had none),
+	 * which is reused for repair packets that are pushed outside of block
+	 * processing (see gst_rs_fec_enc_get_repair_send_times() ). It is
+	 * reset to 0 by flushes and the PAUSED->READY state change, and only
+	 * accessed with the sinkpad's stream lock held. */
+	gboolean repair_pacing;
+	GstClockTime repair_delay;
+	GstClockTime last_repair_send_time;
+	GstClockTime repair_send_interval;
+	GQueue repair_output_queue;
+	GMutex repair_output_mutex;
+	GCond repair_output_cond;
+	GstClockID repair_output_clock_id;
+	gboolean repair_output_task_started;
+	gboolean repair_output_flushing;
+	GstFlowReturn repair_output_flow_return;
 	/* TRUE if no FEC source packet has been pushed downstream yet.
 	 * This is set to TRUE at startup, after a flush, and when switching
 	 * back state from PAUSED to READY. */
@@ -67,22 +264,84 @@ struct _GstRSFECEnc
 	 * back state from PAUSED to READY. */
 	gboolean first_repair_packet;
 
+	/* If nonzero, incoming ADUs are split into fragments of at most
+	 * max_fragment_size bytes, and each fragment is prepended with a
+	 * fragment header (see GST_RS_FEC_FRAGMENT_HEADER_SIZE) and treated
+	 * as a separate ADU. This lifts the 65535 byte limit for ADUs, and
+	 * keeps source and repair packets below the MTU. Like the number
+	 * of symbols, this can only be modified if initialized is FALSE.
+	 * next_adu_nr is the ADU number written into the fragment headers
+	 * of the next ADU. */
+	guint max_fragment_size;
+	guint next_adu_nr;
+
+	/* If nonzero, small ADUs (or fragments) are coalesced into "packs" of
+	 * up to pack_size bytes, which are then treated as one ADU each (see
+	 * GST_RS_FEC_PACKED_CAPS_FIELD for the layout). This reduces the
+	 * packet rate and the per-packet overhead of flows with small ADUs.
+	 * pending_pack is the pack that is currently being filled, or NULL.
+	 * It is handed over to the source block once it is full, at frame
+	 * boundaries, and before an incomplete source block is closed. Like
+	 * the number of symbols, pack_size can only be modified if
+	 * initialized is FALSE. */
+	guint pack_size;
+	GstBuffer *pending_pack;
+
+	/* If nonzero, the input is treated as a byte stream (for example,
+	 * MPEG-TS), which is sliced into ADUs of exactly adu_size bytes. The
+	 * ADUs refer to the memory of the input buffers. Bytes that do not
+	 * fill an entire ADU yet are kept in pending_bytes, and are sent as
+	 * a shorter ADU at GAP and EOS events. Like the number of symbols,
+	 * adu_size can only be modified if initialized is FALSE. */
+	guint adu_size;
+	GstBuffer *pending_bytes;
+
+	/* If TRUE, each ADU is prepended with a timestamp header which
+	 * carries its PTS (as running time) and duration (see
+	 * GST_RS_FEC_TIMESTAMPED_CAPS_FIELD), so the decoder can restore
+	 * them, even for recovered ADUs. input_segment is the most recent
+	 * segment from upstream, which is needed for converting the PTS
+	 * to running time. Like the number of symbols, transmit_timestamps
+	 * can only be modified if initialized is FALSE. */
+	gboolean transmit_timestamps;
+	GstSegment input_segment;
+
 	/* Length of encoding symbols, in bytes, which are fed into OpenFEC.
 	 * Source and repair symbols all have this same length. */
 	gsize encoding_symbol_length;
 	/* Table containing encoding symbols.
 	 * All source symbols come first, followed by the repair symbols
 	 * this table is used by OpenFEC.
-	 * the table is num_encoding_symbols long.
+	 * The table has room for max_source_symbols + max_repair_symbols
+	 * entries, of which the first num_encoding_symbols are in use.
 	 * The array index equals the ESI of the corresponding symbol. */
 	void **encoding_symbol_table;
+	/* Memory blocks for the source symbols (max_source_symbols entries,
+	 * each encoding_symbol_length bytes large). Before the repair symbols
+	 * of a block are built, the first num_source_symbols of these are
+	 * placed in the encoding_symbol_table. They are kept separately,
+	 * since the repair symbol entries in the encoding_symbol_table
+	 * start at index num_source_symbols, which can change. The memory
+	 * blocks are located in symbol_arena. */
+	void **source_symbol_table;
+	/* Slab for the source symbol memory blocks. It is only replaced if
+	 * the encoding symbol length grows beyond what the slab can hold.
+	 * If max_symbol_length is nonzero (set via property), the slab is
+	 * made large enough for symbols of that length when the session is
+	 * created. Like the number of symbols, max_symbol_length can only
+	 * be modified if initialized is FALSE. */
+	GstFECSymbolArena symbol_arena;
+	guint max_symbol_length;
 
 	/* Table for incoming ADUs.
 	 * Source block generation can only commence if enough ADUs are present
-	 * in the table. The table contains num_source_symbols entries.
-	 * Each entry holds a pointer to the GstBuffer that contains the ADU. */
+	 * in the table. The table contains max_source_symbols * interleave_depth
+	 * entries; the num_source_symbols ADUs of the group's first block come
+	 * first, followed by those of the second block etc. Each entry holds a pointer to the
+	 * GstBuffer that contains the ADU. */
 	GstBuffer **adu_table;
-	/* Counter for the number of ADUs that have come in so far.
+	/* Counter for the number of ADUs of the current interleaving group
+	 * that have come in so far.
 	 * This is incremented when new ADUs come in, and decremented after
 	 * each ADU has been processed. It is set to 0 at startup, after a
 	 * source block has been successfully generated and sent out, after
@@ -93,20 +352,41 @@ struct _GstRSFECEnc
 	 * used to calculate the encoding_symbol_length once a source block is
 	 * generated. */
 	gsize cur_max_adu_length;
+	/* Sum of the sizes of the ADUs of the current interleaving group,
+	 * in bytes. Together with cur_max_adu_length, this tells how many
+	 * bytes of padding the group's source symbols contain. */
+	gsize cur_adu_bytes;
+
+	/* If nonzero, a source block (or interleaving group) is closed early,
+	 * as a shortened block, if the next ADU would make the padding exceed
+	 * max_padding_overhead percent of its source symbol bytes. This keeps
+	 * a single large ADU from inflating the encoding symbol length of a
+	 * block of small ones. Blocks are only closed if they contain at least
+	 * min_source_symbols ADUs. num_padding_bytes and num_symbol_bytes are
+	 * the padding and source symbol bytes of all blocks since the stream
+	 * started, and last_padding_overhead is the padding fraction of the
+	 * most recent block. All of these are protected by the object lock,
+	 * and max_padding_overhead can be modified at any time. */
+	guint max_padding_overhead;
+	guint64 num_padding_bytes;
+	guint64 num_symbol_bytes;
+	gdouble last_padding_overhead;
 
 	/* Table for GstBuffers that hold FEC repair packets.
 	 * This table is filled with GstBuffers when a new source block is
 	 * created, and cleared afterwards. The table contains
-	 * num_repair_symbols entries. */
+	 * max_repair_symbols * interleave_depth entries, ordered
+	 * like the adu_table. */
 	GstBuffer **fec_repair_packet_table;
 	/* Array containing mapping information for each non-NULL entry in
 	 * the fec_repair_packet_table. Since OpenFEC itself has no
 	 * callbacks for mapping/unmapping memory, the GstBuffers from
 	 * that table have to be mapped prior to the OpenFEC symbol
-	 * building calls. This array has num_repair_symbols members. */
+	 * building calls. This array has as many members as the
+	 * fec_repair_packet_table. */
 	GstMapInfo *fec_repair_packet_map_infos;
 	/* Counter for the number of FEC repair packets in the table.
-	 * This is set to num_repair_symbols after the table was filled
+	 * This is set to the table size after the table was filled
 	 * with GstBuffers, and decremented for each newly built repair
 	 * symbol. In case an error occurs while building repair symbols,
 	 * that process is aborted, and packets are still in the table.
@@ -128,8 +408,10 @@ struct _GstRSFECEnc
 	 * from PAUSED to READY (but not after a flush!) */
 	gboolean stream_started;
 	/* TRUE if an EOS event was received from upstream.
-	 * Queued ADUs and incomplete source blocks will be discarded when
-	 * EOS is received, and no more data will be accepted.
+	 * When EOS is received, pending bytes of a byte stream are sent as
+	 * a final, shorter ADU, and the incomplete source block (or group)
+	 * is closed early as a shortened block, so its ADUs still get repair
+	 * symbols. Afterwards, no more data will be accepted.
 	 * this is set to FALSE at startup, after a flush, and when switching
 	 * back state from PAUSED to READY. */
 	gboolean eos_received;
@@ -139,11 +421,72 @@ struct _GstRSFECEnc
 struct _GstRSFECEncClass
 {
 	GstElementClass parent_class;
+
+	/* The functions and values below cover everything that depends on the
+	 * FEC scheme. The class installs the Reed-Solomon versions. Elements
+	 * for other FEC schemes (like ldpcfecenc) derive from GstRSFECEnc and
+	 * override them; the ADU and ADUI handling, the FEC payload IDs, the
+	 * source block generation and the pads are then shared. */
+
+	/* The OpenFEC codec that is used for the encoder session */
+	of_codec_id_t openfec_codec_id;
+	/* TRUE if the number of source and repair symbols can be changed
+	 * while the session is running. configure_session is then called
+	 * again with the new values, and set_caps_fields must add them to
+	 * the caps, since the decoder needs to know n for each block. */
+	gboolean supports_num_symbols_changes;
+
+	/* Returns the m value that determines the FEC payload ID layout
+	 * (see gst_rs_fec_write_payload_id() ) */
+	guint (*get_payload_id_m)(GstRSFECEnc *rs_fec_enc);
+	/* Returns the maximum allowed value for num_encoding_symbols. Called
+	 * with the object lock held. */
+	guint (*get_max_num_encoding_symbols)(GstRSFECEnc *rs_fec_enc);
+	/* Returns FALSE if the scheme cannot be used with the currently
+	 * configured properties. Called before the session is created. */
+	gboolean (*check_settings)(GstRSFECEnc *rs_fec_enc);
+	/* Returns TRUE if an OpenFEC session with openfec_codec_id is
+	 * needed for building repair symbols with the currently configured
+	 * properties. Schemes that build repair symbols on their own return
+	 * FALSE; openfec_session then stays NULL. */
+	gboolean (*uses_openfec_session)(GstRSFECEnc *rs_fec_enc);
+	/* Returns the encoding symbol length to use for a source block
+	 * whose longest ADUI has the given length */
+	gsize (*get_encoding_symbol_length)(GstRSFECEnc *rs_fec_enc, gsize max_adui_length);
+	/* Passes new FEC parameters to openfec_session. Only called if
+	 * the encoding symbol length or the number of symbols changed. */
+	gboolean (*configure_session)(GstRSFECEnc *rs_fec_enc, gsize encoding_symbol_length);
+	/* Fills the repair symbol memory blocks in the encoding_symbol_table */
+	gboolean (*build_repair_symbols)(GstRSFECEnc *rs_fec_enc, gsize encoding_symbol_length);
+	/* Adds scheme specific fields to the caps of the source pads */
+	void (*set_caps_fields)(GstRSFECEnc *rs_fec_enc, GstCaps *caps);
 };
 
 
+GType gst_rs_fec_enc_frame_boundary_get_type(void);
 GType gst_rs_fec_enc_get_type(void);
 
+/* These are for subclasses which push additional FEC repair packets outside
+ * of source block processing (like raptorqfecenc with push-repair-symbols).
+ * They must be called with the sinkpad's stream lock held, so the packets
+ * go through the same bitrate budget, pacing and output queue as the repair
+ * packets of the source blocks. */
+
+/* Takes the bytes for up to num_repair_packets repair packets out of the
+ * max-repair-bitrate token bucket, and returns the number of packets that
+ * the bucket could pay for. Without a budget, num_repair_packets is
+ * returned as-is. */
+guint gst_rs_fec_enc_take_repair_budget(GstRSFECEnc *rs_fec_enc, guint num_repair_packets, gsize repair_packet_length);
+/* Gets the send time of the first of a series of repair packets, and the
+ * interval between them, according to repair-pacing and repair-delay.
+ * first_send_time is set to GST_CLOCK_TIME_NONE if the packets shall be
+ * pushed right away. */
+void gst_rs_fec_enc_get_repair_send_times(GstRSFECEnc *rs_fec_enc, GstClockTime *first_send_time, GstClockTime *send_interval);
+/* Pushes the repair packet downstream, or queues it for the repair output
+ * task if send_time is valid or the task is already running. Takes
+ * ownership over the packet. */
+GstFlowReturn gst_rs_fec_enc_push_repair_packet(GstRSFECEnc *rs_fec_enc, GstBuffer *fec_repair_packet, GstClockTime send_time);
+
 
 G_END_DECLS
 
@@ -0,0 +1,433 @@
+/* GF(2^16) Reed-Solomon erasure code based on the additive FFT
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/* Overview of the math used here:
+ *
+ * Polynomials are represented in the "novel polynomial basis" X_i
+ * instead of the monomial basis x^i. The evaluation points are
+ * w_i = sum of the basis elements v_j selected by the bits of i.
+ * A Cantor basis is used for the v_j, that is, v_0 = 1 and
+ * v_j^2 + v_j = v_(j-1). With such a basis, the normalized subspace
+ * polynomials are s_j(x) = f(f(...f(x))) (j times) with f(x) = x^2+x,
+ * which has two useful consequences:
+ *
+ * - s_j(w_i) = w_(i >> j), so the FFT "skew" factors can be read from
+ *   the table of evaluation points
+ * - the derivative of s_j is 1, so the formal derivative of X_i is
+ *   the sum of X_(i - 2^j) over all set bits j of i
+ *
+ * Erasure decoding works by multiplying the codeword with the error
+ * locator polynomial E(x) (whose roots are the erased points), which
+ * yields a polynomial F of degree < N. Its formal derivative satisfies
+ * F'(w_e) = C(w_e) * E'(w_e) at erased points w_e, so the erased values
+ * of the codeword C are F'(w_e) / E'(w_e). The logarithms of E(w_i) and
+ * E'(w_e) are computed for all points at once with a Walsh-Hadamard
+ * transform, since log(E(w_i)) is the XOR convolution of the erasure
+ * indicator vector with the logarithms of the evaluation points. */
+
+
+#include <string.h>
+#include "common/gstgf256.h"
+#include "gstrsfft.h"
+
+
+#define GF16_NUM_BITS 16
+#define GF16_ORDER (1 << GF16_NUM_BITS)
+/* The multiplicative group has 2^16-1 elements. Logarithms are
+ * computed modulo this value. */
+#define GF16_MODULUS (GF16_ORDER - 1)
+#define GF16_PRIMITIVE_POLYNOMIAL 0x1002D
+
+
+/* The exp table is twice as long as necessary, so the sum of two
+ * logarithms can be used as index without a modulo operation */
+static guint16 gf16_exp[GF16_MODULUS * 2];
+static guint16 gf16_log[GF16_ORDER];
+/* Evaluation points w_i, and their logarithms. log(w_0) = log(0) is
+ * undefined and set to 0; see gst_rs_fft_compute_error_locator(). */
+static guint16 fft_points[GF16_ORDER];
+static guint16 fft_point_logs[GF16_ORDER];
+
+
+static guint gst_rs_fft_next_pow2(guint value)
+{
+	guint pow2 = 1;
+	while (pow2 < value)
+		pow2 <<= 1;
+	return pow2;
+}
+
+
+static guint16 gst_rs_fft_mul(guint16 a, guint16 b)
+{
+	if ((a == 0) || (b == 0))
+		return 0;
+	else
+		return gf16_exp[gf16_log[a] + gf16_log[b]];
+}
+
+
+void gst_rs_fft_init(void)
+{
+	static gsize tables_initialized = 0;
+
+	if (g_once_init_enter(&tables_initialized))
+	{
+		guint i, j, x;
+		guint16 basis[GF16_NUM_BITS];
+
+		x = 1;
+		for (i = 0; i < GF16_MODULUS; ++i)
+		{
+			gf16_exp[i] = x;
+			gf16_exp[i + GF16_MODULUS] = x;
+			gf16_log[x] = i;
+
+			x <<= 1;
+			if (x & GF16_ORDER)
+				x ^= GF16_PRIMITIVE_POLYNOMIAL;
+		}
+		gf16_log[0] = 0;
+
+		/* Find the last Cantor basis element; it is an element which
+		 * yields 1 after 15 applications of f(x) = x^2+x. The other
+		 * basis elements are the intermediate results. */
+		for (x = 2; x < GF16_ORDER; ++x)
+		{
+			guint16 y = x;
+			for (j = 0; j < (GF16_NUM_BITS - 1); ++j)
+				y = gst_rs_fft_mul(y, y) ^ y;
+			if (y == 1)
+				break;
+		}
+		g_assert(x < GF16_ORDER);
+
+		basis[GF16_NUM_BITS - 1] = x;
+		for (j = GF16_NUM_BITS - 1; j > 0; --j)
+			basis[j - 1] = gst_rs_fft_mul(basis[j], basis[j]) ^ basis[j];
+		g_assert(basis[0] == 1);
+
+		fft_points[0] = 0;
+		for (j = 0; j < GF16_NUM_BITS; ++j)
+		{
+			for (i = 0; i < (1u << j); ++i)
+				fft_points[i + (1u << j)] = fft_points[i] ^ basis[j];
+		}
+
+		for (i = 0; i < GF16_ORDER; ++i)
+			fft_point_logs[i] = gf16_log[fft_points[i]];
+
+		g_once_init_leave(&tables_initialized, 1);
+	}
+}
+
+
+gboolean gst_rs_fft_check_parameters(guint num_source_symbols, guint num_repair_symbols)
+{
+	if (num_source_symbols == 0)
+		return FALSE;
+	if ((num_source_symbols >= GF16_ORDER) || (num_repair_symbols >= GF16_ORDER))
+		return FALSE;
+	return (num_source_symbols + gst_rs_fft_next_pow2(num_repair_symbols)) <= GF16_ORDER;
+}
+
+
+/* dst = c*src , with c given as logarithm */
+static void gst_rs_fft_region_mul(guint8 *dst, guint8 const *src, guint log_c, gsize length)
+{
+	gsize i;
+
+	for (i = 0; i < length; i += 2)
+	{
+		guint w = (((guint)(src[i])) << 8) | src[i + 1];
+		if (w != 0)
+			w = gf16_exp[gf16_log[w] + log_c];
+		dst[i] = w >> 8;
+		dst[i + 1] = w & 0xFF;
+	}
+}
+
+
+/* dst += c*src , with c given as logarithm */
+static void gst_rs_fft_region_mul_add(guint8 *dst, guint8 const *src, guint log_c, gsize length)
+{
+	gsize i;
+
+	for (i = 0; i < length; i += 2)
+	{
+		guint w = (((guint)(src[i])) << 8) | src[i + 1];
+		if (w != 0)
+		{
+			w = gf16_exp[gf16_log[w] + log_c];
+			dst[i] ^= w >> 8;
+			dst[i + 1] ^= w & 0xFF;
+		}
+	}
+}
+
+
+/* Evaluates the polynomial whose size coefficients are stored in work
+ * at the points w_offset ... w_(offset+size-1). offset must be a
+ * multiple of size. The results replace the coefficients. */
+static void gst_rs_fft_fft(guint8 *work, guint size, guint offset, gsize length)
+{
+	guint half, block, i;
+
+	for (half = size >> 1; half >= 1; half >>= 1)
+	{
+		for (block = 0; block < size; block += half * 2)
+		{
+			guint16 skew = fft_points[(offset + block) / half];
+
+			for (i = block; i < (block + half); ++i)
+			{
+				guint8 *a = work + i * length;
+				guint8 *b = work + (i + half) * length;
+
+				if (skew != 0)
+					gst_rs_fft_region_mul_add(a, b, gf16_log[skew], length);
+				gst_fec_xor_region(b, a, length);
+			}
+		}
+	}
+}
+
+
+/* Inverse of gst_rs_fft_fft(); turns evaluations into coefficients */
+static void gst_rs_fft_ifft(guint8 *work, guint size, guint offset, gsize length)
+{
+	guint half, block, i;
+
+	for (half = 1; half < size; half <<= 1)
+	{
+		for (block = 0; block < size; block += half * 2)
+		{
+			guint16 skew = fft_points[(offset + block) / half];
+
+			for (i = block; i < (block + half); ++i)
+			{
+				guint8 *a = work + i * length;
+				guint8 *b = work + (i + half) * length;
+
+				gst_fec_xor_region(b, a, length);
+				if (skew != 0)
+					gst_rs_fft_region_mul_add(a, b, gf16_log[skew], length);
+			}
+		}
+	}
+}
+
+
+static void gst_rs_fft_formal_derivative(guint8 *work, guint size, gsize length)
+{
+	guint t, bit;
+
+	/* The coefficient t of the derivative is the sum of the coefficients
+	 * t + 2^j for all bits j which are not set in t. Going in ascending
+	 * order allows for doing this in place, since coefficient t only
+	 * depends on higher coefficients. */
+	for (t = 0; t < size; ++t)
+	{
+		for (bit = 1; (t + bit) < size; bit <<= 1)
+		{
+			if ((t & bit) == 0)
+				gst_fec_xor_region(work + t * length, work + (t + bit) * length, length);
+		}
+	}
+}
+
+
+static void gst_rs_fft_fwht(guint32 *data, guint size)
+{
+	guint half, block, i;
+
+	/* Walsh-Hadamard transform, modulo 2^16-1 */
+	for (half = 1; half < size; half <<= 1)
+	{
+		for (block = 0; block < size; block += half * 2)
+		{
+			for (i = block; i < (block + half); ++i)
+			{
+				guint32 x = data[i], y = data[i + half];
+				data[i] = (x + y) % GF16_MODULUS;
+				data[i + half] = (x + GF16_MODULUS - y) % GF16_MODULUS;
+			}
+		}
+	}
+}
+
+
+/* On entry, erasures[i] is 1 if point w_i is erased, and 0 otherwise.
+ * On exit, erasures[i] is log(E(w_i)) for points which are not erased,
+ * and log(E'(w_i)) for erased ones. size must be a power of two. */
+static void gst_rs_fft_compute_error_locator(guint32 *erasures, guint size)
+{
+	guint i, inv_size;
+	guint32 *point_logs = g_malloc(sizeof(guint32) * size);
+
+	/* log(E(w_i)) = sum over erased e of log(w_i + w_e) = log(w_(i^e)),
+	 * an XOR convolution. For erased points, the zero factor w_e + w_e
+	 * is skipped by treating log(w_0) as 0. This yields the logarithm
+	 * of the product of all other factors, which is E'(w_e). */
+	for (i = 0; i < size; ++i)
+		point_logs[i] = fft_point_logs[i];
+
+	gst_rs_fft_fwht(point_logs, size);
+	gst_rs_fft_fwht(erasures, size);
+	for (i = 0; i < size; ++i)
+		erasures[i] = ((guint64)(erasures[i]) * point_logs[i]) % GF16_MODULUS;
+	gst_rs_fft_fwht(erasures, size);
+
+	/* The transform needs to be scaled by 1/size. Since 2^16 = 1 mod
+	 * (2^16-1), the inverse of size = 2^l is 2^(16-l). */
+	inv_size = GF16_ORDER / size;
+	for (i = 0; i < size; ++i)
+		erasures[i] = ((guint64)(erasures[i]) * inv_size) % GF16_MODULUS;
+
+	g_free(point_logs);
+}
+
+
+void gst_rs_fft_build_repair_symbols(guint num_source_symbols, guint num_repair_symbols, void * const *encoding_symbol_table, gsize encoding_symbol_length)
+{
+	guint i, chunk_start;
+	guint m = gst_rs_fft_next_pow2(num_repair_symbols);
+	gsize const length = encoding_symbol_length;
+	guint8 *work, *accum, *chunk;
+
+	g_assert((length & 1) == 0);
+	g_assert(gst_rs_fft_check_parameters(num_source_symbols, num_repair_symbols));
+
+	work = g_malloc(m * 2 * length);
+	accum = work;
+	chunk = work + m * length;
+
+	/* The source symbols are located at positions m ... m+k-1. Split them
+	 * into chunks of m symbols, and interpolate each chunk on its own
+	 * coset. The sum of the interpolated polynomials, evaluated at the
+	 * first m points, yields the repair symbols. This works, since the
+	 * codeword needs a zero top coefficient block, and the top block of
+	 * the full size interpolation is the sum of the per-chunk ones. */
+	for (chunk_start = 0; chunk_start < num_source_symbols; chunk_start += m)
+	{
+		guint8 *dest = (chunk_start == 0) ? accum : chunk;
+		guint num_chunk_symbols = MIN(m, num_source_symbols - chunk_start);
+
+		for (i = 0; i < num_chunk_symbols; ++i)
+			memcpy(dest + i * length, encoding_symbol_table[chunk_start + i], length);
+		if (num_chunk_symbols < m)
+			memset(dest + num_chunk_symbols * length, 0, (m - num_chunk_symbols) * length);
+
+		gst_rs_fft_ifft(dest, m, m + chunk_start, length);
+
+		if (dest != accum)
+			gst_fec_xor_region(accum, chunk, m * length);
+	}
+
+	gst_rs_fft_fft(accum, m, 0, length);
+
+	for (i = 0; i < num_repair_symbols; ++i)
+		memcpy(encoding_symbol_table[num_source_symbols + i], accum + i * length, length);
+
+	g_free(work);
+}
+
+
+gboolean gst_rs_fft_decode(guint num_source_symbols, guint num_repair_symbols, void * const *received_encoding_symbol_table, void * const *recovered_source_symbol_table, gsize encoding_symbol_length)
+{
+	guint i, num_missing = 0, num_received_repair = 0;
+	guint m, size;
+	gsize const length = encoding_symbol_length;
+	guint32 *error_locator;
+	guint8 *work;
+
+	g_assert((length & 1) == 0);
+	g_assert(gst_rs_fft_check_parameters(num_source_symbols, num_repair_symbols));
+
+	for (i = 0; i < num_source_symbols; ++i)
+	{
+		if (received_encoding_symbol_table[i] == NULL)
+			num_missing++;
+	}
+
+	if (num_missing == 0)
+		return TRUE;
+
+	for (i = 0; i < num_repair_symbols; ++i)
+	{
+		if (received_encoding_symbol_table[num_source_symbols + i] != NULL)
+			num_received_repair++;
+	}
+
+	if (num_received_repair < num_missing)
+		return FALSE;
+
+	m = gst_rs_fft_next_pow2(num_repair_symbols);
+	size = gst_rs_fft_next_pow2(m + num_source_symbols);
+
+	/* Mark the erased points. The repair positions r ... m-1 are never
+	 * transmitted, so they count as erased. Positions from m+k on are
+	 * known to be zero, so they count as received. */
+	error_locator = g_malloc0(sizeof(guint32) * size);
+	for (i = 0; i < m; ++i)
+		error_locator[i] = (i >= num_repair_symbols) || (received_encoding_symbol_table[num_source_symbols + i] == NULL);
+	for (i = 0; i < num_source_symbols; ++i)
+		error_locator[m + i] = (received_encoding_symbol_table[i] == NULL);
+
+	gst_rs_fft_compute_error_locator(error_locator, size);
+
+	/* Multiply the received symbols with E(w_i), and set the
+	 * erased and zero positions to zero */
+	work = g_malloc(size * length);
+	for (i = 0; i < (m + num_source_symbols); ++i)
+	{
+		guint8 const *symbol;
+
+		if (i < m)
+			symbol = (i < num_repair_symbols) ? received_encoding_symbol_table[num_source_symbols + i] : NULL;
+		else
+			symbol = received_encoding_symbol_table[i - m];
+
+		if (symbol != NULL)
+			gst_rs_fft_region_mul(work + i * length, symbol, error_locator[i], length);
+		else
+			memset(work + i * length, 0, length);
+	}
+	memset(work + (m + num_source_symbols) * length, 0, (size - m - num_source_symbols) * length);
+
+	/* Compute F'(w_i) for all points */
+	gst_rs_fft_ifft(work, size, 0, length);
+	gst_rs_fft_formal_derivative(work, size, length);
+	gst_rs_fft_fft(work, size, 0, length);
+
+	/* Divide by E'(w_e) to get the missing source symbols */
+	for (i = 0; i < num_source_symbols; ++i)
+	{
+		if (received_encoding_symbol_table[i] != NULL)
+			continue;
+
+		g_assert(recovered_source_symbol_table[i] != NULL);
+		gst_rs_fft_region_mul(recovered_source_symbol_table[i], work + (m + i) * length, (GF16_MODULUS - error_locator[m + i]) % GF16_MODULUS, length);
+	}
+
+	g_free(work);
+	g_free(error_locator);
+
+	return TRUE;
+}
@@ -0,0 +1,70 @@
+/* GF(2^16) Reed-Solomon erasure code based on the additive FFT
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef GSTFECFRAME_REED_SOLOMON_RSFFT_H
+#define GSTFECFRAME_REED_SOLOMON_RSFFT_H
+
+#include <gst/gst.h>
+
+
+G_BEGIN_DECLS
+
+
+/* Systematic Reed-Solomon erasure code over GF(2^16), using the additive
+ * FFT by Lin, Chung and Han ("Novel polynomial basis and its application to
+ * Reed-Solomon erasure codes", 2014). This is the same approach the Leopard
+ * codec takes. Encoding and decoding cost O(n log n) symbol operations
+ * instead of the O(k*n) of the matrix based constructions, which makes
+ * source blocks with thousands of symbols feasible.
+ *
+ * The codewords are evaluations of a polynomial of degree < N-m at the
+ * N points of a GF(2) subspace of GF(2^16), where m is the smallest power
+ * of two that is >= the number of repair symbols, and N is the smallest
+ * power of two that is >= k+m. The m repair positions come first, followed
+ * by the k source positions. Positions beyond that are zero and never
+ * transmitted; the same applies to repair positions r..m-1. Since the code
+ * is MDS, any k received encoding symbols suffice for recovery.
+ *
+ * Symbols are sequences of 16-bit big endian field elements, so the
+ * encoding symbol length must be even. k+m must not exceed 65536.
+ * The symbol tables have the same layout as the ones used by OpenFEC:
+ * source symbols come first, followed by the repair symbols, and the
+ * array index equals the ESI. */
+
+
+/* Must be called before any other function in this file is used. */
+void gst_rs_fft_init(void);
+
+/* Returns TRUE if the given symbol counts can be used with this code. */
+gboolean gst_rs_fft_check_parameters(guint num_source_symbols, guint num_repair_symbols);
+
+/* Computes all repair symbols at once. encoding_symbol_table is
+ * num_source_symbols+num_repair_symbols long; the repair symbols
+ * are written to the memory blocks the last num_repair_symbols
+ * entries point to. */
+void gst_rs_fft_build_repair_symbols(guint num_source_symbols, guint num_repair_symbols, void * const *encoding_symbol_table, gsize encoding_symbol_length);
+
+/* Same semantics as gst_rs_cauchy_decode(). */
+gboolean gst_rs_fft_decode(guint num_source_symbols, guint num_repair_symbols, void * const *received_encoding_symbol_table, void * const *recovered_source_symbol_table, gsize encoding_symbol_length);
+
+
+G_END_DECLS
+
+
+#endif
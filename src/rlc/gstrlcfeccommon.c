@@ -0,0 +1,162 @@
+/* RFC 8681-based sliding window forward error correction for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include "gstrlcfeccommon.h"
+
+
+/* TinyMT32 as specified by RFC 8680, with the parameter set
+ * that RFC 8681 uses for generating coding coefficients */
+
+#define TINYMT32_MAT1 0x8f7011eeu
+#define TINYMT32_MAT2 0xfc78ff1fu
+#define TINYMT32_TMAT 0x3793fdffu
+#define TINYMT32_SH0 1
+#define TINYMT32_SH1 10
+#define TINYMT32_SH8 8
+#define TINYMT32_MASK 0x7fffffffu
+#define TINYMT32_MIN_LOOP 8
+#define TINYMT32_PRE_LOOP 8
+
+
+typedef struct
+{
+	guint32 status[4];
+}
+GstRLCTinyMT32;
+
+
+static void gst_rlc_tinymt32_next_state(GstRLCTinyMT32 *s)
+{
+	guint32 x, y;
+
+	y = s->status[3];
+	x = (s->status[0] & TINYMT32_MASK) ^ s->status[1] ^ s->status[2];
+	x ^= (x << TINYMT32_SH0);
+	y ^= (y >> TINYMT32_SH0) ^ x;
+	s->status[0] = s->status[1];
+	s->status[1] = s->status[2];
+	s->status[2] = x ^ (y << TINYMT32_SH1);
+	s->status[3] = y;
+	s->status[1] ^= (guint32)(-((gint32)(y & 1))) & TINYMT32_MAT1;
+	s->status[2] ^= (guint32)(-((gint32)(y & 1))) & TINYMT32_MAT2;
+}
+
+
+static guint32 gst_rlc_tinymt32_generate_uint32(GstRLCTinyMT32 *s)
+{
+	guint32 t0, t1;
+
+	gst_rlc_tinymt32_next_state(s);
+
+	t0 = s->status[3];
+	t1 = s->status[0] + (s->status[2] >> TINYMT32_SH8);
+	t0 ^= t1;
+	t0 ^= (guint32)(-((gint32)(t1 & 1))) & TINYMT32_TMAT;
+
+	return t0;
+}
+
+
+static void gst_rlc_tinymt32_init(GstRLCTinyMT32 *s, guint32 seed)
+{
+	guint32 i;
+
+	s->status[0] = seed;
+	s->status[1] = TINYMT32_MAT1;
+	s->status[2] = TINYMT32_MAT2;
+	s->status[3] = TINYMT32_TMAT;
+
+	for (i = 1; i < TINYMT32_MIN_LOOP; ++i)
+		s->status[i & 3] ^= i + 1812433253u * (s->status[(i - 1) & 3] ^ (s->status[(i - 1) & 3] >> 30));
+
+	/* Period certification; the all-zero state is not allowed */
+	if (((s->status[0] & TINYMT32_MASK) == 0) && (s->status[1] == 0) && (s->status[2] == 0) && (s->status[3] == 0))
+	{
+		s->status[0] = 'T';
+		s->status[1] = 'I';
+		s->status[2] = 'N';
+		s->status[3] = 'Y';
+	}
+
+	for (i = 0; i < TINYMT32_PRE_LOOP; ++i)
+		gst_rlc_tinymt32_next_state(s);
+}
+
+
+void gst_rlc_fec_write_source_payload_id(guint8 *payload_id, guint32 esi)
+{
+	payload_id[0] = (esi >> 24) & 0xFF;
+	payload_id[1] = (esi >> 16) & 0xFF;
+	payload_id[2] = (esi >> 8) & 0xFF;
+	payload_id[3] = (esi >> 0) & 0xFF;
+}
+
+
+guint32 gst_rlc_fec_read_source_payload_id(guint8 const *payload_id)
+{
+	return (((guint32)(payload_id[0])) << 24) | (((guint32)(payload_id[1])) << 16) | (((guint32)(payload_id[2])) << 8) | ((guint32)(payload_id[3]));
+}
+
+
+void gst_rlc_fec_write_repair_payload_id(guint8 *payload_id, guint repair_key, guint dt, guint nss, guint32 first_esi)
+{
+	payload_id[0] = (repair_key >> 8) & 0xFF;
+	payload_id[1] = (repair_key >> 0) & 0xFF;
+	payload_id[2] = ((dt & 0x0F) << 4) | ((nss >> 8) & 0x0F);
+	payload_id[3] = (nss >> 0) & 0xFF;
+	gst_rlc_fec_write_source_payload_id(payload_id + 4, first_esi);
+}
+
+
+void gst_rlc_fec_read_repair_payload_id(guint8 const *payload_id, guint *repair_key, guint *dt, guint *nss, guint32 *first_esi)
+{
+	if (repair_key != NULL)
+		*repair_key = (((guint)(payload_id[0])) << 8) | ((guint)(payload_id[1]));
+	if (dt != NULL)
+		*dt = payload_id[2] >> 4;
+	if (nss != NULL)
+		*nss = ((((guint)(payload_id[2])) & 0x0F) << 8) | ((guint)(payload_id[3]));
+	if (first_esi != NULL)
+		*first_esi = gst_rlc_fec_read_source_payload_id(payload_id + 4);
+}
+
+
+void gst_rlc_fec_generate_coding_coefficients(guint repair_key, guint8 *coefs, guint num_coefs, guint dt)
+{
+	GstRLCTinyMT32 s;
+	guint i;
+
+	gst_rlc_tinymt32_init(&s, repair_key);
+
+	for (i = 0; i < num_coefs; ++i)
+	{
+		/* With the maximum density, no random value is consumed for
+		 * deciding whether or not the coefficient is zero */
+		if ((dt == GST_RLC_FEC_DT_DENSE) || ((gst_rlc_tinymt32_generate_uint32(&s) & 0x0F) <= dt))
+		{
+			do
+			{
+				coefs[i] = gst_rlc_tinymt32_generate_uint32(&s) & 0xFF;
+			}
+			while (coefs[i] == 0);
+		}
+		else
+			coefs[i] = 0;
+	}
+}
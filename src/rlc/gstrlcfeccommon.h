@@ -0,0 +1,71 @@
+/* RFC 8681-based sliding window forward error correction for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef GSTFECFRAME_RLC_RLCFECCOMMON_H
+#define GSTFECFRAME_RLC_RLCFECCOMMON_H
+
+#include <gst/gst.h>
+
+
+G_BEGIN_DECLS
+
+
+/* FEC payload IDs of the RLC scheme over GF(2^8) (RFC 8681 section 4.1).
+ *
+ * FEC source packets: ADU, followed by the 32-bit ESI of the source symbol.
+ *
+ * FEC repair packets: 16-bit repair key, 4-bit density threshold (DT),
+ * 12-bit number of source symbols in the encoding window (NSS), and the
+ * 32-bit ESI of the first source symbol in the window, followed by the
+ * repair symbol. The encoding window always consists of the NSS
+ * consecutive source symbols starting at that ESI.
+ *
+ * All values are big endian. */
+#define GST_RLC_FEC_SOURCE_PAYLOAD_ID_LENGTH 4
+#define GST_RLC_FEC_REPAIR_PAYLOAD_ID_LENGTH 8
+
+/* NSS has 12 bits, which limits the size of the encoding window */
+#define GST_RLC_FEC_MAX_WINDOW_SIZE 4095
+
+/* With this density threshold, all coding coefficients are nonzero */
+#define GST_RLC_FEC_DT_DENSE 15
+
+/* Signed distance between two ESIs. ESIs wrap around at 2^32, so
+ * a positive value means that a is newer than b. */
+#define GST_RLC_FEC_ESI_DIFF(a, b) ((gint32)((guint32)(a) - (guint32)(b)))
+
+
+void gst_rlc_fec_write_source_payload_id(guint8 *payload_id, guint32 esi);
+guint32 gst_rlc_fec_read_source_payload_id(guint8 const *payload_id);
+void gst_rlc_fec_write_repair_payload_id(guint8 *payload_id, guint repair_key, guint dt, guint nss, guint32 first_esi);
+void gst_rlc_fec_read_repair_payload_id(guint8 const *payload_id, guint *repair_key, guint *dt, guint *nss, guint32 *first_esi);
+
+/* Generates the coding coefficients of one repair symbol the way RFC 8681
+ * section 3.6 specifies it, with the TinyMT32 PRNG from RFC 8680 seeded
+ * with the repair key. Coefficient i belongs to the i-th source symbol of
+ * the encoding window. With dt < GST_RLC_FEC_DT_DENSE, some coefficients
+ * are zero. Encoder and decoder must produce the exact same values, so
+ * this must not be changed. */
+void gst_rlc_fec_generate_coding_coefficients(guint repair_key, guint8 *coefs, guint num_coefs, guint dt);
+
+
+G_END_DECLS
+
+
+#endif
@@ -0,0 +1,1181 @@
+/* RFC 8681-based sliding window forward error correction for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/**
+ * GstRLCFECDec is a decoder element for the sliding window Random Linear
+ * Codes (RLC) FEC scheme over GF(2^8) from RFC 8681. See GstRLCFECEnc for
+ * an overview of the scheme.
+ *
+ * Incoming FEC source packets are pushed downstream immediately. Their ADUs
+ * are also stored in the decoding window, since they are needed to remove
+ * the contribution of the received source symbols from repair symbols.
+ *
+ * Each FEC repair packet describes a linear equation: its repair symbol is
+ * the sum of the source symbols in its encoding window, multiplied by the
+ * coding coefficients derived from its repair key. All known source symbols
+ * are eliminated from the equation right away, so it only refers to the
+ * missing ones. The decoder keeps these equations in reduced row echelon
+ * form (incremental Gaussian elimination): every equation has a "pivot",
+ * which is one of its missing source symbols. The pivot's coefficient is 1,
+ * and the coefficients of all other equations at that source symbol are 0.
+ * Once an equation has no coefficient other than its pivot left, its
+ * symbol equals the missing source symbol, which is then recovered and
+ * pushed downstream. Each incoming packet therefore only costs a few row
+ * operations, instead of solving the entire system again.
+ *
+ * Since recovered ADUs are pushed as soon as possible, the output is not
+ * sorted. An element downstream (like an rtpjitterbuffer) has to reorder
+ * ADUs if necessary.
+ *
+ * The "window-size" property defines the size of the decoding window. Source
+ * symbols that are older than the newest ESI seen minus the window size are
+ * forgotten, and equations which refer to such old source symbols are
+ * discarded. The decoding window must be at least as large as the encoder's
+ * encoding window, otherwise repair symbols will be discarded as too old.
+ * Larger decoding windows allow for recovering source symbols with repair
+ * symbols from later encoding windows, at the cost of more memory usage
+ * and a higher latency for recovered ADUs.
+ */
+
+
+#include <string.h>
+#include "common/gstgf256.h"
+#include "gstrlcfeccommon.h"
+#include "gstrlcfecdec.h"
+
+
+GST_DEBUG_CATEGORY(rlc_fec_dec_debug);
+#define GST_CAT_DEFAULT rlc_fec_dec_debug
+
+
+enum
+{
+	PROP_0,
+	PROP_WINDOW_SIZE,
+	PROP_DO_TIMESTAMP
+};
+
+
+#define DEFAULT_WINDOW_SIZE 64
+#define DEFAULT_DO_TIMESTAMP TRUE
+
+
+#define FEC_SOURCE_CAPS_STR "application/x-fec-source-flow, encoding-id = (int) 10"
+#define FEC_REPAIR_CAPS_STR "application/x-fec-repair-flow, encoding-id = (int) 10"
+
+
+#define RLC_LOCK_MUTEX(obj) do { g_mutex_lock(&(((GstRLCFECDec *)(obj))->mutex)); } while (0)
+#define RLC_UNLOCK_MUTEX(obj) do { g_mutex_unlock(&(((GstRLCFECDec *)(obj))->mutex)); } while (0)
+
+
+static GstStaticPadTemplate static_fecsource_template = GST_STATIC_PAD_TEMPLATE(
+	"fecsource",
+	GST_PAD_SINK,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS(FEC_SOURCE_CAPS_STR)
+);
+
+
+static GstStaticPadTemplate static_fecrepair_template = GST_STATIC_PAD_TEMPLATE(
+	"fecrepair",
+	GST_PAD_SINK,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS(FEC_REPAIR_CAPS_STR)
+);
+
+
+static GstStaticPadTemplate static_src_template = GST_STATIC_PAD_TEMPLATE(
+	"src",
+	GST_PAD_SRC,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS_ANY
+);
+
+
+
+
+G_DEFINE_TYPE(GstRLCFECDec, gst_rlc_fec_dec, GST_TYPE_ELEMENT)
+
+
+
+
+static void gst_rlc_fec_dec_finalize(GObject *object);
+static void gst_rlc_fec_dec_set_property(GObject *object, guint prop_id, GValue const *value, GParamSpec *pspec);
+static void gst_rlc_fec_dec_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec);
+
+static GstStateChangeReturn gst_rlc_fec_dec_change_state(GstElement *element, GstStateChange transition);
+
+static gboolean gst_rlc_fec_dec_fecsource_event(GstPad *pad, GstObject *parent, GstEvent *event);
+static gboolean gst_rlc_fec_dec_fecrepair_event(GstPad *pad, GstObject *parent, GstEvent *event);
+static GstFlowReturn gst_rlc_fec_dec_fecsource_chain(GstPad *pad, GstObject *parent, GstBuffer *buffer);
+static GstFlowReturn gst_rlc_fec_dec_fecrepair_chain(GstPad *pad, GstObject *parent, GstBuffer *buffer);
+
+static void gst_rlc_fec_dec_alloc_tables(GstRLCFECDec *rlc_fec_dec);
+static void gst_rlc_fec_dec_free_tables(GstRLCFECDec *rlc_fec_dec);
+
+static GstFlowReturn gst_rlc_fec_dec_insert_source_packet(GstRLCFECDec *rlc_fec_dec, GstBuffer *fec_source_packet);
+static GstFlowReturn gst_rlc_fec_dec_insert_repair_packet(GstRLCFECDec *rlc_fec_dec, GstBuffer *fec_repair_packet);
+
+static GstBuffer* gst_rlc_fec_dec_get_known_adu(GstRLCFECDec *rlc_fec_dec, guint32 esi);
+static void gst_rlc_fec_dec_set_known_adu(GstRLCFECDec *rlc_fec_dec, guint32 esi, GstBuffer *adu);
+static gboolean gst_rlc_fec_dec_is_esi_in_window(GstRLCFECDec *rlc_fec_dec, guint32 esi);
+static void gst_rlc_fec_dec_update_newest_esi(GstRLCFECDec *rlc_fec_dec, guint32 esi);
+
+static GstFlowReturn gst_rlc_fec_dec_add_equation(GstRLCFECDec *rlc_fec_dec, GstRLCFECDecEquation *equation);
+static GstFlowReturn gst_rlc_fec_dec_recover_adus(GstRLCFECDec *rlc_fec_dec);
+
+static void gst_rlc_fec_dec_equation_free(GstRLCFECDecEquation *equation);
+static guint8 gst_rlc_fec_dec_equation_get_coef(GstRLCFECDecEquation const *equation, guint32 esi);
+static void gst_rlc_fec_dec_equation_extend(GstRLCFECDecEquation *equation, guint32 first_esi, guint32 last_esi, gsize symbol_length);
+static gboolean gst_rlc_fec_dec_equation_trim(GstRLCFECDecEquation *equation);
+static void gst_rlc_fec_dec_equation_add(GstRLCFECDecEquation *dest, GstRLCFECDecEquation const *src, guint8 c);
+static void gst_rlc_fec_dec_equation_eliminate_adu(GstRLCFECDecEquation *equation, guint32 esi, GstBuffer *adu);
+
+static void gst_rlc_fec_dec_reset_states(GstRLCFECDec *rlc_fec_dec);
+static void gst_rlc_fec_dec_flush(GstRLCFECDec *rlc_fec_dec);
+static GstFlowReturn gst_rlc_fec_dec_push_adu(GstRLCFECDec *rlc_fec_dec, GstBuffer *adu);
+static void gst_rlc_fec_dec_push_stream_start(GstRLCFECDec *rlc_fec_dec);
+static void gst_rlc_fec_dec_push_segment(GstRLCFECDec *rlc_fec_dec);
+static void gst_rlc_fec_dec_push_eos(GstRLCFECDec *rlc_fec_dec);
+
+
+
+
+static void gst_rlc_fec_dec_class_init(GstRLCFECDecClass *klass)
+{
+	GObjectClass *object_class;
+	GstElementClass *element_class;
+
+	GST_DEBUG_CATEGORY_INIT(rlc_fec_dec_debug, "rlcfecdec", 0, "FECFRAME RFC 8681 sliding window RLC scheme decoder");
+
+	gst_fec_gf256_init();
+
+	object_class = G_OBJECT_CLASS(klass);
+	element_class = GST_ELEMENT_CLASS(klass);
+
+	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_fecsource_template));
+	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_fecrepair_template));
+	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_src_template));
+
+	object_class->finalize      = GST_DEBUG_FUNCPTR(gst_rlc_fec_dec_finalize);
+	object_class->set_property  = GST_DEBUG_FUNCPTR(gst_rlc_fec_dec_set_property);
+	object_class->get_property  = GST_DEBUG_FUNCPTR(gst_rlc_fec_dec_get_property);
+
+	element_class->change_state = GST_DEBUG_FUNCPTR(gst_rlc_fec_dec_change_state);
+
+	g_object_class_install_property(
+		object_class,
+		PROP_WINDOW_SIZE,
+		g_param_spec_uint(
+			"window-size",
+			"Window size",
+			"Number of source symbols in the decoding window (must be at least as large as the encoder's window size)",
+			1, 65535,
+			DEFAULT_WINDOW_SIZE,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_DO_TIMESTAMP,
+		g_param_spec_boolean(
+			"do-timestamp",
+			"Do timestamping",
+			"Apply the current running time to outgoing ADUs",
+			DEFAULT_DO_TIMESTAMP,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+
+	gst_element_class_set_static_metadata(
+		element_class,
+		"Sliding window RLC forward error correction decoder",
+		"Codec/Decoder/Network",
+		"Decoder for forward-error erasure coding based on the FECFRAME sliding window RLC scheme RFC 8681",
+		"Carlos Rafael Giani <dv@pseudoterminal.org>"
+	);
+}
+
+
+static void gst_rlc_fec_dec_init(GstRLCFECDec *rlc_fec_dec)
+{
+	rlc_fec_dec->window_size = DEFAULT_WINDOW_SIZE;
+	rlc_fec_dec->do_timestamp = DEFAULT_DO_TIMESTAMP;
+
+	rlc_fec_dec->known_adus = NULL;
+	rlc_fec_dec->known_esis = NULL;
+	rlc_fec_dec->table_size = 0;
+
+	rlc_fec_dec->equations = NULL;
+	rlc_fec_dec->num_equations = 0;
+
+	rlc_fec_dec->newest_esi = 0;
+	rlc_fec_dec->has_newest_esi = FALSE;
+
+	g_mutex_init(&(rlc_fec_dec->mutex));
+
+	rlc_fec_dec->segment_started = FALSE;
+	rlc_fec_dec->stream_started = FALSE;
+	rlc_fec_dec->fecsource_eos = FALSE;
+	rlc_fec_dec->fecrepair_eos = FALSE;
+
+	rlc_fec_dec->fecsourcepad = gst_ghost_pad_new_no_target_from_template(
+		"fecsource",
+		gst_element_class_get_pad_template(GST_ELEMENT_GET_CLASS(rlc_fec_dec), "fecsource")
+	);
+	gst_element_add_pad(GST_ELEMENT(rlc_fec_dec), rlc_fec_dec->fecsourcepad);
+
+	rlc_fec_dec->fecrepairpad = gst_ghost_pad_new_no_target_from_template(
+		"fecrepair",
+		gst_element_class_get_pad_template(GST_ELEMENT_GET_CLASS(rlc_fec_dec), "fecrepair")
+	);
+	gst_element_add_pad(GST_ELEMENT(rlc_fec_dec), rlc_fec_dec->fecrepairpad);
+
+	rlc_fec_dec->srcpad = gst_ghost_pad_new_no_target_from_template(
+		"src",
+		gst_element_class_get_pad_template(GST_ELEMENT_GET_CLASS(rlc_fec_dec), "src")
+	);
+	gst_element_add_pad(GST_ELEMENT(rlc_fec_dec), rlc_fec_dec->srcpad);
+
+	gst_pad_set_event_function(rlc_fec_dec->fecsourcepad, GST_DEBUG_FUNCPTR(gst_rlc_fec_dec_fecsource_event));
+	gst_pad_set_event_function(rlc_fec_dec->fecrepairpad, GST_DEBUG_FUNCPTR(gst_rlc_fec_dec_fecrepair_event));
+
+	gst_pad_set_chain_function(rlc_fec_dec->fecsourcepad, GST_DEBUG_FUNCPTR(gst_rlc_fec_dec_fecsource_chain));
+	gst_pad_set_chain_function(rlc_fec_dec->fecrepairpad, GST_DEBUG_FUNCPTR(gst_rlc_fec_dec_fecrepair_chain));
+}
+
+
+static void gst_rlc_fec_dec_finalize(GObject *object)
+{
+	GstRLCFECDec *rlc_fec_dec = GST_RLC_FEC_DEC(object);
+
+	g_mutex_clear(&(rlc_fec_dec->mutex));
+
+	G_OBJECT_CLASS(gst_rlc_fec_dec_parent_class)->finalize(object);
+}
+
+
+static void gst_rlc_fec_dec_set_property(GObject *object, guint prop_id, GValue const *value, GParamSpec *pspec)
+{
+	GstRLCFECDec *rlc_fec_dec = GST_RLC_FEC_DEC(object);
+
+	switch (prop_id)
+	{
+		case PROP_WINDOW_SIZE:
+			RLC_LOCK_MUTEX(rlc_fec_dec);
+			if (rlc_fec_dec->known_adus == NULL)
+				rlc_fec_dec->window_size = g_value_get_uint(value);
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set window size after the decoding window was allocated"), (NULL));
+			RLC_UNLOCK_MUTEX(rlc_fec_dec);
+			break;
+
+		case PROP_DO_TIMESTAMP:
+			RLC_LOCK_MUTEX(rlc_fec_dec);
+			rlc_fec_dec->do_timestamp = g_value_get_boolean(value);
+			RLC_UNLOCK_MUTEX(rlc_fec_dec);
+			break;
+
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+			break;
+	}
+}
+
+
+static void gst_rlc_fec_dec_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec)
+{
+	GstRLCFECDec *rlc_fec_dec = GST_RLC_FEC_DEC(object);
+
+	switch (prop_id)
+	{
+		case PROP_WINDOW_SIZE:
+			RLC_LOCK_MUTEX(rlc_fec_dec);
+			g_value_set_uint(value, rlc_fec_dec->window_size);
+			RLC_UNLOCK_MUTEX(rlc_fec_dec);
+			break;
+
+		case PROP_DO_TIMESTAMP:
+			RLC_LOCK_MUTEX(rlc_fec_dec);
+			g_value_set_boolean(value, rlc_fec_dec->do_timestamp);
+			RLC_UNLOCK_MUTEX(rlc_fec_dec);
+			break;
+
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+			break;
+	}
+}
+
+
+static GstStateChangeReturn gst_rlc_fec_dec_change_state(GstElement *element, GstStateChange transition)
+{
+	GstRLCFECDec *rlc_fec_dec = GST_RLC_FEC_DEC(element);
+	GstStateChangeReturn result;
+
+	switch (transition)
+	{
+		case GST_STATE_CHANGE_NULL_TO_READY:
+			gst_rlc_fec_dec_alloc_tables(rlc_fec_dec);
+			break;
+
+		case GST_STATE_CHANGE_READY_TO_PAUSED:
+			/* Make sure states are at their initial value */
+			gst_rlc_fec_dec_reset_states(rlc_fec_dec);
+			break;
+
+		default:
+			break;
+	}
+
+	if ((result = GST_ELEMENT_CLASS(gst_rlc_fec_dec_parent_class)->change_state(element, transition)) == GST_STATE_CHANGE_FAILURE)
+		return result;
+
+	switch (transition)
+	{
+		case GST_STATE_CHANGE_PAUSED_TO_READY:
+			/* Make sure the decoding window and equations are
+			 * flushed and states are reset properly */
+			gst_rlc_fec_dec_flush(rlc_fec_dec);
+			/* Stream is done after switching to READY */
+			rlc_fec_dec->stream_started = FALSE;
+			break;
+
+		case GST_STATE_CHANGE_READY_TO_NULL:
+			gst_rlc_fec_dec_free_tables(rlc_fec_dec);
+			break;
+
+		default:
+			break;
+	}
+
+	return result;
+}
+
+
+static gboolean gst_rlc_fec_dec_fecsource_event(GstPad *pad, GstObject *parent, GstEvent *event)
+{
+	GstRLCFECDec *rlc_fec_dec = GST_RLC_FEC_DEC(parent);
+
+	switch (GST_EVENT_TYPE(event))
+	{
+		case GST_EVENT_STREAM_START:
+			/* Throw away incoming STREAM_START events
+			 * this decoder generates its own STREAM_START events */
+			gst_event_unref(event);
+			return TRUE;
+
+		case GST_EVENT_CAPS:
+			/* Throw away incoming caps
+			 * this decoder generates its own CAPS events */
+			gst_event_unref(event);
+			return TRUE;
+
+		case GST_EVENT_SEGMENT:
+			/* Throw away incoming segments
+			 * this decoder generates its own SEGMENT events */
+			gst_event_unref(event);
+			return TRUE;
+
+		case GST_EVENT_FLUSH_STOP:
+			/* Lock to avoid race conditions between flushes here
+			 * and chain function calls at the other sinkpad */
+			RLC_LOCK_MUTEX(rlc_fec_dec);
+			gst_rlc_fec_dec_flush(rlc_fec_dec);
+			RLC_UNLOCK_MUTEX(rlc_fec_dec);
+			break;
+
+		case GST_EVENT_EOS:
+			/* Lock to avoid race conditions between here
+			 * and chain function calls at the other sinkpad */
+			RLC_LOCK_MUTEX(rlc_fec_dec);
+
+			rlc_fec_dec->fecsource_eos = TRUE;
+			gst_rlc_fec_dec_push_eos(rlc_fec_dec);
+
+			RLC_UNLOCK_MUTEX(rlc_fec_dec);
+			break;
+
+		default:
+			break;
+	}
+
+	return gst_pad_event_default(pad, parent, event);
+}
+
+
+static gboolean gst_rlc_fec_dec_fecrepair_event(GstPad *pad, GstObject *parent, GstEvent *event)
+{
+	GstRLCFECDec *rlc_fec_dec = GST_RLC_FEC_DEC(parent);
+
+	switch (GST_EVENT_TYPE(event))
+	{
+		case GST_EVENT_STREAM_START:
+			/* Throw away incoming STREAM_START events
+			 * this decoder generates its own STREAM_START events */
+			gst_event_unref(event);
+			return TRUE;
+
+		case GST_EVENT_CAPS:
+			/* Throw away incoming caps
+			 * this decoder generates its own CAPS events */
+			gst_event_unref(event);
+			return TRUE;
+
+		case GST_EVENT_SEGMENT:
+			/* Throw away incoming segments
+			 * this decoder generates its own SEGMENT events */
+			gst_event_unref(event);
+			return TRUE;
+
+		case GST_EVENT_FLUSH_STOP:
+			/* Lock to avoid race conditions between flushes here
+			 * and chain function calls at the other sinkpad */
+			RLC_LOCK_MUTEX(rlc_fec_dec);
+			gst_rlc_fec_dec_flush(rlc_fec_dec);
+			RLC_UNLOCK_MUTEX(rlc_fec_dec);
+			break;
+
+		case GST_EVENT_EOS:
+			/* Lock to avoid race conditions between here
+			 * and chain function calls at the other sinkpad */
+			RLC_LOCK_MUTEX(rlc_fec_dec);
+
+			rlc_fec_dec->fecrepair_eos = TRUE;
+			gst_rlc_fec_dec_push_eos(rlc_fec_dec);
+
+			RLC_UNLOCK_MUTEX(rlc_fec_dec);
+			break;
+
+		default:
+			break;
+	}
+
+	return gst_pad_event_default(pad, parent, event);
+}
+
+
+static GstFlowReturn gst_rlc_fec_dec_fecsource_chain(G_GNUC_UNUSED GstPad *pad, GstObject *parent, GstBuffer *buffer)
+{
+	GstRLCFECDec *rlc_fec_dec = GST_RLC_FEC_DEC_CAST(parent);
+	GstFlowReturn ret = GST_FLOW_OK;
+
+	/* Lock to prevent race conditions between flushes, this chain function,
+	 * and a chain function call at the other sinkpad */
+	RLC_LOCK_MUTEX(rlc_fec_dec);
+
+	if (rlc_fec_dec->fecsource_eos)
+	{
+		GST_DEBUG_OBJECT(rlc_fec_dec, "received FEC source data after EOS was received - dropping buffer");
+		gst_buffer_unref(buffer);
+		ret = GST_FLOW_EOS;
+	}
+	else
+		ret = gst_rlc_fec_dec_insert_source_packet(rlc_fec_dec, buffer);
+
+	RLC_UNLOCK_MUTEX(rlc_fec_dec);
+
+	return ret;
+}
+
+
+static GstFlowReturn gst_rlc_fec_dec_fecrepair_chain(G_GNUC_UNUSED GstPad *pad, GstObject *parent, GstBuffer *buffer)
+{
+	GstRLCFECDec *rlc_fec_dec = GST_RLC_FEC_DEC_CAST(parent);
+	GstFlowReturn ret = GST_FLOW_OK;
+
+	/* Lock to prevent race conditions between flushes, this chain function,
+	 * and a chain function call at the other sinkpad */
+	RLC_LOCK_MUTEX(rlc_fec_dec);
+
+	if (rlc_fec_dec->fecrepair_eos)
+	{
+		GST_DEBUG_OBJECT(rlc_fec_dec, "received FEC repair data after EOS was received - dropping buffer");
+		gst_buffer_unref(buffer);
+		ret = GST_FLOW_EOS;
+	}
+	else
+		ret = gst_rlc_fec_dec_insert_repair_packet(rlc_fec_dec, buffer);
+
+	RLC_UNLOCK_MUTEX(rlc_fec_dec);
+
+	return ret;
+}
+
+
+static void gst_rlc_fec_dec_alloc_tables(GstRLCFECDec *rlc_fec_dec)
+{
+	g_assert(rlc_fec_dec->known_adus == NULL);
+
+	/* Round up to a power of two; see the known_adus description in the header */
+	rlc_fec_dec->table_size = 1;
+	while (rlc_fec_dec->table_size < rlc_fec_dec->window_size)
+		rlc_fec_dec->table_size <<= 1;
+
+	GST_DEBUG_OBJECT(rlc_fec_dec, "allocating decoding window  (window size: %u  table size: %u)", rlc_fec_dec->window_size, rlc_fec_dec->table_size);
+
+	rlc_fec_dec->known_adus = g_slice_alloc0(sizeof(GstBuffer *) * rlc_fec_dec->table_size);
+	rlc_fec_dec->known_esis = g_slice_alloc0(sizeof(guint32) * rlc_fec_dec->table_size);
+}
+
+
+static void gst_rlc_fec_dec_free_tables(GstRLCFECDec *rlc_fec_dec)
+{
+	g_assert(rlc_fec_dec->known_adus != NULL);
+
+	/* The flush unrefs any ADUs left in the table */
+	gst_rlc_fec_dec_flush(rlc_fec_dec);
+
+	g_slice_free1(sizeof(GstBuffer *) * rlc_fec_dec->table_size, rlc_fec_dec->known_adus);
+	g_slice_free1(sizeof(guint32) * rlc_fec_dec->table_size, rlc_fec_dec->known_esis);
+	rlc_fec_dec->known_adus = NULL;
+	rlc_fec_dec->known_esis = NULL;
+	rlc_fec_dec->table_size = 0;
+}
+
+
+static GstFlowReturn gst_rlc_fec_dec_insert_source_packet(GstRLCFECDec *rlc_fec_dec, GstBuffer *fec_source_packet)
+{
+	guint8 payload_id[GST_RLC_FEC_SOURCE_PAYLOAD_ID_LENGTH];
+	gsize packet_size, adu_length;
+	guint32 esi;
+	GstBuffer *adu;
+	GSList *node, *orphaned_equations = NULL;
+	GstFlowReturn ret;
+
+	packet_size = gst_buffer_get_size(fec_source_packet);
+	if (packet_size < GST_RLC_FEC_SOURCE_PAYLOAD_ID_LENGTH)
+	{
+		GST_WARNING_OBJECT(rlc_fec_dec, "FEC source packet is too small (%" G_GSIZE_FORMAT " bytes) - discarding packet", packet_size);
+		gst_buffer_unref(fec_source_packet);
+		return GST_FLOW_OK;
+	}
+
+	adu_length = packet_size - GST_RLC_FEC_SOURCE_PAYLOAD_ID_LENGTH;
+	gst_buffer_extract(fec_source_packet, adu_length, payload_id, GST_RLC_FEC_SOURCE_PAYLOAD_ID_LENGTH);
+	esi = gst_rlc_fec_read_source_payload_id(payload_id);
+
+	GST_LOG_OBJECT(rlc_fec_dec, "received FEC source packet with ESI %u", esi);
+
+	/* Discard packets which arrive too late. Their source symbols may have
+	 * been recovered already, and since they were forgotten, there is no
+	 * way of telling. */
+	if (!gst_rlc_fec_dec_is_esi_in_window(rlc_fec_dec, esi))
+	{
+		GST_LOG_OBJECT(rlc_fec_dec, "FEC source packet with ESI %u is too old (newest ESI: %u) - discarding obsolete packet", esi, rlc_fec_dec->newest_esi);
+		gst_buffer_unref(fec_source_packet);
+		return GST_FLOW_OK;
+	}
+
+	/* The source symbol may have been received or recovered already */
+	if (gst_rlc_fec_dec_get_known_adu(rlc_fec_dec, esi) != NULL)
+	{
+		GST_LOG_OBJECT(rlc_fec_dec, "ADU with ESI %u is already known - discarding duplicate packet", esi);
+		gst_buffer_unref(fec_source_packet);
+		return GST_FLOW_OK;
+	}
+
+	gst_rlc_fec_dec_update_newest_esi(rlc_fec_dec, esi);
+
+	/* Extract ADU from the packet. Using a GStreamer subbuffer
+	 * to avoid unnecessary copies. */
+	adu = gst_buffer_copy_region(fec_source_packet, GST_BUFFER_COPY_MEMORY | GST_BUFFER_COPY_MERGE, 0, adu_length);
+	gst_buffer_unref(fec_source_packet);
+
+	gst_rlc_fec_dec_set_known_adu(rlc_fec_dec, esi, gst_buffer_ref(adu));
+
+	/* Eliminate the source symbol from the equations. Equations whose pivot
+	 * was this source symbol have to be added again, since they need a new
+	 * pivot, and the other equations have to be reduced by it. */
+	node = rlc_fec_dec->equations;
+	while (node != NULL)
+	{
+		GSList *next = node->next;
+		GstRLCFECDecEquation *equation = (GstRLCFECDecEquation *)(node->data);
+
+		if (gst_rlc_fec_dec_equation_get_coef(equation, esi) != 0)
+		{
+			gst_rlc_fec_dec_equation_eliminate_adu(equation, esi, adu);
+
+			if (equation->pivot_esi == esi)
+			{
+				rlc_fec_dec->equations = g_slist_delete_link(rlc_fec_dec->equations, node);
+				rlc_fec_dec->num_equations--;
+				orphaned_equations = g_slist_prepend(orphaned_equations, equation);
+			}
+			else
+			{
+				/* This equation still has its pivot, so it cannot be empty */
+				gst_rlc_fec_dec_equation_trim(equation);
+			}
+		}
+
+		node = next;
+	}
+
+	GST_LOG_OBJECT(rlc_fec_dec, "pushing ADU with ESI %u", esi);
+
+	if ((ret = gst_rlc_fec_dec_push_adu(rlc_fec_dec, adu)) != GST_FLOW_OK)
+	{
+		g_slist_free_full(orphaned_equations, (GDestroyNotify)gst_rlc_fec_dec_equation_free);
+		return ret;
+	}
+
+	for (node = orphaned_equations; node != NULL; node = node->next)
+	{
+		GstRLCFECDecEquation *equation = (GstRLCFECDecEquation *)(node->data);
+		node->data = NULL;
+
+		if (!gst_rlc_fec_dec_equation_trim(equation))
+		{
+			gst_rlc_fec_dec_equation_free(equation);
+			continue;
+		}
+
+		if ((ret = gst_rlc_fec_dec_add_equation(rlc_fec_dec, equation)) != GST_FLOW_OK)
+			break;
+	}
+
+	/* Free the remaining equations in case the loop above was aborted early */
+	g_slist_free_full(orphaned_equations, (GDestroyNotify)gst_rlc_fec_dec_equation_free);
+
+	if (ret != GST_FLOW_OK)
+		return ret;
+
+	/* Other equations may have been reduced to their pivot */
+	return gst_rlc_fec_dec_recover_adus(rlc_fec_dec);
+}
+
+
+static GstFlowReturn gst_rlc_fec_dec_insert_repair_packet(GstRLCFECDec *rlc_fec_dec, GstBuffer *fec_repair_packet)
+{
+	guint8 payload_id[GST_RLC_FEC_REPAIR_PAYLOAD_ID_LENGTH];
+	gsize packet_size;
+	guint repair_key, dt, nss, i;
+	guint32 first_esi;
+	GstRLCFECDecEquation *equation;
+
+	packet_size = gst_buffer_get_size(fec_repair_packet);
+	if (packet_size <= GST_RLC_FEC_REPAIR_PAYLOAD_ID_LENGTH)
+	{
+		GST_WARNING_OBJECT(rlc_fec_dec, "FEC repair packet is too small (%" G_GSIZE_FORMAT " bytes) - discarding packet", packet_size);
+		gst_buffer_unref(fec_repair_packet);
+		return GST_FLOW_OK;
+	}
+
+	gst_buffer_extract(fec_repair_packet, 0, payload_id, GST_RLC_FEC_REPAIR_PAYLOAD_ID_LENGTH);
+	gst_rlc_fec_read_repair_payload_id(payload_id, &repair_key, &dt, &nss, &first_esi);
+
+	GST_LOG_OBJECT(rlc_fec_dec, "received FEC repair packet with repair key %u  (window ESIs: %u-%u  DT: %u)", repair_key, first_esi, first_esi + nss - 1, dt);
+
+	if (nss == 0)
+	{
+		GST_WARNING_OBJECT(rlc_fec_dec, "FEC repair packet has an empty encoding window - discarding packet");
+		gst_buffer_unref(fec_repair_packet);
+		return GST_FLOW_OK;
+	}
+
+	if (nss > rlc_fec_dec->window_size)
+	{
+		GST_WARNING_OBJECT(rlc_fec_dec, "FEC repair packet's encoding window (%u symbols) is larger than the decoding window (%u symbols) - discarding packet", nss, rlc_fec_dec->window_size);
+		gst_buffer_unref(fec_repair_packet);
+		return GST_FLOW_OK;
+	}
+
+	if (!gst_rlc_fec_dec_is_esi_in_window(rlc_fec_dec, first_esi))
+	{
+		GST_LOG_OBJECT(rlc_fec_dec, "FEC repair packet's encoding window starts too early (first ESI: %u newest ESI: %u) - discarding obsolete packet", first_esi, rlc_fec_dec->newest_esi);
+		gst_buffer_unref(fec_repair_packet);
+		return GST_FLOW_OK;
+	}
+
+	gst_rlc_fec_dec_update_newest_esi(rlc_fec_dec, first_esi + nss - 1);
+
+	/* Updating the newest ESI may have moved the decoding window
+	 * past the start of the encoding window */
+	if (!gst_rlc_fec_dec_is_esi_in_window(rlc_fec_dec, first_esi))
+	{
+		GST_LOG_OBJECT(rlc_fec_dec, "FEC repair packet's encoding window starts too early (first ESI: %u newest ESI: %u) - discarding obsolete packet", first_esi, rlc_fec_dec->newest_esi);
+		gst_buffer_unref(fec_repair_packet);
+		return GST_FLOW_OK;
+	}
+
+	/* Turn the repair symbol into an equation */
+	equation = g_slice_new(GstRLCFECDecEquation);
+	equation->first_esi = first_esi;
+	equation->num_coefs = nss;
+	equation->coefs = g_malloc(nss);
+	equation->pivot_esi = first_esi;
+	equation->symbol_length = packet_size - GST_RLC_FEC_REPAIR_PAYLOAD_ID_LENGTH;
+	equation->symbol = g_malloc(equation->symbol_length);
+
+	gst_rlc_fec_generate_coding_coefficients(repair_key, equation->coefs, nss, dt);
+	gst_buffer_extract(fec_repair_packet, GST_RLC_FEC_REPAIR_PAYLOAD_ID_LENGTH, equation->symbol, equation->symbol_length);
+	gst_buffer_unref(fec_repair_packet);
+
+	/* Eliminate all known source symbols, so that only
+	 * the missing ones remain in the equation */
+	for (i = 0; i < nss; ++i)
+	{
+		GstBuffer *adu = gst_rlc_fec_dec_get_known_adu(rlc_fec_dec, first_esi + i);
+		if (adu != NULL)
+			gst_rlc_fec_dec_equation_eliminate_adu(equation, first_esi + i, adu);
+	}
+
+	if (!gst_rlc_fec_dec_equation_trim(equation))
+	{
+		GST_LOG_OBJECT(rlc_fec_dec, "all source symbols of FEC repair packet with repair key %u are known - discarding unnecessary packet", repair_key);
+		gst_rlc_fec_dec_equation_free(equation);
+		return GST_FLOW_OK;
+	}
+
+	return gst_rlc_fec_dec_add_equation(rlc_fec_dec, equation);
+}
+
+
+static GstBuffer* gst_rlc_fec_dec_get_known_adu(GstRLCFECDec *rlc_fec_dec, guint32 esi)
+{
+	guint index = esi & (rlc_fec_dec->table_size - 1);
+
+	if ((rlc_fec_dec->known_adus[index] != NULL) && (rlc_fec_dec->known_esis[index] == esi))
+		return rlc_fec_dec->known_adus[index];
+	else
+		return NULL;
+}
+
+
+static void gst_rlc_fec_dec_set_known_adu(GstRLCFECDec *rlc_fec_dec, guint32 esi, GstBuffer *adu)
+{
+	guint index = esi & (rlc_fec_dec->table_size - 1);
+
+	/* Any ADU at this index is older than the decoding window, since
+	 * window_size consecutive ESIs have distinct indices, even across
+	 * the ESI wraparound */
+	if (rlc_fec_dec->known_adus[index] != NULL)
+		gst_buffer_unref(rlc_fec_dec->known_adus[index]);
+
+	rlc_fec_dec->known_adus[index] = adu;
+	rlc_fec_dec->known_esis[index] = esi;
+}
+
+
+static gboolean gst_rlc_fec_dec_is_esi_in_window(GstRLCFECDec *rlc_fec_dec, guint32 esi)
+{
+	/* ESIs newer than newest_esi are considered to be in the window too */
+	if (!rlc_fec_dec->has_newest_esi)
+		return TRUE;
+	else
+		return GST_RLC_FEC_ESI_DIFF(esi, rlc_fec_dec->newest_esi) > -((gint32)(rlc_fec_dec->window_size));
+}
+
+
+static void gst_rlc_fec_dec_update_newest_esi(GstRLCFECDec *rlc_fec_dec, guint32 esi)
+{
+	GSList *node;
+
+	if (rlc_fec_dec->has_newest_esi && (GST_RLC_FEC_ESI_DIFF(esi, rlc_fec_dec->newest_esi) <= 0))
+		return;
+
+	rlc_fec_dec->newest_esi = esi;
+	rlc_fec_dec->has_newest_esi = TRUE;
+
+	/* The decoding window moved; discard equations that refer to source
+	 * symbols which dropped out of it. Their missing source symbols
+	 * can no longer be recovered. */
+	node = rlc_fec_dec->equations;
+	while (node != NULL)
+	{
+		GSList *next = node->next;
+		GstRLCFECDecEquation *equation = (GstRLCFECDecEquation *)(node->data);
+
+		if (!gst_rlc_fec_dec_is_esi_in_window(rlc_fec_dec, equation->first_esi))
+		{
+			GST_LOG_OBJECT(rlc_fec_dec, "discarding equation with pivot ESI %u, since it is too old (newest ESI: %u)", equation->pivot_esi, esi);
+			gst_rlc_fec_dec_equation_free(equation);
+			rlc_fec_dec->equations = g_slist_delete_link(rlc_fec_dec->equations, node);
+			rlc_fec_dec->num_equations--;
+		}
+
+		node = next;
+	}
+}
+
+
+static GstFlowReturn gst_rlc_fec_dec_add_equation(GstRLCFECDec *rlc_fec_dec, GstRLCFECDecEquation *equation)
+{
+	GSList *node;
+	guint8 c;
+
+	/* Reduce the new equation by the pivots of the existing ones.
+	 * Afterwards, its coefficients at these pivots are all 0. */
+	for (node = rlc_fec_dec->equations; node != NULL; node = node->next)
+	{
+		GstRLCFECDecEquation *existing = (GstRLCFECDecEquation *)(node->data);
+
+		if ((c = gst_rlc_fec_dec_equation_get_coef(equation, existing->pivot_esi)) != 0)
+			gst_rlc_fec_dec_equation_add(equation, existing, c);
+	}
+
+	if (!gst_rlc_fec_dec_equation_trim(equation))
+	{
+		/* The equation is a linear combination of the existing ones */
+		GST_LOG_OBJECT(rlc_fec_dec, "equation is redundant - discarding");
+		gst_rlc_fec_dec_equation_free(equation);
+		return GST_FLOW_OK;
+	}
+
+	/* Use the oldest missing source symbol as pivot, and normalize
+	 * the equation so that the pivot's coefficient is 1 */
+	equation->pivot_esi = equation->first_esi;
+	c = equation->coefs[0];
+	if (c != 1)
+	{
+		c = gst_fec_gf256_inv(c);
+		gst_fec_gf256_region_mul(equation->coefs, equation->coefs, c, equation->num_coefs);
+		gst_fec_gf256_region_mul(equation->symbol, equation->symbol, c, equation->symbol_length);
+	}
+
+	/* Eliminate the new pivot from the existing equations. This does not
+	 * touch their own pivots, since the new equation has 0 coefficients
+	 * there, and they cannot become empty for the same reason. */
+	for (node = rlc_fec_dec->equations; node != NULL; node = node->next)
+	{
+		GstRLCFECDecEquation *existing = (GstRLCFECDecEquation *)(node->data);
+
+		if ((c = gst_rlc_fec_dec_equation_get_coef(existing, equation->pivot_esi)) != 0)
+		{
+			gst_rlc_fec_dec_equation_add(existing, equation, c);
+			gst_rlc_fec_dec_equation_trim(existing);
+		}
+	}
+
+	rlc_fec_dec->equations = g_slist_prepend(rlc_fec_dec->equations, equation);
+	rlc_fec_dec->num_equations++;
+
+	GST_LOG_OBJECT(rlc_fec_dec, "added equation with pivot ESI %u ; there are %u equations now", equation->pivot_esi, rlc_fec_dec->num_equations);
+
+	return gst_rlc_fec_dec_recover_adus(rlc_fec_dec);
+}
+
+
+static GstFlowReturn gst_rlc_fec_dec_recover_adus(GstRLCFECDec *rlc_fec_dec)
+{
+	GSList *node;
+	guint adu_flow_id = 0; /* XXX: Currently, only one flow (flow 0) is supported */
+	GstFlowReturn ret = GST_FLOW_OK;
+
+	/* Equations which only have their pivot left directly contain the
+	 * missing source symbol. Since the other equations have a zero
+	 * coefficient at this pivot, recovering the source symbol does not
+	 * affect them, so one pass is enough. */
+	node = rlc_fec_dec->equations;
+	while (node != NULL)
+	{
+		GSList *next = node->next;
+		GstRLCFECDecEquation *equation = (GstRLCFECDecEquation *)(node->data);
+		guint adu_flow, adu_length;
+		GstBuffer *adu;
+
+		if (equation->num_coefs != 1)
+		{
+			node = next;
+			continue;
+		}
+
+		rlc_fec_dec->equations = g_slist_delete_link(rlc_fec_dec->equations, node);
+		rlc_fec_dec->num_equations--;
+		node = next;
+
+		/* Extract flow ID and ADU length (16-bit big endian unsigned integer) */
+		adu_flow = equation->symbol[0];
+		adu_length = (((guint)(equation->symbol[1])) << 8) | ((guint)(equation->symbol[2]));
+
+		if (adu_flow != adu_flow_id)
+		{
+			GST_ELEMENT_WARNING(rlc_fec_dec, STREAM, DECODE, ("multiple ADU flows are currently not supported"), ("recovered ADU has flow ID %u", adu_flow));
+			gst_rlc_fec_dec_equation_free(equation);
+			continue;
+		}
+
+		if ((adu_length + 3) > equation->symbol_length)
+		{
+			GST_WARNING_OBJECT(rlc_fec_dec, "recovered ADU with ESI %u has invalid length %u (symbol length: %" G_GSIZE_FORMAT ") - discarding", equation->pivot_esi, adu_length, equation->symbol_length);
+			gst_rlc_fec_dec_equation_free(equation);
+			continue;
+		}
+
+		GST_LOG_OBJECT(rlc_fec_dec, "pushing recovered ADU with ESI %u  (length: %u)", equation->pivot_esi, adu_length);
+
+		/* Copy the ADU bytes, which are located right after the
+		 * 3 initial bytes (the ADU flow and ADU length) */
+		adu = gst_buffer_new_allocate(NULL, adu_length, NULL);
+		gst_buffer_fill(adu, 0, equation->symbol + 3, adu_length);
+		gst_rlc_fec_dec_set_known_adu(rlc_fec_dec, equation->pivot_esi, gst_buffer_ref(adu));
+		gst_rlc_fec_dec_equation_free(equation);
+
+		if ((ret = gst_rlc_fec_dec_push_adu(rlc_fec_dec, adu)) != GST_FLOW_OK)
+		{
+			GST_DEBUG_OBJECT(rlc_fec_dec, "got return value %s while pushing recovered ADU", gst_flow_get_name(ret));
+			break;
+		}
+	}
+
+	return ret;
+}
+
+
+static void gst_rlc_fec_dec_equation_free(GstRLCFECDecEquation *equation)
+{
+	if (equation == NULL)
+		return;
+
+	g_free(equation->coefs);
+	g_free(equation->symbol);
+	g_slice_free1(sizeof(GstRLCFECDecEquation), equation);
+}
+
+
+static guint8 gst_rlc_fec_dec_equation_get_coef(GstRLCFECDecEquation const *equation, guint32 esi)
+{
+	gint32 offset = GST_RLC_FEC_ESI_DIFF(esi, equation->first_esi);
+
+	if ((offset < 0) || ((guint)offset >= equation->num_coefs))
+		return 0;
+	else
+		return equation->coefs[offset];
+}
+
+
+static void gst_rlc_fec_dec_equation_extend(GstRLCFECDecEquation *equation, guint32 first_esi, guint32 last_esi, gsize symbol_length)
+{
+	guint32 old_last_esi = equation->first_esi + equation->num_coefs - 1;
+
+	/* Grow the coefficient range so that it covers first_esi..last_esi */
+	if (GST_RLC_FEC_ESI_DIFF(first_esi, equation->first_esi) > 0)
+		first_esi = equation->first_esi;
+	if (GST_RLC_FEC_ESI_DIFF(last_esi, old_last_esi) < 0)
+		last_esi = old_last_esi;
+
+	if ((first_esi != equation->first_esi) || (last_esi != old_last_esi))
+	{
+		guint num_coefs = last_esi - first_esi + 1;
+		guint8 *coefs = g_malloc0(num_coefs);
+		memcpy(coefs + (equation->first_esi - first_esi), equation->coefs, equation->num_coefs);
+		g_free(equation->coefs);
+
+		equation->first_esi = first_esi;
+		equation->coefs = coefs;
+		equation->num_coefs = num_coefs;
+	}
+
+	/* Shorter symbols are implicitely zero padded */
+	if (symbol_length > equation->symbol_length)
+	{
+		equation->symbol = g_realloc(equation->symbol, symbol_length);
+		memset(equation->symbol + equation->symbol_length, 0, symbol_length - equation->symbol_length);
+		equation->symbol_length = symbol_length;
+	}
+}
+
+
+static gboolean gst_rlc_fec_dec_equation_trim(GstRLCFECDecEquation *equation)
+{
+	guint start = 0, end = equation->num_coefs;
+
+	/* Shrink the coefficient range to the nonzero coefficients.
+	 * Returns FALSE if all coefficients are zero. */
+	while ((start < end) && (equation->coefs[start] == 0))
+		start++;
+	while ((end > start) && (equation->coefs[end - 1] == 0))
+		end--;
+
+	if (start == end)
+		return FALSE;
+
+	if (start > 0)
+		memmove(equation->coefs, equation->coefs + start, end - start);
+
+	equation->first_esi += start;
+	equation->num_coefs = end - start;
+
+	return TRUE;
+}
+
+
+static void gst_rlc_fec_dec_equation_add(GstRLCFECDecEquation *dest, GstRLCFECDecEquation const *src, guint8 c)
+{
+	/* dest = dest + c * src ; the caller has to trim dest afterwards */
+
+	gst_rlc_fec_dec_equation_extend(dest, src->first_esi, src->first_esi + src->num_coefs - 1, src->symbol_length);
+
+	gst_fec_gf256_region_mul_add(dest->coefs + (src->first_esi - dest->first_esi), src->coefs, c, src->num_coefs);
+	gst_fec_gf256_region_mul_add(dest->symbol, src->symbol, c, src->symbol_length);
+}
+
+
+static void gst_rlc_fec_dec_equation_eliminate_adu(GstRLCFECDecEquation *equation, guint32 esi, GstBuffer *adu)
+{
+	/* Subtract the contribution of a known source symbol from the
+	 * equation; the caller has to trim the equation afterwards */
+
+	GstMapInfo map_info;
+	guint8 adui_header[3];
+	guint adu_flow_id = 0; /* XXX: Currently, only one flow (flow 0) is supported */
+	guint8 c = gst_rlc_fec_dec_equation_get_coef(equation, esi);
+
+	if (c == 0)
+		return;
+
+	gst_buffer_map(adu, &map_info, GST_MAP_READ);
+
+	/* The source symbol is the ADUI: flow ID, ADU length, ADU */
+	adui_header[0] = adu_flow_id;
+	adui_header[1] = (map_info.size & 0xFF00) >> 8;
+	adui_header[2] = (map_info.size & 0x00FF);
+
+	gst_rlc_fec_dec_equation_extend(equation, esi, esi, 3 + map_info.size);
+
+	gst_fec_gf256_region_mul_add(equation->symbol, adui_header, c, 3);
+	gst_fec_gf256_region_mul_add(equation->symbol + 3, map_info.data, c, map_info.size);
+	equation->coefs[esi - equation->first_esi] = 0;
+
+	gst_buffer_unmap(adu, &map_info);
+}
+
+
+static void gst_rlc_fec_dec_reset_states(GstRLCFECDec *rlc_fec_dec)
+{
+	rlc_fec_dec->has_newest_esi = FALSE;
+	rlc_fec_dec->segment_started = FALSE;
+	rlc_fec_dec->fecsource_eos = FALSE;
+	rlc_fec_dec->fecrepair_eos = FALSE;
+}
+
+
+static void gst_rlc_fec_dec_flush(GstRLCFECDec *rlc_fec_dec)
+{
+	guint i;
+
+	/* Cleanup any leftover equations and known ADUs */
+
+	g_slist_free_full(rlc_fec_dec->equations, (GDestroyNotify)gst_rlc_fec_dec_equation_free);
+	rlc_fec_dec->equations = NULL;
+	rlc_fec_dec->num_equations = 0;
+
+	if (rlc_fec_dec->known_adus != NULL)
+	{
+		for (i = 0; i < rlc_fec_dec->table_size; ++i)
+		{
+			if (rlc_fec_dec->known_adus[i] != NULL)
+			{
+				gst_buffer_unref(rlc_fec_dec->known_adus[i]);
+				rlc_fec_dec->known_adus[i] = NULL;
+			}
+		}
+	}
+
+	gst_rlc_fec_dec_reset_states(rlc_fec_dec);
+}
+
+
+static GstFlowReturn gst_rlc_fec_dec_push_adu(GstRLCFECDec *rlc_fec_dec, GstBuffer *adu)
+{
+	/* Send stream-start and segment events if necessary */
+	gst_rlc_fec_dec_push_stream_start(rlc_fec_dec);
+	gst_rlc_fec_dec_push_segment(rlc_fec_dec);
+
+	if (rlc_fec_dec->do_timestamp)
+	{
+		/* Fetch clock and base time, to be able to set buffer timestamps */
+		GstClock *clock = GST_ELEMENT_CLOCK(rlc_fec_dec);
+		GstClockTime base_time = GST_ELEMENT_CAST(rlc_fec_dec)->base_time;
+
+		/* Set the buffer PTS and DTS to the current running time */
+		if (clock != NULL)
+		{
+			GstClockTime ts;
+			GstClockTime now = gst_clock_get_time(clock);
+			ts = now - base_time;
+			GST_BUFFER_PTS(adu) = ts;
+			GST_BUFFER_DTS(adu) = ts;
+		}
+	}
+
+	return gst_pad_push(rlc_fec_dec->srcpad, adu);
+}
+
+
+static void gst_rlc_fec_dec_push_stream_start(GstRLCFECDec *rlc_fec_dec)
+{
+	GstEvent *event;
+	gchar stream_id[32];
+
+	/* Catch redundant calls */
+	if (rlc_fec_dec->stream_started)
+		return;
+
+	g_snprintf(stream_id, sizeof(stream_id), "rlcfecdec-%08x", g_random_int());
+	GST_DEBUG_OBJECT(rlc_fec_dec, "sending out stream-start event with ID %s", stream_id);
+
+	event = gst_event_new_stream_start(stream_id);
+	gst_pad_push_event(rlc_fec_dec->srcpad, event);
+
+	rlc_fec_dec->stream_started = TRUE;
+}
+
+
+static void gst_rlc_fec_dec_push_segment(GstRLCFECDec *rlc_fec_dec)
+{
+	GstEvent *event;
+	GstSegment segment;
+
+	/* Catch redundant calls */
+	if (rlc_fec_dec->segment_started)
+		return;
+
+	gst_segment_init(&segment, GST_FORMAT_TIME);
+
+	GST_DEBUG_OBJECT(rlc_fec_dec, "sending out segment event");
+
+	event = gst_event_new_segment(&segment);
+	gst_pad_push_event(rlc_fec_dec->srcpad, event);
+
+	rlc_fec_dec->segment_started = TRUE;
+}
+
+
+static void gst_rlc_fec_dec_push_eos(GstRLCFECDec *rlc_fec_dec)
+{
+	/* Only push EOS downstream if both sinkpads received EOS.
+	 * For example, if the fecsource sinkpad gets EOS, it may
+	 * still be possible for the fecrepair sinkpad to receive
+	 * enough repair symbols to recover some ADUs. Recovered
+	 * ADUs are pushed immediately, so there is nothing to
+	 * drain here. */
+	if (rlc_fec_dec->fecsource_eos && rlc_fec_dec->fecrepair_eos)
+	{
+		GST_DEBUG_OBJECT(rlc_fec_dec, "both sinkpads received EOS -> pushing EOS downstream");
+
+		/* Send stream-start and segment events if necessary */
+		gst_rlc_fec_dec_push_stream_start(rlc_fec_dec);
+		gst_rlc_fec_dec_push_segment(rlc_fec_dec);
+
+		gst_pad_push_event(rlc_fec_dec->srcpad, gst_event_new_eos());
+	}
+}
@@ -0,0 +1,135 @@
+/* RFC 8681-based sliding window forward error correction for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef GSTFECFRAME_RLC_RLCFECDEC_H
+#define GSTFECFRAME_RLC_RLCFECDEC_H
+
+#include <gst/gst.h>
+
+
+G_BEGIN_DECLS
+
+
+typedef struct _GstRLCFECDec GstRLCFECDec;
+typedef struct _GstRLCFECDecClass GstRLCFECDecClass;
+typedef struct _GstRLCFECDecEquation GstRLCFECDecEquation;
+
+
+#define GST_TYPE_RLC_FEC_DEC             (gst_rlc_fec_dec_get_type())
+#define GST_RLC_FEC_DEC(obj)             (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_RLC_FEC_DEC, GstRLCFECDec))
+#define GST_RLC_FEC_DEC_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST((klass), GST_TYPE_RLC_FEC_DEC, GstRLCFECDecClass))
+#define GST_RLC_FEC_DEC_CAST(obj)        ((GstRLCFECDec *)(obj))
+#define GST_IS_RLC_FEC_DEC(obj)          (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_RLC_FEC_DEC))
+#define GST_IS_RLC_FEC_DEC_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass), GST_TYPE_RLC_FEC_DEC))
+
+
+/* A linear equation over GF(2^8), originating from one or more repair
+ * symbols: symbol = sum of coefs[i] * ADUI(first_esi + i). Known source
+ * symbols are always eliminated from it, so the equation only refers
+ * to missing source symbols. */
+struct _GstRLCFECDecEquation
+{
+	/* ESI of the first coefficient. The coefficient range is kept
+	 * trimmed, so coefs[0] and coefs[num_coefs - 1] are nonzero. */
+	guint32 first_esi;
+	guint8 *coefs;
+	guint num_coefs;
+
+	/* The equation's pivot. Its coefficient is always 1, and the
+	 * coefficients of all other equations at this ESI are 0. */
+	guint32 pivot_esi;
+
+	/* Linear combination of the ADUIs. Shorter ADUIs are
+	 * implicitely zero padded to this length. */
+	guint8 *symbol;
+	gsize symbol_length;
+};
+
+
+struct _GstRLCFECDec
+{
+	GstElement parent;
+
+	/* Sink- and source pads.
+	 * NOTE: fecsourcepad is a sinkpad! "fecsource" refers to
+	 * "FEC source packets", not to a sourcepad" */
+	GstPad *srcpad, *fecsourcepad, *fecrepairpad;
+
+	/* Size of the decoding window, configured via property. Source
+	 * symbols which are window_size or more ESIs older than the newest
+	 * ESI seen so far are forgotten, and repair symbols which refer to
+	 * them are discarded. This must be at least as large as the
+	 * encoder's window size. It may only be modified if the tables are
+	 * not allocated (that is, if known_adus == NULL). */
+	guint window_size;
+
+	/* If TRUE, received and recovered ADUs will get timestamped with
+	 * the current running time they are pushed downstream. */
+	gboolean do_timestamp;
+
+	/* Received and recovered ADUs of the decoding window. These are
+	 * needed for eliminating known source symbols from incoming repair
+	 * symbols. This is a ring with table_size entries, indexed by
+	 * (ESI & (table_size - 1)). table_size is window_size rounded up
+	 * to the next power of two. Since 2^32 is a multiple of it, the
+	 * index keeps advancing by one across the ESI wraparound, so any
+	 * window_size consecutive ESIs have distinct indices. (With a plain
+	 * ESI % window_size, the ESIs right before and after the wraparound
+	 * could collide and evict ADUs that are still in the window.)
+	 * known_esis contains the ESI of each entry, since entries are only
+	 * replaced once a newer ADU with the same index shows up. The tables
+	 * are allocated at the NULL->READY state change. */
+	GstBuffer **known_adus;
+	guint32 *known_esis;
+	guint table_size;
+
+	/* List of GstRLCFECDecEquation instances. These are kept in
+	 * reduced row echelon form, so a missing source symbol is
+	 * recovered as soon as an equation only has its pivot left. */
+	GSList *equations;
+	guint num_equations;
+
+	/* Newest ESI seen so far in FEC source and repair packets. This
+	 * defines the end of the decoding window. has_newest_esi is FALSE
+	 * at startup, after a flush, and when switching back state from
+	 * PAUSED to READY. */
+	guint32 newest_esi;
+	gboolean has_newest_esi;
+
+	/* Same meaning as the fields with the same name in GstRSFECDec */
+	GMutex mutex;
+	gboolean segment_started;
+	gboolean stream_started;
+	gboolean fecsource_eos, fecrepair_eos;
+};
+
+
+struct _GstRLCFECDecClass
+{
+	GstElementClass parent_class;
+};
+
+
+GType gst_rlc_fec_dec_get_type(void);
+
+
+G_END_DECLS
+
+
+#endif
@@ -0,0 +1,774 @@
+/* RFC 8681-based sliding window forward error correction for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/**
+ * GstRLCFECEnc is an encoder element that implements the sliding window
+ * Random Linear Codes (RLC) FEC scheme over GF(2^8) from RFC 8681.
+ *
+ * Block codes like Reed-Solomon can only produce repair symbols once all k
+ * source symbols of a block are present, so a lost ADU can at the earliest
+ * be recovered k ADUs later. With a sliding window code, each repair symbol
+ * is a random linear combination of the most recent source symbols (the
+ * "encoding window"). The window moves forward with each new ADU, and
+ * repair symbols can be sent at any time. This allows for much lower
+ * latencies with the same protection, which is why this scheme is a good
+ * fit for interactive audio and video.
+ *
+ * Just like rsfecenc, each incoming ADU is immediately pushed downstream as
+ * a FEC source packet to the fecsource pad. The ADU is also put into the
+ * encoding window, which holds up to window-size ADUs; the oldest ADU is
+ * dropped when the window is full. After every repair-interval ADUs, the
+ * encoder sends out num-repair-symbols FEC repair packets over the current
+ * window to the fecrepair pad. The source symbols are the same ADUIs as in
+ * RFC 6865 (flow ID, ADU length, ADU, zero padding).
+ *
+ * The coding coefficients of each repair symbol are derived from its repair
+ * key as specified by RFC 8681. The encoder always uses the maximum density
+ * (all coefficients are nonzero).
+ *
+ * NOTE: RFC 8681 uses a fixed encoding symbol length E. Here, the encoding
+ * symbol length of each repair symbol is the length of the largest ADUI in
+ * its window instead, just like rsfecenc adapts the symbol length to the
+ * ADUs of each source block. Since zero padding does not change linear
+ * combinations, the decoder simply pads all symbols to the longest length
+ * it sees. With ADUs of different sizes, the stream is therefore not
+ * interoperable with other RFC 8681 implementations.
+ *
+ * At EOS, one last burst of repair symbols is sent out if ADUs arrived since
+ * the previous burst, so the tail of the stream is protected as well.
+ */
+
+
+#include <string.h>
+#include "common/gstgf256.h"
+#include "gstrlcfeccommon.h"
+#include "gstrlcfecenc.h"
+
+
+GST_DEBUG_CATEGORY(rlc_fec_enc_debug);
+#define GST_CAT_DEFAULT rlc_fec_enc_debug
+
+
+enum
+{
+	PROP_0,
+	PROP_WINDOW_SIZE,
+	PROP_REPAIR_INTERVAL,
+	PROP_NUM_REPAIR_SYMBOLS
+};
+
+
+#define DEFAULT_WINDOW_SIZE 16
+#define DEFAULT_REPAIR_INTERVAL 4
+#define DEFAULT_NUM_REPAIR_SYMBOLS 1
+
+
+#define FEC_SOURCE_CAPS_STR "application/x-fec-source-flow, encoding-id = (int) 10"
+#define FEC_REPAIR_CAPS_STR "application/x-fec-repair-flow, encoding-id = (int) 10"
+
+
+static GstStaticPadTemplate static_sink_template = GST_STATIC_PAD_TEMPLATE(
+	"sink",
+	GST_PAD_SINK,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS_ANY
+);
+
+
+static GstStaticPadTemplate static_fecsource_template = GST_STATIC_PAD_TEMPLATE(
+	"fecsource",
+	GST_PAD_SRC,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS(FEC_SOURCE_CAPS_STR)
+);
+
+
+static GstStaticPadTemplate static_fecrepair_template = GST_STATIC_PAD_TEMPLATE(
+	"fecrepair",
+	GST_PAD_SRC,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS(FEC_REPAIR_CAPS_STR)
+);
+
+
+
+
+G_DEFINE_TYPE(GstRLCFECEnc, gst_rlc_fec_enc, GST_TYPE_ELEMENT)
+
+
+
+
+static void gst_rlc_fec_enc_set_property(GObject *object, guint prop_id, GValue const *value, GParamSpec *pspec);
+static void gst_rlc_fec_enc_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec);
+
+static GstStateChangeReturn gst_rlc_fec_enc_change_state(GstElement *element, GstStateChange transition);
+
+static gboolean gst_rlc_fec_enc_sink_event(GstPad *pad, GstObject *parent, GstEvent *event);
+static GstFlowReturn gst_rlc_fec_enc_sink_chain(GstPad *pad, GstObject *parent, GstBuffer *buffer);
+
+static void gst_rlc_fec_enc_alloc_window(GstRLCFECEnc *rlc_fec_enc);
+static void gst_rlc_fec_enc_free_window(GstRLCFECEnc *rlc_fec_enc);
+static void gst_rlc_fec_enc_insert_adu(GstRLCFECEnc *rlc_fec_enc, GstBuffer *adu);
+static void gst_rlc_fec_enc_flush_window(GstRLCFECEnc *rlc_fec_enc);
+
+static GstFlowReturn gst_rlc_fec_enc_push_adu(GstRLCFECEnc *rlc_fec_enc, GstBuffer *adu, guint32 esi);
+static GstFlowReturn gst_rlc_fec_enc_push_repair_symbols(GstRLCFECEnc *rlc_fec_enc, guint num_repair_symbols);
+static void gst_rlc_fec_enc_push_events(GstRLCFECEnc *rlc_fec_enc);
+static void gst_rlc_fec_enc_free_payload_id(gpointer data);
+
+static void gst_rlc_fec_enc_reset_states(GstRLCFECEnc *rlc_fec_enc);
+static void gst_rlc_fec_enc_flush(GstRLCFECEnc *rlc_fec_enc);
+
+
+
+
+static void gst_rlc_fec_enc_class_init(GstRLCFECEncClass *klass)
+{
+	GObjectClass *object_class;
+	GstElementClass *element_class;
+
+	GST_DEBUG_CATEGORY_INIT(rlc_fec_enc_debug, "rlcfecenc", 0, "FECFRAME RFC 8681 sliding window RLC scheme encoder");
+
+	gst_fec_gf256_init();
+
+	object_class = G_OBJECT_CLASS(klass);
+	element_class = GST_ELEMENT_CLASS(klass);
+
+	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_sink_template));
+	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_fecsource_template));
+	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_fecrepair_template));
+
+	object_class->set_property  = GST_DEBUG_FUNCPTR(gst_rlc_fec_enc_set_property);
+	object_class->get_property  = GST_DEBUG_FUNCPTR(gst_rlc_fec_enc_get_property);
+
+	element_class->change_state = GST_DEBUG_FUNCPTR(gst_rlc_fec_enc_change_state);
+
+	g_object_class_install_property(
+		object_class,
+		PROP_WINDOW_SIZE,
+		g_param_spec_uint(
+			"window-size",
+			"Window size",
+			"Maximum number of source symbols in the encoding window",
+			1, GST_RLC_FEC_MAX_WINDOW_SIZE,
+			DEFAULT_WINDOW_SIZE,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_REPAIR_INTERVAL,
+		g_param_spec_uint(
+			"repair-interval",
+			"Repair interval",
+			"How many source symbols to send between two bursts of repair symbols",
+			1, G_MAXUINT,
+			DEFAULT_REPAIR_INTERVAL,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_NUM_REPAIR_SYMBOLS,
+		g_param_spec_uint(
+			"num-repair-symbols",
+			"Number of repair symbols",
+			"How many repair symbols to send in each burst (0 disables FEC repair symbol generation)",
+			0, G_MAXUINT,
+			DEFAULT_NUM_REPAIR_SYMBOLS,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+
+	gst_element_class_set_static_metadata(
+		element_class,
+		"Sliding window RLC forward error correction encoder",
+		"Codec/Encoder/Network",
+		"Produces forward-error erasure coding based on the FECFRAME sliding window RLC scheme RFC 8681",
+		"Carlos Rafael Giani <dv@pseudoterminal.org>"
+	);
+}
+
+
+static void gst_rlc_fec_enc_init(GstRLCFECEnc *rlc_fec_enc)
+{
+	rlc_fec_enc->window_size = DEFAULT_WINDOW_SIZE;
+	rlc_fec_enc->repair_interval = DEFAULT_REPAIR_INTERVAL;
+	rlc_fec_enc->num_repair_symbols = DEFAULT_NUM_REPAIR_SYMBOLS;
+
+	rlc_fec_enc->window_adus = NULL;
+	rlc_fec_enc->window_start = 0;
+	rlc_fec_enc->window_fill = 0;
+	rlc_fec_enc->window_first_esi = 0;
+	rlc_fec_enc->coefs = NULL;
+
+	rlc_fec_enc->next_esi = 0;
+	rlc_fec_enc->repair_key = 0;
+	rlc_fec_enc->num_adus_since_repair = 0;
+
+	rlc_fec_enc->first_source_packet = TRUE;
+	rlc_fec_enc->first_repair_packet = TRUE;
+	rlc_fec_enc->segment_started = FALSE;
+	rlc_fec_enc->stream_started = FALSE;
+	rlc_fec_enc->eos_received = FALSE;
+
+	rlc_fec_enc->sinkpad = gst_ghost_pad_new_no_target_from_template(
+		"sink",
+		gst_element_class_get_pad_template(GST_ELEMENT_GET_CLASS(rlc_fec_enc), "sink")
+	);
+	gst_element_add_pad(GST_ELEMENT(rlc_fec_enc), rlc_fec_enc->sinkpad);
+
+	rlc_fec_enc->fecsourcepad = gst_ghost_pad_new_no_target_from_template(
+		"fecsource",
+		gst_element_class_get_pad_template(GST_ELEMENT_GET_CLASS(rlc_fec_enc), "fecsource")
+	);
+	gst_element_add_pad(GST_ELEMENT(rlc_fec_enc), rlc_fec_enc->fecsourcepad);
+
+	rlc_fec_enc->fecrepairpad = gst_ghost_pad_new_no_target_from_template(
+		"fecrepair",
+		gst_element_class_get_pad_template(GST_ELEMENT_GET_CLASS(rlc_fec_enc), "fecrepair")
+	);
+	gst_element_add_pad(GST_ELEMENT(rlc_fec_enc), rlc_fec_enc->fecrepairpad);
+
+	gst_pad_set_event_function(rlc_fec_enc->sinkpad, GST_DEBUG_FUNCPTR(gst_rlc_fec_enc_sink_event));
+	gst_pad_set_chain_function(rlc_fec_enc->sinkpad, GST_DEBUG_FUNCPTR(gst_rlc_fec_enc_sink_chain));
+}
+
+
+static void gst_rlc_fec_enc_set_property(GObject *object, guint prop_id, GValue const *value, GParamSpec *pspec)
+{
+	GstRLCFECEnc *rlc_fec_enc = GST_RLC_FEC_ENC(object);
+
+	switch (prop_id)
+	{
+		case PROP_WINDOW_SIZE:
+			GST_OBJECT_LOCK(object);
+			if (rlc_fec_enc->window_adus == NULL)
+				rlc_fec_enc->window_size = g_value_get_uint(value);
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set window size after the encoding window was allocated"), (NULL));
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_REPAIR_INTERVAL:
+			GST_OBJECT_LOCK(object);
+			rlc_fec_enc->repair_interval = g_value_get_uint(value);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_NUM_REPAIR_SYMBOLS:
+			GST_OBJECT_LOCK(object);
+			rlc_fec_enc->num_repair_symbols = g_value_get_uint(value);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+			break;
+	}
+}
+
+
+static void gst_rlc_fec_enc_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec)
+{
+	GstRLCFECEnc *rlc_fec_enc = GST_RLC_FEC_ENC(object);
+
+	switch (prop_id)
+	{
+		case PROP_WINDOW_SIZE:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, rlc_fec_enc->window_size);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_REPAIR_INTERVAL:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, rlc_fec_enc->repair_interval);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_NUM_REPAIR_SYMBOLS:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, rlc_fec_enc->num_repair_symbols);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+			break;
+	}
+}
+
+
+static GstStateChangeReturn gst_rlc_fec_enc_change_state(GstElement *element, GstStateChange transition)
+{
+	GstRLCFECEnc *rlc_fec_enc = GST_RLC_FEC_ENC(element);
+	GstStateChangeReturn result;
+
+	switch (transition)
+	{
+		case GST_STATE_CHANGE_NULL_TO_READY:
+			gst_rlc_fec_enc_alloc_window(rlc_fec_enc);
+			break;
+
+		case GST_STATE_CHANGE_READY_TO_PAUSED:
+			/* Make sure states are at their initial value */
+			gst_rlc_fec_enc_reset_states(rlc_fec_enc);
+			break;
+
+		default:
+			break;
+	}
+
+	if ((result = GST_ELEMENT_CLASS(gst_rlc_fec_enc_parent_class)->change_state(element, transition)) == GST_STATE_CHANGE_FAILURE)
+		return result;
+
+	switch (transition)
+	{
+		case GST_STATE_CHANGE_PAUSED_TO_READY:
+			/* Make sure any stored ADUs are flushed and states are reset properly */
+			gst_rlc_fec_enc_flush(rlc_fec_enc);
+			/* Stream is done after switching to READY */
+			rlc_fec_enc->stream_started = FALSE;
+			break;
+
+		case GST_STATE_CHANGE_READY_TO_NULL:
+			gst_rlc_fec_enc_free_window(rlc_fec_enc);
+			break;
+
+		default:
+			break;
+	}
+
+	return result;
+}
+
+
+static gboolean gst_rlc_fec_enc_sink_event(GstPad *pad, GstObject *parent, GstEvent *event)
+{
+	GstRLCFECEnc *rlc_fec_enc = GST_RLC_FEC_ENC(parent);
+
+	switch (GST_EVENT_TYPE(event))
+	{
+		case GST_EVENT_STREAM_START:
+			/* Throw away incoming STREAM_START events
+			 * this encoder generates its own STREAM_START events */
+			gst_event_unref(event);
+			return TRUE;
+
+		case GST_EVENT_CAPS:
+			/* Throw away incoming caps
+			 * this encoder generates its own CAPS events */
+			gst_event_unref(event);
+			return TRUE;
+
+		case GST_EVENT_SEGMENT:
+			/* Throw away incoming segments
+			 * this encoder generates its own SEGMENT events */
+			gst_event_unref(event);
+			return TRUE;
+
+		case GST_EVENT_FLUSH_STOP:
+			/* Make sure any stored ADUs are flushed and states are reset properly */
+			gst_rlc_fec_enc_flush(rlc_fec_enc);
+			break;
+
+		case GST_EVENT_EOS:
+		{
+			guint num_repair_symbols;
+
+			GST_DEBUG_OBJECT(rlc_fec_enc, "EOS received");
+
+			/* Protect the ADUs that came in after the last repair burst.
+			 * Unlike with block codes, there is no incomplete block that
+			 * needs to be discarded; the window can be used as it is. */
+			GST_OBJECT_LOCK(rlc_fec_enc);
+			num_repair_symbols = rlc_fec_enc->num_repair_symbols;
+			GST_OBJECT_UNLOCK(rlc_fec_enc);
+			if (!rlc_fec_enc->eos_received && (rlc_fec_enc->num_adus_since_repair > 0) && (num_repair_symbols > 0))
+				gst_rlc_fec_enc_push_repair_symbols(rlc_fec_enc, num_repair_symbols);
+
+			/* Set the eos_received flag to let the chain function know we are done
+			 * receiving data, and forward the EOS event to both sourcepads */
+			rlc_fec_enc->eos_received = TRUE;
+
+			/* Ref the event, since it is pushed downstream twice here
+			 * (once for each sourcepad) */
+			gst_event_ref(event);
+			gst_pad_push_event(rlc_fec_enc->fecsourcepad, event);
+			gst_pad_push_event(rlc_fec_enc->fecrepairpad, event);
+
+			/* After EOS, no data is accepted anymore; might as well flush
+			 * whatever is still stored */
+			gst_rlc_fec_enc_flush_window(rlc_fec_enc);
+
+			return TRUE;
+		}
+
+		default:
+			break;
+	}
+
+	return gst_pad_event_default(pad, parent, event);
+}
+
+
+static GstFlowReturn gst_rlc_fec_enc_sink_chain(G_GNUC_UNUSED GstPad *pad, GstObject *parent, GstBuffer *buffer)
+{
+	GstRLCFECEnc *rlc_fec_enc = GST_RLC_FEC_ENC_CAST(parent);
+	GstFlowReturn ret = GST_FLOW_OK;
+	gsize bufsize;
+	guint32 esi;
+	guint repair_interval, num_repair_symbols;
+
+	if (rlc_fec_enc->eos_received)
+	{
+		GST_DEBUG_OBJECT(rlc_fec_enc, "received data after EOS was received - dropping buffer");
+		gst_buffer_unref(buffer);
+		return GST_FLOW_EOS;
+	}
+
+	/* The input buffer is the new ADU */
+
+	bufsize = gst_buffer_get_size(buffer);
+	if (bufsize > 65535)
+	{
+		GST_ELEMENT_ERROR(rlc_fec_enc, STREAM, ENCODE, ("input buffer too large"), ("maximum is 65535 bytes, buffer size is %" G_GSIZE_FORMAT, bufsize));
+		gst_buffer_unref(buffer);
+		return GST_FLOW_ERROR;
+	}
+
+	esi = rlc_fec_enc->next_esi++;
+
+	/* Copy the ADU, since the copy is modified (an FEC payload ID is
+	 * appended prior to sending). This does not copy the bytes. */
+	if ((ret = gst_rlc_fec_enc_push_adu(rlc_fec_enc, gst_buffer_copy(buffer), esi)) != GST_FLOW_OK)
+	{
+		gst_buffer_unref(buffer);
+		return ret;
+	}
+
+	/* Move the encoding window forward */
+	gst_rlc_fec_enc_insert_adu(rlc_fec_enc, buffer);
+	rlc_fec_enc->num_adus_since_repair++;
+
+	GST_OBJECT_LOCK(rlc_fec_enc);
+	repair_interval = rlc_fec_enc->repair_interval;
+	num_repair_symbols = rlc_fec_enc->num_repair_symbols;
+	GST_OBJECT_UNLOCK(rlc_fec_enc);
+
+	if (rlc_fec_enc->num_adus_since_repair >= repair_interval)
+	{
+		if (num_repair_symbols > 0)
+			ret = gst_rlc_fec_enc_push_repair_symbols(rlc_fec_enc, num_repair_symbols);
+		rlc_fec_enc->num_adus_since_repair = 0;
+	}
+
+	return ret;
+}
+
+
+static void gst_rlc_fec_enc_alloc_window(GstRLCFECEnc *rlc_fec_enc)
+{
+	g_assert(rlc_fec_enc->window_adus == NULL);
+
+	GST_DEBUG_OBJECT(rlc_fec_enc, "allocating encoding window  (window size: %u)", rlc_fec_enc->window_size);
+
+	rlc_fec_enc->window_adus = g_slice_alloc0(sizeof(GstBuffer *) * rlc_fec_enc->window_size);
+	rlc_fec_enc->coefs = g_slice_alloc(rlc_fec_enc->window_size);
+	rlc_fec_enc->window_start = 0;
+	rlc_fec_enc->window_fill = 0;
+}
+
+
+static void gst_rlc_fec_enc_free_window(GstRLCFECEnc *rlc_fec_enc)
+{
+	g_assert(rlc_fec_enc->window_adus != NULL);
+
+	gst_rlc_fec_enc_flush_window(rlc_fec_enc);
+
+	g_slice_free1(sizeof(GstBuffer *) * rlc_fec_enc->window_size, rlc_fec_enc->window_adus);
+	g_slice_free1(rlc_fec_enc->window_size, rlc_fec_enc->coefs);
+	rlc_fec_enc->window_adus = NULL;
+	rlc_fec_enc->coefs = NULL;
+}
+
+
+static void gst_rlc_fec_enc_insert_adu(GstRLCFECEnc *rlc_fec_enc, GstBuffer *adu)
+{
+	guint index;
+
+	/* If the window is full, the oldest ADU drops out of it */
+	if (rlc_fec_enc->window_fill == rlc_fec_enc->window_size)
+	{
+		gst_buffer_unref(rlc_fec_enc->window_adus[rlc_fec_enc->window_start]);
+		rlc_fec_enc->window_adus[rlc_fec_enc->window_start] = NULL;
+		rlc_fec_enc->window_start = (rlc_fec_enc->window_start + 1) % rlc_fec_enc->window_size;
+		rlc_fec_enc->window_first_esi++;
+		rlc_fec_enc->window_fill--;
+	}
+
+	/* The first ADU after a flush starts a new window */
+	if (rlc_fec_enc->window_fill == 0)
+		rlc_fec_enc->window_first_esi = rlc_fec_enc->next_esi - 1;
+
+	index = (rlc_fec_enc->window_start + rlc_fec_enc->window_fill) % rlc_fec_enc->window_size;
+	rlc_fec_enc->window_adus[index] = adu;
+	rlc_fec_enc->window_fill++;
+
+	GST_LOG_OBJECT(rlc_fec_enc, "inserted ADU into encoding window  (window ESIs: %u-%u)", rlc_fec_enc->window_first_esi, rlc_fec_enc->window_first_esi + rlc_fec_enc->window_fill - 1);
+}
+
+
+static void gst_rlc_fec_enc_flush_window(GstRLCFECEnc *rlc_fec_enc)
+{
+	guint i;
+
+	if (rlc_fec_enc->window_fill == 0)
+		return;
+
+	GST_LOG_OBJECT(rlc_fec_enc, "flushing %u ADUs from the encoding window", rlc_fec_enc->window_fill);
+
+	for (i = 0; i < rlc_fec_enc->window_fill; ++i)
+	{
+		guint index = (rlc_fec_enc->window_start + i) % rlc_fec_enc->window_size;
+		gst_buffer_unref(rlc_fec_enc->window_adus[index]);
+		rlc_fec_enc->window_adus[index] = NULL;
+	}
+
+	rlc_fec_enc->window_start = 0;
+	rlc_fec_enc->window_fill = 0;
+	rlc_fec_enc->num_adus_since_repair = 0;
+}
+
+
+static GstFlowReturn gst_rlc_fec_enc_push_adu(GstRLCFECEnc *rlc_fec_enc, GstBuffer *adu, guint32 esi)
+{
+	GstBuffer *fec_source_packet;
+	GstMemory *wrapped_payload_id;
+	GstFlowReturn ret;
+	guint8 *fec_payload_id = g_slice_alloc(GST_RLC_FEC_SOURCE_PAYLOAD_ID_LENGTH);
+
+	gst_rlc_fec_write_source_payload_id(fec_payload_id, esi);
+
+	GST_LOG_OBJECT(rlc_fec_enc, "pushing ADU with ESI %u as FEC source packet downstream", esi);
+
+	/* Create FEC source packet out of the ADU by appending the payload ID */
+	fec_source_packet = adu;
+	wrapped_payload_id = gst_memory_new_wrapped(
+		0,
+		fec_payload_id,
+		GST_RLC_FEC_SOURCE_PAYLOAD_ID_LENGTH,
+		0,
+		GST_RLC_FEC_SOURCE_PAYLOAD_ID_LENGTH,
+		fec_payload_id,
+		gst_rlc_fec_enc_free_payload_id
+	);
+	gst_buffer_append_memory(fec_source_packet, wrapped_payload_id);
+
+	/* Clear timestamp and duration, since they are
+	 * useless with FEC source packets */
+	GST_BUFFER_PTS(fec_source_packet) = GST_CLOCK_TIME_NONE;
+	GST_BUFFER_DTS(fec_source_packet) = GST_CLOCK_TIME_NONE;
+	GST_BUFFER_DURATION(fec_source_packet) = GST_CLOCK_TIME_NONE;
+
+	/* Mark discontinuity at start */
+	if (rlc_fec_enc->first_source_packet)
+	{
+		GST_BUFFER_FLAG_SET(fec_source_packet, GST_BUFFER_FLAG_DISCONT);
+		rlc_fec_enc->first_source_packet = FALSE;
+	}
+
+	/* offset and offset_end have no meaning here */
+	GST_BUFFER_OFFSET(fec_source_packet) = -1;
+	GST_BUFFER_OFFSET_END(fec_source_packet) = -1;
+
+	/* Push STREAM_START, CAPS, SEGMENT events if necessary */
+	gst_rlc_fec_enc_push_events(rlc_fec_enc);
+
+	/* Send out the FEC source packet */
+	ret = gst_pad_push(rlc_fec_enc->fecsourcepad, fec_source_packet);
+
+	if (ret != GST_FLOW_OK)
+		GST_DEBUG_OBJECT(rlc_fec_enc, "got return value %s while pushing", gst_flow_get_name(ret));
+
+	return ret;
+}
+
+
+static GstFlowReturn gst_rlc_fec_enc_push_repair_symbols(GstRLCFECEnc *rlc_fec_enc, guint num_repair_symbols)
+{
+	guint i, r;
+	gsize encoding_symbol_length = 0;
+	guint nss = rlc_fec_enc->window_fill;
+	GstFlowReturn ret = GST_FLOW_OK;
+
+	if (nss == 0)
+		return GST_FLOW_OK;
+
+	/* The repair symbols are as long as the longest ADUI in the window.
+	 * Shorter ADUIs are implicitely zero padded. */
+	for (i = 0; i < nss; ++i)
+	{
+		GstBuffer *adu = rlc_fec_enc->window_adus[(rlc_fec_enc->window_start + i) % rlc_fec_enc->window_size];
+		encoding_symbol_length = MAX(encoding_symbol_length, 1 + 2 + gst_buffer_get_size(adu));
+	}
+
+	for (r = 0; r < num_repair_symbols; ++r)
+	{
+		GstBuffer *fec_repair_packet;
+		GstMapInfo map_info;
+		guint8 *repair_symbol;
+		guint repair_key = rlc_fec_enc->repair_key;
+
+		rlc_fec_enc->repair_key = (rlc_fec_enc->repair_key + 1) & 0xFFFF;
+
+		gst_rlc_fec_generate_coding_coefficients(repair_key, rlc_fec_enc->coefs, nss, GST_RLC_FEC_DT_DENSE);
+
+		fec_repair_packet = gst_buffer_new_allocate(NULL, GST_RLC_FEC_REPAIR_PAYLOAD_ID_LENGTH + encoding_symbol_length, NULL);
+		gst_buffer_map(fec_repair_packet, &map_info, GST_MAP_WRITE);
+
+		gst_rlc_fec_write_repair_payload_id(map_info.data, repair_key, GST_RLC_FEC_DT_DENSE, nss, rlc_fec_enc->window_first_esi);
+
+		/* repair symbol = sum of coef_i * ADUI_i over the window */
+		repair_symbol = map_info.data + GST_RLC_FEC_REPAIR_PAYLOAD_ID_LENGTH;
+		memset(repair_symbol, 0, encoding_symbol_length);
+		for (i = 0; i < nss; ++i)
+		{
+			GstBuffer *adu = rlc_fec_enc->window_adus[(rlc_fec_enc->window_start + i) % rlc_fec_enc->window_size];
+			GstMapInfo adu_map_info;
+			guint8 adui_header[3];
+			guint adu_flow_id = 0; /* XXX: Currently, only one flow (flow 0) is supported */
+
+			gst_buffer_map(adu, &adu_map_info, GST_MAP_READ);
+
+			/* The ADUI header (flow ID and 16-bit big endian ADU length)
+			 * is part of the source symbol, see gst_rs_fec_enc_insert_adu() */
+			adui_header[0] = adu_flow_id;
+			adui_header[1] = (adu_map_info.size & 0xFF00) >> 8;
+			adui_header[2] = (adu_map_info.size & 0x00FF);
+
+			gst_fec_gf256_region_mul_add(repair_symbol, adui_header, rlc_fec_enc->coefs[i], 3);
+			gst_fec_gf256_region_mul_add(repair_symbol + 3, adu_map_info.data, rlc_fec_enc->coefs[i], adu_map_info.size);
+
+			gst_buffer_unmap(adu, &adu_map_info);
+		}
+
+		gst_buffer_unmap(fec_repair_packet, &map_info);
+
+		/* Mark discontinuity at start */
+		if (rlc_fec_enc->first_repair_packet)
+		{
+			GST_BUFFER_FLAG_SET(fec_repair_packet, GST_BUFFER_FLAG_DISCONT);
+			rlc_fec_enc->first_repair_packet = FALSE;
+		}
+
+		GST_LOG_OBJECT(rlc_fec_enc, "pushing repair symbol with repair key %u  (window ESIs: %u-%u  encoding symbol length: %" G_GSIZE_FORMAT ")", repair_key, rlc_fec_enc->window_first_esi, rlc_fec_enc->window_first_esi + nss - 1, encoding_symbol_length);
+
+		gst_rlc_fec_enc_push_events(rlc_fec_enc);
+
+		if ((ret = gst_pad_push(rlc_fec_enc->fecrepairpad, fec_repair_packet)) != GST_FLOW_OK)
+		{
+			GST_DEBUG_OBJECT(rlc_fec_enc, "got return value %s while pushing", gst_flow_get_name(ret));
+			break;
+		}
+	}
+
+	return ret;
+}
+
+
+static void gst_rlc_fec_enc_push_events(GstRLCFECEnc *rlc_fec_enc)
+{
+	GstEvent *event;
+	GstSegment segment;
+	gchar *stream_id;
+	guint group_id;
+	GstPad *pads[2];
+	gchar const *pad_names[2] = { "fecsource", "fecrepair" };
+	guint i;
+
+	if (rlc_fec_enc->segment_started)
+		return;
+
+	pads[0] = rlc_fec_enc->fecsourcepad;
+	pads[1] = rlc_fec_enc->fecrepairpad;
+
+	group_id = gst_util_group_id_next();
+	gst_segment_init(&segment, GST_FORMAT_BYTES);
+
+	if (rlc_fec_enc->stream_started)
+		GST_DEBUG_OBJECT(rlc_fec_enc, "pushing SEGMENT and CAPS events downstream");
+	else
+		GST_DEBUG_OBJECT(rlc_fec_enc, "pushing STREAM_START, SEGMENT, and CAPS events downstream (stream-start group id: %u)", group_id);
+
+	/* push stream start, caps, segment events for both pads */
+	for (i = 0; i < 2; ++i)
+	{
+		if (!rlc_fec_enc->stream_started)
+		{
+			GstCaps *caps;
+
+			/* stream start */
+			stream_id = gst_pad_create_stream_id(pads[i], GST_ELEMENT_CAST(rlc_fec_enc), pad_names[i]);
+			event = gst_event_new_stream_start(stream_id);
+			gst_event_set_group_id(event, group_id);
+			gst_pad_push_event(pads[i], event);
+			g_free(stream_id);
+
+			/* caps; the template caps contain the FEC encoding ID */
+			caps = gst_pad_get_pad_template_caps(pads[i]);
+			event = gst_event_new_caps(caps);
+			gst_pad_push_event(pads[i], event);
+			gst_caps_unref(caps);
+		}
+
+		/* segment */
+		event = gst_event_new_segment(&segment);
+		gst_pad_push_event(pads[i], event);
+	}
+
+	rlc_fec_enc->segment_started = TRUE;
+	rlc_fec_enc->stream_started = TRUE;
+}
+
+
+static void gst_rlc_fec_enc_free_payload_id(gpointer data)
+{
+	/* This function is called once a GstMemory block that
+	 * contains a FEC payload ID is deallocated */
+	g_slice_free1(GST_RLC_FEC_SOURCE_PAYLOAD_ID_LENGTH, data);
+}
+
+
+static void gst_rlc_fec_enc_reset_states(GstRLCFECEnc *rlc_fec_enc)
+{
+	rlc_fec_enc->num_adus_since_repair = 0;
+	rlc_fec_enc->first_source_packet = TRUE;
+	rlc_fec_enc->first_repair_packet = TRUE;
+	rlc_fec_enc->segment_started = FALSE;
+	rlc_fec_enc->eos_received = FALSE;
+}
+
+
+static void gst_rlc_fec_enc_flush(GstRLCFECEnc *rlc_fec_enc)
+{
+	gst_rlc_fec_enc_flush_window(rlc_fec_enc);
+	gst_rlc_fec_enc_reset_states(rlc_fec_enc);
+}
@@ -0,0 +1,104 @@
+/* RFC 8681-based sliding window forward error correction for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef GSTFECFRAME_RLC_RLCFECENC_H
+#define GSTFECFRAME_RLC_RLCFECENC_H
+
+#include <gst/gst.h>
+
+
+G_BEGIN_DECLS
+
+
+typedef struct _GstRLCFECEnc GstRLCFECEnc;
+typedef struct _GstRLCFECEncClass GstRLCFECEncClass;
+
+
+#define GST_TYPE_RLC_FEC_ENC             (gst_rlc_fec_enc_get_type())
+#define GST_RLC_FEC_ENC(obj)             (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_RLC_FEC_ENC, GstRLCFECEnc))
+#define GST_RLC_FEC_ENC_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST((klass), GST_TYPE_RLC_FEC_ENC, GstRLCFECEncClass))
+#define GST_RLC_FEC_ENC_CAST(obj)        ((GstRLCFECEnc *)(obj))
+#define GST_IS_RLC_FEC_ENC(obj)          (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_RLC_FEC_ENC))
+#define GST_IS_RLC_FEC_ENC_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass), GST_TYPE_RLC_FEC_ENC))
+
+
+struct _GstRLCFECEnc
+{
+	GstElement parent;
+
+	/* Sink- and source pads */
+	GstPad *sinkpad, *fecsourcepad, *fecrepairpad;
+
+	/* Maximum number of source symbols in the encoding window,
+	 * configured via property. This may only be modified if the
+	 * window is not allocated (that is, if window_adus == NULL). */
+	guint window_size;
+	/* How many source symbols are sent between two bursts of repair
+	 * symbols, and how many repair symbols make up one burst. Both
+	 * are configured via properties, and can be changed anytime. */
+	guint repair_interval, num_repair_symbols;
+
+	/* The encoding window. This is a ring buffer with window_size
+	 * entries, containing the most recent ADUs. window_start is the
+	 * index of the oldest ADU, window_fill the number of ADUs in the
+	 * window. The oldest ADU has the ESI window_first_esi, and the
+	 * following ones have consecutive ESIs. The ring buffer is
+	 * allocated at the NULL->READY state change. */
+	GstBuffer **window_adus;
+	guint window_start, window_fill;
+	guint32 window_first_esi;
+	/* Buffer for the coding coefficients of one repair symbol.
+	 * It has window_size entries. */
+	guint8 *coefs;
+
+	/* ESI of the next ADU. Like the source block number in rsfecenc,
+	 * this is _not_ reset after flushes and PAUSED->READY state changes,
+	 * to avoid confusing the decoder on the other end. */
+	guint32 next_esi;
+	/* Repair key of the next repair symbol (16 bits). Incremented
+	 * for each repair symbol, and not reset either. */
+	guint repair_key;
+	/* Number of ADUs received since the last repair burst */
+	guint num_adus_since_repair;
+
+	/* TRUE if no FEC source/repair packet has been pushed downstream yet.
+	 * These are set to TRUE at startup, after a flush, and when switching
+	 * back state from PAUSED to READY. */
+	gboolean first_source_packet, first_repair_packet;
+
+	/* Same meaning as the fields with the same name in GstRSFECEnc */
+	gboolean segment_started;
+	gboolean stream_started;
+	gboolean eos_received;
+};
+
+
+struct _GstRLCFECEncClass
+{
+	GstElementClass parent_class;
+};
+
+
+GType gst_rlc_fec_enc_get_type(void);
+
+
+G_END_DECLS
+
+
+#endif
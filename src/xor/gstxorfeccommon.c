@@ -0,0 +1,38 @@
+/* SMPTE 2022-1 style row/column XOR forward error correction for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include "gstxorfeccommon.h"
+
+
+void gst_xor_fec_write_payload_id(guint8 *payload_id, guint source_block_nr, guint esi)
+{
+	payload_id[0] = (source_block_nr & 0xFF00) >> 8;
+	payload_id[1] = (source_block_nr & 0x00FF) >> 0;
+	payload_id[2] = (esi & 0xFF00) >> 8;
+	payload_id[3] = (esi & 0x00FF) >> 0;
+}
+
+
+void gst_xor_fec_read_payload_id(guint8 const *payload_id, guint *source_block_nr, guint *esi)
+{
+	if (source_block_nr != NULL)
+		*source_block_nr = (((guint)(payload_id[0])) << 8) | ((guint)(payload_id[1]));
+	if (esi != NULL)
+		*esi = (((guint)(payload_id[2])) << 8) | ((guint)(payload_id[3]));
+}
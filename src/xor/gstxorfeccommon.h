@@ -0,0 +1,60 @@
+/* SMPTE 2022-1 style row/column XOR forward error correction for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef GSTFECFRAME_XOR_XORFECCOMMON_H
+#define GSTFECFRAME_XOR_XORFECCOMMON_H
+
+#include <gst/gst.h>
+
+
+G_BEGIN_DECLS
+
+
+/* The source symbols of a source block are arranged in a matrix with
+ * L columns and D rows, in row-major order (the ESI of the source symbol
+ * in row r and column c is r*L + c). There is one repair symbol for each
+ * row and one for each column, which is the XOR of the source symbols of
+ * that row or column. Row repair symbols have the ESIs k..k+D-1, column
+ * repair symbols k+D..k+D+L-1 (with k = L*D).
+ *
+ * The FEC payload ID consists of a 16-bit source block number and a 16-bit
+ * ESI (both big endian). It is appended to the ADU in FEC source packets,
+ * and prepended to the repair symbol in FEC repair packets. */
+#define GST_XOR_FEC_PAYLOAD_ID_LENGTH 4
+
+#define GST_XOR_FEC_MAX_COLUMNS 255
+#define GST_XOR_FEC_MAX_ROWS 255
+#define GST_XOR_FEC_DEFAULT_COLUMNS 10
+#define GST_XOR_FEC_DEFAULT_ROWS 10
+
+/* Encoder and decoder must use the same matrix dimensions. The encoder
+ * adds them to its caps, and the decoder refuses caps with differing
+ * values. */
+#define GST_XOR_FEC_COLUMNS_CAPS_FIELD "xor-columns"
+#define GST_XOR_FEC_ROWS_CAPS_FIELD "xor-rows"
+
+
+void gst_xor_fec_write_payload_id(guint8 *payload_id, guint source_block_nr, guint esi);
+void gst_xor_fec_read_payload_id(guint8 const *payload_id, guint *source_block_nr, guint *esi);
+
+
+G_END_DECLS
+
+
+#endif
@@ -0,0 +1,1074 @@
+/* SMPTE 2022-1 style row/column XOR forward error correction for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/**
+ * GstXORFECDec is a decoder element for the row/column XOR parity FEC
+ * produced by GstXORFECEnc. See GstXORFECEnc for an overview.
+ *
+ * The decoder keeps a table of source blocks, just like rsfecdec. For each
+ * source block, it keeps track of the received and recovered ADUs, the
+ * received repair packets, and the number of missing ADUs in each row and
+ * column. If exactly one ADU of a row or column is missing, and the repair
+ * packet of that row or column was received, the missing ADUI is recovered
+ * by XORing the repair symbol with the other ADUIs of the row or column.
+ * A recovered ADU may in turn complete the "exactly one missing" condition
+ * for the crossing column or row, so recovery alternates between rows and
+ * columns until no more progress can be made. This happens as soon as a
+ * FEC packet arrives; unlike rsfecdec, there is no need to wait for the
+ * source block to be complete.
+ *
+ * Received ADUs are pushed downstream immediately, and recovered ADUs are
+ * pushed as soon as they are recovered. The output is therefore not sorted.
+ * An element downstream (like an rtpjitterbuffer) has to reorder ADUs if
+ * necessary.
+ *
+ * Repair packets are accepted over both the fecrepair and the fecrowrepair
+ * sinkpads. The fecrowrepair sinkpad only needs to be linked if the encoder's
+ * "separate-repair-pads" property is set to TRUE. If it is not linked, EOS is
+ * pushed downstream once the fecsource and fecrepair sinkpads received EOS.
+ *
+ * The "max-source-block-age" property works just like in rsfecdec. Since
+ * column repair packets are sent at the end of a source block, values below
+ * 2 will cause column repair packets to be discarded if they arrive after
+ * the first FEC source packet of the next source block.
+ */
+
+
+#include <string.h>
+#include "common/gstgf256.h"
+#include "gstxorfeccommon.h"
+#include "gstxorfecdec.h"
+
+
+GST_DEBUG_CATEGORY(xor_fec_dec_debug);
+#define GST_CAT_DEFAULT xor_fec_dec_debug
+
+
+enum
+{
+	PROP_0,
+	PROP_COLUMNS,
+	PROP_ROWS,
+	PROP_MAX_SOURCE_BLOCK_AGE,
+	PROP_DO_TIMESTAMP
+};
+
+
+#define DEFAULT_MAX_SOURCE_BLOCK_AGE 2
+#define DEFAULT_DO_TIMESTAMP TRUE
+
+
+#define FEC_SOURCE_CAPS_STR "application/x-fec-source-flow, fec-scheme = (string) xor-row-column"
+#define FEC_REPAIR_CAPS_STR "application/x-fec-repair-flow, fec-scheme = (string) xor-row-column"
+
+/* Large enough for the ADUI of the largest possible ADU */
+#define MAX_ADUI_LENGTH (3 + 65535)
+
+/* Source block numbers have 16 bits */
+#define BLOCK_NR_MASK 0xFFFF
+
+
+#define XOR_LOCK_MUTEX(obj) do { g_mutex_lock(&(((GstXORFECDec *)(obj))->mutex)); } while (0)
+#define XOR_UNLOCK_MUTEX(obj) do { g_mutex_unlock(&(((GstXORFECDec *)(obj))->mutex)); } while (0)
+
+
+static GstStaticPadTemplate static_fecsource_template = GST_STATIC_PAD_TEMPLATE(
+	"fecsource",
+	GST_PAD_SINK,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS(FEC_SOURCE_CAPS_STR)
+);
+
+
+static GstStaticPadTemplate static_fecrepair_template = GST_STATIC_PAD_TEMPLATE(
+	"fecrepair",
+	GST_PAD_SINK,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS(FEC_REPAIR_CAPS_STR)
+);
+
+
+static GstStaticPadTemplate static_fecrowrepair_template = GST_STATIC_PAD_TEMPLATE(
+	"fecrowrepair",
+	GST_PAD_SINK,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS(FEC_REPAIR_CAPS_STR)
+);
+
+
+static GstStaticPadTemplate static_src_template = GST_STATIC_PAD_TEMPLATE(
+	"src",
+	GST_PAD_SRC,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS_ANY
+);
+
+
+
+
+G_DEFINE_TYPE(GstXORFECDec, gst_xor_fec_dec, GST_TYPE_ELEMENT)
+
+
+
+
+static void gst_xor_fec_dec_finalize(GObject *object);
+static void gst_xor_fec_dec_set_property(GObject *object, guint prop_id, GValue const *value, GParamSpec *pspec);
+static void gst_xor_fec_dec_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec);
+
+static GstStateChangeReturn gst_xor_fec_dec_change_state(GstElement *element, GstStateChange transition);
+
+static gboolean gst_xor_fec_dec_sink_event(GstPad *pad, GstObject *parent, GstEvent *event);
+static GstFlowReturn gst_xor_fec_dec_fecsource_chain(GstPad *pad, GstObject *parent, GstBuffer *buffer);
+static GstFlowReturn gst_xor_fec_dec_fecrepair_chain(GstPad *pad, GstObject *parent, GstBuffer *buffer);
+static gboolean gst_xor_fec_dec_check_caps(GstXORFECDec *xor_fec_dec, GstCaps *caps);
+
+static GstFlowReturn gst_xor_fec_dec_insert_fec_packet(GstXORFECDec *xor_fec_dec, GstBuffer *fec_packet, gboolean is_source_packet);
+
+static GstXORFECDecSourceBlock* gst_xor_fec_dec_create_source_block(GstXORFECDec *xor_fec_dec, guint block_nr);
+static void gst_xor_fec_dec_destroy_source_block(GstXORFECDec *xor_fec_dec, GstXORFECDecSourceBlock *source_block);
+static void gst_xor_fec_dec_add_adu(GstXORFECDec *xor_fec_dec, GstXORFECDecSourceBlock *source_block, GstBuffer *adu, guint esi, GQueue *pending_lines);
+static GstFlowReturn gst_xor_fec_dec_recover_adus(GstXORFECDec *xor_fec_dec, GstXORFECDecSourceBlock *source_block, GQueue *pending_lines);
+static GstBuffer* gst_xor_fec_dec_recover_adu(GstXORFECDec *xor_fec_dec, GstXORFECDecSourceBlock *source_block, guint line, guint missing_esi);
+
+static gboolean gst_xor_fec_dec_is_source_block_nr_newer(guint candidate_block_nr, guint reference_block_nr);
+static gboolean gst_xor_fec_dec_is_source_block_nr_recent_enough(guint candidate_block_nr, guint reference_block_nr, guint max_age);
+static void gst_xor_fec_dec_prune_source_block_table(GstXORFECDec *xor_fec_dec, guint source_block_nr);
+
+static void gst_xor_fec_dec_reset_states(GstXORFECDec *xor_fec_dec);
+static void gst_xor_fec_dec_flush(GstXORFECDec *xor_fec_dec);
+static GstFlowReturn gst_xor_fec_dec_push_adu(GstXORFECDec *xor_fec_dec, GstBuffer *adu);
+static void gst_xor_fec_dec_push_stream_start(GstXORFECDec *xor_fec_dec);
+static void gst_xor_fec_dec_push_segment(GstXORFECDec *xor_fec_dec);
+static void gst_xor_fec_dec_push_eos(GstXORFECDec *xor_fec_dec);
+
+
+
+
+static void gst_xor_fec_dec_class_init(GstXORFECDecClass *klass)
+{
+	GObjectClass *object_class;
+	GstElementClass *element_class;
+
+	GST_DEBUG_CATEGORY_INIT(xor_fec_dec_debug, "xorfecdec", 0, "row/column XOR FEC decoder");
+
+	object_class = G_OBJECT_CLASS(klass);
+	element_class = GST_ELEMENT_CLASS(klass);
+
+	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_fecsource_template));
+	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_fecrepair_template));
+	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_fecrowrepair_template));
+	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_src_template));
+
+	object_class->finalize      = GST_DEBUG_FUNCPTR(gst_xor_fec_dec_finalize);
+	object_class->set_property  = GST_DEBUG_FUNCPTR(gst_xor_fec_dec_set_property);
+	object_class->get_property  = GST_DEBUG_FUNCPTR(gst_xor_fec_dec_get_property);
+
+	element_class->change_state = GST_DEBUG_FUNCPTR(gst_xor_fec_dec_change_state);
+
+	g_object_class_install_property(
+		object_class,
+		PROP_COLUMNS,
+		g_param_spec_uint(
+			"columns",
+			"Columns",
+			"Number of columns (L) in the source block matrix (must match the encoder's value)",
+			1, GST_XOR_FEC_MAX_COLUMNS,
+			GST_XOR_FEC_DEFAULT_COLUMNS,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_ROWS,
+		g_param_spec_uint(
+			"rows",
+			"Rows",
+			"Number of rows (D) in the source block matrix (must match the encoder's value)",
+			1, GST_XOR_FEC_MAX_ROWS,
+			GST_XOR_FEC_DEFAULT_ROWS,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_MAX_SOURCE_BLOCK_AGE,
+		g_param_spec_uint(
+			"max-source-block-age",
+			"Max source block age",
+			"How old a source block can be before it is evicted from the hash table",
+			1, G_MAXUINT16,
+			DEFAULT_MAX_SOURCE_BLOCK_AGE,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_DO_TIMESTAMP,
+		g_param_spec_boolean(
+			"do-timestamp",
+			"Do timestamping",
+			"Apply the current running time to outgoing ADUs",
+			DEFAULT_DO_TIMESTAMP,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+
+	gst_element_class_set_static_metadata(
+		element_class,
+		"Row/column XOR forward error correction decoder",
+		"Codec/Decoder/Network",
+		"Decoder for forward-error erasure coding based on row and column XOR parity (similar to SMPTE 2022-1)",
+		"Carlos Rafael Giani <dv@pseudoterminal.org>"
+	);
+}
+
+
+static void gst_xor_fec_dec_init(GstXORFECDec *xor_fec_dec)
+{
+	xor_fec_dec->num_columns = GST_XOR_FEC_DEFAULT_COLUMNS;
+	xor_fec_dec->num_rows = GST_XOR_FEC_DEFAULT_ROWS;
+	xor_fec_dec->num_source_symbols = xor_fec_dec->num_columns * xor_fec_dec->num_rows;
+
+	xor_fec_dec->max_source_block_age = DEFAULT_MAX_SOURCE_BLOCK_AGE;
+	xor_fec_dec->do_timestamp = DEFAULT_DO_TIMESTAMP;
+
+	xor_fec_dec->recovery_symbol = NULL;
+
+	xor_fec_dec->source_block_table = g_hash_table_new(g_direct_hash, g_direct_equal);
+	xor_fec_dec->first_pruning = TRUE;
+	xor_fec_dec->most_recent_block_nr = 0;
+
+	g_mutex_init(&(xor_fec_dec->mutex));
+
+	xor_fec_dec->segment_started = FALSE;
+	xor_fec_dec->stream_started = FALSE;
+	xor_fec_dec->fecsource_eos = FALSE;
+	xor_fec_dec->fecrepair_eos = FALSE;
+	xor_fec_dec->fecrowrepair_eos = FALSE;
+
+	xor_fec_dec->fecsourcepad = gst_ghost_pad_new_no_target_from_template(
+		"fecsource",
+		gst_element_class_get_pad_template(GST_ELEMENT_GET_CLASS(xor_fec_dec), "fecsource")
+	);
+	gst_element_add_pad(GST_ELEMENT(xor_fec_dec), xor_fec_dec->fecsourcepad);
+
+	xor_fec_dec->fecrepairpad = gst_ghost_pad_new_no_target_from_template(
+		"fecrepair",
+		gst_element_class_get_pad_template(GST_ELEMENT_GET_CLASS(xor_fec_dec), "fecrepair")
+	);
+	gst_element_add_pad(GST_ELEMENT(xor_fec_dec), xor_fec_dec->fecrepairpad);
+
+	xor_fec_dec->fecrowrepairpad = gst_ghost_pad_new_no_target_from_template(
+		"fecrowrepair",
+		gst_element_class_get_pad_template(GST_ELEMENT_GET_CLASS(xor_fec_dec), "fecrowrepair")
+	);
+	gst_element_add_pad(GST_ELEMENT(xor_fec_dec), xor_fec_dec->fecrowrepairpad);
+
+	xor_fec_dec->srcpad = gst_ghost_pad_new_no_target_from_template(
+		"src",
+		gst_element_class_get_pad_template(GST_ELEMENT_GET_CLASS(xor_fec_dec), "src")
+	);
+	gst_element_add_pad(GST_ELEMENT(xor_fec_dec), xor_fec_dec->srcpad);
+
+	gst_pad_set_event_function(xor_fec_dec->fecsourcepad, GST_DEBUG_FUNCPTR(gst_xor_fec_dec_sink_event));
+	gst_pad_set_event_function(xor_fec_dec->fecrepairpad, GST_DEBUG_FUNCPTR(gst_xor_fec_dec_sink_event));
+	gst_pad_set_event_function(xor_fec_dec->fecrowrepairpad, GST_DEBUG_FUNCPTR(gst_xor_fec_dec_sink_event));
+
+	gst_pad_set_chain_function(xor_fec_dec->fecsourcepad, GST_DEBUG_FUNCPTR(gst_xor_fec_dec_fecsource_chain));
+	gst_pad_set_chain_function(xor_fec_dec->fecrepairpad, GST_DEBUG_FUNCPTR(gst_xor_fec_dec_fecrepair_chain));
+	gst_pad_set_chain_function(xor_fec_dec->fecrowrepairpad, GST_DEBUG_FUNCPTR(gst_xor_fec_dec_fecrepair_chain));
+}
+
+
+static void gst_xor_fec_dec_finalize(GObject *object)
+{
+	GstXORFECDec *xor_fec_dec = GST_XOR_FEC_DEC(object);
+
+	g_hash_table_unref(xor_fec_dec->source_block_table);
+	g_mutex_clear(&(xor_fec_dec->mutex));
+
+	G_OBJECT_CLASS(gst_xor_fec_dec_parent_class)->finalize(object);
+}
+
+
+static void gst_xor_fec_dec_set_property(GObject *object, guint prop_id, GValue const *value, GParamSpec *pspec)
+{
+	GstXORFECDec *xor_fec_dec = GST_XOR_FEC_DEC(object);
+
+	switch (prop_id)
+	{
+		case PROP_COLUMNS:
+			XOR_LOCK_MUTEX(xor_fec_dec);
+			if (xor_fec_dec->recovery_symbol == NULL)
+			{
+				xor_fec_dec->num_columns = g_value_get_uint(value);
+				xor_fec_dec->num_source_symbols = xor_fec_dec->num_columns * xor_fec_dec->num_rows;
+			}
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set number of columns after the decoder was initialized"), (NULL));
+			XOR_UNLOCK_MUTEX(xor_fec_dec);
+			break;
+
+		case PROP_ROWS:
+			XOR_LOCK_MUTEX(xor_fec_dec);
+			if (xor_fec_dec->recovery_symbol == NULL)
+			{
+				xor_fec_dec->num_rows = g_value_get_uint(value);
+				xor_fec_dec->num_source_symbols = xor_fec_dec->num_columns * xor_fec_dec->num_rows;
+			}
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set number of rows after the decoder was initialized"), (NULL));
+			XOR_UNLOCK_MUTEX(xor_fec_dec);
+			break;
+
+		case PROP_MAX_SOURCE_BLOCK_AGE:
+			XOR_LOCK_MUTEX(xor_fec_dec);
+			xor_fec_dec->max_source_block_age = g_value_get_uint(value);
+			XOR_UNLOCK_MUTEX(xor_fec_dec);
+			break;
+
+		case PROP_DO_TIMESTAMP:
+			XOR_LOCK_MUTEX(xor_fec_dec);
+			xor_fec_dec->do_timestamp = g_value_get_boolean(value);
+			XOR_UNLOCK_MUTEX(xor_fec_dec);
+			break;
+
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+			break;
+	}
+}
+
+
+static void gst_xor_fec_dec_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec)
+{
+	GstXORFECDec *xor_fec_dec = GST_XOR_FEC_DEC(object);
+
+	switch (prop_id)
+	{
+		case PROP_COLUMNS:
+			XOR_LOCK_MUTEX(xor_fec_dec);
+			g_value_set_uint(value, xor_fec_dec->num_columns);
+			XOR_UNLOCK_MUTEX(xor_fec_dec);
+			break;
+
+		case PROP_ROWS:
+			XOR_LOCK_MUTEX(xor_fec_dec);
+			g_value_set_uint(value, xor_fec_dec->num_rows);
+			XOR_UNLOCK_MUTEX(xor_fec_dec);
+			break;
+
+		case PROP_MAX_SOURCE_BLOCK_AGE:
+			XOR_LOCK_MUTEX(xor_fec_dec);
+			g_value_set_uint(value, xor_fec_dec->max_source_block_age);
+			XOR_UNLOCK_MUTEX(xor_fec_dec);
+			break;
+
+		case PROP_DO_TIMESTAMP:
+			XOR_LOCK_MUTEX(xor_fec_dec);
+			g_value_set_boolean(value, xor_fec_dec->do_timestamp);
+			XOR_UNLOCK_MUTEX(xor_fec_dec);
+			break;
+
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+			break;
+	}
+}
+
+
+static GstStateChangeReturn gst_xor_fec_dec_change_state(GstElement *element, GstStateChange transition)
+{
+	GstXORFECDec *xor_fec_dec = GST_XOR_FEC_DEC(element);
+	GstStateChangeReturn result;
+
+	switch (transition)
+	{
+		case GST_STATE_CHANGE_NULL_TO_READY:
+			g_assert(xor_fec_dec->recovery_symbol == NULL);
+			xor_fec_dec->recovery_symbol = g_slice_alloc(MAX_ADUI_LENGTH);
+			break;
+
+		case GST_STATE_CHANGE_READY_TO_PAUSED:
+			/* Make sure states are at their initial value */
+			gst_xor_fec_dec_reset_states(xor_fec_dec);
+			break;
+
+		default:
+			break;
+	}
+
+	if ((result = GST_ELEMENT_CLASS(gst_xor_fec_dec_parent_class)->change_state(element, transition)) == GST_STATE_CHANGE_FAILURE)
+		return result;
+
+	switch (transition)
+	{
+		case GST_STATE_CHANGE_PAUSED_TO_READY:
+			/* Make sure any source blocks are flushed
+			 * and states are reset properly */
+			gst_xor_fec_dec_flush(xor_fec_dec);
+			/* Stream is done after switching to READY */
+			xor_fec_dec->stream_started = FALSE;
+			break;
+
+		case GST_STATE_CHANGE_READY_TO_NULL:
+			g_slice_free1(MAX_ADUI_LENGTH, xor_fec_dec->recovery_symbol);
+			xor_fec_dec->recovery_symbol = NULL;
+			break;
+
+		default:
+			break;
+	}
+
+	return result;
+}
+
+
+static gboolean gst_xor_fec_dec_sink_event(GstPad *pad, GstObject *parent, GstEvent *event)
+{
+	GstXORFECDec *xor_fec_dec = GST_XOR_FEC_DEC(parent);
+
+	/* The same event function is used for all three sinkpads */
+
+	switch (GST_EVENT_TYPE(event))
+	{
+		case GST_EVENT_STREAM_START:
+			/* Throw away incoming STREAM_START events
+			 * this decoder generates its own STREAM_START events */
+			gst_event_unref(event);
+			return TRUE;
+
+		case GST_EVENT_CAPS:
+		{
+			/* Throw away incoming caps after checking them
+			 * this decoder generates its own CAPS events */
+			GstCaps *caps;
+			gboolean ret;
+
+			gst_event_parse_caps(event, &caps);
+			ret = gst_xor_fec_dec_check_caps(xor_fec_dec, caps);
+			gst_event_unref(event);
+			return ret;
+		}
+
+		case GST_EVENT_SEGMENT:
+			/* Throw away incoming segments
+			 * this decoder generates its own SEGMENT events */
+			gst_event_unref(event);
+			return TRUE;
+
+		case GST_EVENT_FLUSH_STOP:
+			/* Lock to avoid race conditions between flushes here
+			 * and chain function calls at the other sinkpads */
+			XOR_LOCK_MUTEX(xor_fec_dec);
+			gst_xor_fec_dec_flush(xor_fec_dec);
+			XOR_UNLOCK_MUTEX(xor_fec_dec);
+			break;
+
+		case GST_EVENT_EOS:
+			/* Lock to avoid race conditions between here
+			 * and chain function calls at the other sinkpads */
+			XOR_LOCK_MUTEX(xor_fec_dec);
+
+			if (pad == xor_fec_dec->fecsourcepad)
+				xor_fec_dec->fecsource_eos = TRUE;
+			else if (pad == xor_fec_dec->fecrepairpad)
+				xor_fec_dec->fecrepair_eos = TRUE;
+			else
+				xor_fec_dec->fecrowrepair_eos = TRUE;
+			gst_xor_fec_dec_push_eos(xor_fec_dec);
+
+			XOR_UNLOCK_MUTEX(xor_fec_dec);
+			break;
+
+		default:
+			break;
+	}
+
+	return gst_pad_event_default(pad, parent, event);
+}
+
+
+static GstFlowReturn gst_xor_fec_dec_fecsource_chain(G_GNUC_UNUSED GstPad *pad, GstObject *parent, GstBuffer *buffer)
+{
+	GstXORFECDec *xor_fec_dec = GST_XOR_FEC_DEC_CAST(parent);
+	GstFlowReturn ret = GST_FLOW_OK;
+
+	/* Lock to prevent race conditions between flushes, this chain function,
+	 * and chain function calls at the other sinkpads */
+	XOR_LOCK_MUTEX(xor_fec_dec);
+
+	if (xor_fec_dec->fecsource_eos)
+	{
+		GST_DEBUG_OBJECT(xor_fec_dec, "received FEC source data after EOS was received - dropping buffer");
+		gst_buffer_unref(buffer);
+		ret = GST_FLOW_EOS;
+	}
+	else
+		ret = gst_xor_fec_dec_insert_fec_packet(xor_fec_dec, buffer, TRUE);
+
+	XOR_UNLOCK_MUTEX(xor_fec_dec);
+
+	return ret;
+}
+
+
+static GstFlowReturn gst_xor_fec_dec_fecrepair_chain(GstPad *pad, GstObject *parent, GstBuffer *buffer)
+{
+	GstXORFECDec *xor_fec_dec = GST_XOR_FEC_DEC_CAST(parent);
+	GstFlowReturn ret = GST_FLOW_OK;
+	gboolean eos;
+
+	/* Lock to prevent race conditions between flushes, this chain function,
+	 * and chain function calls at the other sinkpads */
+	XOR_LOCK_MUTEX(xor_fec_dec);
+
+	/* This chain function is used by both repair sinkpads */
+	eos = (pad == xor_fec_dec->fecrepairpad) ? xor_fec_dec->fecrepair_eos : xor_fec_dec->fecrowrepair_eos;
+
+	if (eos)
+	{
+		GST_DEBUG_OBJECT(xor_fec_dec, "received FEC repair data after EOS was received - dropping buffer");
+		gst_buffer_unref(buffer);
+		ret = GST_FLOW_EOS;
+	}
+	else
+		ret = gst_xor_fec_dec_insert_fec_packet(xor_fec_dec, buffer, FALSE);
+
+	XOR_UNLOCK_MUTEX(xor_fec_dec);
+
+	return ret;
+}
+
+
+static gboolean gst_xor_fec_dec_check_caps(GstXORFECDec *xor_fec_dec, GstCaps *caps)
+{
+	GstStructure const *s = gst_caps_get_structure(caps, 0);
+	guint num_columns, num_rows;
+
+	/* Refuse caps with matrix dimensions that differ from the configured
+	 * ones, since rows and columns would be mixed up, and the recovered
+	 * ADUs would contain garbage. Caps without these fields are
+	 * accepted; the properties must then be set correctly by the user. */
+
+	if (gst_structure_get_uint(s, GST_XOR_FEC_COLUMNS_CAPS_FIELD, &num_columns) && (num_columns != xor_fec_dec->num_columns))
+	{
+		GST_ERROR_OBJECT(xor_fec_dec, "caps use %u columns, but decoder is configured for %u", num_columns, xor_fec_dec->num_columns);
+		return FALSE;
+	}
+
+	if (gst_structure_get_uint(s, GST_XOR_FEC_ROWS_CAPS_FIELD, &num_rows) && (num_rows != xor_fec_dec->num_rows))
+	{
+		GST_ERROR_OBJECT(xor_fec_dec, "caps use %u rows, but decoder is configured for %u", num_rows, xor_fec_dec->num_rows);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+
+static GstFlowReturn gst_xor_fec_dec_insert_fec_packet(GstXORFECDec *xor_fec_dec, GstBuffer *fec_packet, gboolean is_source_packet)
+{
+	guint8 payload_id[GST_XOR_FEC_PAYLOAD_ID_LENGTH];
+	guint source_block_nr, esi, line;
+	gsize packet_size;
+	GstXORFECDecSourceBlock *source_block;
+	GQueue pending_lines = G_QUEUE_INIT;
+	gchar const *packet_str = is_source_packet ? "source" : "repair";
+	GstFlowReturn ret = GST_FLOW_OK;
+
+	packet_size = gst_buffer_get_size(fec_packet);
+	if (packet_size < GST_XOR_FEC_PAYLOAD_ID_LENGTH)
+	{
+		GST_WARNING_OBJECT(xor_fec_dec, "FEC %s packet is too small (%" G_GSIZE_FORMAT " bytes) - discarding packet", packet_str, packet_size);
+		gst_buffer_unref(fec_packet);
+		return GST_FLOW_OK;
+	}
+
+	/* The payload ID trails the ADU in FEC source packets,
+	 * and precedes the repair symbol in FEC repair packets */
+	gst_buffer_extract(fec_packet, is_source_packet ? (packet_size - GST_XOR_FEC_PAYLOAD_ID_LENGTH) : 0, payload_id, GST_XOR_FEC_PAYLOAD_ID_LENGTH);
+	gst_xor_fec_read_payload_id(payload_id, &source_block_nr, &esi);
+
+	GST_LOG_OBJECT(xor_fec_dec, "adding FEC %s packet with source block nr #%u and ESI %u", packet_str, source_block_nr, esi);
+
+	/* Discard packets with invalid ESIs, since they would otherwise
+	 * cause out-of-bounds accesses in the tables */
+	if ((is_source_packet && (esi >= xor_fec_dec->num_source_symbols)) || (!is_source_packet && ((esi < xor_fec_dec->num_source_symbols) || (esi >= (xor_fec_dec->num_source_symbols + xor_fec_dec->num_rows + xor_fec_dec->num_columns)))))
+	{
+		GST_WARNING_OBJECT(xor_fec_dec, "FEC %s packet has invalid ESI %u - discarding packet", packet_str, esi);
+		gst_buffer_unref(fec_packet);
+		return GST_FLOW_OK;
+	}
+
+	/* Discard packet if it is too old */
+	if (!xor_fec_dec->first_pruning && !gst_xor_fec_dec_is_source_block_nr_recent_enough(source_block_nr, xor_fec_dec->most_recent_block_nr, xor_fec_dec->max_source_block_age))
+	{
+		GST_LOG_OBJECT(xor_fec_dec, "FEC %s packet's block nr is too old (packet block nr: %u most recent nr: %u) - discarding obsolete packet", packet_str, source_block_nr, xor_fec_dec->most_recent_block_nr);
+		gst_buffer_unref(fec_packet);
+		return GST_FLOW_OK;
+	}
+
+	gst_xor_fec_dec_prune_source_block_table(xor_fec_dec, source_block_nr);
+
+	/* Get the corresponding source block; create a new one if it does not exist */
+	source_block = g_hash_table_lookup(xor_fec_dec->source_block_table, GINT_TO_POINTER(source_block_nr));
+	if (source_block == NULL)
+	{
+		GST_LOG_OBJECT(xor_fec_dec, "source block with nr #%u not present - creating", source_block_nr);
+		source_block = gst_xor_fec_dec_create_source_block(xor_fec_dec, source_block_nr);
+		g_hash_table_insert(xor_fec_dec->source_block_table, GINT_TO_POINTER(source_block_nr), source_block);
+	}
+
+	if (is_source_packet)
+	{
+		GstBuffer *adu;
+
+		if (source_block->adus[esi] != NULL)
+		{
+			GST_LOG_OBJECT(xor_fec_dec, "ADU with ESI %u already in source block #%u - discarding duplicate packet", esi, source_block_nr);
+			gst_buffer_unref(fec_packet);
+			return GST_FLOW_OK;
+		}
+
+		/* Extract ADU from the packet. Using a GStreamer subbuffer
+		 * to avoid unnecessary copies. */
+		adu = gst_buffer_copy_region(fec_packet, GST_BUFFER_COPY_MEMORY | GST_BUFFER_COPY_MERGE, 0, packet_size - GST_XOR_FEC_PAYLOAD_ID_LENGTH);
+		gst_buffer_unref(fec_packet);
+
+		gst_xor_fec_dec_add_adu(xor_fec_dec, source_block, gst_buffer_ref(adu), esi, &pending_lines);
+
+		GST_LOG_OBJECT(xor_fec_dec, "pushing ADU with ESI %u from source block %u", esi, source_block_nr);
+
+		if ((ret = gst_xor_fec_dec_push_adu(xor_fec_dec, adu)) != GST_FLOW_OK)
+		{
+			g_queue_clear(&pending_lines);
+			return ret;
+		}
+	}
+	else
+	{
+		line = esi - xor_fec_dec->num_source_symbols;
+
+		/* Repair packets are useless if their row or column is complete already */
+		if ((source_block->repair_packets[line] != NULL) || (source_block->num_missing_adus[line] == 0))
+		{
+			GST_LOG_OBJECT(xor_fec_dec, "discarding unnecessary FEC repair packet with ESI %u in source block #%u", esi, source_block_nr);
+			gst_buffer_unref(fec_packet);
+			return GST_FLOW_OK;
+		}
+
+		source_block->repair_packets[line] = fec_packet;
+		g_queue_push_tail(&pending_lines, GUINT_TO_POINTER(line));
+	}
+
+	return gst_xor_fec_dec_recover_adus(xor_fec_dec, source_block, &pending_lines);
+}
+
+
+static GstXORFECDecSourceBlock* gst_xor_fec_dec_create_source_block(GstXORFECDec *xor_fec_dec, guint block_nr)
+{
+	guint i;
+	guint num_lines = xor_fec_dec->num_rows + xor_fec_dec->num_columns;
+	GstXORFECDecSourceBlock *source_block = g_slice_new(GstXORFECDecSourceBlock);
+
+	source_block->block_nr = block_nr;
+	source_block->adus = g_slice_alloc0(sizeof(GstBuffer *) * xor_fec_dec->num_source_symbols);
+	source_block->num_known_adus = 0;
+	source_block->repair_packets = g_slice_alloc0(sizeof(GstBuffer *) * num_lines);
+	source_block->num_missing_adus = g_slice_alloc(sizeof(guint) * num_lines);
+
+	/* Initially, all ADUs of all rows and columns are missing */
+	for (i = 0; i < xor_fec_dec->num_rows; ++i)
+		source_block->num_missing_adus[i] = xor_fec_dec->num_columns;
+	for (i = 0; i < xor_fec_dec->num_columns; ++i)
+		source_block->num_missing_adus[xor_fec_dec->num_rows + i] = xor_fec_dec->num_rows;
+
+	return source_block;
+}
+
+
+static void gst_xor_fec_dec_destroy_source_block(GstXORFECDec *xor_fec_dec, GstXORFECDecSourceBlock *source_block)
+{
+	guint i;
+	guint num_lines = xor_fec_dec->num_rows + xor_fec_dec->num_columns;
+
+	for (i = 0; i < xor_fec_dec->num_source_symbols; ++i)
+	{
+		if (source_block->adus[i] != NULL)
+			gst_buffer_unref(source_block->adus[i]);
+	}
+
+	for (i = 0; i < num_lines; ++i)
+	{
+		if (source_block->repair_packets[i] != NULL)
+			gst_buffer_unref(source_block->repair_packets[i]);
+	}
+
+	g_slice_free1(sizeof(GstBuffer *) * xor_fec_dec->num_source_symbols, source_block->adus);
+	g_slice_free1(sizeof(GstBuffer *) * num_lines, source_block->repair_packets);
+	g_slice_free1(sizeof(guint) * num_lines, source_block->num_missing_adus);
+	g_slice_free1(sizeof(GstXORFECDecSourceBlock), source_block);
+}
+
+
+static void gst_xor_fec_dec_add_adu(GstXORFECDec *xor_fec_dec, GstXORFECDecSourceBlock *source_block, GstBuffer *adu, guint esi, GQueue *pending_lines)
+{
+	guint row_line = esi / xor_fec_dec->num_columns;
+	guint column_line = xor_fec_dec->num_rows + (esi % xor_fec_dec->num_columns);
+
+	/* Takes ownership over adu */
+
+	source_block->adus[esi] = adu;
+	source_block->num_known_adus++;
+
+	/* The row and column of this ADU may now have exactly one missing
+	 * ADU, so they have to be checked for possible recoveries */
+	source_block->num_missing_adus[row_line]--;
+	source_block->num_missing_adus[column_line]--;
+	g_queue_push_tail(pending_lines, GUINT_TO_POINTER(row_line));
+	g_queue_push_tail(pending_lines, GUINT_TO_POINTER(column_line));
+}
+
+
+static GstFlowReturn gst_xor_fec_dec_recover_adus(GstXORFECDec *xor_fec_dec, GstXORFECDecSourceBlock *source_block, GQueue *pending_lines)
+{
+	GstFlowReturn ret = GST_FLOW_OK;
+
+	/* Check the rows and columns in the pending_lines queue. Each
+	 * recovered ADU adds its row and column to the queue, so this
+	 * continues until no more ADUs can be recovered. */
+	while (!g_queue_is_empty(pending_lines))
+	{
+		guint line = GPOINTER_TO_UINT(g_queue_pop_head(pending_lines));
+		guint i, missing_esi = 0, first_esi, esi_step, num_esis;
+		GstBuffer *adu;
+
+		if (source_block->repair_packets[line] == NULL)
+			continue;
+
+		if (source_block->num_missing_adus[line] == 0)
+		{
+			/* All ADUs of this row or column are known; its repair packet is no longer needed */
+			gst_buffer_unref(source_block->repair_packets[line]);
+			source_block->repair_packets[line] = NULL;
+			continue;
+		}
+
+		if (source_block->num_missing_adus[line] != 1)
+			continue;
+
+		/* Find the missing ADU */
+		if (line < xor_fec_dec->num_rows)
+		{
+			first_esi = line * xor_fec_dec->num_columns;
+			esi_step = 1;
+			num_esis = xor_fec_dec->num_columns;
+		}
+		else
+		{
+			first_esi = line - xor_fec_dec->num_rows;
+			esi_step = xor_fec_dec->num_columns;
+			num_esis = xor_fec_dec->num_rows;
+		}
+
+		for (i = 0; i < num_esis; ++i)
+		{
+			missing_esi = first_esi + i * esi_step;
+			if (source_block->adus[missing_esi] == NULL)
+				break;
+		}
+		g_assert(i < num_esis);
+
+		adu = gst_xor_fec_dec_recover_adu(xor_fec_dec, source_block, line, missing_esi);
+
+		/* The repair packet is used up either way. If recovery failed, the
+		 * packet was corrupt, and the line cannot be used anymore. */
+		gst_buffer_unref(source_block->repair_packets[line]);
+		source_block->repair_packets[line] = NULL;
+
+		if (adu == NULL)
+			continue;
+
+		gst_xor_fec_dec_add_adu(xor_fec_dec, source_block, gst_buffer_ref(adu), missing_esi, pending_lines);
+
+		GST_LOG_OBJECT(xor_fec_dec, "pushing recovered ADU with ESI %u from source block %u", missing_esi, source_block->block_nr);
+
+		if ((ret = gst_xor_fec_dec_push_adu(xor_fec_dec, adu)) != GST_FLOW_OK)
+		{
+			GST_DEBUG_OBJECT(xor_fec_dec, "got return value %s while pushing recovered ADU", gst_flow_get_name(ret));
+			break;
+		}
+	}
+
+	g_queue_clear(pending_lines);
+
+	return ret;
+}
+
+
+static GstBuffer* gst_xor_fec_dec_recover_adu(GstXORFECDec *xor_fec_dec, GstXORFECDecSourceBlock *source_block, guint line, guint missing_esi)
+{
+	GstBuffer *fec_repair_packet = source_block->repair_packets[line];
+	guint8 *symbol = xor_fec_dec->recovery_symbol;
+	gsize symbol_length;
+	guint i, esi, first_esi, esi_step, num_esis;
+	guint adu_flow, adu_length;
+	guint adu_flow_id = 0; /* XXX: Currently, only one flow (flow 0) is supported */
+	GstBuffer *adu;
+
+	symbol_length = gst_buffer_get_size(fec_repair_packet) - GST_XOR_FEC_PAYLOAD_ID_LENGTH;
+	if ((symbol_length < 3) || (symbol_length > MAX_ADUI_LENGTH))
+	{
+		GST_WARNING_OBJECT(xor_fec_dec, "FEC repair packet of source block #%u has invalid symbol length %" G_GSIZE_FORMAT " - cannot recover ADU with ESI %u", source_block->block_nr, symbol_length, missing_esi);
+		return NULL;
+	}
+
+	gst_buffer_extract(fec_repair_packet, GST_XOR_FEC_PAYLOAD_ID_LENGTH, symbol, symbol_length);
+
+	if (line < xor_fec_dec->num_rows)
+	{
+		first_esi = line * xor_fec_dec->num_columns;
+		esi_step = 1;
+		num_esis = xor_fec_dec->num_columns;
+	}
+	else
+	{
+		first_esi = line - xor_fec_dec->num_rows;
+		esi_step = xor_fec_dec->num_columns;
+		num_esis = xor_fec_dec->num_rows;
+	}
+
+	/* XOR all other ADUIs of the row or column into the repair
+	 * symbol; what remains is the missing ADUI */
+	for (i = 0, esi = first_esi; i < num_esis; ++i, esi += esi_step)
+	{
+		GstMapInfo map_info;
+		guint8 adui_header[3];
+
+		if (esi == missing_esi)
+			continue;
+
+		gst_buffer_map(source_block->adus[esi], &map_info, GST_MAP_READ);
+
+		if ((3 + map_info.size) > symbol_length)
+		{
+			GST_WARNING_OBJECT(xor_fec_dec, "ADU with ESI %u is larger than the repair symbol of source block #%u - cannot recover ADU with ESI %u", esi, source_block->block_nr, missing_esi);
+			gst_buffer_unmap(source_block->adus[esi], &map_info);
+			return NULL;
+		}
+
+		adui_header[0] = adu_flow_id;
+		adui_header[1] = (map_info.size & 0xFF00) >> 8;
+		adui_header[2] = (map_info.size & 0x00FF);
+
+		gst_fec_xor_region(symbol, adui_header, 3);
+		gst_fec_xor_region(symbol + 3, map_info.data, map_info.size);
+
+		gst_buffer_unmap(source_block->adus[esi], &map_info);
+	}
+
+	/* Extract flow ID and ADU length (16-bit big endian unsigned integer) */
+	adu_flow = symbol[0];
+	adu_length = (((guint)(symbol[1])) << 8) | ((guint)(symbol[2]));
+
+	if (adu_flow != adu_flow_id)
+	{
+		GST_ELEMENT_WARNING(xor_fec_dec, STREAM, DECODE, ("multiple ADU flows are currently not supported"), ("recovered ADU has flow ID %u", adu_flow));
+		return NULL;
+	}
+
+	if ((3 + adu_length) > symbol_length)
+	{
+		GST_WARNING_OBJECT(xor_fec_dec, "recovered ADU with ESI %u has invalid length %u (symbol length: %" G_GSIZE_FORMAT ") - discarding", missing_esi, adu_length, symbol_length);
+		return NULL;
+	}
+
+	/* Copy the ADU bytes, which are located right after the 3 initial
+	 * bytes (the ADU flow and ADU length). The recovery_symbol memory
+	 * block is reused later, so it cannot be wrapped. */
+	adu = gst_buffer_new_allocate(NULL, adu_length, NULL);
+	gst_buffer_fill(adu, 0, symbol + 3, adu_length);
+
+	return adu;
+}
+
+
+static gboolean gst_xor_fec_dec_is_source_block_nr_newer(guint candidate_block_nr, guint reference_block_nr)
+{
+	/* Like in rsfecdec, a quarter of the source block number
+	 * range after the reference is considered "newer" */
+	guint distance = (candidate_block_nr - reference_block_nr) & BLOCK_NR_MASK;
+	return (distance >= 1) && (distance < ((BLOCK_NR_MASK + 1) >> 2));
+}
+
+
+static gboolean gst_xor_fec_dec_is_source_block_nr_recent_enough(guint candidate_block_nr, guint reference_block_nr, guint max_age)
+{
+	guint age = (reference_block_nr - candidate_block_nr) & BLOCK_NR_MASK;
+	return (age < max_age) || gst_xor_fec_dec_is_source_block_nr_newer(candidate_block_nr, reference_block_nr);
+}
+
+
+static void gst_xor_fec_dec_prune_source_block_table(GstXORFECDec *xor_fec_dec, guint source_block_nr)
+{
+	gpointer value;
+	GHashTableIter iter;
+
+	if (xor_fec_dec->first_pruning)
+	{
+		xor_fec_dec->most_recent_block_nr = source_block_nr;
+		xor_fec_dec->first_pruning = FALSE;
+		return;
+	}
+
+	if (!gst_xor_fec_dec_is_source_block_nr_newer(source_block_nr, xor_fec_dec->most_recent_block_nr))
+		return;
+
+	xor_fec_dec->most_recent_block_nr = source_block_nr;
+
+	/* Discard source blocks that are too old. Their ADUs were already
+	 * pushed, and any ADUs that are still missing cannot be recovered
+	 * anymore, since any recovery is done as soon as possible. */
+	g_hash_table_iter_init(&iter, xor_fec_dec->source_block_table);
+	while (g_hash_table_iter_next(&iter, NULL, &value))
+	{
+		GstXORFECDecSourceBlock *source_block = (GstXORFECDecSourceBlock *)value;
+		if (!gst_xor_fec_dec_is_source_block_nr_recent_enough(source_block->block_nr, xor_fec_dec->most_recent_block_nr, xor_fec_dec->max_source_block_age))
+		{
+			GST_LOG_OBJECT(xor_fec_dec, "discarding source block #%u  (%u of %u ADUs known)", source_block->block_nr, source_block->num_known_adus, xor_fec_dec->num_source_symbols);
+			gst_xor_fec_dec_destroy_source_block(xor_fec_dec, source_block);
+			g_hash_table_iter_remove(&iter);
+		}
+	}
+}
+
+
+static void gst_xor_fec_dec_reset_states(GstXORFECDec *xor_fec_dec)
+{
+	xor_fec_dec->first_pruning = TRUE;
+	xor_fec_dec->segment_started = FALSE;
+	xor_fec_dec->fecsource_eos = FALSE;
+	xor_fec_dec->fecrepair_eos = FALSE;
+	xor_fec_dec->fecrowrepair_eos = FALSE;
+}
+
+
+static void gst_xor_fec_dec_flush(GstXORFECDec *xor_fec_dec)
+{
+	GHashTableIter iter;
+	gpointer value;
+
+	/* Cleanup any leftover source blocks */
+	g_hash_table_iter_init(&iter, xor_fec_dec->source_block_table);
+	while (g_hash_table_iter_next(&iter, NULL, &value))
+	{
+		GstXORFECDecSourceBlock *source_block = (GstXORFECDecSourceBlock *)value;
+		gst_xor_fec_dec_destroy_source_block(xor_fec_dec, source_block);
+		g_hash_table_iter_remove(&iter);
+	}
+
+	gst_xor_fec_dec_reset_states(xor_fec_dec);
+}
+
+
+static GstFlowReturn gst_xor_fec_dec_push_adu(GstXORFECDec *xor_fec_dec, GstBuffer *adu)
+{
+	/* Send stream-start and segment events if necessary */
+	gst_xor_fec_dec_push_stream_start(xor_fec_dec);
+	gst_xor_fec_dec_push_segment(xor_fec_dec);
+
+	if (xor_fec_dec->do_timestamp)
+	{
+		/* Fetch clock and base time, to be able to set buffer timestamps */
+		GstClock *clock = GST_ELEMENT_CLOCK(xor_fec_dec);
+		GstClockTime base_time = GST_ELEMENT_CAST(xor_fec_dec)->base_time;
+
+		/* Set the buffer PTS and DTS to the current running time */
+		if (clock != NULL)
+		{
+			GstClockTime ts;
+			GstClockTime now = gst_clock_get_time(clock);
+			ts = now - base_time;
+			GST_BUFFER_PTS(adu) = ts;
+			GST_BUFFER_DTS(adu) = ts;
+		}
+	}
+
+	return gst_pad_push(xor_fec_dec->srcpad, adu);
+}
+
+
+static void gst_xor_fec_dec_push_stream_start(GstXORFECDec *xor_fec_dec)
+{
+	GstEvent *event;
+	gchar stream_id[32];
+
+	/* Catch redundant calls */
+	if (xor_fec_dec->stream_started)
+		return;
+
+	g_snprintf(stream_id, sizeof(stream_id), "xorfecdec-%08x", g_random_int());
+	GST_DEBUG_OBJECT(xor_fec_dec, "sending out stream-start event with ID %s", stream_id);
+
+	event = gst_event_new_stream_start(stream_id);
+	gst_pad_push_event(xor_fec_dec->srcpad, event);
+
+	xor_fec_dec->stream_started = TRUE;
+}
+
+
+static void gst_xor_fec_dec_push_segment(GstXORFECDec *xor_fec_dec)
+{
+	GstEvent *event;
+	GstSegment segment;
+
+	/* Catch redundant calls */
+	if (xor_fec_dec->segment_started)
+		return;
+
+	gst_segment_init(&segment, GST_FORMAT_TIME);
+
+	GST_DEBUG_OBJECT(xor_fec_dec, "sending out segment event");
+
+	event = gst_event_new_segment(&segment);
+	gst_pad_push_event(xor_fec_dec->srcpad, event);
+
+	xor_fec_dec->segment_started = TRUE;
+}
+
+
+static void gst_xor_fec_dec_push_eos(GstXORFECDec *xor_fec_dec)
+{
+	/* Only push EOS downstream if all linked sinkpads received EOS.
+	 * For example, if the fecsource sinkpad gets EOS, it may still
+	 * be possible for the repair sinkpads to receive repair symbols
+	 * that recover some ADUs. The fecrowrepair sinkpad is only used
+	 * if the encoder sends row repair packets separately. */
+	if (xor_fec_dec->fecsource_eos && xor_fec_dec->fecrepair_eos && (xor_fec_dec->fecrowrepair_eos || !gst_pad_is_linked(xor_fec_dec->fecrowrepairpad)))
+	{
+		GST_DEBUG_OBJECT(xor_fec_dec, "all sinkpads received EOS -> pushing EOS downstream");
+
+		/* Send stream-start and segment events if necessary */
+		gst_xor_fec_dec_push_stream_start(xor_fec_dec);
+		gst_xor_fec_dec_push_segment(xor_fec_dec);
+
+		gst_pad_push_event(xor_fec_dec->srcpad, gst_event_new_eos());
+	}
+}
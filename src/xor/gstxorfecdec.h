@@ -0,0 +1,123 @@
+/* SMPTE 2022-1 style row/column XOR forward error correction for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef GSTFECFRAME_XOR_XORFECDEC_H
+#define GSTFECFRAME_XOR_XORFECDEC_H
+
+#include <gst/gst.h>
+
+
+G_BEGIN_DECLS
+
+
+typedef struct _GstXORFECDec GstXORFECDec;
+typedef struct _GstXORFECDecClass GstXORFECDecClass;
+typedef struct _GstXORFECDecSourceBlock GstXORFECDecSourceBlock;
+
+
+#define GST_TYPE_XOR_FEC_DEC             (gst_xor_fec_dec_get_type())
+#define GST_XOR_FEC_DEC(obj)             (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_XOR_FEC_DEC, GstXORFECDec))
+#define GST_XOR_FEC_DEC_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST((klass), GST_TYPE_XOR_FEC_DEC, GstXORFECDecClass))
+#define GST_XOR_FEC_DEC_CAST(obj)        ((GstXORFECDec *)(obj))
+#define GST_IS_XOR_FEC_DEC(obj)          (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_XOR_FEC_DEC))
+#define GST_IS_XOR_FEC_DEC_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass), GST_TYPE_XOR_FEC_DEC))
+
+
+struct _GstXORFECDecSourceBlock
+{
+	/* Number of this source block */
+	guint block_nr;
+
+	/* Table with num_source_symbols entries, containing the received
+	 * and recovered ADUs. The array index equals the ESI. Entries of
+	 * missing ADUs are NULL. */
+	GstBuffer **adus;
+	guint num_known_adus;
+
+	/* Table with num_rows + num_columns entries, containing the
+	 * received FEC repair packets. Rows come first, so the array
+	 * index equals (ESI - num_source_symbols). A repair packet is
+	 * released once all ADUs of its row or column are known. */
+	GstBuffer **repair_packets;
+	/* Number of missing ADUs in each row and column. Uses
+	 * the same indices as repair_packets. */
+	guint *num_missing_adus;
+};
+
+
+struct _GstXORFECDec
+{
+	GstElement parent;
+
+	/* Sink- and source pads.
+	 * NOTE: fecsourcepad is a sinkpad! "fecsource" refers to
+	 * "FEC source packets", not to a sourcepad"
+	 * Row and column repair packets can arrive over both repair
+	 * sinkpads, since they are identified by their ESIs. */
+	GstPad *srcpad, *fecsourcepad, *fecrepairpad, *fecrowrepairpad;
+
+	/* Matrix dimensions (L and D), configured via properties.
+	 * These must match the ones of the encoder, and may only be
+	 * modified if the decoder is not running (that is, if
+	 * recovery_symbol == NULL). */
+	guint num_columns, num_rows;
+	/* Number of source symbols per source block (L*D) */
+	guint num_source_symbols;
+
+	/* Same meaning as the fields with the same name in GstRSFECDec.
+	 * Received and recovered ADUs are always pushed downstream as
+	 * soon as possible (there is no sorting). */
+	guint max_source_block_age;
+	gboolean do_timestamp;
+
+	/* Memory block where lost ADUIs are recovered. It is large enough
+	 * for the largest possible ADUI, and allocated at the NULL->READY
+	 * state change. */
+	guint8 *recovery_symbol;
+
+	/* Hash table containing the source blocks, with the source block
+	 * numbers as keys. Source blocks remain in here until they are
+	 * too old, even if all of their ADUs are known, to be able to
+	 * detect duplicate and late FEC packets. */
+	GHashTable *source_block_table;
+	/* Same meaning as the fields with the same name in GstRSFECDec */
+	gboolean first_pruning;
+	guint most_recent_block_nr;
+
+	/* Same meaning as the fields with the same name in GstRSFECDec */
+	GMutex mutex;
+	gboolean segment_started;
+	gboolean stream_started;
+	gboolean fecsource_eos, fecrepair_eos, fecrowrepair_eos;
+};
+
+
+struct _GstXORFECDecClass
+{
+	GstElementClass parent_class;
+};
+
+
+GType gst_xor_fec_dec_get_type(void);
+
+
+G_END_DECLS
+
+
+#endif
@@ -0,0 +1,820 @@
+/* SMPTE 2022-1 style row/column XOR forward error correction for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/**
+ * GstXORFECEnc is an encoder element that implements row/column XOR parity
+ * FEC, similar to the two-dimensional FEC of SMPTE 2022-1.
+ *
+ * The ADUs are arranged in a matrix with L columns ("columns" property) and
+ * D rows ("rows" property), in row-major order. Each row and each column gets
+ * one repair symbol, which is the XOR of the ADUIs in that row or column (see
+ * gstxorfeccommon.h). A single lost ADU in a row or column can be recovered
+ * with the corresponding repair symbol. Column repair symbols protect against
+ * burst losses of up to L consecutive ADUs; row repair symbols additionally
+ * allow for recovering ADUs whose column has more than one loss. The decoder
+ * alternates between rows and columns, so many loss patterns can be
+ * recovered even if both contain more than one loss.
+ *
+ * XOR is much cheaper than Reed-Solomon. Each ADU is XORed into the repair
+ * symbols of its row and its column right when it comes in, and the ADU
+ * itself is not retained. This makes the encoding costs comparable to a
+ * memcpy() of the input data, which is useful for very high data rates.
+ * The overhead is (L+D)/(L*D), or 1/D if row repair symbols are disabled.
+ *
+ * Just like rsfecenc, each incoming ADU is immediately pushed downstream as
+ * a FEC source packet to the fecsource pad. The repair symbol of a row is
+ * sent as soon as the row is complete, the repair symbols of the columns
+ * once the entire matrix is complete. Column repair packets are pushed to
+ * the fecrepair pad. Row repair packets are pushed to the same pad, unless
+ * "separate-repair-pads" is set to TRUE, in which case they are pushed to
+ * the fecrowrepair pad, so they can be sent over a separate transport
+ * (for example, SMPTE 2022-1 uses separate ports for row and column FEC).
+ *
+ * NOTE: The packet format is not compatible with SMPTE 2022-1, which uses RTP
+ * based FEC headers. Here, the same ADUI framing as in RFC 6865 is used, and
+ * a 4-byte FEC payload ID (see gstxorfeccommon.h).
+ *
+ * If a source block is incomplete when EOS is reached, no repair symbols
+ * are sent for its incomplete rows and columns.
+ */
+
+
+#include <string.h>
+#include "common/gstgf256.h"
+#include "gstxorfeccommon.h"
+#include "gstxorfecenc.h"
+
+
+GST_DEBUG_CATEGORY(xor_fec_enc_debug);
+#define GST_CAT_DEFAULT xor_fec_enc_debug
+
+
+enum
+{
+	PROP_0,
+	PROP_COLUMNS,
+	PROP_ROWS,
+	PROP_ROW_REPAIR,
+	PROP_SEPARATE_REPAIR_PADS
+};
+
+
+#define DEFAULT_ROW_REPAIR TRUE
+#define DEFAULT_SEPARATE_REPAIR_PADS FALSE
+
+
+#define FEC_SOURCE_CAPS_STR "application/x-fec-source-flow, fec-scheme = (string) xor-row-column"
+#define FEC_REPAIR_CAPS_STR "application/x-fec-repair-flow, fec-scheme = (string) xor-row-column"
+
+
+static GstStaticPadTemplate static_sink_template = GST_STATIC_PAD_TEMPLATE(
+	"sink",
+	GST_PAD_SINK,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS_ANY
+);
+
+
+static GstStaticPadTemplate static_fecsource_template = GST_STATIC_PAD_TEMPLATE(
+	"fecsource",
+	GST_PAD_SRC,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS(FEC_SOURCE_CAPS_STR)
+);
+
+
+static GstStaticPadTemplate static_fecrepair_template = GST_STATIC_PAD_TEMPLATE(
+	"fecrepair",
+	GST_PAD_SRC,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS(FEC_REPAIR_CAPS_STR)
+);
+
+
+static GstStaticPadTemplate static_fecrowrepair_template = GST_STATIC_PAD_TEMPLATE(
+	"fecrowrepair",
+	GST_PAD_SRC,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS(FEC_REPAIR_CAPS_STR)
+);
+
+
+
+
+G_DEFINE_TYPE(GstXORFECEnc, gst_xor_fec_enc, GST_TYPE_ELEMENT)
+
+
+
+
+static void gst_xor_fec_enc_set_property(GObject *object, guint prop_id, GValue const *value, GParamSpec *pspec);
+static void gst_xor_fec_enc_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec);
+
+static GstStateChangeReturn gst_xor_fec_enc_change_state(GstElement *element, GstStateChange transition);
+
+static gboolean gst_xor_fec_enc_sink_event(GstPad *pad, GstObject *parent, GstEvent *event);
+static GstFlowReturn gst_xor_fec_enc_sink_chain(GstPad *pad, GstObject *parent, GstBuffer *buffer);
+
+static void gst_xor_fec_enc_alloc_accumulators(GstXORFECEnc *xor_fec_enc);
+static void gst_xor_fec_enc_free_accumulators(GstXORFECEnc *xor_fec_enc);
+static void gst_xor_fec_enc_accumulate(GstXORFECEncAccumulator *accumulator, guint8 const *adui_header, guint8 const *adu, gsize adu_length);
+
+static GstFlowReturn gst_xor_fec_enc_push_adu(GstXORFECEnc *xor_fec_enc, GstBuffer *adu, guint esi);
+static GstFlowReturn gst_xor_fec_enc_push_repair_symbol(GstXORFECEnc *xor_fec_enc, GstXORFECEncAccumulator *accumulator, guint esi, gboolean is_row);
+static void gst_xor_fec_enc_push_events(GstXORFECEnc *xor_fec_enc);
+static void gst_xor_fec_enc_free_payload_id(gpointer data);
+
+static void gst_xor_fec_enc_reset_states(GstXORFECEnc *xor_fec_enc);
+static void gst_xor_fec_enc_flush(GstXORFECEnc *xor_fec_enc);
+static void gst_xor_fec_enc_discard_source_block(GstXORFECEnc *xor_fec_enc);
+
+
+
+
+static void gst_xor_fec_enc_class_init(GstXORFECEncClass *klass)
+{
+	GObjectClass *object_class;
+	GstElementClass *element_class;
+
+	GST_DEBUG_CATEGORY_INIT(xor_fec_enc_debug, "xorfecenc", 0, "row/column XOR FEC encoder");
+
+	object_class = G_OBJECT_CLASS(klass);
+	element_class = GST_ELEMENT_CLASS(klass);
+
+	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_sink_template));
+	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_fecsource_template));
+	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_fecrepair_template));
+	gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&static_fecrowrepair_template));
+
+	object_class->set_property  = GST_DEBUG_FUNCPTR(gst_xor_fec_enc_set_property);
+	object_class->get_property  = GST_DEBUG_FUNCPTR(gst_xor_fec_enc_get_property);
+
+	element_class->change_state = GST_DEBUG_FUNCPTR(gst_xor_fec_enc_change_state);
+
+	g_object_class_install_property(
+		object_class,
+		PROP_COLUMNS,
+		g_param_spec_uint(
+			"columns",
+			"Columns",
+			"Number of columns (L) in the source block matrix",
+			1, GST_XOR_FEC_MAX_COLUMNS,
+			GST_XOR_FEC_DEFAULT_COLUMNS,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_ROWS,
+		g_param_spec_uint(
+			"rows",
+			"Rows",
+			"Number of rows (D) in the source block matrix",
+			1, GST_XOR_FEC_MAX_ROWS,
+			GST_XOR_FEC_DEFAULT_ROWS,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_ROW_REPAIR,
+		g_param_spec_boolean(
+			"row-repair",
+			"Row repair",
+			"Generate row repair symbols in addition to the column repair symbols",
+			DEFAULT_ROW_REPAIR,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+	g_object_class_install_property(
+		object_class,
+		PROP_SEPARATE_REPAIR_PADS,
+		g_param_spec_boolean(
+			"separate-repair-pads",
+			"Separate repair pads",
+			"Push row repair packets to the fecrowrepair pad instead of the fecrepair pad",
+			DEFAULT_SEPARATE_REPAIR_PADS,
+			G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS
+		)
+	);
+
+	gst_element_class_set_static_metadata(
+		element_class,
+		"Row/column XOR forward error correction encoder",
+		"Codec/Encoder/Network",
+		"Produces forward-error erasure coding based on row and column XOR parity (similar to SMPTE 2022-1)",
+		"Carlos Rafael Giani <dv@pseudoterminal.org>"
+	);
+}
+
+
+static void gst_xor_fec_enc_init(GstXORFECEnc *xor_fec_enc)
+{
+	xor_fec_enc->num_columns = GST_XOR_FEC_DEFAULT_COLUMNS;
+	xor_fec_enc->num_rows = GST_XOR_FEC_DEFAULT_ROWS;
+	xor_fec_enc->num_source_symbols = xor_fec_enc->num_columns * xor_fec_enc->num_rows;
+	xor_fec_enc->row_repair = DEFAULT_ROW_REPAIR;
+	xor_fec_enc->separate_repair_pads = DEFAULT_SEPARATE_REPAIR_PADS;
+
+	memset(&(xor_fec_enc->row_accumulator), 0, sizeof(GstXORFECEncAccumulator));
+	xor_fec_enc->column_accumulators = NULL;
+
+	xor_fec_enc->cur_source_block_nr = 0;
+	xor_fec_enc->cur_esi = 0;
+
+	xor_fec_enc->first_source_packet = TRUE;
+	xor_fec_enc->first_repair_packet = TRUE;
+	xor_fec_enc->first_row_repair_packet = TRUE;
+	xor_fec_enc->segment_started = FALSE;
+	xor_fec_enc->stream_started = FALSE;
+	xor_fec_enc->eos_received = FALSE;
+
+	xor_fec_enc->sinkpad = gst_ghost_pad_new_no_target_from_template(
+		"sink",
+		gst_element_class_get_pad_template(GST_ELEMENT_GET_CLASS(xor_fec_enc), "sink")
+	);
+	gst_element_add_pad(GST_ELEMENT(xor_fec_enc), xor_fec_enc->sinkpad);
+
+	xor_fec_enc->fecsourcepad = gst_ghost_pad_new_no_target_from_template(
+		"fecsource",
+		gst_element_class_get_pad_template(GST_ELEMENT_GET_CLASS(xor_fec_enc), "fecsource")
+	);
+	gst_element_add_pad(GST_ELEMENT(xor_fec_enc), xor_fec_enc->fecsourcepad);
+
+	xor_fec_enc->fecrepairpad = gst_ghost_pad_new_no_target_from_template(
+		"fecrepair",
+		gst_element_class_get_pad_template(GST_ELEMENT_GET_CLASS(xor_fec_enc), "fecrepair")
+	);
+	gst_element_add_pad(GST_ELEMENT(xor_fec_enc), xor_fec_enc->fecrepairpad);
+
+	xor_fec_enc->fecrowrepairpad = gst_ghost_pad_new_no_target_from_template(
+		"fecrowrepair",
+		gst_element_class_get_pad_template(GST_ELEMENT_GET_CLASS(xor_fec_enc), "fecrowrepair")
+	);
+	gst_element_add_pad(GST_ELEMENT(xor_fec_enc), xor_fec_enc->fecrowrepairpad);
+
+	gst_pad_set_event_function(xor_fec_enc->sinkpad, GST_DEBUG_FUNCPTR(gst_xor_fec_enc_sink_event));
+	gst_pad_set_chain_function(xor_fec_enc->sinkpad, GST_DEBUG_FUNCPTR(gst_xor_fec_enc_sink_chain));
+}
+
+
+static void gst_xor_fec_enc_set_property(GObject *object, guint prop_id, GValue const *value, GParamSpec *pspec)
+{
+	GstXORFECEnc *xor_fec_enc = GST_XOR_FEC_ENC(object);
+
+	switch (prop_id)
+	{
+		case PROP_COLUMNS:
+			GST_OBJECT_LOCK(object);
+			if (xor_fec_enc->column_accumulators == NULL)
+			{
+				xor_fec_enc->num_columns = g_value_get_uint(value);
+				xor_fec_enc->num_source_symbols = xor_fec_enc->num_columns * xor_fec_enc->num_rows;
+			}
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set number of columns after the encoder was initialized"), (NULL));
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_ROWS:
+			GST_OBJECT_LOCK(object);
+			if (xor_fec_enc->column_accumulators == NULL)
+			{
+				xor_fec_enc->num_rows = g_value_get_uint(value);
+				xor_fec_enc->num_source_symbols = xor_fec_enc->num_columns * xor_fec_enc->num_rows;
+			}
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot set number of rows after the encoder was initialized"), (NULL));
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_ROW_REPAIR:
+			GST_OBJECT_LOCK(object);
+			if (xor_fec_enc->column_accumulators == NULL)
+				xor_fec_enc->row_repair = g_value_get_boolean(value);
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot enable/disable row repair after the encoder was initialized"), (NULL));
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_SEPARATE_REPAIR_PADS:
+			GST_OBJECT_LOCK(object);
+			if (xor_fec_enc->column_accumulators == NULL)
+				xor_fec_enc->separate_repair_pads = g_value_get_boolean(value);
+			else
+				GST_ELEMENT_WARNING(object, LIBRARY, SETTINGS, ("cannot change repair pad assignment after the encoder was initialized"), (NULL));
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+			break;
+	}
+}
+
+
+static void gst_xor_fec_enc_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec)
+{
+	GstXORFECEnc *xor_fec_enc = GST_XOR_FEC_ENC(object);
+
+	switch (prop_id)
+	{
+		case PROP_COLUMNS:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, xor_fec_enc->num_columns);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_ROWS:
+			GST_OBJECT_LOCK(object);
+			g_value_set_uint(value, xor_fec_enc->num_rows);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_ROW_REPAIR:
+			GST_OBJECT_LOCK(object);
+			g_value_set_boolean(value, xor_fec_enc->row_repair);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		case PROP_SEPARATE_REPAIR_PADS:
+			GST_OBJECT_LOCK(object);
+			g_value_set_boolean(value, xor_fec_enc->separate_repair_pads);
+			GST_OBJECT_UNLOCK(object);
+			break;
+
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+			break;
+	}
+}
+
+
+static GstStateChangeReturn gst_xor_fec_enc_change_state(GstElement *element, GstStateChange transition)
+{
+	GstXORFECEnc *xor_fec_enc = GST_XOR_FEC_ENC(element);
+	GstStateChangeReturn result;
+
+	switch (transition)
+	{
+		case GST_STATE_CHANGE_NULL_TO_READY:
+			gst_xor_fec_enc_alloc_accumulators(xor_fec_enc);
+			break;
+
+		case GST_STATE_CHANGE_READY_TO_PAUSED:
+			/* Make sure states are at their initial value */
+			gst_xor_fec_enc_reset_states(xor_fec_enc);
+			break;
+
+		default:
+			break;
+	}
+
+	if ((result = GST_ELEMENT_CLASS(gst_xor_fec_enc_parent_class)->change_state(element, transition)) == GST_STATE_CHANGE_FAILURE)
+		return result;
+
+	switch (transition)
+	{
+		case GST_STATE_CHANGE_PAUSED_TO_READY:
+			/* Make sure the partial source block is discarded
+			 * and states are reset properly */
+			gst_xor_fec_enc_flush(xor_fec_enc);
+			/* Stream is done after switching to READY */
+			xor_fec_enc->stream_started = FALSE;
+			break;
+
+		case GST_STATE_CHANGE_READY_TO_NULL:
+			gst_xor_fec_enc_free_accumulators(xor_fec_enc);
+			break;
+
+		default:
+			break;
+	}
+
+	return result;
+}
+
+
+static gboolean gst_xor_fec_enc_sink_event(GstPad *pad, GstObject *parent, GstEvent *event)
+{
+	GstXORFECEnc *xor_fec_enc = GST_XOR_FEC_ENC(parent);
+
+	switch (GST_EVENT_TYPE(event))
+	{
+		case GST_EVENT_STREAM_START:
+			/* Throw away incoming STREAM_START events
+			 * this encoder generates its own STREAM_START events */
+			gst_event_unref(event);
+			return TRUE;
+
+		case GST_EVENT_CAPS:
+			/* Throw away incoming caps
+			 * this encoder generates its own CAPS events */
+			gst_event_unref(event);
+			return TRUE;
+
+		case GST_EVENT_SEGMENT:
+			/* Throw away incoming segments
+			 * this encoder generates its own SEGMENT events */
+			gst_event_unref(event);
+			return TRUE;
+
+		case GST_EVENT_FLUSH_STOP:
+			/* Make sure the partial source block is discarded
+			 * and states are reset properly */
+			gst_xor_fec_enc_flush(xor_fec_enc);
+			break;
+
+		case GST_EVENT_EOS:
+		{
+			GST_DEBUG_OBJECT(xor_fec_enc, "EOS received");
+
+			/* Set the eos_received flag to let the chain function know we are done
+			 * receiving data, and forward the EOS event to all sourcepads */
+			xor_fec_enc->eos_received = TRUE;
+
+			/* Ref the event, since it is pushed downstream three times here
+			 * (once for each sourcepad) */
+			gst_event_ref(event);
+			gst_event_ref(event);
+			gst_pad_push_event(xor_fec_enc->fecsourcepad, event);
+			gst_pad_push_event(xor_fec_enc->fecrepairpad, event);
+			gst_pad_push_event(xor_fec_enc->fecrowrepairpad, event);
+
+			return TRUE;
+		}
+
+		default:
+			break;
+	}
+
+	return gst_pad_event_default(pad, parent, event);
+}
+
+
+static GstFlowReturn gst_xor_fec_enc_sink_chain(G_GNUC_UNUSED GstPad *pad, GstObject *parent, GstBuffer *buffer)
+{
+	GstXORFECEnc *xor_fec_enc = GST_XOR_FEC_ENC_CAST(parent);
+	GstFlowReturn ret = GST_FLOW_OK;
+	GstMapInfo map_info;
+	gsize bufsize;
+	guint esi, row, column;
+	guint8 adui_header[3];
+	guint adu_flow_id = 0; /* XXX: Currently, only one flow (flow 0) is supported */
+
+	if (xor_fec_enc->eos_received)
+	{
+		GST_DEBUG_OBJECT(xor_fec_enc, "received data after EOS was received - dropping buffer");
+		gst_buffer_unref(buffer);
+		return GST_FLOW_EOS;
+	}
+
+	/* The input buffer is the new ADU */
+
+	bufsize = gst_buffer_get_size(buffer);
+	if (bufsize > 65535)
+	{
+		GST_ELEMENT_ERROR(xor_fec_enc, STREAM, ENCODE, ("input buffer too large"), ("maximum is 65535 bytes, buffer size is %" G_GSIZE_FORMAT, bufsize));
+		gst_buffer_unref(buffer);
+		return GST_FLOW_ERROR;
+	}
+
+	esi = xor_fec_enc->cur_esi;
+	row = esi / xor_fec_enc->num_columns;
+	column = esi % xor_fec_enc->num_columns;
+
+	/* Copy the ADU, since the copy is modified (an FEC payload ID is
+	 * appended prior to sending). This does not copy the bytes. */
+	if ((ret = gst_xor_fec_enc_push_adu(xor_fec_enc, gst_buffer_copy(buffer), esi)) != GST_FLOW_OK)
+	{
+		gst_buffer_unref(buffer);
+		gst_xor_fec_enc_discard_source_block(xor_fec_enc);
+		return ret;
+	}
+
+	/* XOR the ADUI into the repair symbols of its row and column. The
+	 * ADUI header consists of the flow ID and the 16-bit big endian
+	 * ADU length, just like in rsfecenc. */
+	gst_buffer_map(buffer, &map_info, GST_MAP_READ);
+	adui_header[0] = adu_flow_id;
+	adui_header[1] = (map_info.size & 0xFF00) >> 8;
+	adui_header[2] = (map_info.size & 0x00FF);
+	if (xor_fec_enc->row_repair)
+		gst_xor_fec_enc_accumulate(&(xor_fec_enc->row_accumulator), adui_header, map_info.data, map_info.size);
+	gst_xor_fec_enc_accumulate(&(xor_fec_enc->column_accumulators[column]), adui_header, map_info.data, map_info.size);
+	gst_buffer_unmap(buffer, &map_info);
+	gst_buffer_unref(buffer);
+
+	xor_fec_enc->cur_esi++;
+
+	/* Row complete -> send its repair symbol right away */
+	if (xor_fec_enc->row_repair && (column == (xor_fec_enc->num_columns - 1)))
+	{
+		if ((ret = gst_xor_fec_enc_push_repair_symbol(xor_fec_enc, &(xor_fec_enc->row_accumulator), xor_fec_enc->num_source_symbols + row, TRUE)) != GST_FLOW_OK)
+		{
+			gst_xor_fec_enc_discard_source_block(xor_fec_enc);
+			return ret;
+		}
+	}
+
+	/* Matrix complete -> send the column repair symbols, and begin a new source block */
+	if (xor_fec_enc->cur_esi == xor_fec_enc->num_source_symbols)
+	{
+		for (column = 0; column < xor_fec_enc->num_columns; ++column)
+		{
+			if ((ret = gst_xor_fec_enc_push_repair_symbol(xor_fec_enc, &(xor_fec_enc->column_accumulators[column]), xor_fec_enc->num_source_symbols + xor_fec_enc->num_rows + column, FALSE)) != GST_FLOW_OK)
+				break;
+		}
+
+		/* This also empties the accumulators of the columns that were
+		 * not pushed if the loop above was aborted. Otherwise, their
+		 * contents would be mixed into the next source block. */
+		gst_xor_fec_enc_discard_source_block(xor_fec_enc);
+	}
+
+	return ret;
+}
+
+
+static void gst_xor_fec_enc_alloc_accumulators(GstXORFECEnc *xor_fec_enc)
+{
+	g_assert(xor_fec_enc->column_accumulators == NULL);
+
+	GST_DEBUG_OBJECT(xor_fec_enc, "allocating accumulators  (columns: %u rows: %u)", xor_fec_enc->num_columns, xor_fec_enc->num_rows);
+
+	/* The memory blocks of the accumulators are allocated
+	 * on demand, once the ADU sizes are known */
+	xor_fec_enc->column_accumulators = g_slice_alloc0(sizeof(GstXORFECEncAccumulator) * xor_fec_enc->num_columns);
+	memset(&(xor_fec_enc->row_accumulator), 0, sizeof(GstXORFECEncAccumulator));
+}
+
+
+static void gst_xor_fec_enc_free_accumulators(GstXORFECEnc *xor_fec_enc)
+{
+	guint i;
+
+	g_assert(xor_fec_enc->column_accumulators != NULL);
+
+	for (i = 0; i < xor_fec_enc->num_columns; ++i)
+		g_free(xor_fec_enc->column_accumulators[i].data);
+	g_free(xor_fec_enc->row_accumulator.data);
+
+	g_slice_free1(sizeof(GstXORFECEncAccumulator) * xor_fec_enc->num_columns, xor_fec_enc->column_accumulators);
+	xor_fec_enc->column_accumulators = NULL;
+	memset(&(xor_fec_enc->row_accumulator), 0, sizeof(GstXORFECEncAccumulator));
+}
+
+
+static void gst_xor_fec_enc_accumulate(GstXORFECEncAccumulator *accumulator, guint8 const *adui_header, guint8 const *adu, gsize adu_length)
+{
+	gsize adui_length = 3 + adu_length;
+
+	/* Extend the repair symbol if this ADUI is longer than the
+	 * previous ones. The extension is zero filled, which is the
+	 * same as zero padding all the shorter ADUIs. */
+	if (adui_length > accumulator->length)
+	{
+		if (adui_length > accumulator->capacity)
+		{
+			accumulator->data = g_realloc(accumulator->data, adui_length);
+			accumulator->capacity = adui_length;
+		}
+
+		memset(accumulator->data + accumulator->length, 0, adui_length - accumulator->length);
+		accumulator->length = adui_length;
+	}
+
+	gst_fec_xor_region(accumulator->data, adui_header, 3);
+	gst_fec_xor_region(accumulator->data + 3, adu, adu_length);
+}
+
+
+static GstFlowReturn gst_xor_fec_enc_push_adu(GstXORFECEnc *xor_fec_enc, GstBuffer *adu, guint esi)
+{
+	GstBuffer *fec_source_packet;
+	GstMemory *wrapped_payload_id;
+	GstFlowReturn ret;
+	guint8 *fec_payload_id = g_slice_alloc(GST_XOR_FEC_PAYLOAD_ID_LENGTH);
+
+	gst_xor_fec_write_payload_id(fec_payload_id, xor_fec_enc->cur_source_block_nr, esi);
+
+	GST_LOG_OBJECT(xor_fec_enc, "pushing ADU with ESI %u as FEC source packet downstream  (source block: #%u)", esi, xor_fec_enc->cur_source_block_nr);
+
+	/* Create FEC source packet out of the ADU by appending the payload ID */
+	fec_source_packet = adu;
+	wrapped_payload_id = gst_memory_new_wrapped(
+		0,
+		fec_payload_id,
+		GST_XOR_FEC_PAYLOAD_ID_LENGTH,
+		0,
+		GST_XOR_FEC_PAYLOAD_ID_LENGTH,
+		fec_payload_id,
+		gst_xor_fec_enc_free_payload_id
+	);
+	gst_buffer_append_memory(fec_source_packet, wrapped_payload_id);
+
+	/* Clear timestamp and duration, since they are
+	 * useless with FEC source packets */
+	GST_BUFFER_PTS(fec_source_packet) = GST_CLOCK_TIME_NONE;
+	GST_BUFFER_DTS(fec_source_packet) = GST_CLOCK_TIME_NONE;
+	GST_BUFFER_DURATION(fec_source_packet) = GST_CLOCK_TIME_NONE;
+
+	/* Mark discontinuity at start */
+	if (xor_fec_enc->first_source_packet)
+	{
+		GST_BUFFER_FLAG_SET(fec_source_packet, GST_BUFFER_FLAG_DISCONT);
+		xor_fec_enc->first_source_packet = FALSE;
+	}
+
+	/* offset and offset_end have no meaning here */
+	GST_BUFFER_OFFSET(fec_source_packet) = -1;
+	GST_BUFFER_OFFSET_END(fec_source_packet) = -1;
+
+	/* Push STREAM_START, CAPS, SEGMENT events if necessary */
+	gst_xor_fec_enc_push_events(xor_fec_enc);
+
+	/* Send out the FEC source packet */
+	ret = gst_pad_push(xor_fec_enc->fecsourcepad, fec_source_packet);
+
+	if (ret != GST_FLOW_OK)
+		GST_DEBUG_OBJECT(xor_fec_enc, "got return value %s while pushing", gst_flow_get_name(ret));
+
+	return ret;
+}
+
+
+static GstFlowReturn gst_xor_fec_enc_push_repair_symbol(GstXORFECEnc *xor_fec_enc, GstXORFECEncAccumulator *accumulator, guint esi, gboolean is_row)
+{
+	GstBuffer *fec_repair_packet;
+	GstMapInfo map_info;
+	GstPad *pad;
+	gboolean *first_packet;
+	GstFlowReturn ret;
+
+	if (is_row && xor_fec_enc->separate_repair_pads)
+	{
+		pad = xor_fec_enc->fecrowrepairpad;
+		first_packet = &(xor_fec_enc->first_row_repair_packet);
+	}
+	else
+	{
+		pad = xor_fec_enc->fecrepairpad;
+		first_packet = &(xor_fec_enc->first_repair_packet);
+	}
+
+	fec_repair_packet = gst_buffer_new_allocate(NULL, GST_XOR_FEC_PAYLOAD_ID_LENGTH + accumulator->length, NULL);
+	gst_buffer_map(fec_repair_packet, &map_info, GST_MAP_WRITE);
+	gst_xor_fec_write_payload_id(map_info.data, xor_fec_enc->cur_source_block_nr, esi);
+	memcpy(map_info.data + GST_XOR_FEC_PAYLOAD_ID_LENGTH, accumulator->data, accumulator->length);
+	gst_buffer_unmap(fec_repair_packet, &map_info);
+
+	/* The accumulator is empty again; its memory block is retained */
+	accumulator->length = 0;
+
+	/* Mark discontinuity at start */
+	if (*first_packet)
+	{
+		GST_BUFFER_FLAG_SET(fec_repair_packet, GST_BUFFER_FLAG_DISCONT);
+		*first_packet = FALSE;
+	}
+
+	GST_LOG_OBJECT(xor_fec_enc, "pushing %s repair symbol with ESI %u  (source block: #%u)", is_row ? "row" : "column", esi, xor_fec_enc->cur_source_block_nr);
+
+	gst_xor_fec_enc_push_events(xor_fec_enc);
+
+	if ((ret = gst_pad_push(pad, fec_repair_packet)) != GST_FLOW_OK)
+		GST_DEBUG_OBJECT(xor_fec_enc, "got return value %s while pushing", gst_flow_get_name(ret));
+
+	return ret;
+}
+
+
+static void gst_xor_fec_enc_push_events(GstXORFECEnc *xor_fec_enc)
+{
+	GstEvent *event;
+	GstSegment segment;
+	gchar *stream_id;
+	guint group_id;
+	GstPad *pads[3];
+	gchar const *pad_names[3] = { "fecsource", "fecrepair", "fecrowrepair" };
+	guint i;
+
+	if (xor_fec_enc->segment_started)
+		return;
+
+	pads[0] = xor_fec_enc->fecsourcepad;
+	pads[1] = xor_fec_enc->fecrepairpad;
+	pads[2] = xor_fec_enc->fecrowrepairpad;
+
+	group_id = gst_util_group_id_next();
+	gst_segment_init(&segment, GST_FORMAT_BYTES);
+
+	if (xor_fec_enc->stream_started)
+		GST_DEBUG_OBJECT(xor_fec_enc, "pushing SEGMENT and CAPS events downstream");
+	else
+		GST_DEBUG_OBJECT(xor_fec_enc, "pushing STREAM_START, SEGMENT, and CAPS events downstream (stream-start group id: %u)", group_id);
+
+	/* push stream start, caps, segment events for all pads */
+	for (i = 0; i < 3; ++i)
+	{
+		if (!xor_fec_enc->stream_started)
+		{
+			GstCaps *caps;
+
+			/* stream start */
+			stream_id = gst_pad_create_stream_id(pads[i], GST_ELEMENT_CAST(xor_fec_enc), pad_names[i]);
+			event = gst_event_new_stream_start(stream_id);
+			gst_event_set_group_id(event, group_id);
+			gst_pad_push_event(pads[i], event);
+			g_free(stream_id);
+
+			/* caps; a decoder with different matrix dimensions would
+			 * produce garbage, so these are added to the caps to make
+			 * sure such a decoder fails to negotiate instead */
+			caps = gst_caps_make_writable(gst_pad_get_pad_template_caps(pads[i]));
+			gst_caps_set_simple(
+				caps,
+				GST_XOR_FEC_COLUMNS_CAPS_FIELD, G_TYPE_UINT, xor_fec_enc->num_columns,
+				GST_XOR_FEC_ROWS_CAPS_FIELD, G_TYPE_UINT, xor_fec_enc->num_rows,
+				NULL
+			);
+			event = gst_event_new_caps(caps);
+			gst_pad_push_event(pads[i], event);
+			gst_caps_unref(caps);
+		}
+
+		/* segment */
+		event = gst_event_new_segment(&segment);
+		gst_pad_push_event(pads[i], event);
+	}
+
+	xor_fec_enc->segment_started = TRUE;
+	xor_fec_enc->stream_started = TRUE;
+}
+
+
+static void gst_xor_fec_enc_free_payload_id(gpointer data)
+{
+	/* This function is called once a GstMemory block that
+	 * contains a FEC payload ID is deallocated */
+	g_slice_free1(GST_XOR_FEC_PAYLOAD_ID_LENGTH, data);
+}
+
+
+static void gst_xor_fec_enc_reset_states(GstXORFECEnc *xor_fec_enc)
+{
+	xor_fec_enc->first_source_packet = TRUE;
+	xor_fec_enc->first_repair_packet = TRUE;
+	xor_fec_enc->first_row_repair_packet = TRUE;
+	xor_fec_enc->segment_started = FALSE;
+	xor_fec_enc->eos_received = FALSE;
+}
+
+
+static void gst_xor_fec_enc_flush(GstXORFECEnc *xor_fec_enc)
+{
+	gst_xor_fec_enc_discard_source_block(xor_fec_enc);
+	gst_xor_fec_enc_reset_states(xor_fec_enc);
+}
+
+
+static void gst_xor_fec_enc_discard_source_block(GstXORFECEnc *xor_fec_enc)
+{
+	guint i;
+
+	/* Discard the current source block. Called when flushing, when a
+	 * source block is finished, and when pushing a packet failed. In
+	 * the latter case, the accumulators may still contain ADUIs of the
+	 * block, which must not end up in the next one. If FEC source
+	 * packets of the block were already sent, the next source block
+	 * must use a new number. */
+	if (xor_fec_enc->cur_esi > 0)
+	{
+		xor_fec_enc->cur_esi = 0;
+		xor_fec_enc->cur_source_block_nr = (xor_fec_enc->cur_source_block_nr + 1) & 0xFFFF;
+	}
+
+	/* The extension in gst_xor_fec_enc_accumulate() zero fills anything
+	 * past the length, so setting the lengths to 0 empties them */
+	xor_fec_enc->row_accumulator.length = 0;
+	if (xor_fec_enc->column_accumulators != NULL)
+	{
+		for (i = 0; i < xor_fec_enc->num_columns; ++i)
+			xor_fec_enc->column_accumulators[i].length = 0;
+	}
+}
@@ -0,0 +1,115 @@
+/* SMPTE 2022-1 style row/column XOR forward error correction for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef GSTFECFRAME_XOR_XORFECENC_H
+#define GSTFECFRAME_XOR_XORFECENC_H
+
+#include <gst/gst.h>
+
+
+G_BEGIN_DECLS
+
+
+typedef struct _GstXORFECEnc GstXORFECEnc;
+typedef struct _GstXORFECEncClass GstXORFECEncClass;
+typedef struct _GstXORFECEncAccumulator GstXORFECEncAccumulator;
+
+
+#define GST_TYPE_XOR_FEC_ENC             (gst_xor_fec_enc_get_type())
+#define GST_XOR_FEC_ENC(obj)             (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_XOR_FEC_ENC, GstXORFECEnc))
+#define GST_XOR_FEC_ENC_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST((klass), GST_TYPE_XOR_FEC_ENC, GstXORFECEncClass))
+#define GST_XOR_FEC_ENC_CAST(obj)        ((GstXORFECEnc *)(obj))
+#define GST_IS_XOR_FEC_ENC(obj)          (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_XOR_FEC_ENC))
+#define GST_IS_XOR_FEC_ENC_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass), GST_TYPE_XOR_FEC_ENC))
+
+
+/* A repair symbol that is being built. The ADUIs of a row or column
+ * are XORed into it as they come in, so the ADUs themselves do not
+ * have to be kept around. */
+struct _GstXORFECEncAccumulator
+{
+	/* Memory block for the repair symbol. It is grown as needed, and
+	 * retained after the repair symbol was sent, to avoid reallocations
+	 * for subsequent rows and columns. */
+	guint8 *data;
+	gsize capacity;
+	/* Current length of the repair symbol, which is the length of the
+	 * largest ADUI XORed into it so far. Shorter ADUIs are implicitely
+	 * zero padded. 0 means that the repair symbol is empty. */
+	gsize length;
+};
+
+
+struct _GstXORFECEnc
+{
+	GstElement parent;
+
+	/* Sink- and source pads. If separate_repair_pads is TRUE, row
+	 * repair packets are pushed to fecrowrepairpad, otherwise they
+	 * are pushed to fecrepairpad together with the column repair
+	 * packets. */
+	GstPad *sinkpad, *fecsourcepad, *fecrepairpad, *fecrowrepairpad;
+
+	/* Matrix dimensions (L and D), configured via properties.
+	 * These may only be modified if the accumulators are not
+	 * allocated (that is, if column_accumulators == NULL). */
+	guint num_columns, num_rows;
+	/* Number of source symbols per source block (L*D) */
+	guint num_source_symbols;
+	/* If FALSE, only column repair symbols are generated */
+	gboolean row_repair;
+	gboolean separate_repair_pads;
+
+	/* Accumulators for the repair symbol of the current row, and for
+	 * the repair symbols of all num_columns columns. These are allocated
+	 * at the NULL->READY state change. */
+	GstXORFECEncAccumulator row_accumulator;
+	GstXORFECEncAccumulator *column_accumulators;
+
+	/* Number of the current source block. Like in rsfecenc, this is
+	 * _not_ reset after flushes and PAUSED->READY state changes. */
+	guint cur_source_block_nr;
+	/* ESI of the next ADU in the current source block */
+	guint cur_esi;
+
+	/* TRUE if no FEC source/repair packet has been pushed downstream
+	 * yet. These are set to TRUE at startup, after a flush, and when
+	 * switching back state from PAUSED to READY. */
+	gboolean first_source_packet, first_repair_packet, first_row_repair_packet;
+
+	/* Same meaning as the fields with the same name in GstRSFECEnc */
+	gboolean segment_started;
+	gboolean stream_started;
+	gboolean eos_received;
+};
+
+
+struct _GstXORFECEncClass
+{
+	GstElementClass parent_class;
+};
+
+
+GType gst_xor_fec_enc_get_type(void);
+
+
+G_END_DECLS
+
+
+#endif
@@ -0,0 +1,430 @@
+/* Cauchy-matrix based Reed-Solomon erasure code
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/**
+ * Round-trip tests for the Cauchy Reed-Solomon code in
+ * src/reed-solomon/gstrscauchy.c, both with and without the XOR parity
+ * first row. k source symbols are encoded, up to n-k encoding symbols are
+ * dropped, and the decoded source symbols are compared with the original
+ * ones.
+ *
+ * The codec is linked into the test program directly (see the wscript),
+ * so unlike the element tests, this one does not need GST_PLUGIN_PATH.
+ */
+
+
+#include <string.h>
+#include <gst/check/gstcheck.h>
+#include "common/gstgf256.h"
+#include "reed-solomon/gstrscauchy.h"
+
+
+/* Not a multiple of 8, so the tail loops of the region functions are used */
+#define SYMBOL_LENGTH 37
+/* One of the default lengths with specialised region functions */
+#define FIXED_SYMBOL_LENGTH 1319
+#define NUM_RANDOM_PATTERNS 200
+#define RANDOM_SEED 0x2015
+
+
+typedef struct
+{
+	gboolean parity_first_row;
+	guint num_source_symbols, num_repair_symbols;
+	gsize symbol_length;
+
+	guint8 *symbols;
+	void **encoding_symbol_table;
+	void **received_encoding_symbol_table;
+	void **recovered_source_symbol_table;
+	guint8 *recovered_symbols;
+}
+CodecTestBlock;
+
+
+
+
+static void setup_block(CodecTestBlock *block, gboolean parity_first_row, guint num_source_symbols, guint num_repair_symbols, gsize symbol_length)
+{
+	guint i;
+	gsize j;
+	guint n = num_source_symbols + num_repair_symbols;
+
+	gst_fec_gf256_init();
+
+	block->parity_first_row = parity_first_row;
+	block->num_source_symbols = num_source_symbols;
+	block->num_repair_symbols = num_repair_symbols;
+	block->symbol_length = symbol_length;
+
+	block->symbols = g_malloc(n * symbol_length);
+	block->encoding_symbol_table = g_new(void *, n);
+	block->received_encoding_symbol_table = g_new(void *, n);
+	block->recovered_source_symbol_table = g_new(void *, num_source_symbols);
+	block->recovered_symbols = g_malloc(num_source_symbols * symbol_length);
+
+	for (i = 0; i < n; ++i)
+		block->encoding_symbol_table[i] = block->symbols + i * symbol_length;
+
+	for (i = 0; i < num_source_symbols; ++i)
+	{
+		guint8 *symbol = block->encoding_symbol_table[i];
+		for (j = 0; j < symbol_length; ++j)
+			symbol[j] = (guint8)(i * 151 + j * 7 + (j >> 8) + 1);
+	}
+
+	for (i = num_source_symbols; i < n; ++i)
+		gst_rs_cauchy_build_repair_symbol(parity_first_row, num_source_symbols, block->encoding_symbol_table, i, symbol_length);
+}
+
+
+static void cleanup_block(CodecTestBlock *block)
+{
+	g_free(block->symbols);
+	g_free(block->encoding_symbol_table);
+	g_free(block->received_encoding_symbol_table);
+	g_free(block->recovered_source_symbol_table);
+	g_free(block->recovered_symbols);
+}
+
+
+/* Marks all encoding symbols as received, and clears the recovered symbols
+ * with a pattern that is never a valid result */
+static void receive_all(CodecTestBlock *block)
+{
+	guint i;
+
+	for (i = 0; i < (block->num_source_symbols + block->num_repair_symbols); ++i)
+		block->received_encoding_symbol_table[i] = block->encoding_symbol_table[i];
+
+	for (i = 0; i < block->num_source_symbols; ++i)
+		block->recovered_source_symbol_table[i] = NULL;
+
+	memset(block->recovered_symbols, 0xA5, block->num_source_symbols * block->symbol_length);
+}
+
+
+static void drop_symbol(CodecTestBlock *block, guint esi)
+{
+	block->received_encoding_symbol_table[esi] = NULL;
+	if (esi < block->num_source_symbols)
+		block->recovered_source_symbol_table[esi] = block->recovered_symbols + esi * block->symbol_length;
+}
+
+
+static gboolean decode(CodecTestBlock *block)
+{
+	return gst_rs_cauchy_decode(block->parity_first_row, block->num_source_symbols, block->num_repair_symbols, block->received_encoding_symbol_table, block->recovered_source_symbol_table, block->symbol_length);
+}
+
+
+/* Decodes the block, and checks that all dropped source symbols were recovered */
+static void decode_and_compare(CodecTestBlock *block)
+{
+	guint i;
+
+	fail_unless(decode(block));
+
+	for (i = 0; i < block->num_source_symbols; ++i)
+	{
+		if (block->received_encoding_symbol_table[i] != NULL)
+			continue;
+
+		fail_unless(memcmp(block->recovered_source_symbol_table[i], block->encoding_symbol_table[i], block->symbol_length) == 0, "source symbol %u was not recovered correctly (k %u r %u)", i, block->num_source_symbols, block->num_repair_symbols);
+	}
+}
+
+
+/* Drops a random selection of up to num_repair_symbols encoding symbols,
+ * num_patterns times, and checks that the block is recovered every time */
+static void check_random_patterns(CodecTestBlock *block, guint num_patterns)
+{
+	GRand *rand = g_rand_new_with_seed(RANDOM_SEED);
+	guint n = block->num_source_symbols + block->num_repair_symbols;
+	guint pattern, i;
+
+	for (pattern = 0; pattern < num_patterns; ++pattern)
+	{
+		guint num_dropped = g_rand_int_range(rand, 0, block->num_repair_symbols + 1);
+
+		receive_all(block);
+		for (i = 0; i < num_dropped; ++i)
+		{
+			guint esi;
+
+			/* Pick an encoding symbol that has not been dropped yet */
+			do
+				esi = g_rand_int_range(rand, 0, n);
+			while (block->received_encoding_symbol_table[esi] == NULL);
+
+			drop_symbol(block, esi);
+		}
+
+		decode_and_compare(block);
+	}
+
+	g_rand_free(rand);
+}
+
+
+
+
+GST_START_TEST(test_cauchy_no_loss)
+{
+	CodecTestBlock block;
+
+	setup_block(&block, FALSE, 10, 4, SYMBOL_LENGTH);
+	receive_all(&block);
+	fail_unless(decode(&block));
+	cleanup_block(&block);
+}
+GST_END_TEST
+
+
+GST_START_TEST(test_cauchy_source_symbol_losses)
+{
+	CodecTestBlock block;
+	guint i;
+
+	setup_block(&block, FALSE, 10, 4, SYMBOL_LENGTH);
+
+	/* The first r source symbols */
+	receive_all(&block);
+	for (i = 0; i < 4; ++i)
+		drop_symbol(&block, i);
+	decode_and_compare(&block);
+
+	/* The last r source symbols */
+	receive_all(&block);
+	for (i = 6; i < 10; ++i)
+		drop_symbol(&block, i);
+	decode_and_compare(&block);
+
+	/* Source and repair symbols mixed, so that
+	 * the last repair symbol has to be used */
+	receive_all(&block);
+	drop_symbol(&block, 1);
+	drop_symbol(&block, 5);
+	drop_symbol(&block, 10);
+	drop_symbol(&block, 12);
+	decode_and_compare(&block);
+
+	/* Only repair symbols; nothing needs to be recovered */
+	receive_all(&block);
+	for (i = 10; i < 14; ++i)
+		drop_symbol(&block, i);
+	decode_and_compare(&block);
+
+	cleanup_block(&block);
+}
+GST_END_TEST
+
+
+GST_START_TEST(test_cauchy_too_many_losses)
+{
+	CodecTestBlock block;
+	guint i;
+
+	setup_block(&block, FALSE, 10, 4, SYMBOL_LENGTH);
+
+	receive_all(&block);
+	for (i = 0; i < 5; ++i)
+		drop_symbol(&block, i);
+	fail_if(decode(&block));
+
+	receive_all(&block);
+	drop_symbol(&block, 0);
+	drop_symbol(&block, 10);
+	drop_symbol(&block, 11);
+	drop_symbol(&block, 12);
+	drop_symbol(&block, 13);
+	fail_if(decode(&block));
+
+	cleanup_block(&block);
+}
+GST_END_TEST
+
+
+GST_START_TEST(test_cauchy_random_losses)
+{
+	CodecTestBlock block;
+
+	setup_block(&block, FALSE, 20, 8, SYMBOL_LENGTH);
+	check_random_patterns(&block, NUM_RANDOM_PATTERNS);
+	cleanup_block(&block);
+}
+GST_END_TEST
+
+
+GST_START_TEST(test_cauchy_fixed_symbol_length)
+{
+	CodecTestBlock block;
+
+	setup_block(&block, FALSE, 10, 6, FIXED_SYMBOL_LENGTH);
+	check_random_patterns(&block, NUM_RANDOM_PATTERNS / 10);
+	cleanup_block(&block);
+}
+GST_END_TEST
+
+
+GST_START_TEST(test_cauchy_max_block_size)
+{
+	CodecTestBlock block;
+	guint i;
+
+	/* k+r = 256 is the largest block the code supports */
+	setup_block(&block, FALSE, 200, 56, SYMBOL_LENGTH);
+
+	receive_all(&block);
+	for (i = 0; i < 56; ++i)
+		drop_symbol(&block, 144 + i);
+	decode_and_compare(&block);
+
+	check_random_patterns(&block, NUM_RANDOM_PATTERNS / 10);
+
+	cleanup_block(&block);
+}
+GST_END_TEST
+
+
+
+GST_START_TEST(test_parity_cauchy_first_repair_is_xor)
+{
+	CodecTestBlock block;
+	guint8 parity[SYMBOL_LENGTH];
+	guint i;
+
+	setup_block(&block, TRUE, 10, 4, SYMBOL_LENGTH);
+
+	memset(parity, 0, sizeof(parity));
+	for (i = 0; i < 10; ++i)
+		gst_fec_xor_region(parity, block.encoding_symbol_table[i], SYMBOL_LENGTH);
+
+	fail_unless(memcmp(block.encoding_symbol_table[10], parity, SYMBOL_LENGTH) == 0);
+
+	cleanup_block(&block);
+}
+GST_END_TEST
+
+
+GST_START_TEST(test_parity_cauchy_single_erasure)
+{
+	CodecTestBlock block;
+	guint i, j;
+
+	setup_block(&block, TRUE, 10, 4, SYMBOL_LENGTH);
+
+	/* Only the XOR parity symbol is available for recovery */
+	for (i = 0; i < 10; ++i)
+	{
+		receive_all(&block);
+		drop_symbol(&block, i);
+		for (j = 11; j < 14; ++j)
+			drop_symbol(&block, j);
+		decode_and_compare(&block);
+	}
+
+	/* The XOR parity symbol is lost as well, so another
+	 * repair symbol has to be used */
+	for (i = 0; i < 10; ++i)
+	{
+		receive_all(&block);
+		drop_symbol(&block, i);
+		drop_symbol(&block, 10);
+		decode_and_compare(&block);
+	}
+
+	cleanup_block(&block);
+}
+GST_END_TEST
+
+
+GST_START_TEST(test_parity_cauchy_too_many_losses)
+{
+	CodecTestBlock block;
+
+	setup_block(&block, TRUE, 10, 4, SYMBOL_LENGTH);
+
+	receive_all(&block);
+	drop_symbol(&block, 3);
+	drop_symbol(&block, 7);
+	drop_symbol(&block, 11);
+	drop_symbol(&block, 12);
+	drop_symbol(&block, 13);
+	fail_if(decode(&block));
+
+	cleanup_block(&block);
+}
+GST_END_TEST
+
+
+GST_START_TEST(test_parity_cauchy_random_losses)
+{
+	CodecTestBlock block;
+
+	setup_block(&block, TRUE, 20, 8, SYMBOL_LENGTH);
+	check_random_patterns(&block, NUM_RANDOM_PATTERNS);
+	cleanup_block(&block);
+
+	setup_block(&block, TRUE, 10, 6, FIXED_SYMBOL_LENGTH);
+	check_random_patterns(&block, NUM_RANDOM_PATTERNS / 10);
+	cleanup_block(&block);
+}
+GST_END_TEST
+
+
+GST_START_TEST(test_parity_cauchy_max_block_size)
+{
+	CodecTestBlock block;
+
+	setup_block(&block, TRUE, 200, 56, SYMBOL_LENGTH);
+	check_random_patterns(&block, NUM_RANDOM_PATTERNS / 10);
+	cleanup_block(&block);
+}
+GST_END_TEST
+
+
+
+
+static Suite* rscauchy_suite(void)
+{
+	Suite *s = suite_create("rscauchy");
+	TCase *tc_cauchy = tcase_create("cauchy");
+	TCase *tc_parity_cauchy = tcase_create("parity-cauchy");
+
+	suite_add_tcase(s, tc_cauchy);
+	tcase_add_test(tc_cauchy, test_cauchy_no_loss);
+	tcase_add_test(tc_cauchy, test_cauchy_source_symbol_losses);
+	tcase_add_test(tc_cauchy, test_cauchy_too_many_losses);
+	tcase_add_test(tc_cauchy, test_cauchy_random_losses);
+	tcase_add_test(tc_cauchy, test_cauchy_fixed_symbol_length);
+	tcase_add_test(tc_cauchy, test_cauchy_max_block_size);
+
+	suite_add_tcase(s, tc_parity_cauchy);
+	tcase_add_test(tc_parity_cauchy, test_parity_cauchy_first_repair_is_xor);
+	tcase_add_test(tc_parity_cauchy, test_parity_cauchy_single_erasure);
+	tcase_add_test(tc_parity_cauchy, test_parity_cauchy_too_many_losses);
+	tcase_add_test(tc_parity_cauchy, test_parity_cauchy_random_losses);
+	tcase_add_test(tc_parity_cauchy, test_parity_cauchy_max_block_size);
+
+	return s;
+}
+
+
+GST_CHECK_MAIN(rscauchy)
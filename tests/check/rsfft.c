@@ -0,0 +1,373 @@
+/* GF(2^16) Reed-Solomon erasure code based on the additive FFT
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/**
+ * Round-trip tests for the GF(2^16) FFT Reed-Solomon code in
+ * src/reed-solomon/gstrsfft.c. k source symbols are encoded, up to n-k
+ * encoding symbols are dropped, and the decoded source symbols are compared
+ * with the original ones. The parameter limits (k+m <= 65536, with m being
+ * the number of repair symbols rounded up to a power of two) are checked
+ * as well, including round trips with blocks at these limits.
+ *
+ * The codec is linked into the test program directly (see the wscript),
+ * so unlike the element tests, this one does not need GST_PLUGIN_PATH.
+ */
+
+
+#include <string.h>
+#include <gst/check/gstcheck.h>
+#include "common/gstgf256.h"
+#include "reed-solomon/gstrsfft.h"
+
+
+/* Must be even, since symbols consist of 16-bit words */
+#define SYMBOL_LENGTH 38
+#define NUM_RANDOM_PATTERNS 100
+#define RANDOM_SEED 0x2015
+
+
+typedef struct
+{
+	guint num_source_symbols, num_repair_symbols;
+	gsize symbol_length;
+
+	guint8 *symbols;
+	void **encoding_symbol_table;
+	void **received_encoding_symbol_table;
+	void **recovered_source_symbol_table;
+	guint8 *recovered_symbols;
+}
+CodecTestBlock;
+
+
+
+
+static void setup_block(CodecTestBlock *block, guint num_source_symbols, guint num_repair_symbols, gsize symbol_length)
+{
+	guint i;
+	gsize j;
+	guint n = num_source_symbols + num_repair_symbols;
+
+	gst_fec_gf256_init();
+	gst_rs_fft_init();
+
+	fail_unless(gst_rs_fft_check_parameters(num_source_symbols, num_repair_symbols));
+
+	block->num_source_symbols = num_source_symbols;
+	block->num_repair_symbols = num_repair_symbols;
+	block->symbol_length = symbol_length;
+
+	block->symbols = g_malloc(n * symbol_length);
+	block->encoding_symbol_table = g_new(void *, n);
+	block->received_encoding_symbol_table = g_new(void *, n);
+	block->recovered_source_symbol_table = g_new(void *, num_source_symbols);
+	block->recovered_symbols = g_malloc(num_source_symbols * symbol_length);
+
+	for (i = 0; i < n; ++i)
+		block->encoding_symbol_table[i] = block->symbols + i * symbol_length;
+
+	for (i = 0; i < num_source_symbols; ++i)
+	{
+		guint8 *symbol = block->encoding_symbol_table[i];
+		for (j = 0; j < symbol_length; ++j)
+			symbol[j] = (guint8)(i * 151 + (i >> 8) * 13 + j * 7 + 1);
+	}
+
+	gst_rs_fft_build_repair_symbols(num_source_symbols, num_repair_symbols, block->encoding_symbol_table, symbol_length);
+}
+
+
+static void cleanup_block(CodecTestBlock *block)
+{
+	g_free(block->symbols);
+	g_free(block->encoding_symbol_table);
+	g_free(block->received_encoding_symbol_table);
+	g_free(block->recovered_source_symbol_table);
+	g_free(block->recovered_symbols);
+}
+
+
+/* Marks all encoding symbols as received, and clears the recovered symbols
+ * with a pattern that is never a valid result */
+static void receive_all(CodecTestBlock *block)
+{
+	guint i;
+
+	for (i = 0; i < (block->num_source_symbols + block->num_repair_symbols); ++i)
+		block->received_encoding_symbol_table[i] = block->encoding_symbol_table[i];
+
+	for (i = 0; i < block->num_source_symbols; ++i)
+		block->recovered_source_symbol_table[i] = NULL;
+
+	memset(block->recovered_symbols, 0xA5, block->num_source_symbols * block->symbol_length);
+}
+
+
+static void drop_symbol(CodecTestBlock *block, guint esi)
+{
+	block->received_encoding_symbol_table[esi] = NULL;
+	if (esi < block->num_source_symbols)
+		block->recovered_source_symbol_table[esi] = block->recovered_symbols + esi * block->symbol_length;
+}
+
+
+static gboolean decode(CodecTestBlock *block)
+{
+	return gst_rs_fft_decode(block->num_source_symbols, block->num_repair_symbols, block->received_encoding_symbol_table, block->recovered_source_symbol_table, block->symbol_length);
+}
+
+
+/* Decodes the block, and checks that all dropped source symbols were recovered */
+static void decode_and_compare(CodecTestBlock *block)
+{
+	guint i;
+
+	fail_unless(decode(block));
+
+	for (i = 0; i < block->num_source_symbols; ++i)
+	{
+		if (block->received_encoding_symbol_table[i] != NULL)
+			continue;
+
+		fail_unless(memcmp(block->recovered_source_symbol_table[i], block->encoding_symbol_table[i], block->symbol_length) == 0, "source symbol %u was not recovered correctly (k %u r %u)", i, block->num_source_symbols, block->num_repair_symbols);
+	}
+}
+
+
+/* Drops a random selection of up to num_repair_symbols encoding symbols,
+ * num_patterns times, and checks that the block is recovered every time */
+static void check_random_patterns(CodecTestBlock *block, guint num_patterns)
+{
+	GRand *rand = g_rand_new_with_seed(RANDOM_SEED);
+	guint n = block->num_source_symbols + block->num_repair_symbols;
+	guint pattern, i;
+
+	for (pattern = 0; pattern < num_patterns; ++pattern)
+	{
+		guint num_dropped = g_rand_int_range(rand, 0, block->num_repair_symbols + 1);
+
+		receive_all(block);
+		for (i = 0; i < num_dropped; ++i)
+		{
+			guint esi;
+
+			/* Pick an encoding symbol that has not been dropped yet */
+			do
+				esi = g_rand_int_range(rand, 0, n);
+			while (block->received_encoding_symbol_table[esi] == NULL);
+
+			drop_symbol(block, esi);
+		}
+
+		decode_and_compare(block);
+	}
+
+	g_rand_free(rand);
+}
+
+
+
+
+GST_START_TEST(test_fft_check_parameters)
+{
+	gst_rs_fft_init();
+
+	/* There must be at least one source symbol */
+	fail_if(gst_rs_fft_check_parameters(0, 4));
+
+	fail_unless(gst_rs_fft_check_parameters(1, 1));
+	fail_unless(gst_rs_fft_check_parameters(1000, 100));
+
+	/* k+m must not exceed 65536, with m being the number
+	 * of repair symbols rounded up to a power of two */
+	fail_unless(gst_rs_fft_check_parameters(65535, 1));
+	fail_if(gst_rs_fft_check_parameters(65535, 2));
+	fail_unless(gst_rs_fft_check_parameters(65532, 3));
+	fail_unless(gst_rs_fft_check_parameters(65532, 4));
+	fail_if(gst_rs_fft_check_parameters(65532, 5));
+	fail_unless(gst_rs_fft_check_parameters(32768, 32768));
+	fail_if(gst_rs_fft_check_parameters(32769, 32768));
+	fail_if(gst_rs_fft_check_parameters(32768, 32769));
+	fail_unless(gst_rs_fft_check_parameters(1, 32768));
+	fail_if(gst_rs_fft_check_parameters(1, 32769));
+
+	/* Out of range symbol counts */
+	fail_if(gst_rs_fft_check_parameters(65536, 0));
+	fail_if(gst_rs_fft_check_parameters(65536, 1));
+	fail_if(gst_rs_fft_check_parameters(1, 65536));
+}
+GST_END_TEST
+
+
+GST_START_TEST(test_fft_no_loss)
+{
+	CodecTestBlock block;
+
+	setup_block(&block, 10, 4, SYMBOL_LENGTH);
+	receive_all(&block);
+	fail_unless(decode(&block));
+	cleanup_block(&block);
+}
+GST_END_TEST
+
+
+GST_START_TEST(test_fft_source_symbol_losses)
+{
+	CodecTestBlock block;
+	guint i;
+
+	setup_block(&block, 10, 4, SYMBOL_LENGTH);
+
+	/* The first r source symbols */
+	receive_all(&block);
+	for (i = 0; i < 4; ++i)
+		drop_symbol(&block, i);
+	decode_and_compare(&block);
+
+	/* The last r source symbols */
+	receive_all(&block);
+	for (i = 6; i < 10; ++i)
+		drop_symbol(&block, i);
+	decode_and_compare(&block);
+
+	/* Source and repair symbols mixed */
+	receive_all(&block);
+	drop_symbol(&block, 1);
+	drop_symbol(&block, 5);
+	drop_symbol(&block, 10);
+	drop_symbol(&block, 12);
+	decode_and_compare(&block);
+
+	cleanup_block(&block);
+}
+GST_END_TEST
+
+
+GST_START_TEST(test_fft_too_many_losses)
+{
+	CodecTestBlock block;
+	guint i;
+
+	setup_block(&block, 10, 4, SYMBOL_LENGTH);
+
+	receive_all(&block);
+	for (i = 0; i < 5; ++i)
+		drop_symbol(&block, i);
+	fail_if(decode(&block));
+
+	receive_all(&block);
+	drop_symbol(&block, 0);
+	drop_symbol(&block, 10);
+	drop_symbol(&block, 11);
+	drop_symbol(&block, 12);
+	drop_symbol(&block, 13);
+	fail_if(decode(&block));
+
+	cleanup_block(&block);
+}
+GST_END_TEST
+
+
+GST_START_TEST(test_fft_random_losses)
+{
+	CodecTestBlock block;
+
+	/* r is not a power of two, so some repair positions are never sent */
+	setup_block(&block, 20, 5, SYMBOL_LENGTH);
+	check_random_patterns(&block, NUM_RANDOM_PATTERNS);
+	cleanup_block(&block);
+
+	/* k is much larger than m, so the encoder interpolates several chunks */
+	setup_block(&block, 50, 3, SYMBOL_LENGTH);
+	check_random_patterns(&block, NUM_RANDOM_PATTERNS);
+	cleanup_block(&block);
+
+	/* More repair than source symbols */
+	setup_block(&block, 7, 12, SYMBOL_LENGTH);
+	check_random_patterns(&block, NUM_RANDOM_PATTERNS);
+	cleanup_block(&block);
+}
+GST_END_TEST
+
+
+GST_START_TEST(test_fft_max_source_symbols)
+{
+	CodecTestBlock block;
+	guint i;
+
+	/* k+m = 65536, with k as large as possible for 4 repair symbols */
+	setup_block(&block, 65532, 4, 2);
+
+	receive_all(&block);
+	drop_symbol(&block, 0);
+	drop_symbol(&block, 12345);
+	drop_symbol(&block, 40000);
+	drop_symbol(&block, 65531);
+	decode_and_compare(&block);
+
+	receive_all(&block);
+	for (i = 0; i < 4; ++i)
+		drop_symbol(&block, 65528 + i);
+	decode_and_compare(&block);
+
+	cleanup_block(&block);
+}
+GST_END_TEST
+
+
+GST_START_TEST(test_fft_max_repair_symbols)
+{
+	CodecTestBlock block;
+	guint i;
+
+	/* k+m = 65536, with as many repair as source symbols. Drop
+	 * every other encoding symbol, which are n-k symbols in total. */
+	setup_block(&block, 32768, 32768, 2);
+
+	receive_all(&block);
+	for (i = 0; i < 65536; i += 2)
+		drop_symbol(&block, i);
+	decode_and_compare(&block);
+
+	cleanup_block(&block);
+}
+GST_END_TEST
+
+
+
+
+static Suite* rsfft_suite(void)
+{
+	Suite *s = suite_create("rsfft");
+	TCase *tc_fft = tcase_create("gf16-fft");
+
+	suite_add_tcase(s, tc_fft);
+	tcase_add_test(tc_fft, test_fft_check_parameters);
+	tcase_add_test(tc_fft, test_fft_no_loss);
+	tcase_add_test(tc_fft, test_fft_source_symbol_losses);
+	tcase_add_test(tc_fft, test_fft_too_many_losses);
+	tcase_add_test(tc_fft, test_fft_random_losses);
+	tcase_add_test(tc_fft, test_fft_max_source_symbols);
+	tcase_add_test(tc_fft, test_fft_max_repair_symbols);
+
+	return s;
+}
+
+
+GST_CHECK_MAIN(rsfft)
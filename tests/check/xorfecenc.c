@@ -0,0 +1,216 @@
+/* SMPTE 2022-1 style row/column XOR forward error correction for GStreamer
+ * Copyright (C) 2015  Carlos Rafael Giani
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+/**
+ * Unit tests for xorfecenc. The element's sink pad is fed by a test source
+ * pad; its fecsource and fecrepair pads are linked to test sink pads. The
+ * fecrepair test pad can be told to refuse buffers, which is used to check
+ * that a failed push does not leave stale data in the accumulators.
+ *
+ * The plugin is looked up via the registry, so GST_PLUGIN_PATH must point to
+ * the directory containing the built plugin (see the README).
+ */
+
+
+#include <string.h>
+#include <gst/check/gstcheck.h>
+
+
+#define NUM_COLUMNS 2
+#define NUM_ROWS 2
+#define NUM_SOURCE_SYMBOLS (NUM_COLUMNS * NUM_ROWS)
+#define ADU_LENGTH 16
+#define PAYLOAD_ID_LENGTH 4
+
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE(
+	"src",
+	GST_PAD_SRC,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS_ANY
+);
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE(
+	"sink",
+	GST_PAD_SINK,
+	GST_PAD_ALWAYS,
+	GST_STATIC_CAPS_ANY
+);
+
+
+static GstElement *xorfecenc;
+static GstPad *mysrcpad, *mysourcesinkpad, *myrepairsinkpad;
+static GList *repair_buffers;
+static gboolean fail_repair_push;
+
+
+
+
+static GstFlowReturn repair_chain(G_GNUC_UNUSED GstPad *pad, G_GNUC_UNUSED GstObject *parent, GstBuffer *buffer)
+{
+	if (fail_repair_push)
+	{
+		gst_buffer_unref(buffer);
+		return GST_FLOW_ERROR;
+	}
+
+	repair_buffers = g_list_append(repair_buffers, buffer);
+	return GST_FLOW_OK;
+}
+
+
+static void setup_xorfecenc(void)
+{
+	GstPad *pad;
+
+	xorfecenc = gst_check_setup_element("xorfecenc");
+	g_object_set(G_OBJECT(xorfecenc), "columns", NUM_COLUMNS, "rows", NUM_ROWS, "row-repair", FALSE, NULL);
+
+	mysrcpad = gst_check_setup_src_pad(xorfecenc, &srctemplate);
+	mysourcesinkpad = gst_check_setup_sink_pad_by_name(xorfecenc, &sinktemplate, "fecsource");
+
+	myrepairsinkpad = gst_pad_new_from_static_template(&sinktemplate, "repairsink");
+	gst_pad_set_chain_function(myrepairsinkpad, repair_chain);
+	pad = gst_element_get_static_pad(xorfecenc, "fecrepair");
+	fail_unless(gst_pad_link(pad, myrepairsinkpad) == GST_PAD_LINK_OK);
+	gst_object_unref(GST_OBJECT(pad));
+
+	gst_pad_set_active(mysrcpad, TRUE);
+	gst_pad_set_active(mysourcesinkpad, TRUE);
+	gst_pad_set_active(myrepairsinkpad, TRUE);
+
+	fail_unless(gst_element_set_state(xorfecenc, GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS);
+	gst_check_setup_events(mysrcpad, xorfecenc, NULL, GST_FORMAT_BYTES);
+
+	repair_buffers = NULL;
+	fail_repair_push = FALSE;
+}
+
+
+static void cleanup_xorfecenc(void)
+{
+	GstPad *pad;
+
+	fail_unless(gst_element_set_state(xorfecenc, GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS);
+
+	gst_check_drop_buffers();
+	g_list_free_full(repair_buffers, (GDestroyNotify)gst_buffer_unref);
+	repair_buffers = NULL;
+
+	pad = gst_element_get_static_pad(xorfecenc, "fecrepair");
+	gst_pad_unlink(pad, myrepairsinkpad);
+	gst_object_unref(GST_OBJECT(pad));
+	gst_pad_set_active(myrepairsinkpad, FALSE);
+	gst_object_unref(GST_OBJECT(myrepairsinkpad));
+
+	gst_pad_set_active(mysrcpad, FALSE);
+	gst_pad_set_active(mysourcesinkpad, FALSE);
+	gst_check_teardown_src_pad(xorfecenc);
+	gst_check_teardown_sink_pad(xorfecenc);
+	gst_check_teardown_element(xorfecenc);
+}
+
+
+static GstBuffer* create_adu(guint8 seed)
+{
+	GstBuffer *adu = gst_buffer_new_allocate(NULL, ADU_LENGTH, NULL);
+	GstMapInfo map_info;
+	guint i;
+
+	gst_buffer_map(adu, &map_info, GST_MAP_WRITE);
+	for (i = 0; i < ADU_LENGTH; ++i)
+		map_info.data[i] = (guint8)(seed * 31 + i * 7);
+	gst_buffer_unmap(adu, &map_info);
+
+	return adu;
+}
+
+
+
+
+GST_START_TEST(test_failed_repair_push_resets_accumulators)
+{
+	guint8 expected[3 + ADU_LENGTH];
+	guint esi, column, i;
+	GList *node;
+
+	setup_xorfecenc();
+
+	/* First source block: the column repair push fails at the last ADU */
+	fail_repair_push = TRUE;
+	for (esi = 0; esi < NUM_SOURCE_SYMBOLS - 1; ++esi)
+		fail_unless_equals_int(gst_pad_push(mysrcpad, create_adu(esi)), GST_FLOW_OK);
+	fail_unless_equals_int(gst_pad_push(mysrcpad, create_adu(esi)), GST_FLOW_ERROR);
+	fail_unless(repair_buffers == NULL);
+
+	/* Second source block: all pushes succeed. Its column repair symbols
+	 * must only contain the ADUIs of this block. */
+	fail_repair_push = FALSE;
+	for (esi = 0; esi < NUM_SOURCE_SYMBOLS; ++esi)
+		fail_unless_equals_int(gst_pad_push(mysrcpad, create_adu(100 + esi)), GST_FLOW_OK);
+
+	fail_unless_equals_int(g_list_length(repair_buffers), NUM_COLUMNS);
+
+	for (node = repair_buffers, column = 0; node != NULL; node = node->next, ++column)
+	{
+		GstBuffer *repair_packet = GST_BUFFER(node->data);
+		GstMapInfo map_info;
+		guint source_block_nr, repair_esi;
+
+		/* All ADUs have the same length, so the ADUI headers
+		 * (flow ID 0 and the ADU length) cancel each other out */
+		memset(expected, 0, sizeof(expected));
+		for (esi = column; esi < NUM_SOURCE_SYMBOLS; esi += NUM_COLUMNS)
+		{
+			for (i = 0; i < ADU_LENGTH; ++i)
+				expected[3 + i] ^= (guint8)((100 + esi) * 31 + i * 7);
+		}
+
+		gst_buffer_map(repair_packet, &map_info, GST_MAP_READ);
+		fail_unless_equals_int(map_info.size, PAYLOAD_ID_LENGTH + sizeof(expected));
+
+		source_block_nr = (((guint)(map_info.data[0])) << 8) | map_info.data[1];
+		repair_esi = (((guint)(map_info.data[2])) << 8) | map_info.data[3];
+		fail_unless_equals_int(source_block_nr, 1);
+		fail_unless_equals_int(repair_esi, NUM_SOURCE_SYMBOLS + NUM_ROWS + column);
+
+		fail_unless(memcmp(map_info.data + PAYLOAD_ID_LENGTH, expected, sizeof(expected)) == 0, "column %u repair symbol contains stale data", column);
+		gst_buffer_unmap(repair_packet, &map_info);
+	}
+
+	cleanup_xorfecenc();
+}
+GST_END_TEST
+
+
+
+
+static Suite* xorfecenc_suite(void)
+{
+	Suite *s = suite_create("xorfecenc");
+	TCase *tc_chain = tcase_create("general");
+
+	suite_add_tcase(s, tc_chain);
+	tcase_add_test(tc_chain, test_failed_repair_push_resets_accumulators);
+
+	return s;
+}
+
+
+GST_CHECK_MAIN(xorfecenc)